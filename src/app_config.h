@@ -2,7 +2,9 @@
 #define APP_CONFIG_H_
 
 // 音频配置
-#define AUDIO_SAMPLE_RATE         (16000u)  // 16 kHz
+#define AUDIO_CAPTURE_SAMPLE_RATE (48000u)  // PDM/PCM 采集采样率 48 kHz，较高的采集率给重采样的抗混叠滤波留出过渡带
+#define AUDIO_SAMPLE_RATE         (16000u)  // 默认输出采样率 16 kHz，可通过 audio_set_output_sample_rate() 运行时切换
+#define AUDIO_MAX_OUTPUT_SAMPLE_RATE (16000u) // 输出采样率上限，决定 audio_data_t 的大小
 #define AUDIO_MODE                CYHAL_PDM_PCM_MODE_LEFT
 // #define AUDIO_MODE                CYHAL_PDM_PCM_MODE_RIGHT
 // #define AUDIO_MODE                CYHAL_PDM_PCM_MODE_STEREO
@@ -17,28 +19,113 @@
 #endif
 
 #define AUDIO_BIT_RESOLUTION      (16)      // 16位
-#define AUDIO_FRAME_DURATION_MS   (40)      // 40毫秒
-#define AUDIO_SAMPLES_PER_FRAME   ((AUDIO_SAMPLE_RATE * AUDIO_FRAME_DURATION_MS) / 1000)
+#define AUDIO_FRAME_DURATION_MS   (40)      // 默认帧长 40毫秒，可通过 audio_set_frame_duration_ms() 运行时切换
+#define AUDIO_MIN_FRAME_DURATION_MS (10)    // 帧长必须是 10 毫秒的整数倍 (10/20/40/80)
+#define AUDIO_MAX_FRAME_DURATION_MS (80)    // 所有帧缓冲都按最大帧长分配
+#define AUDIO_SAMPLES_PER_FRAME   ((AUDIO_MAX_OUTPUT_SAMPLE_RATE * AUDIO_MAX_FRAME_DURATION_MS) / 1000) // 每帧最大输出采样点数 (每通道)
 #define AUDIO_BUFFER_SIZE_BYTES   (AUDIO_SAMPLES_PER_FRAME * AUDIO_CHANNELS * (AUDIO_BIT_RESOLUTION / 8))
+#define AUDIO_CAPTURE_SAMPLES_PER_FRAME ((AUDIO_CAPTURE_SAMPLE_RATE * AUDIO_MAX_FRAME_DURATION_MS) / 1000) // 每帧最大采集采样点数 (每通道)
+#define AUDIO_STATS_LOG_INTERVAL_MS (10000) // 录音期间打印音频流水线统计 (含每帧处理周期数) 的间隔
 
 // MQTT 配置 (占位符，后续需要用户配置)
 // #define MQTT_BROKER_ADDRESS       "192.168.5.246"
 #define MQTT_BROKER_ADDRESS       "111.229.213.23"
+// 可故障切换的代理列表 (最多 BROKER_SELECT_MAX_ENDPOINTS 个，见 broker_select.h)，按健康分数选择，分数相同时优先靠前的。
+// 所有代理使用相同的端口、凭证和主题；UDP 接收端与数据连接跟随当前代理。
+#define MQTT_BROKER_LIST          { MQTT_BROKER_ADDRESS /* , "192.168.5.246" */ }
 
-#define MQTT_PORT                 (1883)
 #define MQTT_CLIENT_ID_PREFIX     "meeting_assistant"
 
 //#define MQTT_TOPIC_AUDIO_STREAM   "meeting_audio/stream"
-#define MQTT_TOPIC_AUDIO_STREAM   "audio/stream"
+#define MQTT_TOPIC_AUDIO_STREAM   "audio/stream"  // 音频主题均为前缀，设备发布到 "<前缀>/<客户端 ID>"
+#define MQTT_TOPIC_AUDIO_BACKLOG  "audio/backlog" // 断线期间积压、恢复后限速补发的帧 (帧头带 AUDIO_FRAME_FLAG_BACKLOG)
+#define MQTT_TOPIC_AUDIO_ARCHIVE  "audio/archive" // 扇出的归档副本 (实时帧和积压帧按发布顺序，见 AUDIO_FANOUT_DEPTH)
 
 #define MQTT_USERNAME             "" // 可选
 #define MQTT_PASSWORD             "" // 可选
 #define MQTT_SECURE_CONNECTION    (0) // 0 表示非安全连接，1 表示安全连接 (TLS)
+#if (MQTT_SECURE_CONNECTION == 1)
+#define MQTT_PORT                 (8883)
+#else
+#define MQTT_PORT                 (1883)
+#endif
+// TLS 凭证 (PEM 字符串)，空字符串表示不设置。mbedTLS 的裁剪配置见 mbedtls_user_config.h 中的 APP_MBEDTLS_TRIMMED_PROFILE。
+#define MQTT_ROOT_CA_CERTIFICATE  ""  // 代理证书的根 CA
+#define MQTT_CLIENT_CERTIFICATE   ""  // 代理要求双向认证时填写
+#define MQTT_CLIENT_PRIVATE_KEY   ""
+#define MQTT_SNI_HOST_NAME        ""  // 代理证书中的主机名 (MQTT_BROKER_ADDRESS 为 IP 地址时用于 SNI)
+
+// 服务端流控和质量档位命令 (见 server_control.h)，设备以 QoS1 订阅 "<此主题>/<客户端 ID>"
+#define MQTT_TOPIC_CONTROL            "audio/control"
+
+// 多块板对齐采集的时钟同步 (见 clock_sync.h)：同步后帧头 timestamp_ms 为服务端时间，并置 AUDIO_FRAME_FLAG_SERVER_TIME
+#define MQTT_TOPIC_CLOCK              "audio/clock"          // 设备发布同步请求到 "<此主题>/<客户端 ID>"
+#define MQTT_TOPIC_CLOCK_REPLY        "audio/clock_reply"    // 服务端回复到 "<此主题>/<客户端 ID>"
+#define CLOCK_SYNC_INTERVAL_MS        (1000) // 请求间隔，0 表示关闭
+#define CLOCK_SYNC_SAMPLES_PER_PERIOD (16)   // 每多少次交换取延迟最小的一次进入拟合
+
+// 控制连接的应用层心跳 (见 heartbeat.h)：比 MQTT keep-alive 更快发现无声断开的连接
+#define MQTT_TOPIC_HEARTBEAT          "audio/heartbeat"      // 设备发布到 "<此主题>/<客户端 ID>"
+#define MQTT_TOPIC_HEARTBEAT_ECHO     "audio/heartbeat_echo" // 服务端原样回显到 "<此主题>/<客户端 ID>"
+#define MQTT_HEARTBEAT_INTERVAL_MS    (250)  // 0 表示关闭
+#define MQTT_HEARTBEAT_TIMEOUT_MS     (2000) // 超过此时间没有回显即断开重连 (1000 ~ 3000)，可用 network_set_heartbeat_timeout_ms() 修改
+
+// 音频发布的可靠性 (见 mqtt_stream.h)
+#ifndef MQTT_AUDIO_QOS                       // 主机检查 (tools/host/test_mqtt_stream.c) 以 -DMQTT_AUDIO_QOS=1 编译
+#define MQTT_AUDIO_QOS                (0)    // 0: 经 cy_mqtt 以 QoS0 发布；1: 经独立的数据连接以 QoS1 发布 (滑动在途窗口 + 重传)
+#endif
+#define MQTT_STREAM_INFLIGHT_WINDOW   (8)    // QoS1 时最多未收到 PUBACK 的发布数，这些帧在确认前保留在帧缓冲池中
+#define MQTT_STREAM_RETRANSMIT_MS     (3000) // 在途发布超过此时间仍未确认则带 DUP 标志重传
+#define MQTT_STREAM_KEEP_ALIVE_SEC    (60)
+#define MQTT_AUDIO_FAST_PATH          (1)    // 1: QoS0 音频也经数据连接发布 (预编码报头、零拷贝单次发送)；TLS 时自动退回 cy_mqtt
+#if (MQTT_AUDIO_QOS == 1) || ((MQTT_AUDIO_FAST_PATH == 1) && (MQTT_SECURE_CONNECTION == 0))
+#define MQTT_AUDIO_DATA_CONNECTION    (1)    // 音频经 mqtt_stream.c 的数据连接发布
+#else
+#define MQTT_AUDIO_DATA_CONNECTION    (0)
+#endif
+
+// 实时音频的传输方式 (见 udp_stream.h)
+#define AUDIO_TRANSPORT_MQTT          (0)    // 实时帧发布到 MQTT_TOPIC_AUDIO_STREAM
+#define AUDIO_TRANSPORT_UDP           (1)    // 实时帧以类 RTP 数据报发往当前代理的 AUDIO_UDP_PORT，积压帧和控制仍走 MQTT
+#define AUDIO_TRANSPORT               AUDIO_TRANSPORT_MQTT
+#define AUDIO_UDP_PORT                (5004)
+#define MQTT_TOPIC_AUDIO_FEEDBACK     "audio/feedback" // UDP 接收端的丢包报告，设备订阅 "<此主题>/<客户端 ID>"
+#if (MQTT_AUDIO_QOS == 0) || (AUDIO_TRANSPORT == AUDIO_TRANSPORT_UDP)
+#define AUDIO_LIVE_FEC                (1)    // 实时通道没有重传，可以启用 FEC
+#else
+#define AUDIO_LIVE_FEC                (0)
+#endif
+#define MQTT_AUDIO_FEC_GROUP_SIZE_DEFAULT (0) // 实时通道每 N 帧发送一个 XOR 校验包 (见 fec.h)，0 表示关闭；可用 network_set_fec_group_size() 切换
+#if (MQTT_AUDIO_QOS == 1)
+#define MQTT_AUDIO_INFLIGHT_FRAMES    MQTT_STREAM_INFLIGHT_WINDOW
+#else
+#define MQTT_AUDIO_INFLIGHT_FRAMES    (0)
+#endif
+
+// 应用层逐帧加密 (见 payload_crypto.h)：不使用 TLS 时保护音频负载，负载在帧缓冲中原地加密，每帧多 24 字节
+#ifndef AUDIO_PAYLOAD_ENCRYPTION             // 主机检查 (tools/host/test_payload_crypto.c) 以 -DAUDIO_PAYLOAD_ENCRYPTION=1 编译
+#define AUDIO_PAYLOAD_ENCRYPTION      (0)    // 0: 关闭；1: AES-256-GCM (硬件加速)；2: ChaCha20-Poly1305 (须在 mbedTLS 中启用)
+#endif
+// 与接收端共享的 32 字节密钥 (占位符，量产时应按设备配置)
+#define AUDIO_PAYLOAD_KEY             { 0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x0a, 0x0b, 0x0c, 0x0d, 0x0e, 0x0f, \
+                                        0x10, 0x11, 0x12, 0x13, 0x14, 0x15, 0x16, 0x17, 0x18, 0x19, 0x1a, 0x1b, 0x1c, 0x1d, 0x1e, 0x1f }
+
+// 已录制会议的 HTTP 批量上传 (见 http_upload.h)。固件中还没有已录制会议的存储可作为数据源，默认不编入
+// (关闭时不占用分段缓冲的约 9 KB SRAM)；接入数据源后置 1 并调用 http_upload_start()
+#ifndef HTTP_UPLOAD_ENABLE                   // 主机检查 (tools/host/test_http_upload.c) 以 -DHTTP_UPLOAD_ENABLE=1 编译
+#define HTTP_UPLOAD_ENABLE            (0)
+#endif
+#ifndef HTTP_UPLOAD_HOST                     // 主机检查改为本机的替身服务端
+#define HTTP_UPLOAD_HOST              MQTT_BROKER_ADDRESS
+#endif
+#define HTTP_UPLOAD_PORT              (8080)
+#define HTTP_UPLOAD_PATH              "/meetings" // 上传到 <此路径>/<meeting_id>
 
 // Wi-Fi 配置 (占位符，后续需要用户配置)
 #define WIFI_SSID                 "Meeting_Assistant"
 #define WIFI_PASSWORD             "12345678"
 #define WIFI_SECURITY             CY_WCM_SECURITY_WPA2_AES_PSK // 根据实际情况修改
+#define WIFI_FAST_RECONNECT       (1)    // 把上次的 BSSID、信道和 DHCP 租约存入闪存，先直接关联，失败再扫描 (见 wifi_cache.h)
  
 // 用户界面
 // LED4 (CY8CPROTO-062-4343W 上的用户 LED 是 P13.7，低电平有效)
@@ -63,16 +150,52 @@
 #define AUDIO_TASK_PRIORITY       (tskIDLE_PRIORITY + 3)
 #define UI_TASK_PRIORITY          (tskIDLE_PRIORITY + 3) // UI 任务具有较高优先级以确保响应性
 #define NETWORK_TASK_PRIORITY     (tskIDLE_PRIORITY + 1) // 网络任务优先级较低
+// 启动期间网络任务的优先级：WCM 初始化和首次连接是启动的关键路径，且大部分时间阻塞在 SDIO 和 WHD 上，
+// 先于音频/UI 初始化开始可以让两者重叠。首次连接结束后降回 NETWORK_TASK_PRIORITY。
+#define NETWORK_TASK_BOOT_PRIORITY (tskIDLE_PRIORITY + 4)
 
 // 任务堆栈大小
 #define AUDIO_TASK_STACK_SIZE     (1024 * 2)
 #define NETWORK_TASK_STACK_SIZE   (1024 * 4) // MQTT/WCM 可能需要更大堆栈
 #define UI_TASK_STACK_SIZE        (1024 * 4)
+#define HEAP_GUARD_RESET_ON_VIOLATION (1) // 音频/UI 任务或中断中出现堆分配时写下记录并复位 (见 heap_guard.h)，0 时只计数和记录
 
 // 队列长度
-#define AUDIO_QUEUE_LENGTH        (50) // 可容纳5个音频帧
+#define AUDIO_QUEUE_LENGTH        (50) // 可容纳50个音频帧 (队列中只存放帧指针)
+#define AUDIO_BACKLOG_LENGTH      (25) // 网络任务积压通道的容量 (帧)，满时丢弃最旧的积压帧
+#define AUDIO_FRAME_POOL_SIZE     (AUDIO_QUEUE_LENGTH + 2 + MQTT_AUDIO_INFLIGHT_FRAMES + AUDIO_BACKLOG_LENGTH + AUDIO_FANOUT_DEPTH) // 帧缓冲池：队列中的帧 + 正在封包的一帧 + 正在发布的一帧 + 等待 PUBACK 的帧 + 积压帧 + 只被扇出 sink 持有的帧
 #define UI_EVENT_QUEUE_LENGTH     (10)
 #define NETWORK_STATUS_QUEUE_LENGTH (5)
 
+// 实时/积压两级调度 (network_task.c)
+#define AUDIO_LIVE_MAX_AGE_MS     (500)   // 出队时帧龄不超过此值的帧走实时通道，否则转入积压通道
+#define AUDIO_BACKLOG_MAX_AGE_MS  (60000) // 超过此帧龄的积压帧直接丢弃
+#define AUDIO_BACKLOG_SHARE_PCT   (50)    // 积压补发可使用的剩余带宽百分比，可用 network_set_backlog_share_pct() 调整
+
+// 扇出 (见 frame_fanout.h)：实时和积压通道发布的每一帧再零拷贝地分发给额外的 sink (归档主题、network_add_frame_sink() 注册的本地存储等)
+#define AUDIO_FANOUT_DEPTH        (0)     // 共享帧环的深度 (帧，最大 FRAME_FANOUT_MAX_DEPTH)，帧缓冲池相应增加；0 表示关闭，建议 8
+#define AUDIO_FANOUT_ARCHIVE      (1)     // 启用扇出时把每帧以 QoS0 发布到 MQTT_TOPIC_AUDIO_ARCHIVE (有数据连接时经数据连接，不复制负载)
+#define AUDIO_FANOUT_SINK_BURST   (4)     // 每轮每个 sink 最多处理的帧数，慢 sink 不占满网络任务
+
+// 音频流水线过载策略与背压
+#define AUDIO_OVERLOAD_POLICY_DEFAULT       AUDIO_OVERLOAD_DROP_OLDEST // 帧缓冲耗尽时的默认策略，见 audio_overload_policy_t
+#define AUDIO_BACKPRESSURE_ELEVATED_PCT     (50) // 队列占用达到此百分比时进入 ELEVATED
+#define AUDIO_BACKPRESSURE_CRITICAL_PCT     (85) // 队列占用达到此百分比时进入 CRITICAL
+#define AUDIO_BACKPRESSURE_HYSTERESIS_PCT   (15) // 占用需回落到阈值以下这么多才降级，避免来回抖动
+// 上行码率自适应 (见 rate_control.h)。启用时由网络任务按估计带宽切换采样率和格式，音频任务不再自行降级。
+#define AUDIO_RATE_CONTROL                  (1)
+#define AUDIO_RATE_CONTROL_REDUCED_SAMPLE_RATE (8000u) // PCM 降采样率档位
+#if (AUDIO_RATE_CONTROL == 1)
+#define AUDIO_BACKPRESSURE_FALLBACK_SAMPLE_RATE (0u)
+#else
+#define AUDIO_BACKPRESSURE_FALLBACK_SAMPLE_RATE (8000u) // CRITICAL 时音频任务自动切换到的输出采样率，0 表示不自动降级
+#endif
+
+// 上行数据格式：AUDIO_FRAME_FORMAT_PCM_S16LE 或 AUDIO_FRAME_FORMAT_LOGMEL_U8 (参数见 log_mel.h)，可用 audio_set_stream_format() 在运行时切换
+#define AUDIO_STREAM_FORMAT_DEFAULT         AUDIO_FRAME_FORMAT_PCM_S16LE
+
+// 说话人切换检测 (参数见 speaker_change.h)
+#define AUDIO_SPEAKER_CHANGE_DETECTION      (1)  // 1: 默认启用，检测结果以 AUDIO_FRAME_FLAG_SPEAKER_CHANGE 标在帧头
+
 
 #endif /* APP_CONFIG_H_ */ 
\ No newline at end of file
@@ -1,57 +1,335 @@
 #include "audio_task.h"
 #include "app_config.h"
 #include "state_machine.h"
+#include "resampler.h"
+#include "speaker_change.h"
+#include "log_mel.h"
+#include "boot_profile.h"
+#include "frame_pool.h"
 #include "cyhal.h"
 #include "cybsp.h"
 #include "FreeRTOS.h"
 #include "task.h"
 #include <stdio.h> // 用于 printf，替换为适当的日志记录
+#include <string.h>
 
 // 日志记录占位符 - 替换为适当的日志记录机制
 #define APP_LOG_AUDIO_INFO(format, ...) printf("[AUDIO] " format "\n", ##__VA_ARGS__)
 #define APP_LOG_AUDIO_ERROR(format, ...) printf("[AUDIO ERROR] " format "\n", ##__VA_ARGS__)
 
 QueueHandle_t audio_queue = NULL;
+static StaticQueue_t audio_queue_struct;
+static uint8_t audio_queue_storage[AUDIO_FRAME_POOL_SIZE * sizeof(audio_data_t *)];
 
 static cyhal_pdm_pcm_t pdm_pcm_obj;
 static cyhal_clock_t audio_clock_obj;
 static cyhal_clock_t pll_clock_obj; 
 
-// 用于 PDM/PCM 数据采集的乒乓缓冲器
-// AUDIO_SAMPLES_PER_FRAME 用于单通道采样点数，缓冲区保存交错的立体声数据。
-static int16_t pdm_pcm_buffer[AUDIO_SAMPLES_PER_FRAME * AUDIO_CHANNELS]; 
-
-static volatile bool is_recording = false;
+// 用于 PDM/PCM 数据采集的乒乓缓冲器 (按最大帧长分配，采集采样率下的一帧)
+// ISR 在一半写满后立即在另一半上启动下一次异步读取，音频任务随后处理写满的一半。
+// 缓冲区保存交错的立体声数据。
+static int16_t pdm_pcm_buffer[2][AUDIO_CAPTURE_SAMPLES_PER_FRAME * AUDIO_CHANNELS]; 
+static volatile uint32_t capture_buffer_index = 0;   // PDM 当前正在写入的一半
+static volatile uint32_t capture_pending_mask = 0;   // 已写满、等待音频任务处理的一半 (bit0/bit1)
+static volatile uint32_t capture_timestamp_ms[2];    // 每一半写满时的系统节拍
+static volatile uint32_t capture_length[2];          // 每一半本次读取的采样点数 (每通道)，随帧长变化
+static volatile uint32_t frame_duration_ms = AUDIO_FRAME_DURATION_MS; // 由 audio_set_frame_duration_ms() 写入，ISR 启动下一次读取时采用
+
+static volatile bool is_recording = false;           // PDM 正在采集，由音频任务和 ISR 写入
+static volatile bool recording_requested = false;    // 调用者要求的状态，由 audio_start/stop_recording() 写入
+static volatile uint32_t recording_generation = 0;   // 每次 audio_start_recording() 加一，音频任务据此发现重新开始
 static volatile bool audio_initialized = false;
+static TaskHandle_t audio_task_handle = NULL;
+
+// 每个通道一个重采样器，状态跨帧保存
+static resampler_t resamplers[AUDIO_CHANNELS];
+static uint32_t output_sample_rate = 0;                             // 当前生效的输出采样率 (仅音频任务访问)
+static volatile uint32_t requested_output_sample_rate = AUDIO_SAMPLE_RATE; // 由 audio_set_output_sample_rate() 写入
+static uint32_t frame_sequence = 0;
+
+// 说话人切换检测器，工作在输出采样率上 (通道 0)
+static speaker_change_t speaker_change;
+static bool speaker_change_ready = false;           // 当前输出采样率下检测器是否可用
+static volatile bool speaker_change_enabled = (AUDIO_SPEAKER_CHANGE_DETECTION != 0);
+
+// log-mel 特征流，工作在输出采样率上 (通道 0)。每个音频帧的特征先写入 log_mel_output，再拷入帧缓冲
+static log_mel_t log_mel;
+static bool log_mel_ready = false;                  // 当前输出采样率下特征提取是否可用
+static uint8_t stream_format = AUDIO_FRAME_FORMAT_PCM_S16LE; // 当前生效的上行格式 (仅音频任务访问)
+static volatile uint8_t requested_stream_format = AUDIO_STREAM_FORMAT_DEFAULT;
+#define LOG_MEL_MAX_FRAMES_PER_FRAME  ((AUDIO_MAX_FRAME_DURATION_MS / LOG_MEL_HOP_MS) + 1)
+static uint8_t log_mel_output[LOG_MEL_MAX_FRAMES_PER_FRAME][LOG_MEL_BANDS];
+
+// 帧缓冲池：所有帧都按最大帧长分配，free_frame_queue 保存空闲帧的指针 (见 frame_pool.h)。
+// audio_queue 只传递指针，队列项大小与帧长无关。
+#if AUDIO_FRAME_POOL_SIZE > FRAME_POOL_MAX_FRAMES
+#error "AUDIO_FRAME_POOL_SIZE exceeds FRAME_POOL_MAX_FRAMES"
+#endif
+static audio_data_t frame_buffers[AUDIO_FRAME_POOL_SIZE];
+static frame_pool_t frame_pool;
+static QueueHandle_t free_frame_queue = NULL;
+static StaticQueue_t free_frame_queue_struct;
+static uint8_t free_frame_queue_storage[AUDIO_FRAME_POOL_SIZE * sizeof(audio_data_t *)];
+
+// 过载策略与背压
+static volatile audio_overload_policy_t overload_policy = AUDIO_OVERLOAD_POLICY_DEFAULT;
+static volatile audio_backpressure_level_t backpressure_level = AUDIO_BACKPRESSURE_NONE;
+static volatile audio_backpressure_callback_t backpressure_callback = NULL;
+static uint32_t backpressure_saved_sample_rate = 0; // 因 CRITICAL 自动降级前的输出采样率，0 表示未降级
+
+static audio_pipeline_stats_t pipeline_stats;
 
 // PDM/PCM 数据采集回调函数
 static void pdm_pcm_isr_handler(void *callback_arg, cyhal_pdm_pcm_event_t event) {
+    (void)callback_arg;
     if (event == CYHAL_PDM_PCM_ASYNC_COMPLETE) {
-        if (is_recording && audio_queue != NULL) {
-            audio_data_t audio_frame;
-            // pdm_pcm_buffer 现在包含新的一帧交错立体声采样数据。
-            // 如果配置为立体声，PDM 驱动程序会以交错立体声格式存储数据。
-            memcpy(audio_frame.samples, pdm_pcm_buffer, AUDIO_BUFFER_SIZE_BYTES);
-            audio_frame.num_samples = AUDIO_SAMPLES_PER_FRAME; // 每通道采样点数
-
-            if (xQueueSendFromISR(audio_queue, &audio_frame, NULL) != pdPASS) {
-                // APP_LOG_AUDIO_ERROR("从 ISR 发送音频帧到队列失败");
-                // ISR 不应直接调用阻塞函数，如 printf 或大多数日志记录函数。
-                // 如果需要，请考虑使用其他机制从 ISR 报告错误。
-            }
-        }
+        uint32_t filled = capture_buffer_index;
 
-        // 如果仍在录制，则安排下一次异步读取
+        // 如果仍在录制，则立即在另一半缓冲区上安排下一次异步读取，避免采集出现间隙
         if (is_recording) {
-            cy_rslt_t result = cyhal_pdm_pcm_read_async(&pdm_pcm_obj, pdm_pcm_buffer, AUDIO_SAMPLES_PER_FRAME * AUDIO_CHANNELS);
+            uint32_t next = filled ^ 1u;
+            if (capture_pending_mask & (1u << next)) {
+                // 音频任务还没处理完这一半，新的采集会覆盖它
+                pipeline_stats.capture_overruns++;
+            }
+            // 帧长切换在这里生效：新的读取长度只影响下一半，已写满的一半保持原长度
+            uint32_t length = (AUDIO_CAPTURE_SAMPLE_RATE / 1000u) * frame_duration_ms;
+            capture_buffer_index = next;
+            capture_length[next] = length;
+            cy_rslt_t result = cyhal_pdm_pcm_read_async(&pdm_pcm_obj, pdm_pcm_buffer[next], length * AUDIO_CHANNELS);
             if (result != CY_RSLT_SUCCESS) {
                 // APP_LOG_AUDIO_ERROR("ISR 中的 PDM 异步读取失败：0x%08X", (unsigned int)result);
                 is_recording = false; // 出错时停止录制
             }
+
+            // ISR 中只做最少的工作：标记写满的一半并唤醒音频任务，重采样和入队在任务上下文中完成
+            capture_timestamp_ms[filled] = xTaskGetTickCountFromISR();
+            capture_pending_mask |= (1u << filled);
+            pipeline_stats.frames_captured++;
+            if (audio_task_handle != NULL) {
+                BaseType_t xHigherPriorityTaskWoken = pdFALSE;
+                vTaskNotifyGiveFromISR(audio_task_handle, &xHigherPriorityTaskWoken);
+                portYIELD_FROM_ISR(xHigherPriorityTaskWoken);
+            }
+        }
+    }
+}
+
+// 初始化 DWT 周期计数器，用于测量每帧处理开销
+static void enable_cycle_counter(void) {
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CYCCNT = 0;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+}
+
+// 按当前请求的输出采样率 (重新) 配置每个通道的重采样器和说话人切换检测器，仅在音频任务中、帧边界处调用
+static bool configure_resamplers(uint32_t sample_rate_hz) {
+    for (uint32_t ch = 0; ch < AUDIO_CHANNELS; ch++) {
+        if (!resampler_init(&resamplers[ch], AUDIO_CAPTURE_SAMPLE_RATE, sample_rate_hz)) {
+            APP_LOG_AUDIO_ERROR("Unsupported resampling ratio %lu -> %lu Hz.",
+                                (unsigned long)AUDIO_CAPTURE_SAMPLE_RATE, (unsigned long)sample_rate_hz);
+            return false;
+        }
+    }
+    output_sample_rate = sample_rate_hz;
+
+    // 检测器的分析窗和 mel 刻度依赖采样率，切换后重新开始累积特征
+    speaker_change_ready = speaker_change_init(&speaker_change, sample_rate_hz);
+    if (!speaker_change_ready) {
+        APP_LOG_AUDIO_ERROR("Speaker change detection unavailable at %lu Hz.", (unsigned long)sample_rate_hz);
+    }
+    log_mel_ready = log_mel_init(&log_mel, sample_rate_hz);
+    if (!log_mel_ready) {
+        APP_LOG_AUDIO_ERROR("Log-mel features unavailable at %lu Hz, streaming PCM.", (unsigned long)sample_rate_hz);
+    }
+    APP_LOG_AUDIO_INFO("Output sample rate: %lu Hz (capture %lu Hz, %u taps/phase).",
+                       (unsigned long)sample_rate_hz, (unsigned long)AUDIO_CAPTURE_SAMPLE_RATE,
+                       (unsigned int)resamplers[0].taps_per_phase);
+    return true;
+}
+
+static bool create_frame_pool(void) {
+    free_frame_queue = xQueueCreateStatic(AUDIO_FRAME_POOL_SIZE, sizeof(audio_data_t *), free_frame_queue_storage,
+                                          &free_frame_queue_struct);
+    return frame_pool_init(&frame_pool, frame_buffers, sizeof(audio_data_t), AUDIO_FRAME_POOL_SIZE, free_frame_queue,
+                           audio_queue);
+}
+
+bool audio_create_queues(void) {
+    // 队列存储 audio_data_t 指针，帧本身来自帧缓冲池。
+    // 队列容量与帧缓冲池相同，因此过载总是表现为帧缓冲池耗尽，由 acquire_frame() 按策略统一处理。
+    // 背压等级仍按 AUDIO_QUEUE_LENGTH 计算占用率。
+    audio_queue = xQueueCreateStatic(AUDIO_FRAME_POOL_SIZE, sizeof(audio_data_t *), audio_queue_storage, &audio_queue_struct);
+    return audio_queue != NULL && create_frame_pool();
+}
+
+// 一帧采集数据 (所有通道) 的平均能量，作为丢帧时衡量“是否有语音”的廉价指标
+static uint32_t capture_energy(const int16_t *samples, uint32_t count) {
+    uint64_t sum = 0;
+    for (uint32_t i = 0; i < count; i++) {
+        sum += (uint32_t)((int32_t)samples[i] * samples[i]);
+    }
+    return (count != 0) ? (uint32_t)(sum / count) : 0;
+}
+
+// 取一个空闲帧；帧缓冲池耗尽时按过载策略从 audio_queue 中挤出一帧复用 (见 frame_pool_acquire())。返回 NULL 表示丢弃新帧。
+static audio_data_t *acquire_frame(uint32_t energy) {
+    bool evicted;
+    audio_data_t *frame = frame_pool_acquire(&frame_pool, energy, (frame_pool_policy_t)overload_policy, &evicted);
+    if (evicted) {
+        pipeline_stats.frames_evicted++;
+        pipeline_stats.frames_dropped++;
+    }
+    return frame;
+}
+
+// 按 audio_queue 占用率更新背压等级。上升立即生效，下降需回落到阈值以下 AUDIO_BACKPRESSURE_HYSTERESIS_PCT。
+static void update_backpressure(void) {
+    uint32_t occupancy_pct = (uint32_t)uxQueueMessagesWaiting(audio_queue) * 100u / AUDIO_QUEUE_LENGTH;
+    audio_backpressure_level_t level = backpressure_level;
+
+    if (occupancy_pct >= AUDIO_BACKPRESSURE_CRITICAL_PCT) {
+        level = AUDIO_BACKPRESSURE_CRITICAL;
+    } else if (occupancy_pct >= AUDIO_BACKPRESSURE_ELEVATED_PCT) {
+        if (level == AUDIO_BACKPRESSURE_NONE ||
+            occupancy_pct + AUDIO_BACKPRESSURE_HYSTERESIS_PCT < AUDIO_BACKPRESSURE_CRITICAL_PCT) {
+            level = AUDIO_BACKPRESSURE_ELEVATED;
         }
+    } else if (occupancy_pct + AUDIO_BACKPRESSURE_HYSTERESIS_PCT < AUDIO_BACKPRESSURE_ELEVATED_PCT) {
+        level = AUDIO_BACKPRESSURE_NONE;
+    } else if (level == AUDIO_BACKPRESSURE_CRITICAL) {
+        level = AUDIO_BACKPRESSURE_ELEVATED;
+    }
+
+    if (level == backpressure_level) {
+        return;
+    }
+    APP_LOG_AUDIO_INFO("Backpressure %d -> %d (queue %lu%%).", (int)backpressure_level, (int)level, (unsigned long)occupancy_pct);
+    backpressure_level = level;
+    if (level == AUDIO_BACKPRESSURE_CRITICAL) {
+        pipeline_stats.backpressure_events++;
+    }
+
+#if AUDIO_BACKPRESSURE_FALLBACK_SAMPLE_RATE != 0
+    // 内置的降级：CRITICAL 时降低输出采样率以减小负载，完全恢复后还原 (期间用户改过采样率则不还原)
+    if (level == AUDIO_BACKPRESSURE_CRITICAL && backpressure_saved_sample_rate == 0 &&
+        requested_output_sample_rate > AUDIO_BACKPRESSURE_FALLBACK_SAMPLE_RATE) {
+        backpressure_saved_sample_rate = requested_output_sample_rate;
+        requested_output_sample_rate = AUDIO_BACKPRESSURE_FALLBACK_SAMPLE_RATE;
+    } else if (level == AUDIO_BACKPRESSURE_NONE && backpressure_saved_sample_rate != 0) {
+        if (requested_output_sample_rate == AUDIO_BACKPRESSURE_FALLBACK_SAMPLE_RATE) {
+            requested_output_sample_rate = backpressure_saved_sample_rate;
+        }
+        backpressure_saved_sample_rate = 0;
+    }
+#endif
+
+    audio_backpressure_callback_t callback = backpressure_callback;
+    if (callback != NULL) {
+        callback(level);
     }
 }
 
+// 将一帧采集数据重采样到输出采样率，封装帧头后送入 audio_queue
+static void process_capture_buffer(uint32_t index) {
+    uint32_t start_cycles = DWT->CYCCNT;
+
+    // 采样率切换只在帧边界生效，保证每帧的帧头与采样点数一致
+    uint32_t requested = requested_output_sample_rate;
+    if (requested != output_sample_rate) {
+        if (!configure_resamplers(requested)) {
+            requested_output_sample_rate = output_sample_rate;
+        }
+    }
+    uint8_t format = requested_stream_format;
+    if (format != stream_format) {
+        // 特征缓冲中是旧格式下的样本，切换时从零开始
+        log_mel_reset(&log_mel);
+        stream_format = format;
+    }
+
+    const int16_t *capture = pdm_pcm_buffer[index];
+    uint32_t in_count = capture_length[index];
+    size_t out_count = resampler_output_count(&resamplers[0], in_count);
+    if (out_count > AUDIO_SAMPLES_PER_FRAME) {
+        // 不应发生：audio_set_output_sample_rate() 与 audio_set_frame_duration_ms() 已限制输出帧大小
+        APP_LOG_AUDIO_ERROR("Resampler output (%u) exceeds frame capacity.", (unsigned int)out_count);
+        return;
+    }
+
+    uint32_t energy = capture_energy(capture, in_count * AUDIO_CHANNELS);
+    audio_data_t *frame = acquire_frame(energy);
+    if (frame == NULL) {
+        // 帧缓冲池耗尽 (网络任务积压) 且策略选择丢弃新帧。输出本来就不连续了，复位重采样历史；
+        // 说话人切换检测和 log-mel 的分析窗也会跨过缺口，一并从零开始
+        pipeline_stats.frames_dropped++;
+        frame_sequence++;
+        for (uint32_t ch = 0; ch < AUDIO_CHANNELS; ch++) {
+            resampler_reset(&resamplers[ch]);
+        }
+        speaker_change_reset(&speaker_change);
+        log_mel_reset(&log_mel);
+        update_backpressure();
+        return;
+    }
+    for (uint32_t ch = 0; ch < AUDIO_CHANNELS; ch++) {
+        out_count = resampler_process(&resamplers[ch],
+                                      capture + ch, in_count, AUDIO_CHANNELS,
+                                      frame->samples + ch, AUDIO_CHANNELS);
+    }
+
+    uint8_t flags = 0;
+    if (speaker_change_enabled && speaker_change_ready &&
+        speaker_change_process(&speaker_change, frame->samples, out_count, AUDIO_CHANNELS)) {
+        flags |= AUDIO_FRAME_FLAG_SPEAKER_CHANGE;
+    }
+
+    uint8_t channels = AUDIO_CHANNELS;
+    uint8_t frame_format = AUDIO_FRAME_FORMAT_PCM_S16LE;
+    if (stream_format == AUDIO_FRAME_FORMAT_LOGMEL_U8 && log_mel_ready &&
+        log_mel_output_count(&log_mel, out_count) <= LOG_MEL_MAX_FRAMES_PER_FRAME) {
+        // 用通道 0 计算特征，替换掉帧中的 PCM (特征远小于 PCM，不会越界)
+        out_count = log_mel_process(&log_mel, frame->samples, out_count, AUDIO_CHANNELS, &log_mel_output[0][0]);
+        memcpy(frame->features, log_mel_output, out_count * LOG_MEL_BANDS);
+        channels = 1;
+        frame_format = AUDIO_FRAME_FORMAT_LOGMEL_U8;
+    }
+
+    frame->header.version = AUDIO_FRAME_HEADER_VERSION;
+    frame->header.flags = flags;
+    frame->header.channels = channels;
+    frame->header.format = frame_format;
+    frame->header.sample_rate_hz = (uint16_t)output_sample_rate;
+    frame->header.num_samples = (uint16_t)out_count; // 每通道采样点数或特征帧数，随帧长变化
+    frame->header.sequence = frame_sequence++;
+    frame->header.timestamp_ms = capture_timestamp_ms[index];
+
+    if (xQueueSend(audio_queue, &frame, 0) == pdPASS) {
+        pipeline_stats.frames_queued++;
+    } else {
+        audio_release_frame(frame);
+        pipeline_stats.frames_dropped++;
+    }
+    update_backpressure();
+
+    uint32_t cycles = DWT->CYCCNT - start_cycles;
+    pipeline_stats.process_cycles_last = cycles;
+    if (cycles > pipeline_stats.process_cycles_max) {
+        pipeline_stats.process_cycles_max = cycles;
+    }
+}
+
+static void log_pipeline_stats(void) {
+    audio_pipeline_stats_t stats;
+    audio_get_pipeline_stats(&stats);
+    APP_LOG_AUDIO_INFO("Frames: captured %lu, queued %lu, dropped %lu (evicted %lu), overruns %lu, backpressure %d. Cycles/frame: last %lu, max %lu (%lu MHz core).",
+                       (unsigned long)stats.frames_captured, (unsigned long)stats.frames_queued,
+                       (unsigned long)stats.frames_dropped, (unsigned long)stats.frames_evicted,
+                       (unsigned long)stats.capture_overruns, (int)backpressure_level,
+                       (unsigned long)stats.process_cycles_last, (unsigned long)stats.process_cycles_max,
+                       (unsigned long)(SystemCoreClock / 1000000u));
+}
+
 static cy_rslt_t initialize_audio_clocks(void) {
     // 基于 Audio_Streaming 示例
     cy_rslt_t result;
@@ -115,7 +393,7 @@ static cy_rslt_t initialize_audio_clocks(void) {
 
 static cy_rslt_t initialize_pdm_pcm(void) {
     const cyhal_pdm_pcm_cfg_t pdm_pcm_cfg = {
-        .sample_rate = AUDIO_SAMPLE_RATE,
+        .sample_rate = AUDIO_CAPTURE_SAMPLE_RATE, // 以较高采样率采集，再由重采样器转换到输出采样率
         .decimation_rate = 64, // 常用值，PDM_CLK = 采样率 * 抽取率
         .mode = AUDIO_MODE, // 根据 story.md (双麦克风) 和 kit_info.md (共享数据线)
         .word_length = AUDIO_BIT_RESOLUTION, // 位
@@ -145,49 +423,159 @@ static cy_rslt_t initialize_pdm_pcm(void) {
     return CY_RSLT_SUCCESS;
 }
 
+// 按采集顺序处理所有已写满的一半
+static void drain_capture_buffers(uint32_t *next_index) {
+    while (capture_pending_mask & (1u << *next_index)) {
+        process_capture_buffer(*next_index);
+        taskENTER_CRITICAL();
+        capture_pending_mask &= ~(1u << *next_index);
+        taskEXIT_CRITICAL();
+        *next_index ^= 1u;
+    }
+}
+
+static void end_capture(void) {
+    is_recording = false; // ISR 将看到此标志并停止链接读取
+
+    // 首先尝试中止任何正在进行的异步操作
+    cy_rslt_t abort_result = cyhal_pdm_pcm_abort_async(&pdm_pcm_obj);
+    if (abort_result != CY_RSLT_SUCCESS) {
+        // 没有正在进行的异步操作时 abort 也会报错，这不是关键问题，关键是确保它被调用了
+        APP_LOG_AUDIO_INFO("PDM/PCM abort_async result: 0x%08X (may be OK if no async was pending)", (unsigned int)abort_result);
+    }
+
+    // 然后停止 PDM/PCM 硬件
+    cy_rslt_t stop_result = cyhal_pdm_pcm_stop(&pdm_pcm_obj);
+    if (stop_result != CY_RSLT_SUCCESS) {
+        APP_LOG_AUDIO_ERROR("PDM/PCM stop failed: 0x%08X", (unsigned int)stop_result);
+    }
+}
+
+// 从第一半开始一段新的采集。PDM 此时没有运行，ISR 不会并发修改采集状态
+static void begin_capture(void) {
+    // 清除 PDM 外设 FIFO 中的任何挂起数据
+    cyhal_pdm_pcm_clear(&pdm_pcm_obj);
+
+    // 重新开始时清空重采样历史，避免把上一段录音的尾巴混进新的录音
+    for (uint32_t ch = 0; ch < AUDIO_CHANNELS; ch++) {
+        resampler_reset(&resamplers[ch]);
+    }
+    speaker_change_reset(&speaker_change);
+    log_mel_reset(&log_mel);
+    capture_buffer_index = 0;
+    capture_pending_mask = 0;
+    capture_length[0] = (AUDIO_CAPTURE_SAMPLE_RATE / 1000u) * frame_duration_ms;
+    taskENTER_CRITICAL();
+    memset(&pipeline_stats, 0, sizeof(pipeline_stats));
+    taskEXIT_CRITICAL();
+    backpressure_level = AUDIO_BACKPRESSURE_NONE;
+    if (backpressure_saved_sample_rate != 0) {
+        // 上次录音停止时仍处于自动降级状态，新录音从原采样率开始
+        if (requested_output_sample_rate == AUDIO_BACKPRESSURE_FALLBACK_SAMPLE_RATE) {
+            requested_output_sample_rate = backpressure_saved_sample_rate;
+        }
+        backpressure_saved_sample_rate = 0;
+    }
+
+    is_recording = true;
+
+    // 首先发起第一次异步读取
+    cy_rslt_t result = cyhal_pdm_pcm_read_async(&pdm_pcm_obj, pdm_pcm_buffer[0], capture_length[0] * AUDIO_CHANNELS);
+    if (result != CY_RSLT_SUCCESS) {
+        APP_LOG_AUDIO_ERROR("Initial PDM async read failed: 0x%08X", (unsigned int)result);
+        is_recording = false; // PDM 还未启动，不需要 stop
+        return;
+    }
+
+    // 然后启动 PDM/PCM 操作
+    result = cyhal_pdm_pcm_start(&pdm_pcm_obj);
+    if (result != CY_RSLT_SUCCESS) {
+        APP_LOG_AUDIO_ERROR("PDM/PCM start failed: 0x%08X", (unsigned int)result);
+        is_recording = false;
+        cyhal_pdm_pcm_abort_async(&pdm_pcm_obj); // 尝试中止挂起的异步读取
+    }
+}
+
+// 把调用者的启动/停止请求应用到 PDM。停止后先处理完上一段录音剩下的一半；
+// 在一次等待中先停止再启动 (generation 变化) 时，同样先停止再从第一半重新开始，
+// next_index 与 ISR 写入的顺序因此总是一致，DSP 状态也只在本任务中复位。
+static void apply_recording_request(uint32_t *next_index, uint32_t *active_generation) {
+    bool requested = recording_requested;
+    uint32_t generation = recording_generation;
+
+    if (is_recording && (!requested || generation != *active_generation)) {
+        end_capture();
+        drain_capture_buffers(next_index);
+    }
+    if (requested && !is_recording && generation != *active_generation) {
+        *active_generation = generation;
+        *next_index = 0;
+        begin_capture();
+    }
+}
+
 void audio_task(void *pvParameters) {
     (void)pvParameters;
     cy_rslt_t result;
 
     APP_LOG_AUDIO_INFO("Audio task started.");
 
-    // 创建用于发送音频数据的队列
-    // 缓冲区存储 audio_data_t 结构体。大小在 app_config.h 中定义
-    audio_queue = xQueueCreate(AUDIO_QUEUE_LENGTH, sizeof(audio_data_t));
+    // audio_queue 和帧缓冲池已由 main 在创建任务之前建好 (audio_create_queues())，
+    // 下面的初始化失败时任务退出，队列保留，网络任务只是收不到帧
+    audio_task_handle = xTaskGetCurrentTaskHandle();
+    boot_step_begin(BOOT_STEP_AUDIO_BUFFERS);
     if (audio_queue == NULL) {
-        APP_LOG_AUDIO_ERROR("Failed to create audio queue.");
-        vTaskDelete(NULL); // 或适当处理错误
+        APP_LOG_AUDIO_ERROR("Audio queue or frame pool missing. Deleting task.");
+        vTaskDelete(NULL);
         return;
     }
 
+    // AUDIO_CAPTURE_SAMPLE_RATE 与 AUDIO_SAMPLE_RATE 的比值不受支持属于配置错误
+    if (!configure_resamplers(requested_output_sample_rate)) {
+        APP_LOG_AUDIO_ERROR("Resampler configuration failed. Deleting task.");
+        vTaskDelete(NULL);
+        return;
+    }
+    boot_step_end(BOOT_STEP_AUDIO_BUFFERS);
+
+    boot_step_begin(BOOT_STEP_AUDIO_CLOCKS);
     result = initialize_audio_clocks();
     if (result != CY_RSLT_SUCCESS) {
         APP_LOG_AUDIO_ERROR("Audio clock initialization failed. Deleting task.");
-        vQueueDelete(audio_queue);
-        audio_queue = NULL;
         vTaskDelete(NULL);
         return;
     }
+    boot_step_end(BOOT_STEP_AUDIO_CLOCKS);
 
+    boot_step_begin(BOOT_STEP_PDM);
     result = initialize_pdm_pcm();
     if (result != CY_RSLT_SUCCESS) {
         APP_LOG_AUDIO_ERROR("PDM/PCM initialization failed. Deleting task.");
         // 如果 PDM 初始化失败，则释放时钟
         cyhal_clock_free(&audio_clock_obj);
         cyhal_clock_free(&pll_clock_obj);
-        vQueueDelete(audio_queue);
-        audio_queue = NULL;
         vTaskDelete(NULL);
         return;
     }
+    boot_step_end(BOOT_STEP_PDM);
     
-    // 任务本身在循环中不做太多事情，因为 PDM 是异步的，ISR 处理数据。
-    // 它主要用于初始化和管理音频资源。
-    // 控制函数 (启动/停止) 将管理 'is_recording' 标志和 PDM 外设。
+    enable_cycle_counter();
+
+    // PDM 是异步的，ISR 只负责链接读取；重采样、封包和入队在此循环中完成。
+    // 启动和停止采集也都在这里执行 (见 apply_recording_request())，控制函数只记录请求并唤醒本任务
+    uint32_t next_index = 0;
+    uint32_t active_generation = recording_generation;
+    TickType_t last_stats_log = xTaskGetTickCount();
     while (1) {
-        // 主要工作由 PDM ISR 和控制函数完成。
-        // 如果需要，此任务可以监视命令或执行清理操作。
-        vTaskDelay(pdMS_TO_TICKS(1000)); 
+        ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(1000));
+
+        drain_capture_buffers(&next_index);
+        apply_recording_request(&next_index, &active_generation);
+
+        if (is_recording && (xTaskGetTickCount() - last_stats_log) >= pdMS_TO_TICKS(AUDIO_STATS_LOG_INTERVAL_MS)) {
+            last_stats_log = xTaskGetTickCount();
+            log_pipeline_stats();
+        }
     }
 }
 
@@ -196,69 +584,25 @@ void audio_start_recording(void) {
         APP_LOG_AUDIO_ERROR("Cannot start recording, audio not initialized.");
         return;
     }
-    if (is_recording) {
+    if (recording_requested && is_recording) {
         APP_LOG_AUDIO_INFO("Recording already in progress.");
         return;
     }
 
     APP_LOG_AUDIO_INFO("Starting audio recording...");
-    // 清除 PDM 外设 FIFO 中的任何挂起数据
-    cyhal_pdm_pcm_clear(&pdm_pcm_obj);
-    
-    is_recording = true; // Set recording flag
-
-    // 首先发起第一次异步读取
-    cy_rslt_t result = cyhal_pdm_pcm_read_async(&pdm_pcm_obj, pdm_pcm_buffer, AUDIO_SAMPLES_PER_FRAME * AUDIO_CHANNELS);
-    if (result != CY_RSLT_SUCCESS) {
-        APP_LOG_AUDIO_ERROR("Initial PDM async read failed: 0x%08X", (unsigned int)result);
-        is_recording = false; // Reset flag if read_async fails
-        // 不需要在这里调用 stop，因为 PDM 可能还未成功启动
-        return;
-    }
-
-    // 然后启动 PDM/PCM 操作
-    result = cyhal_pdm_pcm_start(&pdm_pcm_obj);
-    if (result != CY_RSLT_SUCCESS) {
-        APP_LOG_AUDIO_ERROR("PDM/PCM start failed: 0x%08X", (unsigned int)result);
-        is_recording = false; // Reset flag
-        // 如果 start 失败，可能需要中止之前成功的 read_async (如果 HAL 支持 abort 且有必要)
-        // 但通常，如果 start 失败，说明外设本身就有问题，read_async 的回调也不会触发。
-        // For now, just setting is_recording to false and returning should be okay.
-        // The ISR checks is_recording before queueing new reads.
-        cyhal_pdm_pcm_abort_async(&pdm_pcm_obj); // 尝试中止挂起的异步读取
-        return;
-    }
-    // 如果两个调用都成功，录音正式开始，ISR将处理后续的读取
+    recording_requested = true;
+    recording_generation++;
+    xTaskNotifyGive(audio_task_handle);
 }
 
 void audio_stop_recording(void) {
-    if (!audio_initialized || !is_recording) {
+    if (!audio_initialized || !recording_requested) {
         // APP_LOG_AUDIO_INFO("Recording not in progress or audio not initialized.");
         return;
     }
     APP_LOG_AUDIO_INFO("Stopping audio recording...");
-    is_recording = false; // ISR 将看到此标志并停止链接读取
-
-    // 首先尝试中止任何正在进行的异步操作
-    cy_rslt_t abort_result = cyhal_pdm_pcm_abort_async(&pdm_pcm_obj);
-    if (abort_result != CY_RSLT_SUCCESS) {
-        // 如果 abort 失败，可能意味着没有正在进行的异步操作，或者出现了其他错误
-        // 对于 "already in progress" 的问题，即使 abort 报告错误（例如"没有操作可中止"）
-        // 也可能不是关键问题，关键是确保它被调用了。
-        // 可以选择性地打印日志，但主要目标是调用它。
-        APP_LOG_AUDIO_INFO("PDM/PCM abort_async result: 0x%08X (may be OK if no async was pending)", (unsigned int)abort_result);
-    }
-
-    // 然后停止 PDM/PCM 硬件
-    cy_rslt_t stop_result = cyhal_pdm_pcm_stop(&pdm_pcm_obj);
-    if (stop_result != CY_RSLT_SUCCESS) {
-        APP_LOG_AUDIO_ERROR("PDM/PCM stop failed: 0x%08X", (unsigned int)stop_result);
-    }
-    
-    // （可选）可以稍微延迟一下，确保硬件和HAL状态有时间更新
-    // vTaskDelay(pdMS_TO_TICKS(1)); // 非常短的延迟，作为诊断手段
-
-    // 如果需要，可选择清除队列，但通常应由消费者耗尽队列
+    recording_requested = false;
+    xTaskNotifyGive(audio_task_handle);
 }
 
 void audio_pause_recording(void) {
@@ -305,4 +649,94 @@ void audio_set_mic_volume(uint8_t percentage) {
     // APP_LOG_AUDIO_ERROR("设置 PDM 增益失败：0x%08X", (unsigned int)result);
     // }
     APP_LOG_AUDIO_INFO("Note: Actual dynamic gain control via cyhal_pdm_pcm_set_gain() needs validation and careful mapping.");
-} 
\ No newline at end of file
+} 
+
+bool audio_set_output_sample_rate(uint32_t sample_rate_hz) {
+    // 输出帧按 AUDIO_MAX_OUTPUT_SAMPLE_RATE 分配，且任意允许的帧长都必须是整数个输出采样点，帧头才能与负载长度保持一致
+    if (sample_rate_hz == 0 || sample_rate_hz > AUDIO_MAX_OUTPUT_SAMPLE_RATE ||
+        ((sample_rate_hz * AUDIO_MIN_FRAME_DURATION_MS) % 1000u) != 0 ||
+        !resampler_is_supported(AUDIO_CAPTURE_SAMPLE_RATE, sample_rate_hz)) {
+        APP_LOG_AUDIO_ERROR("Output sample rate %lu Hz not supported.", (unsigned long)sample_rate_hz);
+        return false;
+    }
+    requested_output_sample_rate = sample_rate_hz;
+    APP_LOG_AUDIO_INFO("Output sample rate %lu Hz requested, applies at next frame boundary.", (unsigned long)sample_rate_hz);
+    return true;
+}
+
+uint32_t audio_get_output_sample_rate(void) {
+    return requested_output_sample_rate;
+}
+
+bool audio_set_frame_duration_ms(uint32_t duration_ms) {
+    if (duration_ms < AUDIO_MIN_FRAME_DURATION_MS || duration_ms > AUDIO_MAX_FRAME_DURATION_MS ||
+        (duration_ms % AUDIO_MIN_FRAME_DURATION_MS) != 0) {
+        APP_LOG_AUDIO_ERROR("Frame duration %lu ms not supported.", (unsigned long)duration_ms);
+        return false;
+    }
+    frame_duration_ms = duration_ms;
+    APP_LOG_AUDIO_INFO("Frame duration %lu ms requested, applies to the next PDM read.", (unsigned long)duration_ms);
+    return true;
+}
+
+uint32_t audio_get_frame_duration_ms(void) {
+    return frame_duration_ms;
+}
+
+void audio_set_overload_policy(audio_overload_policy_t policy) {
+    overload_policy = policy;
+    APP_LOG_AUDIO_INFO("Overload policy set to %d.", (int)policy);
+}
+
+audio_overload_policy_t audio_get_overload_policy(void) {
+    return overload_policy;
+}
+
+audio_backpressure_level_t audio_get_backpressure_level(void) {
+    return backpressure_level;
+}
+
+void audio_register_backpressure_callback(audio_backpressure_callback_t callback) {
+    backpressure_callback = callback;
+}
+
+bool audio_set_stream_format(uint8_t format) {
+    if (format != AUDIO_FRAME_FORMAT_PCM_S16LE && format != AUDIO_FRAME_FORMAT_LOGMEL_U8) {
+        APP_LOG_AUDIO_ERROR("Stream format %u not supported.", (unsigned int)format);
+        return false;
+    }
+    requested_stream_format = format;
+    APP_LOG_AUDIO_INFO("Stream format %u requested, applies at next frame boundary.", (unsigned int)format);
+    return true;
+}
+
+uint8_t audio_get_stream_format(void) {
+    return requested_stream_format;
+}
+
+void audio_set_speaker_change_detection(bool enable) {
+    speaker_change_enabled = enable;
+    APP_LOG_AUDIO_INFO("Speaker change detection %s.", enable ? "enabled" : "disabled");
+}
+
+bool audio_get_speaker_change_detection(void) {
+    return speaker_change_enabled;
+}
+
+uint32_t audio_get_speaker_change_latency_ms(void) {
+    return speaker_change_latency_ms(&speaker_change);
+}
+
+void audio_retain_frame(audio_data_t *frame) {
+    frame_pool_retain(&frame_pool, frame);
+}
+
+void audio_release_frame(audio_data_t *frame) {
+    frame_pool_release(&frame_pool, frame);
+}
+
+void audio_get_pipeline_stats(audio_pipeline_stats_t *stats) {
+    taskENTER_CRITICAL();
+    *stats = pipeline_stats;
+    taskEXIT_CRITICAL();
+}
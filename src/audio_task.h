@@ -4,17 +4,116 @@
 #include "FreeRTOS.h"
 #include "queue.h"
 #include "app_config.h"
+#include "log_mel.h"
+#include "fec.h"
+#include "payload_crypto.h"
+#include "frame_pool.h"
 #include <stdint.h>
 #include <stddef.h>
+#include <stdbool.h>
 
-// 音频数据包结构体
+// 随每帧一起发布的帧头 (小端，16 字节，紧跟其后的是负载：交错的 PCM 采样或 log-mel 特征)
+#define AUDIO_FRAME_HEADER_VERSION    (1)
+#define AUDIO_FRAME_FORMAT_PCM_S16LE  (0)   // 16 位有符号小端 PCM
+#define AUDIO_FRAME_FORMAT_LOGMEL_U8  (1)   // 每个特征帧 LOG_MEL_BANDS 字节的 8 位 log-mel，num_samples 为特征帧数，channels 为 1
+#define AUDIO_FRAME_FORMAT_FEC_XOR    FEC_FRAME_FORMAT_XOR // 网络任务生成的 XOR 校验包，num_samples 为负载字节数 (见 fec.h)
+
+// 帧标志位
+#define AUDIO_FRAME_FLAG_SPEAKER_CHANGE (1u << 0) // 在本帧之前约 audio_get_speaker_change_latency_ms() 处检测到说话人切换
+#define AUDIO_FRAME_FLAG_FEC_PARITY     FEC_FRAME_FLAG_PARITY // 校验包，不是音频帧
+#define AUDIO_FRAME_FLAG_BACKLOG        (1u << 2) // 断线后补发的积压帧，发布在 MQTT_TOPIC_AUDIO_BACKLOG
+#define AUDIO_FRAME_FLAG_ENCRYPTED      PAYLOAD_CRYPTO_FLAG // 负载已加密，其后紧跟 PAYLOAD_CRYPTO_TRAILER_SIZE 字节的尾部 (见 payload_crypto.h)
+#define AUDIO_FRAME_FLAG_SERVER_TIME    (1u << 4) // timestamp_ms 已由网络任务换算为服务端时间 (见 clock_sync.h)，否则为设备节拍
+
+typedef struct {
+    uint8_t  version;         // AUDIO_FRAME_HEADER_VERSION
+    uint8_t  flags;           // AUDIO_FRAME_FLAG_*
+    uint8_t  channels;        // 通道数
+    uint8_t  format;          // AUDIO_FRAME_FORMAT_*
+    uint16_t sample_rate_hz;  // 本帧的输出采样率
+    uint16_t num_samples;     // 此数据包中的采样点数 (每通道)；log-mel 格式下为特征帧数
+    uint32_t sequence;        // 帧序号，每采集一帧加一 (被丢弃的帧同样占用序号，接收端可据此统计丢帧)
+    uint32_t timestamp_ms;    // 采集完成时的系统节拍 (毫秒)；发布时若已时钟同步则换算为服务端时间
+} audio_frame_header_t;
+
+// 帧头之前为传输层预留的字节：数据连接发布时把 MQTT PUBLISH 报头原地写在帧头前面，整包一次发送，不做拷贝。
+// 须为 4 的倍数以保持帧头对齐。
+#define AUDIO_FRAME_HEADROOM          (60)
+
+// 负载之后为加密尾部预留的字节，最长的负载加密后也不越出帧缓冲
+#if (AUDIO_PAYLOAD_ENCRYPTION != 0)
+#define AUDIO_FRAME_TAILROOM          PAYLOAD_CRYPTO_TRAILER_SIZE
+#else
+#define AUDIO_FRAME_TAILROOM          (0)
+#endif
+
+// 音频数据包结构体。header 与负载在内存中连续，发布时直接从 header 开始发送。
+// 帧来自音频任务内部的帧缓冲池，audio_queue 中传递的是 audio_data_t 指针，消费者用完后须调用 audio_release_frame()。
+// 帧可由多个消费者共享 (见 frame_fanout.h)：每个额外的持有者先 audio_retain_frame()，共享期间帧头和负载只读。
 typedef struct {
-    int16_t samples[AUDIO_SAMPLES_PER_FRAME * AUDIO_CHANNELS]; // 在 app_config.h 中定义
-    size_t  num_samples; // 此数据包中的采样点数 (每通道)
-    // uint32_t timestamp; // 可选：如果需要时间戳
+    uint8_t transport_headroom[AUDIO_FRAME_HEADROOM]; // 仅由网络任务在发布时写入
+    audio_frame_header_t header;
+    union {
+        int16_t samples[AUDIO_SAMPLES_PER_FRAME * AUDIO_CHANNELS]; // 按最大输出采样率和最大帧长分配，在 app_config.h 中定义
+        uint8_t features[AUDIO_SAMPLES_PER_FRAME * AUDIO_CHANNELS * 2]; // AUDIO_FRAME_FORMAT_LOGMEL_U8 时的特征帧
+    };
+#if (AUDIO_FRAME_TAILROOM > 0)
+    uint8_t transport_tailroom[AUDIO_FRAME_TAILROOM]; // 仅由网络任务在加密时写入
+#endif
 } audio_data_t;
 
-extern QueueHandle_t audio_queue; // 用于发送音频数据到 network_task 的队列
+// 帧头 + 有效负载 (加密后含尾部) 的字节数，即 MQTT 负载长度
+static inline size_t audio_frame_payload_len(const audio_data_t *frame) {
+    size_t trailer_len = (frame->header.flags & AUDIO_FRAME_FLAG_ENCRYPTED) ? PAYLOAD_CRYPTO_TRAILER_SIZE : 0;
+    if (frame->header.format == AUDIO_FRAME_FORMAT_LOGMEL_U8) {
+        return sizeof(audio_frame_header_t) + (size_t)frame->header.num_samples * LOG_MEL_BANDS + trailer_len;
+    }
+    if (frame->header.format == AUDIO_FRAME_FORMAT_FEC_XOR) {
+        return sizeof(audio_frame_header_t) + frame->header.num_samples;
+    }
+    return sizeof(audio_frame_header_t) +
+           (size_t)frame->header.num_samples * frame->header.channels * (AUDIO_BIT_RESOLUTION / 8) + trailer_len;
+}
+
+// 帧缓冲池耗尽时的过载策略 (取值与 frame_pool_policy_t 相同)
+typedef enum {
+    AUDIO_OVERLOAD_DROP_NEWEST = FRAME_POOL_DROP_NEWEST,               // 丢弃刚采集的帧 (队列内容不变)
+    AUDIO_OVERLOAD_DROP_OLDEST = FRAME_POOL_DROP_OLDEST,               // 丢弃队列中最旧的帧，优先保证实时性
+    AUDIO_OVERLOAD_DROP_LOWEST_ENERGY = FRAME_POOL_DROP_LOWEST_ENERGY  // 丢弃队列中 (含新帧) 能量最低的帧，优先保留有语音的帧
+} audio_overload_policy_t;
+
+// 背压等级，由 audio_queue 占用率带滞回地计算
+typedef enum {
+    AUDIO_BACKPRESSURE_NONE,
+    AUDIO_BACKPRESSURE_ELEVATED,        // 下游开始落后，可切换到更便宜的处理
+    AUDIO_BACKPRESSURE_CRITICAL         // 即将丢帧，应切换到更高压缩/更低码率
+} audio_backpressure_level_t;
+
+// 背压等级变化时在音频任务上下文中调用，回调中不得阻塞
+typedef void (*audio_backpressure_callback_t)(audio_backpressure_level_t level);
+
+// 音频流水线统计，用于在目标板上评估处理开销和丢帧情况
+typedef struct {
+    uint32_t frames_captured;       // PDM 完成的采集帧数
+    uint32_t frames_queued;         // 成功送入 audio_queue 的帧数
+    uint32_t frames_dropped;        // 因过载而丢弃的帧总数 (含 frames_evicted)
+    uint32_t frames_evicted;        // 其中已在队列中、按过载策略被挤出的帧数
+    uint32_t backpressure_events;   // 进入 CRITICAL 的次数
+    uint32_t capture_overruns;      // 音频任务来不及处理、采集缓冲区被重新写入的次数
+    uint32_t process_cycles_last;   // 最近一帧重采样与封包所用的 CPU 周期数 (DWT)
+    uint32_t process_cycles_max;    // 自录音开始以来单帧处理的最大 CPU 周期数
+} audio_pipeline_stats_t;
+
+extern QueueHandle_t audio_queue; // 用于发送音频帧指针 (audio_data_t *) 到 network_task 的队列，创建失败时为 NULL
+
+// 创建 audio_queue 和帧缓冲池 (静态存储)。由 main 在创建任何任务之前调用，消费者因此不依赖音频任务先运行
+bool audio_create_queues(void);
+
+// 释放一个引用，最后一个引用释放时帧归还帧缓冲池
+void audio_release_frame(audio_data_t *frame);
+
+// 增加一个引用 (只对已从 audio_queue 取出的帧调用)
+void audio_retain_frame(audio_data_t *frame);
 
 void audio_task(void *pvParameters);
 
@@ -26,8 +125,37 @@ void audio_pause_recording(void); // 目前与停止类似，将来可能有区
 // 可能用于通过滑块控制音量
 void audio_set_mic_volume(uint8_t percentage); // 0-100
 
+// 运行时选择输出采样率 (例如 16000 或 8000)，在下一帧边界生效。不受支持时返回 false。
+bool audio_set_output_sample_rate(uint32_t sample_rate_hz);
+uint32_t audio_get_output_sample_rate(void);
+
+// 运行时选择帧长 (10/20/40/80 毫秒，即 AUDIO_MIN_FRAME_DURATION_MS 的整数倍且不超过 AUDIO_MAX_FRAME_DURATION_MS)，
+// 从下一次启动的 PDM 读取开始生效，不需要停止录音。不受支持时返回 false。
+bool audio_set_frame_duration_ms(uint32_t duration_ms);
+uint32_t audio_get_frame_duration_ms(void);
+
+// 运行时选择过载策略
+void audio_set_overload_policy(audio_overload_policy_t policy);
+audio_overload_policy_t audio_get_overload_policy(void);
+
+// 背压：查询当前等级，或注册等级变化回调 (只支持一个回调，传 NULL 取消)
+audio_backpressure_level_t audio_get_backpressure_level(void);
+void audio_register_backpressure_callback(audio_backpressure_callback_t callback);
+
+// 运行时选择上行格式 (AUDIO_FRAME_FORMAT_PCM_S16LE 或 AUDIO_FRAME_FORMAT_LOGMEL_U8)，在下一帧边界生效。不受支持时返回 false。
+bool audio_set_stream_format(uint8_t format);
+uint8_t audio_get_stream_format(void);
+
+// 运行时启用/关闭说话人切换检测。检测延迟随输出采样率变化，接收端用帧时间戳减去该延迟得到切换点。
+void audio_set_speaker_change_detection(bool enable);
+bool audio_get_speaker_change_detection(void);
+uint32_t audio_get_speaker_change_latency_ms(void);
+
+// 读取音频流水线统计的快照
+void audio_get_pipeline_stats(audio_pipeline_stats_t *stats);
+
 // 控制静音帧发送的函数
 void audio_start_sending_silent_frames(void);
 void audio_stop_sending_silent_frames(void);
 
-#endif /* AUDIO_TASK_H_ */ 
\ No newline at end of file
+#endif /* AUDIO_TASK_H_ */
@@ -0,0 +1,69 @@
+#include "backlog_lane.h"
+#include <stddef.h>
+
+bool backlog_lane_init(backlog_lane_t *lane, uint32_t capacity, uint32_t bucket_bits, uint32_t now_ms) {
+    if (capacity == 0 || capacity > BACKLOG_LANE_MAX_FRAMES) {
+        return false;
+    }
+    *lane = (backlog_lane_t){0};
+    lane->capacity = capacity;
+    lane->bucket_millibits = (uint64_t)bucket_bits * 1000u;
+    lane->refill_ms = now_ms;
+    return true;
+}
+
+static void *take_head(backlog_lane_t *lane, uint32_t now_ms) {
+    void *frame = lane->frames[lane->head];
+    lane->head = (lane->head + 1u) % lane->capacity;
+    lane->count--;
+    if (lane->count == 0) {
+        lane->last_catchup_ms = now_ms - lane->started_ms;
+    }
+    return frame;
+}
+
+void *backlog_lane_push(backlog_lane_t *lane, void *frame, uint32_t captured_ms, uint32_t bytes, uint32_t now_ms) {
+    void *evicted = NULL;
+    if (lane->count == lane->capacity) {
+        // 挤出最旧的帧不算一次追平，通道保持非空
+        evicted = lane->frames[lane->head];
+        lane->head = (lane->head + 1u) % lane->capacity;
+        lane->count--;
+    } else if (lane->count == 0) {
+        lane->started_ms = now_ms;
+    }
+    uint32_t tail = (lane->head + lane->count) % lane->capacity;
+    lane->frames[tail] = frame;
+    lane->captured_ms[tail] = captured_ms;
+    lane->bytes[tail] = bytes;
+    lane->count++;
+    return evicted;
+}
+
+void *backlog_lane_expire(backlog_lane_t *lane, uint32_t now_ms, uint32_t max_age_ms) {
+    if (lane->count == 0 || (uint32_t)(now_ms - lane->captured_ms[lane->head]) <= max_age_ms) {
+        return NULL;
+    }
+    return take_head(lane, now_ms);
+}
+
+void backlog_lane_refill(backlog_lane_t *lane, uint32_t now_ms, uint32_t spare_bps, uint32_t share_pct) {
+    uint64_t elapsed_ms = (uint32_t)(now_ms - lane->refill_ms);
+    lane->refill_ms = now_ms;
+    lane->tokens += (uint64_t)spare_bps * share_pct / 100u * elapsed_ms;
+    if (lane->tokens > lane->bucket_millibits) {
+        lane->tokens = lane->bucket_millibits;
+    }
+}
+
+void *backlog_lane_pop(backlog_lane_t *lane, uint32_t now_ms) {
+    if (lane->count == 0) {
+        return NULL;
+    }
+    uint64_t cost = (uint64_t)lane->bytes[lane->head] * 8000u;
+    if (lane->tokens < cost) {
+        return NULL;
+    }
+    lane->tokens -= cost;
+    return take_head(lane, now_ms);
+}
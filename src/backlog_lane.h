@@ -0,0 +1,49 @@
+#ifndef BACKLOG_LANE_H_
+#define BACKLOG_LANE_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// 实时/积压两级调度中的积压通道：按入队顺序 (即采集顺序) 存放帧指针的环形缓冲，加一个令牌桶限速补发。
+//   满时挤出最旧的积压帧 (优先保留较新的内容)，超过给定帧龄的帧由调用者逐个取出丢弃；
+//   令牌按 spare_bps * share_pct / 100 补充 (单位毫比特，避免短周期补充时被截断)，桶深由调用者给定，
+//   应至少为最大一帧，保证任意一帧都能发出。
+// 帧的内容由调用者决定，入队时给出采集时间和线上字节数；时间为毫秒计数，允许回绕。
+// 与 fec.c 一样不依赖 RTOS，只在一个任务中调用。
+
+#define BACKLOG_LANE_MAX_FRAMES     (64)
+
+typedef struct {
+    void *frames[BACKLOG_LANE_MAX_FRAMES];
+    uint32_t captured_ms[BACKLOG_LANE_MAX_FRAMES];
+    uint32_t bytes[BACKLOG_LANE_MAX_FRAMES];
+    uint32_t capacity;
+    uint32_t head;
+    uint32_t count;
+    uint64_t tokens;                // 毫比特 (bit/s * ms)
+    uint64_t bucket_millibits;
+    uint32_t refill_ms;
+    uint32_t started_ms;            // 通道从空变为非空的时间
+    uint32_t last_catchup_ms;       // 最近一次从非空到补发完 (或丢弃完) 的耗时
+} backlog_lane_t;
+
+// capacity 超过 BACKLOG_LANE_MAX_FRAMES 或为 0 时返回 false
+bool backlog_lane_init(backlog_lane_t *lane, uint32_t capacity, uint32_t bucket_bits, uint32_t now_ms);
+
+// 放入一帧。通道满时先挤出最旧的帧并返回它 (调用者释放并计为丢弃)，否则返回 NULL。
+void *backlog_lane_push(backlog_lane_t *lane, void *frame, uint32_t captured_ms, uint32_t bytes, uint32_t now_ms);
+
+// 队头帧龄超过 max_age_ms 时取出并返回它，否则返回 NULL。调用者循环调用直到返回 NULL。
+void *backlog_lane_expire(backlog_lane_t *lane, uint32_t now_ms, uint32_t max_age_ms);
+
+// 按上次补充以来的时间补充令牌
+void backlog_lane_refill(backlog_lane_t *lane, uint32_t now_ms, uint32_t spare_bps, uint32_t share_pct);
+
+// 令牌足够发出队头帧时扣除令牌并返回它，否则 (或通道为空) 返回 NULL
+void *backlog_lane_pop(backlog_lane_t *lane, uint32_t now_ms);
+
+static inline uint32_t backlog_lane_depth(const backlog_lane_t *lane) {
+    return lane->count;
+}
+
+#endif /* BACKLOG_LANE_H_ */
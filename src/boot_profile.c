@@ -0,0 +1,61 @@
+#include "boot_profile.h"
+#include <string.h>
+
+static const char *const step_names[BOOT_STEP_COUNT] = {
+    "bsp", "retarget_io", "tasks", "audio_buffers", "audio_clocks", "pdm", "capsense", "wcm_init", "mqtt_init",
+    "wifi_connect", "broker_connect"
+};
+
+void boot_profile_init(boot_profile_t *p) {
+    memset(p, 0, sizeof(*p));
+}
+
+void boot_profile_begin(boot_profile_t *p, boot_step_t step, uint32_t now_us) {
+    if (step >= BOOT_STEP_COUNT || (p->started & (1u << step))) {
+        return;
+    }
+    p->start_us[step] = now_us;
+    p->started |= 1u << step;
+}
+
+void boot_profile_end(boot_profile_t *p, boot_step_t step, uint32_t now_us) {
+    if (step >= BOOT_STEP_COUNT || !(p->started & (1u << step)) || (p->finished & (1u << step))) {
+        return;
+    }
+    p->end_us[step] = now_us;
+    p->finished |= 1u << step;
+}
+
+bool boot_profile_reached_idle(boot_profile_t *p, uint32_t now_us) {
+    if (p->idle) {
+        return false;
+    }
+    p->idle_us = now_us;
+    p->idle = true;
+    return true;
+}
+
+bool boot_profile_step(const boot_profile_t *p, boot_step_t step, uint32_t *start_us, uint32_t *duration_us) {
+    if (step >= BOOT_STEP_COUNT || !(p->finished & (1u << step))) {
+        return false;
+    }
+    *start_us = p->start_us[step];
+    *duration_us = p->end_us[step] - p->start_us[step];
+    return true;
+}
+
+uint32_t boot_profile_serial_us(const boot_profile_t *p) {
+    uint32_t total = 0;
+    for (uint32_t step = 0; step < BOOT_STEP_COUNT; step++) {
+        uint32_t start_us;
+        uint32_t duration_us;
+        if (boot_profile_step(p, (boot_step_t)step, &start_us, &duration_us)) {
+            total += duration_us;
+        }
+    }
+    return total;
+}
+
+const char *boot_profile_step_name(boot_step_t step) {
+    return (step < BOOT_STEP_COUNT) ? step_names[step] : "?";
+}
@@ -0,0 +1,64 @@
+#ifndef BOOT_PROFILE_H_
+#define BOOT_PROFILE_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// 启动过程剖析：记录每个初始化步骤第一次开始和结束的时间 (从 main() 开始计，微秒)，以及第一次进入 IDLE 的时间。
+// 各步骤在不同任务中并行执行，步骤耗时之和 (boot_profile_serial_us()) 与到 IDLE 的时间之差就是重叠节省的时间。
+// 只记录第一次，断线重连时再次调用不会覆盖启动时的数据。
+// 与 fec.c 一样不依赖 RTOS，时间由调用者传入；主机模拟设备 (tools/host/sim_device.c) 用它记录模拟的启动过程。
+
+typedef enum {
+    BOOT_STEP_BSP,                  // cybsp_init()，跨越时钟切换，只作参考
+    BOOT_STEP_RETARGET_IO,
+    BOOT_STEP_TASKS,                // 状态机初始化和创建任务
+    BOOT_STEP_AUDIO_BUFFERS,        // 音频队列、帧缓冲池和重采样器
+    BOOT_STEP_AUDIO_CLOCKS,
+    BOOT_STEP_PDM,
+    BOOT_STEP_CAPSENSE,             // 含 Cy_CapSense_Enable() 的自动校准
+    BOOT_STEP_WCM_INIT,             // 含 WLAN 固件下载
+    BOOT_STEP_MQTT_INIT,
+    BOOT_STEP_WIFI_CONNECT,
+    BOOT_STEP_BROKER_CONNECT,
+    BOOT_STEP_COUNT
+} boot_step_t;
+
+typedef struct {
+    uint32_t start_us[BOOT_STEP_COUNT];
+    uint32_t end_us[BOOT_STEP_COUNT];
+    uint32_t started;               // 位图
+    uint32_t finished;
+    uint32_t idle_us;
+    bool idle;
+} boot_profile_t;
+
+void boot_profile_init(boot_profile_t *p);
+void boot_profile_begin(boot_profile_t *p, boot_step_t step, uint32_t now_us);
+void boot_profile_end(boot_profile_t *p, boot_step_t step, uint32_t now_us);
+
+// 第一次进入 IDLE 时返回 true
+bool boot_profile_reached_idle(boot_profile_t *p, uint32_t now_us);
+
+// 步骤已完成时写出开始时间和耗时并返回 true
+bool boot_profile_step(const boot_profile_t *p, boot_step_t step, uint32_t *start_us, uint32_t *duration_us);
+
+// 已完成步骤的耗时之和，即串行执行时的启动时间 (不含步骤之间的空闲)
+uint32_t boot_profile_serial_us(const boot_profile_t *p);
+
+const char *boot_profile_step_name(boot_step_t step);
+
+// --- 固件 (main.c) ---
+// 全局实例和时钟：调度器启动前用 DWT 周期计数器，之后用 tick 计数 (1 ms 分辨率，DWT 32 位计数在 100 MHz 下
+// 约 43 秒回绕，而启动可能因 Wi-Fi 重试更长)。可在任何任务中调用，不可在中断中调用。
+
+uint32_t boot_now_us(void);
+void boot_step_begin(boot_step_t step);
+void boot_step_end(boot_step_t step);
+
+// 状态机第一次进入 IDLE 时调用，打印各步骤的时间线
+void boot_reached_idle(void);
+
+void boot_get_profile(boot_profile_t *out);
+
+#endif /* BOOT_PROFILE_H_ */
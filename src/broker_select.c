@@ -0,0 +1,62 @@
+#include "broker_select.h"
+#include <string.h>
+
+static void decay_failures(broker_endpoint_t *ep, uint32_t now_ms) {
+    while (ep->recent_failures > 0 && (now_ms - ep->last_decay_ms) >= BROKER_SELECT_FAILURE_DECAY_MS) {
+        ep->recent_failures /= 2u;
+        ep->last_decay_ms += BROKER_SELECT_FAILURE_DECAY_MS;
+    }
+    if (ep->recent_failures == 0) {
+        ep->last_decay_ms = now_ms;
+    }
+}
+
+void broker_select_init(broker_select_t *bs, const char *const addresses[], uint32_t count, uint32_t now_ms) {
+    memset(bs, 0, sizeof(*bs));
+    bs->count = (count > BROKER_SELECT_MAX_ENDPOINTS) ? BROKER_SELECT_MAX_ENDPOINTS : count;
+    for (uint32_t i = 0; i < bs->count; i++) {
+        bs->endpoints[i].address = addresses[i];
+        bs->endpoints[i].last_decay_ms = now_ms;
+    }
+}
+
+uint32_t broker_select_score(broker_select_t *bs, uint32_t index, uint32_t now_ms) {
+    broker_endpoint_t *ep = &bs->endpoints[index];
+    decay_failures(ep, now_ms);
+    uint32_t connect_ms = (ep->connect_ms_avg > 0) ? ep->connect_ms_avg : BROKER_SELECT_UNKNOWN_CONNECT_MS;
+    return connect_ms + ep->recent_failures * BROKER_SELECT_FAILURE_PENALTY_MS;
+}
+
+uint32_t broker_select_rank(broker_select_t *bs, uint32_t now_ms, uint32_t order[BROKER_SELECT_MAX_ENDPOINTS]) {
+    uint32_t scores[BROKER_SELECT_MAX_ENDPOINTS];
+    // 插入排序，分数相同时保持列表顺序
+    for (uint32_t i = 0; i < bs->count; i++) {
+        uint32_t score = broker_select_score(bs, i, now_ms);
+        uint32_t j = i;
+        while (j > 0 && scores[j - 1] > score) {
+            scores[j] = scores[j - 1];
+            order[j] = order[j - 1];
+            j--;
+        }
+        scores[j] = score;
+        order[j] = i;
+    }
+    return bs->count;
+}
+
+void broker_select_report_success(broker_select_t *bs, uint32_t index, uint32_t connect_ms, uint32_t now_ms) {
+    broker_endpoint_t *ep = &bs->endpoints[index];
+    decay_failures(ep, now_ms);
+    ep->connects++;
+    if (connect_ms == 0) {
+        connect_ms = 1;     // 0 表示未连接过
+    }
+    ep->connect_ms_avg = (ep->connect_ms_avg == 0) ? connect_ms : (ep->connect_ms_avg * 3u + connect_ms) / 4u;
+}
+
+void broker_select_report_failure(broker_select_t *bs, uint32_t index, uint32_t now_ms) {
+    broker_endpoint_t *ep = &bs->endpoints[index];
+    decay_failures(ep, now_ms);
+    ep->failures++;
+    ep->recent_failures++;
+}
@@ -0,0 +1,45 @@
+#ifndef BROKER_SELECT_H_
+#define BROKER_SELECT_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// 多代理故障切换的健康评分：app_config.h 中 MQTT_BROKER_LIST 的每个代理维护连接耗时和近期失败次数，
+// 连接时按分数从低到高依次尝试，失败立即换下一个，不在同一个代理上等待重试。
+//   分数 = 平滑连接耗时 (未连接过时为 BROKER_SELECT_UNKNOWN_CONNECT_MS) + 近期失败次数 * BROKER_SELECT_FAILURE_PENALTY_MS
+// 近期失败次数每 BROKER_SELECT_FAILURE_DECAY_MS 减半，恢复的代理 (例如首选代理重启完成) 会逐渐重新排到前面。
+// 分数相同时按列表顺序，列表第一个为首选代理。
+// 与 fec.c 一样不依赖 RTOS，时间由调用者传入。
+
+#define BROKER_SELECT_MAX_ENDPOINTS       (4)
+#define BROKER_SELECT_UNKNOWN_CONNECT_MS  (1000)
+#define BROKER_SELECT_FAILURE_PENALTY_MS  (5000)
+#define BROKER_SELECT_FAILURE_DECAY_MS    (60000)
+
+typedef struct {
+    const char *address;
+    uint32_t connects;              // 成功连接次数
+    uint32_t failures;              // 连接失败或连接后被判定失效的总次数
+    uint32_t recent_failures;       // 参与评分的近期失败次数
+    uint32_t connect_ms_avg;        // 连接耗时的指数平滑 (1/4)，0 表示未连接过
+    uint32_t last_decay_ms;
+} broker_endpoint_t;
+
+typedef struct {
+    broker_endpoint_t endpoints[BROKER_SELECT_MAX_ENDPOINTS];
+    uint32_t count;
+} broker_select_t;
+
+// addresses 须在整个运行期间有效，超过 BROKER_SELECT_MAX_ENDPOINTS 的部分被忽略
+void broker_select_init(broker_select_t *bs, const char *const addresses[], uint32_t count, uint32_t now_ms);
+
+uint32_t broker_select_score(broker_select_t *bs, uint32_t index, uint32_t now_ms);
+
+// 按分数从低到高把代理下标写入 order，返回代理个数
+uint32_t broker_select_rank(broker_select_t *bs, uint32_t now_ms, uint32_t order[BROKER_SELECT_MAX_ENDPOINTS]);
+
+void broker_select_report_success(broker_select_t *bs, uint32_t index, uint32_t connect_ms, uint32_t now_ms);
+
+void broker_select_report_failure(broker_select_t *bs, uint32_t index, uint32_t now_ms);
+
+#endif /* BROKER_SELECT_H_ */
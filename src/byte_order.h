@@ -0,0 +1,45 @@
+#ifndef BYTE_ORDER_H_
+#define BYTE_ORDER_H_
+
+#include <stdint.h>
+
+// 协议字段的字节序读写：帧头、FEC、心跳、时钟同步和控制消息为小端，RTP 头为大端 (网络字节序)。
+// 按字节访问，与地址对齐和主机字节序无关。主机工具 (tools/host/) 也包含此文件。
+
+static inline uint16_t get_le16(const uint8_t *p) {
+    return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+static inline uint32_t get_le32(const uint8_t *p) {
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static inline void put_le16(uint8_t *p, uint16_t v) {
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+}
+
+static inline void put_le32(uint8_t *p, uint32_t v) {
+    put_le16(p, (uint16_t)v);
+    put_le16(&p[2], (uint16_t)(v >> 16));
+}
+
+static inline uint16_t get_be16(const uint8_t *p) {
+    return (uint16_t)((p[0] << 8) | p[1]);
+}
+
+static inline uint32_t get_be32(const uint8_t *p) {
+    return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 8) | (uint32_t)p[3];
+}
+
+static inline void put_be16(uint8_t *p, uint16_t v) {
+    p[0] = (uint8_t)(v >> 8);
+    p[1] = (uint8_t)v;
+}
+
+static inline void put_be32(uint8_t *p, uint32_t v) {
+    put_be16(p, (uint16_t)(v >> 16));
+    put_be16(&p[2], (uint16_t)v);
+}
+
+#endif /* BYTE_ORDER_H_ */
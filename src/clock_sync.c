@@ -0,0 +1,200 @@
+#include "clock_sync.h"
+#include "byte_order.h"
+#include <string.h>
+#include <math.h>
+
+// 对 history 做加权最小二乘拟合，x 为相对最新样本的本地时间 (毫秒)，y 为偏移 (微秒)。
+// 延迟比历史最小延迟多出越多，上下行越可能不对称，权重按 1 / (1 + 超出量/CLOCK_SYNC_DELAY_SCALE_MS)^2 递减。
+static void fit_history(clock_sync_t *cs) {
+    uint32_t n = cs->history_count;
+    uint32_t newest = (cs->history_head + CLOCK_SYNC_HISTORY - 1u) % CLOCK_SYNC_HISTORY;
+    uint32_t ref_ms = cs->history[newest].local_ms;
+    uint32_t min_delay = cs->history[0].delay_ms;
+    int32_t min_x = 0;
+    for (uint32_t i = 0; i < n; i++) {
+        const clock_sync_sample_t *s = &cs->history[i];
+        int32_t x = (int32_t)(s->local_ms - ref_ms);
+        if (x < min_x) {
+            min_x = x;
+        }
+        if (s->delay_ms < min_delay) {
+            min_delay = s->delay_ms;
+        }
+    }
+
+    double w[CLOCK_SYNC_HISTORY];
+    double sum_w = 0.0;
+    double sum_x = 0.0;
+    double sum_y = 0.0;
+    for (uint32_t i = 0; i < n; i++) {
+        const clock_sync_sample_t *s = &cs->history[i];
+        double excess = (double)(s->delay_ms - min_delay) / (double)CLOCK_SYNC_DELAY_SCALE_MS;
+        w[i] = 1.0 / ((1.0 + excess) * (1.0 + excess));
+        sum_w += w[i];
+        sum_x += w[i] * (int32_t)(s->local_ms - ref_ms);
+        sum_y += w[i] * s->offset_us;
+    }
+    double mean_x = sum_x / sum_w;
+    double mean_y = sum_y / sum_w;
+    double sxx = 0.0;
+    double sxy = 0.0;
+    for (uint32_t i = 0; i < n; i++) {
+        const clock_sync_sample_t *s = &cs->history[i];
+        double dx = (int32_t)(s->local_ms - ref_ms) - mean_x;
+        sxx += w[i] * dx * dx;
+        sxy += w[i] * dx * (s->offset_us - mean_y);
+    }
+
+    double slope = 0.0;     // 微秒/毫秒
+    bool drift_valid = false;
+    if (n >= 2 && sxx > 0.0 && (uint32_t)(-min_x) >= CLOCK_SYNC_MIN_DRIFT_BASELINE_MS) {
+        slope = sxy / sxx;
+        drift_valid = fabs(slope * 1e6) <= CLOCK_SYNC_MAX_DRIFT_PPB;
+        if (!drift_valid) {
+            slope = 0.0;
+        }
+    }
+    double intercept = mean_y - slope * mean_x;
+
+    double sum_sq = 0.0;
+    for (uint32_t i = 0; i < n; i++) {
+        const clock_sync_sample_t *s = &cs->history[i];
+        double e = s->offset_us - (intercept + slope * (int32_t)(s->local_ms - ref_ms));
+        sum_sq += w[i] * e * e;
+    }
+
+    cs->est_ref_ms = ref_ms;
+    cs->est_offset_us = (int64_t)llround(intercept);
+    cs->stats.drift_ppb = (int32_t)lround(slope * 1e6);
+    cs->stats.drift_valid = drift_valid;
+    cs->stats.residual_us = (uint32_t)lround(sqrt(sum_sq / sum_w));
+}
+
+static int64_t offset_at(const clock_sync_t *cs, uint32_t local_ms) {
+    int32_t dx = (int32_t)(local_ms - cs->est_ref_ms);
+    return cs->est_offset_us + (int64_t)cs->stats.drift_ppb * dx / 1000000;
+}
+
+void clock_sync_init(clock_sync_t *cs, uint32_t interval_ms, uint32_t samples_per_period) {
+    memset(cs, 0, sizeof(*cs));
+    cs->interval_ms = interval_ms;
+    cs->samples_per_period = (samples_per_period == 0) ? 1u : samples_per_period;
+}
+
+void clock_sync_start(clock_sync_t *cs) {
+    cs->running = cs->interval_ms > 0;
+    cs->sent_any = false;
+    cs->awaiting_reply = false;
+}
+
+void clock_sync_stop(clock_sync_t *cs) {
+    cs->running = false;
+    cs->awaiting_reply = false;
+}
+
+size_t clock_sync_poll(clock_sync_t *cs, uint32_t now_ms, uint8_t request[CLOCK_SYNC_MSG_SIZE]) {
+    if (!cs->running || (cs->sent_any && (now_ms - cs->last_send_ms) < cs->interval_ms)) {
+        return 0;
+    }
+    memset(request, 0, CLOCK_SYNC_MSG_SIZE);
+    request[0] = CLOCK_SYNC_VERSION;
+    request[1] = CLOCK_SYNC_MSG_REQUEST;
+    put_le16(&request[2], cs->next_sequence);
+    put_le32(&request[4], now_ms);
+    put_le32(&request[8], (uint32_t)cs->stats.drift_ppb);
+    request[12] = (uint8_t)((cs->stats.synced ? CLOCK_SYNC_FLAG_SYNCED : 0u) |
+                            (cs->stats.drift_valid ? CLOCK_SYNC_FLAG_DRIFT_VALID : 0u));
+
+    // 只等待最近一次请求的回复，迟到的回复延迟偏大，直接丢弃
+    cs->pending_sequence = cs->next_sequence++;
+    cs->awaiting_reply = true;
+    cs->last_send_ms = now_ms;
+    cs->sent_any = true;
+    cs->stats.requests_sent++;
+    return CLOCK_SYNC_MSG_SIZE;
+}
+
+bool clock_sync_on_reply(clock_sync_t *cs, const uint8_t *data, size_t len, uint32_t t4_ms) {
+    if (len != CLOCK_SYNC_MSG_SIZE || data[0] != CLOCK_SYNC_VERSION || data[1] != CLOCK_SYNC_MSG_REPLY ||
+        !cs->awaiting_reply || get_le16(&data[2]) != cs->pending_sequence) {
+        cs->stats.replies_rejected++;
+        return false;
+    }
+    cs->awaiting_reply = false;
+
+    uint32_t t1 = get_le32(&data[4]);
+    uint32_t t2 = get_le32(&data[8]);
+    uint32_t t3 = get_le32(&data[12]);
+    int32_t delay = (int32_t)(t4_ms - t1) - (int32_t)(t3 - t2);
+    if (delay < 0) {
+        delay = 0; // 两端时钟分辨率为 1 ms，短延迟时可能算出负值
+    }
+
+    // 偏移在 2^32 模空间中计算，相对第一个样本的偏移保存，拟合只处理小数值
+    uint32_t up = t2 - t1;
+    uint32_t down = t3 - t4_ms;
+    if (!cs->base_valid) {
+        cs->base_offset_ms = up + (uint32_t)((int32_t)(down - up) / 2);
+        cs->base_valid = true;
+    }
+    clock_sync_sample_t sample = {
+        .local_ms = t1 + (t4_ms - t1) / 2u,
+        .offset_us = ((int32_t)(up - cs->base_offset_ms) + (int32_t)(down - cs->base_offset_ms)) * 500,
+        .delay_ms = (uint32_t)delay
+    };
+
+    cs->stats.replies++;
+    cs->stats.delay_last_ms = sample.delay_ms;
+    if (cs->stats.replies == 1 || sample.delay_ms < cs->stats.delay_min_ms) {
+        cs->stats.delay_min_ms = sample.delay_ms;
+    }
+
+    if (!cs->period_has_sample || sample.delay_ms < cs->period_best.delay_ms) {
+        cs->period_best = sample;
+        cs->period_has_sample = true;
+    }
+    cs->period_count++;
+
+    if (cs->period_count >= cs->samples_per_period) {
+        cs->history[cs->history_head] = cs->period_best;
+        cs->history_head = (cs->history_head + 1u) % CLOCK_SYNC_HISTORY;
+        if (cs->history_count < CLOCK_SYNC_HISTORY) {
+            cs->history_count++;
+        }
+        cs->period_count = 0;
+        cs->period_has_sample = false;
+        cs->stats.periods++;
+        fit_history(cs);
+    } else if (cs->history_count == 0) {
+        // 第一个周期结束前先用目前延迟最小的样本，尽快给出服务端时间
+        cs->est_ref_ms = cs->period_best.local_ms;
+        cs->est_offset_us = cs->period_best.offset_us;
+    }
+    cs->stats.synced = true;
+    cs->stats.offset_ms = cs->base_offset_ms + (uint32_t)(int32_t)(offset_at(cs, t4_ms) / 1000);
+    return true;
+}
+
+bool clock_sync_to_server(const clock_sync_t *cs, uint32_t local_ms, uint32_t *server_ms) {
+    if (!cs->stats.synced) {
+        return false;
+    }
+    int64_t offset_us = offset_at(cs, local_ms);
+    int64_t offset_ms = (offset_us >= 0) ? (offset_us + 500) / 1000 : -((-offset_us + 500) / 1000);
+    *server_ms = local_ms + cs->base_offset_ms + (uint32_t)(int32_t)offset_ms;
+    return true;
+}
+
+bool clock_sync_make_reply(const uint8_t request[CLOCK_SYNC_MSG_SIZE], uint32_t t2_ms, uint32_t t3_ms,
+                           uint8_t reply[CLOCK_SYNC_MSG_SIZE]) {
+    if (request[0] != CLOCK_SYNC_VERSION || request[1] != CLOCK_SYNC_MSG_REQUEST) {
+        return false;
+    }
+    memset(reply, 0, CLOCK_SYNC_MSG_SIZE);
+    reply[0] = CLOCK_SYNC_VERSION;
+    reply[1] = CLOCK_SYNC_MSG_REPLY;
+    memcpy(&reply[2], &request[2], 6);     // 序号和 t1 原样返回
+    put_le32(&reply[8], t2_ms);
+    put_le32(&reply[12], t3_ms);
+    return true;
+}
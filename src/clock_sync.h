@@ -0,0 +1,95 @@
+#ifndef CLOCK_SYNC_H_
+#define CLOCK_SYNC_H_
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+// 多块板对齐采集的时钟同步：设备经控制连接与服务端做类似 NTP 的四时间戳交换，估计本地节拍相对服务端时钟的偏移和漂移。
+// 设备每 interval_ms 发布一条请求到 "MQTT_TOPIC_CLOCK/<客户端 ID>"，服务端收到后立即回复到 "MQTT_TOPIC_CLOCK_REPLY/<客户端 ID>"：
+//   请求 (16 字节，小端)：[0] 版本 [1] CLOCK_SYNC_MSG_REQUEST [2..3] 序号 [4..7] t1 设备发送时间 (节拍毫秒)
+//                        [8..11] 设备当前的漂移估计 (ppb，有符号) [12] 标志 CLOCK_SYNC_FLAG_*
+//   回复 (16 字节，小端)：[0] 版本 [1] CLOCK_SYNC_MSG_REPLY   [2..3] 请求序号 [4..7] 原样返回的 t1
+//                        [8..11] t2 服务端收到时间 [12..15] t3 服务端回复时间 (服务端毫秒时钟，可回绕)
+// 设备记录收到回复的时间 t4，往返延迟 = (t4 - t1) - (t3 - t2)，偏移 = ((t2 - t1) + (t3 - t4)) / 2。
+// 每 samples_per_period 次交换只保留延迟最小的一次 (排队较少，上下行较对称)，最近 CLOCK_SYNC_HISTORY 个周期的样本做加权最小二乘拟合：
+// 截距为偏移，斜率为漂移。样本跨度不足 CLOCK_SYNC_MIN_DRIFT_BASELINE_MS 时漂移按 0，避免短基线上把测量噪声当成漂移。
+// 与 fec.c 一样不依赖 RTOS，时间由调用者传入。
+
+#define CLOCK_SYNC_VERSION                 (1)
+#define CLOCK_SYNC_MSG_SIZE                (16)
+#define CLOCK_SYNC_MSG_REQUEST             (1)
+#define CLOCK_SYNC_MSG_REPLY               (2)
+#define CLOCK_SYNC_FLAG_SYNCED             (1u << 0)  // 请求中：设备已有偏移估计，帧时间戳为服务端时间
+#define CLOCK_SYNC_FLAG_DRIFT_VALID        (1u << 1)  // 请求中：漂移估计有效
+#define CLOCK_SYNC_HISTORY                 (32)
+#define CLOCK_SYNC_DELAY_SCALE_MS          (2)        // 拟合权重随延迟超出历史最小延迟的量递减的尺度
+#define CLOCK_SYNC_MIN_DRIFT_BASELINE_MS   (60000)
+#define CLOCK_SYNC_MAX_DRIFT_PPB           (500000)   // 超过 500 ppm 的拟合结果视为异常，不采用
+
+typedef struct {
+    uint32_t local_ms;
+    int32_t offset_us;              // 相对 base_offset_ms 的偏移
+    uint32_t delay_ms;
+} clock_sync_sample_t;
+
+typedef struct {
+    uint32_t requests_sent;
+    uint32_t replies;               // 接受的回复
+    uint32_t replies_rejected;      // 序号不匹配 (迟到) 或格式错误
+    uint32_t periods;               // 进入拟合的样本数
+    uint32_t delay_last_ms;
+    uint32_t delay_min_ms;
+    uint32_t offset_ms;             // 服务端时间 - 本地节拍 (模 2^32)
+    int32_t drift_ppb;              // 本地节拍相对服务端时钟的漂移，正值表示本地偏慢
+    uint32_t residual_us;           // 拟合残差的加权均方根 (单个样本的噪声，拟合结果的误差小于此值)
+    bool synced;
+    bool drift_valid;
+} clock_sync_stats_t;
+
+typedef struct {
+    uint32_t interval_ms;
+    uint32_t samples_per_period;
+    bool running;
+    bool sent_any;
+    uint32_t last_send_ms;
+    uint16_t next_sequence;
+    uint16_t pending_sequence;
+    bool awaiting_reply;
+
+    bool base_valid;
+    uint32_t base_offset_ms;
+    uint32_t period_count;
+    bool period_has_sample;
+    clock_sync_sample_t period_best;
+    clock_sync_sample_t history[CLOCK_SYNC_HISTORY];
+    uint32_t history_head;
+    uint32_t history_count;
+
+    // 当前估计：offset_us(local) = est_offset_us + drift_ppb * (local - est_ref_ms) / 1e6
+    uint32_t est_ref_ms;
+    int64_t est_offset_us;
+    clock_sync_stats_t stats;
+} clock_sync_t;
+
+// interval_ms 为 0 时不发送请求
+void clock_sync_init(clock_sync_t *cs, uint32_t interval_ms, uint32_t samples_per_period);
+
+// 连接建立后开始/断开时停止发送请求。已有的估计保留：时钟关系与连接无关。
+void clock_sync_start(clock_sync_t *cs);
+void clock_sync_stop(clock_sync_t *cs);
+
+// 到了发送时间时写入一条请求并返回 CLOCK_SYNC_MSG_SIZE，否则返回 0
+size_t clock_sync_poll(clock_sync_t *cs, uint32_t now_ms, uint8_t request[CLOCK_SYNC_MSG_SIZE]);
+
+// 处理一条回复，t4_ms 为收到回复时的本地时间。样本被接受时返回 true。
+bool clock_sync_on_reply(clock_sync_t *cs, const uint8_t *data, size_t len, uint32_t t4_ms);
+
+// 把本地节拍换算为服务端时间。尚未同步时返回 false，server_ms 不变。
+bool clock_sync_to_server(const clock_sync_t *cs, uint32_t local_ms, uint32_t *server_ms);
+
+// 服务端用：根据请求生成回复
+bool clock_sync_make_reply(const uint8_t request[CLOCK_SYNC_MSG_SIZE], uint32_t t2_ms, uint32_t t3_ms,
+                           uint8_t reply[CLOCK_SYNC_MSG_SIZE]);
+
+#endif /* CLOCK_SYNC_H_ */
@@ -0,0 +1,268 @@
+#include "dsp.h"
+#include <string.h>
+
+#define DSP_PI            (3.14159265358979f)
+#define DSP_LN2           (0.69314718056f)
+#define DSP_LOG10_2       (0.30102999566f)
+#define DSP_LOG2_10       (3.32192809489f)
+#define DSP_LOG2_TABLE_BITS (5)
+
+static int16_t twiddle_cos[DSP_FFT_MAX_N / 2];   // cos(2*pi*k/N)，Q15
+static int16_t twiddle_sin[DSP_FFT_MAX_N / 2];   // sin(2*pi*k/N)，Q15
+static uint16_t log2_table[(1u << DSP_LOG2_TABLE_BITS) + 1]; // log2(1 + i/32)，Q10
+static bool dsp_initialized = false;
+
+typedef union {
+    float f;
+    uint32_t u;
+} dsp_float_bits_t;
+
+float dsp_sinf(float x) {
+    // 先把 x 规约到 [-pi/2, pi/2]，再用泰勒级数展开到 x^11
+    const float two_pi = 2.0f * DSP_PI;
+    int32_t turns = (int32_t)(x / two_pi + (x >= 0.0f ? 0.5f : -0.5f));
+    x -= (float)turns * two_pi;                 // [-pi, pi]
+    if (x > DSP_PI * 0.5f) {
+        x = DSP_PI - x;
+    } else if (x < -DSP_PI * 0.5f) {
+        x = -DSP_PI - x;
+    }
+    float x2 = x * x;
+    return x * (1.0f - x2 / 6.0f * (1.0f - x2 / 20.0f * (1.0f - x2 / 42.0f * (1.0f - x2 / 72.0f * (1.0f - x2 / 110.0f)))));
+}
+
+float dsp_cosf(float x) {
+    return dsp_sinf(x + DSP_PI * 0.5f);
+}
+
+float dsp_log2f(float x) {
+    // x = m * 2^e，m 在 [1, 2)；ln(m) = 2 * atanh((m - 1) / (m + 1))，级数在 y <= 1/3 时收敛很快
+    dsp_float_bits_t bits = { .f = x };
+    int32_t e = (int32_t)((bits.u >> 23) & 0xFFu) - 127;
+    bits.u = (bits.u & 0x007FFFFFu) | 0x3F800000u;
+    float y = (bits.f - 1.0f) / (bits.f + 1.0f);
+    float y2 = y * y;
+    float ln_m = 2.0f * y * (1.0f + y2 * (1.0f / 3.0f + y2 * (1.0f / 5.0f + y2 * (1.0f / 7.0f + y2 * (1.0f / 9.0f)))));
+    return (float)e + ln_m / DSP_LN2;
+}
+
+float dsp_exp2f(float x) {
+    if (x < -126.0f) {
+        return 0.0f;
+    }
+    if (x > 127.0f) {
+        x = 127.0f;
+    }
+    int32_t i = (int32_t)x;
+    if ((float)i > x) {
+        i--;                                    // 向下取整
+    }
+    float t = (x - (float)i) * DSP_LN2;         // e^t，t 在 [0, ln2)
+    float frac = 1.0f + t * (1.0f + t / 2.0f * (1.0f + t / 3.0f * (1.0f + t / 4.0f * (1.0f + t / 5.0f * (1.0f + t / 6.0f * (1.0f + t / 7.0f))))));
+    dsp_float_bits_t scale = { .u = (uint32_t)(i + 127) << 23 };
+    return frac * scale.f;
+}
+
+void dsp_init(void) {
+    if (dsp_initialized) {
+        return;
+    }
+    for (uint32_t k = 0; k < DSP_FFT_MAX_N / 2; k++) {
+        float a = 2.0f * DSP_PI * (float)k / (float)DSP_FFT_MAX_N;
+        float c = dsp_cosf(a) * 32767.0f;
+        float s = dsp_sinf(a) * 32767.0f;
+        twiddle_cos[k] = (int16_t)(c + (c >= 0.0f ? 0.5f : -0.5f));
+        twiddle_sin[k] = (int16_t)(s + (s >= 0.0f ? 0.5f : -0.5f));
+    }
+    for (uint32_t i = 0; i <= (1u << DSP_LOG2_TABLE_BITS); i++) {
+        float v = dsp_log2f(1.0f + (float)i / (float)(1u << DSP_LOG2_TABLE_BITS));
+        log2_table[i] = (uint16_t)(v * (float)(1u << DSP_LOG2_FRAC_BITS) + 0.5f);
+    }
+    dsp_initialized = true;
+}
+
+int32_t dsp_normalize_q15(int16_t *x, size_t n) {
+    uint32_t peak = 0;
+    for (size_t i = 0; i < n; i++) {
+        uint32_t a = (uint32_t)((x[i] < 0) ? -(int32_t)x[i] : x[i]);
+        if (a > peak) {
+            peak = a;
+        }
+    }
+    if (peak == 0) {
+        return 0;
+    }
+
+    int32_t shift = 0;
+    while (peak >= (1u << 14)) {
+        peak >>= 1;
+        shift--;
+    }
+    while (peak < (1u << 13)) {
+        peak <<= 1;
+        shift++;
+    }
+    if (shift > 0) {
+        for (size_t i = 0; i < n; i++) {
+            x[i] = (int16_t)(x[i] * (1 << shift));
+        }
+    } else if (shift < 0) {
+        for (size_t i = 0; i < n; i++) {
+            x[i] = (int16_t)(x[i] >> -shift);
+        }
+    }
+    return shift;
+}
+
+uint32_t dsp_fft_q15(int16_t *re, int16_t *im, uint32_t log2n) {
+    const uint32_t n = 1u << log2n;
+
+    // 位反转重排，同时求出各分量的峰值
+    uint32_t peak = 0;
+    for (uint32_t i = 1, j = 0; i < n; i++) {
+        uint32_t bit = n >> 1;
+        for (; j & bit; bit >>= 1) {
+            j ^= bit;
+        }
+        j ^= bit;
+        if (i < j) {
+            int16_t t = re[i]; re[i] = re[j]; re[j] = t;
+            t = im[i]; im[i] = im[j]; im[j] = t;
+        }
+    }
+    for (uint32_t i = 0; i < n; i++) {
+        uint32_t a = (uint32_t)((re[i] < 0) ? -(int32_t)re[i] : re[i]) | (uint32_t)((im[i] < 0) ? -(int32_t)im[i] : im[i]);
+        peak |= a;
+    }
+
+    // 蝶形运算，W = cos - j*sin。块浮点：只有当本级输入的分量可能达到 2^13 (复数模可能在本级翻倍后溢出) 时才右移一位，
+    // 低电平信号因此保留更多有效位。peak 用按位或近似最大值，只会偏保守。
+    uint32_t scaled_stages = 0;
+    for (uint32_t len = 2; len <= n; len <<= 1) {
+        const uint32_t half = len >> 1;
+        const uint32_t step = DSP_FFT_MAX_N / len;
+        const uint32_t scale = (peak >= (1u << 13)) ? 1u : 0u;
+        scaled_stages += scale;
+        peak = 0;
+        for (uint32_t i = 0; i < n; i += len) {
+            for (uint32_t k = 0; k < half; k++) {
+                int32_t wr = twiddle_cos[k * step];
+                int32_t wi = twiddle_sin[k * step];
+                uint32_t a = i + k;
+                uint32_t b = a + half;
+                int32_t tr = ((int32_t)re[b] * wr + (int32_t)im[b] * wi + (1 << 14)) >> 15;
+                int32_t ti = ((int32_t)im[b] * wr - (int32_t)re[b] * wi + (1 << 14)) >> 15;
+                int32_t ur = re[a];
+                int32_t ui = im[a];
+                int32_t v0 = (ur + tr) >> scale;
+                int32_t v1 = (ui + ti) >> scale;
+                int32_t v2 = (ur - tr) >> scale;
+                int32_t v3 = (ui - ti) >> scale;
+                re[a] = (int16_t)v0;
+                im[a] = (int16_t)v1;
+                re[b] = (int16_t)v2;
+                im[b] = (int16_t)v3;
+                peak |= (uint32_t)((v0 < 0) ? -v0 : v0) | (uint32_t)((v1 < 0) ? -v1 : v1) |
+                        (uint32_t)((v2 < 0) ? -v2 : v2) | (uint32_t)((v3 < 0) ? -v3 : v3);
+            }
+        }
+    }
+    return scaled_stages;
+}
+
+void dsp_power_spectrum(const int16_t *re, const int16_t *im, uint32_t *power, size_t n_bins) {
+    for (size_t k = 0; k < n_bins; k++) {
+        power[k] = (uint32_t)((int32_t)re[k] * re[k]) + (uint32_t)((int32_t)im[k] * im[k]);
+    }
+}
+
+int32_t dsp_log2_q10(uint64_t x) {
+    if (x == 0) {
+        return 0;
+    }
+    int32_t e = 63 - __builtin_clzll(x);
+    uint32_t frac = (e >= 16) ? (uint32_t)(x >> (e - 16)) : (uint32_t)(x << (16 - e));
+    frac &= 0xFFFFu;                            // 尾数的小数部分，Q16
+
+    // 查表 + 线性插值
+    uint32_t idx = frac >> (16 - DSP_LOG2_TABLE_BITS);
+    uint32_t t = frac & ((1u << (16 - DSP_LOG2_TABLE_BITS)) - 1u);
+    int32_t v = log2_table[idx] + (int32_t)(((log2_table[idx + 1] - log2_table[idx]) * t) >> (16 - DSP_LOG2_TABLE_BITS));
+    return e * (1 << DSP_LOG2_FRAC_BITS) + v;
+}
+
+static float dsp_hz_to_mel(float hz) {
+    return 2595.0f * DSP_LOG10_2 * dsp_log2f(1.0f + hz / 700.0f);
+}
+
+static float dsp_mel_to_hz(float mel) {
+    return 700.0f * (dsp_exp2f(mel / 2595.0f * DSP_LOG2_10) - 1.0f);
+}
+
+bool dsp_mel_init(dsp_mel_filterbank_t *fb, uint32_t log2n, uint32_t sample_rate_hz,
+                  uint32_t n_bands, float fmin_hz, float fmax_hz) {
+    if (fb == NULL || log2n > DSP_FFT_MAX_LOG2N || n_bands == 0 || n_bands > DSP_MEL_MAX_BANDS ||
+        fmin_hz < 0.0f || fmax_hz <= fmin_hz || fmax_hz > (float)sample_rate_hz * 0.5f) {
+        return false;
+    }
+
+    memset(fb, 0, sizeof(*fb));
+    const uint32_t n_bins = (1u << log2n) / 2u + 1u;
+    const float bin_hz = (float)sample_rate_hz / (float)(1u << log2n);
+    const float mel_lo = dsp_hz_to_mel(fmin_hz);
+    const float mel_step = (dsp_hz_to_mel(fmax_hz) - mel_lo) / (float)(n_bands + 1);
+    uint32_t offset = 0;
+
+    for (uint32_t m = 0; m < n_bands; m++) {
+        float f_lo = dsp_mel_to_hz(mel_lo + mel_step * (float)m);
+        float f_c = dsp_mel_to_hz(mel_lo + mel_step * (float)(m + 1));
+        float f_hi = dsp_mel_to_hz(mel_lo + mel_step * (float)(m + 2));
+        uint32_t k_lo = (uint32_t)(f_lo / bin_hz) + 1u;
+        uint32_t k_hi = (uint32_t)(f_hi / bin_hz);
+        if (k_hi >= n_bins) {
+            k_hi = n_bins - 1u;
+        }
+
+        fb->first_bin[m] = (uint16_t)k_lo;
+        fb->weight_offset[m] = (uint16_t)offset;
+        uint32_t count = 0;
+        for (uint32_t k = k_lo; k <= k_hi; k++) {
+            float f = (float)k * bin_hz;
+            float w = (f <= f_c) ? (f - f_lo) / (f_c - f_lo) : (f_hi - f) / (f_hi - f_c);
+            if (w <= 0.0f) {
+                break;
+            }
+            if (offset + count >= DSP_MEL_MAX_WEIGHTS) {
+                return false;
+            }
+            fb->weights[offset + count] = (uint16_t)((w >= 1.0f) ? 65535.0f : w * 65535.0f + 0.5f);
+            count++;
+        }
+        if (count == 0) {
+            // 频带比频点间距还窄：取离中心最近的频点，避免出现恒为零的频带
+            if (offset >= DSP_MEL_MAX_WEIGHTS) {
+                return false;
+            }
+            fb->first_bin[m] = (uint16_t)(f_c / bin_hz + 0.5f);
+            fb->weights[offset] = 65535u;
+            count = 1;
+        }
+        fb->bin_count[m] = (uint16_t)count;
+        offset += count;
+    }
+    fb->n_bands = (uint16_t)n_bands;
+    fb->n_bins = (uint16_t)n_bins;
+    return true;
+}
+
+void dsp_mel_apply(const dsp_mel_filterbank_t *fb, const uint32_t *power, uint64_t *bands) {
+    for (uint32_t m = 0; m < fb->n_bands; m++) {
+        const uint32_t *p = &power[fb->first_bin[m]];
+        const uint16_t *w = &fb->weights[fb->weight_offset[m]];
+        uint64_t acc = 0;
+        for (uint32_t k = 0; k < fb->bin_count[m]; k++) {
+            acc += (uint64_t)p[k] * w[k];
+        }
+        bands[m] = acc >> 16;
+    }
+}
@@ -0,0 +1,57 @@
+#ifndef DSP_H_
+#define DSP_H_
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+// 音频特征提取共用的小型 DSP 工具：不依赖 libm 的浮点近似 (只在初始化时使用)、
+// 块浮点 Q15 基 2 FFT、定点 log2，以及三角 mel 滤波器组。
+
+#define DSP_FFT_MAX_LOG2N     (9)
+#define DSP_FFT_MAX_N         (1u << DSP_FFT_MAX_LOG2N)   // 512 点
+#define DSP_LOG2_FRAC_BITS    (10)                        // dsp_log2_q10() 的小数位数
+
+#define DSP_MEL_MAX_BANDS     (80)
+#define DSP_MEL_MAX_WEIGHTS   (DSP_FFT_MAX_N + 2 + DSP_MEL_MAX_BANDS) // 每个频点最多属于两个相邻频带，另加窄频带的兜底频点
+
+// 在调用任何 FFT/log2 函数前调用一次 (重复调用无副作用)
+void dsp_init(void);
+
+// 浮点近似，精度约 1e-6，用于初始化时生成窗函数、滤波器和 mel 刻度
+float dsp_sinf(float x);
+float dsp_cosf(float x);
+float dsp_log2f(float x);   // x > 0
+float dsp_exp2f(float x);
+
+// 原地移位 x[0..n-1] 使峰值落在 [2^13, 2^14)，为 FFT 留出余量。返回左移位数 (负数表示右移，全零时返回 0)。
+int32_t dsp_normalize_q15(int16_t *x, size_t n);
+
+// 原地 2^log2n 点复数 FFT (log2n <= DSP_FFT_MAX_LOG2N)，块浮点：只在可能溢出的级右移一位。
+// 返回右移的级数 s，输出为真实 DFT 的 2^-s。输入的复数模须不超过 2^14 (dsp_normalize_q15() 的输出满足此条件)。
+uint32_t dsp_fft_q15(int16_t *re, int16_t *im, uint32_t log2n);
+
+// 前 n_bins 个频点的功率 re^2 + im^2
+void dsp_power_spectrum(const int16_t *re, const int16_t *im, uint32_t *power, size_t n_bins);
+
+// log2(x)，Q10 定点 (x = 0 时返回 0)。误差不超过一个 Q10 单位。
+int32_t dsp_log2_q10(uint64_t x);
+
+// 三角 mel 滤波器组 (HTK 刻度，峰值为 1)，权重按频带连续存放
+typedef struct {
+    uint16_t n_bands;
+    uint16_t n_bins;                                // 使用的频点数 (n_fft / 2 + 1)
+    uint16_t first_bin[DSP_MEL_MAX_BANDS];
+    uint16_t bin_count[DSP_MEL_MAX_BANDS];
+    uint16_t weight_offset[DSP_MEL_MAX_BANDS];
+    uint16_t weights[DSP_MEL_MAX_WEIGHTS];          // Q16，65535 约等于 1
+} dsp_mel_filterbank_t;
+
+// 在 [fmin_hz, fmax_hz] 内均匀划分 mel 刻度。窄于频点间距的低频带至少取离中心最近的一个频点。
+bool dsp_mel_init(dsp_mel_filterbank_t *fb, uint32_t log2n, uint32_t sample_rate_hz,
+                  uint32_t n_bands, float fmin_hz, float fmax_hz);
+
+// 对功率谱加权求和，bands 为 n_bands 个频带能量 (与 power 同单位)
+void dsp_mel_apply(const dsp_mel_filterbank_t *fb, const uint32_t *power, uint64_t *bands);
+
+#endif /* DSP_H_ */
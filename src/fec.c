@@ -0,0 +1,154 @@
+#include "fec.h"
+#include "byte_order.h"
+#include <string.h>
+
+// 帧头字段的字节偏移，与 audio_frame_header_t 一致
+#define FEC_OFFSET_VERSION      (0)
+#define FEC_OFFSET_FLAGS        (1)
+#define FEC_OFFSET_CHANNELS     (2)
+#define FEC_OFFSET_FORMAT       (3)
+#define FEC_OFFSET_SAMPLE_RATE  (4)
+#define FEC_OFFSET_NUM_SAMPLES  (6)
+#define FEC_OFFSET_SEQUENCE     (8)
+#define FEC_OFFSET_TIMESTAMP    (12)
+#define FEC_HEADER_VERSION      (1)
+
+static void xor_bytes(uint8_t *dst, const uint8_t *src, size_t len) {
+    for (size_t i = 0; i < len; i++) {
+        dst[i] ^= src[i];
+    }
+}
+
+void fec_encoder_init(fec_encoder_t *enc, uint8_t *buffer, size_t capacity, uint32_t group_size) {
+    memset(enc, 0, sizeof(*enc));
+    enc->buffer = buffer;
+    enc->capacity = capacity;
+    if (!fec_encoder_set_group_size(enc, group_size)) {
+        enc->requested_group_size = 0;
+    }
+}
+
+bool fec_encoder_set_group_size(fec_encoder_t *enc, uint32_t group_size) {
+    if (group_size != 0 && (group_size < FEC_MIN_GROUP_SIZE || group_size > FEC_MAX_GROUP_SIZE)) {
+        return false;
+    }
+    enc->requested_group_size = group_size;
+    return true;
+}
+
+// 写入校验包帧头并结束当前组，返回校验包长度
+static size_t fec_finish_group(fec_encoder_t *enc) {
+    uint8_t *h = enc->buffer;
+    h[FEC_OFFSET_VERSION] = FEC_HEADER_VERSION;
+    h[FEC_OFFSET_FLAGS] = FEC_FRAME_FLAG_PARITY;
+    h[FEC_OFFSET_CHANNELS] = (uint8_t)enc->group_size;
+    h[FEC_OFFSET_FORMAT] = FEC_FRAME_FORMAT_XOR;
+    put_le16(&h[FEC_OFFSET_SAMPLE_RATE], enc->mask);
+    put_le16(&h[FEC_OFFSET_NUM_SAMPLES], enc->length);
+    put_le32(&h[FEC_OFFSET_SEQUENCE], enc->base_sequence);
+    put_le32(&h[FEC_OFFSET_TIMESTAMP], enc->last_timestamp);
+    size_t len = FEC_HEADER_SIZE + enc->length;
+    enc->mask = 0;
+    return len;
+}
+
+size_t fec_encoder_close_before(fec_encoder_t *enc, uint32_t sequence) {
+    if (enc->mask == 0) {
+        return 0;
+    }
+    // 序号回退 (无符号差值溢出) 同样视为组外
+    if (sequence - enc->base_sequence < enc->group_size) {
+        return 0;
+    }
+    return fec_finish_group(enc);
+}
+
+size_t fec_encoder_add(fec_encoder_t *enc, const uint8_t *packet, size_t packet_len) {
+    if (packet_len < FEC_HEADER_SIZE || FEC_PARITY_BUFFER_SIZE(packet_len) > enc->capacity ||
+        FEC_LENGTH_PREFIX_SIZE + packet_len > UINT16_MAX) {
+        return 0;
+    }
+    uint32_t sequence = get_le32(&packet[FEC_OFFSET_SEQUENCE]);
+
+    if (enc->mask == 0) {
+        // 组大小只在组边界切换，保证同一组内的基序号和位图一致
+        enc->group_size = enc->requested_group_size;
+        if (enc->group_size == 0) {
+            return 0;
+        }
+        enc->base_sequence = sequence - sequence % enc->group_size;
+        enc->length = 0;
+    } else if (sequence - enc->base_sequence >= enc->group_size) {
+        return 0;                                   // 调用者未先调用 fec_encoder_close_before()
+    }
+
+    uint32_t offset = sequence - enc->base_sequence;
+    uint8_t *acc = &enc->buffer[FEC_HEADER_SIZE];
+    uint16_t len = (uint16_t)(FEC_LENGTH_PREFIX_SIZE + packet_len);
+    if (len > enc->length) {
+        memset(&acc[enc->length], 0, len - enc->length);
+        enc->length = len;
+    }
+    uint8_t prefix[FEC_LENGTH_PREFIX_SIZE];
+    put_le16(prefix, (uint16_t)packet_len);
+    xor_bytes(acc, prefix, sizeof(prefix));
+    xor_bytes(&acc[FEC_LENGTH_PREFIX_SIZE], packet, packet_len);
+    enc->mask |= (uint16_t)(1u << offset);
+    enc->last_timestamp = get_le32(&packet[FEC_OFFSET_TIMESTAMP]);
+
+    if (offset == enc->group_size - 1u) {
+        return fec_finish_group(enc);
+    }
+    return 0;
+}
+
+size_t fec_recover(const uint8_t *parity, size_t parity_len, const uint8_t *const packets[], const size_t lens[],
+                   uint8_t *out, size_t out_capacity) {
+    if (parity_len < FEC_HEADER_SIZE || parity[FEC_OFFSET_FORMAT] != FEC_FRAME_FORMAT_XOR ||
+        !(parity[FEC_OFFSET_FLAGS] & FEC_FRAME_FLAG_PARITY)) {
+        return 0;
+    }
+    uint32_t group_size = parity[FEC_OFFSET_CHANNELS];
+    uint16_t mask = get_le16(&parity[FEC_OFFSET_SAMPLE_RATE]);
+    size_t length = get_le16(&parity[FEC_OFFSET_NUM_SAMPLES]);
+    if (group_size > FEC_MAX_GROUP_SIZE || FEC_HEADER_SIZE + length > parity_len || length > out_capacity + FEC_LENGTH_PREFIX_SIZE ||
+        length < FEC_LENGTH_PREFIX_SIZE) {
+        return 0;
+    }
+
+    int32_t missing = -1;
+    for (uint32_t i = 0; i < group_size; i++) {
+        if ((mask & (1u << i)) && packets[i] == NULL) {
+            if (missing >= 0) {
+                return 0;                           // 丢失超过一帧，XOR 无法恢复
+            }
+            missing = (int32_t)i;
+        }
+    }
+    if (missing < 0) {
+        return 0;
+    }
+
+    // out 中依次放入长度前缀和帧内容，最后去掉前缀
+    uint8_t acc[FEC_LENGTH_PREFIX_SIZE];
+    memcpy(acc, &parity[FEC_HEADER_SIZE], sizeof(acc));
+    memcpy(out, &parity[FEC_HEADER_SIZE + FEC_LENGTH_PREFIX_SIZE], length - FEC_LENGTH_PREFIX_SIZE);
+    for (uint32_t i = 0; i < group_size; i++) {
+        if (!(mask & (1u << i)) || (int32_t)i == missing) {
+            continue;
+        }
+        if (lens[i] + FEC_LENGTH_PREFIX_SIZE > length) {
+            return 0;                               // 与校验包不一致
+        }
+        uint8_t prefix[FEC_LENGTH_PREFIX_SIZE];
+        put_le16(prefix, (uint16_t)lens[i]);
+        xor_bytes(acc, prefix, sizeof(prefix));
+        xor_bytes(out, packets[i], lens[i]);
+    }
+
+    size_t recovered_len = get_le16(acc);
+    if (recovered_len < FEC_HEADER_SIZE || recovered_len + FEC_LENGTH_PREFIX_SIZE > length) {
+        return 0;
+    }
+    return recovered_len;
+}
@@ -0,0 +1,59 @@
+#ifndef FEC_H_
+#define FEC_H_
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+// QoS0 音频流的 XOR 前向纠错：按帧序号把流划分为每 N 帧一组 (基序号为 N 的整数倍)，
+// 每组发送一个校验包，接收端在一组内丢失一帧时无需重传即可恢复。开销为 1/N。
+// 只依赖 16 字节帧头的字节布局 (见 audio_task.h)，不依赖 RTOS，接收端可直接复用 fec_recover()。
+//
+// 校验包使用与音频帧相同的帧头，字段含义如下 (小端)：
+//   flags = FEC_FRAME_FLAG_PARITY，format = FEC_FRAME_FORMAT_XOR，channels = 组大小 N，
+//   sample_rate_hz = 覆盖位图 (位 i 表示序号 sequence + i 的帧参与了校验；上游已丢弃的帧不参与)，
+//   num_samples = 负载字节数，sequence = 组基序号，timestamp_ms = 组内最后一帧的时间戳。
+// 负载为组内各帧 [2 字节小端长度 | 帧头 + 负载] 按最长者补零后的逐字节异或，恢复出的长度前缀给出原始帧长。
+
+#define FEC_FRAME_FORMAT_XOR        (2)
+#define FEC_FRAME_FLAG_PARITY       (1u << 1)
+#define FEC_HEADER_SIZE             (16)
+#define FEC_LENGTH_PREFIX_SIZE      (2)
+#define FEC_MAX_GROUP_SIZE          (16)    // 覆盖位图为 16 位
+#define FEC_MIN_GROUP_SIZE          (2)
+
+// 校验包缓冲所需的字节数 (max_packet_len 为最长的帧头 + 负载)
+#define FEC_PARITY_BUFFER_SIZE(max_packet_len) (FEC_HEADER_SIZE + FEC_LENGTH_PREFIX_SIZE + (max_packet_len))
+
+typedef struct {
+    uint8_t *buffer;                // 校验包：帧头 + 异或累加区，由调用者提供
+    size_t capacity;                // buffer 字节数
+    uint32_t group_size;            // 当前组的大小，0 表示未启用
+    uint32_t requested_group_size;  // 下一组开始时生效
+    uint32_t base_sequence;
+    uint32_t last_timestamp;
+    uint16_t mask;                  // 当前组已累加的帧，0 表示组为空
+    uint16_t length;                // 异或累加区的有效字节数
+} fec_encoder_t;
+
+// buffer 至少为 FEC_PARITY_BUFFER_SIZE(最长帧)。group_size 为 0 时不生成校验包。
+void fec_encoder_init(fec_encoder_t *enc, uint8_t *buffer, size_t capacity, uint32_t group_size);
+
+// 修改组大小 (0 或 FEC_MIN_GROUP_SIZE ~ FEC_MAX_GROUP_SIZE)，从下一组开始生效。不受支持时返回 false。
+bool fec_encoder_set_group_size(fec_encoder_t *enc, uint32_t group_size);
+
+// 在发送序号为 sequence 的帧之前调用：若该帧不属于当前组 (组内后面的帧已被上游丢弃)，
+// 则结束当前组并返回待发送的校验包长度 (包在 enc->buffer 中)，否则返回 0。
+size_t fec_encoder_close_before(fec_encoder_t *enc, uint32_t sequence);
+
+// 在发送一帧 (帧头 + 负载) 之后调用，将其累加到校验包。该帧是组内最后一个序号时
+// 返回待发送的校验包长度，否则返回 0。未启用或帧过长时忽略该帧。
+size_t fec_encoder_add(fec_encoder_t *enc, const uint8_t *packet, size_t packet_len);
+
+// 接收端：用校验包和同组已收到的帧恢复唯一丢失的一帧。
+// packets[i] / lens[i] 为序号 sequence + i 的帧 (未收到时为 NULL)，i < 组大小。
+// 恰好丢失一个参与校验的帧时写入 out (至少为校验负载长度) 并返回其长度，否则返回 0。
+size_t fec_recover(const uint8_t *parity, size_t parity_len, const uint8_t *const packets[], const size_t lens[],
+                   uint8_t *out, size_t out_capacity);
+
+#endif /* FEC_H_ */
@@ -0,0 +1,159 @@
+#include "frame_fanout.h"
+#include <string.h>
+
+static uint32_t slot_of(const frame_fanout_t *fo, uint32_t seq) {
+    return seq % fo->depth;
+}
+
+// 环尾越过已无人持有的格
+static void advance_tail(frame_fanout_t *fo) {
+    while (fo->tail != fo->head && fo->holders[slot_of(fo, fo->tail)] == 0) {
+        fo->frames[slot_of(fo, fo->tail)] = NULL;
+        fo->tail++;
+    }
+}
+
+static void release_slot(frame_fanout_t *fo, int sink, uint32_t seq) {
+    uint32_t slot = slot_of(fo, seq);
+    fo->holders[slot] &= (uint8_t)~(1u << sink);
+    fo->sinks[sink].stats.lag--;
+    fo->release(fo->frames[slot]);
+}
+
+// 扫描 sink 持有的格的起点。游标落在环尾之前时从环尾开始：环尾之前的格已无人持有，
+// 其槽位可能已被新帧复用，按旧序号访问会读到 (或释放) 下一圈的帧
+static uint32_t scan_start(const frame_fanout_t *fo, int sink) {
+    uint32_t seq = fo->sinks[sink].cursor;
+    return (fo->head - seq > fo->head - fo->tail) ? fo->tail : seq;
+}
+
+// sink 持有的最旧一格，没有时返回 head
+static uint32_t first_held(const frame_fanout_t *fo, int sink) {
+    uint32_t seq = scan_start(fo, sink);
+    while (seq != fo->head && !(fo->holders[slot_of(fo, seq)] & (1u << sink))) {
+        seq++;
+    }
+    return seq;
+}
+
+static void drop_oldest(frame_fanout_t *fo, int sink) {
+    uint32_t seq = first_held(fo, sink);
+    if (seq != fo->head) {
+        release_slot(fo, sink, seq);
+        fo->sinks[sink].cursor = seq + 1u;
+        fo->sinks[sink].stats.dropped++;
+    }
+}
+
+void frame_fanout_init(frame_fanout_t *fo, uint32_t depth, void (*retain)(void *frame), void (*release)(void *frame)) {
+    memset(fo, 0, sizeof(*fo));
+    fo->depth = (depth == 0 || depth > FRAME_FANOUT_MAX_DEPTH) ? FRAME_FANOUT_MAX_DEPTH : depth;
+    fo->retain = retain;
+    fo->release = release;
+}
+
+int frame_fanout_add_sink(frame_fanout_t *fo, frame_fanout_policy_t policy, uint32_t max_lag) {
+    if (max_lag == 0 || max_lag > fo->depth) {
+        return -1;
+    }
+    for (int i = 0; i < FRAME_FANOUT_MAX_SINKS; i++) {
+        frame_fanout_sink_t *s = &fo->sinks[i];
+        if (!s->active) {
+            memset(s, 0, sizeof(*s));
+            s->active = true;
+            s->policy = policy;
+            s->max_lag = max_lag;
+            s->cursor = fo->head;   // 只接收加入之后的帧
+            return i;
+        }
+    }
+    return -1;
+}
+
+void frame_fanout_remove_sink(frame_fanout_t *fo, int sink) {
+    if (sink < 0 || sink >= FRAME_FANOUT_MAX_SINKS || !fo->sinks[sink].active) {
+        return;
+    }
+    for (uint32_t seq = scan_start(fo, sink); seq != fo->head; seq++) {
+        if (fo->holders[slot_of(fo, seq)] & (1u << sink)) {
+            release_slot(fo, sink, seq);
+        }
+    }
+    fo->sinks[sink].active = false;
+    advance_tail(fo);
+}
+
+uint32_t frame_fanout_push(frame_fanout_t *fo, void *frame) {
+    // 环满：最旧一格的持有者都落后了 depth 帧，被迫丢弃
+    if (fo->head - fo->tail == fo->depth) {
+        uint8_t holders = fo->holders[slot_of(fo, fo->tail)];
+        for (int i = 0; i < FRAME_FANOUT_MAX_SINKS; i++) {
+            if (holders & (1u << i)) {
+                release_slot(fo, i, fo->tail);
+                fo->sinks[i].stats.dropped++;
+                if (fo->sinks[i].cursor == fo->tail) {
+                    fo->sinks[i].cursor++;
+                }
+            }
+        }
+        advance_tail(fo);
+    }
+
+    uint32_t slot = slot_of(fo, fo->head);
+    uint8_t holders = 0;
+    for (int i = 0; i < FRAME_FANOUT_MAX_SINKS; i++) {
+        frame_fanout_sink_t *s = &fo->sinks[i];
+        if (!s->active) {
+            continue;
+        }
+        if (s->stats.lag >= s->max_lag) {
+            if (s->policy == FRAME_FANOUT_DROP_NEWEST) {
+                s->stats.dropped++;
+                continue;
+            }
+            drop_oldest(fo, i);
+        }
+        fo->retain(frame);
+        holders |= (uint8_t)(1u << i);
+        if (++s->stats.lag > s->stats.lag_max) {
+            s->stats.lag_max = s->stats.lag;
+        }
+    }
+
+    uint32_t takers = 0;
+    if (holders != 0) {
+        fo->frames[slot] = frame;
+        fo->holders[slot] = holders;
+        fo->head++;
+        for (uint8_t h = holders; h != 0; h &= (uint8_t)(h - 1u)) {
+            takers++;
+        }
+    }
+    advance_tail(fo);
+    return takers;
+}
+
+void *frame_fanout_peek(frame_fanout_t *fo, int sink) {
+    frame_fanout_sink_t *s = &fo->sinks[sink];
+    if (!s->active) {
+        return NULL;
+    }
+    s->cursor = first_held(fo, sink);
+    return (s->cursor == fo->head) ? NULL : fo->frames[slot_of(fo, s->cursor)];
+}
+
+void frame_fanout_consume(frame_fanout_t *fo, int sink) {
+    frame_fanout_sink_t *s = &fo->sinks[sink];
+    uint32_t seq = first_held(fo, sink);
+    if (!s->active || seq == fo->head) {
+        return;
+    }
+    release_slot(fo, sink, seq);
+    s->cursor = seq + 1u;
+    s->stats.delivered++;
+    advance_tail(fo);
+}
+
+void frame_fanout_get_sink_stats(const frame_fanout_t *fo, int sink, frame_fanout_sink_stats_t *stats) {
+    *stats = fo->sinks[sink].stats;
+}
@@ -0,0 +1,69 @@
+#ifndef FRAME_FANOUT_H_
+#define FRAME_FANOUT_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// 把同一路音频帧零拷贝地分发给多个 sink (例如归档主题、本地存储)。
+// 所有 sink 共享一个帧指针环，每格记录仍持有该帧的 sink (位掩码)，每个 sink 有自己的读游标、积压上限和丢帧策略：
+//   FRAME_FANOUT_DROP_OLDEST  积压达到上限时丢弃自己最旧的一帧，再接收新帧 (优先实时性)
+//   FRAME_FANOUT_DROP_NEWEST  积压达到上限时不接收新帧 (优先连续性)
+// 每个 sink 接收一帧时调用一次 retain，消费或丢弃时调用一次 release，帧的释放由调用者的引用计数决定。
+// 慢 sink 只丢自己的帧，不阻塞其他 sink；环满时最旧一格的持有者被迫丢弃该帧。
+// 与 fec.c 一样不依赖 RTOS，只在一个任务中调用。
+
+#define FRAME_FANOUT_MAX_SINKS    (4)
+#define FRAME_FANOUT_MAX_DEPTH    (16)
+
+typedef enum {
+    FRAME_FANOUT_DROP_OLDEST,
+    FRAME_FANOUT_DROP_NEWEST
+} frame_fanout_policy_t;
+
+typedef struct {
+    uint32_t delivered;             // 已消费的帧数
+    uint32_t dropped;               // 因积压上限或环满丢弃的帧数
+    uint32_t lag;                   // 当前积压帧数
+    uint32_t lag_max;
+} frame_fanout_sink_stats_t;
+
+typedef struct {
+    bool active;
+    frame_fanout_policy_t policy;
+    uint32_t max_lag;
+    uint32_t cursor;                // 下一个待检查的格 (绝对序号)
+    frame_fanout_sink_stats_t stats;
+} frame_fanout_sink_t;
+
+typedef struct {
+    void *frames[FRAME_FANOUT_MAX_DEPTH];
+    uint8_t holders[FRAME_FANOUT_MAX_DEPTH];    // 仍持有该格的 sink，置位数即该格的引用数
+    uint32_t depth;
+    uint32_t tail;                  // 最旧的仍被持有的格 (绝对序号)
+    uint32_t head;                  // 下一个写入的格 (绝对序号)
+    frame_fanout_sink_t sinks[FRAME_FANOUT_MAX_SINKS];
+    void (*retain)(void *frame);
+    void (*release)(void *frame);
+} frame_fanout_t;
+
+// depth 超过 FRAME_FANOUT_MAX_DEPTH 时按 FRAME_FANOUT_MAX_DEPTH
+void frame_fanout_init(frame_fanout_t *fo, uint32_t depth, void (*retain)(void *frame), void (*release)(void *frame));
+
+// 添加一个 sink，max_lag 为 1 ~ depth。成功返回 sink 编号，已满时返回 -1。
+int frame_fanout_add_sink(frame_fanout_t *fo, frame_fanout_policy_t policy, uint32_t max_lag);
+
+// 移除 sink 并释放它持有的帧
+void frame_fanout_remove_sink(frame_fanout_t *fo, int sink);
+
+// 把一帧分发给所有活动的 sink，返回接收该帧的 sink 数
+uint32_t frame_fanout_push(frame_fanout_t *fo, void *frame);
+
+// sink 的下一帧，没有时返回 NULL。帧在 frame_fanout_consume() 之前一直有效，调用者只能读取。
+void *frame_fanout_peek(frame_fanout_t *fo, int sink);
+
+// sink 已处理完 frame_fanout_peek() 返回的帧
+void frame_fanout_consume(frame_fanout_t *fo, int sink);
+
+void frame_fanout_get_sink_stats(const frame_fanout_t *fo, int sink, frame_fanout_sink_stats_t *stats);
+
+#endif /* FRAME_FANOUT_H_ */
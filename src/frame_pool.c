@@ -0,0 +1,100 @@
+#include "frame_pool.h"
+#include "task.h"
+
+static uint32_t index_of(const frame_pool_t *pool, const void *frame) {
+    return (uint32_t)(((const uint8_t *)frame - pool->frames) / pool->frame_size);
+}
+
+bool frame_pool_init(frame_pool_t *pool, void *frames, size_t frame_size, uint32_t count, QueueHandle_t free_queue,
+                     QueueHandle_t queue) {
+    if (count > FRAME_POOL_MAX_FRAMES || free_queue == NULL || queue == NULL) {
+        return false;
+    }
+    pool->frames = frames;
+    pool->frame_size = frame_size;
+    pool->count = count;
+    pool->queue = queue;
+    for (uint32_t i = 0; i < count; i++) {
+        void *frame = pool->frames + i * frame_size;
+        pool->energy[i] = 0;
+        pool->refs[i] = 0;
+        xQueueSend(free_queue, &frame, 0);
+    }
+    pool->free_queue = free_queue;
+    return true;
+}
+
+// 从输出队列中挤出能量最低且低于 new_energy 的帧并返回给调用方复用，其余帧按原顺序放回。
+// 挂起调度器，保证消费者在重排期间看不到一个被抽空的队列。新帧本身能量最低时返回 NULL。
+static void *evict_lowest_energy(frame_pool_t *pool, uint32_t new_energy) {
+    void *evicted = NULL;
+    uint32_t count = 0;
+    uint32_t victim = pool->count;
+    uint32_t min_energy = new_energy;
+
+    vTaskSuspendAll();
+    while (count < pool->count && xQueueReceive(pool->queue, &pool->scratch[count], 0) == pdPASS) {
+        uint32_t energy = pool->energy[index_of(pool, pool->scratch[count])];
+        if (energy < min_energy) {
+            min_energy = energy;
+            victim = count;
+        }
+        count++;
+    }
+    for (uint32_t i = 0; i < count; i++) {
+        if (i == victim) {
+            evicted = pool->scratch[i];
+        } else {
+            xQueueSend(pool->queue, &pool->scratch[i], 0);
+        }
+    }
+    (void)xTaskResumeAll();
+    return evicted;
+}
+
+void *frame_pool_acquire(frame_pool_t *pool, uint32_t energy, frame_pool_policy_t policy, bool *evicted) {
+    void *frame = NULL;
+    *evicted = false;
+    if (xQueueReceive(pool->free_queue, &frame, 0) != pdPASS) {
+        switch (policy) {
+            case FRAME_POOL_DROP_OLDEST:
+                if (xQueueReceive(pool->queue, &frame, 0) != pdPASS) {
+                    frame = NULL;
+                }
+                break;
+            case FRAME_POOL_DROP_LOWEST_ENERGY:
+                frame = evict_lowest_energy(pool, energy);
+                break;
+            case FRAME_POOL_DROP_NEWEST:
+            default:
+                break;
+        }
+        if (frame == NULL) {
+            return NULL;
+        }
+        *evicted = true;
+    }
+    // 挤出的帧在输出队列中时引用计数为 1，这里与空闲帧一样重新置 1
+    uint32_t index = index_of(pool, frame);
+    pool->refs[index] = 1;
+    pool->energy[index] = energy;
+    return frame;
+}
+
+void frame_pool_retain(frame_pool_t *pool, void *frame) {
+    taskENTER_CRITICAL();
+    pool->refs[index_of(pool, frame)]++;
+    taskEXIT_CRITICAL();
+}
+
+void frame_pool_release(frame_pool_t *pool, void *frame) {
+    if (frame == NULL || pool->free_queue == NULL) {
+        return;
+    }
+    taskENTER_CRITICAL();
+    bool last = (--pool->refs[index_of(pool, frame)] == 0);
+    taskEXIT_CRITICAL();
+    if (last) {
+        xQueueSend(pool->free_queue, &frame, 0);
+    }
+}
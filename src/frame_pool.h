@@ -0,0 +1,52 @@
+#ifndef FRAME_POOL_H_
+#define FRAME_POOL_H_
+
+#include "FreeRTOS.h"
+#include "queue.h"
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+// 定长帧缓冲池：空闲帧的指针放在 free_queue 中，生产者把填好的帧指针送入输出队列 queue，消费者用完后释放。
+// 每帧有一个引用计数 (扇出时多个 sink 共享同一帧，归零时才回到 free_queue) 和一个能量值。
+// 池耗尽时按策略处理新帧：
+//   FRAME_POOL_DROP_NEWEST        丢弃新帧，输出队列不变
+//   FRAME_POOL_DROP_OLDEST        从输出队列头部取出最旧的帧复用
+//   FRAME_POOL_DROP_LOWEST_ENERGY 挂起调度器，从输出队列中挤出能量最低且低于新帧的帧复用，其余帧按原顺序放回
+// 帧的内容和大小由调用者决定。只依赖 FreeRTOS 的队列和调度器接口，主机检查用 tools/host/shim/ 中的替身编译。
+// frame_pool_acquire() 只在生产者一个任务中调用；retain/release 可在任意任务中调用。
+
+#define FRAME_POOL_MAX_FRAMES    (128)
+
+typedef enum {
+    FRAME_POOL_DROP_NEWEST,
+    FRAME_POOL_DROP_OLDEST,
+    FRAME_POOL_DROP_LOWEST_ENERGY
+} frame_pool_policy_t;
+
+typedef struct {
+    uint8_t *frames;                // count 个 frame_size 字节的帧
+    size_t frame_size;
+    uint32_t count;
+    uint32_t energy[FRAME_POOL_MAX_FRAMES];     // 每帧的能量，只用于 DROP_LOWEST_ENERGY，不随帧发送
+    uint8_t refs[FRAME_POOL_MAX_FRAMES];        // 引用计数，空闲帧为 0，输出队列中的帧为 1
+    void *scratch[FRAME_POOL_MAX_FRAMES];       // 挤出时暂存输出队列的内容 (调度器挂起期间，不占任务栈)
+    QueueHandle_t free_queue;       // 容量至少为 count
+    QueueHandle_t queue;            // 输出队列，容量至少为 count，项为帧指针
+} frame_pool_t;
+
+// free_queue 和 queue 由调用者创建 (项大小为 sizeof(void *))，所有帧放入 free_queue。count 超过 FRAME_POOL_MAX_FRAMES 时返回 false。
+bool frame_pool_init(frame_pool_t *pool, void *frames, size_t frame_size, uint32_t count, QueueHandle_t free_queue,
+                     QueueHandle_t queue);
+
+// 取一个帧，引用计数置 1 并记录 energy。池耗尽时按 policy 从输出队列中挤出一帧复用，此时 *evicted 为 true
+// (被挤出的帧不会再被消费者看到)。返回 NULL 表示丢弃新帧。
+void *frame_pool_acquire(frame_pool_t *pool, uint32_t energy, frame_pool_policy_t policy, bool *evicted);
+
+// 增加一个引用 (只对已从输出队列取出的帧调用)
+void frame_pool_retain(frame_pool_t *pool, void *frame);
+
+// 释放一个引用，最后一个引用释放时帧回到 free_queue。frame 为 NULL 或池未初始化时不做任何事。
+void frame_pool_release(frame_pool_t *pool, void *frame);
+
+#endif /* FRAME_POOL_H_ */
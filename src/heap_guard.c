@@ -0,0 +1,115 @@
+#include "heap_guard.h"
+#include "app_config.h"
+#include "cy_syslib.h"
+
+#include <errno.h>
+#include <stddef.h>
+#include <string.h>
+
+#define HEAP_GUARD_RECORD_MAGIC (0x48475231u)   // "HGR1"
+
+// 链接器把对 _malloc_r 等的引用改为 __wrap_*，原来的实现以 __real_* 的名字保留。
+// newlib 的 malloc()/calloc()/realloc() 只是转调这些 _r 版本，因此不必单独截获
+struct _reent;
+void *__real__malloc_r(struct _reent *reent, size_t size);
+void *__real__realloc_r(struct _reent *reent, void *ptr, size_t size);
+
+void *__wrap__malloc_r(struct _reent *reent, size_t size);
+void *__wrap__calloc_r(struct _reent *reent, size_t count, size_t size);
+void *__wrap__realloc_r(struct _reent *reent, void *ptr, size_t size);
+
+// 只在调度器启动前由 main 写入，之后只读
+static TaskHandle_t forbidden_tasks[HEAP_GUARD_MAX_TASKS];
+static uint32_t forbidden_task_count;
+static heap_guard_stats_t stats;
+static CY_NOINIT heap_guard_violation_t reset_record;
+
+void heap_guard_forbid_task(TaskHandle_t task) {
+    if (forbidden_task_count < HEAP_GUARD_MAX_TASKS) {
+        forbidden_tasks[forbidden_task_count++] = task;
+    }
+}
+
+void heap_guard_get_stats(heap_guard_stats_t *out) {
+    taskENTER_CRITICAL();
+    *out = stats;
+    taskEXIT_CRITICAL();
+}
+
+bool heap_guard_take_reset_record(heap_guard_violation_t *out) {
+    if (reset_record.magic != HEAP_GUARD_RECORD_MAGIC) {
+        return false;
+    }
+    *out = reset_record;
+    out->task_name[sizeof(out->task_name) - 1] = '\0';
+    reset_record.magic = 0;
+    return true;
+}
+
+// 不能打印日志：printf 自己可能分配 (stdio 缓冲区)，会递归回到这里
+static void record_allocation(size_t size) {
+    uint32_t bytes = (uint32_t)size;
+    // 调度器启动前只有 main 在运行 (BSP、retarget-io 等的初始化)，不进入临界区
+    if (xTaskGetSchedulerState() == taskSCHEDULER_NOT_STARTED) {
+        stats.boot_allocations++;
+        stats.boot_bytes += bytes;
+        return;
+    }
+    bool in_isr = (xPortIsInsideInterrupt() != pdFALSE);
+    TaskHandle_t self = in_isr ? NULL : xTaskGetCurrentTaskHandle();
+    bool forbidden = in_isr;
+    for (uint32_t i = 0; i < forbidden_task_count; i++) {
+        if (forbidden_tasks[i] == self) {
+            forbidden = true;
+        }
+    }
+    // 中断中也可能调用到这里，使用可在中断中嵌套的临界区
+    UBaseType_t saved = taskENTER_CRITICAL_FROM_ISR();
+    stats.runtime_allocations++;
+    stats.runtime_bytes += bytes;
+    if (forbidden) {
+        stats.violations++;
+        stats.last_violation_task = self;
+        reset_record.size = bytes;
+        strncpy(reset_record.task_name, in_isr ? "ISR" : pcTaskGetName(self), sizeof(reset_record.task_name));
+        reset_record.magic = HEAP_GUARD_RECORD_MAGIC;
+    }
+    taskEXIT_CRITICAL_FROM_ISR(saved);
+#if (HEAP_GUARD_RESET_ON_VIOLATION == 1)
+    // 音频和 UI 任务的内存都在链接时确定，这里出现分配说明有代码绕过了静态分配。
+    // 不用 configASSERT：它在 Release 构建中为空。记录已写入 .noinit，复位后由 main 打印；
+    // 复位而不是原地停机，现场的设备不需要人工断电就能恢复
+    if (forbidden) {
+        taskDISABLE_INTERRUPTS();
+        NVIC_SystemReset();
+    }
+#endif
+}
+
+void *__wrap__malloc_r(struct _reent *reent, size_t size) {
+    record_allocation(size);
+    return __real__malloc_r(reent, size);
+}
+
+// 在截获后的 _malloc_r 之上实现，只计一次 (newlib 的 _calloc_r 内部会再调用 _malloc_r)。
+// 乘积溢出时按最大值记录并像 newlib 一样返回 NULL
+void *__wrap__calloc_r(struct _reent *reent, size_t count, size_t size) {
+    if (size != 0 && count > SIZE_MAX / size) {
+        record_allocation(SIZE_MAX);
+        errno = ENOMEM;
+        return NULL;
+    }
+    void *ptr = __wrap__malloc_r(reent, count * size);
+    if (ptr != NULL) {
+        memset(ptr, 0, count * size);
+    }
+    return ptr;
+}
+
+// newlib-nano 扩大块时内部会再调用 _malloc_r，字节数可能重复计入，违规判定不受影响。size 为 0 相当于 free，不计
+void *__wrap__realloc_r(struct _reent *reent, void *ptr, size_t size) {
+    if (size != 0) {
+        record_allocation(size);
+    }
+    return __real__realloc_r(reent, ptr, size);
+}
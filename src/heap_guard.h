@@ -0,0 +1,43 @@
+#ifndef HEAP_GUARD_H_
+#define HEAP_GUARD_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "FreeRTOS.h"
+#include "task.h"
+
+// 堆分配守卫：链接时用 --wrap 截获 newlib 的 _malloc_r/_calloc_r/_realloc_r (见 Makefile 的 LDFLAGS)，
+// malloc/calloc/realloc 以及 newlib 内部的分配 (stdio 缓冲区等) 都经过它们，统计调度器启动前后的分配。
+// 应用自己的对象 (任务、队列、定时器、事件组、帧缓冲池) 全部静态分配，音频和 UI 任务运行后不应再出现堆分配，
+// 在这两个任务或中断中发现分配视为违规：计数，并把违规写入复位后保留的 .noinit 记录，
+// HEAP_GUARD_RESET_ON_VIOLATION 为 1 时随即软件复位 (NVIC_SystemReset)，记录由 main 在下次启动时打印。这些不依赖 configASSERT，Release 构建 (NDEBUG) 中同样生效。
+// 网络任务和库线程 (WHD、lwIP、mbedTLS 握手、定时器任务) 按设计从堆分配，只计数。
+
+#define HEAP_GUARD_MAX_TASKS    (4)
+
+typedef struct {
+    uint32_t boot_allocations;      // 调度器启动前
+    uint32_t boot_bytes;
+    uint32_t runtime_allocations;   // 调度器启动后，所有任务
+    uint32_t runtime_bytes;
+    uint32_t violations;            // 发生在禁止分配的任务或中断中的次数
+    TaskHandle_t last_violation_task; // 中断中的违规为 NULL
+} heap_guard_stats_t;
+
+// 最近一次违规，保存在复位后保留的 RAM 中
+typedef struct {
+    uint32_t magic;
+    uint32_t size;                  // 请求的字节数 (calloc 的乘积溢出时为 SIZE_MAX)
+    char task_name[configMAX_TASK_NAME_LEN]; // 中断中为 "ISR"
+} heap_guard_violation_t;
+
+// 此后该任务中的堆分配都是违规。在调度器启动前调用
+void heap_guard_forbid_task(TaskHandle_t task);
+
+void heap_guard_get_stats(heap_guard_stats_t *out);
+
+// 取出上一次运行留下的违规记录 (例如违规后复位)，取出后清除。没有记录时返回 false
+bool heap_guard_take_reset_record(heap_guard_violation_t *out);
+
+#endif /* HEAP_GUARD_H_ */
@@ -0,0 +1,84 @@
+#include "heartbeat.h"
+#include "byte_order.h"
+#include <string.h>
+
+void heartbeat_init(heartbeat_t *hb, uint32_t interval_ms, uint32_t timeout_ms) {
+    memset(hb, 0, sizeof(*hb));
+    hb->interval_ms = interval_ms;
+    hb->timeout_ms = HEARTBEAT_MAX_TIMEOUT_MS;
+    (void)heartbeat_set_timeout(hb, timeout_ms);
+}
+
+bool heartbeat_set_timeout(heartbeat_t *hb, uint32_t timeout_ms) {
+    if (timeout_ms < HEARTBEAT_MIN_TIMEOUT_MS || timeout_ms > HEARTBEAT_MAX_TIMEOUT_MS) {
+        return false;
+    }
+    hb->timeout_ms = timeout_ms;
+    return true;
+}
+
+void heartbeat_start(heartbeat_t *hb, uint32_t now_ms) {
+    hb->running = hb->interval_ms > 0;
+    hb->armed = false;
+    hb->sent_any = false;
+    hb->first_sequence = hb->next_sequence;
+    hb->last_echo_ms = now_ms;
+}
+
+void heartbeat_stop(heartbeat_t *hb) {
+    hb->running = false;
+    hb->armed = false;
+}
+
+size_t heartbeat_poll(heartbeat_t *hb, uint32_t now_ms, uint8_t payload[HEARTBEAT_PAYLOAD_SIZE]) {
+    if (!hb->running || (hb->sent_any && (now_ms - hb->last_send_ms) < hb->interval_ms)) {
+        return 0;
+    }
+    put_le32(payload, hb->next_sequence++);
+    put_le32(&payload[4], now_ms);
+    hb->last_send_ms = now_ms;
+    hb->sent_any = true;
+    hb->stats.pings_sent++;
+    return HEARTBEAT_PAYLOAD_SIZE;
+}
+
+void heartbeat_on_echo(heartbeat_t *hb, const uint8_t *data, size_t len, uint32_t now_ms) {
+    if (!hb->running || len != HEARTBEAT_PAYLOAD_SIZE) {
+        hb->stats.stale_echoes++;
+        return;
+    }
+    // 只接受本次连接发出的心跳 (序号差按无符号比较，可跨回绕)
+    uint32_t sequence = get_le32(data);
+    if ((sequence - hb->first_sequence) >= (hb->next_sequence - hb->first_sequence)) {
+        hb->stats.stale_echoes++;
+        return;
+    }
+
+    uint32_t rtt_ms = now_ms - get_le32(&data[4]);
+    hb->stats.echoes_received++;
+    hb->stats.rtt_last_ms = rtt_ms;
+    if (hb->stats.echoes_received == 1) {
+        hb->stats.rtt_avg_ms = rtt_ms;
+    } else {
+        hb->stats.rtt_avg_ms = (hb->stats.rtt_avg_ms * 7u + rtt_ms) / 8u;
+    }
+    if (rtt_ms > hb->stats.rtt_max_ms) {
+        hb->stats.rtt_max_ms = rtt_ms;
+    }
+    hb->last_echo_ms = now_ms;
+    hb->armed = true;
+}
+
+bool heartbeat_check_dead(heartbeat_t *hb, uint32_t now_ms) {
+    if (!hb->running || !hb->armed) {
+        return false;
+    }
+    uint32_t silence_ms = now_ms - hb->last_echo_ms;
+    if (silence_ms < hb->timeout_ms) {
+        return false;
+    }
+    hb->stats.link_dead_events++;
+    hb->stats.detection_ms_last = silence_ms;
+    heartbeat_stop(hb);
+    return true;
+}
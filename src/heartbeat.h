@@ -0,0 +1,65 @@
+#ifndef HEARTBEAT_H_
+#define HEARTBEAT_H_
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+// 控制连接的应用层心跳：MQTT keep-alive 为 60 秒，TCP 连接无声断开时要 90 秒才触发断开事件，
+// 期间 QoS0 音频全部丢失。设备每 interval_ms 向 "MQTT_TOPIC_HEARTBEAT/<客户端 ID>" 发布一个心跳，
+// 服务端把负载原样回显到 "MQTT_TOPIC_HEARTBEAT_ECHO/<客户端 ID>"；超过 timeout_ms 没有收到回显即判定链路失效。
+//
+// 心跳负载 8 字节 (小端)：[0..3] 心跳序号，[4..7] 发送时间 (毫秒)。回显的往返时间由发送时间直接算出。
+// 只在本次连接收到第一个回显之后才会判定失效，服务端未部署回显时心跳不影响连接。
+// 与 fec.c 一样不依赖 RTOS，时间由调用者传入，可在主机上模拟链路故障测试。
+
+#define HEARTBEAT_PAYLOAD_SIZE      (8)
+#define HEARTBEAT_MIN_TIMEOUT_MS    (1000)
+#define HEARTBEAT_MAX_TIMEOUT_MS    (3000)
+
+typedef struct {
+    uint32_t pings_sent;
+    uint32_t echoes_received;
+    uint32_t stale_echoes;          // 来自上一次连接或格式错误而忽略的回显
+    uint32_t rtt_last_ms;
+    uint32_t rtt_avg_ms;            // 往返时间的指数平滑 (1/8)
+    uint32_t rtt_max_ms;
+    uint32_t link_dead_events;      // 判定链路失效的次数
+    uint32_t detection_ms_last;     // 最近一次判定时距最后一个回显的时间
+} heartbeat_stats_t;
+
+typedef struct {
+    uint32_t interval_ms;
+    uint32_t timeout_ms;
+    uint32_t next_sequence;
+    uint32_t first_sequence;        // 本次连接的第一个心跳序号，更早的回显不计入
+    uint32_t last_send_ms;
+    uint32_t last_echo_ms;
+    bool running;                   // 连接在线
+    bool armed;                     // 本次连接已收到回显，开始检测超时
+    bool sent_any;
+    heartbeat_stats_t stats;
+} heartbeat_t;
+
+// interval_ms 为 0 时不发送心跳；timeout_ms 须在 HEARTBEAT_MIN_TIMEOUT_MS ~ HEARTBEAT_MAX_TIMEOUT_MS 之间
+void heartbeat_init(heartbeat_t *hb, uint32_t interval_ms, uint32_t timeout_ms);
+
+// 修改失效判定时间，不受支持时返回 false
+bool heartbeat_set_timeout(heartbeat_t *hb, uint32_t timeout_ms);
+
+// 连接建立时调用，开始发送心跳
+void heartbeat_start(heartbeat_t *hb, uint32_t now_ms);
+
+// 连接断开时调用
+void heartbeat_stop(heartbeat_t *hb);
+
+// 到了发送时间时把心跳写入 payload 并返回其长度，否则返回 0
+size_t heartbeat_poll(heartbeat_t *hb, uint32_t now_ms, uint8_t payload[HEARTBEAT_PAYLOAD_SIZE]);
+
+// 处理一个回显，now_ms 为收到的时间
+void heartbeat_on_echo(heartbeat_t *hb, const uint8_t *data, size_t len, uint32_t now_ms);
+
+// 超过 timeout_ms 未收到回显时返回 true (每次连接只返回一次，之后停止心跳直到下一次 heartbeat_start())
+bool heartbeat_check_dead(heartbeat_t *hb, uint32_t now_ms);
+
+#endif /* HEARTBEAT_H_ */
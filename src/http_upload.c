@@ -0,0 +1,326 @@
+#include "http_upload.h"
+#include "app_config.h"
+
+#if (HTTP_UPLOAD_ENABLE == 1)
+
+#include "core_http_client.h"
+#include "cy_secure_sockets.h"
+#include "FreeRTOS.h"
+#include "task.h"
+#include <stdio.h> // 用于 printf，替换为适当的日志记录
+#include <string.h>
+
+#define APP_LOG_HTTP_INFO(format, ...) printf("[HTTP] " format "\n", ##__VA_ARGS__)
+#define APP_LOG_HTTP_ERROR(format, ...) printf("[HTTP ERROR] " format "\n", ##__VA_ARGS__)
+
+#define HTTP_STATUS_OK                 (200)
+#define HTTP_STATUS_CREATED            (201)
+#define HTTP_STATUS_RESUME_INCOMPLETE  (308)
+
+// 上传失败 (服务端返回了无法处理的状态码，或读取录音失败)
+#define HTTP_UPLOAD_RSLT_ERROR CY_RSLT_CREATE(CY_RSLT_TYPE_ERROR, CY_RSLT_MODULE_MIDDLEWARE_BASE, 0x37)
+
+// coreHTTP 传输接口的上下文
+struct NetworkContext {
+    cy_socket_t socket;
+};
+
+static NetworkContext_t network_context = { .socket = NULL };
+
+// 由其他任务请求，在网络任务中开始
+static http_upload_source_t pending_source;
+static volatile bool start_requested = false;
+static volatile bool cancel_requested = false;
+
+static http_upload_source_t source;
+static bool active = false;
+static bool offset_known = false;           // 连接建立后须先向服务端查询已收到的字节
+static uint32_t upload_offset = 0;
+static uint32_t upload_bytes = 0;           // 本次上传发出的负载字节
+static TickType_t upload_start_tick = 0;
+static bool retry_pending = false;
+static TickType_t retry_tick = 0;
+static uint32_t retry_delay_ms = HTTP_UPLOAD_RETRY_MS;
+
+static uint8_t segment_buffer[HTTP_UPLOAD_SEGMENT_SIZE];
+static uint8_t header_buffer[HTTP_UPLOAD_HEADER_BUFFER_SIZE];
+static uint8_t response_buffer[HTTP_UPLOAD_RESPONSE_BUFFER_SIZE];
+static char path_buffer[sizeof(HTTP_UPLOAD_PATH) + 1 + HTTP_UPLOAD_MAX_ID_LEN];
+
+static http_upload_stats_t upload_stats;
+
+static int32_t transport_send(NetworkContext_t *context, const void *buffer, size_t bytes_to_send) {
+    uint32_t sent = 0;
+    cy_rslt_t result = cy_socket_send(context->socket, buffer, (uint32_t)bytes_to_send, CY_SOCKET_FLAGS_NONE, &sent);
+    return (result == CY_RSLT_SUCCESS) ? (int32_t)sent : -1;
+}
+
+static int32_t transport_recv(NetworkContext_t *context, void *buffer, size_t bytes_to_recv) {
+    uint32_t received = 0;
+    cy_rslt_t result = cy_socket_recv(context->socket, buffer, (uint32_t)bytes_to_recv, CY_SOCKET_FLAGS_NONE, &received);
+    if (result == CY_RSLT_MODULE_SECURE_SOCKETS_TIMEOUT) {
+        return 0;
+    }
+    return (result == CY_RSLT_SUCCESS) ? (int32_t)received : -1;
+}
+
+static uint32_t get_time_ms(void) {
+    return (uint32_t)(xTaskGetTickCount() * portTICK_PERIOD_MS);
+}
+
+static const TransportInterface_t transport = {
+    .recv = transport_recv,
+    .send = transport_send,
+    .pNetworkContext = &network_context
+};
+
+static cy_rslt_t open_connection(void) {
+    cy_socket_sockaddr_t address = { .port = HTTP_UPLOAD_PORT };
+    cy_rslt_t result = cy_socket_gethostbyname(HTTP_UPLOAD_HOST, CY_SOCKET_IP_VER_V4, &address.ip_address);
+    if (result != CY_RSLT_SUCCESS) {
+        APP_LOG_HTTP_ERROR("Failed to resolve upload server: 0x%08X", (unsigned int)result);
+        return result;
+    }
+    result = cy_socket_create(CY_SOCKET_DOMAIN_AF_INET, CY_SOCKET_TYPE_STREAM, CY_SOCKET_IPPROTO_TCP, &network_context.socket);
+    if (result != CY_RSLT_SUCCESS) {
+        APP_LOG_HTTP_ERROR("Failed to create socket: 0x%08X", (unsigned int)result);
+        network_context.socket = NULL;
+        return result;
+    }
+    uint32_t timeout_ms = HTTP_UPLOAD_TIMEOUT_MS;
+    cy_socket_setsockopt(network_context.socket, CY_SOCKET_SOL_SOCKET, CY_SOCKET_SO_RCVTIMEO, &timeout_ms, sizeof(timeout_ms));
+    cy_socket_setsockopt(network_context.socket, CY_SOCKET_SOL_SOCKET, CY_SOCKET_SO_SNDTIMEO, &timeout_ms, sizeof(timeout_ms));
+    result = cy_socket_connect(network_context.socket, &address, sizeof(address));
+    if (result != CY_RSLT_SUCCESS) {
+        APP_LOG_HTTP_ERROR("Failed to connect to upload server: 0x%08X", (unsigned int)result);
+        http_upload_close();
+        return result;
+    }
+    upload_stats.connections++;
+    return CY_RSLT_SUCCESS;
+}
+
+void http_upload_close(void) {
+    if (network_context.socket != NULL) {
+        cy_socket_disconnect(network_context.socket, 0);
+        cy_socket_delete(network_context.socket);
+        network_context.socket = NULL;
+    }
+    offset_known = false;
+}
+
+// 解析 308 响应的 "Range: bytes=0-<最后一字节>"，返回服务端已连续收到的字节数；没有 Range 头表示一个字节都没有收到
+static uint32_t parse_committed_bytes(const HTTPResponse_t *response) {
+    const char *value = NULL;
+    size_t value_len = 0;
+    if (HTTPClient_ReadHeader(response, "Range", sizeof("Range") - 1, &value, &value_len) != HTTPSuccess) {
+        return 0;
+    }
+    const char *end = value + value_len;
+    const char *p = memchr(value, '-', value_len);
+    if (p == NULL) {
+        return 0;
+    }
+    uint32_t last = 0;
+    for (p++; p < end && *p >= '0' && *p <= '9'; p++) {
+        last = last * 10u + (uint32_t)(*p - '0');
+    }
+    return last + 1u;
+}
+
+// 发送一个 PUT：body 为 NULL 时查询进度 (bytes */总长)，否则上传 [offset, offset + len)。
+// 成功时 *committed 为服务端已收到的字节数。
+static cy_rslt_t send_put(const uint8_t *body, uint32_t offset, uint32_t len, uint32_t *committed) {
+    HTTPRequestInfo_t request_info = {
+        .pMethod = HTTP_METHOD_PUT,
+        .methodLen = sizeof(HTTP_METHOD_PUT) - 1,
+        .pPath = path_buffer,
+        .pathLen = strlen(path_buffer),
+        .pHost = HTTP_UPLOAD_HOST,
+        .hostLen = sizeof(HTTP_UPLOAD_HOST) - 1,
+        .reqFlags = HTTP_REQUEST_KEEP_ALIVE_FLAG
+    };
+    HTTPRequestHeaders_t headers = { .pBuffer = header_buffer, .bufferLen = sizeof(header_buffer) };
+    char content_range[48];
+    if (body == NULL) {
+        snprintf(content_range, sizeof(content_range), "bytes */%lu", (unsigned long)source.total_len);
+    } else {
+        snprintf(content_range, sizeof(content_range), "bytes %lu-%lu/%lu", (unsigned long)offset,
+                 (unsigned long)(offset + len - 1u), (unsigned long)source.total_len);
+    }
+
+    HTTPStatus_t status = HTTPClient_InitializeRequestHeaders(&headers, &request_info);
+    if (status == HTTPSuccess) {
+        status = HTTPClient_AddHeader(&headers, "Content-Type", sizeof("Content-Type") - 1, "application/octet-stream",
+                                      sizeof("application/octet-stream") - 1);
+    }
+    if (status == HTTPSuccess) {
+        status = HTTPClient_AddHeader(&headers, "Content-Range", sizeof("Content-Range") - 1, content_range, strlen(content_range));
+    }
+
+    HTTPResponse_t response = {
+        .pBuffer = response_buffer,
+        .bufferLen = sizeof(response_buffer),
+        .getTime = get_time_ms
+    };
+    if (status == HTTPSuccess) {
+        status = HTTPClient_Send(&transport, &headers, body, (body != NULL) ? len : 0, &response, 0);
+    }
+    if (status != HTTPSuccess) {
+        APP_LOG_HTTP_ERROR("PUT %s (%s) failed: %s", path_buffer, content_range, HTTPClient_strerror(status));
+        return HTTP_UPLOAD_RSLT_ERROR;
+    }
+
+    if (response.statusCode == HTTP_STATUS_RESUME_INCOMPLETE) {
+        *committed = parse_committed_bytes(&response);
+    } else if (response.statusCode == HTTP_STATUS_OK || response.statusCode == HTTP_STATUS_CREATED) {
+        *committed = source.total_len;
+    } else {
+        APP_LOG_HTTP_ERROR("PUT %s (%s) returned %u.", path_buffer, content_range, (unsigned int)response.statusCode);
+        return HTTP_UPLOAD_RSLT_ERROR;
+    }
+    if (response.respFlags & HTTP_RESPONSE_CONNECTION_CLOSE_FLAG) {
+        // 服务端不保持连接：下一段重新连接，但进度已知，无需再查询
+        http_upload_close();
+        offset_known = true;
+    }
+    return CY_RSLT_SUCCESS;
+}
+
+static void schedule_retry(void) {
+    http_upload_close();
+    retry_pending = true;
+    retry_tick = xTaskGetTickCount();
+    upload_stats.retries++;
+    APP_LOG_HTTP_INFO("Upload of '%s' interrupted at %lu/%lu bytes, retrying in %lu ms.", source.meeting_id,
+                      (unsigned long)upload_offset, (unsigned long)source.total_len, (unsigned long)retry_delay_ms);
+}
+
+static void finish_upload(void) {
+    uint32_t elapsed_ms = (uint32_t)((xTaskGetTickCount() - upload_start_tick) * portTICK_PERIOD_MS);
+    active = false;
+    upload_stats.uploads_completed++;
+    upload_stats.last_upload_ms = elapsed_ms;
+    upload_stats.last_throughput_bps = (elapsed_ms > 0) ? (uint32_t)((uint64_t)upload_bytes * 8u * 1000u / elapsed_ms) : 0;
+    APP_LOG_HTTP_INFO("Upload of '%s' complete: %lu bytes in %lu ms (%lu bps).", source.meeting_id,
+                      (unsigned long)source.total_len, (unsigned long)elapsed_ms, (unsigned long)upload_stats.last_throughput_bps);
+}
+
+bool http_upload_start(const http_upload_source_t *new_source) {
+    if (http_upload_is_busy() || new_source->read == NULL || new_source->total_len == 0) {
+        return false;
+    }
+    taskENTER_CRITICAL();
+    pending_source = *new_source;
+    pending_source.meeting_id[HTTP_UPLOAD_MAX_ID_LEN - 1] = '\0';
+    cancel_requested = false;
+    start_requested = true;
+    taskEXIT_CRITICAL();
+    return true;
+}
+
+void http_upload_cancel(void) {
+    cancel_requested = true;
+}
+
+bool http_upload_is_busy(void) {
+    return active || start_requested;
+}
+
+cy_rslt_t http_upload_step(void) {
+    if (cancel_requested) {
+        cancel_requested = false;
+        start_requested = false;
+        if (active) {
+            active = false;
+            APP_LOG_HTTP_INFO("Upload of '%s' cancelled at %lu bytes.", source.meeting_id, (unsigned long)upload_offset);
+        }
+        return CY_RSLT_SUCCESS;
+    }
+
+    if (!active) {
+        if (!start_requested) {
+            return CY_RSLT_SUCCESS;
+        }
+        taskENTER_CRITICAL();
+        source = pending_source;
+        start_requested = false;
+        taskEXIT_CRITICAL();
+        snprintf(path_buffer, sizeof(path_buffer), "%s/%s", HTTP_UPLOAD_PATH, source.meeting_id);
+        active = true;
+        offset_known = false;   // 同一 meeting_id 之前可能上传过一部分
+        upload_offset = 0;
+        upload_bytes = 0;
+        upload_start_tick = xTaskGetTickCount();
+        retry_pending = false;
+        retry_delay_ms = HTTP_UPLOAD_RETRY_MS;
+        upload_stats.current_total = source.total_len;
+        APP_LOG_HTTP_INFO("Uploading '%s' (%lu bytes) to %s:%u.", source.meeting_id, (unsigned long)source.total_len,
+                          HTTP_UPLOAD_HOST, (unsigned int)HTTP_UPLOAD_PORT);
+    }
+
+    if (retry_pending) {
+        if ((xTaskGetTickCount() - retry_tick) < pdMS_TO_TICKS(retry_delay_ms)) {
+            return CY_RSLT_SUCCESS;
+        }
+        retry_pending = false;
+        retry_delay_ms = (retry_delay_ms * 2u > HTTP_UPLOAD_RETRY_MAX_MS) ? HTTP_UPLOAD_RETRY_MAX_MS : retry_delay_ms * 2u;
+    }
+
+    cy_rslt_t result;
+    if (network_context.socket == NULL) {
+        result = open_connection();
+        if (result != CY_RSLT_SUCCESS) {
+            schedule_retry();
+            return result;
+        }
+    }
+
+    uint32_t committed = 0;
+    if (!offset_known) {
+        result = send_put(NULL, 0, 0, &committed);
+        if (result != CY_RSLT_SUCCESS) {
+            schedule_retry();
+            return result;
+        }
+        if (committed > upload_offset) {
+            upload_stats.resumed_bytes += committed - upload_offset;
+        }
+        upload_offset = committed;
+        offset_known = true;
+    } else {
+        uint32_t len = source.total_len - upload_offset;
+        if (len > HTTP_UPLOAD_SEGMENT_SIZE) {
+            len = HTTP_UPLOAD_SEGMENT_SIZE;
+        }
+        if (!source.read(source.context, upload_offset, segment_buffer, len)) {
+            // 本地读取失败重试也无济于事，放弃本次上传 (服务端保留已收到的部分)
+            APP_LOG_HTTP_ERROR("Failed to read '%s' at %lu, upload abandoned.", source.meeting_id, (unsigned long)upload_offset);
+            active = false;
+            return HTTP_UPLOAD_RSLT_ERROR;
+        }
+        result = send_put(segment_buffer, upload_offset, len, &committed);
+        if (result != CY_RSLT_SUCCESS) {
+            schedule_retry();
+            return result;
+        }
+        upload_bytes += len;
+        upload_stats.bytes_sent += len;
+        upload_stats.segments_sent++;
+        retry_delay_ms = HTTP_UPLOAD_RETRY_MS;
+        // 服务端按实际收到的字节回报进度，可能少于本段
+        upload_offset = committed;
+    }
+
+    upload_stats.current_offset = upload_offset;
+    if (upload_offset >= source.total_len) {
+        finish_upload();
+    }
+    return CY_RSLT_SUCCESS;
+}
+
+void http_upload_get_stats(http_upload_stats_t *stats) {
+    *stats = upload_stats;
+}
+
+#endif /* HTTP_UPLOAD_ENABLE */
@@ -0,0 +1,67 @@
+#ifndef HTTP_UPLOAD_H_
+#define HTTP_UPLOAD_H_
+
+#include "cy_result.h"
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+// 已录制会议的 HTTP 批量上传 (coreHTTP，配置见 core_http_config.h)。
+// 经 MQTT 每秒 25 个小包推送一小时的会议很慢；这里把整段会议按 HTTP_UPLOAD_SEGMENT_SIZE 分段，
+// 在一条 keep-alive 的 HTTP/1.1 连接上依次 PUT 到 HTTP_UPLOAD_PATH/<meeting_id>，每段带 Content-Range。
+// 协议与常见的可续传上传相同：
+//   PUT ... Content-Range: bytes <首>-<尾>/<总长>    中间段返回 308 (Range: bytes=0-<已收到的最后一字节>)，最后一段返回 200/201
+//   PUT ... Content-Range: bytes */<总长> (空负载)     断线重连后查询服务端已收到的字节，从该处续传
+// 失败后关闭连接，按指数退避 (HTTP_UPLOAD_RETRY_MS 起，上限 HTTP_UPLOAD_RETRY_MAX_MS) 重连并查询偏移后续传。
+//
+// http_upload_step() 每次最多发送一段并可能阻塞到 HTTP_UPLOAD_TIMEOUT_MS，因此网络任务只在没有录音 (会议未进行)
+// 且实时通道和积压通道都空闲时调用，录音期间上传暂停，不推迟实时音频。只在 HTTP_UPLOAD_ENABLE 为 1 时编入。
+// 除 http_upload_start()、http_upload_cancel()、http_upload_is_busy() 和 http_upload_get_stats() 外只在网络任务中调用。
+
+#define HTTP_UPLOAD_SEGMENT_SIZE       (8192)   // 每个 PUT 的负载字节数 (静态缓冲)，决定一次 step 的最长阻塞时间
+#define HTTP_UPLOAD_HEADER_BUFFER_SIZE (256)
+#define HTTP_UPLOAD_RESPONSE_BUFFER_SIZE (512)
+#define HTTP_UPLOAD_TIMEOUT_MS         (5000)   // 连接、发送和接收超时
+#define HTTP_UPLOAD_RETRY_MS           (1000)
+#define HTTP_UPLOAD_RETRY_MAX_MS       (30000)
+#define HTTP_UPLOAD_MAX_ID_LEN         (48)
+
+// 待上传会议的数据来源 (例如外部串行闪存中的录音)。read 在网络任务中调用。
+typedef struct {
+    char meeting_id[HTTP_UPLOAD_MAX_ID_LEN];    // 拼接在 HTTP_UPLOAD_PATH 之后
+    uint32_t total_len;
+    // 从 offset 读取 len 字节到 buffer，成功返回 true
+    bool (*read)(void *context, uint32_t offset, uint8_t *buffer, size_t len);
+    void *context;
+} http_upload_source_t;
+
+typedef struct {
+    uint32_t uploads_completed;
+    uint32_t bytes_sent;            // 发出的负载字节数 (含续传时重发的部分)
+    uint32_t segments_sent;
+    uint32_t connections;           // 建立的 TCP 连接数，keep-alive 正常时每次上传只需一次
+    uint32_t retries;               // 失败后重连的次数
+    uint32_t resumed_bytes;         // 重连后服务端确认已收到、无需重发的字节数
+    uint32_t current_offset;        // 当前上传的下一字节
+    uint32_t current_total;
+    uint32_t last_upload_ms;        // 最近一次完成的上传耗时
+    uint32_t last_throughput_bps;   // 最近一次完成的上传的平均负载速率
+} http_upload_stats_t;
+
+// 请求上传一段会议 (source 被复制)。已有上传进行中时返回 false。
+bool http_upload_start(const http_upload_source_t *source);
+
+// 放弃当前上传，服务端保留已收到的部分，之后以同一 meeting_id 重新开始时会从断点续传
+void http_upload_cancel(void);
+
+bool http_upload_is_busy(void);
+
+// 推进当前上传：需要时建立连接，发送至多一段。没有上传或处于退避等待时立即返回。
+cy_rslt_t http_upload_step(void);
+
+// 关闭连接 (例如 Wi-Fi 断开)，上传在下一次 step 时重连续传
+void http_upload_close(void);
+
+void http_upload_get_stats(http_upload_stats_t *stats);
+
+#endif /* HTTP_UPLOAD_H_ */
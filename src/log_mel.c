@@ -0,0 +1,94 @@
+#include "log_mel.h"
+#include <string.h>
+
+#define LM_PI           (3.14159265358979f)
+// log2(P) (Q10) -> 半 dB：10 * log10(2) * 2 / 1024 ≈ 6165 / 2^20
+#define LM_LOG2_Q10_TO_HALF_DB_MUL   (6165)
+#define LM_LOG2_Q10_TO_HALF_DB_SHIFT (20)
+
+// FFT 工作区。特征只在音频任务中计算，放在静态区以减小任务栈占用。
+static int16_t lm_re[DSP_FFT_MAX_N];
+static int16_t lm_im[DSP_FFT_MAX_N];
+static uint32_t lm_power[DSP_FFT_MAX_N / 2 + 1];
+static uint64_t lm_bands[LOG_MEL_BANDS];
+
+bool log_mel_init(log_mel_t *lm, uint32_t sample_rate_hz) {
+    uint32_t window_len = sample_rate_hz * LOG_MEL_WINDOW_MS / 1000u;
+    uint32_t hop_len = sample_rate_hz * LOG_MEL_HOP_MS / 1000u;
+    if (lm == NULL || hop_len == 0 || window_len > LOG_MEL_MAX_WINDOW ||
+        (sample_rate_hz * LOG_MEL_HOP_MS) % 1000u != 0) {
+        return false;
+    }
+    dsp_init();
+
+    memset(lm, 0, sizeof(*lm));
+    uint32_t log2n = 0;
+    while ((1u << log2n) < window_len) {
+        log2n++;
+    }
+    if (!dsp_mel_init(&lm->mel, log2n, sample_rate_hz, LOG_MEL_BANDS, 0.0f, (float)sample_rate_hz * 0.5f)) {
+        return false;
+    }
+    lm->sample_rate = sample_rate_hz;
+    lm->window_len = (uint16_t)window_len;
+    lm->hop_len = (uint16_t)hop_len;
+    lm->log2n = (uint16_t)log2n;
+    for (uint32_t n = 0; n < window_len; n++) {
+        float w = 0.5f - 0.5f * dsp_cosf(2.0f * LM_PI * (float)n / (float)window_len);
+        lm->window[n] = (int16_t)(w * 32767.0f + 0.5f);
+    }
+    return true;
+}
+
+void log_mel_reset(log_mel_t *lm) {
+    lm->fill = 0;
+    memset(lm->buffer, 0, sizeof(lm->buffer));
+}
+
+size_t log_mel_output_count(const log_mel_t *lm, size_t in_count) {
+    return (lm->fill + in_count) / lm->hop_len;
+}
+
+// 对 buffer[] 中的一个完整窗计算并量化一帧特征
+static void lm_compute_frame(const log_mel_t *lm, uint8_t *out) {
+    const uint32_t n_fft = 1u << lm->log2n;
+    for (uint32_t n = 0; n < lm->window_len; n++) {
+        lm_re[n] = (int16_t)(((int32_t)lm->buffer[n] * lm->window[n] + (1 << 14)) >> 15);
+    }
+    memset(&lm_re[lm->window_len], 0, (n_fft - lm->window_len) * sizeof(int16_t));
+    memset(lm_im, 0, n_fft * sizeof(int16_t));
+
+    // FFT 输出为真实 DFT 的 2^(shift - scaled)，在对数域补偿：log2(P) = log2(P_fft) + 2 * (scaled - shift)
+    int32_t shift = dsp_normalize_q15(lm_re, n_fft);
+    int32_t scaled = (int32_t)dsp_fft_q15(lm_re, lm_im, lm->log2n);
+    dsp_power_spectrum(lm_re, lm_im, lm_power, n_fft / 2u + 1u);
+    dsp_mel_apply(&lm->mel, lm_power, lm_bands);
+
+    const int32_t compensation = 2 * (scaled - shift) * (1 << DSP_LOG2_FRAC_BITS);
+    for (uint32_t b = 0; b < LOG_MEL_BANDS; b++) {
+        if (lm_bands[b] == 0) {
+            out[b] = 0;
+            continue;
+        }
+        int32_t log2_q10 = dsp_log2_q10(lm_bands[b]) + compensation;
+        int32_t half_db = (int32_t)(((int64_t)log2_q10 * LM_LOG2_Q10_TO_HALF_DB_MUL + (1 << (LM_LOG2_Q10_TO_HALF_DB_SHIFT - 1)))
+                                    >> LM_LOG2_Q10_TO_HALF_DB_SHIFT);
+        int32_t q = half_db - 2 * LOG_MEL_DB_MIN;
+        out[b] = (uint8_t)((q < 0) ? 0 : (q > 255) ? 255 : q);
+    }
+}
+
+size_t log_mel_process(log_mel_t *lm, const int16_t *in, size_t in_count, size_t in_stride, uint8_t *out) {
+    const uint32_t keep = lm->window_len - lm->hop_len;
+    size_t produced = 0;
+    for (size_t i = 0; i < in_count; i++) {
+        lm->buffer[keep + lm->fill] = in[i * in_stride];
+        if (++lm->fill == lm->hop_len) {
+            lm_compute_frame(lm, &out[produced * LOG_MEL_BANDS]);
+            produced++;
+            memmove(lm->buffer, &lm->buffer[lm->hop_len], keep * sizeof(int16_t));
+            lm->fill = 0;
+        }
+    }
+    return produced;
+}
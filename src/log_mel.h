@@ -0,0 +1,44 @@
+#ifndef LOG_MEL_H_
+#define LOG_MEL_H_
+
+#include "dsp.h"
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+// 流式 log-mel 滤波器组特征 (定点)：25 ms Hann 窗、10 ms 帧移、80 个 mel 频带 (0 ~ 采样率/2)，
+// 每个频带量化为 8 位：dB = LOG_MEL_DB_MIN + q * LOG_MEL_DB_STEP，其中 dB = 10 * log10(频带功率)，
+// 频带功率按 int16 样本、加窗后的 DFT 幅度平方计算 (满幅正弦约 130 dB)。
+// 窗口开头补零，因此每输入一个帧移的样本就输出一帧特征，输出帧数 = 输入样本数 / 帧移。
+
+#define LOG_MEL_BANDS           (80)
+#define LOG_MEL_WINDOW_MS       (25)
+#define LOG_MEL_HOP_MS          (10)
+#define LOG_MEL_DB_MIN          (10)        // q = 0 对应的 dB
+#define LOG_MEL_DB_STEP         (0.5f)      // 每个量化级的 dB，q = 255 对应 137.5 dB
+#define LOG_MEL_MAX_WINDOW      (DSP_FFT_MAX_N) // 窗长不超过最大 FFT 点数，即采样率不超过 20480 Hz
+
+typedef struct {
+    uint32_t sample_rate;
+    uint16_t window_len;                    // 窗长 (样本)
+    uint16_t hop_len;                       // 帧移 (样本)
+    uint16_t log2n;                         // FFT 点数 = 2^log2n >= window_len
+    uint16_t fill;                          // 自上一帧以来新写入的样本数 (< hop_len)
+    int16_t  window[LOG_MEL_MAX_WINDOW];    // 周期 Hann 窗，Q15
+    int16_t  buffer[LOG_MEL_MAX_WINDOW];    // 最近 window_len 个样本 (旧 -> 新)
+    dsp_mel_filterbank_t mel;
+} log_mel_t;
+
+// 按采样率计算窗长、帧移并生成窗函数和 mel 滤波器。采样率不受支持时返回 false。
+bool log_mel_init(log_mel_t *lm, uint32_t sample_rate_hz);
+
+// 清空样本缓冲 (例如重新开始录音或切换输出格式时调用)
+void log_mel_reset(log_mel_t *lm);
+
+// 处理 in_count 个输入样本时将输出的特征帧数 (不修改状态)
+size_t log_mel_output_count(const log_mel_t *lm, size_t in_count);
+
+// 处理一块单通道样本 (步长以样本为单位)，每个特征帧向 out 写入 LOG_MEL_BANDS 字节。返回写入的帧数。
+size_t log_mel_process(log_mel_t *lm, const int16_t *in, size_t in_count, size_t in_stride, uint8_t *out);
+
+#endif /* LOG_MEL_H_ */
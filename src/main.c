@@ -10,6 +10,8 @@
 #include "audio_task.h"
 #include "network_task.h"
 #include "ui_task.h"
+#include "boot_profile.h"
+#include "heap_guard.h"
 
 #include <stdio.h>
 
@@ -21,12 +23,97 @@
 // 空闲任务的堆栈，如果需要明确提供或增加
 // configMINIMAL_STACK_SIZE 通常在 FreeRTOSConfig.h 中定义
 
+// 应用任务的 TCB 和堆栈静态分配，占用在链接时确定 (见 tools/memmap.py 生成的内存报告)。
+// 堆栈大小以 StackType_t (4 字节) 为单位，与 xTaskCreate 相同
+static StaticTask_t network_task_tcb;
+static StackType_t network_task_stack[NETWORK_TASK_STACK_SIZE];
+static StaticTask_t audio_task_tcb;
+static StackType_t audio_task_stack[AUDIO_TASK_STACK_SIZE];
+static StaticTask_t ui_task_tcb;
+static StackType_t ui_task_stack[UI_TASK_STACK_SIZE];
+
+static boot_profile_t boot_profile;
+static uint32_t scheduler_start_us;
+
+// 复位后第一件事：启动 DWT 周期计数器作为启动时钟 (音频任务之后会清零重用它，那时已改用 tick 计数)
+static void start_boot_clock(void) {
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CYCCNT = 0;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+}
+
+uint32_t boot_now_us(void) {
+    if (xTaskGetSchedulerState() == taskSCHEDULER_NOT_STARTED) {
+        return DWT->CYCCNT / (SystemCoreClock / 1000000u);
+    }
+    return scheduler_start_us + (uint32_t)xTaskGetTickCount() * (1000000u / configTICK_RATE_HZ);
+}
+
+// 调度器启动前只有 main 在运行，不进入临界区，否则中断会一直屏蔽到调度器启动
+void boot_step_begin(boot_step_t step) {
+    uint32_t now = boot_now_us();
+    if (xTaskGetSchedulerState() == taskSCHEDULER_NOT_STARTED) {
+        boot_profile_begin(&boot_profile, step, now);
+        return;
+    }
+    taskENTER_CRITICAL();
+    boot_profile_begin(&boot_profile, step, now);
+    taskEXIT_CRITICAL();
+}
+
+void boot_step_end(boot_step_t step) {
+    uint32_t now = boot_now_us();
+    if (xTaskGetSchedulerState() == taskSCHEDULER_NOT_STARTED) {
+        boot_profile_end(&boot_profile, step, now);
+        return;
+    }
+    taskENTER_CRITICAL();
+    boot_profile_end(&boot_profile, step, now);
+    taskEXIT_CRITICAL();
+}
+
+void boot_get_profile(boot_profile_t *out) {
+    taskENTER_CRITICAL();
+    *out = boot_profile;
+    taskEXIT_CRITICAL();
+}
+
+void boot_reached_idle(void) {
+    uint32_t now = boot_now_us();
+    taskENTER_CRITICAL();
+    bool first = boot_profile_reached_idle(&boot_profile, now);
+    boot_profile_t snapshot = boot_profile;
+    taskEXIT_CRITICAL();
+    if (!first) {
+        return;
+    }
+    APP_LOG_MAIN_INFO("Boot to IDLE in %lu ms, steps sum to %lu ms:", (unsigned long)(snapshot.idle_us / 1000u),
+                      (unsigned long)(boot_profile_serial_us(&snapshot) / 1000u));
+    for (uint32_t step = 0; step < BOOT_STEP_COUNT; step++) {
+        uint32_t start_us;
+        uint32_t duration_us;
+        if (boot_profile_step(&snapshot, (boot_step_t)step, &start_us, &duration_us)) {
+            APP_LOG_MAIN_INFO("  %-14s at %6lu.%lu ms, took %6lu.%lu ms", boot_profile_step_name((boot_step_t)step),
+                              (unsigned long)(start_us / 1000u), (unsigned long)(start_us % 1000u / 100u),
+                              (unsigned long)(duration_us / 1000u), (unsigned long)(duration_us % 1000u / 100u));
+        }
+    }
+    heap_guard_stats_t heap;
+    heap_guard_get_stats(&heap);
+    APP_LOG_MAIN_INFO("Heap: %lu allocations (%lu bytes) before scheduler, %lu (%lu bytes) since, %lu in allocation-free tasks",
+                      (unsigned long)heap.boot_allocations, (unsigned long)heap.boot_bytes,
+                      (unsigned long)heap.runtime_allocations, (unsigned long)heap.runtime_bytes,
+                      (unsigned long)heap.violations);
+}
+
 // 初始化系统组件、Retarget IO 等的函数
 static void system_init(void) {
     cy_rslt_t result;
 
     // 初始化设备和板级外设
+    boot_step_begin(BOOT_STEP_BSP);
     result = cybsp_init();
+    boot_step_end(BOOT_STEP_BSP);
     if (result != CY_RSLT_SUCCESS) {
         // APP_LOG_MAIN_ERROR("BSP initialization failed: 0x%08X", (unsigned int)result);
         CY_ASSERT(0); // 失败时暂停
@@ -35,7 +122,9 @@ static void system_init(void) {
     }
 
     // 初始化 Retarget IO 以支持 printf 功能
+    boot_step_begin(BOOT_STEP_RETARGET_IO);
     result = cy_retarget_io_init(CYBSP_DEBUG_UART_TX, CYBSP_DEBUG_UART_RX, CY_RETARGET_IO_BAUDRATE);
+    boot_step_end(BOOT_STEP_RETARGET_IO);
     if (result != CY_RSLT_SUCCESS) {
         // 即使 retarget_io 失败，如果基本硬件正常，我们可能仍希望继续。
         // 对于调试来说，这很关键。考虑如何在生产环境中处理此问题。
@@ -43,6 +132,13 @@ static void system_init(void) {
         // 如果 retarget_io 失败，在此处打印错误将不起作用。
     }
 
+    // 上一次运行因堆分配违规复位 (或违规后经其他原因复位) 时，记录保存在 .noinit 中
+    heap_guard_violation_t violation;
+    if (heap_guard_take_reset_record(&violation)) {
+        APP_LOG_MAIN_ERROR("Previous run: heap allocation of %lu bytes in allocation-free context %s.",
+                           (unsigned long)violation.size, violation.task_name);
+    }
+
     // 初始化用户LED
     result = cyhal_gpio_init(CYBSP_USER_LED, CYHAL_GPIO_DIR_OUTPUT, CYHAL_GPIO_DRIVE_STRONG, CYBSP_LED_STATE_OFF);
     if (result != CY_RSLT_SUCCESS) {
@@ -58,34 +154,54 @@ static void system_init(void) {
 }
 
 int main(void) {
+    start_boot_clock();
+
     // 初始化系统资源
     system_init();
 
     APP_LOG_MAIN_INFO("Meeting Assistant Starting...");
 
+    boot_step_begin(BOOT_STEP_TASKS);
     // 初始化应用程序状态机
     state_machine_init(); 
     // 初始状态将通过 ui_set_led_state() 设置 LED，因此 UI 任务需要准备就绪，或者 ui_set_led_state 具有鲁棒性。
 
+    // 音频帧队列在任何任务运行之前建好：网络任务先于音频任务运行，并且在音频初始化失败后仍会访问它
+    if (!audio_create_queues()) {
+        APP_LOG_MAIN_ERROR("Failed to create audio queue or frame pool.");
+    }
+
     // 创建应用程序任务
-    BaseType_t rtos_result;
+    TaskHandle_t task_handle;
 
-    rtos_result = xTaskCreate(audio_task, "AudioTask", AUDIO_TASK_STACK_SIZE, NULL, AUDIO_TASK_PRIORITY, NULL);
-    if (rtos_result != pdPASS) {
-        APP_LOG_MAIN_ERROR("Failed to create Audio task.");
+    // 网络任务以 NETWORK_TASK_BOOT_PRIORITY 最先运行：WCM 初始化 (WLAN 固件下载) 和 Wi-Fi 关联是启动的关键路径，
+    // 它阻塞等待 SDIO 和 WHD 的时候，音频时钟、PDM 和 CapSense 的初始化在这些空隙中完成，而不是排在它们之前
+    task_handle = xTaskCreateStatic(network_task, "NetworkTask", NETWORK_TASK_STACK_SIZE, NULL, NETWORK_TASK_BOOT_PRIORITY,
+                                    network_task_stack, &network_task_tcb);
+    if (task_handle == NULL) {
+        APP_LOG_MAIN_ERROR("Failed to create Network task.");
     }
 
-    rtos_result = xTaskCreate(network_task, "NetworkTask", NETWORK_TASK_STACK_SIZE, NULL, NETWORK_TASK_PRIORITY, NULL);
-    if (rtos_result != pdPASS) {
-        APP_LOG_MAIN_ERROR("Failed to create Network task.");
+    // 音频和 UI 任务运行后不应再分配堆内存，heap_guard 在它们里面发现分配时记录并复位
+    task_handle = xTaskCreateStatic(audio_task, "AudioTask", AUDIO_TASK_STACK_SIZE, NULL, AUDIO_TASK_PRIORITY,
+                                    audio_task_stack, &audio_task_tcb);
+    if (task_handle == NULL) {
+        APP_LOG_MAIN_ERROR("Failed to create Audio task.");
+    } else {
+        heap_guard_forbid_task(task_handle);
     }
 
-    rtos_result = xTaskCreate(ui_task, "UITask", UI_TASK_STACK_SIZE, NULL, UI_TASK_PRIORITY, NULL);
-    if (rtos_result != pdPASS) {
+    task_handle = xTaskCreateStatic(ui_task, "UITask", UI_TASK_STACK_SIZE, NULL, UI_TASK_PRIORITY,
+                                    ui_task_stack, &ui_task_tcb);
+    if (task_handle == NULL) {
         APP_LOG_MAIN_ERROR("Failed to create UI task.");
+    } else {
+        heap_guard_forbid_task(task_handle);
     }
 
+    boot_step_end(BOOT_STEP_TASKS);
     APP_LOG_MAIN_INFO("All tasks created. Starting scheduler.");
+    scheduler_start_us = boot_now_us();
 
     // 启动 FreeRTOS 调度器
     vTaskStartScheduler();
@@ -982,6 +982,59 @@
  */
 #undef MBEDTLS_PKCS7_C
 
+/**
+ * \def APP_MBEDTLS_TRIMMED_PROFILE
+ *
+ * Trim the TLS client to what the MQTT control connection actually needs, to
+ * shorten the handshake on reconnect and lower the peak heap of a session.
+ *
+ * - Only P-256 ECDHE with ECDSA or RSA certificates. Curve25519 is disabled so
+ *   that key exchange runs on the hardware ECP implementation (MBEDTLS_ECP_ALT
+ *   is turned off below whenever Curve25519 is enabled).
+ * - Static RSA, DHE-RSA and static ECDH key exchanges are removed; MBEDTLS_RSA_C
+ *   stays enabled for verifying RSA server certificates.
+ * - MBEDTLS_SSL_CIPHERSUITES offers one AES-128-GCM suite per protocol version,
+ *   so no CBC/SHA-384 code paths are linked in.
+ * - The outgoing record buffer is limited to APP_MBEDTLS_OUT_CONTENT_LEN. A mono
+ *   audio PUBLISH is at most about 2.6 KB and fits one record; an 80 ms stereo
+ *   frame (about 5.2 KB) is sent as two records. The incoming buffer
+ *   stays at the 16 KB the protocol allows by default, because the maximum
+ *   fragment length extension is only sent when the application calls
+ *   mbedtls_ssl_conf_max_frag_len(), which the cy_mqtt/secure-sockets TLS layer
+ *   does not expose. Lower APP_MBEDTLS_IN_CONTENT_LEN only when the broker is
+ *   known to send smaller records. tools/host/test_tls_profile.c checks the
+ *   suite list, record sizes and handshake round trips against OpenSSL.
+ *
+ * Session tickets remain enabled (required by TLS 1.3).
+ *
+ * Comment this macro to restore the default profile.
+ */
+#define APP_MBEDTLS_TRIMMED_PROFILE
+
+#ifdef APP_MBEDTLS_TRIMMED_PROFILE
+#undef MBEDTLS_ECP_DP_CURVE25519_ENABLED
+#undef MBEDTLS_KEY_EXCHANGE_RSA_ENABLED
+#undef MBEDTLS_KEY_EXCHANGE_DHE_RSA_ENABLED
+#undef MBEDTLS_KEY_EXCHANGE_ECDH_ECDSA_ENABLED
+#undef MBEDTLS_KEY_EXCHANGE_ECDH_RSA_ENABLED
+
+#define MBEDTLS_SSL_CIPHERSUITES                          \
+    MBEDTLS_TLS1_3_AES_128_GCM_SHA256,                    \
+    MBEDTLS_TLS_ECDHE_ECDSA_WITH_AES_128_GCM_SHA256,      \
+    MBEDTLS_TLS_ECDHE_RSA_WITH_AES_128_GCM_SHA256
+
+#ifndef APP_MBEDTLS_OUT_CONTENT_LEN
+#define APP_MBEDTLS_OUT_CONTENT_LEN 4096
+#endif
+#ifndef APP_MBEDTLS_IN_CONTENT_LEN
+#define APP_MBEDTLS_IN_CONTENT_LEN 16384
+#endif
+#undef MBEDTLS_SSL_OUT_CONTENT_LEN
+#define MBEDTLS_SSL_OUT_CONTENT_LEN APP_MBEDTLS_OUT_CONTENT_LEN
+#undef MBEDTLS_SSL_IN_CONTENT_LEN
+#define MBEDTLS_SSL_IN_CONTENT_LEN APP_MBEDTLS_IN_CONTENT_LEN
+#endif /* APP_MBEDTLS_TRIMMED_PROFILE */
+
 /* When TLS1.3 and TLS1.2 both are enabled, there is no version negotiation currently supported for server. Hence, when both
  * are enabled, the below macro can be changed to force the TLS version to be used on server side. Please note that this macro
  * is only used when device is acting as a server. for client, version negotiation is supported.
@@ -0,0 +1,528 @@
+#include "mqtt_stream.h"
+#include "app_config.h"
+#include "cy_secure_sockets.h"
+#include "FreeRTOS.h"
+#include "task.h"
+#include <stdio.h> // 用于 printf，替换为适当的日志记录
+#include <stddef.h>
+#include <string.h>
+
+#if (MQTT_AUDIO_QOS == 1) && (MQTT_SECURE_CONNECTION == 1)
+#error "The audio data connection does not support TLS yet; use MQTT_AUDIO_QOS 0 with MQTT_SECURE_CONNECTION 1"
+#endif
+
+#define APP_LOG_STREAM_INFO(format, ...) printf("[STREAM] " format "\n", ##__VA_ARGS__)
+#define APP_LOG_STREAM_ERROR(format, ...) printf("[STREAM ERROR] " format "\n", ##__VA_ARGS__)
+
+// MQTT 3.1.1 控制报文类型 (固定报头高 4 位)
+#define MQTT_PACKET_CONNECT     (0x10u)
+#define MQTT_PACKET_CONNACK     (0x20u)
+#define MQTT_PACKET_PUBLISH     (0x30u)
+#define MQTT_PACKET_PUBACK      (0x40u)
+#define MQTT_PACKET_PINGREQ     (0xC0u)
+#define MQTT_PACKET_PINGRESP    (0xD0u)
+#define MQTT_PACKET_DISCONNECT  (0xE0u)
+#define MQTT_PUBLISH_FLAG_DUP   (0x08u)
+#define MQTT_PUBLISH_QOS_SHIFT  (1)
+
+// 固定报头 (1 + 最多 4 字节剩余长度) + 主题长度 + 主题 + 报文标识符
+#define MQTT_PUBLISH_PREFIX_MAX (5 + 2 + MQTT_STREAM_MAX_TOPIC_LEN)
+#define MQTT_PUBLISH_HEADER_MAX (MQTT_PUBLISH_PREFIX_MAX + 2)
+
+#if MQTT_PUBLISH_HEADER_MAX > AUDIO_FRAME_HEADROOM
+#error "AUDIO_FRAME_HEADROOM is too small for the PUBLISH header"
+#endif
+_Static_assert(offsetof(audio_data_t, header) == AUDIO_FRAME_HEADROOM, "PUBLISH header must end exactly at the frame header");
+
+typedef struct {
+    audio_data_t *frame;        // 等待 PUBACK 的帧 (仍属于帧缓冲池)
+    uint8_t *packet;            // 已写好报头的完整报文 (位于帧的预留区内)，重传时原样重发
+    uint32_t packet_len;
+    uint16_t packet_id;
+    TickType_t sent_tick;       // 最近一次 (重) 发的时间
+} mqtt_stream_inflight_t;
+
+// 预先编码的报头前缀：固定报头 + 主题，不含报文标识符。音频帧长度通常不变，命中后发布只需一次 memcpy。
+typedef struct {
+    const char *topic;          // 主题字符串地址 (内容不变，按地址匹配，避免每次 strlen)
+    uint32_t payload_len;
+    uint8_t qos;
+    uint8_t length;
+    uint8_t bytes[MQTT_PUBLISH_PREFIX_MAX];
+} mqtt_publish_prefix_t;
+
+static cy_socket_t stream_socket = NULL;
+static bool stream_connected = false;
+
+// 在途窗口按发送顺序保存，代理通常按序确认，匹配时从头查找
+static mqtt_stream_inflight_t inflight[MQTT_STREAM_INFLIGHT_WINDOW];
+static uint32_t inflight_count = 0;
+#if (MQTT_AUDIO_QOS == 1)
+static uint16_t next_packet_id = 1;
+#endif
+
+static uint8_t rx_buffer[MQTT_STREAM_RX_BUFFER_SIZE];
+static uint32_t rx_length = 0;
+static TickType_t last_tx_tick = 0;
+static TickType_t ping_sent_tick = 0;
+static bool ping_outstanding = false;
+static uint32_t link_timeout_ms = MQTT_HEARTBEAT_TIMEOUT_MS;
+
+static mqtt_publish_prefix_t prefix_cache[MQTT_STREAM_PREFIX_CACHE_SIZE];
+static uint32_t prefix_cache_next = 0;
+
+static mqtt_stream_stats_t stream_stats;
+
+// MQTT 剩余长度的变长编码，返回写入的字节数 (1~4)
+static uint32_t encode_remaining_length(uint8_t *buf, uint32_t length) {
+    uint32_t n = 0;
+    do {
+        uint8_t byte = (uint8_t)(length % 128u);
+        length /= 128u;
+        if (length > 0) {
+            byte |= 0x80u;
+        }
+        buf[n++] = byte;
+    } while (length > 0 && n < 4);
+    return n;
+}
+
+static uint32_t put_string(uint8_t *buf, const char *str, uint32_t len) {
+    buf[0] = (uint8_t)(len >> 8);
+    buf[1] = (uint8_t)(len & 0xFFu);
+    memcpy(&buf[2], str, len);
+    return len + 2u;
+}
+
+static cy_rslt_t send_all(const void *data, uint32_t length) {
+    const uint8_t *p = (const uint8_t *)data;
+    while (length > 0) {
+        uint32_t sent = 0;
+        cy_rslt_t result = cy_socket_send(stream_socket, p, length, CY_SOCKET_FLAGS_NONE, &sent);
+        if (result != CY_RSLT_SUCCESS) {
+            return result;
+        }
+        p += sent;
+        length -= sent;
+    }
+    last_tx_tick = xTaskGetTickCount();
+    return CY_RSLT_SUCCESS;
+}
+
+// 查找或生成 (主题, 负载长度, QoS) 对应的报头前缀
+static const mqtt_publish_prefix_t *get_publish_prefix(const char *topic, uint32_t payload_len, uint8_t qos) {
+    for (uint32_t i = 0; i < MQTT_STREAM_PREFIX_CACHE_SIZE; i++) {
+        const mqtt_publish_prefix_t *p = &prefix_cache[i];
+        if (p->topic == topic && p->payload_len == payload_len && p->qos == qos) {
+            return p;
+        }
+    }
+
+    uint32_t topic_len = (uint32_t)strlen(topic);
+    if (topic_len > MQTT_STREAM_MAX_TOPIC_LEN) {
+        return NULL;
+    }
+    mqtt_publish_prefix_t *p = &prefix_cache[prefix_cache_next];
+    prefix_cache_next = (prefix_cache_next + 1u) % MQTT_STREAM_PREFIX_CACHE_SIZE;
+    uint32_t variable_len = 2u + topic_len + ((qos > 0) ? 2u : 0u);
+    uint32_t n = 0;
+    p->bytes[n++] = (uint8_t)(MQTT_PACKET_PUBLISH | (qos << MQTT_PUBLISH_QOS_SHIFT));
+    n += encode_remaining_length(&p->bytes[n], variable_len + payload_len);
+    n += put_string(&p->bytes[n], topic, topic_len);
+    p->topic = topic;
+    p->payload_len = payload_len;
+    p->qos = qos;
+    p->length = (uint8_t)n;
+    return p;
+}
+
+// 在 payload 之前的预留区写入 PUBLISH 报头，返回报文起始地址和总长度
+static uint8_t *build_publish(uint8_t *payload, uint32_t payload_len, const char *topic, uint16_t packet_id, uint8_t qos,
+                              uint32_t *packet_len) {
+    const mqtt_publish_prefix_t *prefix = get_publish_prefix(topic, payload_len, qos);
+    if (prefix == NULL) {
+        return NULL;
+    }
+    uint8_t *start = payload;
+    if (qos > 0) {
+        start -= 2;
+        start[0] = (uint8_t)(packet_id >> 8);
+        start[1] = (uint8_t)(packet_id & 0xFFu);
+    }
+    start -= prefix->length;
+    memcpy(start, prefix->bytes, prefix->length);
+    *packet_len = (uint32_t)(payload + payload_len - start);
+    return start;
+}
+
+static void close_socket(void) {
+    if (stream_socket != NULL) {
+        cy_socket_disconnect(stream_socket, 0);
+        cy_socket_delete(stream_socket);
+        stream_socket = NULL;
+    }
+    stream_connected = false;
+    rx_length = 0;
+    ping_outstanding = false;
+}
+
+// 从套接字读取，直到缓冲中至少有 needed 字节或超时
+static cy_rslt_t receive_at_least(uint32_t needed) {
+    while (rx_length < needed) {
+        uint32_t received = 0;
+        cy_rslt_t result = cy_socket_recv(stream_socket, &rx_buffer[rx_length], sizeof(rx_buffer) - rx_length,
+                                          CY_SOCKET_FLAGS_NONE, &received);
+        if (result != CY_RSLT_SUCCESS) {
+            return result;
+        }
+        rx_length += received;
+    }
+    return CY_RSLT_SUCCESS;
+}
+
+static cy_rslt_t send_connect(const char *client_id) {
+    uint8_t packet[128];
+    char stream_client_id[80];
+    snprintf(stream_client_id, sizeof(stream_client_id), "%s%s", client_id, MQTT_STREAM_CLIENT_ID_SUFFIX);
+    uint32_t id_len = (uint32_t)strlen(stream_client_id);
+    uint32_t user_len = sizeof(MQTT_USERNAME) - 1;
+    uint32_t pass_len = sizeof(MQTT_PASSWORD) - 1;
+
+    // 可变报头：协议名 "MQTT"、级别 4、连接标志、保活时间
+#if (MQTT_AUDIO_QOS == 1)
+    uint8_t flags = 0x00;                           // clean session = 0：代理保留 QoS1 会话；DUP 只是提示，重复副本仍会被转发
+#else
+    uint8_t flags = 0x02;                           // clean session = 1：QoS0 快速路径没有需要代理保留的会话状态
+#endif
+    uint32_t remaining = 10u + 2u + id_len;
+    if (user_len > 0) {
+        flags |= 0x80u;
+        remaining += 2u + user_len;
+    }
+    if (pass_len > 0) {
+        flags |= 0x40u;
+        remaining += 2u + pass_len;
+    }
+    if (remaining + 5u > sizeof(packet)) {
+        return CY_RSLT_MODULE_SECURE_SOCKETS_BADARG;
+    }
+
+    uint32_t n = 0;
+    packet[n++] = MQTT_PACKET_CONNECT;
+    n += encode_remaining_length(&packet[n], remaining);
+    n += put_string(&packet[n], "MQTT", 4);
+    packet[n++] = 4;                                // 协议级别 3.1.1
+    packet[n++] = flags;
+    packet[n++] = (uint8_t)(MQTT_STREAM_KEEP_ALIVE_SEC >> 8);
+    packet[n++] = (uint8_t)(MQTT_STREAM_KEEP_ALIVE_SEC & 0xFF);
+    n += put_string(&packet[n], stream_client_id, id_len);
+    if (user_len > 0) {
+        n += put_string(&packet[n], MQTT_USERNAME, user_len);
+    }
+    if (pass_len > 0) {
+        n += put_string(&packet[n], MQTT_PASSWORD, pass_len);
+    }
+    return send_all(packet, n);
+}
+
+cy_rslt_t mqtt_stream_connect(const char *broker_address, const char *client_id) {
+    if (stream_connected) {
+        return CY_RSLT_SUCCESS;
+    }
+
+    cy_socket_sockaddr_t address = { .port = MQTT_PORT };
+    cy_rslt_t result = cy_socket_gethostbyname(broker_address, CY_SOCKET_IP_VER_V4, &address.ip_address);
+    if (result != CY_RSLT_SUCCESS) {
+        APP_LOG_STREAM_ERROR("Failed to resolve broker address: 0x%08X", (unsigned int)result);
+        return result;
+    }
+
+    result = cy_socket_create(CY_SOCKET_DOMAIN_AF_INET, CY_SOCKET_TYPE_STREAM, CY_SOCKET_IPPROTO_TCP, &stream_socket);
+    if (result != CY_RSLT_SUCCESS) {
+        APP_LOG_STREAM_ERROR("Failed to create socket: 0x%08X", (unsigned int)result);
+        stream_socket = NULL;
+        return result;
+    }
+
+    uint32_t timeout_ms = MQTT_STREAM_CONNECT_TIMEOUT_MS;
+    cy_socket_setsockopt(stream_socket, CY_SOCKET_SOL_SOCKET, CY_SOCKET_SO_RCVTIMEO, &timeout_ms, sizeof(timeout_ms));
+    cy_socket_setsockopt(stream_socket, CY_SOCKET_SOL_SOCKET, CY_SOCKET_SO_SNDTIMEO, &timeout_ms, sizeof(timeout_ms));
+
+    result = cy_socket_connect(stream_socket, &address, sizeof(address));
+    if (result == CY_RSLT_SUCCESS) {
+        result = send_connect(client_id);
+    }
+    rx_length = 0;
+    if (result == CY_RSLT_SUCCESS) {
+        result = receive_at_least(4);
+    }
+    if (result == CY_RSLT_SUCCESS && (rx_buffer[0] != MQTT_PACKET_CONNACK || rx_buffer[1] != 2 || rx_buffer[3] != 0)) {
+        APP_LOG_STREAM_ERROR("Broker refused data connection (return code %u).", (unsigned int)rx_buffer[3]);
+        result = MQTT_STREAM_RSLT_PROTOCOL_ERROR;
+    }
+    if (result != CY_RSLT_SUCCESS) {
+        APP_LOG_STREAM_ERROR("Data connection failed: 0x%08X", (unsigned int)result);
+        close_socket();
+        return result;
+    }
+    rx_length -= 4;
+    memmove(rx_buffer, &rx_buffer[4], rx_length);
+
+    // 之后的接收都是短超时的轮询
+    timeout_ms = MQTT_STREAM_POLL_TIMEOUT_MS;
+    cy_socket_setsockopt(stream_socket, CY_SOCKET_SOL_SOCKET, CY_SOCKET_SO_RCVTIMEO, &timeout_ms, sizeof(timeout_ms));
+    stream_connected = true;
+    ping_sent_tick = xTaskGetTickCount();
+    stream_stats.reconnects++;
+    APP_LOG_STREAM_INFO("Data connection established, %lu frame(s) to resend.", (unsigned long)inflight_count);
+
+    // 重传连接断开时仍未确认的帧
+    for (uint32_t i = 0; i < inflight_count && stream_connected; i++) {
+        inflight[i].packet[0] |= MQTT_PUBLISH_FLAG_DUP;
+        if (send_all(inflight[i].packet, inflight[i].packet_len) != CY_RSLT_SUCCESS) {
+            close_socket();
+            return CY_RSLT_MODULE_SECURE_SOCKETS_NOT_CONNECTED;
+        }
+        inflight[i].sent_tick = last_tx_tick;
+        stream_stats.retransmits++;
+    }
+    return CY_RSLT_SUCCESS;
+}
+
+void mqtt_stream_disconnect(void) {
+    if (stream_connected) {
+        uint8_t packet[2] = { MQTT_PACKET_DISCONNECT, 0 };
+        (void)send_all(packet, sizeof(packet));
+    }
+    close_socket();
+}
+
+bool mqtt_stream_is_connected(void) {
+    return stream_connected;
+}
+
+bool mqtt_stream_can_publish(void) {
+    return stream_connected && inflight_count < MQTT_STREAM_INFLIGHT_WINDOW;
+}
+
+cy_rslt_t mqtt_stream_publish(audio_data_t *frame, const char *topic) {
+    if (!mqtt_stream_can_publish()) {
+        audio_release_frame(frame);
+        return CY_RSLT_MODULE_SECURE_SOCKETS_NOT_CONNECTED;
+    }
+
+    uint8_t *payload = (uint8_t *)&frame->header;
+    uint32_t payload_len = (uint32_t)audio_frame_payload_len(frame);
+    uint32_t packet_len = 0;
+#if (MQTT_AUDIO_QOS == 1)
+    uint16_t packet_id = next_packet_id++;
+    if (next_packet_id == 0) {
+        next_packet_id = 1;                         // 报文标识符不能为 0
+    }
+    uint8_t *packet = build_publish(payload, payload_len, topic, packet_id, 1, &packet_len);
+    if (packet == NULL) {
+        audio_release_frame(frame);
+        return CY_RSLT_MODULE_SECURE_SOCKETS_BADARG;
+    }
+    // 先登记再发送：发送失败时帧仍在窗口中，重新连接后重传
+    mqtt_stream_inflight_t *entry = &inflight[inflight_count++];
+    entry->frame = frame;
+    entry->packet = packet;
+    entry->packet_len = packet_len;
+    entry->packet_id = packet_id;
+    entry->sent_tick = xTaskGetTickCount();
+    if (inflight_count > stream_stats.inflight_max) {
+        stream_stats.inflight_max = inflight_count;
+    }
+    cy_rslt_t result = send_all(packet, packet_len);
+#else
+    uint8_t *packet = build_publish(payload, payload_len, topic, 0, 0, &packet_len);
+    cy_rslt_t result = (packet != NULL) ? send_all(packet, packet_len) : CY_RSLT_MODULE_SECURE_SOCKETS_BADARG;
+    audio_release_frame(frame);
+#endif
+    if (result != CY_RSLT_SUCCESS) {
+        APP_LOG_STREAM_ERROR("Publish failed: 0x%08X", (unsigned int)result);
+        close_socket();
+        return result;
+    }
+    stream_stats.published++;
+    return CY_RSLT_SUCCESS;
+}
+
+cy_rslt_t mqtt_stream_publish_payload(const char *topic, uint8_t *payload, size_t payload_len) {
+    if (!stream_connected) {
+        return CY_RSLT_MODULE_SECURE_SOCKETS_NOT_CONNECTED;
+    }
+    uint32_t packet_len = 0;
+    uint8_t *packet = build_publish(payload, (uint32_t)payload_len, topic, 0, 0, &packet_len);
+    if (packet == NULL) {
+        return CY_RSLT_MODULE_SECURE_SOCKETS_BADARG;
+    }
+    cy_rslt_t result = send_all(packet, packet_len);
+    if (result != CY_RSLT_SUCCESS) {
+        APP_LOG_STREAM_ERROR("Publish failed: 0x%08X", (unsigned int)result);
+        close_socket();
+        return result;
+    }
+    stream_stats.published++;
+    return CY_RSLT_SUCCESS;
+}
+
+// 帧的预留区中是否有等待 PUBACK 的报头
+static bool frame_in_flight(const audio_data_t *frame) {
+    for (uint32_t i = 0; i < inflight_count; i++) {
+        if (inflight[i].frame == frame) {
+            return true;
+        }
+    }
+    return false;
+}
+
+cy_rslt_t mqtt_stream_publish_shared(const audio_data_t *frame, const char *topic) {
+    if (!stream_connected) {
+        return CY_RSLT_MODULE_SECURE_SOCKETS_NOT_CONNECTED;
+    }
+    uint8_t *payload = (uint8_t *)&frame->header;
+    uint32_t payload_len = (uint32_t)audio_frame_payload_len(frame);
+    cy_rslt_t result;
+    if (!frame_in_flight(frame)) {
+        // 帧已发布完毕，预留区空闲：与 QoS0 音频一样写入报头，一次发送
+        uint32_t packet_len = 0;
+        uint8_t *packet = build_publish(payload, payload_len, topic, 0, 0, &packet_len);
+        result = (packet != NULL) ? send_all(packet, packet_len) : CY_RSLT_MODULE_SECURE_SOCKETS_BADARG;
+    } else {
+        // 预留区中的 QoS1 报头还要用于重传，不能覆盖：报头从前缀缓存单独发送，负载仍直接从帧发出
+        const mqtt_publish_prefix_t *prefix = get_publish_prefix(topic, payload_len, 0);
+        result = (prefix != NULL) ? send_all(prefix->bytes, prefix->length) : CY_RSLT_MODULE_SECURE_SOCKETS_BADARG;
+        if (result == CY_RSLT_SUCCESS) {
+            result = send_all(payload, payload_len);
+        }
+    }
+    if (result == CY_RSLT_MODULE_SECURE_SOCKETS_BADARG) {
+        return result;
+    }
+    if (result != CY_RSLT_SUCCESS) {
+        APP_LOG_STREAM_ERROR("Publish failed: 0x%08X", (unsigned int)result);
+        close_socket();
+        return result;
+    }
+    stream_stats.published++;
+    return CY_RSLT_SUCCESS;
+}
+
+static void handle_puback(uint16_t packet_id) {
+    for (uint32_t i = 0; i < inflight_count; i++) {
+        if (inflight[i].packet_id == packet_id) {
+            audio_release_frame(inflight[i].frame);
+            memmove(&inflight[i], &inflight[i + 1], (inflight_count - i - 1) * sizeof(inflight[0]));
+            inflight_count--;
+            stream_stats.acked++;
+            return;
+        }
+    }
+    // 重传后可能收到同一标识符的第二个 PUBACK，忽略即可
+}
+
+// 解析缓冲中所有完整的报文
+static cy_rslt_t process_rx_buffer(void) {
+    while (rx_length >= 2) {
+        uint32_t remaining = 0;
+        uint32_t multiplier = 1;
+        uint32_t pos = 1;
+        uint8_t byte;
+        do {
+            if (pos >= rx_length) {
+                return CY_RSLT_SUCCESS;             // 剩余长度还没收全
+            }
+            byte = rx_buffer[pos++];
+            remaining += (byte & 0x7Fu) * multiplier;
+            multiplier *= 128u;
+        } while ((byte & 0x80u) && pos < 5);
+
+        if (pos + remaining > sizeof(rx_buffer)) {
+            // 数据连接不订阅任何主题，不应收到长报文
+            return MQTT_STREAM_RSLT_PROTOCOL_ERROR;
+        }
+        if (pos + remaining > rx_length) {
+            return CY_RSLT_SUCCESS;
+        }
+
+        uint8_t type = rx_buffer[0] & 0xF0u;
+        if (type == MQTT_PACKET_PUBACK && remaining == 2) {
+            handle_puback((uint16_t)((rx_buffer[pos] << 8) | rx_buffer[pos + 1]));
+        }
+        // 收到任何报文都说明连接仍然有效，未回应的 PINGREQ 不再计时 (它的 PINGRESP 稍后到达也无妨)
+        ping_outstanding = false;
+
+        rx_length -= pos + remaining;
+        memmove(rx_buffer, &rx_buffer[pos + remaining], rx_length);
+    }
+    return CY_RSLT_SUCCESS;
+}
+
+cy_rslt_t mqtt_stream_poll(void) {
+    if (!stream_connected) {
+        return CY_RSLT_MODULE_SECURE_SOCKETS_NOT_CONNECTED;
+    }
+
+    uint32_t received = 0;
+    cy_rslt_t result = cy_socket_recv(stream_socket, &rx_buffer[rx_length], sizeof(rx_buffer) - rx_length,
+                                      CY_SOCKET_FLAGS_NONE, &received);
+    if (result == CY_RSLT_SUCCESS) {
+        rx_length += received;
+        result = process_rx_buffer();
+    } else if (result == CY_RSLT_MODULE_SECURE_SOCKETS_TIMEOUT) {
+        result = CY_RSLT_SUCCESS;
+    }
+
+    TickType_t now = xTaskGetTickCount();
+#if (MQTT_HEARTBEAT_INTERVAL_MS > 0)
+    // 与控制连接的心跳同样的间隔和判定时间：数据连接无声断开时不必等 keep-alive
+    const TickType_t ping_interval = pdMS_TO_TICKS(MQTT_HEARTBEAT_INTERVAL_MS);
+    const TickType_t ping_idle = 0;
+    const TickType_t ping_deadline = pdMS_TO_TICKS(link_timeout_ms);
+#else
+    const TickType_t ping_interval = 0;
+    const TickType_t ping_idle = pdMS_TO_TICKS(MQTT_STREAM_KEEP_ALIVE_SEC * 500u);
+    const TickType_t ping_deadline = pdMS_TO_TICKS(MQTT_STREAM_KEEP_ALIVE_SEC * 1000u);
+#endif
+    if (result == CY_RSLT_SUCCESS && ping_outstanding && (now - ping_sent_tick) >= ping_deadline) {
+        APP_LOG_STREAM_ERROR("No response to PINGREQ for %lu ms.", (unsigned long)((now - ping_sent_tick) * portTICK_PERIOD_MS));
+        stream_stats.link_dead_events++;
+        result = MQTT_STREAM_RSLT_LINK_DEAD;
+    }
+
+    // 超时未确认的帧带 DUP 重传
+    for (uint32_t i = 0; i < inflight_count && result == CY_RSLT_SUCCESS; i++) {
+        if ((now - inflight[i].sent_tick) >= pdMS_TO_TICKS(MQTT_STREAM_RETRANSMIT_MS)) {
+            inflight[i].packet[0] |= MQTT_PUBLISH_FLAG_DUP;
+            result = send_all(inflight[i].packet, inflight[i].packet_len);
+            inflight[i].sent_tick = now;
+            stream_stats.retransmits++;
+        }
+    }
+
+    // 心跳开启时每个间隔发送一次 PINGREQ，否则空闲超过保活时间的一半时发送
+    if (result == CY_RSLT_SUCCESS && !ping_outstanding && (now - ping_sent_tick) >= ping_interval &&
+        (now - last_tx_tick) >= ping_idle) {
+        uint8_t packet[2] = { MQTT_PACKET_PINGREQ, 0 };
+        result = send_all(packet, sizeof(packet));
+        ping_outstanding = true;
+        ping_sent_tick = now;
+    }
+
+    if (result != CY_RSLT_SUCCESS) {
+        APP_LOG_STREAM_ERROR("Data connection lost: 0x%08X", (unsigned int)result);
+        close_socket();
+    }
+    return result;
+}
+
+void mqtt_stream_set_link_timeout_ms(uint32_t timeout_ms) {
+    link_timeout_ms = timeout_ms;
+}
+
+void mqtt_stream_get_stats(mqtt_stream_stats_t *stats) {
+    *stats = stream_stats;
+    stats->inflight = inflight_count;
+}
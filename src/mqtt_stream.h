@@ -0,0 +1,76 @@
+#ifndef MQTT_STREAM_H_
+#define MQTT_STREAM_H_
+
+#include "audio_task.h"
+#include "cy_result.h"
+#include <stdint.h>
+#include <stdbool.h>
+
+// 音频数据专用的精简 MQTT 3.1.1 发布连接 (基于 secure-sockets 的 TCP)。
+// cy_mqtt 的 QoS1 发布会阻塞到收到 PUBACK 为止，且不暴露底层套接字，无法流水线化；
+// 因此音频帧改走这条独立连接，连接管理、订阅和控制消息仍由 cy_mqtt 负责。
+// MQTT_AUDIO_FAST_PATH 时 QoS0 音频也走这条连接：主题和固定报头按 (主题, 负载长度) 预先编码并缓存，
+// 发布时写入帧头前的 AUDIO_FRAME_HEADROOM，报头与负载一次 cy_socket_send() 发出，不经过 cy_mqtt 的序列化缓冲。
+//
+// QoS1 时最多 MQTT_STREAM_INFLIGHT_WINDOW 个发布同时在途，发送不等待确认；PUBACK 按报文标识符匹配后归还帧。
+// 未确认的帧保留在帧缓冲池中，超时或重新连接后带 DUP 标志重传 (clean session = 0)。这是至少一次交付：
+// MQTT 3.1.1 代理不按 DUP 去重，PUBACK 丢失或断线时同一帧会被转发多次，接收端须按帧头中的 sequence 去重。
+// MQTT_HEARTBEAT_INTERVAL_MS 不为 0 时按同样的间隔发送 PINGREQ，超过判定时间没有收到任何报文即返回
+// MQTT_STREAM_RSLT_LINK_DEAD：数据连接和控制连接通常一起失效，keep-alive (60 s) 发现得太晚。
+// 只在网络任务中调用。
+
+#define MQTT_STREAM_CLIENT_ID_SUFFIX    "-data"  // 与控制连接使用不同的客户端 ID，避免互相踢下线
+#define MQTT_STREAM_CONNECT_TIMEOUT_MS  (5000)
+#define MQTT_STREAM_POLL_TIMEOUT_MS     (10)     // mqtt_stream_poll() 等待接收的最长时间
+#define MQTT_STREAM_RX_BUFFER_SIZE      (64)     // 只接收 CONNACK/PUBACK/PINGRESP 等短报文
+#define MQTT_STREAM_MAX_TOPIC_LEN       (48)     // "audio/backlog/<客户端 ID>"；PUBLISH 报头须放得进 AUDIO_FRAME_HEADROOM
+#define MQTT_STREAM_PREFIX_CACHE_SIZE   (4)      // 预先编码的 (主题, 负载长度) 报头前缀数
+
+// 代理拒绝连接或回复了无法解析的报文
+#define MQTT_STREAM_RSLT_PROTOCOL_ERROR CY_RSLT_CREATE(CY_RSLT_TYPE_ERROR, CY_RSLT_MODULE_MIDDLEWARE_BASE, 0x31)
+// PINGREQ 超过判定时间没有回应 (见 mqtt_stream_set_link_timeout_ms())
+#define MQTT_STREAM_RSLT_LINK_DEAD      CY_RSLT_CREATE(CY_RSLT_TYPE_ERROR, CY_RSLT_MODULE_MIDDLEWARE_BASE, 0x32)
+
+typedef struct {
+    uint32_t published;         // 首次发出的 PUBLISH 数
+    uint32_t acked;             // 收到的 PUBACK 数
+    uint32_t retransmits;       // 带 DUP 重发的次数
+    uint32_t inflight;          // 当前在途数
+    uint32_t inflight_max;      // 在途数峰值
+    uint32_t reconnects;        // 成功建立连接的次数
+    uint32_t link_dead_events;  // PINGREQ 超时判定失效的次数
+} mqtt_stream_stats_t;
+
+// 解析代理地址 (与控制连接当前使用的代理相同) 并建立连接 (CONNECT/CONNACK)。成功后立即重传所有在途帧。
+cy_rslt_t mqtt_stream_connect(const char *broker_address, const char *client_id);
+
+// 关闭连接。在途帧保留，下次连接后重传。
+void mqtt_stream_disconnect(void);
+
+bool mqtt_stream_is_connected(void);
+
+// 在途窗口未满，可以再发布一帧
+bool mqtt_stream_can_publish(void);
+
+// 以 MQTT_AUDIO_QOS 将一帧发布到 topic (长度不超过 MQTT_STREAM_MAX_TOPIC_LEN，地址和内容在运行期间不变，重传时仍会引用) 并接管其所有权：
+// QoS0 发送后立即归还，QoS1 在收到 PUBACK 后归还。
+cy_rslt_t mqtt_stream_publish(audio_data_t *frame, const char *topic);
+
+// 以 QoS0 发布一个共享的帧 (例如扇出 sink 持有的帧)，不接管所有权，返回后调用者仍持有引用。
+// 帧不在 QoS1 在途窗口中时报头写入其 transport_headroom、一次发送；在途时预留区中的报头要用于重传，
+// 报头单独发送。两种情况负载都直接从帧发出，不复制。
+cy_rslt_t mqtt_stream_publish_shared(const audio_data_t *frame, const char *topic);
+
+// 以 QoS0 发布不属于帧缓冲池的负载 (例如 FEC 校验包)。payload 之前须有 AUDIO_FRAME_HEADROOM 字节可写。
+cy_rslt_t mqtt_stream_publish_payload(const char *topic, uint8_t *payload, size_t payload_len);
+
+// 接收并处理 PUBACK/PINGRESP，执行超时重传和保活。最多阻塞 MQTT_STREAM_POLL_TIMEOUT_MS。
+// 连接出错时断开并返回错误，PINGREQ 超时返回 MQTT_STREAM_RSLT_LINK_DEAD。
+cy_rslt_t mqtt_stream_poll(void);
+
+// PINGREQ 的失效判定时间，与控制连接的心跳超时相同 (默认 MQTT_HEARTBEAT_TIMEOUT_MS)
+void mqtt_stream_set_link_timeout_ms(uint32_t timeout_ms);
+
+void mqtt_stream_get_stats(mqtt_stream_stats_t *stats);
+
+#endif /* MQTT_STREAM_H_ */
@@ -2,6 +2,26 @@
 #include "audio_task.h" // 用于 audio_queue
 #include "app_config.h"
 #include "state_machine.h"
+#include "fec.h"
+#include "rate_control.h"
+#include "backlog_lane.h"
+#include "http_upload.h"
+#include "heartbeat.h"
+#include "broker_select.h"
+#include "server_control.h"
+#include "frame_fanout.h"
+#include "clock_sync.h"
+#include "wifi_cache.h"
+#include "boot_profile.h"
+#if (AUDIO_PAYLOAD_ENCRYPTION != 0)
+#include "payload_crypto.h"
+#endif
+#if (MQTT_AUDIO_DATA_CONNECTION == 1)
+#include "mqtt_stream.h"
+#endif
+#if (AUDIO_TRANSPORT == AUDIO_TRANSPORT_UDP)
+#include "udp_stream.h"
+#endif
 
 #include "cyhal.h"
 #include "cybsp.h"
@@ -15,14 +35,28 @@
 
 #include <stdio.h> // 用于 printf，请替换为正确的日志记录
 #include <string.h>
+#include <malloc.h>  // mallinfo()
 
 // 日志记录占位符
 #define APP_LOG_NET_INFO(format, ...) printf("[NET] " format "\n", ##__VA_ARGS__)
 #define APP_LOG_NET_ERROR(format, ...) printf("[NET ERROR] " format "\n", ##__VA_ARGS__)
 
 #define MQTT_HANDLE_DESCRIPTOR            "MQTThandleID"
+#define MQTT_STREAM_RECONNECT_INTERVAL_MS (3000) // 数据连接重连 (及 UDP 套接字重新创建) 的最小间隔
 
 // MQTT 配置 (来自 app_config.h，但在此处为 cy_mqtt_broker_info_t 定义)
+// cy_mqtt 实例创建时绑定代理地址，切换代理时删除并以新地址重新创建实例。
+static const char *const broker_addresses[] = MQTT_BROKER_LIST;
+#define BROKER_COUNT (sizeof(broker_addresses) / sizeof(broker_addresses[0]))
+#if !defined(__cplusplus)
+_Static_assert(BROKER_COUNT <= BROKER_SELECT_MAX_ENDPOINTS, "MQTT_BROKER_LIST has too many entries");
+#endif
+static broker_select_t broker_select;
+static uint32_t active_broker = 0;          // 当前 cy_mqtt 实例绑定的代理
+static bool mqtt_instance_created = false;
+static bool broker_ever_connected = false;
+static uint32_t last_connected_broker = 0;
+
 static cy_mqtt_broker_info_t broker_info = {
     .hostname = MQTT_BROKER_ADDRESS,
     .hostname_len = (sizeof(MQTT_BROKER_ADDRESS) - 1),
@@ -41,22 +75,21 @@ static cy_mqtt_connect_info_t connection_info = {
 };
 
 #if (MQTT_SECURE_CONNECTION == 1)
-// 如果启用 MQTT_SECURE_CONNECTION，则为安全凭证占位符
-// 确保这些在 app_config.h 或安全位置正确定义
-// static const char client_certificate[] = "...";
-// static const char client_private_key[] = "...";
-// static const char root_ca_certificate[] = "...";
-
-static cy_awsport_ssl_credentials_t security_info = {
-    // .client_cert = client_certificate,
-    // .client_cert_size = sizeof(client_certificate),
-    // .private_key = client_private_key,
-    // .private_key_size = sizeof(client_private_key),
-    // .root_ca = root_ca_certificate,
-    // .root_ca_size = sizeof(root_ca_certificate)
-    // 如果使用安全连接，请适当初始化
-    .client_cert = NULL, .client_cert_size = 0, .private_key = NULL, .private_key_size = 0, .root_ca = NULL, .root_ca_size = 0
+// TLS 凭证来自 app_config.h，空字符串的项不设置。PEM 长度须包含结尾的 '\0'。
+#define TLS_CREDENTIAL(pem)       ((sizeof(pem) > 1) ? (pem) : NULL)
+#define TLS_CREDENTIAL_SIZE(pem)  ((sizeof(pem) > 1) ? sizeof(pem) : 0)
+
+static cy_awsport_ssl_credentials_t security_credentials = {
+    .root_ca = TLS_CREDENTIAL(MQTT_ROOT_CA_CERTIFICATE),
+    .root_ca_size = TLS_CREDENTIAL_SIZE(MQTT_ROOT_CA_CERTIFICATE),
+    .client_cert = TLS_CREDENTIAL(MQTT_CLIENT_CERTIFICATE),
+    .client_cert_size = TLS_CREDENTIAL_SIZE(MQTT_CLIENT_CERTIFICATE),
+    .private_key = TLS_CREDENTIAL(MQTT_CLIENT_PRIVATE_KEY),
+    .private_key_size = TLS_CREDENTIAL_SIZE(MQTT_CLIENT_PRIVATE_KEY),
+    .sni_host_name = TLS_CREDENTIAL(MQTT_SNI_HOST_NAME),
+    .sni_host_name_size = (sizeof(MQTT_SNI_HOST_NAME) > 1) ? sizeof(MQTT_SNI_HOST_NAME) - 1 : 0
 };
+static cy_awsport_ssl_credentials_t *security_info = &security_credentials;
 #else
 static cy_awsport_ssl_credentials_t *security_info = NULL;
 #endif
@@ -64,36 +97,185 @@ static cy_awsport_ssl_credentials_t *security_info = NULL;
 static cy_mqtt_t mqtt_connection_handle;
 static uint8_t mqtt_network_buffer[1024 * 2]; // MQTT 库网络缓冲区
 static char mqtt_client_id_buffer[64];
+// 音频主题带客户端 ID ("<主题>/<客户端 ID>")，接收端按主题区分设备。启动时生成后不再改变，数据连接按地址缓存报头
+static char stream_topic_buffer[sizeof(MQTT_TOPIC_AUDIO_STREAM) + sizeof(mqtt_client_id_buffer)];
+static char backlog_topic_buffer[sizeof(MQTT_TOPIC_AUDIO_BACKLOG) + sizeof(mqtt_client_id_buffer)];
+#if (AUDIO_FANOUT_DEPTH > 0) && (AUDIO_FANOUT_ARCHIVE == 1)
+static char archive_topic_buffer[sizeof(MQTT_TOPIC_AUDIO_ARCHIVE) + sizeof(mqtt_client_id_buffer)];
+#endif
+#if (AUDIO_TRANSPORT == AUDIO_TRANSPORT_UDP)
+static char feedback_topic_buffer[sizeof(MQTT_TOPIC_AUDIO_FEEDBACK) + sizeof(mqtt_client_id_buffer)];
+#endif
+
+// 应用层心跳 (见 heartbeat.h)。回显在 MQTT 回调中连同收到的节拍一起暂存，由网络任务处理。
+static heartbeat_t heartbeat;
+static char heartbeat_topic_buffer[sizeof(MQTT_TOPIC_HEARTBEAT) + sizeof(mqtt_client_id_buffer)];
+static char heartbeat_echo_topic_buffer[sizeof(MQTT_TOPIC_HEARTBEAT_ECHO) + sizeof(mqtt_client_id_buffer)];
+static uint8_t pending_echo[HEARTBEAT_PAYLOAD_SIZE];
+static size_t pending_echo_len = 0;
+static TickType_t pending_echo_tick = 0;
+static bool echo_pending = false;
+static volatile uint32_t requested_heartbeat_timeout_ms = MQTT_HEARTBEAT_TIMEOUT_MS;
+
+// 时钟同步 (见 clock_sync.h)。回复与心跳回显一样在 MQTT 回调中连同收到的节拍一起暂存，由网络任务处理。
+static clock_sync_t clock_sync;
+static char clock_topic_buffer[sizeof(MQTT_TOPIC_CLOCK) + sizeof(mqtt_client_id_buffer)];
+static char clock_reply_topic_buffer[sizeof(MQTT_TOPIC_CLOCK_REPLY) + sizeof(mqtt_client_id_buffer)];
+static uint8_t pending_clock_reply[CLOCK_SYNC_MSG_SIZE];
+static size_t pending_clock_reply_len = 0;
+static TickType_t pending_clock_reply_tick = 0;
+static bool clock_reply_pending = false;
+
+// 服务端流控和质量档位 (见 server_control.h)。MQTT 回调只解析命令并放入 control_queue，由网络任务应用。
+typedef struct {
+    server_control_cmd_t cmd;
+    TickType_t received_tick;
+} pending_control_t;
+#define CONTROL_QUEUE_LENGTH (4)
+static char control_topic_buffer[sizeof(MQTT_TOPIC_CONTROL) + sizeof(mqtt_client_id_buffer)];
+static QueueHandle_t control_queue;
+static StaticQueue_t control_queue_struct;
+static uint8_t control_queue_storage[CONTROL_QUEUE_LENGTH * sizeof(pending_control_t)];
+static bool credit_flow_enabled = false;
+static uint32_t flow_credits = 0;
+static bool control_id_valid = false;
+static uint16_t last_control_id = 0;
+static network_control_stats_t control_stats;
+static volatile uint32_t control_rejected = 0;             // 回调中丢弃的命令，只由 MQTT 回调写入
+
+#if (AUDIO_LIVE_FEC == 1)
+// 实时通道的 XOR 校验 (见 fec.h)。组大小由其他任务请求，在网络任务中应用。
+// 校验包前同样预留 AUDIO_FRAME_HEADROOM，数据连接或 UDP 传输可以原地写入报头。
+static uint8_t fec_parity_storage[AUDIO_FRAME_HEADROOM + FEC_PARITY_BUFFER_SIZE(sizeof(audio_data_t))];
+static uint8_t *const fec_parity_buffer = &fec_parity_storage[AUDIO_FRAME_HEADROOM];
+static fec_encoder_t fec_encoder;
+static volatile uint32_t requested_fec_group_size = MQTT_AUDIO_FEC_GROUP_SIZE_DEFAULT;
+#endif
+
+// 实时/积压两级调度：audio_queue 是实时通道，严格优先；出队时已经过时的帧 (断线期间积压的帧) 转入积压通道，
+// 只在实时通道为空时按令牌桶限速补发到 MQTT_TOPIC_AUDIO_BACKLOG/<客户端 ID>，速率为估计剩余带宽的 backlog_share_pct。
+// 积压通道只由网络任务访问。
+#if AUDIO_BACKLOG_LENGTH > BACKLOG_LANE_MAX_FRAMES
+#error "AUDIO_BACKLOG_LENGTH exceeds BACKLOG_LANE_MAX_FRAMES"
+#endif
+static backlog_lane_t backlog_lane;                         // 见 backlog_lane.h，桶深为两帧
+static bool backlog_lane_ready = false;
+static volatile uint32_t backlog_share_pct = AUDIO_BACKLOG_SHARE_PCT;
+static network_scheduler_stats_t scheduler_stats;
+static network_connection_stats_t connection_stats;
+
+// audio_queue 创建失败时为 NULL，网络任务照常运行，只是没有实时帧
+static uint32_t audio_queue_depth(void) {
+    return (audio_queue != NULL) ? (uint32_t)uxQueueMessagesWaiting(audio_queue) : 0;
+}
+
+#if (HTTP_UPLOAD_ENABLE == 1)
+// 会议进行中 (正在录音) 时不上传：一段 PUT 可能阻塞到 HTTP_UPLOAD_TIMEOUT_MS，期间实时帧无法发出
+static bool upload_paused_for_recording(void) {
+    return state_machine_get_current_state() == APP_STATE_MEETING_IN_PROGRESS;
+}
+#endif
+
+#if (AUDIO_FANOUT_DEPTH > 0)
+// 扇出 (见 frame_fanout.h)：帧在加密之后、交给传输层之前分发，各 sink 与发布路径共享同一帧缓冲 (引用计数)。
+// sink 不使用 transport_headroom：QoS1 在途帧的 PUBLISH 报头保留在其中，等待重传 (内置归档 sink 经
+// mqtt_stream_publish_shared() 发布，由它判断预留区是否空闲)。只由网络任务访问。
+typedef struct {
+    network_frame_sink_fn write;
+    void *context;
+} frame_sink_t;
+static frame_fanout_t fanout;
+static frame_sink_t frame_sinks[FRAME_FANOUT_MAX_SINKS];
+static bool fanout_ready = false;
+#endif
+
+#if (AUDIO_PAYLOAD_ENCRYPTION != 0)
+static payload_crypto_t payload_crypto;
+static bool payload_crypto_ready = false;
+#endif
+static TickType_t link_lost_tick = 0;                      // 控制连接断开的时间，0 表示未断开或已统计
 
 // Wi-Fi 和 MQTT 连接状态
 static volatile bool wifi_connected = false;
 static volatile bool mqtt_server_connected = false;
 
+#if (WIFI_FAST_RECONNECT == 1)
+// 快速重连的关联记录 (见 wifi_cache.h) 占用 Em_EEPROM 区 (工作闪存，与代码所在的主闪存分属不同扇区，写入时不阻塞取指)
+// 的一整行，按行擦写。声明为 volatile，读取不会被常量折叠成初始值。
+CY_SECTION(".cy_em_eeprom") CY_ALIGN(CY_FLASH_SIZEOF_ROW)
+static const volatile uint8_t wifi_cache_nvm[CY_FLASH_SIZEOF_ROW] = { 0 };
+static wifi_cache_record_t wifi_cache;
+static uint32_t wifi_credentials_hash;
+static bool wifi_static_ip_unverified = false;  // 用缓存的租约连上 Wi-Fi 后还没有连上过代理
+#endif
+
 // 用于在网络任务内部发信号通知连接事件的事件组
 #define WIFI_CONNECTED_BIT (1 << 0)
 #define MQTT_CONNECTED_BIT (1 << 1)
 #define WIFI_DISCONNECTED_BIT (1 << 2)
 #define MQTT_DISCONNECTED_BIT (1 << 3)
 #define SHUTDOWN_BIT (1 << 4) // 用于通知任务关闭
+#define CONTROL_COMMAND_BIT (1 << 5) // 收到服务端控制命令
 
 static EventGroupHandle_t network_event_group;
+static StaticEventGroup_t network_event_group_struct;
 
 // 前向声明
 static cy_rslt_t connect_to_wifi(void);
+#if (WIFI_FAST_RECONNECT == 1)
+static void load_wifi_cache(void);
+static void store_wifi_cache(void);
+static cy_rslt_t connect_to_cached_ap(bool *used_static_ip);
+static void remember_association(bool used_static_ip);
+#endif
 static cy_rslt_t connect_to_mqtt_broker(void);
 static void mqtt_event_callback(cy_mqtt_t mqtt_handle, cy_mqtt_event_t event, void *user_data);
 static void generate_client_id(void);
+static void schedule_audio_frames(void);
+static void note_link_lost(void);
+static void record_connect_time(TickType_t connect_start);
+static void service_heartbeat(void);
+static void handle_link_dead(const char *source);
+static void service_clock_sync(void);
+static void stamp_server_time(audio_data_t *frame);
+static uint32_t now_ms(void);
+static cy_rslt_t use_broker(uint32_t index);
+static void apply_control_commands(void);
+static void fanout_frame(audio_data_t *frame);
+static void service_frame_sinks(void);
+#if (AUDIO_FANOUT_DEPTH > 0) && (AUDIO_FANOUT_ARCHIVE == 1)
+static bool archive_sink_write(const audio_data_t *frame, void *context);
+#endif
+static bool flow_credit_available(void);
+static void flow_credit_consume(void);
+#if (AUDIO_PAYLOAD_ENCRYPTION != 0)
+static void init_payload_crypto(void);
+#endif
 
 void network_task(void *pvParameters) {
     (void)pvParameters;
     cy_rslt_t result;
-    audio_data_t received_audio_frame;
-    cy_mqtt_publish_info_t publish_info;
 
     APP_LOG_NET_INFO("Network task started.");
+    rate_control_init();
+    heartbeat_init(&heartbeat, MQTT_HEARTBEAT_INTERVAL_MS, MQTT_HEARTBEAT_TIMEOUT_MS);
+    clock_sync_init(&clock_sync, CLOCK_SYNC_INTERVAL_MS, CLOCK_SYNC_SAMPLES_PER_PERIOD);
+#if (AUDIO_PAYLOAD_ENCRYPTION != 0)
+    init_payload_crypto();
+#endif
+#if (AUDIO_FANOUT_DEPTH > 0) && (AUDIO_FANOUT_ARCHIVE == 1)
+    if (network_add_frame_sink(archive_sink_write, NULL, FRAME_FANOUT_DROP_OLDEST, AUDIO_FANOUT_DEPTH) < 0) {
+        APP_LOG_NET_ERROR("Failed to add archive sink.");
+    }
+#endif
+#if (AUDIO_LIVE_FEC == 1)
+    fec_encoder_init(&fec_encoder, fec_parity_buffer, sizeof(fec_parity_storage) - AUDIO_FRAME_HEADROOM, requested_fec_group_size);
+#endif
 
-    network_event_group = xEventGroupCreate();
-    if (network_event_group == NULL) {
+    network_event_group = xEventGroupCreateStatic(&network_event_group_struct);
+    control_queue = xQueueCreateStatic(CONTROL_QUEUE_LENGTH, sizeof(pending_control_t), control_queue_storage,
+                                       &control_queue_struct);
+    if (network_event_group == NULL || control_queue == NULL) {
         APP_LOG_NET_ERROR("Failed to create network event group.");
         vTaskDelete(NULL);
         return;
@@ -101,6 +283,7 @@ void network_task(void *pvParameters) {
 
     // 初始化 Wi-Fi 连接管理器
     cy_wcm_config_t wcm_config = {.interface = CY_WCM_INTERFACE_TYPE_STA};
+    boot_step_begin(BOOT_STEP_WCM_INIT);
     result = cy_wcm_init(&wcm_config);
     if (result != CY_RSLT_SUCCESS) {
         APP_LOG_NET_ERROR("Wi-Fi Connection Manager initialization failed: 0x%08X", (unsigned int)result);
@@ -110,9 +293,15 @@ void network_task(void *pvParameters) {
         vTaskDelete(NULL);
         return;
     }
+    boot_step_end(BOOT_STEP_WCM_INIT);
     APP_LOG_NET_INFO("Wi-Fi Connection Manager initialized.");
+#if (WIFI_FAST_RECONNECT == 1)
+    wifi_credentials_hash = wifi_cache_credentials_hash(WIFI_SSID, WIFI_PASSWORD, (uint32_t)WIFI_SECURITY);
+    load_wifi_cache();
+#endif
 
     // 初始化 MQTT 库
+    boot_step_begin(BOOT_STEP_MQTT_INIT);
     result = cy_mqtt_init();
     if (result != CY_RSLT_SUCCESS) {
         APP_LOG_NET_ERROR("MQTT library initialization failed: 0x%08X", (unsigned int)result);
@@ -123,21 +312,31 @@ void network_task(void *pvParameters) {
         vTaskDelete(NULL);
         return;
     }
+    boot_step_end(BOOT_STEP_MQTT_INIT);
     APP_LOG_NET_INFO("MQTT library initialized.");
     
     generate_client_id();
     connection_info.client_id = mqtt_client_id_buffer;
     connection_info.client_id_len = strlen(mqtt_client_id_buffer);
+    snprintf(stream_topic_buffer, sizeof(stream_topic_buffer), "%s/%s", MQTT_TOPIC_AUDIO_STREAM, mqtt_client_id_buffer);
+    snprintf(backlog_topic_buffer, sizeof(backlog_topic_buffer), "%s/%s", MQTT_TOPIC_AUDIO_BACKLOG, mqtt_client_id_buffer);
+#if (AUDIO_FANOUT_DEPTH > 0) && (AUDIO_FANOUT_ARCHIVE == 1)
+    snprintf(archive_topic_buffer, sizeof(archive_topic_buffer), "%s/%s", MQTT_TOPIC_AUDIO_ARCHIVE, mqtt_client_id_buffer);
+#endif
+#if (AUDIO_TRANSPORT == AUDIO_TRANSPORT_UDP)
+    snprintf(feedback_topic_buffer, sizeof(feedback_topic_buffer), "%s/%s", MQTT_TOPIC_AUDIO_FEEDBACK, mqtt_client_id_buffer);
+#endif
+    snprintf(heartbeat_topic_buffer, sizeof(heartbeat_topic_buffer), "%s/%s", MQTT_TOPIC_HEARTBEAT, mqtt_client_id_buffer);
+    snprintf(heartbeat_echo_topic_buffer, sizeof(heartbeat_echo_topic_buffer), "%s/%s", MQTT_TOPIC_HEARTBEAT_ECHO,
+             mqtt_client_id_buffer);
+    snprintf(control_topic_buffer, sizeof(control_topic_buffer), "%s/%s", MQTT_TOPIC_CONTROL, mqtt_client_id_buffer);
+    snprintf(clock_topic_buffer, sizeof(clock_topic_buffer), "%s/%s", MQTT_TOPIC_CLOCK, mqtt_client_id_buffer);
+    snprintf(clock_reply_topic_buffer, sizeof(clock_reply_topic_buffer), "%s/%s", MQTT_TOPIC_CLOCK_REPLY,
+             mqtt_client_id_buffer);
 
-    APP_LOG_NET_INFO("Broker Hostname: %s", broker_info.hostname);
-    APP_LOG_NET_INFO("Broker Hostname Len: %u", (unsigned int)broker_info.hostname_len);
-    APP_LOG_NET_INFO("Broker Port: %u", (unsigned int)broker_info.port);
-
-    result = cy_mqtt_create(mqtt_network_buffer, sizeof(mqtt_network_buffer),
-                            security_info, &broker_info, MQTT_HANDLE_DESCRIPTOR,
-                            &mqtt_connection_handle);
+    broker_select_init(&broker_select, broker_addresses, BROKER_COUNT, now_ms());
+    result = use_broker(0);
     if (result != CY_RSLT_SUCCESS) {
-        APP_LOG_NET_ERROR("MQTT instance creation failed: 0x%08X", (unsigned int)result);
         cy_mqtt_deinit();
         cy_wcm_deinit();
         report_server_disconnected_event();
@@ -145,48 +344,108 @@ void network_task(void *pvParameters) {
         vTaskDelete(NULL);
         return;
     }
-    APP_LOG_NET_INFO("MQTT instance created.");
-
-    cy_mqtt_register_event_callback(mqtt_connection_handle, mqtt_event_callback, NULL);
-
-    // 初始连接尝试
-    if (connect_to_wifi() == CY_RSLT_SUCCESS) {
+    // 初始连接尝试。Wi-Fi 关联之后降回正常优先级：TLS 握手是 CPU 密集的，不应压过音频和 UI 任务
+    bool wifi_up = connect_to_wifi() == CY_RSLT_SUCCESS;
+    vTaskPrioritySet(NULL, NETWORK_TASK_PRIORITY);
+    if (wifi_up) {
         connect_to_mqtt_broker();
     }
 
+    bool rate_measuring = false;
+#if (MQTT_AUDIO_DATA_CONNECTION == 1)
+    TickType_t stream_connect_tick = 0;
+    bool stream_connect_attempted = false;
+#endif
+#if (AUDIO_TRANSPORT == AUDIO_TRANSPORT_UDP)
+    TickType_t udp_open_tick = 0;
+    bool udp_open_attempted = false;
+#endif
+
     while (1) {
-        while (uxQueueMessagesWaiting(audio_queue) > 0) {
-            // 如果 MQTT 已连接，则处理音频队列
-            if (mqtt_server_connected && wifi_connected && audio_queue != NULL) {
-                if (xQueueReceive(audio_queue, &received_audio_frame, 0) == pdPASS) { // 非阻塞读取
-                    if (mqtt_server_connected && wifi_connected) {
-                        publish_info.qos = CY_MQTT_QOS0; // 或根据要求的 QOS_1
-                        publish_info.retain = false;
-                        publish_info.dup = false;
-                        publish_info.topic = MQTT_TOPIC_AUDIO_STREAM;
-                        publish_info.topic_len = strlen(MQTT_TOPIC_AUDIO_STREAM);
-                        publish_info.payload = (const void*)received_audio_frame.samples;
-                        publish_info.payload_len = received_audio_frame.num_samples * AUDIO_CHANNELS * (AUDIO_BIT_RESOLUTION / 8);
-
-                        result = cy_mqtt_publish(mqtt_connection_handle, &publish_info);
-                        if (result != CY_RSLT_SUCCESS) {
-                            APP_LOG_NET_ERROR("MQTT publish failed: 0x%08X", (unsigned int)result);
-                            // 如果发布失败，可能表示连接问题已由回调处理
-                        }
-                    } else {
-                        // 如果网络断开，可以选择丢弃帧或做其他处理
-                        APP_LOG_NET_INFO("Network not connected, discarding audio frame.");
-                        break; // 跳出内层while，去处理网络事件
-                    }
-                }
-            }
+#if (MQTT_AUDIO_DATA_CONNECTION == 1)
+        // 控制连接就绪后再建立数据连接；断开时在途帧保留在窗口中，重连后重传
+        if (mqtt_server_connected && wifi_connected && !mqtt_stream_is_connected() &&
+            (!stream_connect_attempted ||
+             (xTaskGetTickCount() - stream_connect_tick) >= pdMS_TO_TICKS(MQTT_STREAM_RECONNECT_INTERVAL_MS))) {
+            stream_connect_attempted = true;
+            stream_connect_tick = xTaskGetTickCount();
+            (void)mqtt_stream_connect(broker_addresses[active_broker], mqtt_client_id_buffer);
         }
-        
+        if (mqtt_stream_is_connected() && mqtt_stream_poll() == MQTT_STREAM_RSLT_LINK_DEAD && mqtt_server_connected) {
+            // 数据连接无声断开时控制连接通常也已失效：两条连接一起断开重连
+            handle_link_dead("data connection PINGREQ");
+        }
+#endif
+#if (AUDIO_TRANSPORT == AUDIO_TRANSPORT_UDP)
+        // UDP 没有连接状态，控制连接在线 (接收端可达、能收到反馈) 时才发送
+        if (mqtt_server_connected && wifi_connected && !udp_stream_is_open() &&
+            (!udp_open_attempted ||
+             (xTaskGetTickCount() - udp_open_tick) >= pdMS_TO_TICKS(MQTT_STREAM_RECONNECT_INTERVAL_MS))) {
+            udp_open_attempted = true;
+            udp_open_tick = xTaskGetTickCount();
+            (void)udp_stream_open(broker_addresses[active_broker], mqtt_client_id_buffer);
+        }
+        udp_stream_feedback_t feedback;
+        if (udp_stream_take_feedback(&feedback)) {
+            rate_control_report_loss((uint32_t)feedback.fraction_lost * 100u / 256u);
+        }
+#endif
+        // 先应用服务端命令，新的信用和档位从本轮开始生效
+        apply_control_commands();
+        // 链路断开时不出队，帧留在 audio_queue 中由音频任务的过载策略处理
+        schedule_audio_frames();
+
+        service_frame_sinks();
+
+#if (HTTP_UPLOAD_ENABLE == 1)
+        // 批量上传每轮最多一段，一段可能阻塞数秒，录音期间暂停，避免推迟实时帧
+        bool upload_allowed = wifi_connected && !upload_paused_for_recording() && backlog_lane_depth(&backlog_lane) == 0 && audio_queue_depth() == 0;
+        if (upload_allowed) {
+            (void)http_upload_step();
+        }
+#endif
+
+        // 码率自适应只在实时链路在线时测量，重新连接后从新的周期开始
+#if (AUDIO_TRANSPORT == AUDIO_TRANSPORT_UDP)
+        bool audio_link_up = udp_stream_is_open();
+#elif (MQTT_AUDIO_DATA_CONNECTION == 1)
+        bool audio_link_up = mqtt_stream_is_connected();
+#else
+        bool audio_link_up = mqtt_server_connected && wifi_connected;
+#endif
+        if (audio_link_up && !rate_measuring) {
+            rate_control_restart_interval();
+        } else if (audio_link_up) {
+#if (MQTT_AUDIO_DATA_CONNECTION == 1)
+            mqtt_stream_stats_t stream_stats;
+            mqtt_stream_get_stats(&stream_stats);
+            rate_control_update(stream_stats.inflight * 100u / MQTT_STREAM_INFLIGHT_WINDOW);
+#else
+            rate_control_update(0); // cy_mqtt 不暴露套接字发送缓冲占用，只靠发布耗时和队列增长
+#endif
+        }
+        rate_measuring = audio_link_up;
+
+        service_heartbeat();
+        service_clock_sync();
+
+#if (MQTT_AUDIO_DATA_CONNECTION == 1)
+        // 数据连接在线时需要及时处理 PUBACK，缩短等待
+        TickType_t event_wait = mqtt_stream_is_connected() ? pdMS_TO_TICKS(MQTT_STREAM_POLL_TIMEOUT_MS) : pdMS_TO_TICKS(100);
+#else
+        TickType_t event_wait = pdMS_TO_TICKS(100);
+#endif
+#if (HTTP_UPLOAD_ENABLE == 1)
+        if (upload_allowed && http_upload_is_busy()) {
+            event_wait = 1; // 上传期间逐段连续发送，每段之间仍让出 CPU 并检查音频队列
+        }
+#endif
         EventBits_t bits = xEventGroupWaitBits(network_event_group,
-                                               WIFI_CONNECTED_BIT | MQTT_CONNECTED_BIT | WIFI_DISCONNECTED_BIT | MQTT_DISCONNECTED_BIT | SHUTDOWN_BIT,
+                                               WIFI_CONNECTED_BIT | MQTT_CONNECTED_BIT | WIFI_DISCONNECTED_BIT | MQTT_DISCONNECTED_BIT | SHUTDOWN_BIT |
+                                               CONTROL_COMMAND_BIT,
                                                pdTRUE, // 退出时清除
                                                pdFALSE, // 等待任一位
-                                               pdMS_TO_TICKS(100)); // 处理音频队列超时
+                                               event_wait); // 处理音频队列超时
 
         if (bits & SHUTDOWN_BIT) {
             APP_LOG_NET_INFO("Shutdown signal received.");
@@ -195,6 +454,18 @@ void network_task(void *pvParameters) {
 
         if (bits & WIFI_DISCONNECTED_BIT) {
             APP_LOG_NET_INFO("Wi-Fi disconnected bit set.");
+            note_link_lost();
+            heartbeat_stop(&heartbeat);
+            clock_sync_stop(&clock_sync);
+#if (HTTP_UPLOAD_ENABLE == 1)
+            http_upload_close();
+#endif
+#if (MQTT_AUDIO_DATA_CONNECTION == 1)
+            mqtt_stream_disconnect();
+#endif
+#if (AUDIO_TRANSPORT == AUDIO_TRANSPORT_UDP)
+            udp_stream_close();
+#endif
             if (mqtt_server_connected) {
                  cy_mqtt_disconnect(mqtt_connection_handle); // MQTT 也将断开连接
                  mqtt_server_connected = false;
@@ -211,6 +482,15 @@ void network_task(void *pvParameters) {
 
         if (bits & MQTT_DISCONNECTED_BIT) {
             APP_LOG_NET_INFO("MQTT disconnected bit set (Wi-Fi may still be connected).");
+            note_link_lost();
+            heartbeat_stop(&heartbeat);
+            clock_sync_stop(&clock_sync);
+#if (MQTT_AUDIO_DATA_CONNECTION == 1)
+            mqtt_stream_disconnect();
+#endif
+#if (AUDIO_TRANSPORT == AUDIO_TRANSPORT_UDP)
+            udp_stream_close();
+#endif
             mqtt_server_connected = false;
             report_server_disconnected_event();
             // 如果 Wi-Fi 仍处于连接状态，则尝试重新连接 MQTT
@@ -237,10 +517,21 @@ void network_task(void *pvParameters) {
 
     // 清理
     APP_LOG_NET_INFO("Network task shutting down...");
+#if (HTTP_UPLOAD_ENABLE == 1)
+    http_upload_close();
+#endif
+#if (MQTT_AUDIO_DATA_CONNECTION == 1)
+    mqtt_stream_disconnect();
+#endif
+#if (AUDIO_TRANSPORT == AUDIO_TRANSPORT_UDP)
+    udp_stream_close();
+#endif
     if (mqtt_server_connected) {
         cy_mqtt_disconnect(mqtt_connection_handle);
     }
-    cy_mqtt_delete(mqtt_connection_handle);
+    if (mqtt_instance_created) {
+        cy_mqtt_delete(mqtt_connection_handle);
+    }
     cy_mqtt_deinit();
     if (wifi_connected) {
         cy_wcm_disconnect_ap();
@@ -251,6 +542,280 @@ void network_task(void *pvParameters) {
     vTaskDelete(NULL);
 }
 
+#if (MQTT_AUDIO_DATA_CONNECTION == 1)
+// 数据连接：报头原地写入帧头前的预留区，一次发送；发布耗时计入码率自适应
+static void publish_frame_to(audio_data_t *frame, const char *topic) {
+    size_t payload_len = audio_frame_payload_len(frame);
+    TickType_t publish_start = xTaskGetTickCount();
+    (void)mqtt_stream_publish(frame, topic);
+    rate_control_on_publish(payload_len, xTaskGetTickCount() - publish_start);
+}
+
+static void publish_audio_payload(const char *topic, uint8_t *payload, size_t payload_len) {
+    TickType_t publish_start = xTaskGetTickCount();
+    (void)mqtt_stream_publish_payload(topic, payload, payload_len);
+    rate_control_on_publish(payload_len, xTaskGetTickCount() - publish_start);
+}
+
+// QoS1 时在途窗口满同样视为不可发布
+static bool audio_link_ready(void) {
+    return mqtt_stream_can_publish();
+}
+#else
+static void publish_audio_payload(const char *topic, uint8_t *payload, size_t payload_len) {
+    cy_mqtt_publish_info_t publish_info;
+    publish_info.qos = CY_MQTT_QOS0;
+    publish_info.retain = false;
+    publish_info.dup = false;
+    publish_info.topic = topic;
+    publish_info.topic_len = strlen(topic);
+    publish_info.payload = (const char *)payload;
+    publish_info.payload_len = payload_len;
+
+    TickType_t publish_start = xTaskGetTickCount();
+    cy_rslt_t result = cy_mqtt_publish(mqtt_connection_handle, &publish_info);
+    if (result != CY_RSLT_SUCCESS) {
+        APP_LOG_NET_ERROR("MQTT publish failed: 0x%08X", (unsigned int)result);
+        // 如果发布失败，可能表示连接问题已由回调处理
+    }
+    // 发送缓冲满时发布会阻塞，耗时反映链路速率
+    rate_control_on_publish(payload_len, xTaskGetTickCount() - publish_start);
+}
+
+static void publish_frame_to(audio_data_t *frame, const char *topic) {
+    publish_audio_payload(topic, (uint8_t *)&frame->header, audio_frame_payload_len(frame)); // 帧头 + 负载，长度随帧长和格式变化
+    audio_release_frame(frame);
+}
+
+static bool audio_link_ready(void) {
+    return mqtt_server_connected && wifi_connected;
+}
+#endif
+
+#if (AUDIO_TRANSPORT == AUDIO_TRANSPORT_UDP)
+// 实时通道经 UDP 发送：RTP 报头写入帧头前的预留区，一次发送；发送几乎不阻塞，拥塞由接收端的丢包报告反映
+static void publish_live_payload(uint8_t *payload, size_t payload_len) {
+    TickType_t publish_start = xTaskGetTickCount();
+    (void)udp_stream_send(payload, payload_len);
+    rate_control_on_publish(payload_len, xTaskGetTickCount() - publish_start);
+}
+
+static void publish_live_to_link(audio_data_t *frame) {
+    publish_live_payload((uint8_t *)&frame->header, audio_frame_payload_len(frame));
+    audio_release_frame(frame);
+}
+
+static bool live_link_ready(void) {
+    return udp_stream_is_open();
+}
+#else
+static void publish_live_payload(uint8_t *payload, size_t payload_len) {
+    publish_audio_payload(stream_topic_buffer, payload, payload_len);
+}
+
+static void publish_live_to_link(audio_data_t *frame) {
+    publish_frame_to(frame, stream_topic_buffer);
+}
+
+static bool live_link_ready(void) {
+    return audio_link_ready();
+}
+#endif
+
+#if (AUDIO_PAYLOAD_ENCRYPTION != 0)
+// 每次启动随机生成 salt：帧序号每次启动从 0 开始，salt 保证同一密钥下 nonce 不重复
+static void init_payload_crypto(void) {
+    static const uint8_t key[PAYLOAD_CRYPTO_KEY_SIZE] = AUDIO_PAYLOAD_KEY;
+    uint8_t salt[PAYLOAD_CRYPTO_SALT_SIZE];
+    cyhal_trng_t trng;
+    if (cyhal_trng_init(&trng) != CY_RSLT_SUCCESS) {
+        APP_LOG_NET_ERROR("TRNG init failed, audio frames will not be sent.");
+        return;
+    }
+    for (size_t i = 0; i < sizeof(salt); i += sizeof(uint32_t)) {
+        uint32_t word = cyhal_trng_generate(&trng);
+        memcpy(&salt[i], &word, sizeof(word));
+    }
+    cyhal_trng_free(&trng);
+
+    payload_crypto_ready = payload_crypto_init(&payload_crypto, AUDIO_PAYLOAD_ENCRYPTION, key, salt);
+    if (!payload_crypto_ready) {
+        APP_LOG_NET_ERROR("Payload cipher %d unavailable, audio frames will not be sent.", AUDIO_PAYLOAD_ENCRYPTION);
+    }
+}
+
+// 在帧缓冲中原地加密帧，尾部写在负载之后 (最长负载时落在 transport_tailroom 中)，不做拷贝。
+// 加密失败的帧直接丢弃，不以明文发送。耗时 (DWT 周期) 记入调度统计，可与 TLS 下的发布耗时比较。
+static bool seal_frame(audio_data_t *frame) {
+    uint8_t *packet = (uint8_t *)&frame->header;
+    size_t capacity = sizeof(audio_data_t) - offsetof(audio_data_t, header);
+    size_t sealed_len = 0;
+
+    uint32_t start_cycles = DWT->CYCCNT;
+    if (payload_crypto_ready) {
+        sealed_len = payload_crypto_seal(&payload_crypto, packet, audio_frame_payload_len(frame), capacity);
+    }
+    uint32_t cycles = DWT->CYCCNT - start_cycles;
+
+    if (sealed_len == 0) {
+        scheduler_stats.seal_failures++;
+        audio_release_frame(frame);
+        return false;
+    }
+    scheduler_stats.seal_cycles_last = cycles;
+    if (cycles > scheduler_stats.seal_cycles_max) {
+        scheduler_stats.seal_cycles_max = cycles;
+    }
+    return true;
+}
+#endif
+
+// 发布一帧实时帧 (发布后帧归还帧缓冲池)；启用 FEC 时在组结束后紧跟着发布校验包。
+// 发布耗时 (DWT 周期，含套接字发送) 记入调度统计，可用 MQTT_AUDIO_FAST_PATH 比较两条发布路径的开销。
+// 启用加密时帧先原地加密，校验包是已加密帧的异或，无需再加密。
+static void publish_live_frame(audio_data_t *frame) {
+    stamp_server_time(frame);
+#if (AUDIO_PAYLOAD_ENCRYPTION != 0)
+    if (!seal_frame(frame)) {
+        return;
+    }
+#endif
+    fanout_frame(frame);
+#if (AUDIO_LIVE_FEC == 1)
+    (void)fec_encoder_set_group_size(&fec_encoder, requested_fec_group_size);
+    size_t parity_len = fec_encoder_close_before(&fec_encoder, frame->header.sequence);
+    if (parity_len > 0) {
+        publish_live_payload(fec_parity_buffer, parity_len);
+    }
+    // 发布后帧即归还，先累加校验
+    parity_len = fec_encoder_add(&fec_encoder, (const uint8_t *)&frame->header, audio_frame_payload_len(frame));
+#endif
+
+    uint32_t start_cycles = DWT->CYCCNT;
+    publish_live_to_link(frame);
+    uint32_t cycles = DWT->CYCCNT - start_cycles;
+    scheduler_stats.publish_cycles_last = cycles;
+    if (cycles > scheduler_stats.publish_cycles_max) {
+        scheduler_stats.publish_cycles_max = cycles;
+    }
+
+#if (AUDIO_LIVE_FEC == 1)
+    if (parity_len > 0) {
+        publish_live_payload(fec_parity_buffer, parity_len);
+    }
+#endif
+}
+
+// 积压帧不参与 FEC：补发顺序与实时帧交错，按序号分组没有意义
+// 积压标志在转入积压通道时已置位，加密时帧头已是最终内容
+static void publish_backlog_frame(audio_data_t *frame) {
+    stamp_server_time(frame);
+#if (AUDIO_PAYLOAD_ENCRYPTION != 0)
+    if (!seal_frame(frame)) {
+        return;
+    }
+#endif
+    fanout_frame(frame);
+    publish_frame_to(frame, backlog_topic_buffer);
+}
+
+static uint32_t frame_age_ms(const audio_data_t *frame, TickType_t now) {
+    return (uint32_t)((now - (TickType_t)frame->header.timestamp_ms) * portTICK_PERIOD_MS);
+}
+
+static void backlog_push(audio_data_t *frame, uint32_t now_ms) {
+    frame->header.flags |= AUDIO_FRAME_FLAG_BACKLOG;
+    // 积压通道满时挤出最旧的积压帧，优先保留较新的内容
+    audio_data_t *evicted = backlog_lane_push(&backlog_lane, frame, frame->header.timestamp_ms * portTICK_PERIOD_MS,
+                                              (uint32_t)audio_frame_payload_len(frame), now_ms);
+    if (evicted != NULL) {
+        audio_release_frame(evicted);
+        scheduler_stats.backlog_dropped++;
+    }
+}
+
+static void schedule_audio_frames(void) {
+    audio_data_t *frame;
+    TickType_t now = xTaskGetTickCount();
+    uint32_t now_ms = (uint32_t)(now * portTICK_PERIOD_MS);
+
+    if (audio_queue == NULL) {
+        return;
+    }
+    if (!backlog_lane_ready) {
+        backlog_lane_ready = backlog_lane_init(&backlog_lane, AUDIO_BACKLOG_LENGTH, 2u * sizeof(audio_data_t) * 8u, now_ms);
+    }
+
+    // 实时通道：严格优先，出队时帧龄超过 AUDIO_LIVE_MAX_AGE_MS 的帧转入积压通道。
+    // 服务端流控的信用用完时不出队，帧留在 audio_queue 中。
+    while (live_link_ready() && flow_credit_available() && xQueueReceive(audio_queue, &frame, 0) == pdPASS) {
+        uint32_t age_ms = frame_age_ms(frame, now);
+        if (age_ms > AUDIO_LIVE_MAX_AGE_MS) {
+            backlog_push(frame, now_ms);
+            continue;
+        }
+        publish_live_frame(frame);
+        flow_credit_consume();
+        scheduler_stats.live_published++;
+        if (age_ms > scheduler_stats.live_latency_max_ms) {
+            scheduler_stats.live_latency_max_ms = age_ms;
+        }
+    }
+
+    // 过旧的积压帧已没有补发价值
+    while ((frame = backlog_lane_expire(&backlog_lane, now_ms, AUDIO_BACKLOG_MAX_AGE_MS)) != NULL) {
+        audio_release_frame(frame);
+        scheduler_stats.backlog_dropped++;
+    }
+
+    // 令牌按 (估计带宽 - 当前档位码率) * backlog_share_pct 补充
+    rate_control_stats_t rc;
+    rate_control_get_stats(&rc);
+    backlog_lane_refill(&backlog_lane, now_ms, (rc.estimate_bps > rc.tier_bps) ? rc.estimate_bps - rc.tier_bps : 0,
+                        backlog_share_pct);
+    while (backlog_lane_depth(&backlog_lane) > 0 && audio_link_ready() && flow_credit_available() &&
+           audio_queue_depth() == 0 && (frame = backlog_lane_pop(&backlog_lane, now_ms)) != NULL) {
+        publish_backlog_frame(frame);
+        flow_credit_consume();
+        scheduler_stats.backlog_published++;
+    }
+    scheduler_stats.backlog_depth = backlog_lane_depth(&backlog_lane);
+    scheduler_stats.last_catchup_ms = backlog_lane.last_catchup_ms;
+}
+
+bool network_set_backlog_share_pct(uint32_t share_pct) {
+    if (share_pct > 100u) {
+        return false;
+    }
+    backlog_share_pct = share_pct;
+    return true;
+}
+
+void network_get_scheduler_stats(network_scheduler_stats_t *stats) {
+    *stats = scheduler_stats;
+}
+
+bool network_set_fec_group_size(uint32_t group_size) {
+#if (AUDIO_LIVE_FEC == 1)
+    if (group_size != 0 && (group_size < FEC_MIN_GROUP_SIZE || group_size > FEC_MAX_GROUP_SIZE)) {
+        return false;
+    }
+    requested_fec_group_size = group_size;
+    return true;
+#else
+    // 实时帧经 QoS1 发布时由重传保证可靠性，不生成校验包
+    return group_size == 0;
+#endif
+}
+
+uint32_t network_get_fec_group_size(void) {
+#if (AUDIO_LIVE_FEC == 1)
+    return requested_fec_group_size;
+#else
+    return 0;
+#endif
+}
+
 static void generate_client_id(void){
     // 简单的客户端 ID 生成：前缀 + MAC 地址的最后几个字节
     // 生产环境可能需要更健壮的唯一 ID 生成方式。
@@ -268,19 +833,37 @@ static void generate_client_id(void){
 static cy_rslt_t connect_to_wifi(void) {
     if (wifi_connected) return CY_RSLT_SUCCESS;
 
+    boot_step_begin(BOOT_STEP_WIFI_CONNECT);    // 只记录启动时的第一次
     APP_LOG_NET_INFO("Connecting to Wi-Fi AP: %s", WIFI_SSID);
     cy_wcm_connect_params_t connect_params = {
         .ap_credentials.SSID = WIFI_SSID,
         .ap_credentials.password = WIFI_PASSWORD,
         .ap_credentials.security = WIFI_SECURITY,
-        // .BSSID - 未指定，连接到具有该 SSID 的任何 AP
+        // .BSSID - 未指定，扫描后连接到具有该 SSID 的任何 AP
     };
 
     cy_rslt_t result = CY_RSLT_SUCCESS; 
     for (int retries = 0; retries < 5; retries++) { // 在再次报告失败前的有限重试次数
-        result = cy_wcm_connect_ap(&connect_params, NULL);
+        TickType_t connect_start = xTaskGetTickCount();
+        bool used_static_ip = false;
+#if (WIFI_FAST_RECONNECT == 1)
+        // 先直接关联上次的 AP，失败时在同一轮中立即回退到扫描
+        result = connect_to_cached_ap(&used_static_ip);
+        if (result != CY_RSLT_SUCCESS)
+#endif
+        {
+            result = cy_wcm_connect_ap(&connect_params, NULL);
+            if (result == CY_RSLT_SUCCESS) {
+                connection_stats.wifi_scan_connects++;
+            }
+        }
         if (result == CY_RSLT_SUCCESS) {
-            APP_LOG_NET_INFO("Successfully connected to Wi-Fi AP.");
+            connection_stats.wifi_connect_ms_last = (uint32_t)((xTaskGetTickCount() - connect_start) * portTICK_PERIOD_MS);
+            APP_LOG_NET_INFO("Successfully connected to Wi-Fi AP in %lu ms.", (unsigned long)connection_stats.wifi_connect_ms_last);
+#if (WIFI_FAST_RECONNECT == 1)
+            remember_association(used_static_ip);
+#endif
+            boot_step_end(BOOT_STEP_WIFI_CONNECT);
             wifi_connected = true;
             report_wifi_connected_event();
             xEventGroupSetBits(network_event_group, WIFI_CONNECTED_BIT);
@@ -297,6 +880,480 @@ static cy_rslt_t connect_to_wifi(void) {
     return result; // 返回最后一个错误
 }
 
+#if (WIFI_FAST_RECONNECT == 1)
+static void load_wifi_cache(void) {
+    uint8_t *dst = (uint8_t *)&wifi_cache;
+    for (size_t i = 0; i < sizeof(wifi_cache); i++) {
+        dst[i] = wifi_cache_nvm[i];
+    }
+    if (wifi_cache_is_valid(&wifi_cache, wifi_credentials_hash)) {
+        APP_LOG_NET_INFO("Cached AP %02X:%02X:%02X:%02X:%02X:%02X on channel %u, IP lease %s.", wifi_cache.bssid[0],
+                         wifi_cache.bssid[1], wifi_cache.bssid[2], wifi_cache.bssid[3], wifi_cache.bssid[4], wifi_cache.bssid[5],
+                         (unsigned int)wifi_cache.channel, (wifi_cache.ip != 0) ? "cached" : "none");
+    }
+}
+
+// 整行写入 (cyhal_flash_write 先擦除再编程)，约 20 ms，只在关联参数变化时执行
+static void store_wifi_cache(void) {
+    static uint32_t row[CY_FLASH_SIZEOF_ROW / sizeof(uint32_t)];
+    memset(row, 0, sizeof(row));
+    memcpy(row, &wifi_cache, sizeof(wifi_cache));
+    cyhal_flash_t flash;
+    cy_rslt_t result = cyhal_flash_init(&flash);
+    if (result == CY_RSLT_SUCCESS) {
+        result = cyhal_flash_write(&flash, (uint32_t)(uintptr_t)wifi_cache_nvm, row);
+        cyhal_flash_free(&flash);
+    }
+    if (result != CY_RSLT_SUCCESS) {
+        APP_LOG_NET_ERROR("Failed to store Wi-Fi cache: 0x%08X", (unsigned int)result);
+    }
+}
+
+// 用缓存的 BSSID 直接关联，租约可用时作为静态 IP 传入，跳过扫描和 DHCP。
+// 没有可用记录或关联失败时返回错误，由调用者回退到扫描。失败时不清除记录：AP 可能只是暂时不在 (断电、走出覆盖)，
+// AP 确实更换时扫描连上后 remember_association() 会覆盖它。
+static cy_rslt_t connect_to_cached_ap(bool *used_static_ip) {
+    *used_static_ip = false;
+    wifi_cache_plan_t plan = wifi_cache_plan(&wifi_cache, wifi_credentials_hash);
+    if (plan == WIFI_CACHE_PLAN_SCAN) {
+        return CY_RSLT_MODULE_WCM_BASE;
+    }
+    cy_wcm_ip_setting_t static_ip = {
+        .ip_address = { .version = CY_WCM_IP_VER_V4, .ip.v4 = wifi_cache.ip },
+        .gateway = { .version = CY_WCM_IP_VER_V4, .ip.v4 = wifi_cache.gateway },
+        .netmask = { .version = CY_WCM_IP_VER_V4, .ip.v4 = wifi_cache.netmask }
+    };
+    // cy_wcm_connect_params_t 没有信道字段，频段限定在缓存 AP 所在的频段
+    cy_wcm_connect_params_t connect_params = {
+        .ap_credentials.SSID = WIFI_SSID,
+        .ap_credentials.password = WIFI_PASSWORD,
+        .ap_credentials.security = WIFI_SECURITY,
+        .static_ip_settings = (plan == WIFI_CACHE_PLAN_DIRECTED_STATIC) ? &static_ip : NULL,
+        .band = (cy_wcm_wifi_band_t)wifi_cache.band
+    };
+    memcpy(connect_params.BSSID, wifi_cache.bssid, sizeof(connect_params.BSSID));
+    APP_LOG_NET_INFO("Directed join to cached AP on channel %u (%s).", (unsigned int)wifi_cache.channel,
+                     (plan == WIFI_CACHE_PLAN_DIRECTED_STATIC) ? "cached IP" : "DHCP");
+
+    cy_rslt_t result = cy_wcm_connect_ap(&connect_params, NULL);
+    if (result == CY_RSLT_SUCCESS) {
+        connection_stats.wifi_directed_connects++;
+        *used_static_ip = (plan == WIFI_CACHE_PLAN_DIRECTED_STATIC);
+        wifi_static_ip_unverified = *used_static_ip;
+    } else {
+        connection_stats.wifi_directed_failures++;
+        APP_LOG_NET_ERROR("Directed join failed: 0x%08X, falling back to scan.", (unsigned int)result);
+    }
+    return result;
+}
+
+// 记录本次关联的 AP 和租约，有变化时写回闪存
+static void remember_association(bool used_static_ip) {
+    cy_wcm_associated_ap_info_t ap_info;
+    cy_wcm_ip_address_t ip_address;
+    cy_wcm_ip_address_t netmask = { 0 };
+    cy_wcm_ip_address_t gateway = { 0 };
+    if (cy_wcm_get_associated_ap_info(&ap_info) != CY_RSLT_SUCCESS ||
+        cy_wcm_get_ip_addr(CY_WCM_INTERFACE_TYPE_STA, &ip_address) != CY_RSLT_SUCCESS) {
+        return;
+    }
+    (void)cy_wcm_get_ip_netmask(CY_WCM_INTERFACE_TYPE_STA, &netmask);
+    (void)cy_wcm_get_gateway_ip_address(CY_WCM_INTERFACE_TYPE_STA, &gateway);
+    uint8_t band = (ap_info.channel > 14u) ? (uint8_t)CY_WCM_WIFI_BAND_5GHZ : (uint8_t)CY_WCM_WIFI_BAND_2_4GHZ;
+    if (wifi_cache_update(&wifi_cache, wifi_credentials_hash, ap_info.BSSID, ap_info.channel, band, ip_address.ip.v4,
+                          netmask.ip.v4, gateway.ip.v4, used_static_ip)) {
+        store_wifi_cache();
+    }
+}
+#endif
+
+// clean session：每次连接后都要重新订阅。订阅失败不影响音频发送：
+// 没有 UDP 反馈时码率自适应看不到丢包，没有心跳回显时只剩 MQTT keep-alive，没有控制主题时不受服务端流控。
+static void subscribe_topic(const char *topic, cy_mqtt_qos_t qos) {
+    cy_mqtt_subscribe_info_t subscribe_info = {
+        .qos = qos,
+        .topic = topic,
+        .topic_len = (uint16_t)strlen(topic)
+    };
+    cy_rslt_t result = cy_mqtt_subscribe(mqtt_connection_handle, &subscribe_info, 1);
+    if (result != CY_RSLT_SUCCESS) {
+        APP_LOG_NET_ERROR("Failed to subscribe to '%s': 0x%08X", topic, (unsigned int)result);
+    }
+}
+
+static bool topic_matches(const cy_mqtt_received_msg_info_t *message, const char *topic) {
+    return message->topic_len == strlen(topic) && memcmp(message->topic, topic, message->topic_len) == 0;
+}
+
+// 信用用完时实时和积压通道都停止出队；流控关闭时总有信用
+static bool flow_credit_available(void) {
+    return !credit_flow_enabled || flow_credits > 0;
+}
+
+static void flow_credit_consume(void) {
+    if (credit_flow_enabled && --flow_credits == 0) {
+        control_stats.credit_stalls++;
+    }
+}
+
+static void apply_credit_command(const server_control_cmd_t *cmd) {
+    if (cmd->flags & SERVER_CONTROL_FLAG_CREDIT_OFF) {
+        credit_flow_enabled = false;
+        flow_credits = 0;
+        APP_LOG_NET_INFO("Flow control off.");
+        return;
+    }
+    credit_flow_enabled = true;
+    flow_credits = (flow_credits > UINT32_MAX - cmd->credits) ? UINT32_MAX : flow_credits + cmd->credits;
+    APP_LOG_NET_INFO("Flow control: +%lu credits, %lu available.", (unsigned long)cmd->credits, (unsigned long)flow_credits);
+}
+
+// 格式和采样率由服务端固定时关闭码率自适应，否则两者会互相覆盖
+static void apply_quality_command(const server_control_cmd_t *cmd) {
+    if (cmd->flags & SERVER_CONTROL_FLAG_QUALITY_AUTO) {
+        rate_control_set_enabled(true);
+        APP_LOG_NET_INFO("Quality tier returned to rate control.");
+    } else if (cmd->format != SERVER_CONTROL_KEEP_FORMAT || cmd->sample_rate_hz != 0) {
+        rate_control_set_enabled(false);
+        if (cmd->format != SERVER_CONTROL_KEEP_FORMAT) {
+            bool ok = audio_set_stream_format(cmd->format);
+            APP_LOG_NET_INFO("Quality: format %u %s.", (unsigned int)cmd->format, ok ? "applied" : "unsupported");
+        }
+        if (cmd->sample_rate_hz != 0) {
+            bool ok = audio_set_output_sample_rate(cmd->sample_rate_hz);
+            APP_LOG_NET_INFO("Quality: %u Hz %s.", (unsigned int)cmd->sample_rate_hz, ok ? "applied" : "unsupported");
+        }
+    }
+    if (cmd->frame_duration_ms != 0) {
+        bool ok = audio_set_frame_duration_ms(cmd->frame_duration_ms);
+        APP_LOG_NET_INFO("Quality: %u ms frames %s.", (unsigned int)cmd->frame_duration_ms, ok ? "applied" : "unsupported");
+    }
+}
+
+// 应用 MQTT 回调收到的控制命令，延迟为从回调收到到应用完成的时间
+static void apply_control_commands(void) {
+    pending_control_t pending;
+    while (xQueueReceive(control_queue, &pending, 0) == pdPASS) {
+        if (control_id_valid && pending.cmd.id == last_control_id) {
+            control_stats.commands_ignored++; // QoS1 重复投递
+            continue;
+        }
+        control_id_valid = true;
+        last_control_id = pending.cmd.id;
+
+        if (pending.cmd.type == SERVER_CONTROL_CMD_CREDIT) {
+            apply_credit_command(&pending.cmd);
+        } else {
+            apply_quality_command(&pending.cmd);
+        }
+        uint32_t latency_ms = (uint32_t)((xTaskGetTickCount() - pending.received_tick) * portTICK_PERIOD_MS);
+        control_stats.commands_applied++;
+        control_stats.latency_ms_last = latency_ms;
+        if (latency_ms > control_stats.latency_ms_max) {
+            control_stats.latency_ms_max = latency_ms;
+        }
+        APP_LOG_NET_INFO("Control command %u (type %u) applied %lu ms after receipt.", (unsigned int)pending.cmd.id,
+                         (unsigned int)pending.cmd.type, (unsigned long)latency_ms);
+    }
+}
+
+// 新连接上服务端可能已不记得此前的流控状态，恢复为不限流，由服务端重新下发
+static void reset_server_control(void) {
+    xQueueReset(control_queue);
+    credit_flow_enabled = false;
+    flow_credits = 0;
+    control_id_valid = false;
+}
+
+void network_get_control_stats(network_control_stats_t *stats) {
+    *stats = control_stats;
+    stats->commands_ignored += control_rejected;
+    stats->credit_flow_enabled = credit_flow_enabled;
+    stats->credits = flow_credits;
+}
+
+static uint32_t now_ms(void) {
+    return (uint32_t)(xTaskGetTickCount() * portTICK_PERIOD_MS);
+}
+
+// 心跳判定链路失效：连接可能已无声断开，keep-alive 要很久才会发现。
+// 立即停止实时通道出队 (帧留在 audio_queue 中，重连后按帧龄转入积压通道补发)，关闭半开的连接并走正常的重连流程。
+static void handle_link_dead(const char *source) {
+    heartbeat_stats_t stats = heartbeat.stats;
+    APP_LOG_NET_ERROR("Link dead (%s; last echo RTT avg %lu ms), reconnecting.", source, (unsigned long)stats.rtt_avg_ms);
+    broker_select_report_failure(&broker_select, active_broker, now_ms()); // 重连时优先考虑其他代理
+    mqtt_server_connected = false;
+    cy_mqtt_disconnect(mqtt_connection_handle);
+    xEventGroupSetBits(network_event_group, MQTT_DISCONNECTED_BIT);
+}
+
+static void service_heartbeat(void) {
+    (void)heartbeat_set_timeout(&heartbeat, requested_heartbeat_timeout_ms);
+#if (MQTT_AUDIO_DATA_CONNECTION == 1)
+    mqtt_stream_set_link_timeout_ms(requested_heartbeat_timeout_ms);
+#endif
+
+    uint8_t echo[HEARTBEAT_PAYLOAD_SIZE];
+    size_t echo_len = 0;
+    TickType_t echo_tick = 0;
+    taskENTER_CRITICAL();
+    if (echo_pending) {
+        memcpy(echo, pending_echo, sizeof(echo));
+        echo_len = pending_echo_len;
+        echo_tick = pending_echo_tick;
+        echo_pending = false;
+    }
+    taskEXIT_CRITICAL();
+    if (echo_len > 0) {
+        heartbeat_on_echo(&heartbeat, echo, echo_len, (uint32_t)(echo_tick * portTICK_PERIOD_MS));
+    }
+
+    if (heartbeat_check_dead(&heartbeat, now_ms())) {
+        APP_LOG_NET_ERROR("No heartbeat echo for %lu ms.", (unsigned long)heartbeat.stats.detection_ms_last);
+        handle_link_dead("control heartbeat");
+        return;
+    }
+
+    uint8_t ping[HEARTBEAT_PAYLOAD_SIZE];
+    if (mqtt_server_connected && heartbeat_poll(&heartbeat, now_ms(), ping) > 0) {
+        cy_mqtt_publish_info_t publish_info = {
+            .qos = CY_MQTT_QOS0,
+            .retain = false,
+            .dup = false,
+            .topic = heartbeat_topic_buffer,
+            .topic_len = (uint16_t)strlen(heartbeat_topic_buffer),
+            .payload = (const char *)ping,
+            .payload_len = sizeof(ping)
+        };
+        (void)cy_mqtt_publish(mqtt_connection_handle, &publish_info); // 发送失败同样表现为收不到回显
+    }
+}
+
+static void service_clock_sync(void) {
+    uint8_t reply[CLOCK_SYNC_MSG_SIZE];
+    size_t reply_len = 0;
+    TickType_t reply_tick = 0;
+    taskENTER_CRITICAL();
+    if (clock_reply_pending) {
+        memcpy(reply, pending_clock_reply, sizeof(reply));
+        reply_len = pending_clock_reply_len;
+        reply_tick = pending_clock_reply_tick;
+        clock_reply_pending = false;
+    }
+    taskEXIT_CRITICAL();
+    if (reply_len > 0) {
+        bool first = !clock_sync.stats.synced;
+        if (clock_sync_on_reply(&clock_sync, reply, reply_len, (uint32_t)(reply_tick * portTICK_PERIOD_MS)) && first) {
+            APP_LOG_NET_INFO("Clock synchronised (offset %lu ms, delay %lu ms).", (unsigned long)clock_sync.stats.offset_ms,
+                             (unsigned long)clock_sync.stats.delay_last_ms);
+        }
+    }
+
+    uint8_t request[CLOCK_SYNC_MSG_SIZE];
+    if (mqtt_server_connected && clock_sync_poll(&clock_sync, now_ms(), request) > 0) {
+        cy_mqtt_publish_info_t publish_info = {
+            .qos = CY_MQTT_QOS0,
+            .retain = false,
+            .dup = false,
+            .topic = clock_topic_buffer,
+            .topic_len = (uint16_t)strlen(clock_topic_buffer),
+            .payload = (const char *)request,
+            .payload_len = sizeof(request)
+        };
+        (void)cy_mqtt_publish(mqtt_connection_handle, &publish_info); // 丢失的请求只少一个样本
+    }
+}
+
+// 发布前把帧时间戳换算为服务端时间，须在加密之前 (帧头是附加认证数据)。
+// 积压帧在补发时才换算，使用的是最新的偏移和漂移估计。
+static void stamp_server_time(audio_data_t *frame) {
+    uint32_t server_ms;
+    if (!(frame->header.flags & AUDIO_FRAME_FLAG_SERVER_TIME) &&
+        clock_sync_to_server(&clock_sync, (uint32_t)(frame->header.timestamp_ms * portTICK_PERIOD_MS), &server_ms)) {
+        frame->header.timestamp_ms = server_ms;
+        frame->header.flags |= AUDIO_FRAME_FLAG_SERVER_TIME;
+    }
+}
+
+void network_get_clock_sync_stats(clock_sync_stats_t *stats) {
+    *stats = clock_sync.stats;
+}
+
+bool network_set_heartbeat_timeout_ms(uint32_t timeout_ms) {
+    if (timeout_ms < HEARTBEAT_MIN_TIMEOUT_MS || timeout_ms > HEARTBEAT_MAX_TIMEOUT_MS) {
+        return false;
+    }
+    requested_heartbeat_timeout_ms = timeout_ms;
+    return true;
+}
+
+void network_get_heartbeat_stats(heartbeat_stats_t *stats) {
+    *stats = heartbeat.stats;
+}
+
+#if (AUDIO_FANOUT_DEPTH > 0)
+static void fanout_retain(void *frame) {
+    audio_retain_frame((audio_data_t *)frame);
+}
+
+static void fanout_release(void *frame) {
+    audio_release_frame((audio_data_t *)frame);
+}
+
+static void ensure_fanout_init(void) {
+    if (!fanout_ready) {
+        frame_fanout_init(&fanout, AUDIO_FANOUT_DEPTH, fanout_retain, fanout_release);
+        fanout_ready = true;
+    }
+}
+
+// 归档副本与音频走同一条数据连接，直接从扇出环持有的帧发出 (见 mqtt_stream_publish_shared())；
+// 没有数据连接时 (TLS) 经 cy_mqtt 发布，负载拷贝到 mqtt_network_buffer。
+// 链路断开时返回 false，帧留在扇出环中，积压满后丢弃最旧的帧。
+static bool archive_sink_write(const audio_data_t *frame, void *context) {
+    (void)context;
+#if (MQTT_AUDIO_DATA_CONNECTION == 1)
+    if (!mqtt_stream_is_connected()) {
+        return false;
+    }
+    cy_rslt_t result = mqtt_stream_publish_shared(frame, archive_topic_buffer);
+    if (result != CY_RSLT_SUCCESS) {
+        APP_LOG_NET_ERROR("Archive publish failed: 0x%08X", (unsigned int)result);
+    }
+#else
+    if (!mqtt_server_connected || !wifi_connected) {
+        return false;
+    }
+    cy_mqtt_publish_info_t publish_info = {
+        .qos = CY_MQTT_QOS0,
+        .topic = archive_topic_buffer,
+        .topic_len = strlen(archive_topic_buffer),
+        .payload = (const char *)&frame->header,
+        .payload_len = audio_frame_payload_len(frame)
+    };
+    cy_rslt_t result = cy_mqtt_publish(mqtt_connection_handle, &publish_info);
+    if (result != CY_RSLT_SUCCESS) {
+        APP_LOG_NET_ERROR("Archive publish failed: 0x%08X", (unsigned int)result);
+    }
+#endif
+    return true; // QoS0，失败不重试
+}
+
+int network_add_frame_sink(network_frame_sink_fn write, void *context, frame_fanout_policy_t policy, uint32_t max_lag) {
+    ensure_fanout_init();
+    int sink = frame_fanout_add_sink(&fanout, policy, max_lag);
+    if (sink >= 0) {
+        frame_sinks[sink].write = write;
+        frame_sinks[sink].context = context;
+    }
+    return sink;
+}
+
+void network_get_frame_sink_stats(int sink, frame_fanout_sink_stats_t *stats) {
+    frame_fanout_get_sink_stats(&fanout, sink, stats);
+}
+
+static void fanout_frame(audio_data_t *frame) {
+    (void)frame_fanout_push(&fanout, frame);
+}
+
+// 每个 sink 每轮最多 AUDIO_FANOUT_SINK_BURST 帧；sink 忙时停在当前帧，不影响其他 sink
+static void service_frame_sinks(void) {
+    for (int sink = 0; sink < FRAME_FANOUT_MAX_SINKS; sink++) {
+        if (frame_sinks[sink].write == NULL) {
+            continue;
+        }
+        for (uint32_t n = 0; n < AUDIO_FANOUT_SINK_BURST; n++) {
+            const audio_data_t *frame = frame_fanout_peek(&fanout, sink);
+            if (frame == NULL || !frame_sinks[sink].write(frame, frame_sinks[sink].context)) {
+                break;
+            }
+            frame_fanout_consume(&fanout, sink);
+        }
+    }
+}
+#else
+int network_add_frame_sink(network_frame_sink_fn write, void *context, frame_fanout_policy_t policy, uint32_t max_lag) {
+    (void)write;
+    (void)context;
+    (void)policy;
+    (void)max_lag;
+    return -1;
+}
+
+void network_get_frame_sink_stats(int sink, frame_fanout_sink_stats_t *stats) {
+    (void)sink;
+    memset(stats, 0, sizeof(*stats));
+}
+
+static void fanout_frame(audio_data_t *frame) {
+    (void)frame;
+}
+
+static void service_frame_sinks(void) {
+}
+#endif
+
+static void note_link_lost(void) {
+    // 连接失败后的重试不会覆盖首次断线的时间
+    if (link_lost_tick == 0) {
+        link_lost_tick = xTaskGetTickCount();
+        if (link_lost_tick == 0) {
+            link_lost_tick = 1;
+        }
+    }
+}
+
+// 记录一次成功连接的耗时 (TCP + TLS 握手 + CONNECT/CONNACK) 和从断线到恢复的时间。
+// heap_3 下 mbedTLS 从 C 库堆分配，mallinfo().arena 为堆的峰值占用 (newlib 不归还已扩展的堆)。
+static void record_connect_time(TickType_t connect_start) {
+    TickType_t now = xTaskGetTickCount();
+    connection_stats.connects++;
+    connection_stats.connect_ms_last = (uint32_t)((now - connect_start) * portTICK_PERIOD_MS);
+    if (connection_stats.connect_ms_last > connection_stats.connect_ms_max) {
+        connection_stats.connect_ms_max = connection_stats.connect_ms_last;
+    }
+    if (link_lost_tick != 0) {
+        connection_stats.reconnect_ms_last = (uint32_t)((now - link_lost_tick) * portTICK_PERIOD_MS);
+        link_lost_tick = 0;
+    }
+    connection_stats.heap_arena_bytes = (uint32_t)mallinfo().arena;
+}
+
+void network_get_connection_stats(network_connection_stats_t *stats) {
+    *stats = connection_stats;
+}
+
+// 让 cy_mqtt 实例绑定到第 index 个代理 (须处于断开状态)
+static cy_rslt_t use_broker(uint32_t index) {
+    if (mqtt_instance_created && index == active_broker) {
+        return CY_RSLT_SUCCESS;
+    }
+    if (mqtt_instance_created) {
+        cy_mqtt_delete(mqtt_connection_handle);
+        mqtt_instance_created = false;
+    }
+
+    broker_info.hostname = broker_addresses[index];
+    broker_info.hostname_len = (uint16_t)strlen(broker_addresses[index]);
+    APP_LOG_NET_INFO("Broker: %s:%u", broker_info.hostname, (unsigned int)broker_info.port);
+    cy_rslt_t result = cy_mqtt_create(mqtt_network_buffer, sizeof(mqtt_network_buffer),
+                                      security_info, &broker_info, MQTT_HANDLE_DESCRIPTOR,
+                                      &mqtt_connection_handle);
+    if (result != CY_RSLT_SUCCESS) {
+        APP_LOG_NET_ERROR("MQTT instance creation failed: 0x%08X", (unsigned int)result);
+        return result;
+    }
+    cy_mqtt_register_event_callback(mqtt_connection_handle, mqtt_event_callback, NULL);
+    mqtt_instance_created = true;
+    active_broker = index;
+    return CY_RSLT_SUCCESS;
+}
+
+void network_get_broker_health(broker_select_t *health) {
+    *health = broker_select;
+}
+
 static cy_rslt_t connect_to_mqtt_broker(void) {
     if (!wifi_connected) {
         APP_LOG_NET_INFO("Wi-Fi not connected, cannot connect to MQTT broker.");
@@ -305,19 +1362,73 @@ static cy_rslt_t connect_to_mqtt_broker(void) {
     }
     if (mqtt_server_connected) return CY_RSLT_SUCCESS;
 
-    APP_LOG_NET_INFO("Connecting to MQTT broker: %s", MQTT_BROKER_ADDRESS);
+    boot_step_begin(BOOT_STEP_BROKER_CONNECT);
     cy_rslt_t result = CY_RSLT_SUCCESS;
 
+    // 每轮按健康分数依次尝试所有代理，失败立即换下一个；整轮都失败后才等待重试
     for (int retries = 0; retries < 3; retries++) { // 有限重试次数
-        result = cy_mqtt_connect(mqtt_connection_handle, &connection_info);
-        if (result == CY_RSLT_SUCCESS) {
-            APP_LOG_NET_INFO("Successfully connected to MQTT Broker.");
-            mqtt_server_connected = true;
-            report_server_connected_event();
-            xEventGroupSetBits(network_event_group, MQTT_CONNECTED_BIT);
-            return CY_RSLT_SUCCESS;
+        uint32_t order[BROKER_SELECT_MAX_ENDPOINTS];
+        uint32_t count = broker_select_rank(&broker_select, now_ms(), order);
+        for (uint32_t i = 0; i < count; i++) {
+            uint32_t index = order[i];
+            APP_LOG_NET_INFO("Connecting to MQTT broker: %s (score %lu)", broker_addresses[index],
+                             (unsigned long)broker_select_score(&broker_select, index, now_ms()));
+            TickType_t connect_start = xTaskGetTickCount();
+            result = use_broker(index);
+            if (result == CY_RSLT_SUCCESS) {
+                result = cy_mqtt_connect(mqtt_connection_handle, &connection_info);
+            }
+            if (result == CY_RSLT_SUCCESS) {
+                record_connect_time(connect_start);
+                broker_select_report_success(&broker_select, index, connection_stats.connect_ms_last, now_ms());
+                connection_stats.active_broker = index;
+                if (broker_ever_connected && index != last_connected_broker) {
+                    // 帧序号由音频任务连续分配，断线期间的帧在积压通道中补发到新代理
+                    connection_stats.broker_switches++;
+                    connection_stats.switchover_ms_last = connection_stats.reconnect_ms_last;
+                }
+                broker_ever_connected = true;
+                last_connected_broker = index;
+#if (WIFI_FAST_RECONNECT == 1)
+                wifi_static_ip_unverified = false;
+#endif
+                APP_LOG_NET_INFO("Successfully connected to MQTT Broker in %lu ms (heap arena %lu bytes).",
+                                 (unsigned long)connection_stats.connect_ms_last, (unsigned long)connection_stats.heap_arena_bytes);
+                mqtt_server_connected = true;
+#if (AUDIO_TRANSPORT == AUDIO_TRANSPORT_UDP)
+                subscribe_topic(feedback_topic_buffer, CY_MQTT_QOS0);
+#endif
+                subscribe_topic(heartbeat_echo_topic_buffer, CY_MQTT_QOS0);
+                reset_server_control();
+                subscribe_topic(control_topic_buffer, CY_MQTT_QOS1); // 信用命令丢失会使设备停止发送，需要确认投递
+                heartbeat_start(&heartbeat, now_ms());
+                subscribe_topic(clock_reply_topic_buffer, CY_MQTT_QOS0);
+                clock_sync_start(&clock_sync);
+                boot_step_end(BOOT_STEP_BROKER_CONNECT);
+                report_server_connected_event();
+                xEventGroupSetBits(network_event_group, MQTT_CONNECTED_BIT);
+                return CY_RSLT_SUCCESS;
+            }
+            broker_select_report_failure(&broker_select, index, now_ms());
+            APP_LOG_NET_ERROR("MQTT connection to %s failed: 0x%08X", broker_addresses[index], (unsigned int)result);
         }
-        APP_LOG_NET_ERROR("MQTT connection failed (attempt %d): 0x%08X. Retrying in 3s...", retries + 1, (unsigned int)result);
+#if (WIFI_FAST_RECONNECT == 1)
+        if (wifi_static_ip_unverified) {
+            // 复用的租约可能已被收回 (地址冲突或网段变化)：丢弃租约，重新关联并走 DHCP，不等待
+            APP_LOG_NET_ERROR("No broker reachable with cached IP lease, renewing via DHCP.");
+            wifi_static_ip_unverified = false;
+            if (wifi_cache_drop_lease(&wifi_cache)) {
+                store_wifi_cache();
+            }
+            cy_wcm_disconnect_ap();
+            wifi_connected = false;
+            if (connect_to_wifi() != CY_RSLT_SUCCESS) {
+                return CY_RSLT_MODULE_WCM_BASE;
+            }
+            continue;
+        }
+#endif
+        APP_LOG_NET_ERROR("All brokers failed (attempt %d). Retrying in 3s...", retries + 1);
         vTaskDelay(pdMS_TO_TICKS(3000));
     }
 
@@ -353,10 +1464,52 @@ static void mqtt_event_callback(cy_mqtt_t mqtt_handle, cy_mqtt_event_t event, vo
         // 根据文档使用 CY_MQTT_EVENT_TYPE_SUBSCRIPTION_MESSAGE_RECEIVE
         case CY_MQTT_EVENT_TYPE_SUBSCRIPTION_MESSAGE_RECEIVE: 
             // 根据 cy_mqtt_api.h (v4.6.1) 的定义，通过 event.data.pub_msg.received_message 访问接收到的消息信息
+            // 心跳回显每秒数次，不记录日志；只保留最新的一个，收到的节拍用于计算往返时间
+            if (topic_matches(&event.data.pub_msg.received_message, heartbeat_echo_topic_buffer)) {
+                size_t len = event.data.pub_msg.received_message.payload_len;
+                taskENTER_CRITICAL();
+                memcpy(pending_echo, event.data.pub_msg.received_message.payload,
+                       (len < sizeof(pending_echo)) ? len : sizeof(pending_echo));
+                pending_echo_len = len;
+                pending_echo_tick = xTaskGetTickCount();
+                echo_pending = true;
+                taskEXIT_CRITICAL();
+                break;
+            }
+            if (topic_matches(&event.data.pub_msg.received_message, clock_reply_topic_buffer)) {
+                size_t len = event.data.pub_msg.received_message.payload_len;
+                taskENTER_CRITICAL();
+                memcpy(pending_clock_reply, event.data.pub_msg.received_message.payload,
+                       (len < sizeof(pending_clock_reply)) ? len : sizeof(pending_clock_reply));
+                pending_clock_reply_len = len;
+                pending_clock_reply_tick = xTaskGetTickCount(); // t4 尽量靠近实际收到的时间
+                clock_reply_pending = true;
+                taskEXIT_CRITICAL();
+                break;
+            }
             APP_LOG_NET_INFO("MQTT Event: Publish message received on topic '%.*s'", 
                              (int)event.data.pub_msg.received_message.topic_len, 
                              (const char*)event.data.pub_msg.received_message.topic);
             // 如果订阅了任何主题，则处理传入消息
+            if (topic_matches(&event.data.pub_msg.received_message, control_topic_buffer)) {
+                pending_control_t pending = { .received_tick = xTaskGetTickCount() };
+                if (!server_control_parse((const uint8_t *)event.data.pub_msg.received_message.payload,
+                                          event.data.pub_msg.received_message.payload_len, &pending.cmd)) {
+                    APP_LOG_NET_ERROR("Malformed control command ignored.");
+                    control_rejected++;
+                } else if (xQueueSend(control_queue, &pending, 0) != pdPASS) {
+                    APP_LOG_NET_ERROR("Control queue full, command %u dropped.", (unsigned int)pending.cmd.id);
+                    control_rejected++;
+                } else {
+                    xEventGroupSetBits(network_event_group, CONTROL_COMMAND_BIT); // 立即唤醒网络任务应用
+                }
+            }
+#if (AUDIO_TRANSPORT == AUDIO_TRANSPORT_UDP)
+            if (topic_matches(&event.data.pub_msg.received_message, feedback_topic_buffer)) {
+                udp_stream_handle_feedback((const uint8_t *)event.data.pub_msg.received_message.payload,
+                                           event.data.pub_msg.received_message.payload_len);
+            }
+#endif
             break;
         // 在提供的文档的事件类型中没有明确的 PUBACK 事件。
         // PINGRESP 是列出的另一种事件类型，但当前未处理。
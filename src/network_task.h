@@ -4,6 +4,14 @@
 #include "FreeRTOS.h"
 #include "queue.h"
 #include "state_machine.h" // 用于报告网络事件
+#include "heartbeat.h"
+#include "broker_select.h"
+#include "server_control.h"
+#include "frame_fanout.h"
+#include "clock_sync.h"
+#include "audio_task.h"
+#include <stdint.h>
+#include <stdbool.h>
 
 // 网络任务的命令枚举 (如果需要，例如从状态机发送)
 // typedef enum {
@@ -21,4 +29,80 @@ void network_task(void *pvParameters);
 void network_notify_wifi_lost(void); // 当状态机进入 WIFI_DISCONNECTED 状态时调用
 void network_notify_server_lost(void); // 当状态机进入 SERVER_DISCONNECTED 状态时调用
 
+// 运行时选择实时通道 (QoS0 或 UDP) 的 FEC 组大小：每 group_size 帧发送一个 XOR 校验包 (开销 1/group_size)，0 表示关闭。
+// 可取 0 或 FEC_MIN_GROUP_SIZE ~ FEC_MAX_GROUP_SIZE，从下一组开始生效。实时帧经 QoS1 发布时只接受 0。
+bool network_set_fec_group_size(uint32_t group_size);
+uint32_t network_get_fec_group_size(void);
+
+// 实时/积压两级调度统计
+typedef struct {
+    uint32_t live_published;        // 实时通道发布的帧数
+    uint32_t live_latency_max_ms;   // 实时帧从采集完成到发布的最大延迟
+    uint32_t backlog_published;     // 补发到 MQTT_TOPIC_AUDIO_BACKLOG 的帧数
+    uint32_t backlog_dropped;       // 积压通道满或超过 AUDIO_BACKLOG_MAX_AGE_MS 而丢弃的帧数
+    uint32_t backlog_depth;         // 当前积压帧数
+    uint32_t last_catchup_ms;       // 最近一次积压从出现到补发完的耗时
+    uint32_t publish_cycles_last;   // 最近一次实时帧发布的 CPU 周期数 (DWT，含套接字发送)
+    uint32_t publish_cycles_max;
+    uint32_t seal_cycles_last;      // 最近一帧原地加密的 CPU 周期数 (AUDIO_PAYLOAD_ENCRYPTION 启用时)
+    uint32_t seal_cycles_max;
+    uint32_t seal_failures;         // 加密失败而丢弃的帧数
+} network_scheduler_stats_t;
+
+// 积压补发可使用的剩余带宽百分比 (0 ~ 100，0 表示不补发)
+bool network_set_backlog_share_pct(uint32_t share_pct);
+void network_get_scheduler_stats(network_scheduler_stats_t *stats);
+
+// 控制连接的建立耗时统计，用于评估 TLS 握手和 mbedTLS 配置的开销
+typedef struct {
+    uint32_t connects;              // 成功连接次数
+    uint32_t connect_ms_last;       // 最近一次 cy_mqtt_connect() 的耗时 (TCP + TLS 握手 + CONNECT)
+    uint32_t connect_ms_max;
+    uint32_t reconnect_ms_last;     // 最近一次从检测到断线到重新连上的时间
+    uint32_t heap_arena_bytes;      // 连接后 C 库堆的峰值占用 (mbedTLS 从这里分配)
+    uint32_t active_broker;         // 当前代理在 MQTT_BROKER_LIST 中的下标
+    uint32_t broker_switches;       // 重连到与上次不同的代理的次数
+    uint32_t switchover_ms_last;    // 最近一次切换代理时从检测到断线到连上新代理的时间
+    uint32_t wifi_connect_ms_last;  // 最近一次 Wi-Fi 关联的耗时 (含直接关联失败后的扫描和 DHCP)
+    uint32_t wifi_directed_connects;    // 用缓存的 BSSID 直接关联成功的次数 (WIFI_FAST_RECONNECT)
+    uint32_t wifi_directed_failures;    // 直接关联失败、回退到扫描的次数
+    uint32_t wifi_scan_connects;    // 扫描后关联成功的次数
+} network_connection_stats_t;
+
+void network_get_connection_stats(network_connection_stats_t *stats);
+
+// 读取各代理健康分数的快照 (见 broker_select.h)
+void network_get_broker_health(broker_select_t *health);
+
+// 心跳失效判定时间 (HEARTBEAT_MIN_TIMEOUT_MS ~ HEARTBEAT_MAX_TIMEOUT_MS)，在网络任务中应用。不受支持时返回 false。
+bool network_set_heartbeat_timeout_ms(uint32_t timeout_ms);
+void network_get_heartbeat_stats(heartbeat_stats_t *stats);
+
+// 服务端控制命令 (见 server_control.h) 的应用统计
+typedef struct {
+    uint32_t commands_applied;
+    uint32_t commands_ignored;      // 格式错误、QoS1 重复投递或 control_queue 已满
+    uint32_t credit_stalls;         // 信用用完、暂停出队的次数
+    uint32_t latency_ms_last;       // 从 MQTT 回调收到到命令应用完成的时间
+    uint32_t latency_ms_max;
+    bool credit_flow_enabled;
+    uint32_t credits;               // 剩余信用 (帧)
+} network_control_stats_t;
+
+void network_get_control_stats(network_control_stats_t *stats);
+
+// 时钟同步状态：偏移、漂移 (ppb) 和交换延迟
+void network_get_clock_sync_stats(clock_sync_stats_t *stats);
+
+// 扇出 sink (AUDIO_FANOUT_DEPTH > 0 时可用)：实时和积压通道发布的每一帧按发布顺序交给 write，帧已加密 (启用时)，
+// 只读且不得使用 transport_headroom (内置归档 sink 经 mqtt_stream_publish_shared() 使用)，返回后不得再引用。返回 false 表示暂时忙，该帧下一轮重试；
+// 积压超过 max_lag (1 ~ AUDIO_FANOUT_DEPTH) 帧时按 policy 只丢自己的帧，不影响实时通道和其他 sink。
+// write 在网络任务中调用，不得长时间阻塞。
+typedef bool (*network_frame_sink_fn)(const audio_data_t *frame, void *context);
+
+// 扇出状态只由网络任务访问：须在启动调度器之前或在网络任务中调用 (内置归档 sink 在网络任务开始时注册)。
+// 成功返回 sink 编号，不支持或已满时返回 -1。
+int network_add_frame_sink(network_frame_sink_fn write, void *context, frame_fanout_policy_t policy, uint32_t max_lag);
+void network_get_frame_sink_stats(int sink, frame_fanout_sink_stats_t *stats);
+
 #endif /* NETWORK_TASK_H_ */ 
\ No newline at end of file
@@ -0,0 +1,122 @@
+#include "payload_crypto.h"
+#include <string.h>
+
+// 帧头字段偏移 (见 audio_task.h 中的 audio_frame_header_t)
+#define HEADER_FLAGS_OFFSET     (1)
+#define HEADER_SEQUENCE_OFFSET  (8)
+
+static void build_nonce(uint8_t nonce[PAYLOAD_CRYPTO_NONCE_SIZE], const uint8_t *salt, const uint8_t *packet) {
+    memcpy(nonce, salt, PAYLOAD_CRYPTO_SALT_SIZE);
+    memcpy(&nonce[PAYLOAD_CRYPTO_SALT_SIZE], &packet[HEADER_SEQUENCE_OFFSET], 4);
+}
+
+bool payload_crypto_init(payload_crypto_t *ctx, uint8_t cipher, const uint8_t key[PAYLOAD_CRYPTO_KEY_SIZE],
+                         const uint8_t salt[PAYLOAD_CRYPTO_SALT_SIZE]) {
+    memset(ctx, 0, sizeof(*ctx));
+    if (salt != NULL) {
+        memcpy(ctx->salt, salt, PAYLOAD_CRYPTO_SALT_SIZE);
+    }
+
+    if (cipher == PAYLOAD_CRYPTO_CIPHER_AES_GCM) {
+        mbedtls_gcm_init(&ctx->gcm);
+        if (mbedtls_gcm_setkey(&ctx->gcm, MBEDTLS_CIPHER_ID_AES, key, PAYLOAD_CRYPTO_KEY_SIZE * 8) != 0) {
+            mbedtls_gcm_free(&ctx->gcm);
+            return false;
+        }
+        ctx->cipher = cipher;
+        return true;
+    }
+#if defined(MBEDTLS_CHACHAPOLY_C)
+    if (cipher == PAYLOAD_CRYPTO_CIPHER_CHACHAPOLY) {
+        mbedtls_chachapoly_init(&ctx->chachapoly);
+        if (mbedtls_chachapoly_setkey(&ctx->chachapoly, key) != 0) {
+            mbedtls_chachapoly_free(&ctx->chachapoly);
+            return false;
+        }
+        ctx->cipher = cipher;
+        return true;
+    }
+#endif
+    return false;
+}
+
+void payload_crypto_free(payload_crypto_t *ctx) {
+    if (ctx->cipher == PAYLOAD_CRYPTO_CIPHER_AES_GCM) {
+        mbedtls_gcm_free(&ctx->gcm);
+    }
+#if defined(MBEDTLS_CHACHAPOLY_C)
+    if (ctx->cipher == PAYLOAD_CRYPTO_CIPHER_CHACHAPOLY) {
+        mbedtls_chachapoly_free(&ctx->chachapoly);
+    }
+#endif
+    ctx->cipher = 0;
+}
+
+size_t payload_crypto_seal(payload_crypto_t *ctx, uint8_t *packet, size_t packet_len, size_t capacity) {
+    if (ctx->cipher == 0 || packet_len < PAYLOAD_CRYPTO_HEADER_SIZE ||
+        capacity < packet_len + PAYLOAD_CRYPTO_TRAILER_SIZE ||
+        (packet[HEADER_FLAGS_OFFSET] & PAYLOAD_CRYPTO_FLAG) != 0) {
+        return 0;
+    }
+
+    uint8_t nonce[PAYLOAD_CRYPTO_NONCE_SIZE];
+    build_nonce(nonce, ctx->salt, packet);
+    uint8_t *payload = &packet[PAYLOAD_CRYPTO_HEADER_SIZE];
+    size_t payload_len = packet_len - PAYLOAD_CRYPTO_HEADER_SIZE;
+    uint8_t *trailer = &packet[packet_len];
+    uint8_t *tag = &trailer[PAYLOAD_CRYPTO_SALT_SIZE];
+
+    // 标志是认证数据的一部分，须在加密前置位
+    packet[HEADER_FLAGS_OFFSET] |= PAYLOAD_CRYPTO_FLAG;
+    int ret = -1;
+    if (ctx->cipher == PAYLOAD_CRYPTO_CIPHER_AES_GCM) {
+        ret = mbedtls_gcm_crypt_and_tag(&ctx->gcm, MBEDTLS_GCM_ENCRYPT, payload_len, nonce, sizeof(nonce),
+                                        packet, PAYLOAD_CRYPTO_HEADER_SIZE, payload, payload,
+                                        PAYLOAD_CRYPTO_TAG_SIZE, tag);
+    }
+#if defined(MBEDTLS_CHACHAPOLY_C)
+    if (ctx->cipher == PAYLOAD_CRYPTO_CIPHER_CHACHAPOLY) {
+        ret = mbedtls_chachapoly_encrypt_and_tag(&ctx->chachapoly, payload_len, nonce,
+                                                 packet, PAYLOAD_CRYPTO_HEADER_SIZE, payload, payload, tag);
+    }
+#endif
+    if (ret != 0) {
+        // 两种算法都在处理数据前检查参数，失败时负载未被修改
+        packet[HEADER_FLAGS_OFFSET] &= (uint8_t)~PAYLOAD_CRYPTO_FLAG;
+        return 0;
+    }
+    memcpy(trailer, ctx->salt, PAYLOAD_CRYPTO_SALT_SIZE);
+    return packet_len + PAYLOAD_CRYPTO_TRAILER_SIZE;
+}
+
+size_t payload_crypto_open(payload_crypto_t *ctx, uint8_t *packet, size_t packet_len) {
+    if (ctx->cipher == 0 || packet_len < PAYLOAD_CRYPTO_HEADER_SIZE + PAYLOAD_CRYPTO_TRAILER_SIZE ||
+        (packet[HEADER_FLAGS_OFFSET] & PAYLOAD_CRYPTO_FLAG) == 0) {
+        return 0;
+    }
+
+    size_t plain_len = packet_len - PAYLOAD_CRYPTO_TRAILER_SIZE;
+    const uint8_t *trailer = &packet[plain_len];
+    const uint8_t *tag = &trailer[PAYLOAD_CRYPTO_SALT_SIZE];
+    uint8_t nonce[PAYLOAD_CRYPTO_NONCE_SIZE];
+    build_nonce(nonce, trailer, packet);
+    uint8_t *payload = &packet[PAYLOAD_CRYPTO_HEADER_SIZE];
+    size_t payload_len = plain_len - PAYLOAD_CRYPTO_HEADER_SIZE;
+
+    int ret = -1;
+    if (ctx->cipher == PAYLOAD_CRYPTO_CIPHER_AES_GCM) {
+        ret = mbedtls_gcm_auth_decrypt(&ctx->gcm, payload_len, nonce, sizeof(nonce), packet, PAYLOAD_CRYPTO_HEADER_SIZE,
+                                       tag, PAYLOAD_CRYPTO_TAG_SIZE, payload, payload);
+    }
+#if defined(MBEDTLS_CHACHAPOLY_C)
+    if (ctx->cipher == PAYLOAD_CRYPTO_CIPHER_CHACHAPOLY) {
+        ret = mbedtls_chachapoly_auth_decrypt(&ctx->chachapoly, payload_len, nonce, packet, PAYLOAD_CRYPTO_HEADER_SIZE,
+                                              tag, payload, payload);
+    }
+#endif
+    if (ret != 0) {
+        return 0;   // 认证失败时 mbedTLS 已清零输出，该帧只能丢弃
+    }
+    packet[HEADER_FLAGS_OFFSET] &= (uint8_t)~PAYLOAD_CRYPTO_FLAG;
+    return plain_len;
+}
@@ -0,0 +1,60 @@
+#ifndef PAYLOAD_CRYPTO_H_
+#define PAYLOAD_CRYPTO_H_
+
+#include "mbedtls/gcm.h"
+#if defined(MBEDTLS_CHACHAPOLY_C)
+#include "mbedtls/chachapoly.h"
+#endif
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+// 应用层逐帧 AEAD：不使用 TLS 时为音频帧提供机密性和完整性，开销只有每帧一次 AEAD 和 PAYLOAD_CRYPTO_TRAILER_SIZE 字节。
+// 与 fec.h 一样只依赖 16 字节帧头的字节布局 (见 audio_task.h)，不依赖 RTOS，接收端可直接复用 payload_crypto_open()。
+//
+// 加密后的帧 (小端)：
+//   帧头 (明文，flags 中置 PAYLOAD_CRYPTO_FLAG，整个帧头作为附加认证数据)
+//   负载 (原地加密，长度不变)
+//   尾部：salt (PAYLOAD_CRYPTO_SALT_SIZE 字节) | 认证标签 (PAYLOAD_CRYPTO_TAG_SIZE 字节)
+// nonce (12 字节) = salt | 帧头中的 sequence (4 字节小端)。salt 在每次启动时随机生成，
+// 同一密钥下帧序号在一次启动内不重复，因此 nonce 不重复。
+// 认证不防重放：重复的帧同样能通过 payload_crypto_open()，接收端须按序号丢弃重复的帧 (tools/host/receiver.c 即如此)。
+// FEC 校验包不加密：它是已加密帧 (含标签) 的异或，恢复出的帧同样要通过 payload_crypto_open() 的认证。
+
+#define PAYLOAD_CRYPTO_CIPHER_AES_GCM     (1)   // AES-256-GCM，使用硬件 AES 加速
+#define PAYLOAD_CRYPTO_CIPHER_CHACHAPOLY  (2)   // ChaCha20-Poly1305，须在 mbedtls_user_config.h 中启用 MBEDTLS_CHACHAPOLY_C
+
+#define PAYLOAD_CRYPTO_FLAG               (1u << 3) // 帧头 flags：负载已加密，帧尾带 PAYLOAD_CRYPTO_TRAILER_SIZE 字节
+#define PAYLOAD_CRYPTO_HEADER_SIZE        (16)
+#define PAYLOAD_CRYPTO_KEY_SIZE           (32)
+#define PAYLOAD_CRYPTO_SALT_SIZE          (8)
+#define PAYLOAD_CRYPTO_NONCE_SIZE         (12)
+#define PAYLOAD_CRYPTO_TAG_SIZE           (16)
+#define PAYLOAD_CRYPTO_TRAILER_SIZE       (PAYLOAD_CRYPTO_SALT_SIZE + PAYLOAD_CRYPTO_TAG_SIZE)
+
+typedef struct {
+    uint8_t cipher;                             // PAYLOAD_CRYPTO_CIPHER_*
+    uint8_t salt[PAYLOAD_CRYPTO_SALT_SIZE];     // 发送端的 nonce 前缀
+    union {
+        mbedtls_gcm_context gcm;
+#if defined(MBEDTLS_CHACHAPOLY_C)
+        mbedtls_chachapoly_context chachapoly;
+#endif
+    };
+} payload_crypto_t;
+
+// 设置密钥和发送端 salt (接收端可传 NULL，salt 从每帧尾部读取)。不支持的算法或密钥设置失败时返回 false。
+bool payload_crypto_init(payload_crypto_t *ctx, uint8_t cipher, const uint8_t key[PAYLOAD_CRYPTO_KEY_SIZE],
+                         const uint8_t salt[PAYLOAD_CRYPTO_SALT_SIZE]);
+
+void payload_crypto_free(payload_crypto_t *ctx);
+
+// 原地加密 packet (帧头 + 负载)：置位加密标志，加密负载，在负载后写入尾部。
+// packet 之后须有 PAYLOAD_CRYPTO_TRAILER_SIZE 字节可写 (capacity 为 packet 起的可用字节数)。
+// 返回加密后的长度，已加密、空间不足或失败时返回 0 且不修改 packet。
+size_t payload_crypto_seal(payload_crypto_t *ctx, uint8_t *packet, size_t packet_len, size_t capacity);
+
+// 接收端：验证并原地解密，清除加密标志。返回帧头 + 明文负载的长度，未加密、格式错误或认证失败时返回 0。
+size_t payload_crypto_open(payload_crypto_t *ctx, uint8_t *packet, size_t packet_len);
+
+#endif /* PAYLOAD_CRYPTO_H_ */
@@ -0,0 +1,210 @@
+#include "rate_control.h"
+#include "audio_task.h"
+#include "app_config.h"
+#include "task.h"
+#include "queue.h"
+#include <stdio.h> // 用于 printf，替换为适当的日志记录
+
+#define APP_LOG_RATE_INFO(format, ...) printf("[RATE] " format "\n", ##__VA_ARGS__)
+
+static volatile bool rate_control_enabled = (AUDIO_RATE_CONTROL == 1);
+static volatile bool tier_reset_requested = true;   // 下一次更新时切换到最高档
+
+static rate_control_stats_t rc_stats;
+static rate_tier_t current_tier = RATE_TIER_PCM_FULL;
+
+// 当前测量周期
+static TickType_t interval_start = 0;
+static uint64_t interval_bytes = 0;
+static TickType_t interval_busy = 0;
+static uint32_t interval_loss_pct = 0;
+static uint32_t previous_depth = 0;
+
+// 升档控制
+static TickType_t upgrade_candidate_since = 0;      // 满足升档条件的起始时间，0 表示当前不满足
+static TickType_t last_upgrade_tick = 0;
+static bool upgraded_recently = false;
+static uint32_t upgrade_hold_ms = RATE_CONTROL_UPGRADE_HOLD_MS;
+static bool settling = false;                       // 刚切换档位：队列中仍是旧档位的帧，下一个周期不做决定
+
+// 档位的上行码率 (含帧头)，按当前帧长计算
+static uint32_t tier_bitrate(rate_tier_t tier) {
+    uint32_t frame_ms = audio_get_frame_duration_ms();
+    uint32_t payload;
+    if (tier == RATE_TIER_FEATURES) {
+        payload = (frame_ms / LOG_MEL_HOP_MS) * LOG_MEL_BANDS;
+    } else {
+        uint32_t rate = (tier == RATE_TIER_PCM_FULL) ? AUDIO_MAX_OUTPUT_SAMPLE_RATE : AUDIO_RATE_CONTROL_REDUCED_SAMPLE_RATE;
+        payload = rate * frame_ms / 1000u * AUDIO_CHANNELS * (AUDIO_BIT_RESOLUTION / 8);
+    }
+    return (uint32_t)(((uint64_t)sizeof(audio_frame_header_t) + payload) * 8u * 1000u / frame_ms);
+}
+
+static void apply_tier(rate_tier_t tier) {
+    if (tier == RATE_TIER_FEATURES) {
+        (void)audio_set_output_sample_rate(AUDIO_MAX_OUTPUT_SAMPLE_RATE);
+        (void)audio_set_stream_format(AUDIO_FRAME_FORMAT_LOGMEL_U8);
+    } else {
+        (void)audio_set_stream_format(AUDIO_FRAME_FORMAT_PCM_S16LE);
+        (void)audio_set_output_sample_rate((tier == RATE_TIER_PCM_FULL) ? AUDIO_MAX_OUTPUT_SAMPLE_RATE
+                                                                       : AUDIO_RATE_CONTROL_REDUCED_SAMPLE_RATE);
+    }
+    current_tier = tier;
+    settling = true;
+    rc_stats.tier = tier;
+    rc_stats.tier_bps = tier_bitrate(tier);
+}
+
+void rate_control_init(void) {
+    rc_stats = (rate_control_stats_t){0};
+    current_tier = RATE_TIER_PCM_FULL;
+    rc_stats.tier_bps = tier_bitrate(current_tier);
+    upgrade_hold_ms = RATE_CONTROL_UPGRADE_HOLD_MS;
+    upgraded_recently = false;
+    upgrade_candidate_since = 0;
+    settling = false;
+    tier_reset_requested = true;
+    rate_control_restart_interval();
+}
+
+void rate_control_set_enabled(bool enable) {
+    if (enable && !rate_control_enabled) {
+        tier_reset_requested = true;
+    }
+    rate_control_enabled = enable;
+    APP_LOG_RATE_INFO("Rate control %s.", enable ? "enabled" : "disabled");
+}
+
+bool rate_control_is_enabled(void) {
+    return rate_control_enabled;
+}
+
+void rate_control_on_publish(size_t bytes, TickType_t elapsed) {
+    interval_bytes += bytes;
+    interval_busy += elapsed;
+}
+
+void rate_control_report_loss(uint32_t loss_pct) {
+    if (loss_pct > interval_loss_pct) {
+        interval_loss_pct = loss_pct;
+    }
+}
+
+void rate_control_restart_interval(void) {
+    interval_start = xTaskGetTickCount();
+    interval_bytes = 0;
+    interval_busy = 0;
+    interval_loss_pct = 0;
+    previous_depth = (audio_queue != NULL) ? (uint32_t)uxQueueMessagesWaiting(audio_queue) : 0;
+    upgrade_candidate_since = 0;
+}
+
+// 根据本周期的测量更新带宽估计，返回是否拥塞
+static bool update_estimate(uint32_t interval_ms, uint32_t depth, uint32_t backlog_pct) {
+    uint32_t delivered = (uint32_t)(interval_bytes * 8u * 1000u / interval_ms);
+    uint32_t busy_ms = (uint32_t)(interval_busy * portTICK_PERIOD_MS);
+
+    // 发布耗时对应的发送速率即链路排空速率；几乎不阻塞时测不出上限，按实际速率的倍数封顶
+    uint32_t reference = (delivered > rc_stats.tier_bps) ? delivered : rc_stats.tier_bps;
+    uint64_t cap = (uint64_t)reference * RATE_CONTROL_ESTIMATE_CAP_FACTOR;
+    uint64_t sample = (busy_ms > 0) ? interval_bytes * 8u * 1000u / busy_ms : cap;
+    if (sample > cap) {
+        sample = cap;
+    }
+
+    // 队列持续增长、发送窗口接近满或接收端丢包：实际发出的速率就是链路能承受的上限
+    bool congested = (depth >= previous_depth + RATE_CONTROL_QUEUE_GROWTH_FRAMES) ||
+                     (backlog_pct >= RATE_CONTROL_BACKLOG_PCT) || (interval_loss_pct >= RATE_CONTROL_LOSS_PCT);
+    if (congested && sample > delivered) {
+        sample = delivered;
+    }
+    // 丢掉的部分并没有送达
+    if (interval_loss_pct > 0 && interval_loss_pct <= 100u) {
+        sample = sample * (100u - interval_loss_pct) / 100u;
+    }
+
+    // 下降立即跟随，上升按 1/4 平滑
+    if (rc_stats.estimate_bps == 0 || sample < rc_stats.estimate_bps) {
+        rc_stats.estimate_bps = (uint32_t)sample;
+    } else {
+        rc_stats.estimate_bps = (uint32_t)((3u * (uint64_t)rc_stats.estimate_bps + sample) / 4u);
+    }
+    rc_stats.delivered_bps = delivered;
+    rc_stats.queue_depth = depth;
+    return congested;
+}
+
+void rate_control_update(uint32_t backlog_pct) {
+    TickType_t now = xTaskGetTickCount();
+    uint32_t interval_ms = (uint32_t)((now - interval_start) * portTICK_PERIOD_MS);
+    if (interval_ms < RATE_CONTROL_INTERVAL_MS) {
+        return;
+    }
+
+    uint32_t depth = (audio_queue != NULL) ? (uint32_t)uxQueueMessagesWaiting(audio_queue) : 0;
+    rc_stats.tier_bps = tier_bitrate(current_tier);     // 帧长可能在运行时改变
+    bool congested = update_estimate(interval_ms, depth, backlog_pct);
+    interval_start = now;
+    interval_bytes = 0;
+    interval_busy = 0;
+    interval_loss_pct = 0;
+    previous_depth = depth;
+
+    if (!rate_control_enabled) {
+        return;
+    }
+    if (tier_reset_requested) {
+        tier_reset_requested = false;
+        apply_tier(RATE_TIER_PCM_FULL);
+        return;
+    }
+    if (settling) {
+        settling = false;
+        return;
+    }
+
+    // 升档后 RATE_CONTROL_UPGRADE_STABLE_MS 内未降档，说明新档位稳定，恢复基础等待时间。
+    // 升档失败在切换后两三个周期内就表现为阻塞或队列增长；按等待上限判断稳定会使长时间拥塞后恢复的每一级都等满上限。
+    if (upgraded_recently && (now - last_upgrade_tick) >= pdMS_TO_TICKS(RATE_CONTROL_UPGRADE_STABLE_MS)) {
+        upgraded_recently = false;
+        upgrade_hold_ms = RATE_CONTROL_UPGRADE_HOLD_MS;
+    }
+
+    bool insufficient = (uint64_t)rc_stats.estimate_bps * 100u < (uint64_t)rc_stats.tier_bps * RATE_CONTROL_DOWNGRADE_MARGIN_PCT;
+    if ((congested || insufficient) && current_tier + 1 < RATE_TIER_COUNT) {
+        if (upgraded_recently) {
+            // 刚升档就撑不住：加倍下一次升档前的等待
+            upgrade_hold_ms = (upgrade_hold_ms * 2u > RATE_CONTROL_UPGRADE_HOLD_MAX_MS) ? RATE_CONTROL_UPGRADE_HOLD_MAX_MS
+                                                                                       : upgrade_hold_ms * 2u;
+            upgraded_recently = false;
+        }
+        apply_tier((rate_tier_t)(current_tier + 1));
+        rc_stats.downgrades++;
+        upgrade_candidate_since = 0;
+        APP_LOG_RATE_INFO("Downgrade to tier %d (estimate %lu bps, delivered %lu bps, queue %lu).", (int)current_tier,
+                          (unsigned long)rc_stats.estimate_bps, (unsigned long)rc_stats.delivered_bps, (unsigned long)depth);
+        return;
+    }
+
+    bool headroom = current_tier > RATE_TIER_PCM_FULL && !congested && depth <= RATE_CONTROL_IDLE_QUEUE_FRAMES &&
+                    (uint64_t)rc_stats.estimate_bps * 100u >=
+                        (uint64_t)tier_bitrate((rate_tier_t)(current_tier - 1)) * RATE_CONTROL_UPGRADE_MARGIN_PCT;
+    if (!headroom) {
+        upgrade_candidate_since = 0;
+        return;
+    }
+    if (upgrade_candidate_since == 0) {
+        upgrade_candidate_since = now;
+    } else if ((now - upgrade_candidate_since) >= pdMS_TO_TICKS(upgrade_hold_ms)) {
+        apply_tier((rate_tier_t)(current_tier - 1));
+        rc_stats.upgrades++;
+        upgrade_candidate_since = 0;
+        last_upgrade_tick = now;
+        upgraded_recently = true;
+        APP_LOG_RATE_INFO("Upgrade to tier %d (estimate %lu bps).", (int)current_tier, (unsigned long)rc_stats.estimate_bps);
+    }
+}
+
+void rate_control_get_stats(rate_control_stats_t *stats) {
+    *stats = rc_stats;
+}
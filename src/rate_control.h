@@ -0,0 +1,68 @@
+#ifndef RATE_CONTROL_H_
+#define RATE_CONTROL_H_
+
+#include "FreeRTOS.h"
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+// 上行码率自适应：网络任务测量每次发布的耗时和字节数、发送窗口占用 (QoS1 在途帧)、audio_queue 的增长
+// 以及 UDP 接收端报告的丢包率，
+// 每 RATE_CONTROL_INTERVAL_MS 估计一次可用带宽，并在以下档位间逐级切换 (通过 audio_set_output_sample_rate()
+// 和 audio_set_stream_format()，在音频任务的下一帧边界生效)：
+//   PCM 全采样率 -> PCM 降采样率 -> log-mel 特征 (码率依次约减半)
+// 降档立即生效；升档要求估计带宽持续 RATE_CONTROL_UPGRADE_HOLD_MS 高于目标档位码率的 RATE_CONTROL_UPGRADE_MARGIN_PCT，
+// 且每次升档后很快又降档时加倍等待时间，避免在临界带宽上来回切换。
+// 除 rate_control_set_enabled() 和 rate_control_get_stats() 外只在网络任务中调用。
+
+#define RATE_CONTROL_INTERVAL_MS            (1000)
+#define RATE_CONTROL_DOWNGRADE_MARGIN_PCT   (110)   // 估计带宽低于当前档位码率的此百分比时降档
+#define RATE_CONTROL_UPGRADE_MARGIN_PCT     (150)   // 估计带宽高于目标档位码率的此百分比时才考虑升档
+#define RATE_CONTROL_UPGRADE_HOLD_MS        (5000)
+#define RATE_CONTROL_UPGRADE_HOLD_MAX_MS    (20000)
+#define RATE_CONTROL_UPGRADE_STABLE_MS      (10000) // 升档后保持此时间未降档视为稳定，等待时间恢复为基础值
+#define RATE_CONTROL_QUEUE_GROWTH_FRAMES    (3)     // 一个周期内 audio_queue 增长超过此帧数视为拥塞
+#define RATE_CONTROL_BACKLOG_PCT            (75)    // 发送窗口占用超过此百分比视为拥塞
+#define RATE_CONTROL_IDLE_QUEUE_FRAMES      (2)     // 升档要求队列深度不超过此值
+#define RATE_CONTROL_ESTIMATE_CAP_FACTOR    (4)     // 发布从未阻塞时，估计值按实际发送速率的此倍数封顶
+#define RATE_CONTROL_LOSS_PCT               (5)     // 接收端报告的丢包率达到此百分比视为拥塞 (UDP 发送不阻塞，只能靠丢包发现拥塞)
+
+typedef enum {
+    RATE_TIER_PCM_FULL,         // PCM，AUDIO_MAX_OUTPUT_SAMPLE_RATE
+    RATE_TIER_PCM_REDUCED,      // PCM，AUDIO_RATE_CONTROL_REDUCED_SAMPLE_RATE
+    RATE_TIER_FEATURES,         // log-mel 特征，AUDIO_MAX_OUTPUT_SAMPLE_RATE
+    RATE_TIER_COUNT
+} rate_tier_t;
+
+typedef struct {
+    rate_tier_t tier;
+    uint32_t estimate_bps;      // 平滑后的可用带宽估计
+    uint32_t delivered_bps;     // 最近一个周期实际发出的速率
+    uint32_t tier_bps;          // 当前档位的码率
+    uint32_t queue_depth;       // 最近一个周期结束时 audio_queue 的深度
+    uint32_t downgrades;
+    uint32_t upgrades;
+} rate_control_stats_t;
+
+// 复位估计器并从最高档开始
+void rate_control_init(void);
+
+// 启用/关闭自适应。启用时切换到最高档；关闭后保持当前档位，可手动设置采样率和格式。
+void rate_control_set_enabled(bool enable);
+bool rate_control_is_enabled(void);
+
+// 记录一次发布：发出的字节数及发布调用耗时 (发送缓冲满时发布会阻塞，耗时反映链路速率)
+void rate_control_on_publish(size_t bytes, TickType_t elapsed);
+
+// 记录一次接收端丢包报告 (0~100)，本周期内取最大值
+void rate_control_report_loss(uint32_t loss_pct);
+
+// 周期性调用 (连接在线时)。backlog_pct 为发送窗口占用百分比 (QoS0 没有可观测的窗口，传 0)。
+void rate_control_update(uint32_t backlog_pct);
+
+// 连接断开期间没有有效测量，重连后调用以重新开始一个周期
+void rate_control_restart_interval(void);
+
+void rate_control_get_stats(rate_control_stats_t *stats);
+
+#endif /* RATE_CONTROL_H_ */
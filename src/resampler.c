@@ -0,0 +1,166 @@
+#include "resampler.h"
+#include "dsp.h"
+#include <string.h>
+
+// 截止频率相对于 min(输入, 输出) 奈奎斯特频率的比例，留出过渡带以抑制混叠
+#define RESAMPLER_CUTOFF_RATIO    (0.90f)
+#define RESAMPLER_PI              (3.14159265358979f)
+
+// 原型低通第 n 个抽头：加窗 sinc，4 项 Blackman-Harris 窗 (旁瓣约 -92 dB)
+static float rs_prototype_tap(uint32_t n, uint32_t n_taps, float fc) {
+    float t = (float)n - (float)(n_taps - 1) * 0.5f;
+    float sinc = (t == 0.0f) ? 2.0f * fc : dsp_sinf(2.0f * RESAMPLER_PI * fc * t) / (RESAMPLER_PI * t);
+    float w_arg = 2.0f * RESAMPLER_PI * (float)n / (float)(n_taps - 1);
+    float w = 0.35875f - 0.48829f * dsp_cosf(w_arg) + 0.14128f * dsp_cosf(2.0f * w_arg) - 0.01168f * dsp_cosf(3.0f * w_arg);
+    return sinc * w;
+}
+
+static uint32_t rs_gcd(uint32_t a, uint32_t b) {
+    while (b != 0) {
+        uint32_t t = a % b;
+        a = b;
+        b = t;
+    }
+    return a;
+}
+
+static inline int16_t rs_saturate_q15(int32_t acc) {
+    acc = (acc + (1 << 14)) >> 15;
+    if (acc > INT16_MAX) return INT16_MAX;
+    if (acc < INT16_MIN) return INT16_MIN;
+    return (int16_t)acc;
+}
+
+bool resampler_is_supported(uint32_t in_rate, uint32_t out_rate) {
+    if (in_rate == 0 || out_rate == 0) {
+        return false;
+    }
+    uint32_t g = rs_gcd(in_rate, out_rate);
+    return (out_rate / g <= RESAMPLER_MAX_FACTOR) && (in_rate / g <= RESAMPLER_MAX_FACTOR);
+}
+
+bool resampler_init(resampler_t *rs, uint32_t in_rate, uint32_t out_rate) {
+    if (rs == NULL || !resampler_is_supported(in_rate, out_rate)) {
+        return false;
+    }
+
+    uint32_t g = rs_gcd(in_rate, out_rate);
+    uint32_t up = out_rate / g;
+    uint32_t down = in_rate / g;
+
+    memset(rs, 0, sizeof(*rs));
+    rs->in_rate = in_rate;
+    rs->out_rate = out_rate;
+    rs->up = (uint16_t)up;
+    rs->down = (uint16_t)down;
+
+    if (up == 1 && down == 1) {
+        // 直通：不设计滤波器，resampler_process 直接拷贝
+        rs->taps_per_phase = 1;
+        return true;
+    }
+
+    // 原型低通工作在 L * in_rate，截止频率归一化后为 0.5 * ratio / max(L, M)
+    uint32_t r = (up > down) ? up : down;
+    uint32_t n_taps = 2u * RESAMPLER_ZERO_CROSSINGS * r;
+    uint32_t taps_per_phase = (n_taps + up - 1) / up;
+    float fc = 0.5f * RESAMPLER_CUTOFF_RATIO / (float)r;
+
+    // 第一遍求和用于归一化：整个原型的直流增益为 L，使每个相位的直流增益约为 1
+    float sum = 0.0f;
+    for (uint32_t n = 0; n < n_taps; n++) {
+        sum += rs_prototype_tap(n, n_taps, fc);
+    }
+    float scale = (float)up * 32768.0f / sum;
+
+    for (uint32_t p = 0; p < up; p++) {
+        for (uint32_t k = 0; k < taps_per_phase; k++) {
+            uint32_t n = p + k * up;
+            int32_t q = 0;
+            if (n < n_taps) {
+                float v = rs_prototype_tap(n, n_taps, fc) * scale;
+                q = (int32_t)(v + (v >= 0.0f ? 0.5f : -0.5f));
+                if (q > INT16_MAX) q = INT16_MAX;
+                if (q < INT16_MIN) q = INT16_MIN;
+            }
+            rs->coeffs[p * taps_per_phase + k] = (int16_t)q;
+        }
+    }
+    rs->taps_per_phase = (uint16_t)taps_per_phase;
+    return true;
+}
+
+void resampler_reset(resampler_t *rs) {
+    rs->phase = 0;
+    rs->in_offset = 0;
+    memset(rs->history, 0, sizeof(rs->history));
+}
+
+size_t resampler_output_count(const resampler_t *rs, size_t in_count) {
+    // 以 1/L 个输入样本为单位的位置：pos = in_offset * L + phase，每个输出样本前进 M
+    uint32_t pos = rs->in_offset * rs->up + rs->phase;
+    uint32_t end = (uint32_t)in_count * rs->up;
+    if (pos >= end) {
+        return 0;
+    }
+    return (end - pos + rs->down - 1) / rs->down;
+}
+
+size_t resampler_process(resampler_t *rs,
+                         const int16_t *in, size_t in_count, size_t in_stride,
+                         int16_t *out, size_t out_stride) {
+    if (rs->up == 1 && rs->down == 1) {
+        for (size_t i = 0; i < in_count; i++) {
+            out[i * out_stride] = in[i * in_stride];
+        }
+        return in_count;
+    }
+
+    const uint32_t taps = rs->taps_per_phase;
+    const uint32_t hist_len = taps - 1;
+    uint32_t i = rs->in_offset;
+    uint32_t p = rs->phase;
+    size_t produced = 0;
+
+    while (i < in_count) {
+        const int16_t *c = &rs->coeffs[p * taps];
+        int32_t acc = 0;
+        if (i >= hist_len) {
+            // 快速路径：所有抽头都落在当前块内
+            const int16_t *x = &in[i * in_stride];
+            for (uint32_t k = 0; k < taps; k++) {
+                acc += (int32_t)c[k] * (int32_t)x[-(ptrdiff_t)(k * in_stride)];
+            }
+        } else {
+            // 块起始处：较旧的抽头来自上一块保存的历史样本
+            for (uint32_t k = 0; k <= i; k++) {
+                acc += (int32_t)c[k] * (int32_t)in[(i - k) * in_stride];
+            }
+            for (uint32_t k = i + 1; k < taps; k++) {
+                acc += (int32_t)c[k] * (int32_t)rs->history[hist_len + i - k];
+            }
+        }
+        out[produced * out_stride] = rs_saturate_q15(acc);
+        produced++;
+
+        p += rs->down;
+        i += p / rs->up;
+        p %= rs->up;
+    }
+    rs->in_offset = i - (uint32_t)in_count;
+    rs->phase = (uint16_t)p;
+
+    // 保存最新的 T-1 个输入样本，供下一块使用
+    if (in_count >= hist_len) {
+        for (uint32_t k = 0; k < hist_len; k++) {
+            rs->history[k] = in[(in_count - hist_len + k) * in_stride];
+        }
+    } else {
+        uint32_t keep = hist_len - (uint32_t)in_count;
+        memmove(rs->history, &rs->history[in_count], keep * sizeof(int16_t));
+        for (uint32_t k = 0; k < in_count; k++) {
+            rs->history[keep + k] = in[k * in_stride];
+        }
+    }
+    return produced;
+}
@@ -0,0 +1,47 @@
+#ifndef RESAMPLER_H_
+#define RESAMPLER_H_
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+// 定点多相采样率转换器 (Q15 系数，int32 累加)
+// 支持 L/M 有理比，L 与 M 约分后均不超过 RESAMPLER_MAX_FACTOR (例如 48k->16k, 32k->16k, 16k->8k)
+// 状态 (相位与历史样本) 跨帧保存，因此连续调用的输出与一次性处理整段信号完全一致。
+
+#define RESAMPLER_MAX_FACTOR          (6)   // L、M 的最大值
+#define RESAMPLER_ZERO_CROSSINGS      (16)  // 原型 sinc 每侧过零点数，决定过渡带宽度
+#define RESAMPLER_MAX_TAPS_PER_PHASE  (2 * RESAMPLER_ZERO_CROSSINGS * RESAMPLER_MAX_FACTOR)
+#define RESAMPLER_MAX_COEFFS          (RESAMPLER_MAX_TAPS_PER_PHASE + RESAMPLER_MAX_FACTOR)
+
+typedef struct {
+    uint32_t in_rate;           // 输入采样率 (Hz)
+    uint32_t out_rate;          // 输出采样率 (Hz)
+    uint16_t up;                // 插值因子 L
+    uint16_t down;              // 抽取因子 M
+    uint16_t taps_per_phase;    // 每个相位的抽头数 T
+    uint16_t phase;             // 下一个输出样本使用的相位 (0..L-1)
+    uint32_t in_offset;         // 下一个输出样本对应的最新输入样本在下一块中的下标
+    int16_t  coeffs[RESAMPLER_MAX_COEFFS];             // 按相位重排：coeffs[p * T + k] = L * h[p + k * L]
+    int16_t  history[RESAMPLER_MAX_TAPS_PER_PHASE];    // 上一块末尾的 T-1 个输入样本 (旧 -> 新)
+} resampler_t;
+
+// 检查输入/输出采样率之比是否受支持 (不初始化任何状态)
+bool resampler_is_supported(uint32_t in_rate, uint32_t out_rate);
+
+// 按输入/输出采样率设计滤波器并复位状态。比值不受支持时返回 false。
+bool resampler_init(resampler_t *rs, uint32_t in_rate, uint32_t out_rate);
+
+// 清除历史样本与相位，保留滤波器系数 (例如重新开始录音时调用)
+void resampler_reset(resampler_t *rs);
+
+// 处理 in_count 个输入样本时将产生的输出样本数 (不修改状态)
+size_t resampler_output_count(const resampler_t *rs, size_t in_count);
+
+// 处理一块输入样本。in/out 的步长以样本为单位，便于直接处理交错多通道数据中的单个通道。
+// 返回写入 out 的样本数，调用方需保证 out 至少能容纳 resampler_output_count() 个样本。
+size_t resampler_process(resampler_t *rs,
+                         const int16_t *in, size_t in_count, size_t in_stride,
+                         int16_t *out, size_t out_stride);
+
+#endif /* RESAMPLER_H_ */
@@ -0,0 +1,41 @@
+#include "server_control.h"
+#include "byte_order.h"
+#include <string.h>
+
+bool server_control_parse(const uint8_t *data, size_t len, server_control_cmd_t *cmd) {
+    if (len != SERVER_CONTROL_MSG_SIZE || data[0] != SERVER_CONTROL_VERSION) {
+        return false;
+    }
+    memset(cmd, 0, sizeof(*cmd));
+    cmd->type = data[1];
+    cmd->id = get_le16(&data[2]);
+    cmd->flags = data[8];
+    switch (cmd->type) {
+        case SERVER_CONTROL_CMD_CREDIT:
+            cmd->credits = get_le32(&data[4]);
+            return true;
+        case SERVER_CONTROL_CMD_QUALITY:
+            cmd->format = data[4];
+            cmd->sample_rate_hz = get_le16(&data[6]);
+            cmd->frame_duration_ms = get_le16(&data[10]);
+            return true;
+        default:
+            return false;
+    }
+}
+
+size_t server_control_encode(const server_control_cmd_t *cmd, uint8_t out[SERVER_CONTROL_MSG_SIZE]) {
+    memset(out, 0, SERVER_CONTROL_MSG_SIZE);
+    out[0] = SERVER_CONTROL_VERSION;
+    out[1] = cmd->type;
+    put_le16(&out[2], cmd->id);
+    out[8] = cmd->flags;
+    if (cmd->type == SERVER_CONTROL_CMD_CREDIT) {
+        put_le32(&out[4], cmd->credits);
+    } else {
+        out[4] = cmd->format;
+        put_le16(&out[6], cmd->sample_rate_hz);
+        put_le16(&out[10], cmd->frame_duration_ms);
+    }
+    return SERVER_CONTROL_MSG_SIZE;
+}
@@ -0,0 +1,51 @@
+#ifndef SERVER_CONTROL_H_
+#define SERVER_CONTROL_H_
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+// 服务端下发的流控和质量档位命令。设备每次连接后以 QoS1 订阅 "MQTT_TOPIC_CONTROL/<客户端 ID>"，
+// 网络任务在下一轮循环中应用命令，不需要重连。
+//
+// 命令为 12 字节 (小端)：
+//   [0]      版本 = SERVER_CONTROL_VERSION
+//   [1]      类型 SERVER_CONTROL_CMD_*
+//   [2..3]   命令 ID，与上一条已应用的命令相同时视为 QoS1 重复投递而忽略
+//   [8]      标志 SERVER_CONTROL_FLAG_*
+// SERVER_CONTROL_CMD_CREDIT (基于信用的流控)：
+//   [4..7]   追加的信用 (音频帧数)。第一条信用命令启用流控，此后每发布一帧音频 (实时或积压，不含 FEC 校验包)
+//            消耗一个信用，信用用完时帧留在 audio_queue 中 (随后按帧龄转入积压通道)。
+//            标志 SERVER_CONTROL_FLAG_CREDIT_OFF 关闭流控。每次重新连接后流控恢复为关闭，由服务端重新下发。
+// SERVER_CONTROL_CMD_QUALITY (质量档位)：
+//   [4]      上行格式 (AUDIO_FRAME_FORMAT_PCM_S16LE / AUDIO_FRAME_FORMAT_LOGMEL_U8)，SERVER_CONTROL_KEEP_FORMAT 表示不变
+//   [6..7]   输出采样率 (Hz)，0 表示不变
+//   [10..11] 帧长 (毫秒，即每条消息打包的音频时长)，0 表示不变
+//            指定格式或采样率时关闭码率自适应，由服务端固定档位；标志 SERVER_CONTROL_FLAG_QUALITY_AUTO 恢复自适应。
+// 不依赖 RTOS，服务端可复用 server_control_encode() 生成命令。
+
+#define SERVER_CONTROL_VERSION            (1)
+#define SERVER_CONTROL_MSG_SIZE           (12)
+#define SERVER_CONTROL_CMD_CREDIT         (1)
+#define SERVER_CONTROL_CMD_QUALITY        (2)
+#define SERVER_CONTROL_FLAG_CREDIT_OFF    (1u << 0)
+#define SERVER_CONTROL_FLAG_QUALITY_AUTO  (1u << 1)
+#define SERVER_CONTROL_KEEP_FORMAT        (0xFF)
+
+typedef struct {
+    uint8_t  type;                  // SERVER_CONTROL_CMD_*
+    uint8_t  flags;                 // SERVER_CONTROL_FLAG_*
+    uint16_t id;
+    uint32_t credits;               // CREDIT
+    uint8_t  format;                // QUALITY
+    uint16_t sample_rate_hz;        // QUALITY
+    uint16_t frame_duration_ms;     // QUALITY
+} server_control_cmd_t;
+
+// 解析一条命令，版本、长度或类型不对时返回 false
+bool server_control_parse(const uint8_t *data, size_t len, server_control_cmd_t *cmd);
+
+// 编码一条命令到 out，返回 SERVER_CONTROL_MSG_SIZE
+size_t server_control_encode(const server_control_cmd_t *cmd, uint8_t out[SERVER_CONTROL_MSG_SIZE]);
+
+#endif /* SERVER_CONTROL_H_ */
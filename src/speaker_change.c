@@ -0,0 +1,170 @@
+#include "speaker_change.h"
+#include <string.h>
+
+#define SC_PI       (3.14159265358979f)
+#define SC_LN2      (0.69314718056f)
+#define SC_N_BINS   (SPEAKER_CHANGE_WINDOW_SAMPLES / 2u + 1u)
+#define SC_N_TOTAL  (2u * SPEAKER_CHANGE_HALF_WINDOWS)
+
+// FFT 工作区。检测器只在音频任务中运行，放在静态区以减小任务栈占用。
+static int16_t sc_re[SPEAKER_CHANGE_WINDOW_SAMPLES];
+static int16_t sc_im[SPEAKER_CHANGE_WINDOW_SAMPLES];
+static uint32_t sc_power[SC_N_BINS];
+static uint64_t sc_bands[SPEAKER_CHANGE_MEL_BANDS];
+
+bool speaker_change_init(speaker_change_t *sc, uint32_t sample_rate_hz) {
+    if (sc == NULL || sample_rate_hz == 0) {
+        return false;
+    }
+    dsp_init();
+
+    memset(sc, 0, sizeof(*sc));
+    if (!dsp_mel_init(&sc->mel, SPEAKER_CHANGE_FFT_LOG2N, sample_rate_hz, SPEAKER_CHANGE_MEL_BANDS,
+                      100.0f, (float)sample_rate_hz * 0.5f)) {
+        return false;
+    }
+    sc->sample_rate = sample_rate_hz;
+    sc->min_segment_windows = (uint32_t)((uint64_t)SPEAKER_CHANGE_MIN_SEGMENT_MS * sample_rate_hz /
+                                         (1000u * SPEAKER_CHANGE_WINDOW_SAMPLES));
+
+    for (uint32_t n = 0; n < SPEAKER_CHANGE_WINDOW_SAMPLES; n++) {
+        float w = 0.54f - 0.46f * dsp_cosf(2.0f * SC_PI * (float)n / (float)(SPEAKER_CHANGE_WINDOW_SAMPLES - 1));
+        sc->window[n] = (int16_t)(w * 32767.0f + 0.5f);
+    }
+    // DCT-II 的第 1..C 个基函数；c0 只反映整体电平，不使用
+    for (uint32_t k = 0; k < SPEAKER_CHANGE_NUM_CEPSTRA; k++) {
+        for (uint32_t b = 0; b < SPEAKER_CHANGE_MEL_BANDS; b++) {
+            sc->dct[k][b] = dsp_cosf(SC_PI * (float)(k + 1) * ((float)b + 0.5f) / (float)SPEAKER_CHANGE_MEL_BANDS);
+        }
+    }
+    return true;
+}
+
+void speaker_change_reset(speaker_change_t *sc) {
+    sc->pending_count = 0;
+    sc->n_features = 0;
+    sc->head = 0;
+    sc->windows_since_change = 0;
+    sc->prev_delta = 0.0f;
+    sc->prev2_delta = 0.0f;
+}
+
+// 计算 pending[] 的 MFCC 并写入特征环形缓冲。静音窗返回 false，不写入。
+static bool sc_extract_features(speaker_change_t *sc) {
+    uint64_t energy = 0;
+    for (uint32_t n = 0; n < SPEAKER_CHANGE_WINDOW_SAMPLES; n++) {
+        energy += (uint32_t)((int32_t)sc->pending[n] * sc->pending[n]);
+        sc_re[n] = (int16_t)(((int32_t)sc->pending[n] * sc->window[n] + (1 << 14)) >> 15);
+        sc_im[n] = 0;
+    }
+    if (energy / SPEAKER_CHANGE_WINDOW_SAMPLES < SPEAKER_CHANGE_SILENCE_POWER) {
+        return false;
+    }
+
+    // 归一化和 FFT 的块浮点移位只给所有频带加上同一个对数偏移，只影响被丢弃的 c0，因此不需要补偿
+    (void)dsp_normalize_q15(sc_re, SPEAKER_CHANGE_WINDOW_SAMPLES);
+    (void)dsp_fft_q15(sc_re, sc_im, SPEAKER_CHANGE_FFT_LOG2N);
+    dsp_power_spectrum(sc_re, sc_im, sc_power, SC_N_BINS);
+    dsp_mel_apply(&sc->mel, sc_power, sc_bands);
+
+    float log_mel[SPEAKER_CHANGE_MEL_BANDS];
+    for (uint32_t b = 0; b < SPEAKER_CHANGE_MEL_BANDS; b++) {
+        log_mel[b] = (float)dsp_log2_q10(sc_bands[b] + 1u) * (1.0f / (float)(1u << DSP_LOG2_FRAC_BITS));
+    }
+    float *c = sc->features[sc->head];
+    for (uint32_t k = 0; k < SPEAKER_CHANGE_NUM_CEPSTRA; k++) {
+        float acc = 0.0f;
+        for (uint32_t b = 0; b < SPEAKER_CHANGE_MEL_BANDS; b++) {
+            acc += sc->dct[k][b] * log_mel[b];
+        }
+        c[k] = acc;
+    }
+
+    sc->head = (sc->head + 1u) % SC_N_TOTAL;
+    if (sc->n_features < SC_N_TOTAL) {
+        sc->n_features++;
+    }
+    return true;
+}
+
+// 左段 (较旧的 H 个窗) 与右段 (最新的 H 个窗) 的 delta-BIC：
+// 0.5 * (N log|S| - N_l log|S_l| - N_r log|S_r|) - lambda * 0.5 * (d + d) * log N，对角协方差下 log|S| 为各维方差的对数和。
+// 每次从头累加 2H 个特征 (约 6000 次乘加)，避免滑动更新时的浮点漂移。
+static float sc_delta_bic(const speaker_change_t *sc) {
+    float sum_l[SPEAKER_CHANGE_NUM_CEPSTRA] = {0};
+    float sq_l[SPEAKER_CHANGE_NUM_CEPSTRA] = {0};
+    float sum_r[SPEAKER_CHANGE_NUM_CEPSTRA] = {0};
+    float sq_r[SPEAKER_CHANGE_NUM_CEPSTRA] = {0};
+
+    for (uint32_t i = 0; i < SC_N_TOTAL; i++) {
+        const float *c = sc->features[(sc->head + i) % SC_N_TOTAL];
+        float *sum = (i < SPEAKER_CHANGE_HALF_WINDOWS) ? sum_l : sum_r;
+        float *sq = (i < SPEAKER_CHANGE_HALF_WINDOWS) ? sq_l : sq_r;
+        for (uint32_t k = 0; k < SPEAKER_CHANGE_NUM_CEPSTRA; k++) {
+            sum[k] += c[k];
+            sq[k] += c[k] * c[k];
+        }
+    }
+
+    const float h = (float)SPEAKER_CHANGE_HALF_WINDOWS;
+    const float n = (float)SC_N_TOTAL;
+    float log_det_l = 0.0f, log_det_r = 0.0f, log_det_all = 0.0f;
+    for (uint32_t k = 0; k < SPEAKER_CHANGE_NUM_CEPSTRA; k++) {
+        float mean_l = sum_l[k] / h;
+        float mean_r = sum_r[k] / h;
+        float mean_all = (sum_l[k] + sum_r[k]) / n;
+        float var_l = sq_l[k] / h - mean_l * mean_l;
+        float var_r = sq_r[k] / h - mean_r * mean_r;
+        float var_all = (sq_l[k] + sq_r[k]) / n - mean_all * mean_all;
+        log_det_l += dsp_log2f((var_l > SPEAKER_CHANGE_VAR_FLOOR) ? var_l : SPEAKER_CHANGE_VAR_FLOOR);
+        log_det_r += dsp_log2f((var_r > SPEAKER_CHANGE_VAR_FLOOR) ? var_r : SPEAKER_CHANGE_VAR_FLOOR);
+        log_det_all += dsp_log2f((var_all > SPEAKER_CHANGE_VAR_FLOOR) ? var_all : SPEAKER_CHANGE_VAR_FLOOR);
+    }
+
+    float gain = 0.5f * SC_LN2 * (n * log_det_all - h * log_det_l - h * log_det_r);
+    float penalty = SPEAKER_CHANGE_PENALTY * 0.5f * (2.0f * SPEAKER_CHANGE_NUM_CEPSTRA) * SC_LN2 * dsp_log2f(n);
+    return gain - penalty;
+}
+
+// 分析一个窗，检测到切换时返回 true
+static bool sc_analyze_window(speaker_change_t *sc) {
+    if (!sc_extract_features(sc) || sc->n_features < SC_N_TOTAL) {
+        return false;
+    }
+    sc->windows_since_change++;
+
+    // 前一个窗的距离为正且是局部峰值：切换点位于前一个窗的左右段交界处
+    float delta = sc_delta_bic(sc);
+    bool detected = sc->prev_delta > 0.0f && sc->prev_delta >= delta && sc->prev_delta > sc->prev2_delta &&
+                    sc->windows_since_change >= sc->min_segment_windows;
+    if (detected) {
+        sc->windows_since_change = 0;
+    }
+    sc->prev2_delta = sc->prev_delta;
+    sc->prev_delta = delta;
+    return detected;
+}
+
+bool speaker_change_process(speaker_change_t *sc, const int16_t *in, size_t count, size_t stride) {
+    bool detected = false;
+    uint32_t windows = 0;
+    for (size_t i = 0; i < count; i++) {
+        sc->pending[sc->pending_count++] = in[i * stride];
+        if (sc->pending_count == SPEAKER_CHANGE_WINDOW_SAMPLES) {
+            sc->pending_count = 0;
+            // 超出预算的窗直接跳过，只会稀疏特征序列，不会让单帧处理时间失控
+            if (windows < SPEAKER_CHANGE_MAX_WINDOWS_PER_CALL) {
+                windows++;
+                detected |= sc_analyze_window(sc);
+            }
+        }
+    }
+    return detected;
+}
+
+uint32_t speaker_change_latency_ms(const speaker_change_t *sc) {
+    if (sc->sample_rate == 0) {
+        return 0;
+    }
+    return (SPEAKER_CHANGE_HALF_WINDOWS + 1u) * SPEAKER_CHANGE_WINDOW_SAMPLES * 1000u / sc->sample_rate;
+}
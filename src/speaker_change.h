@@ -0,0 +1,54 @@
+#ifndef SPEAKER_CHANGE_H_
+#define SPEAKER_CHANGE_H_
+
+#include "dsp.h"
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+// 轻量级说话人切换检测：每个分析窗计算 MFCC (c1..c12)，在相邻两段特征上用对角协方差高斯
+// 计算 BIC 距离，距离出现正的局部峰值时认为在两段交界处发生了说话人切换。
+// 分析窗不重叠，每次调用最多分析 SPEAKER_CHANGE_MAX_WINDOWS_PER_CALL 个窗，单帧开销有上界。
+// 两段各约 2 s：0.5 s 的段里同一人的音素变化就足以让 delta-BIC 为正，误报接近最短间隔允许的上限。
+// 段长、惩罚系数和最短间隔按 tools/host/test_speaker_change.c 的误报率门限 (< 1 次/分钟) 选定。
+
+#define SPEAKER_CHANGE_FFT_LOG2N            (8)
+#define SPEAKER_CHANGE_WINDOW_SAMPLES       (1u << SPEAKER_CHANGE_FFT_LOG2N) // 16 kHz 时 16 ms
+#define SPEAKER_CHANGE_MEL_BANDS            (24)
+#define SPEAKER_CHANGE_NUM_CEPSTRA          (12)    // 不含 c0，对增益变化不敏感
+#define SPEAKER_CHANGE_HALF_WINDOWS         (128)   // BIC 左右两段各自的分析窗数 (16 kHz 时约 2 s)
+#define SPEAKER_CHANGE_MAX_WINDOWS_PER_CALL (6)     // 覆盖 16 kHz 下的最大帧长 (80 ms = 5 个窗)
+#define SPEAKER_CHANGE_MIN_SEGMENT_MS       (3000)  // 两次切换之间的最短间隔
+#define SPEAKER_CHANGE_PENALTY              (4.0f)  // BIC 模型复杂度惩罚系数 lambda，越大越保守
+#define SPEAKER_CHANGE_SILENCE_POWER        (10000u) // 窗内均方值低于此值 (约 -50 dBFS) 视为静音，不参与统计
+#define SPEAKER_CHANGE_VAR_FLOOR            (1e-3f)
+
+typedef struct {
+    uint32_t sample_rate;
+    uint32_t min_segment_windows;       // SPEAKER_CHANGE_MIN_SEGMENT_MS 对应的分析窗数
+    uint32_t pending_count;             // pending[] 中已累积的样本数
+    uint32_t n_features;                // features[] 中的有效特征数 (<= 2 * HALF_WINDOWS)
+    uint32_t head;                      // 下一次写入 features[] 的位置，写满后即最旧的特征
+    uint32_t windows_since_change;
+    float    prev_delta;                // 前一个窗的 BIC 距离
+    float    prev2_delta;
+    int16_t  window[SPEAKER_CHANGE_WINDOW_SAMPLES];    // Hamming 窗，Q15
+    int16_t  pending[SPEAKER_CHANGE_WINDOW_SAMPLES];
+    float    dct[SPEAKER_CHANGE_NUM_CEPSTRA][SPEAKER_CHANGE_MEL_BANDS];
+    float    features[2 * SPEAKER_CHANGE_HALF_WINDOWS][SPEAKER_CHANGE_NUM_CEPSTRA];
+    dsp_mel_filterbank_t mel;
+} speaker_change_t;
+
+// 按采样率生成窗函数、mel 滤波器和 DCT 表并复位状态。采样率不受支持时返回 false。
+bool speaker_change_init(speaker_change_t *sc, uint32_t sample_rate_hz);
+
+// 清除已累积的特征 (例如重新开始录音时调用)，保留初始化生成的表
+void speaker_change_reset(speaker_change_t *sc);
+
+// 输入一块单通道样本 (步长以样本为单位)。本块内检测到切换时返回 true。
+bool speaker_change_process(speaker_change_t *sc, const int16_t *in, size_t count, size_t stride);
+
+// 检测延迟：返回 true 时，切换点大约位于当前块之前这么多毫秒
+uint32_t speaker_change_latency_ms(const speaker_change_t *sc);
+
+#endif /* SPEAKER_CHANGE_H_ */
@@ -2,6 +2,7 @@
 #include "ui_task.h" // 用于 LED 控制函数 (稍后创建)
 #include "audio_task.h" // 用于控制音频录制 (稍后创建)
 #include "network_task.h" // 用于网络操作 (稍后创建)
+#include "boot_profile.h"
 #include <stdio.h> // 用于 printf，应替换为正确的日志记录
 
 // 应用的当前状态
@@ -139,6 +140,7 @@ static void on_enter_server_disconnected(void) {
 
 static void on_enter_idle(void) {
     APP_LOG_INFO("Entering IDLE state");
+    boot_reached_idle();
     // Trigger LED:灭 (off) // 触发 LED：熄灭
     ui_set_led_state(LED_STATE_OFF);
     // Stop audio streaming // 停止音频流式传输
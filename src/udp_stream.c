@@ -0,0 +1,132 @@
+#include "udp_stream.h"
+#include "byte_order.h"
+#include "audio_task.h"
+#include "app_config.h"
+#include "cy_secure_sockets.h"
+#include "FreeRTOS.h"
+#include "task.h"
+#include <stdio.h> // 用于 printf，替换为适当的日志记录
+#include <stddef.h>
+
+#define APP_LOG_UDP_INFO(format, ...) printf("[UDP] " format "\n", ##__VA_ARGS__)
+#define APP_LOG_UDP_ERROR(format, ...) printf("[UDP ERROR] " format "\n", ##__VA_ARGS__)
+
+#if UDP_STREAM_RTP_HEADER_SIZE > AUDIO_FRAME_HEADROOM
+#error "AUDIO_FRAME_HEADROOM is too small for the RTP header"
+#endif
+
+static cy_socket_t udp_socket = NULL;
+static cy_socket_sockaddr_t receiver_address;
+static uint16_t rtp_sequence = 0;
+static uint32_t rtp_ssrc = 0;
+
+static udp_stream_stats_t udp_stats;
+static udp_stream_feedback_t pending_feedback;  // 由 MQTT 回调写入，网络任务取走
+static bool feedback_pending = false;
+
+// FNV-1a，只需在同一接收端上区分不同设备
+static uint32_t hash_client_id(const char *client_id) {
+    uint32_t hash = 2166136261u;
+    while (*client_id != '\0') {
+        hash ^= (uint8_t)*client_id++;
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+cy_rslt_t udp_stream_open(const char *receiver_host, const char *client_id) {
+    if (udp_socket != NULL) {
+        return CY_RSLT_SUCCESS;
+    }
+
+    receiver_address = (cy_socket_sockaddr_t){ .port = AUDIO_UDP_PORT };
+    cy_rslt_t result = cy_socket_gethostbyname(receiver_host, CY_SOCKET_IP_VER_V4, &receiver_address.ip_address);
+    if (result != CY_RSLT_SUCCESS) {
+        APP_LOG_UDP_ERROR("Failed to resolve receiver address: 0x%08X", (unsigned int)result);
+        return result;
+    }
+
+    result = cy_socket_create(CY_SOCKET_DOMAIN_AF_INET, CY_SOCKET_TYPE_DGRAM, CY_SOCKET_IPPROTO_UDP, &udp_socket);
+    if (result != CY_RSLT_SUCCESS) {
+        APP_LOG_UDP_ERROR("Failed to create socket: 0x%08X", (unsigned int)result);
+        udp_socket = NULL;
+        return result;
+    }
+
+    rtp_ssrc = hash_client_id(client_id);
+    APP_LOG_UDP_INFO("Live audio over UDP to %s:%u, SSRC 0x%08lX.", receiver_host, (unsigned int)AUDIO_UDP_PORT,
+                     (unsigned long)rtp_ssrc);
+    return CY_RSLT_SUCCESS;
+}
+
+void udp_stream_close(void) {
+    if (udp_socket != NULL) {
+        cy_socket_delete(udp_socket);
+        udp_socket = NULL;
+    }
+}
+
+bool udp_stream_is_open(void) {
+    return udp_socket != NULL;
+}
+
+cy_rslt_t udp_stream_send(uint8_t *payload, size_t payload_len) {
+    // 校验包缓冲不保证对齐，按字节读取帧头字段
+    uint8_t *packet = payload - UDP_STREAM_RTP_HEADER_SIZE;
+    bool parity = (payload[offsetof(audio_frame_header_t, flags)] & AUDIO_FRAME_FLAG_FEC_PARITY) != 0;
+    uint32_t timestamp_ms = get_le32(&payload[offsetof(audio_frame_header_t, timestamp_ms)]);
+
+    packet[0] = (uint8_t)(UDP_STREAM_RTP_VERSION << 6);
+    packet[1] = parity ? UDP_STREAM_PAYLOAD_TYPE_FEC : UDP_STREAM_PAYLOAD_TYPE_AUDIO;
+    put_be16(&packet[2], rtp_sequence);
+    put_be32(&packet[4], timestamp_ms * UDP_STREAM_RTP_CLOCK_KHZ);
+    put_be32(&packet[8], rtp_ssrc);
+
+    uint32_t sent = 0;
+    cy_rslt_t result = cy_socket_sendto(udp_socket, packet, (uint32_t)(UDP_STREAM_RTP_HEADER_SIZE + payload_len),
+                                        CY_SOCKET_FLAGS_NONE, &receiver_address, sizeof(receiver_address), &sent);
+    // 发送失败的数据报同样占用序号，接收端会把它计为丢包
+    rtp_sequence++;
+    if (result != CY_RSLT_SUCCESS) {
+        udp_stats.send_errors++;
+        return result;
+    }
+    udp_stats.datagrams_sent++;
+    return CY_RSLT_SUCCESS;
+}
+
+void udp_stream_handle_feedback(const uint8_t *data, size_t len) {
+    if (len < UDP_STREAM_FEEDBACK_SIZE || data[0] != UDP_STREAM_FEEDBACK_VERSION) {
+        return;
+    }
+    udp_stream_feedback_t feedback = {
+        .fraction_lost = data[1],
+        .highest_sequence = get_le32(&data[4]),
+        .cumulative_lost = get_le32(&data[8]),
+        .jitter_ms = get_le32(&data[12]),
+    };
+    taskENTER_CRITICAL();
+    pending_feedback = feedback;
+    feedback_pending = true;
+    taskEXIT_CRITICAL();
+}
+
+bool udp_stream_take_feedback(udp_stream_feedback_t *feedback) {
+    bool available;
+    taskENTER_CRITICAL();
+    available = feedback_pending;
+    if (available) {
+        *feedback = pending_feedback;
+        feedback_pending = false;
+    }
+    taskEXIT_CRITICAL();
+    if (available) {
+        udp_stats.feedback_reports++;
+        udp_stats.last_feedback = *feedback;
+    }
+    return available;
+}
+
+void udp_stream_get_stats(udp_stream_stats_t *stats) {
+    *stats = udp_stats;
+}
@@ -0,0 +1,71 @@
+#ifndef UDP_STREAM_H_
+#define UDP_STREAM_H_
+
+#include "cy_result.h"
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+// 实时音频的 UDP 传输 (AUDIO_TRANSPORT_UDP)：每帧一个数据报，发往控制连接当前使用的代理的 AUDIO_UDP_PORT。
+// TCP 在 Wi-Fi 丢包时要等重传，后面的帧全部被挡住 (队头阻塞)；UDP 丢一帧只丢一帧，配合 FEC 校验包可就地恢复。
+//
+// 数据报 = 12 字节 RTP 报头 (RFC 3550，大端) + 16 字节帧头 + 负载，即 MQTT 路径的负载前加 RTP 报头：
+//   V=2，P=0，X=0，CC=0，M=0，
+//   PT = UDP_STREAM_PAYLOAD_TYPE_AUDIO (音频帧) 或 UDP_STREAM_PAYLOAD_TYPE_FEC (XOR 校验包，见 fec.h)，
+//   sequence number = 每个数据报加一 (含校验包)，接收端据此统计网络丢包和乱序，
+//   timestamp = 帧头 timestamp_ms * UDP_STREAM_RTP_CLOCK_KHZ (与输出采样率无关，切换档位时不跳变)，
+//   SSRC = 客户端 ID 的 FNV-1a 散列。
+// RTP 报头写在帧头前的 AUDIO_FRAME_HEADROOM 中，一次 cy_socket_sendto() 发出，不做拷贝。
+// 超过路径 MTU 的帧会被 IP 分片，任一分片丢失即整帧丢失，UDP 传输时建议帧长不超过 40 ms。
+//
+// 接收端反馈经已有的 MQTT 控制连接发布到 "MQTT_TOPIC_AUDIO_FEEDBACK/<客户端 ID>"，负载 16 字节 (小端，与帧头一致)：
+//   [0]      版本 = UDP_STREAM_FEEDBACK_VERSION
+//   [1]      fraction_lost：自上次报告以来的丢包比例 (x/256，FEC 恢复前，与 RTCP RR 相同)
+//   [2..3]   保留
+//   [4..7]   highest_sequence：收到的最大扩展 RTP 序号 (高 16 位为序号回绕次数)
+//   [8..11]  cumulative_lost：累计丢失的数据报数
+//   [12..15] jitter_ms：到达间隔抖动 (RFC 3550 第 6.4.1 节的算法，换算为毫秒)
+// 除 udp_stream_handle_feedback() 外只在网络任务中调用。
+
+#define UDP_STREAM_RTP_HEADER_SIZE       (12)
+#define UDP_STREAM_RTP_VERSION           (2)
+#define UDP_STREAM_PAYLOAD_TYPE_AUDIO    (96)   // 动态负载类型
+#define UDP_STREAM_PAYLOAD_TYPE_FEC      (97)
+#define UDP_STREAM_RTP_CLOCK_KHZ         (48)   // RTP 时间戳时钟 48 kHz
+#define UDP_STREAM_FEEDBACK_VERSION      (1)
+#define UDP_STREAM_FEEDBACK_SIZE         (16)
+
+typedef struct {
+    uint8_t  fraction_lost;     // x/256
+    uint32_t highest_sequence;
+    uint32_t cumulative_lost;
+    uint32_t jitter_ms;
+} udp_stream_feedback_t;
+
+typedef struct {
+    uint32_t datagrams_sent;    // 成功发出的数据报数 (含校验包)
+    uint32_t send_errors;       // 发送失败 (例如协议栈缓冲不足) 而丢弃的数据报数
+    uint32_t feedback_reports;  // 收到的有效接收端报告数
+    udp_stream_feedback_t last_feedback;
+} udp_stream_stats_t;
+
+// 解析接收端地址并创建 UDP 套接字。client_id 用于生成 SSRC。
+cy_rslt_t udp_stream_open(const char *receiver_host, const char *client_id);
+
+void udp_stream_close(void);
+
+bool udp_stream_is_open(void);
+
+// 发送一个数据报：payload 为帧头 + 负载，之前须有 AUDIO_FRAME_HEADROOM 字节可写。
+// 按帧头中的 FEC 标志选择负载类型。发送失败时计数并返回错误，不重试。
+cy_rslt_t udp_stream_send(uint8_t *payload, size_t payload_len);
+
+// 处理一条接收端反馈 (MQTT 回调上下文中调用)，格式不对时忽略
+void udp_stream_handle_feedback(const uint8_t *data, size_t len);
+
+// 取出自上次调用以来收到的最新反馈，没有新反馈时返回 false
+bool udp_stream_take_feedback(udp_stream_feedback_t *feedback);
+
+void udp_stream_get_stats(udp_stream_stats_t *stats);
+
+#endif /* UDP_STREAM_H_ */
@@ -2,6 +2,7 @@
 #include "app_config.h"
 #include "state_machine.h"
 #include "audio_task.h" // 用于 audio_set_mic_volume
+#include "boot_profile.h"
 
 #include "cyhal.h"
 #include "cybsp.h"
@@ -22,17 +23,22 @@
 // CapSense 任务定义 (来自示例)
 #define CAPSENSE_SCAN_INTERVAL_MS   (20u) // 扫描间隔
 static TimerHandle_t capsense_scan_timer_handle;
+static StaticTimer_t capsense_scan_timer_struct;
 
 // UI 任务中 CapSense 处理部分的内部命令枚举
 typedef enum {
     CAPSENSE_CMD_SCAN,    // 开始 CapSense 扫描的命令
     CAPSENSE_CMD_PROCESS  // 处理已扫描数据的命令
 } capsense_internal_cmd_t;
+#define CAPSENSE_CMD_QUEUE_LENGTH   (5)
 static QueueHandle_t capsense_internal_cmd_queue;
+static StaticQueue_t capsense_cmd_queue_struct;
+static uint8_t capsense_cmd_queue_storage[CAPSENSE_CMD_QUEUE_LENGTH * sizeof(capsense_internal_cmd_t)];
 
 // LED 控制变量
 static led_indicator_state_t current_led_state = LED_STATE_OFF;
 static TimerHandle_t led_blink_timer_handle = NULL;
+static StaticTimer_t led_blink_timer_struct;
 static bool led_state = false; // 如果 LED 物理上亮起，则为 true
 
 // 按钮 BTN1 长按检测变量
@@ -53,7 +59,8 @@ void ui_task(void *pvParameters) {
     (void)pvParameters;
     APP_LOG_UI_INFO("UI Task Started.");
 
-    capsense_internal_cmd_queue = xQueueCreate(5, sizeof(capsense_internal_cmd_t));
+    capsense_internal_cmd_queue = xQueueCreateStatic(CAPSENSE_CMD_QUEUE_LENGTH, sizeof(capsense_internal_cmd_t),
+                                                     capsense_cmd_queue_storage, &capsense_cmd_queue_struct);
     if (capsense_internal_cmd_queue == NULL) {
         APP_LOG_UI_ERROR("Failed to create CapSense internal command queue.");
         vTaskDelete(NULL);
@@ -61,11 +68,13 @@ void ui_task(void *pvParameters) {
     }
 
     // Initialize CapSense
+    boot_step_begin(BOOT_STEP_CAPSENSE);
     capsense_init();
+    boot_step_end(BOOT_STEP_CAPSENSE);
 
     // Create a timer for periodic CapSense scans
-    capsense_scan_timer_handle = xTimerCreate("CapScanTmr", pdMS_TO_TICKS(CAPSENSE_SCAN_INTERVAL_MS),
-                                              pdTRUE, (void *)0, capsense_timer_cb);
+    capsense_scan_timer_handle = xTimerCreateStatic("CapScanTmr", pdMS_TO_TICKS(CAPSENSE_SCAN_INTERVAL_MS),
+                                                    pdTRUE, (void *)0, capsense_timer_cb, &capsense_scan_timer_struct);
     if (capsense_scan_timer_handle == NULL) {
         APP_LOG_UI_ERROR("Failed to create CapSense scan timer.");
         // 在没有 capsense 的情况下继续或删除任务
@@ -75,8 +84,8 @@ void ui_task(void *pvParameters) {
 
     // Create a timer for LED blinking patterns
     // 初始停止，周期将在闪烁开始时设置
-    led_blink_timer_handle = xTimerCreate("LedBlinkTmr", pdMS_TO_TICKS(1000), 
-                                           pdTRUE, (void *)0, led_timer_callback);
+    led_blink_timer_handle = xTimerCreateStatic("LedBlinkTmr", pdMS_TO_TICKS(1000),
+                                                 pdTRUE, (void *)0, led_timer_callback, &led_blink_timer_struct);
     if (led_blink_timer_handle == NULL) {
         APP_LOG_UI_ERROR("Failed to create LED blink timer.");
     } else {
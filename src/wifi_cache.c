@@ -0,0 +1,77 @@
+#include "wifi_cache.h"
+#include <stddef.h>
+#include <string.h>
+
+#define FNV_OFFSET_BASIS (2166136261u)
+#define FNV_PRIME        (16777619u)
+
+static uint32_t fnv1a(uint32_t hash, const void *data, size_t len) {
+    const uint8_t *p = data;
+    for (size_t i = 0; i < len; i++) {
+        hash = (hash ^ p[i]) * FNV_PRIME;
+    }
+    return hash;
+}
+
+static uint32_t record_checksum(const wifi_cache_record_t *rec) {
+    return fnv1a(FNV_OFFSET_BASIS, rec, offsetof(wifi_cache_record_t, checksum));
+}
+
+static void seal(wifi_cache_record_t *rec) {
+    rec->checksum = record_checksum(rec);
+}
+
+uint32_t wifi_cache_credentials_hash(const char *ssid, const char *password, uint32_t security) {
+    uint32_t hash = fnv1a(FNV_OFFSET_BASIS, ssid, strlen(ssid) + 1u);     // 含结尾的 '\0'，"ab"+"c" 与 "a"+"bc" 不同
+    hash = fnv1a(hash, password, strlen(password) + 1u);
+    return fnv1a(hash, &security, sizeof(security));
+}
+
+bool wifi_cache_is_valid(const wifi_cache_record_t *rec, uint32_t credentials_hash) {
+    static const uint8_t zero_bssid[6] = { 0 };
+    return rec->magic == WIFI_CACHE_MAGIC && rec->checksum == record_checksum(rec) &&
+           rec->credentials_hash == credentials_hash && memcmp(rec->bssid, zero_bssid, sizeof(zero_bssid)) != 0;
+}
+
+wifi_cache_plan_t wifi_cache_plan(const wifi_cache_record_t *rec, uint32_t credentials_hash) {
+    if (!wifi_cache_is_valid(rec, credentials_hash)) {
+        return WIFI_CACHE_PLAN_SCAN;
+    }
+    if (rec->ip != 0 && rec->ip_reuses < WIFI_CACHE_MAX_IP_REUSES) {
+        return WIFI_CACHE_PLAN_DIRECTED_STATIC;
+    }
+    return WIFI_CACHE_PLAN_DIRECTED;
+}
+
+bool wifi_cache_update(wifi_cache_record_t *rec, uint32_t credentials_hash, const uint8_t bssid[6], uint8_t channel,
+                       uint8_t band, uint32_t ip, uint32_t netmask, uint32_t gateway, bool used_static) {
+    wifi_cache_record_t next;
+    memset(&next, 0, sizeof(next));
+    next.magic = WIFI_CACHE_MAGIC;
+    next.credentials_hash = credentials_hash;
+    memcpy(next.bssid, bssid, sizeof(next.bssid));
+    next.channel = channel;
+    next.band = band;
+    next.ip = ip;
+    next.netmask = netmask;
+    next.gateway = gateway;
+    // 复用租约时累加次数；DHCP 拿到新租约时从 0 开始
+    next.ip_reuses = (used_static && wifi_cache_is_valid(rec, credentials_hash) && rec->ip == ip) ? (uint16_t)(rec->ip_reuses + 1u) : 0u;
+    seal(&next);
+    // 复用计数之前的字段 (凭证、AP、租约) 才是需要持久保存的内容
+    bool changed = memcmp(&next, rec, offsetof(wifi_cache_record_t, ip_reuses)) != 0;
+    *rec = next;
+    return changed;
+}
+
+bool wifi_cache_drop_lease(wifi_cache_record_t *rec) {
+    if (rec->magic != WIFI_CACHE_MAGIC || rec->ip == 0) {
+        return false;
+    }
+    rec->ip = 0;
+    rec->netmask = 0;
+    rec->gateway = 0;
+    rec->ip_reuses = 0;
+    seal(rec);
+    return true;
+}
@@ -0,0 +1,55 @@
+#ifndef WIFI_CACHE_H_
+#define WIFI_CACHE_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// Wi-Fi 快速重连：记住最近一次成功关联的 AP (BSSID、信道、频段) 和 DHCP 租约 (IP、掩码、网关)，保存在非易失存储中。
+// 下次连接 (开机或断线后) 先用 BSSID 直接关联，跳过全信道扫描；租约还可用时作为静态 IP 传给 WCM，跳过 DHCP。
+// 直接关联失败时回退到扫描，记录保留 (AP 可能只是暂时不在)，扫描连上另一台 AP 后被覆盖；
+// 用缓存 IP 连上 Wi-Fi 后代理一个都连不上时只丢弃租约，重新走 DHCP。
+// 租约没有可靠的到期时间 (WCM 不提供租期，设备没有实时时钟)，因此最多连续复用 WIFI_CACHE_MAX_IP_REUSES 次，
+// 之后做一次 DHCP 刷新。复用计数只在内存中累加，不触发写存储 (否则 Wi-Fi 反复断线时每次重连都要擦写闪存)，
+// 重启后从上次写入时的值开始。SSID、密码或安全类型变化时记录失效。
+// 与 fec.c 一样不依赖 RTOS 和 WCM，读写存储由调用者负责。
+
+#define WIFI_CACHE_MAGIC            (0x57464331u)   // "WFC1"，记录格式变化时修改
+#define WIFI_CACHE_MAX_IP_REUSES    (8)
+
+typedef enum {
+    WIFI_CACHE_PLAN_SCAN,           // 没有可用记录：扫描 + DHCP
+    WIFI_CACHE_PLAN_DIRECTED,       // 直接关联缓存的 BSSID，DHCP
+    WIFI_CACHE_PLAN_DIRECTED_STATIC // 直接关联缓存的 BSSID，复用缓存的租约
+} wifi_cache_plan_t;
+
+// 按原样写入存储，字段顺序和大小不随编译器变化
+typedef struct {
+    uint32_t magic;
+    uint32_t credentials_hash;      // SSID、密码和安全类型的 FNV-1a
+    uint8_t bssid[6];
+    uint8_t channel;
+    uint8_t band;                   // cy_wcm_wifi_band_t 的值
+    uint32_t ip;                    // IPv4，与 WCM 相同的网络字节序，0 表示没有租约
+    uint32_t netmask;
+    uint32_t gateway;
+    uint16_t ip_reuses;             // 上次 DHCP 之后复用租约的次数，单独变化时不写回存储
+    uint16_t reserved;
+    uint32_t checksum;              // 以上字段的 FNV-1a
+} wifi_cache_record_t;
+
+uint32_t wifi_cache_credentials_hash(const char *ssid, const char *password, uint32_t security);
+
+// 从存储读出的记录是否完整且属于当前凭证
+bool wifi_cache_is_valid(const wifi_cache_record_t *rec, uint32_t credentials_hash);
+
+wifi_cache_plan_t wifi_cache_plan(const wifi_cache_record_t *rec, uint32_t credentials_hash);
+
+// 关联成功后更新记录 (ip 为 0 表示还没有地址)，used_static 表示本次复用了缓存的租约。
+// 返回 true 时 AP 或租约有变化，需要写回存储；只有复用计数变化时返回 false。
+bool wifi_cache_update(wifi_cache_record_t *rec, uint32_t credentials_hash, const uint8_t bssid[6], uint8_t channel,
+                       uint8_t band, uint32_t ip, uint32_t netmask, uint32_t gateway, bool used_static);
+
+// 复用的租约不可用：只清除 IP，下次直接关联后走 DHCP。返回 true 时需要写回存储。
+bool wifi_cache_drop_lease(wifi_cache_record_t *rec);
+
+#endif /* WIFI_CACHE_H_ */
@@ -0,0 +1,428 @@
+// 测量用的本地 MQTT 3.1.1 代理：没有 mosquitto 的主机上也能运行 loadgen、soak 和 receiver。
+// 单线程 poll()，只实现 host_mqtt.c 和设备 (cy_mqtt、mqtt_stream.c) 用到的报文：CONNECT/CONNACK、
+// PUBLISH (QoS0/QoS1，收到 QoS1 回复 PUBACK)、SUBSCRIBE/SUBACK (支持 + 和 # 通配)、PINGREQ/PINGRESP、DISCONNECT。
+// 转发给订阅者一律用 QoS0；不保存会话，clean session = 0 的连接也按新会话处理 (CONNACK 的 session present 为 0)。
+// 相同客户端 ID 的新连接踢掉旧连接，与 MQTT 3.1.1 一致。
+// -l 时按给定百分比随机丢弃转发的 PUBLISH (每个订阅者独立)，用于检查接收端的 FEC 恢复。
+// 每 -i 秒和退出 (SIGINT/SIGTERM) 时打印收发的 PUBLISH 数、字节数 (MQTT 层，不含 TCP/IP 头) 和本进程的 CPU 时间。
+//
+// 构建 (主机，在仓库根目录)：
+//   cc -O2 -o broker tools/host/broker.c
+// 运行：
+//   ./broker -p 1883 -i 10            # 在 1883 端口监听，每 10 秒打印一次统计
+
+#include <errno.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <signal.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <time.h>
+#include <unistd.h>
+
+#define BROKER_MAX_CLIENTS          (512)
+#define BROKER_MAX_PACKET           (64 * 1024)
+#define BROKER_MAX_SUBSCRIPTIONS    (8)     // 每个连接的主题过滤器数
+#define BROKER_MAX_TOPIC            (128)
+#define BROKER_SEND_TIMEOUT_MS      (1000)  // 订阅者接收缓冲满这么久仍发不出时断开它
+
+typedef struct {
+    int fd;
+    bool connected;                 // 已收到 CONNECT
+    char client_id[64];
+    char filters[BROKER_MAX_SUBSCRIPTIONS][BROKER_MAX_TOPIC];
+    uint32_t filter_count;
+    uint8_t *rx;
+    size_t rx_len;
+} broker_client_t;
+
+typedef struct {
+    uint64_t connects;
+    uint64_t publishes_in;
+    uint64_t bytes_in;
+    uint64_t publishes_out;
+    uint64_t bytes_out;
+    uint64_t pubacks_sent;
+    uint64_t dropped;               // -l 丢弃的转发
+} broker_stats_t;
+
+static broker_client_t *clients[BROKER_MAX_CLIENTS];
+static struct pollfd pollfds[BROKER_MAX_CLIENTS + 1];
+static broker_stats_t stats;
+static volatile sig_atomic_t stopping;
+static double loss_percent;
+static unsigned int loss_seed = 1u;
+
+static uint32_t now_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint32_t)((uint64_t)ts.tv_sec * 1000u + (uint64_t)ts.tv_nsec / 1000000u);
+}
+
+static void on_signal(int sig) {
+    (void)sig;
+    stopping = 1;
+}
+
+static void close_client(uint32_t slot) {
+    broker_client_t *c = clients[slot];
+    close(c->fd);
+    free(c->rx);
+    free(c);
+    clients[slot] = NULL;
+}
+
+static bool send_all(broker_client_t *c, const uint8_t *data, size_t len) {
+    while (len > 0) {
+        ssize_t n = send(c->fd, data, len, MSG_NOSIGNAL);
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return false;
+        }
+        data += n;
+        len -= (size_t)n;
+    }
+    return true;
+}
+
+// MQTT 3.1.1 主题过滤器匹配：+ 匹配一级，# 匹配其余所有级
+static bool topic_matches(const char *filter, const char *topic) {
+    while (*filter != '\0') {
+        if (*filter == '#') {
+            return true;
+        }
+        if (*filter == '+') {
+            while (*topic != '\0' && *topic != '/') {
+                topic++;
+            }
+            filter++;
+            continue;
+        }
+        if (*filter != *topic) {
+            return false;
+        }
+        filter++;
+        topic++;
+    }
+    return *topic == '\0';
+}
+
+// 把一条 PUBLISH 以 QoS0 转发给所有匹配的订阅者 (一条消息只发给每个连接一次)
+static void forward(const char *topic, size_t topic_len, const uint8_t *payload, size_t payload_len) {
+    static uint8_t packet[BROKER_MAX_PACKET + 16];
+    size_t remaining = 2u + topic_len + payload_len;
+    size_t n = 0;
+    packet[n++] = 0x30;
+    size_t len = remaining;
+    do {
+        uint8_t byte = (uint8_t)(len % 128u);
+        len /= 128u;
+        packet[n++] = (uint8_t)(byte | ((len > 0) ? 0x80u : 0u));
+    } while (len > 0);
+    packet[n++] = (uint8_t)(topic_len >> 8);
+    packet[n++] = (uint8_t)topic_len;
+    memcpy(&packet[n], topic, topic_len);
+    n += topic_len;
+    if (n + payload_len > sizeof(packet)) {
+        return;
+    }
+    memcpy(&packet[n], payload, payload_len);
+    n += payload_len;
+
+    for (uint32_t slot = 0; slot < BROKER_MAX_CLIENTS; slot++) {
+        broker_client_t *c = clients[slot];
+        if (c == NULL || !c->connected) {
+            continue;
+        }
+        for (uint32_t f = 0; f < c->filter_count; f++) {
+            if (topic_matches(c->filters[f], topic)) {
+                if (loss_percent > 0.0 && rand_r(&loss_seed) < loss_percent / 100.0 * ((double)RAND_MAX + 1.0)) {
+                    stats.dropped++;
+                } else if (send_all(c, packet, n)) {
+                    stats.publishes_out++;
+                    stats.bytes_out += n;
+                } else {
+                    close_client(slot);
+                }
+                break;
+            }
+        }
+    }
+}
+
+static bool read_string(const uint8_t *body, size_t body_len, size_t *pos, char *out, size_t out_size) {
+    if (*pos + 2u > body_len) {
+        return false;
+    }
+    size_t len = ((size_t)body[*pos] << 8) | body[*pos + 1u];
+    if (*pos + 2u + len > body_len || len >= out_size) {
+        return false;
+    }
+    memcpy(out, &body[*pos + 2u], len);
+    out[len] = '\0';
+    *pos += 2u + len;
+    return true;
+}
+
+// 处理一个完整报文，返回 false 时断开连接
+static bool handle_packet(uint32_t slot, uint8_t first, const uint8_t *body, size_t body_len) {
+    broker_client_t *c = clients[slot];
+    uint8_t type = (uint8_t)(first >> 4);
+    if (!c->connected && type != 1) {
+        return false;
+    }
+    switch (type) {
+        case 1: {   // CONNECT
+            size_t pos = 0;
+            char protocol[8];
+            if (!read_string(body, body_len, &pos, protocol, sizeof(protocol)) || pos + 4u > body_len) {
+                return false;
+            }
+            pos += 4u;  // 协议级别、连接标志、keep-alive
+            if (!read_string(body, body_len, &pos, c->client_id, sizeof(c->client_id))) {
+                return false;
+            }
+            for (uint32_t other = 0; other < BROKER_MAX_CLIENTS; other++) {
+                if (other != slot && clients[other] != NULL && clients[other]->connected &&
+                    strcmp(clients[other]->client_id, c->client_id) == 0) {
+                    close_client(other);
+                }
+            }
+            c->connected = true;
+            stats.connects++;
+            static const uint8_t connack[4] = { 0x20, 0x02, 0x00, 0x00 };
+            return send_all(c, connack, sizeof(connack));
+        }
+        case 3: {   // PUBLISH
+            uint8_t qos = (uint8_t)((first >> 1) & 0x03u);
+            if (body_len < 2u) {
+                return false;
+            }
+            size_t topic_len = ((size_t)body[0] << 8) | body[1];
+            size_t id_len = (qos > 0) ? 2u : 0u;
+            if (topic_len >= BROKER_MAX_TOPIC || 2u + topic_len + id_len > body_len) {
+                return false;
+            }
+            char topic[BROKER_MAX_TOPIC];
+            memcpy(topic, &body[2], topic_len);
+            topic[topic_len] = '\0';
+            stats.publishes_in++;
+            if (qos > 0) {
+                uint8_t puback[4] = { 0x40, 0x02, body[2u + topic_len], body[3u + topic_len] };
+                if (!send_all(c, puback, sizeof(puback))) {
+                    return false;
+                }
+                stats.pubacks_sent++;
+            }
+            size_t offset = 2u + topic_len + id_len;
+            forward(topic, topic_len, &body[offset], body_len - offset);
+            return clients[slot] != NULL;
+        }
+        case 8: {   // SUBSCRIBE
+            if (body_len < 2u) {
+                return false;
+            }
+            size_t pos = 2u;
+            uint8_t suback[4 + BROKER_MAX_SUBSCRIPTIONS] = { 0x90, 0x02, body[0], body[1] };
+            size_t n = 4u;
+            while (pos < body_len && n < sizeof(suback)) {
+                char filter[BROKER_MAX_TOPIC];
+                if (!read_string(body, body_len, &pos, filter, sizeof(filter)) || pos >= body_len) {
+                    return false;
+                }
+                pos++;  // 请求的 QoS
+                bool granted = c->filter_count < BROKER_MAX_SUBSCRIPTIONS;
+                if (granted) {
+                    strcpy(c->filters[c->filter_count++], filter);
+                }
+                suback[n++] = granted ? 0x00 : 0x80;
+            }
+            suback[1] = (uint8_t)(n - 2u);
+            return send_all(c, suback, n);
+        }
+        case 12: {  // PINGREQ
+            static const uint8_t pingresp[2] = { 0xD0, 0x00 };
+            return send_all(c, pingresp, sizeof(pingresp));
+        }
+        case 4:     // PUBACK (转发只用 QoS0，不会收到，忽略)
+        case 10:    // UNSUBSCRIBE 不需要，忽略
+            return true;
+        case 14:    // DISCONNECT
+        default:
+            return false;
+    }
+}
+
+// 读取一个连接上已到达的数据并处理其中的完整报文
+static void service_client(uint32_t slot) {
+    broker_client_t *c = clients[slot];
+    ssize_t n = recv(c->fd, &c->rx[c->rx_len], BROKER_MAX_PACKET + 8u - c->rx_len, 0);
+    if (n <= 0) {
+        if (n < 0 && (errno == EINTR || errno == EAGAIN)) {
+            return;
+        }
+        close_client(slot);
+        return;
+    }
+    c->rx_len += (size_t)n;
+    stats.bytes_in += (uint64_t)n;
+
+    size_t used = 0;
+    for (;;) {
+        size_t avail = c->rx_len - used;
+        size_t remaining = 0;
+        size_t header_len = 0;
+        uint32_t multiplier = 1;
+        for (size_t i = 1; i < 5 && i < avail; i++) {
+            remaining += (size_t)(c->rx[used + i] & 0x7Fu) * multiplier;
+            multiplier *= 128u;
+            if ((c->rx[used + i] & 0x80u) == 0) {
+                header_len = i + 1u;
+                break;
+            }
+        }
+        if (header_len == 0) {
+            if (avail >= 5u) {
+                close_client(slot);   // 剩余长度超过 4 字节
+                return;
+            }
+            break;
+        }
+        if (header_len + remaining > BROKER_MAX_PACKET) {
+            close_client(slot);
+            return;
+        }
+        if (avail < header_len + remaining) {
+            break;
+        }
+        if (!handle_packet(slot, c->rx[used], &c->rx[used + header_len], remaining)) {
+            if (clients[slot] != NULL) {
+                close_client(slot);
+            }
+            return;
+        }
+        used += header_len + remaining;
+    }
+    if (used > 0) {
+        memmove(c->rx, &c->rx[used], c->rx_len - used);
+        c->rx_len -= used;
+    }
+}
+
+static void accept_client(int listen_fd) {
+    int fd = accept(listen_fd, NULL, NULL);
+    if (fd < 0) {
+        return;
+    }
+    for (uint32_t slot = 0; slot < BROKER_MAX_CLIENTS; slot++) {
+        if (clients[slot] == NULL) {
+            broker_client_t *c = calloc(1, sizeof(*c));
+            c->rx = malloc(BROKER_MAX_PACKET + 8u);
+            c->fd = fd;
+            int one = 1;
+            setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+            struct timeval tv = { .tv_sec = BROKER_SEND_TIMEOUT_MS / 1000, .tv_usec = (BROKER_SEND_TIMEOUT_MS % 1000) * 1000 };
+            setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &tv, sizeof(tv));
+            clients[slot] = c;
+            return;
+        }
+    }
+    close(fd);
+}
+
+static void print_stats(const char *label, uint32_t elapsed_ms) {
+    struct rusage ru;
+    getrusage(RUSAGE_SELF, &ru);
+    double cpu_s = ru.ru_utime.tv_sec + ru.ru_stime.tv_sec + (ru.ru_utime.tv_usec + ru.ru_stime.tv_usec) / 1e6;
+    uint32_t open = 0;
+    for (uint32_t slot = 0; slot < BROKER_MAX_CLIENTS; slot++) {
+        open += (clients[slot] != NULL) ? 1u : 0u;
+    }
+    printf("[%s] t=%.1fs clients=%u connects=%llu in=%llu publish %.1f MB out=%llu publish %.1f MB pubacks=%llu dropped=%llu "
+           "cpu=%.2fs (%.1f%% of one core)\n",
+           label, elapsed_ms / 1000.0, open, (unsigned long long)stats.connects, (unsigned long long)stats.publishes_in,
+           stats.bytes_in / 1e6, (unsigned long long)stats.publishes_out, stats.bytes_out / 1e6,
+           (unsigned long long)stats.pubacks_sent, (unsigned long long)stats.dropped, cpu_s, (elapsed_ms > 0) ? 100.0 * cpu_s * 1000.0 / elapsed_ms : 0.0);
+    fflush(stdout);
+}
+
+int main(int argc, char **argv) {
+    uint16_t port = 1883;
+    uint32_t interval_s = 0;
+    int opt;
+    while ((opt = getopt(argc, argv, "p:i:l:")) != -1) {
+        switch (opt) {
+            case 'p': port = (uint16_t)atoi(optarg); break;
+            case 'i': interval_s = (uint32_t)atoi(optarg); break;
+            case 'l': loss_percent = atof(optarg); break;
+            default:
+                fprintf(stderr, "usage: %s [-p port] [-i report_interval_s] [-l loss_percent]\n", argv[0]);
+                return 2;
+        }
+    }
+
+    int listen_fd = socket(AF_INET, SOCK_STREAM, 0);
+    int one = 1;
+    setsockopt(listen_fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+    struct sockaddr_in addr = { .sin_family = AF_INET, .sin_port = htons(port), .sin_addr.s_addr = htonl(INADDR_ANY) };
+    if (bind(listen_fd, (struct sockaddr *)&addr, sizeof(addr)) != 0 || listen(listen_fd, 128) != 0) {
+        perror("broker: bind/listen");
+        return 1;
+    }
+    signal(SIGINT, on_signal);
+    signal(SIGTERM, on_signal);
+    signal(SIGPIPE, SIG_IGN);
+
+    uint32_t start = now_ms();
+    uint32_t last_report = start;
+    while (!stopping) {
+        uint32_t slots[BROKER_MAX_CLIENTS];
+        nfds_t count = 1;
+        pollfds[0] = (struct pollfd){ .fd = listen_fd, .events = POLLIN };
+        for (uint32_t slot = 0; slot < BROKER_MAX_CLIENTS; slot++) {
+            if (clients[slot] != NULL) {
+                pollfds[count] = (struct pollfd){ .fd = clients[slot]->fd, .events = POLLIN };
+                slots[count - 1u] = slot;
+                count++;
+            }
+        }
+        int ready = poll(pollfds, count, 200);
+        if (ready < 0 && errno != EINTR) {
+            perror("broker: poll");
+            break;
+        }
+        if (ready > 0) {
+            for (nfds_t i = 1; i < count; i++) {
+                // 之前的转发可能已经断开了这个连接
+                if ((pollfds[i].revents & (POLLIN | POLLHUP | POLLERR)) && clients[slots[i - 1u]] != NULL &&
+                    clients[slots[i - 1u]]->fd == pollfds[i].fd) {
+                    service_client(slots[i - 1u]);
+                }
+            }
+            if (pollfds[0].revents & POLLIN) {
+                accept_client(listen_fd);
+            }
+        }
+        uint32_t now = now_ms();
+        if (interval_s > 0 && (now - last_report) >= interval_s * 1000u) {
+            print_stats("broker", now - start);
+            last_report = now;
+        }
+    }
+    print_stats("broker", now_ms() - start);
+    for (uint32_t slot = 0; slot < BROKER_MAX_CLIENTS; slot++) {
+        if (clients[slot] != NULL) {
+            close_client(slot);
+        }
+    }
+    close(listen_fd);
+    return 0;
+}
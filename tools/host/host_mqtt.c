@@ -0,0 +1,281 @@
+#include "host_mqtt.h"
+#include <errno.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <time.h>
+#include <unistd.h>
+
+uint32_t host_now_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint32_t)((uint64_t)ts.tv_sec * 1000u + (uint64_t)ts.tv_nsec / 1000000u);
+}
+
+static size_t put_remaining_length(uint8_t *p, size_t len) {
+    size_t n = 0;
+    do {
+        uint8_t byte = (uint8_t)(len % 128u);
+        len /= 128u;
+        if (len > 0) {
+            byte |= 0x80u;
+        }
+        p[n++] = byte;
+    } while (len > 0);
+    return n;
+}
+
+static size_t put_string(uint8_t *p, const char *s, size_t len) {
+    p[0] = (uint8_t)(len >> 8);
+    p[1] = (uint8_t)len;
+    memcpy(&p[2], s, len);
+    return len + 2u;
+}
+
+static int send_all(host_mqtt_t *c, const uint8_t *data, size_t len) {
+    while (len > 0) {
+        ssize_t n = send(c->fd, data, len, MSG_NOSIGNAL);
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return -1;
+        }
+        data += n;
+        len -= (size_t)n;
+    }
+    return 0;
+}
+
+static uint16_t next_packet_id(host_mqtt_t *c) {
+    if (++c->next_packet_id == 0) {
+        c->next_packet_id = 1;
+    }
+    return c->next_packet_id;
+}
+
+static int open_socket(const char *host, uint16_t port, uint32_t timeout_ms) {
+    char port_str[8];
+    snprintf(port_str, sizeof(port_str), "%u", port);
+    struct addrinfo hints = { .ai_family = AF_UNSPEC, .ai_socktype = SOCK_STREAM };
+    struct addrinfo *res = NULL;
+    if (getaddrinfo(host, port_str, &hints, &res) != 0) {
+        errno = EHOSTUNREACH;
+        return -1;
+    }
+    int fd = -1;
+    for (struct addrinfo *ai = res; ai != NULL; ai = ai->ai_next) {
+        fd = socket(ai->ai_family, ai->ai_socktype, ai->ai_protocol);
+        if (fd < 0) {
+            continue;
+        }
+        struct timeval tv = { .tv_sec = timeout_ms / 1000u, .tv_usec = (timeout_ms % 1000u) * 1000u };
+        setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &tv, sizeof(tv));
+        if (connect(fd, ai->ai_addr, ai->ai_addrlen) == 0) {
+            break;
+        }
+        close(fd);
+        fd = -1;
+    }
+    freeaddrinfo(res);
+    if (fd >= 0) {
+        // 与设备一样每帧一个报文，关闭 Nagle 避免小帧被攒批，否则测得的延迟偏大
+        int one = 1;
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+    }
+    return fd;
+}
+
+int host_mqtt_connect(host_mqtt_t *c, const char *host, uint16_t port, const char *client_id,
+                      uint16_t keep_alive_sec, uint32_t timeout_ms, int *reason) {
+    c->fd = open_socket(host, port, timeout_ms);
+    c->next_packet_id = 0;
+    c->rx_len = 0;
+    c->rx_used = 0;
+    if (c->fd < 0) {
+        if (reason != NULL) {
+            *reason = errno;
+        }
+        return -1;
+    }
+
+    uint8_t packet[128];
+    size_t id_len = strnlen(client_id, 64);
+    size_t remaining = 10u + 2u + id_len;
+    size_t n = 0;
+    packet[n++] = 0x10;
+    n += put_remaining_length(&packet[n], remaining);
+    n += put_string(&packet[n], "MQTT", 4);
+    packet[n++] = 4;        // 协议级别 3.1.1
+    packet[n++] = 0x02;     // Clean Session
+    packet[n++] = (uint8_t)(keep_alive_sec >> 8);
+    packet[n++] = (uint8_t)keep_alive_sec;
+    n += put_string(&packet[n], client_id, id_len);
+
+    host_mqtt_message_t msg = { 0 };
+    if (send_all(c, packet, n) != 0 || host_mqtt_read(c, timeout_ms, &msg) != 1 || msg.type != HOST_MQTT_CONNACK ||
+        msg.payload_len != 2 || msg.payload[1] != 0) {
+        if (reason != NULL) {
+            *reason = (msg.type == HOST_MQTT_CONNACK && msg.payload_len == 2) ? msg.payload[1] : ETIMEDOUT;
+        }
+        host_mqtt_close(c);
+        return -1;
+    }
+    return 0;
+}
+
+void host_mqtt_close(host_mqtt_t *c) {
+    if (c->fd >= 0) {
+        static const uint8_t disconnect[2] = { 0xE0, 0x00 };
+        send(c->fd, disconnect, sizeof(disconnect), MSG_NOSIGNAL);
+        close(c->fd);
+        c->fd = -1;
+    }
+}
+
+int host_mqtt_publish(host_mqtt_t *c, const char *topic, const uint8_t *payload, size_t len, uint8_t qos) {
+    static __thread uint8_t packet[HOST_MQTT_MAX_PACKET];
+    size_t topic_len = strlen(topic);
+    size_t remaining = 2u + topic_len + ((qos > 0) ? 2u : 0u) + len;
+    if (remaining + 5u > sizeof(packet)) {
+        return -1;
+    }
+    size_t n = 0;
+    packet[n++] = (uint8_t)(0x30 | (qos << 1));
+    n += put_remaining_length(&packet[n], remaining);
+    n += put_string(&packet[n], topic, topic_len);
+    uint16_t packet_id = 0;
+    if (qos > 0) {
+        packet_id = next_packet_id(c);
+        packet[n++] = (uint8_t)(packet_id >> 8);
+        packet[n++] = (uint8_t)packet_id;
+    }
+    memcpy(&packet[n], payload, len);
+    n += len;
+    return (send_all(c, packet, n) == 0) ? packet_id : -1;
+}
+
+int host_mqtt_subscribe(host_mqtt_t *c, const char *topic_filter, uint8_t qos) {
+    uint8_t packet[300];
+    size_t topic_len = strnlen(topic_filter, 255);
+    size_t n = 0;
+    packet[n++] = 0x82;
+    n += put_remaining_length(&packet[n], 2u + 2u + topic_len + 1u);
+    uint16_t packet_id = next_packet_id(c);
+    packet[n++] = (uint8_t)(packet_id >> 8);
+    packet[n++] = (uint8_t)packet_id;
+    n += put_string(&packet[n], topic_filter, topic_len);
+    packet[n++] = qos;
+    return send_all(c, packet, n);
+}
+
+int host_mqtt_ping(host_mqtt_t *c) {
+    static const uint8_t pingreq[2] = { 0xC0, 0x00 };
+    return send_all(c, pingreq, sizeof(pingreq));
+}
+
+// rx 中有完整报文时返回其总长度并写出报头长度，不完整时返回 0，格式错误返回 -1
+static long complete_packet(const host_mqtt_t *c, size_t *header_len) {
+    size_t remaining = 0;
+    uint32_t multiplier = 1;
+    for (size_t i = 1; i < 5; i++) {
+        if (i >= c->rx_len) {
+            return 0;
+        }
+        remaining += (size_t)(c->rx[i] & 0x7Fu) * multiplier;
+        multiplier *= 128u;
+        if ((c->rx[i] & 0x80u) == 0) {
+            *header_len = i + 1u;
+            size_t total = *header_len + remaining;
+            if (total > sizeof(c->rx)) {
+                return -1;
+            }
+            return (c->rx_len >= total) ? (long)total : 0;
+        }
+    }
+    return -1;
+}
+
+static int parse_packet(host_mqtt_t *c, size_t header_len, size_t total, host_mqtt_message_t *msg) {
+    const uint8_t *body = &c->rx[header_len];
+    size_t body_len = total - header_len;
+    memset(msg, 0, sizeof(*msg));
+    msg->type = (uint8_t)(c->rx[0] >> 4);
+    msg->qos = (uint8_t)((c->rx[0] >> 1) & 0x03u);
+    msg->payload = body;
+    msg->payload_len = body_len;
+    if (msg->type == HOST_MQTT_PUBLISH) {
+        if (body_len < 2) {
+            return -1;
+        }
+        size_t topic_len = ((size_t)body[0] << 8) | body[1];
+        size_t id_len = (msg->qos > 0) ? 2u : 0u;
+        if (2u + topic_len + id_len > body_len) {
+            return -1;
+        }
+        size_t copy_len = (topic_len < sizeof(msg->topic)) ? topic_len : sizeof(msg->topic) - 1u;
+        memcpy(msg->topic, &body[2], copy_len);
+        if (id_len > 0) {
+            msg->packet_id = (uint16_t)((body[2 + topic_len] << 8) | body[3 + topic_len]);
+            uint8_t puback[4] = { 0x40, 0x02, (uint8_t)(msg->packet_id >> 8), (uint8_t)msg->packet_id };
+            if (send_all(c, puback, sizeof(puback)) != 0) {
+                return -1;
+            }
+        }
+        msg->payload = &body[2 + topic_len + id_len];
+        msg->payload_len = body_len - 2u - topic_len - id_len;
+    } else if ((msg->type == HOST_MQTT_PUBACK || msg->type == HOST_MQTT_SUBACK) && body_len >= 2) {
+        msg->packet_id = (uint16_t)((body[0] << 8) | body[1]);
+    }
+    return 1;
+}
+
+int host_mqtt_read(host_mqtt_t *c, uint32_t timeout_ms, host_mqtt_message_t *msg) {
+    if (c->fd < 0) {
+        return -1;
+    }
+    if (c->rx_used > 0) {
+        memmove(c->rx, &c->rx[c->rx_used], c->rx_len - c->rx_used);
+        c->rx_len -= c->rx_used;
+        c->rx_used = 0;
+    }
+
+    uint32_t start = host_now_ms();
+    for (;;) {
+        size_t header_len = 0;
+        long total = complete_packet(c, &header_len);
+        if (total < 0) {
+            return -1;
+        }
+        if (total > 0) {
+            c->rx_used = (size_t)total;
+            return parse_packet(c, header_len, (size_t)total, msg);
+        }
+
+        // timeout_ms 为 0 时也检查一次套接字，用于在发布间隙取走已到达的报文
+        uint32_t elapsed = host_now_ms() - start;
+        struct pollfd pfd = { .fd = c->fd, .events = POLLIN };
+        int ready = poll(&pfd, 1, (elapsed >= timeout_ms) ? 0 : (int)(timeout_ms - elapsed));
+        if (ready < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return -1;
+        }
+        if (ready == 0) {
+            return 0;
+        }
+        ssize_t n = recv(c->fd, &c->rx[c->rx_len], sizeof(c->rx) - c->rx_len, 0);
+        if (n <= 0) {
+            if (n < 0 && (errno == EINTR || errno == EAGAIN)) {
+                continue;
+            }
+            return -1;
+        }
+        c->rx_len += (size_t)n;
+    }
+}
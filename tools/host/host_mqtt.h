@@ -0,0 +1,59 @@
+#ifndef HOST_MQTT_H_
+#define HOST_MQTT_H_
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+// 主机工具用的最小 MQTT 3.1.1 客户端 (POSIX 套接字，阻塞 I/O + 超时)，只实现负载测试和接收端需要的报文：
+// CONNECT/CONNACK、PUBLISH (QoS0/QoS1)、PUBACK、SUBSCRIBE/SUBACK、PINGREQ/PINGRESP、DISCONNECT。
+// 与设备上的 mqtt_stream.c 相同，报文在本地拼好后一次发送。一个连接只在一个线程中使用。
+
+#define HOST_MQTT_MAX_PACKET      (64 * 1024)
+
+#define HOST_MQTT_CONNACK         (2)
+#define HOST_MQTT_PUBLISH         (3)
+#define HOST_MQTT_PUBACK          (4)
+#define HOST_MQTT_SUBACK          (9)
+#define HOST_MQTT_PINGRESP        (13)
+
+typedef struct {
+    int fd;
+    uint16_t next_packet_id;
+    uint8_t rx[HOST_MQTT_MAX_PACKET];
+    size_t rx_len;                  // rx 中已收到的字节数
+    size_t rx_used;                 // 上一次返回的报文长度，下一次读取时移出
+} host_mqtt_t;
+
+// host_mqtt_read() 返回的报文，payload 指向连接的接收缓冲，下一次读取前有效
+typedef struct {
+    uint8_t type;                   // HOST_MQTT_*
+    uint8_t qos;
+    uint16_t packet_id;
+    char topic[256];
+    const uint8_t *payload;
+    size_t payload_len;
+} host_mqtt_message_t;
+
+// 建立 TCP 连接并完成 CONNECT/CONNACK。成功返回 0，失败返回 -1 (errno 或 CONNACK 返回码记录在 *reason 中，可为 NULL)。
+int host_mqtt_connect(host_mqtt_t *c, const char *host, uint16_t port, const char *client_id,
+                      uint16_t keep_alive_sec, uint32_t timeout_ms, int *reason);
+
+void host_mqtt_close(host_mqtt_t *c);
+
+// 发布一条消息，QoS1 时返回使用的报文标识符 (>0)，QoS0 时返回 0，发送失败返回 -1
+int host_mqtt_publish(host_mqtt_t *c, const char *topic, const uint8_t *payload, size_t len, uint8_t qos);
+
+// 订阅一个主题过滤器 (不等待 SUBACK，由 host_mqtt_read() 返回)
+int host_mqtt_subscribe(host_mqtt_t *c, const char *topic_filter, uint8_t qos);
+
+int host_mqtt_ping(host_mqtt_t *c);
+
+// 等待最多 timeout_ms 读取一个完整报文。返回 1 表示 msg 有效，0 表示超时，-1 表示连接已断开或协议错误。
+// 收到 QoS1 的 PUBLISH 时自动回复 PUBACK。
+int host_mqtt_read(host_mqtt_t *c, uint32_t timeout_ms, host_mqtt_message_t *msg);
+
+// 进程内单调时钟 (毫秒)，与设备节拍一样按 32 位回绕
+uint32_t host_now_ms(void);
+
+#endif /* HOST_MQTT_H_ */
@@ -0,0 +1,308 @@
+// 多设备负载发生器：在一个进程中运行 N 个模拟的会议助手 (sim_device.c)，向本地代理发布与固件相同格式的音频帧，
+// 测量代理在多设备并发下的聚合发布速率、丢帧和端到端延迟。
+//
+// 每个模拟设备有自己的状态机、音频线程和网络线程，细节见 sim_device.h；监视线程 (sim_monitor.c) 用单独的连接
+// 订阅 MQTT_TOPIC_AUDIO_STREAM/+，按主题中的客户端 ID 分设备统计，并替代服务端回显心跳。
+// 这里只模拟固件的时序和报文，不运行 FreeRTOS 任务本身。
+//
+// 构建 (主机，在仓库根目录)：
+//   cc -O2 -pthread -Isrc -Itools/host -o loadgen tools/host/loadgen.c tools/host/sim_device.c tools/host/sim_monitor.c tools/host/host_mqtt.c src/fec.c src/heartbeat.c src/wifi_cache.c src/boot_profile.c -lm
+// 运行：
+//   ./loadgen -n 50 -t 60 -w speech_16k_mono.wav          # 50 台设备向 127.0.0.1:1883 发布 60 秒
+
+#include "sim_device.h"
+#include "sim_monitor.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#define LOADGEN_REPORT_INTERVAL_MS  (5000)
+#define LOADGEN_DRAIN_MS            (1000)  // 停止采集后等待在途帧到达监视线程的时间
+
+typedef struct {
+    sim_config_t sim;
+    uint32_t devices;
+    uint32_t duration_s;
+    uint32_t ramp_ms;               // 相邻设备开始会议的间隔
+    const char *wav_path;
+} loadgen_config_t;
+
+static loadgen_config_t config = {
+    .sim = {
+        .host = "127.0.0.1",
+        .port = MQTT_PORT,
+        .frame_ms = AUDIO_FRAME_DURATION_MS,
+        .jitter_ms = 2,
+        .wifi_scan_ms = SIM_WIFI_SCAN_MS_DEFAULT,
+        .wifi_join_ms = SIM_WIFI_JOIN_MS_DEFAULT,
+        .wifi_dhcp_ms = SIM_WIFI_DHCP_MS_DEFAULT,
+        .wifi_cache = true,
+        .fec_group = MQTT_AUDIO_FEC_GROUP_SIZE_DEFAULT,
+        .qos = MQTT_AUDIO_QOS
+    },
+    .devices = 10,
+    .duration_s = 30,
+    .ramp_ms = 50,
+    .wav_path = NULL
+};
+
+static sim_pcm_source_t source;
+static sim_device_t *devices;
+static sim_monitor_t monitor;
+static uint32_t start_ms;
+
+static void sleep_ms(uint32_t ms) {
+    struct timespec ts = { .tv_sec = ms / 1000u, .tv_nsec = (long)(ms % 1000u) * 1000000L };
+    nanosleep(&ts, NULL);
+}
+
+// --- 报告 ---
+
+typedef struct {
+    uint64_t captured;
+    uint64_t queue_drops;
+    uint64_t published;
+    uint64_t published_bytes;
+    uint64_t wire_bytes;
+    uint64_t cpu_us;
+    uint64_t parity_published;
+    uint64_t publish_errors;
+    uint64_t connects;
+    uint64_t reconnects;
+    uint64_t connect_failures;
+    uint64_t link_dead;
+    uint64_t transitions;
+    uint32_t connect_ms_max;
+    uint32_t streaming;
+} totals_t;
+
+static void sum_devices(totals_t *t) {
+    memset(t, 0, sizeof(*t));
+    for (uint32_t i = 0; i < config.devices; i++) {
+        sim_device_stats_t *s = &devices[i].stats;
+        t->captured += s->captured;
+        t->queue_drops += s->queue_drops;
+        t->published += s->published;
+        t->published_bytes += s->published_bytes;
+        t->wire_bytes += s->wire_bytes;
+        t->cpu_us += s->cpu_us;
+        t->parity_published += s->parity_published;
+        t->publish_errors += s->publish_errors;
+        t->connects += s->connects;
+        t->reconnects += (s->connects > 1) ? s->connects - 1u : 0u;
+        t->connect_failures += s->connect_failures;
+        t->link_dead += s->link_dead;
+        t->transitions += s->transitions;
+        if (s->connect_ms_max > t->connect_ms_max) {
+            t->connect_ms_max = s->connect_ms_max;
+        }
+        if (devices[i].state == APP_STATE_MEETING_IN_PROGRESS) {
+            t->streaming++;
+        }
+    }
+}
+
+static void report(const char *label, const totals_t *now, const totals_t *prev, uint64_t received, uint64_t prev_received,
+                   uint32_t elapsed_ms) {
+    static uint64_t hist[SIM_LATENCY_BUCKETS];
+    pthread_mutex_lock(&monitor.lock);
+    memcpy(hist, monitor.latency_hist, sizeof(hist));
+    uint64_t total = monitor.received;
+    uint32_t latency_max = monitor.latency_max_ms;
+    pthread_mutex_unlock(&monitor.lock);
+
+    double seconds = elapsed_ms / 1000.0;
+    uint64_t published = now->published - prev->published;
+    double loss = (now->published > 0) ? 100.0 * (1.0 - (double)received / (double)now->published) : 0.0;
+    printf("[%s] t=%6.1fs streaming=%u/%u publish=%.0f msg/s %.1f kbit/s delivered=%.0f msg/s "
+           "net_loss=%.2f%% queue_drops=%llu errors=%llu reconnects=%llu latency p50=%u p90=%u p99=%u max=%u ms\n",
+           label, (host_now_ms() - start_ms) / 1000.0, now->streaming, config.devices, published / seconds,
+           (now->published_bytes - prev->published_bytes) * 8.0 / 1000.0 / seconds, (received - prev_received) / seconds,
+           (loss < 0.0) ? 0.0 : loss, (unsigned long long)now->queue_drops, (unsigned long long)now->publish_errors,
+           (unsigned long long)now->reconnects,
+           sim_monitor_latency_percentile(hist, total, 50.0), sim_monitor_latency_percentile(hist, total, 90.0),
+           sim_monitor_latency_percentile(hist, total, 99.0), latency_max);
+    fflush(stdout);
+}
+
+static void final_report(uint32_t elapsed_ms) {
+    totals_t t;
+    sum_devices(&t);
+    uint64_t expected = 0;
+    uint64_t reordered = 0;
+    uint32_t worst_device = 0;
+    double worst_loss = 0.0;
+    for (uint32_t i = 0; i < config.devices && i < SIM_MAX_DEVICES; i++) {
+        sim_device_rx_t *rx = &monitor.devices[i];
+        uint32_t captured = devices[i].stats.captured;
+        expected += captured;
+        reordered += rx->out_of_order;
+        double loss = (captured > 0) ? 1.0 - (double)rx->received / captured : 0.0;
+        if (loss > worst_loss) {
+            worst_loss = loss;
+            worst_device = i;
+        }
+    }
+
+    printf("\n=== loadgen summary: %u devices, %u ms frames, qos %u, fec %u, %.1f s ===\n", config.devices, config.sim.frame_ms,
+           config.sim.qos, config.sim.fec_group, elapsed_ms / 1000.0);
+    printf("captured        %llu frames\n", (unsigned long long)t.captured);
+    printf("published       %llu frames + %llu parity, %.1f msg/s, %.1f kbit/s\n", (unsigned long long)t.published,
+           (unsigned long long)t.parity_published, (t.published + t.parity_published) / (elapsed_ms / 1000.0),
+           t.published_bytes * 8.0 / elapsed_ms);
+    double device_seconds = (double)config.devices * elapsed_ms / 1000.0;
+    printf("wire            %.1f kbit/s per device with MQTT and TCP/IP headers (%.1f%% over frame bytes)\n",
+           t.wire_bytes * 8.0 / 1000.0 / device_seconds,
+           (t.published_bytes > 0) ? 100.0 * ((double)t.wire_bytes / t.published_bytes - 1.0) : 0.0);
+    // 设备线程在 sim_device_stop() 中退出时才累加 CPU 时间，这里已经全部停止
+    printf("device cpu      %.3f%% of one core per device, %.1f us per frame (host threads)\n",
+           100.0 * t.cpu_us / 1e6 / device_seconds, (t.captured > 0) ? (double)t.cpu_us / t.captured : 0.0);
+    printf("delivered       %llu frames + %llu parity (%llu heartbeats echoed)\n", (unsigned long long)monitor.received,
+           (unsigned long long)monitor.parity, (unsigned long long)monitor.echoes);
+    if (config.sim.qos > 0) {
+        uint64_t pubacks = 0;
+        for (uint32_t i = 0; i < config.devices; i++) {
+            pubacks += devices[i].stats.pubacks;
+        }
+        printf("acknowledged    %llu PUBACKs\n", (unsigned long long)pubacks);
+    }
+    printf("loss            end-to-end %.3f%%, network %.3f%%, device queue %llu, publish errors %llu\n",
+           (expected > 0) ? 100.0 * (1.0 - (double)monitor.received / expected) : 0.0,
+           (t.published > 0) ? 100.0 * (1.0 - (double)monitor.received / t.published) : 0.0,
+           (unsigned long long)t.queue_drops, (unsigned long long)t.publish_errors);
+    printf("worst device    #%u %.3f%% lost, reordered %llu frames in total\n", worst_device, worst_loss * 100.0,
+           (unsigned long long)reordered);
+    printf("latency         p50 %u ms, p90 %u ms, p99 %u ms, p99.9 %u ms, max %u ms\n",
+           sim_monitor_latency_percentile(monitor.latency_hist, monitor.received, 50.0),
+           sim_monitor_latency_percentile(monitor.latency_hist, monitor.received, 90.0),
+           sim_monitor_latency_percentile(monitor.latency_hist, monitor.received, 99.0),
+           sim_monitor_latency_percentile(monitor.latency_hist, monitor.received, 99.9), monitor.latency_max_ms);
+    // 帧头时间戳是一帧采满的时刻，帧内第一个样本还要再早一个帧长
+    printf("first sample    p50 %u ms, p99 %u ms (frame fill %u ms + transport)\n",
+           config.sim.frame_ms + sim_monitor_latency_percentile(monitor.latency_hist, monitor.received, 50.0),
+           config.sim.frame_ms + sim_monitor_latency_percentile(monitor.latency_hist, monitor.received, 99.0),
+           config.sim.frame_ms);
+    printf("connections     %llu connects (%llu reconnects), %llu failures, %llu heartbeat timeouts, max connect %u ms, %llu state transitions\n",
+           (unsigned long long)t.connects, (unsigned long long)t.reconnects, (unsigned long long)t.connect_failures, (unsigned long long)t.link_dead,
+           t.connect_ms_max, (unsigned long long)t.transitions);
+    uint64_t scans = 0;
+    uint64_t directed = 0;
+    uint64_t boots = 0;
+    uint64_t boot_ms_sum = 0;
+    uint32_t boot_ms_max = 0;
+    for (uint32_t i = 0; i < config.devices; i++) {
+        sim_device_stats_t *s = &devices[i].stats;
+        scans += s->wifi_scan_connects;
+        directed += s->wifi_directed_connects;
+        boots += s->boots_to_idle;
+        boot_ms_sum += s->boot_to_idle_ms_sum;
+        boot_ms_max = (s->boot_to_idle_ms_max > boot_ms_max) ? s->boot_to_idle_ms_max : boot_ms_max;
+    }
+    printf("wifi            %llu scans, %llu directed\n", (unsigned long long)scans, (unsigned long long)directed);
+    // 各设备最近一次启动的步骤，取平均
+    printf("boot            IDLE mean %.0f ms, max %u ms", (boots > 0) ? (double)boot_ms_sum / boots : 0.0, boot_ms_max);
+    for (uint32_t step = 0; step < BOOT_STEP_COUNT; step++) {
+        uint64_t start_sum = 0;
+        uint64_t duration_sum = 0;
+        uint32_t count = 0;
+        for (uint32_t i = 0; i < config.devices; i++) {
+            uint32_t start_us;
+            uint32_t duration_us;
+            if (boot_profile_step(&devices[i].boot_profile, (boot_step_t)step, &start_us, &duration_us)) {
+                start_sum += start_us;
+                duration_sum += duration_us;
+                count++;
+            }
+        }
+        if (count > 0) {
+            printf("; %s at %.0f ms took %.0f ms", boot_profile_step_name((boot_step_t)step), start_sum / 1000.0 / count,
+                   duration_sum / 1000.0 / count);
+        }
+    }
+    printf("\n");
+}
+
+static void usage(const char *argv0) {
+    fprintf(stderr,
+            "usage: %s [-h host] [-p port] [-n devices] [-t seconds] [-w file.wav] [-f fec_group]\n"
+            "          [-q qos] [-m frame_ms] [-j jitter_ms] [-r ramp_ms] [-a wifi_scan_ms]\n", argv0);
+}
+
+int main(int argc, char **argv) {
+    int opt;
+    while ((opt = getopt(argc, argv, "h:p:n:t:w:f:q:m:j:r:a:")) != -1) {
+        switch (opt) {
+            case 'h': config.sim.host = optarg; break;
+            case 'p': config.sim.port = (uint16_t)atoi(optarg); break;
+            case 'n': config.devices = (uint32_t)atoi(optarg); break;
+            case 't': config.duration_s = (uint32_t)atoi(optarg); break;
+            case 'w': config.wav_path = optarg; break;
+            case 'f': config.sim.fec_group = (uint32_t)atoi(optarg); break;
+            case 'q': config.sim.qos = (uint8_t)atoi(optarg); break;
+            case 'm': config.sim.frame_ms = (uint32_t)atoi(optarg); break;
+            case 'j': config.sim.jitter_ms = (uint32_t)atoi(optarg); break;
+            case 'r': config.ramp_ms = (uint32_t)atoi(optarg); break;
+            case 'a': config.sim.wifi_scan_ms = (uint32_t)atoi(optarg); break;
+            default: usage(argv[0]); return 2;
+        }
+    }
+    if (config.devices == 0 || config.devices > SIM_MAX_DEVICES || config.sim.qos > 1 ||
+        config.sim.frame_ms < AUDIO_MIN_FRAME_DURATION_MS || config.sim.frame_ms > AUDIO_MAX_FRAME_DURATION_MS ||
+        config.sim.frame_ms % AUDIO_MIN_FRAME_DURATION_MS != 0 ||
+        (config.sim.fec_group != 0 && (config.sim.fec_group < FEC_MIN_GROUP_SIZE || config.sim.fec_group > FEC_MAX_GROUP_SIZE))) {
+        usage(argv[0]);
+        return 2;
+    }
+    if (config.wav_path != NULL) {
+        if (!sim_source_load_wav(config.wav_path, &source)) {
+            fprintf(stderr, "%s: not a 16-bit PCM WAV with <= %u channels at <= %u Hz\n", config.wav_path, AUDIO_CHANNELS,
+                    AUDIO_MAX_OUTPUT_SAMPLE_RATE);
+            return 1;
+        }
+    } else {
+        sim_source_synthesize(&source);
+    }
+
+    int reason = 0;
+    if (!sim_monitor_start(&monitor, config.sim.host, config.sim.port, "loadgen_monitor", &reason)) {
+        fprintf(stderr, "cannot connect to %s:%u (%d)\n", config.sim.host, config.sim.port, reason);
+        return 1;
+    }
+    start_ms = host_now_ms();
+    sleep_ms(200);  // 等订阅生效，避免把最初几帧计为丢失
+
+    devices = calloc(config.devices, sizeof(sim_device_t));
+    uint32_t boot_ms = config.sim.wifi_scan_ms + config.sim.wifi_join_ms + config.sim.wifi_dhcp_ms;  // 首次关联没有缓存
+    for (uint32_t i = 0; i < config.devices; i++) {
+        sim_device_start(&devices[i], i, &config.sim, &source, start_ms + boot_ms + i * config.ramp_ms);
+    }
+
+    totals_t prev = { 0 };
+    uint64_t prev_received = 0;
+    uint32_t last_report = start_ms;
+    while ((host_now_ms() - start_ms) < config.duration_s * 1000u) {
+        sleep_ms(100);
+        uint32_t now = host_now_ms();
+        if ((now - last_report) >= LOADGEN_REPORT_INTERVAL_MS) {
+            totals_t t;
+            sum_devices(&t);
+            pthread_mutex_lock(&monitor.lock);
+            uint64_t received = monitor.received;
+            pthread_mutex_unlock(&monitor.lock);
+            report("loadgen", &t, &prev, received, prev_received, now - last_report);
+            prev = t;
+            prev_received = received;
+            last_report = now;
+        }
+    }
+
+    uint32_t elapsed_ms = host_now_ms() - start_ms;
+    for (uint32_t i = 0; i < config.devices; i++) {
+        sim_device_stop(&devices[i]);
+    }
+    sim_monitor_stop(&monitor, LOADGEN_DRAIN_MS);
+    final_report(elapsed_ms);
+    return 0;
+}
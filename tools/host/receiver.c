@@ -0,0 +1,794 @@
+// 参考接收端：订阅音频主题 (可选同时在 AUDIO_UDP_PORT 接收 UDP 实时帧)，按设备重组音频流，写出 WAV 文件，
+// 并实时报告到达抖动、丢帧、乱序、中断时长和有效码率。它是所有网络性能测试的测量端。
+//
+// 流的划分：
+//   MQTT  每台设备发布到 "<音频主题>/<客户端 ID>"，按主题中的客户端 ID 区分。
+//   UDP   按 RTP SSRC (客户端 ID 的 FNV-1a 散列) 区分。从心跳和时钟同步主题得知客户端 ID 后，每秒向
+//         "MQTT_TOPIC_AUDIO_FEEDBACK/<客户端 ID>" 发布接收报告 (格式见 udp_stream.h)，设备的码率自适应据此调整档位。
+// 每个流保留最近 RECEIVER_HISTORY 帧，同组恰好丢失一帧时用 XOR 校验包恢复 (fec_recover)。
+// 积压帧 (AUDIO_FRAME_FLAG_BACKLOG) 从 MQTT_TOPIC_AUDIO_BACKLOG 到达，按序号填回原来的位置。
+//
+// 统计口径：
+//   丢帧   期望帧数 (最大序号 - 首个序号 + 1) 减去收到的不同帧 (含恢复和补发的帧)
+//   中断   序号每跳变一次记一次，时长为跳过的帧数 x 帧长；之后补齐的帧不改变已记录的中断
+//   乱序   序号小于已收到的最大序号的实时帧；补发的积压帧单独计数
+//   抖动   RFC 3550 第 6.4.1 节的到达间隔抖动，只对实时帧按到达顺序计算
+//   延迟   帧头带 AUDIO_FRAME_FLAG_SERVER_TIME 且本程序是时钟同步的服务端 (-c) 时，帧时间戳与本机时钟可比，
+//          直接算出从采集到收到的延迟
+// WAV 按帧序号定位写入，迟到和补发的帧写回原位，未收到的帧保持静音。采样率、通道数或帧长变化时开始一个新文件。
+// log-mel 帧和加密帧只统计，不写入 WAV。
+//
+// 构建 (主机，在仓库根目录)：
+//   cc -O2 -Isrc -Itools/host -o receiver tools/host/receiver.c tools/host/host_mqtt.c src/fec.c src/clock_sync.c -lm
+// 运行：
+//   ./receiver -h 127.0.0.1 -o wav -u -e -c        # 写 WAV，接收 UDP，代替服务端回显心跳和回复时钟同步
+
+#include "app_config.h"
+#include "byte_order.h"
+#include "fec.h"
+#include "clock_sync.h"
+#include "host_mqtt.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#define RECEIVER_MAX_STREAMS        (256)
+#define RECEIVER_HISTORY            (64)    // 保留的最近帧数，决定 FEC 可恢复的范围
+#define RECEIVER_SEEN_WINDOW        (8192)  // 判重的范围 (帧)，覆盖 AUDIO_BACKLOG_MAX_AGE_MS 内补发的积压帧
+#define RECEIVER_MAX_PARITY         (8)     // 每个流等待恢复的校验包数
+#define RECEIVER_MAX_CLIENTS        (256)
+#define RECEIVER_FEEDBACK_MS        (1000)
+#define RECEIVER_HEADER_SIZE        (16)
+#define RECEIVER_MAX_FRAME_BYTES    (RECEIVER_HEADER_SIZE + AUDIO_BUFFER_SIZE_BYTES + 64)
+#define RECEIVER_WAV_HEADER_SIZE    (44)
+
+// 帧头字段 (见 audio_task.h)
+#define FRAME_FLAG_BACKLOG          (1u << 2)
+#define FRAME_FLAG_ENCRYPTED        (1u << 3)
+#define FRAME_FLAG_SERVER_TIME      (1u << 4)
+#define FRAME_FORMAT_PCM_S16LE      (0)
+
+// UDP 数据报和接收报告的布局 (见 udp_stream.h)
+#define RTP_HEADER_SIZE             (12)
+#define RTP_VERSION                 (2)
+#define FEEDBACK_VERSION            (1)
+#define FEEDBACK_SIZE               (16)
+
+typedef struct {
+    uint32_t sample_rate;
+    uint32_t channels;
+    uint32_t samples_per_frame;
+    uint32_t first_sequence;
+    uint32_t frames_written;        // 已写到的最大位置 + 1 (帧)
+    int fd;
+    uint32_t index;
+} wav_segment_t;
+
+typedef struct {
+    uint32_t frames;                // 收到的不同帧 (不含校验包)
+    uint32_t parity;
+    uint32_t recovered;             // 由校验包恢复的帧
+    uint32_t backlog;               // 补发的积压帧
+    uint32_t reordered;
+    uint32_t duplicates;
+    uint32_t too_late;              // 早于判重范围的帧
+    uint32_t gaps;
+    uint32_t gap_ms_max;
+    uint64_t gap_ms_total;
+    uint64_t bytes;                 // 帧头 + 负载 (含校验包)
+    uint32_t logmel;
+    uint32_t encrypted;
+    uint32_t latency_count;
+    uint64_t latency_sum_ms;
+    uint32_t latency_max_ms;
+} stream_counters_t;
+
+typedef struct {
+    bool used;
+    bool udp;
+    uint32_t key;                   // UDP 为 SSRC，MQTT 为客户端 ID 的散列 (再比较 name)
+    char name[48];                  // MQTT 为客户端 ID
+
+    bool started;
+    uint32_t first_sequence;
+    uint32_t highest_sequence;
+    uint32_t frame_ms;              // 最近一帧的帧长
+    uint8_t seen[RECEIVER_SEEN_WINDOW / 8];    // 按序号 % RECEIVER_SEEN_WINDOW 记录已收到的帧
+    uint8_t *history[RECEIVER_HISTORY];     // 按序号 % RECEIVER_HISTORY 存放最近帧的副本 (帧头 + 负载)
+    uint16_t history_len[RECEIVER_HISTORY];
+    uint32_t history_sequence[RECEIVER_HISTORY];
+    uint8_t *parity[RECEIVER_MAX_PARITY];
+    uint16_t parity_len[RECEIVER_MAX_PARITY];
+
+    // 抖动 (RFC 3550)，单位为毫秒 x 16
+    bool have_transit;
+    int32_t last_transit;
+    uint32_t jitter_x16;
+
+    // UDP：RTP 序号 (RFC 3550 附录 A.1 的扩展序号)
+    bool rtp_started;
+    uint16_t rtp_max_seq;
+    uint32_t rtp_cycles;
+    uint32_t rtp_base;
+    uint32_t rtp_received;
+    uint32_t rtp_expected_prior;
+    uint32_t rtp_received_prior;
+    uint32_t last_feedback_ms;
+
+    stream_counters_t total;
+    stream_counters_t last_report;  // 上次报告时的 total，用于计算区间值
+    wav_segment_t wav;
+} stream_t;
+
+typedef struct {
+    const char *host;
+    uint16_t port;
+    const char *wav_dir;
+    bool udp;
+    uint16_t udp_port;
+    bool echo_heartbeats;
+    bool clock_server;
+    bool archive;
+    uint32_t report_s;
+    uint32_t duration_s;
+} receiver_config_t;
+
+static receiver_config_t config = {
+    .host = "127.0.0.1",
+    .port = MQTT_PORT,
+    .wav_dir = NULL,
+    .udp = false,
+    .udp_port = AUDIO_UDP_PORT,
+    .echo_heartbeats = false,
+    .clock_server = false,
+    .archive = false,
+    .report_s = 5,
+    .duration_s = 0
+};
+
+static stream_t streams[RECEIVER_MAX_STREAMS];
+static char clients[RECEIVER_MAX_CLIENTS][64];     // 从心跳和时钟同步主题得知的客户端 ID
+static uint32_t client_count;
+static host_mqtt_t mqtt;
+static volatile sig_atomic_t stop_requested;
+
+// 与 udp_stream.c 相同的 FNV-1a
+static uint32_t hash_client_id(const char *client_id) {
+    uint32_t hash = 2166136261u;
+    while (*client_id != '\0') {
+        hash ^= (uint8_t)*client_id++;
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+static const char *client_for_ssrc(uint32_t ssrc) {
+    for (uint32_t i = 0; i < client_count; i++) {
+        if (hash_client_id(clients[i]) == ssrc) {
+            return clients[i];
+        }
+    }
+    return NULL;
+}
+
+static void learn_client(const char *client_id) {
+    for (uint32_t i = 0; i < client_count; i++) {
+        if (strcmp(clients[i], client_id) == 0) {
+            return;
+        }
+    }
+    if (client_count < RECEIVER_MAX_CLIENTS && strlen(client_id) < sizeof(clients[0])) {
+        strcpy(clients[client_count++], client_id);
+        printf("client %s (SSRC 0x%08X)\n", client_id, (unsigned int)hash_client_id(client_id));
+    }
+}
+
+// UDP 流按 SSRC 查找 (client 为 NULL)，MQTT 流按主题中的客户端 ID 查找
+static stream_t *find_stream(bool udp, uint32_t key, const char *client) {
+    stream_t *free_slot = NULL;
+    for (uint32_t i = 0; i < RECEIVER_MAX_STREAMS; i++) {
+        if (streams[i].used && streams[i].udp == udp && streams[i].key == key &&
+            (client == NULL || strcmp(streams[i].name, client) == 0)) {
+            return &streams[i];
+        }
+        if (!streams[i].used && free_slot == NULL) {
+            free_slot = &streams[i];
+        }
+    }
+    if (free_slot != NULL) {
+        memset(free_slot, 0, sizeof(*free_slot));
+        free_slot->used = true;
+        free_slot->udp = udp;
+        free_slot->key = key;
+        free_slot->wav.fd = -1;
+        if (udp) {
+            snprintf(free_slot->name, sizeof(free_slot->name), "udp_%08x", (unsigned int)key);
+        } else {
+            snprintf(free_slot->name, sizeof(free_slot->name), "%.47s", client);
+        }
+    }
+    return free_slot;
+}
+
+// --- WAV ---
+
+static void wav_write_header(wav_segment_t *w) {
+    uint32_t data_bytes = w->frames_written * w->samples_per_frame * w->channels * 2u;
+    uint8_t h[RECEIVER_WAV_HEADER_SIZE];
+    memcpy(h, "RIFF", 4);
+    put_le32(&h[4], 36u + data_bytes);
+    memcpy(&h[8], "WAVEfmt ", 8);
+    put_le32(&h[16], 16);
+    put_le16(&h[20], 1);
+    put_le16(&h[22], (uint16_t)w->channels);
+    put_le32(&h[24], w->sample_rate);
+    put_le32(&h[28], w->sample_rate * w->channels * 2u);
+    put_le16(&h[32], (uint16_t)(w->channels * 2u));
+    put_le16(&h[34], 16);
+    memcpy(&h[36], "data", 4);
+    put_le32(&h[40], data_bytes);
+    if (pwrite(w->fd, h, sizeof(h), 0) != (ssize_t)sizeof(h)) {
+        perror("wav header");
+    }
+}
+
+static void wav_close(wav_segment_t *w) {
+    if (w->fd >= 0) {
+        wav_write_header(w);
+        // 文件按最后写入的帧截断，末尾缺失的帧不占位
+        if (ftruncate(w->fd, RECEIVER_WAV_HEADER_SIZE + (off_t)w->frames_written * w->samples_per_frame * w->channels * 2) != 0) {
+            perror("wav truncate");
+        }
+        close(w->fd);
+        w->fd = -1;
+    }
+}
+
+static void wav_open(stream_t *s, uint32_t sequence, uint32_t sample_rate, uint32_t channels, uint32_t samples_per_frame) {
+    wav_close(&s->wav);
+    uint32_t index = s->wav.index;
+    s->wav = (wav_segment_t){ .sample_rate = sample_rate, .channels = channels, .samples_per_frame = samples_per_frame,
+                              .first_sequence = sequence, .fd = -1, .index = index + 1u };
+    char path[512];
+    snprintf(path, sizeof(path), "%s/%s_%03u.wav", config.wav_dir, s->name, (unsigned int)s->wav.index);
+    s->wav.fd = open(path, O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (s->wav.fd < 0) {
+        perror(path);
+        return;
+    }
+    wav_write_header(&s->wav);
+    printf("%s: writing %s (%u Hz, %u ch, %u samples/frame)\n", s->name, path, (unsigned int)sample_rate,
+           (unsigned int)channels, (unsigned int)samples_per_frame);
+}
+
+// 按序号把一帧 PCM 写到文件中的位置。参数变化时只有比当前段更新的帧才开始新段，迟到的旧参数帧丢弃。
+static void wav_put(stream_t *s, uint32_t sequence, const uint8_t *frame) {
+    uint32_t channels = frame[2];
+    uint32_t sample_rate = get_le16(&frame[4]);
+    uint32_t samples = get_le16(&frame[6]);
+    bool same = s->wav.fd >= 0 && s->wav.sample_rate == sample_rate && s->wav.channels == channels &&
+                s->wav.samples_per_frame == samples;
+    if (!same) {
+        if (s->wav.fd >= 0 && (int32_t)(sequence - s->wav.first_sequence) < 0) {
+            return;
+        }
+        wav_open(s, sequence, sample_rate, channels, samples);
+        if (s->wav.fd < 0) {
+            return;
+        }
+    }
+    int32_t position = (int32_t)(sequence - s->wav.first_sequence);
+    if (position < 0) {
+        return;
+    }
+    size_t frame_bytes = (size_t)samples * channels * 2u;
+    off_t offset = RECEIVER_WAV_HEADER_SIZE + (off_t)position * (off_t)frame_bytes;
+    if (pwrite(s->wav.fd, &frame[RECEIVER_HEADER_SIZE], frame_bytes, offset) != (ssize_t)frame_bytes) {
+        perror("wav write");
+        return;
+    }
+    if ((uint32_t)position + 1u > s->wav.frames_written) {
+        s->wav.frames_written = (uint32_t)position + 1u;
+    }
+}
+
+// --- 帧处理 ---
+
+static bool seen_get(const stream_t *s, uint32_t sequence) {
+    uint32_t bit = sequence % RECEIVER_SEEN_WINDOW;
+    return (s->seen[bit / 8u] >> (bit % 8u)) & 1u;
+}
+
+static void seen_set(stream_t *s, uint32_t sequence, bool value) {
+    uint32_t bit = sequence % RECEIVER_SEEN_WINDOW;
+    if (value) {
+        s->seen[bit / 8u] |= (uint8_t)(1u << (bit % 8u));
+    } else {
+        s->seen[bit / 8u] &= (uint8_t)~(1u << (bit % 8u));
+    }
+}
+
+static bool in_history(const stream_t *s, uint32_t sequence) {
+    uint32_t slot = sequence % RECEIVER_HISTORY;
+    return s->history[slot] != NULL && s->history_len[slot] > 0 && s->history_sequence[slot] == sequence;
+}
+
+static void remember(stream_t *s, uint32_t sequence, const uint8_t *frame, size_t len) {
+    uint32_t slot = sequence % RECEIVER_HISTORY;
+    if (s->history[slot] == NULL) {
+        s->history[slot] = malloc(RECEIVER_MAX_FRAME_BYTES);
+    }
+    if (s->history[slot] != NULL && len <= RECEIVER_MAX_FRAME_BYTES) {
+        memcpy(s->history[slot], frame, len);
+        s->history_len[slot] = (uint16_t)len;
+        s->history_sequence[slot] = sequence;
+    }
+}
+
+static void try_recover(stream_t *s, uint32_t now);
+
+// 一帧音频 (实时、补发或恢复的)。recovered 的帧不参与抖动和延迟统计。
+static void on_audio_frame(stream_t *s, const uint8_t *frame, size_t len, uint32_t now, bool recovered) {
+    uint32_t sequence = get_le32(&frame[8]);
+    uint8_t flags = frame[1];
+    bool backlog = (flags & FRAME_FLAG_BACKLOG) != 0;
+    stream_counters_t *c = &s->total;
+
+    if (!s->started) {
+        s->started = true;
+        s->first_sequence = sequence;
+        s->highest_sequence = sequence;
+    } else if ((int32_t)(sequence - s->highest_sequence) > 0) {
+        uint32_t skipped = sequence - s->highest_sequence - 1u;
+        // 新进入判重范围的序号先清为未收到
+        for (uint32_t k = 1; k <= skipped + 1u && k <= RECEIVER_SEEN_WINDOW; k++) {
+            seen_set(s, s->highest_sequence + k, false);
+        }
+        if (skipped > 0) {
+            uint32_t gap_ms = skipped * s->frame_ms;
+            c->gaps++;
+            c->gap_ms_total += gap_ms;
+            if (gap_ms > c->gap_ms_max) {
+                c->gap_ms_max = gap_ms;
+            }
+        }
+        s->highest_sequence = sequence;
+    } else if (s->highest_sequence - sequence >= RECEIVER_SEEN_WINDOW) {
+        c->too_late++;  // 已超出判重范围，无法判断是否重复，不计入收到的帧
+        return;
+    } else if (seen_get(s, sequence)) {
+        c->duplicates++;
+        return;
+    } else if ((int32_t)(sequence - s->first_sequence) < 0) {
+        // 比首帧更早的补发帧：期望帧数从这里算起
+        s->first_sequence = sequence;
+        c->reordered += backlog ? 0u : 1u;
+    } else if (!backlog && !recovered) {
+        c->reordered++;
+    }
+
+    seen_set(s, sequence, true);
+    c->frames++;
+    c->bytes += len;
+    if (recovered) {
+        c->recovered++;
+    } else if (backlog) {
+        c->backlog++;
+    }
+    uint32_t sample_rate = get_le16(&frame[4]);
+    uint32_t samples = get_le16(&frame[6]);
+    if (frame[3] == FRAME_FORMAT_PCM_S16LE && sample_rate > 0) {
+        s->frame_ms = samples * 1000u / sample_rate;
+    }
+
+    if (!recovered && !backlog) {
+        int32_t transit = (int32_t)(now - get_le32(&frame[12]));
+        if (s->have_transit) {
+            int32_t d = transit - s->last_transit;
+            if (d < 0) {
+                d = -d;
+            }
+            // J += (|D| - J) / 16，以 J x 16 保存
+            s->jitter_x16 += (uint32_t)d - ((s->jitter_x16 + 8u) >> 4);
+        }
+        s->last_transit = transit;
+        s->have_transit = true;
+        if ((flags & FRAME_FLAG_SERVER_TIME) && config.clock_server && transit >= 0) {
+            c->latency_count++;
+            c->latency_sum_ms += (uint32_t)transit;
+            if ((uint32_t)transit > c->latency_max_ms) {
+                c->latency_max_ms = (uint32_t)transit;
+            }
+        }
+    }
+
+    remember(s, sequence, frame, len);
+    if (flags & FRAME_FLAG_ENCRYPTED) {
+        c->encrypted++;
+    } else if (frame[3] != FRAME_FORMAT_PCM_S16LE) {
+        c->logmel++;
+    } else if (config.wav_dir != NULL &&
+               len >= RECEIVER_HEADER_SIZE + (size_t)samples * frame[2] * 2u) {
+        wav_put(s, sequence, frame);
+    }
+    try_recover(s, now);
+}
+
+static void on_parity(stream_t *s, const uint8_t *packet, size_t len, uint32_t now) {
+    s->total.parity++;
+    s->total.bytes += len;
+    for (uint32_t i = 0; i < RECEIVER_MAX_PARITY; i++) {
+        if (s->parity_len[i] == 0) {
+            if (s->parity[i] == NULL) {
+                s->parity[i] = malloc(RECEIVER_MAX_FRAME_BYTES + FEC_HEADER_SIZE + FEC_LENGTH_PREFIX_SIZE);
+            }
+            if (s->parity[i] != NULL && len <= RECEIVER_MAX_FRAME_BYTES + FEC_HEADER_SIZE + FEC_LENGTH_PREFIX_SIZE) {
+                memcpy(s->parity[i], packet, len);
+                s->parity_len[i] = (uint16_t)len;
+            }
+            break;
+        }
+    }
+    try_recover(s, now);
+}
+
+// 对每个等待中的校验包：组内帧已齐则丢弃；恰好缺一帧则恢复；组已落出保留范围则放弃
+static void try_recover(stream_t *s, uint32_t now) {
+    for (uint32_t i = 0; i < RECEIVER_MAX_PARITY; i++) {
+        if (s->parity_len[i] == 0) {
+            continue;
+        }
+        const uint8_t *parity = s->parity[i];
+        uint32_t base = get_le32(&parity[8]);
+        uint32_t group = parity[2];
+        uint16_t mask = get_le16(&parity[4]);
+        const uint8_t *packets[FEC_MAX_GROUP_SIZE] = { 0 };
+        size_t lens[FEC_MAX_GROUP_SIZE] = { 0 };
+        uint32_t missing = 0;
+        for (uint32_t k = 0; k < group && k < FEC_MAX_GROUP_SIZE; k++) {
+            uint32_t sequence = base + k;
+            if (in_history(s, sequence)) {
+                packets[k] = s->history[sequence % RECEIVER_HISTORY];
+                lens[k] = s->history_len[sequence % RECEIVER_HISTORY];
+            } else if (mask & (1u << k)) {
+                missing++;
+            }
+        }
+        bool expired = (int32_t)(s->highest_sequence - (base + group)) >= (int32_t)(RECEIVER_HISTORY / 2u);
+        if (missing == 1) {
+            static uint8_t out[RECEIVER_MAX_FRAME_BYTES];
+            size_t out_len = fec_recover(parity, s->parity_len[i], packets, lens, out, sizeof(out));
+            s->parity_len[i] = 0;
+            if (out_len >= RECEIVER_HEADER_SIZE) {
+                on_audio_frame(s, out, out_len, now, true);
+            }
+        } else if (missing == 0 || expired) {
+            s->parity_len[i] = 0;
+        }
+    }
+}
+
+// UDP 帧按 ssrc，MQTT 帧按 client 归到流
+static void on_frame(bool udp, uint32_t ssrc, const char *client, const uint8_t *frame, size_t len, uint32_t now) {
+    if (len < RECEIVER_HEADER_SIZE || frame[0] != 1) {
+        return;
+    }
+    stream_t *s = udp ? find_stream(true, ssrc, NULL) : find_stream(false, hash_client_id(client), client);
+    if (s == NULL) {
+        return;
+    }
+    if (udp && s->name[0] == 'u') {
+        const char *known = client_for_ssrc(ssrc);
+        if (known != NULL) {
+            snprintf(s->name, sizeof(s->name), "%.47s", known);
+        }
+    }
+    if (frame[1] & FEC_FRAME_FLAG_PARITY) {
+        on_parity(s, frame, len, now);
+    } else {
+        on_audio_frame(s, frame, len, now, false);
+    }
+}
+
+// --- UDP ---
+
+static void on_rtp_sequence(stream_t *s, uint16_t seq) {
+    if (!s->rtp_started) {
+        s->rtp_started = true;
+        s->rtp_base = seq;
+        s->rtp_max_seq = seq;
+    } else {
+        uint16_t delta = (uint16_t)(seq - s->rtp_max_seq);
+        if (delta < 0x8000u) {
+            if (seq < s->rtp_max_seq) {
+                s->rtp_cycles += 0x10000u;
+            }
+            s->rtp_max_seq = seq;
+        }
+    }
+    s->rtp_received++;
+}
+
+static void on_datagram(const uint8_t *data, size_t len, uint32_t now) {
+    if (len < RTP_HEADER_SIZE + RECEIVER_HEADER_SIZE || (data[0] >> 6) != RTP_VERSION) {
+        return;
+    }
+    uint16_t seq = get_be16(&data[2]);
+    uint32_t ssrc = get_be32(&data[8]);
+    stream_t *s = find_stream(true, ssrc, NULL);
+    if (s != NULL) {
+        on_rtp_sequence(s, seq);
+    }
+    on_frame(true, ssrc, NULL, &data[RTP_HEADER_SIZE], len - RTP_HEADER_SIZE, now);
+}
+
+// 接收报告，丢包按 FEC 恢复前的数据报计算 (RFC 3550 附录 A.3)
+static void send_feedback(stream_t *s, uint32_t now) {
+    if (!s->udp || !s->rtp_started || (now - s->last_feedback_ms) < RECEIVER_FEEDBACK_MS) {
+        return;
+    }
+    const char *client = client_for_ssrc(s->key);
+    if (client == NULL) {
+        return;
+    }
+    s->last_feedback_ms = now;
+    uint32_t extended_max = s->rtp_cycles + s->rtp_max_seq;
+    uint32_t expected = extended_max - s->rtp_base + 1u;
+    int32_t lost = (int32_t)(expected - s->rtp_received);
+    uint32_t expected_interval = expected - s->rtp_expected_prior;
+    uint32_t received_interval = s->rtp_received - s->rtp_received_prior;
+    s->rtp_expected_prior = expected;
+    s->rtp_received_prior = s->rtp_received;
+    int32_t lost_interval = (int32_t)(expected_interval - received_interval);
+    uint8_t fraction = (expected_interval == 0 || lost_interval <= 0) ? 0u
+                                                                      : (uint8_t)(((uint32_t)lost_interval << 8) / expected_interval);
+
+    uint8_t report[FEEDBACK_SIZE] = { 0 };
+    report[0] = FEEDBACK_VERSION;
+    report[1] = fraction;
+    put_le32(&report[4], extended_max);
+    put_le32(&report[8], (lost > 0) ? (uint32_t)lost : 0u);
+    put_le32(&report[12], s->jitter_x16 >> 4);
+    char topic[128];
+    snprintf(topic, sizeof(topic), "%s/%.63s", MQTT_TOPIC_AUDIO_FEEDBACK, client);
+    host_mqtt_publish(&mqtt, topic, report, sizeof(report), 0);
+}
+
+// --- MQTT ---
+
+// topic 为 "<prefix>/<客户端 ID>" 时返回客户端 ID
+static const char *topic_client(const char *topic, const char *prefix) {
+    size_t n = strlen(prefix);
+    return (strncmp(topic, prefix, n) == 0 && topic[n] == '/' && topic[n + 1] != '\0') ? &topic[n + 1] : NULL;
+}
+
+static void on_message(const host_mqtt_message_t *msg, uint32_t now) {
+    const char *client;
+    if ((client = topic_client(msg->topic, MQTT_TOPIC_AUDIO_STREAM)) != NULL ||
+        (client = topic_client(msg->topic, MQTT_TOPIC_AUDIO_BACKLOG)) != NULL ||
+        (client = topic_client(msg->topic, MQTT_TOPIC_AUDIO_ARCHIVE)) != NULL) {
+        on_frame(false, 0, client, msg->payload, msg->payload_len, now);
+    } else if ((client = topic_client(msg->topic, MQTT_TOPIC_HEARTBEAT)) != NULL) {
+        learn_client(client);
+        if (config.echo_heartbeats) {
+            char topic[128];
+            snprintf(topic, sizeof(topic), "%s/%.63s", MQTT_TOPIC_HEARTBEAT_ECHO, client);
+            host_mqtt_publish(&mqtt, topic, msg->payload, msg->payload_len, 0);
+        }
+    } else if ((client = topic_client(msg->topic, MQTT_TOPIC_CLOCK)) != NULL) {
+        learn_client(client);
+        uint8_t reply[CLOCK_SYNC_MSG_SIZE];
+        if (config.clock_server && msg->payload_len == CLOCK_SYNC_MSG_SIZE &&
+            clock_sync_make_reply(msg->payload, now, host_now_ms(), reply)) {
+            char topic[128];
+            snprintf(topic, sizeof(topic), "%s/%.63s", MQTT_TOPIC_CLOCK_REPLY, client);
+            host_mqtt_publish(&mqtt, topic, reply, sizeof(reply), 0);
+        }
+    }
+}
+
+static void subscribe_all(void) {
+    char filter[64];
+    snprintf(filter, sizeof(filter), "%s/+", MQTT_TOPIC_AUDIO_STREAM);
+    host_mqtt_subscribe(&mqtt, filter, 0);
+    snprintf(filter, sizeof(filter), "%s/+", MQTT_TOPIC_AUDIO_BACKLOG);
+    host_mqtt_subscribe(&mqtt, filter, 0);
+    if (config.archive) {
+        snprintf(filter, sizeof(filter), "%s/+", MQTT_TOPIC_AUDIO_ARCHIVE);
+        host_mqtt_subscribe(&mqtt, filter, 0);
+    }
+    snprintf(filter, sizeof(filter), "%s/+", MQTT_TOPIC_HEARTBEAT);
+    host_mqtt_subscribe(&mqtt, filter, 0);
+    snprintf(filter, sizeof(filter), "%s/+", MQTT_TOPIC_CLOCK);
+    host_mqtt_subscribe(&mqtt, filter, 0);
+}
+
+// --- 报告 ---
+
+static uint32_t expected_frames(const stream_t *s) {
+    return s->started ? s->highest_sequence - s->first_sequence + 1u : 0u;
+}
+
+static void report_stream(stream_t *s, uint32_t interval_ms) {
+    const stream_counters_t *t = &s->total;
+    const stream_counters_t *p = &s->last_report;
+    uint32_t expected = expected_frames(s);
+    double loss = (expected > 0) ? 100.0 * (double)(expected - t->frames) / expected : 0.0;
+    double seconds = interval_ms / 1000.0;
+    printf("%-28s %6.1f fr/s %7.1f kbit/s loss %6.2f%% (%u) rec %u backlog %u reord %u dup %u late %u "
+           "gaps %u (max %u ms) jitter %.1f ms",
+           s->name, (t->frames - p->frames) / seconds, (double)(t->bytes - p->bytes) * 8.0 / 1000.0 / seconds, loss,
+           (unsigned int)(expected - t->frames), (unsigned int)t->recovered, (unsigned int)t->backlog,
+           (unsigned int)t->reordered, (unsigned int)t->duplicates, (unsigned int)t->too_late, (unsigned int)t->gaps,
+           (unsigned int)t->gap_ms_max, s->jitter_x16 / 16.0);
+    uint32_t latency_count = t->latency_count - p->latency_count;
+    if (latency_count > 0) {
+        printf(" latency avg %.1f max %u ms", (double)(t->latency_sum_ms - p->latency_sum_ms) / latency_count,
+               (unsigned int)t->latency_max_ms);
+    }
+    if (t->encrypted > 0 || t->logmel > 0) {
+        printf(" (encrypted %u, log-mel %u)", (unsigned int)t->encrypted, (unsigned int)t->logmel);
+    }
+    printf("\n");
+    s->last_report = *t;
+}
+
+static void report_all(uint32_t interval_ms) {
+    for (uint32_t i = 0; i < RECEIVER_MAX_STREAMS; i++) {
+        if (streams[i].used && streams[i].started) {
+            report_stream(&streams[i], interval_ms);
+        }
+    }
+    fflush(stdout);
+}
+
+static void final_report(uint32_t elapsed_ms) {
+    uint64_t expected = 0;
+    uint64_t frames = 0;
+    uint64_t bytes = 0;
+    uint32_t n = 0;
+    printf("\n=== receiver summary (%.1f s) ===\n", elapsed_ms / 1000.0);
+    for (uint32_t i = 0; i < RECEIVER_MAX_STREAMS; i++) {
+        stream_t *s = &streams[i];
+        if (!s->used || !s->started) {
+            continue;
+        }
+        s->last_report = (stream_counters_t){ 0 };
+        report_stream(s, elapsed_ms);
+        expected += expected_frames(s);
+        frames += s->total.frames;
+        bytes += s->total.bytes;
+        n++;
+        wav_close(&s->wav);
+    }
+    printf("%u streams, %llu/%llu frames (%.3f%% lost), %.1f kbit/s aggregate\n", (unsigned int)n,
+           (unsigned long long)frames, (unsigned long long)expected,
+           (expected > 0) ? 100.0 * (double)(expected - frames) / expected : 0.0, bytes * 8.0 / elapsed_ms);
+}
+
+static void on_signal(int sig) {
+    (void)sig;
+    stop_requested = 1;
+}
+
+static int open_udp(uint16_t port) {
+    int fd = socket(AF_INET, SOCK_DGRAM, 0);
+    struct sockaddr_in addr = { .sin_family = AF_INET, .sin_port = htons(port), .sin_addr.s_addr = htonl(INADDR_ANY) };
+    int size = 1 << 20;     // 报告间隔内的突发不应在套接字缓冲中丢失，否则测得的是接收端的丢包
+    setsockopt(fd, SOL_SOCKET, SO_RCVBUF, &size, sizeof(size));
+    if (fd < 0 || bind(fd, (struct sockaddr *)&addr, sizeof(addr)) != 0) {
+        perror("udp");
+        return -1;
+    }
+    fcntl(fd, F_SETFL, O_NONBLOCK);
+    return fd;
+}
+
+static void usage(const char *argv0) {
+    fprintf(stderr,
+            "usage: %s [-h host] [-p port] [-o wav_dir] [-u] [-U udp_port] [-e] [-c] [-a] [-i report_s] [-t seconds]\n"
+            "  -u  also receive live frames over UDP     -e  echo heartbeats (stand-in for the server)\n"
+            "  -c  answer clock sync requests            -a  also count the archive topic\n", argv0);
+}
+
+int main(int argc, char **argv) {
+    int opt;
+    while ((opt = getopt(argc, argv, "h:p:o:uU:ecai:t:")) != -1) {
+        switch (opt) {
+            case 'h': config.host = optarg; break;
+            case 'p': config.port = (uint16_t)atoi(optarg); break;
+            case 'o': config.wav_dir = optarg; break;
+            case 'u': config.udp = true; break;
+            case 'U': config.udp = true; config.udp_port = (uint16_t)atoi(optarg); break;
+            case 'e': config.echo_heartbeats = true; break;
+            case 'c': config.clock_server = true; break;
+            case 'a': config.archive = true; break;
+            case 'i': config.report_s = (uint32_t)atoi(optarg); break;
+            case 't': config.duration_s = (uint32_t)atoi(optarg); break;
+            default: usage(argv[0]); return 2;
+        }
+    }
+    if (config.report_s == 0) {
+        usage(argv[0]);
+        return 2;
+    }
+    if (config.wav_dir != NULL) {
+        mkdir(config.wav_dir, 0755);
+    }
+    signal(SIGINT, on_signal);
+    signal(SIGTERM, on_signal);
+
+    int reason = 0;
+    if (host_mqtt_connect(&mqtt, config.host, config.port, "meeting_receiver", 60, 5000, &reason) != 0) {
+        fprintf(stderr, "cannot connect to %s:%u (%d)\n", config.host, config.port, reason);
+        return 1;
+    }
+    subscribe_all();
+    int udp_fd = config.udp ? open_udp(config.udp_port) : -1;
+    if (config.udp && udp_fd < 0) {
+        return 1;
+    }
+
+    uint32_t start = host_now_ms();
+    uint32_t last_report = start;
+    uint32_t last_ping = start;
+    static uint8_t datagram[65536];
+    while (!stop_requested && (config.duration_s == 0 || (host_now_ms() - start) < config.duration_s * 1000u)) {
+        struct pollfd fds[2] = { { .fd = mqtt.fd, .events = POLLIN }, { .fd = udp_fd, .events = POLLIN } };
+        if (poll(fds, (udp_fd >= 0) ? 2 : 1, 50) < 0 && errno != EINTR) {
+            break;
+        }
+        uint32_t now = host_now_ms();
+        host_mqtt_message_t msg;
+        int r;
+        while ((r = host_mqtt_read(&mqtt, 0, &msg)) == 1) {
+            if (msg.type == HOST_MQTT_PUBLISH) {
+                on_message(&msg, now);
+            }
+        }
+        if (r < 0) {
+            // 代理断开：重连后继续，流状态保留，期间的丢帧照常统计
+            fprintf(stderr, "connection to broker lost, reconnecting\n");
+            host_mqtt_close(&mqtt);
+            while (!stop_requested && host_mqtt_connect(&mqtt, config.host, config.port, "meeting_receiver", 60, 5000, &reason) != 0) {
+                sleep(1);
+            }
+            subscribe_all();
+            continue;
+        }
+        if (udp_fd >= 0) {
+            ssize_t n;
+            while ((n = recv(udp_fd, datagram, sizeof(datagram), 0)) > 0) {
+                on_datagram(datagram, (size_t)n, now);
+            }
+        }
+        for (uint32_t i = 0; i < RECEIVER_MAX_STREAMS; i++) {
+            if (streams[i].used) {
+                send_feedback(&streams[i], now);
+            }
+        }
+        if ((now - last_ping) >= 30000u) {
+            host_mqtt_ping(&mqtt);
+            last_ping = now;
+        }
+        if ((now - last_report) >= config.report_s * 1000u) {
+            report_all(now - last_report);
+            last_report = now;
+        }
+    }
+
+    final_report(host_now_ms() - start);
+    host_mqtt_close(&mqtt);
+    if (udp_fd >= 0) {
+        close(udp_fd);
+    }
+    return 0;
+}
@@ -0,0 +1,24 @@
+#ifndef SHIM_FREERTOS_H_
+#define SHIM_FREERTOS_H_
+
+// 主机检查用的 FreeRTOS 替身：只有单线程下的队列、调度器挂起、临界区和节拍计数 (1 kHz，取自 CLOCK_MONOTONIC，
+// 离散时间模拟可改为手动推进)，足以编译只依赖这些接口的模块 (如 frame_pool.c、mqtt_stream.c、rate_control.c)。
+// 队列是定长环形缓冲，项按值拷贝；调度器挂起只计数，并记录挂起期间之外的队列操作次数，供检查确认重排在挂起期间完成。
+
+#include <stdint.h>
+#include <stddef.h>
+
+typedef long BaseType_t;
+typedef unsigned long UBaseType_t;
+typedef uint32_t TickType_t;
+
+#define pdFALSE     ((BaseType_t)0)
+#define pdTRUE      ((BaseType_t)1)
+#define pdPASS      (pdTRUE)
+#define pdFAIL      (pdFALSE)
+
+#define configTICK_RATE_HZ      (1000u)
+#define portTICK_PERIOD_MS      ((TickType_t)1000u / configTICK_RATE_HZ)
+#define pdMS_TO_TICKS(ms)       ((TickType_t)(((uint64_t)(ms) * configTICK_RATE_HZ) / 1000u))
+
+#endif /* SHIM_FREERTOS_H_ */
@@ -0,0 +1,95 @@
+#ifndef SHIM_CORE_HTTP_CLIENT_H_
+#define SHIM_CORE_HTTP_CLIENT_H_
+
+// 主机检查用的 coreHTTP 替身：只实现 http_upload.c 用到的接口，类型和函数签名与 coreHTTP v2 相同。
+// 请求头的写法与 coreHTTP 一致 (请求行、User-Agent、Host、可选的 Connection: keep-alive，有负载时由 HTTPClient_Send()
+// 追加 Content-Length)；响应按 Content-Length 读完，不支持分块响应。解析不用 llhttp，主机上的耗时不代表 coreHTTP 本身。
+
+#include "core_http_config.h"
+#include <stdint.h>
+#include <stddef.h>
+
+#define HTTP_METHOD_GET                             "GET"
+#define HTTP_METHOD_PUT                             "PUT"
+#define HTTP_METHOD_POST                            "POST"
+#define HTTP_METHOD_HEAD                            "HEAD"
+
+#define HTTP_REQUEST_KEEP_ALIVE_FLAG                0x1U
+#define HTTP_RESPONSE_CONNECTION_CLOSE_FLAG         0x1U
+#define HTTP_RESPONSE_CONNECTION_KEEP_ALIVE_FLAG    0x2U
+#define HTTP_SEND_DISABLE_CONTENT_LENGTH_FLAG       0x1U
+
+typedef struct NetworkContext NetworkContext_t;
+typedef int32_t (*TransportRecv_t)(NetworkContext_t *pNetworkContext, void *pBuffer, size_t bytesToRecv);
+typedef int32_t (*TransportSend_t)(NetworkContext_t *pNetworkContext, const void *pBuffer, size_t bytesToSend);
+
+typedef struct {
+    TransportRecv_t recv;
+    TransportSend_t send;
+    void *writev;
+    NetworkContext_t *pNetworkContext;
+} TransportInterface_t;
+
+typedef enum {
+    HTTPSuccess = 0,
+    HTTPInvalidParameter,
+    HTTPNetworkError,
+    HTTPPartialResponse,
+    HTTPNoResponse,
+    HTTPInsufficientMemory,
+    HTTPSecurityAlertResponseHeadersSizeLimitExceeded,
+    HTTPSecurityAlertExtraneousResponseData,
+    HTTPSecurityAlertInvalidChunkHeader,
+    HTTPSecurityAlertInvalidProtocolVersion,
+    HTTPSecurityAlertInvalidStatusCode,
+    HTTPSecurityAlertInvalidCharacter,
+    HTTPSecurityAlertInvalidContentLength,
+    HTTPParserInternalError,
+    HTTPHeaderNotFound,
+    HTTPInvalidResponse
+} HTTPStatus_t;
+
+typedef struct {
+    const char *pMethod;
+    size_t methodLen;
+    const char *pPath;
+    size_t pathLen;
+    const char *pHost;
+    size_t hostLen;
+    uint32_t reqFlags;
+} HTTPRequestInfo_t;
+
+typedef struct {
+    uint8_t *pBuffer;
+    size_t bufferLen;
+    size_t headersLen;
+} HTTPRequestHeaders_t;
+
+typedef uint32_t (*HTTPClient_GetCurrentTimeFunc_t)(void);
+
+typedef struct {
+    uint8_t *pBuffer;
+    size_t bufferLen;
+    void *pHeaderParsingCallback;
+    HTTPClient_GetCurrentTimeFunc_t getTime;
+    const uint8_t *pHeaders;
+    size_t headersLen;
+    const uint8_t *pBody;
+    size_t bodyLen;
+    uint16_t statusCode;
+    size_t contentLength;
+    size_t headerCount;
+    uint32_t respFlags;
+} HTTPResponse_t;
+
+HTTPStatus_t HTTPClient_InitializeRequestHeaders(HTTPRequestHeaders_t *pRequestHeaders, const HTTPRequestInfo_t *pRequestInfo);
+HTTPStatus_t HTTPClient_AddHeader(HTTPRequestHeaders_t *pRequestHeaders, const char *pField, size_t fieldLen,
+                                  const char *pValue, size_t valueLen);
+HTTPStatus_t HTTPClient_Send(const TransportInterface_t *pTransport, HTTPRequestHeaders_t *pRequestHeaders,
+                             const uint8_t *pRequestBodyBuf, size_t reqBodyBufLen, HTTPResponse_t *pResponse,
+                             uint32_t sendFlags);
+HTTPStatus_t HTTPClient_ReadHeader(const HTTPResponse_t *pResponse, const char *pField, size_t fieldLen,
+                                   const char **pValueLoc, size_t *pValueLen);
+const char *HTTPClient_strerror(HTTPStatus_t status);
+
+#endif /* SHIM_CORE_HTTP_CLIENT_H_ */
@@ -0,0 +1,202 @@
+#include "core_http_client.h"
+#include <ctype.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define HEADER_END          "\r\n\r\n"
+#define HEADER_END_LEN      (4u)
+
+// 在结尾的空行之前插入一行头 (与 coreHTTP 一样，headersLen 始终包含结尾的空行)
+static HTTPStatus_t append_line(HTTPRequestHeaders_t *headers, const char *line, size_t len) {
+    if (headers->headersLen < 2u || headers->headersLen + len + 2u > headers->bufferLen) {
+        return HTTPInsufficientMemory;
+    }
+    uint8_t *end = headers->pBuffer + headers->headersLen - 2u;
+    memcpy(end, line, len);
+    memcpy(end + len, "\r\n\r\n", 4u);
+    headers->headersLen += len + 2u;
+    return HTTPSuccess;
+}
+
+HTTPStatus_t HTTPClient_InitializeRequestHeaders(HTTPRequestHeaders_t *headers, const HTTPRequestInfo_t *info) {
+    if (headers == NULL || headers->pBuffer == NULL || info == NULL || info->pMethod == NULL || info->pHost == NULL) {
+        return HTTPInvalidParameter;
+    }
+    int n = snprintf((char *)headers->pBuffer, headers->bufferLen, "%.*s %.*s HTTP/1.1\r\nUser-Agent: %s\r\nHost: %.*s\r\n%s\r\n",
+                     (int)info->methodLen, info->pMethod, (int)info->pathLen, (info->pPath != NULL) ? info->pPath : "/",
+                     HTTP_USER_AGENT_VALUE, (int)info->hostLen, info->pHost,
+                     (info->reqFlags & HTTP_REQUEST_KEEP_ALIVE_FLAG) ? "Connection: keep-alive\r\n" : "");
+    if (n < 0 || (size_t)n >= headers->bufferLen) {
+        return HTTPInsufficientMemory;
+    }
+    headers->headersLen = (size_t)n;
+    return HTTPSuccess;
+}
+
+HTTPStatus_t HTTPClient_AddHeader(HTTPRequestHeaders_t *headers, const char *field, size_t field_len, const char *value,
+                                  size_t value_len) {
+    if (headers == NULL || field == NULL || value == NULL || field_len == 0) {
+        return HTTPInvalidParameter;
+    }
+    char line[512];
+    if (field_len + 2u + value_len > sizeof(line)) {
+        return HTTPInsufficientMemory;
+    }
+    memcpy(line, field, field_len);
+    memcpy(line + field_len, ": ", 2u);
+    memcpy(line + field_len + 2u, value, value_len);
+    return append_line(headers, line, field_len + 2u + value_len);
+}
+
+static bool send_all(const TransportInterface_t *transport, const uint8_t *data, size_t len) {
+    while (len > 0) {
+        int32_t n = transport->send(transport->pNetworkContext, data, len);
+        if (n <= 0) {
+            return false;
+        }
+        data += n;
+        len -= (size_t)n;
+    }
+    return true;
+}
+
+static const uint8_t *find(const uint8_t *data, size_t len, const char *needle, size_t needle_len) {
+    for (size_t i = 0; i + needle_len <= len; i++) {
+        if (memcmp(data + i, needle, needle_len) == 0) {
+            return data + i;
+        }
+    }
+    return NULL;
+}
+
+// 在头部区域中按字段名 (不区分大小写) 查找，返回去掉首尾空白的值
+static bool find_header(const uint8_t *headers, size_t headers_len, const char *field, size_t field_len, const char **value,
+                        size_t *value_len) {
+    const char *p = (const char *)headers;
+    const char *end = p + headers_len;
+    while (p < end) {
+        const char *eol = memchr(p, '\n', (size_t)(end - p));
+        const char *line_end = (eol != NULL) ? eol : end;
+        if ((size_t)(line_end - p) > field_len && p[field_len] == ':' && strncasecmp(p, field, field_len) == 0) {
+            const char *v = p + field_len + 1;
+            const char *v_end = line_end;
+            while (v < v_end && (*v == ' ' || *v == '\t')) {
+                v++;
+            }
+            while (v_end > v && isspace((unsigned char)v_end[-1])) {
+                v_end--;
+            }
+            *value = v;
+            *value_len = (size_t)(v_end - v);
+            return true;
+        }
+        p = line_end + 1;
+    }
+    return false;
+}
+
+HTTPStatus_t HTTPClient_Send(const TransportInterface_t *transport, HTTPRequestHeaders_t *headers, const uint8_t *body,
+                             size_t body_len, HTTPResponse_t *response, uint32_t send_flags) {
+    if (transport == NULL || transport->send == NULL || transport->recv == NULL || headers == NULL || response == NULL ||
+        response->pBuffer == NULL) {
+        return HTTPInvalidParameter;
+    }
+    if (body != NULL && (send_flags & HTTP_SEND_DISABLE_CONTENT_LENGTH_FLAG) == 0) {
+        char line[40];
+        int n = snprintf(line, sizeof(line), "Content-Length: %lu", (unsigned long)body_len);
+        HTTPStatus_t status = append_line(headers, line, (size_t)n);
+        if (status != HTTPSuccess) {
+            return status;
+        }
+    }
+    if (!send_all(transport, headers->pBuffer, headers->headersLen) || (body != NULL && !send_all(transport, body, body_len))) {
+        return HTTPNetworkError;
+    }
+
+    // 读到头部结束，再按 Content-Length 读完负载；传输层返回 0 时在 HTTP_RECV_RETRY_TIMEOUT_MS 内重试
+    size_t received = 0;
+    size_t total = 0;
+    const uint8_t *header_end = NULL;
+    uint32_t last_data_ms = (response->getTime != NULL) ? response->getTime() : 0;
+    memset(&response->pHeaders, 0, sizeof(*response) - offsetof(HTTPResponse_t, pHeaders));
+    while (header_end == NULL || received < total) {
+        if (received == response->bufferLen) {
+            return HTTPInsufficientMemory;
+        }
+        int32_t n = transport->recv(transport->pNetworkContext, response->pBuffer + received, response->bufferLen - received);
+        if (n < 0) {
+            return HTTPNetworkError;
+        }
+        if (n == 0) {
+            if (response->getTime == NULL || response->getTime() - last_data_ms >= HTTP_RECV_RETRY_TIMEOUT_MS) {
+                return (received == 0) ? HTTPNoResponse : HTTPPartialResponse;
+            }
+            continue;
+        }
+        received += (size_t)n;
+        if (response->getTime != NULL) {
+            last_data_ms = response->getTime();
+        }
+        if (header_end != NULL) {
+            continue;
+        }
+        header_end = find(response->pBuffer, received, HEADER_END, HEADER_END_LEN);
+        if (header_end == NULL) {
+            continue;
+        }
+        const char *status_line = (const char *)response->pBuffer;
+        if (received < 12u || strncmp(status_line, "HTTP/1.", 7) != 0) {
+            return HTTPSecurityAlertInvalidProtocolVersion;
+        }
+        response->statusCode = (uint16_t)strtoul(status_line + 9, NULL, 10);
+        if (response->statusCode < 100u || response->statusCode > 999u) {
+            return HTTPSecurityAlertInvalidStatusCode;
+        }
+        const uint8_t *first_header = find(response->pBuffer, received, "\r\n", 2u) + 2;
+        response->pHeaders = first_header;
+        response->headersLen = (size_t)(header_end + 2 - first_header);
+        const char *value;
+        size_t value_len;
+        if (find_header(response->pHeaders, response->headersLen, "Content-Length", 14u, &value, &value_len)) {
+            response->contentLength = strtoul(value, NULL, 10);
+        }
+        response->respFlags = HTTP_RESPONSE_CONNECTION_KEEP_ALIVE_FLAG;
+        if (find_header(response->pHeaders, response->headersLen, "Connection", 10u, &value, &value_len) &&
+            value_len == 5u && strncasecmp(value, "close", 5u) == 0) {
+            response->respFlags = HTTP_RESPONSE_CONNECTION_CLOSE_FLAG;
+        }
+        for (const uint8_t *p = response->pHeaders; p < response->pHeaders + response->headersLen; p++) {
+            response->headerCount += (*p == '\n');
+        }
+        total = (size_t)(header_end + HEADER_END_LEN - response->pBuffer) + response->contentLength;
+    }
+    if (received > total) {
+        return HTTPSecurityAlertExtraneousResponseData;
+    }
+    response->pBody = header_end + HEADER_END_LEN;
+    response->bodyLen = response->contentLength;
+    return HTTPSuccess;
+}
+
+HTTPStatus_t HTTPClient_ReadHeader(const HTTPResponse_t *response, const char *field, size_t field_len, const char **value,
+                                   size_t *value_len) {
+    if (response == NULL || response->pHeaders == NULL || field == NULL || value == NULL || value_len == NULL) {
+        return HTTPInvalidParameter;
+    }
+    return find_header(response->pHeaders, response->headersLen, field, field_len, value, value_len) ? HTTPSuccess
+                                                                                                      : HTTPHeaderNotFound;
+}
+
+const char *HTTPClient_strerror(HTTPStatus_t status) {
+    static const char *const names[] = {
+        "HTTPSuccess", "HTTPInvalidParameter", "HTTPNetworkError", "HTTPPartialResponse", "HTTPNoResponse",
+        "HTTPInsufficientMemory", "HTTPSecurityAlertResponseHeadersSizeLimitExceeded",
+        "HTTPSecurityAlertExtraneousResponseData", "HTTPSecurityAlertInvalidChunkHeader",
+        "HTTPSecurityAlertInvalidProtocolVersion", "HTTPSecurityAlertInvalidStatusCode",
+        "HTTPSecurityAlertInvalidCharacter", "HTTPSecurityAlertInvalidContentLength", "HTTPParserInternalError",
+        "HTTPHeaderNotFound", "HTTPInvalidResponse"
+    };
+    return ((size_t)status < sizeof(names) / sizeof(names[0])) ? names[status] : "Invalid status code!";
+}
@@ -0,0 +1,19 @@
+#ifndef SHIM_CY_RESULT_H_
+#define SHIM_CY_RESULT_H_
+
+// 主机检查用的 cy_result.h 替身：结果码的位布局与 ModusToolbox 相同 (模块 14 位 | 类型 2 位 | 代码 16 位)。
+
+#include <stdint.h>
+
+typedef uint32_t cy_rslt_t;
+
+#define CY_RSLT_SUCCESS                 ((cy_rslt_t)0u)
+#define CY_RSLT_TYPE_INFO               (0u)
+#define CY_RSLT_TYPE_WARNING            (1u)
+#define CY_RSLT_TYPE_ERROR              (2u)
+#define CY_RSLT_TYPE_FATAL              (3u)
+#define CY_RSLT_MODULE_MIDDLEWARE_BASE  (0x0200u)
+#define CY_RSLT_CREATE(type, module, code) \
+    ((cy_rslt_t)((((module) & 0x3FFFu) << 18) | (((type) & 0x3u) << 16) | ((code) & 0xFFFFu)))
+
+#endif /* SHIM_CY_RESULT_H_ */
@@ -0,0 +1,70 @@
+#ifndef SHIM_CY_SECURE_SOCKETS_H_
+#define SHIM_CY_SECURE_SOCKETS_H_
+
+// 主机检查用的 secure-sockets 替身：TCP (不含 TLS) 和 UDP，每个 cy_socket_t 是一个 BSD 套接字。
+// 接收超时返回 CY_RSLT_MODULE_SECURE_SOCKETS_TIMEOUT，对端关闭返回 CY_RSLT_MODULE_SECURE_SOCKETS_CLOSED，与 secure-sockets 一致。
+
+#include "cy_result.h"
+#include <stdbool.h>
+#include <stdint.h>
+
+#define CY_RSLT_MODULE_SECURE_SOCKETS   (0x0201u)
+#define CY_RSLT_MODULE_SECURE_SOCKETS_BADARG        CY_RSLT_CREATE(CY_RSLT_TYPE_ERROR, CY_RSLT_MODULE_SECURE_SOCKETS, 1)
+#define CY_RSLT_MODULE_SECURE_SOCKETS_NOMEM         CY_RSLT_CREATE(CY_RSLT_TYPE_ERROR, CY_RSLT_MODULE_SECURE_SOCKETS, 3)
+#define CY_RSLT_MODULE_SECURE_SOCKETS_NOT_CONNECTED CY_RSLT_CREATE(CY_RSLT_TYPE_ERROR, CY_RSLT_MODULE_SECURE_SOCKETS, 10)
+#define CY_RSLT_MODULE_SECURE_SOCKETS_TIMEOUT       CY_RSLT_CREATE(CY_RSLT_TYPE_ERROR, CY_RSLT_MODULE_SECURE_SOCKETS, 13)
+#define CY_RSLT_MODULE_SECURE_SOCKETS_CLOSED        CY_RSLT_CREATE(CY_RSLT_TYPE_ERROR, CY_RSLT_MODULE_SECURE_SOCKETS, 14)
+#define CY_RSLT_MODULE_SECURE_SOCKETS_HOST_NOT_FOUND CY_RSLT_CREATE(CY_RSLT_TYPE_ERROR, CY_RSLT_MODULE_SECURE_SOCKETS, 18)
+#define CY_RSLT_MODULE_SECURE_SOCKETS_TCPIP_ERROR   CY_RSLT_CREATE(CY_RSLT_TYPE_ERROR, CY_RSLT_MODULE_SECURE_SOCKETS, 20)
+
+#define CY_SOCKET_DOMAIN_AF_INET        (2)
+#define CY_SOCKET_TYPE_STREAM           (1)
+#define CY_SOCKET_TYPE_DGRAM            (2)
+#define CY_SOCKET_IPPROTO_TCP           (1)
+#define CY_SOCKET_IPPROTO_UDP           (2)
+#define CY_SOCKET_SOL_SOCKET            (1)
+#define CY_SOCKET_SO_RCVTIMEO           (0)
+#define CY_SOCKET_SO_SNDTIMEO           (1)
+#define CY_SOCKET_FLAGS_NONE            (0)
+
+typedef void *cy_socket_t;
+
+typedef enum {
+    CY_SOCKET_IP_VER_V4 = 4,
+    CY_SOCKET_IP_VER_V6 = 6
+} cy_socket_ip_version_t;
+
+typedef struct {
+    cy_socket_ip_version_t version;
+    union {
+        uint32_t v4;                // 网络字节序
+        uint32_t v6[4];
+    } ip;
+} cy_socket_ip_address_t;
+
+typedef struct {
+    uint16_t port;
+    cy_socket_ip_address_t ip_address;
+} cy_socket_sockaddr_t;
+
+// 非 0 时 cy_socket_connect() 和 cy_socket_sendto() 用它替换目标端口：主机检查的代理运行在临时端口上
+extern uint16_t shim_socket_port_override;
+// cy_socket_send() 的调用次数 (检查一帧是否一次发出)
+extern uint32_t shim_socket_sends;
+// 为 true 时 cy_socket_send() 不进入内核、直接报告全部发出，用于只测量发布路径本身的 CPU 开销
+extern bool shim_socket_discard;
+// 非 0 时接下来这么多次发送返回 CY_RSLT_MODULE_SECURE_SOCKETS_NOMEM (协议栈缓冲不足)，每次减一
+extern uint32_t shim_socket_send_failures;
+
+cy_rslt_t cy_socket_gethostbyname(const char *hostname, cy_socket_ip_version_t ip_ver, cy_socket_ip_address_t *addr);
+cy_rslt_t cy_socket_create(int domain, int type, int protocol, cy_socket_t *handle);
+cy_rslt_t cy_socket_setsockopt(cy_socket_t handle, int level, int optname, const void *optval, uint32_t optlen);
+cy_rslt_t cy_socket_connect(cy_socket_t handle, cy_socket_sockaddr_t *address, uint32_t address_length);
+cy_rslt_t cy_socket_send(cy_socket_t handle, const void *buffer, uint32_t length, int flags, uint32_t *bytes_sent);
+cy_rslt_t cy_socket_sendto(cy_socket_t handle, const void *buffer, uint32_t length, int flags,
+                           const cy_socket_sockaddr_t *dest_addr, uint32_t address_length, uint32_t *bytes_sent);
+cy_rslt_t cy_socket_recv(cy_socket_t handle, void *buffer, uint32_t length, int flags, uint32_t *bytes_received);
+cy_rslt_t cy_socket_disconnect(cy_socket_t handle, uint32_t timeout);
+cy_rslt_t cy_socket_delete(cy_socket_t handle);
+
+#endif /* SHIM_CY_SECURE_SOCKETS_H_ */
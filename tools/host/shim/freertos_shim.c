@@ -0,0 +1,68 @@
+#include "FreeRTOS.h"
+#include "queue.h"
+#include "task.h"
+#include <string.h>
+#include <time.h>
+
+uint32_t shim_suspend_depth;
+uint32_t shim_critical_depth;
+bool shim_manual_ticks;
+TickType_t shim_tick_count;
+
+QueueHandle_t xQueueCreateStatic(UBaseType_t length, UBaseType_t item_size, uint8_t *storage, StaticQueue_t *queue) {
+    memset(queue, 0, sizeof(*queue));
+    queue->storage = storage;
+    queue->length = length;
+    queue->item_size = item_size;
+    return queue;
+}
+
+BaseType_t xQueueSend(QueueHandle_t queue, const void *item, TickType_t ticks_to_wait) {
+    (void)ticks_to_wait;
+    if (shim_suspend_depth == 0) {
+        queue->ops_while_running++;
+    }
+    if (queue->count == queue->length) {
+        return pdFAIL;
+    }
+    UBaseType_t tail = (queue->head + queue->count) % queue->length;
+    memcpy(queue->storage + tail * queue->item_size, item, queue->item_size);
+    queue->count++;
+    return pdPASS;
+}
+
+BaseType_t xQueueReceive(QueueHandle_t queue, void *item, TickType_t ticks_to_wait) {
+    (void)ticks_to_wait;
+    if (shim_suspend_depth == 0) {
+        queue->ops_while_running++;
+    }
+    if (queue->count == 0) {
+        return pdFAIL;
+    }
+    memcpy(item, queue->storage + queue->head * queue->item_size, queue->item_size);
+    queue->head = (queue->head + 1) % queue->length;
+    queue->count--;
+    return pdPASS;
+}
+
+UBaseType_t uxQueueMessagesWaiting(QueueHandle_t queue) {
+    return queue->count;
+}
+
+void vTaskSuspendAll(void) {
+    shim_suspend_depth++;
+}
+
+BaseType_t xTaskResumeAll(void) {
+    shim_suspend_depth--;
+    return pdFALSE;
+}
+
+TickType_t xTaskGetTickCount(void) {
+    if (shim_manual_ticks) {
+        return shim_tick_count;
+    }
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (TickType_t)((uint64_t)ts.tv_sec * configTICK_RATE_HZ + (uint64_t)ts.tv_nsec / (1000000000u / configTICK_RATE_HZ));
+}
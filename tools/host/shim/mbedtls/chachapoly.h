@@ -0,0 +1,27 @@
+#ifndef SHIM_MBEDTLS_CHACHAPOLY_H_
+#define SHIM_MBEDTLS_CHACHAPOLY_H_
+
+// 主机检查用的替身：payload_crypto.c 用到的 ChaCha20-Poly1305 接口，类型和函数签名与 mbedTLS 3.x 相同，
+// 由 mbedtls_shim.c 经主机上的 OpenSSL 实现 (见 gcm.h)。
+
+#include <stddef.h>
+
+#define MBEDTLS_ERR_CHACHAPOLY_BAD_STATE    -0x0054
+#define MBEDTLS_ERR_CHACHAPOLY_AUTH_FAILED  -0x0056
+
+typedef struct {
+    void *encrypt;                  // EVP_CIPHER_CTX，setkey 时设置密钥，每次运算只换 nonce
+    void *decrypt;
+} mbedtls_chachapoly_context;
+
+void mbedtls_chachapoly_init(mbedtls_chachapoly_context *ctx);
+int mbedtls_chachapoly_setkey(mbedtls_chachapoly_context *ctx, const unsigned char key[32]);
+int mbedtls_chachapoly_encrypt_and_tag(mbedtls_chachapoly_context *ctx, size_t length, const unsigned char nonce[12],
+                                       const unsigned char *aad, size_t aad_len, const unsigned char *input,
+                                       unsigned char *output, unsigned char tag[16]);
+int mbedtls_chachapoly_auth_decrypt(mbedtls_chachapoly_context *ctx, size_t length, const unsigned char nonce[12],
+                                    const unsigned char *aad, size_t aad_len, const unsigned char tag[16],
+                                    const unsigned char *input, unsigned char *output);
+void mbedtls_chachapoly_free(mbedtls_chachapoly_context *ctx);
+
+#endif /* SHIM_MBEDTLS_CHACHAPOLY_H_ */
@@ -0,0 +1,37 @@
+#ifndef SHIM_MBEDTLS_GCM_H_
+#define SHIM_MBEDTLS_GCM_H_
+
+// 主机检查用的替身：payload_crypto.c 用到的 GCM 接口，类型和函数签名与 mbedTLS 3.x 相同。
+// 只包含头文件的模块 (经 audio_task.h) 不需要链接；真正加解密的检查链接 mbedtls_shim.c，由主机上的 OpenSSL 完成，
+// 主机上的耗时不代表 mbedTLS 或设备的硬件 AES。
+
+#include <stddef.h>
+
+#define MBEDTLS_GCM_DECRYPT         0
+#define MBEDTLS_GCM_ENCRYPT         1
+#define MBEDTLS_ERR_GCM_AUTH_FAILED -0x0012
+#define MBEDTLS_ERR_GCM_BAD_INPUT   -0x0014
+
+typedef enum {
+    MBEDTLS_CIPHER_ID_NONE = 0,
+    MBEDTLS_CIPHER_ID_NULL,
+    MBEDTLS_CIPHER_ID_AES,
+} mbedtls_cipher_id_t;
+
+typedef struct {
+    void *encrypt;                  // EVP_CIPHER_CTX，setkey 时设置密钥，每次运算只换 nonce
+    void *decrypt;
+} mbedtls_gcm_context;
+
+void mbedtls_gcm_init(mbedtls_gcm_context *ctx);
+int mbedtls_gcm_setkey(mbedtls_gcm_context *ctx, mbedtls_cipher_id_t cipher, const unsigned char *key,
+                       unsigned int keybits);
+int mbedtls_gcm_crypt_and_tag(mbedtls_gcm_context *ctx, int mode, size_t length, const unsigned char *iv, size_t iv_len,
+                              const unsigned char *add, size_t add_len, const unsigned char *input, unsigned char *output,
+                              size_t tag_len, unsigned char *tag);
+int mbedtls_gcm_auth_decrypt(mbedtls_gcm_context *ctx, size_t length, const unsigned char *iv, size_t iv_len,
+                             const unsigned char *add, size_t add_len, const unsigned char *tag, size_t tag_len,
+                             const unsigned char *input, unsigned char *output);
+void mbedtls_gcm_free(mbedtls_gcm_context *ctx);
+
+#endif /* SHIM_MBEDTLS_GCM_H_ */
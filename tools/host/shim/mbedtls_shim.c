@@ -0,0 +1,138 @@
+#include "mbedtls/gcm.h"
+#include "mbedtls/chachapoly.h"
+#include <openssl/evp.h>
+#include <string.h>
+
+// 两个 EVP 上下文分别用于加密和解密，setkey 时设置算法和密钥，每次运算只换 nonce
+
+static void evp_free(void **encrypt, void **decrypt) {
+    EVP_CIPHER_CTX_free(*encrypt);
+    EVP_CIPHER_CTX_free(*decrypt);
+    *encrypt = NULL;
+    *decrypt = NULL;
+}
+
+static int evp_setkey(void **encrypt, void **decrypt, const EVP_CIPHER *cipher, const unsigned char *key) {
+    evp_free(encrypt, decrypt);
+    EVP_CIPHER_CTX *enc = EVP_CIPHER_CTX_new();
+    EVP_CIPHER_CTX *dec = EVP_CIPHER_CTX_new();
+    *encrypt = enc;
+    *decrypt = dec;
+    if (enc == NULL || dec == NULL || EVP_EncryptInit_ex(enc, cipher, NULL, key, NULL) != 1 ||
+        EVP_DecryptInit_ex(dec, cipher, NULL, key, NULL) != 1) {
+        evp_free(encrypt, decrypt);
+        return -1;
+    }
+    return 0;
+}
+
+static int evp_seal(void *ctx, size_t length, const unsigned char *iv, size_t iv_len, const unsigned char *add,
+                    size_t add_len, const unsigned char *input, unsigned char *output, size_t tag_len,
+                    unsigned char *tag) {
+    EVP_CIPHER_CTX *enc = ctx;
+    int n;
+    if (enc == NULL || EVP_CIPHER_CTX_ctrl(enc, EVP_CTRL_AEAD_SET_IVLEN, (int)iv_len, NULL) != 1 ||
+        EVP_EncryptInit_ex(enc, NULL, NULL, NULL, iv) != 1 ||
+        (add_len > 0 && EVP_EncryptUpdate(enc, NULL, &n, add, (int)add_len) != 1) ||
+        (length > 0 && EVP_EncryptUpdate(enc, output, &n, input, (int)length) != 1) ||
+        EVP_EncryptFinal_ex(enc, output + length, &n) != 1 ||
+        EVP_CIPHER_CTX_ctrl(enc, EVP_CTRL_AEAD_GET_TAG, (int)tag_len, tag) != 1) {
+        return -1;
+    }
+    return 0;
+}
+
+// 认证失败时与 mbedTLS 一样清零输出
+static int evp_open(void *ctx, size_t length, const unsigned char *iv, size_t iv_len, const unsigned char *add,
+                    size_t add_len, const unsigned char *tag, size_t tag_len, const unsigned char *input,
+                    unsigned char *output, int auth_failed) {
+    EVP_CIPHER_CTX *dec = ctx;
+    unsigned char tag_copy[16];
+    int n;
+    if (dec == NULL || tag_len > sizeof(tag_copy)) {
+        return -1;
+    }
+    memcpy(tag_copy, tag, tag_len);
+    if (EVP_CIPHER_CTX_ctrl(dec, EVP_CTRL_AEAD_SET_IVLEN, (int)iv_len, NULL) != 1 ||
+        EVP_DecryptInit_ex(dec, NULL, NULL, NULL, iv) != 1 ||
+        EVP_CIPHER_CTX_ctrl(dec, EVP_CTRL_AEAD_SET_TAG, (int)tag_len, tag_copy) != 1 ||
+        (add_len > 0 && EVP_DecryptUpdate(dec, NULL, &n, add, (int)add_len) != 1) ||
+        (length > 0 && EVP_DecryptUpdate(dec, output, &n, input, (int)length) != 1)) {
+        return -1;
+    }
+    if (EVP_DecryptFinal_ex(dec, output + length, &n) != 1) {
+        memset(output, 0, length);
+        return auth_failed;
+    }
+    return 0;
+}
+
+void mbedtls_gcm_init(mbedtls_gcm_context *ctx) {
+    memset(ctx, 0, sizeof(*ctx));
+}
+
+int mbedtls_gcm_setkey(mbedtls_gcm_context *ctx, mbedtls_cipher_id_t cipher, const unsigned char *key,
+                       unsigned int keybits) {
+    const EVP_CIPHER *evp = (keybits == 128) ? EVP_aes_128_gcm() : (keybits == 192) ? EVP_aes_192_gcm()
+                          : (keybits == 256) ? EVP_aes_256_gcm() : NULL;
+    if (cipher != MBEDTLS_CIPHER_ID_AES || evp == NULL) {
+        return MBEDTLS_ERR_GCM_BAD_INPUT;
+    }
+    return (evp_setkey(&ctx->encrypt, &ctx->decrypt, evp, key) == 0) ? 0 : MBEDTLS_ERR_GCM_BAD_INPUT;
+}
+
+int mbedtls_gcm_crypt_and_tag(mbedtls_gcm_context *ctx, int mode, size_t length, const unsigned char *iv, size_t iv_len,
+                              const unsigned char *add, size_t add_len, const unsigned char *input, unsigned char *output,
+                              size_t tag_len, unsigned char *tag) {
+    if (mode != MBEDTLS_GCM_ENCRYPT || iv_len == 0 || tag_len < 4 || tag_len > 16) {
+        return MBEDTLS_ERR_GCM_BAD_INPUT;
+    }
+    return (evp_seal(ctx->encrypt, length, iv, iv_len, add, add_len, input, output, tag_len, tag) == 0)
+               ? 0
+               : MBEDTLS_ERR_GCM_BAD_INPUT;
+}
+
+int mbedtls_gcm_auth_decrypt(mbedtls_gcm_context *ctx, size_t length, const unsigned char *iv, size_t iv_len,
+                             const unsigned char *add, size_t add_len, const unsigned char *tag, size_t tag_len,
+                             const unsigned char *input, unsigned char *output) {
+    if (iv_len == 0 || tag_len < 4 || tag_len > 16) {
+        return MBEDTLS_ERR_GCM_BAD_INPUT;
+    }
+    int ret = evp_open(ctx->decrypt, length, iv, iv_len, add, add_len, tag, tag_len, input, output,
+                       MBEDTLS_ERR_GCM_AUTH_FAILED);
+    return (ret == -1) ? MBEDTLS_ERR_GCM_BAD_INPUT : ret;
+}
+
+void mbedtls_gcm_free(mbedtls_gcm_context *ctx) {
+    evp_free(&ctx->encrypt, &ctx->decrypt);
+}
+
+void mbedtls_chachapoly_init(mbedtls_chachapoly_context *ctx) {
+    memset(ctx, 0, sizeof(*ctx));
+}
+
+int mbedtls_chachapoly_setkey(mbedtls_chachapoly_context *ctx, const unsigned char key[32]) {
+    return (evp_setkey(&ctx->encrypt, &ctx->decrypt, EVP_chacha20_poly1305(), key) == 0)
+               ? 0
+               : MBEDTLS_ERR_CHACHAPOLY_BAD_STATE;
+}
+
+int mbedtls_chachapoly_encrypt_and_tag(mbedtls_chachapoly_context *ctx, size_t length, const unsigned char nonce[12],
+                                       const unsigned char *aad, size_t aad_len, const unsigned char *input,
+                                       unsigned char *output, unsigned char tag[16]) {
+    return (evp_seal(ctx->encrypt, length, nonce, 12, aad, aad_len, input, output, 16, tag) == 0)
+               ? 0
+               : MBEDTLS_ERR_CHACHAPOLY_BAD_STATE;
+}
+
+int mbedtls_chachapoly_auth_decrypt(mbedtls_chachapoly_context *ctx, size_t length, const unsigned char nonce[12],
+                                    const unsigned char *aad, size_t aad_len, const unsigned char tag[16],
+                                    const unsigned char *input, unsigned char *output) {
+    int ret = evp_open(ctx->decrypt, length, nonce, 12, aad, aad_len, tag, 16, input, output,
+                       MBEDTLS_ERR_CHACHAPOLY_AUTH_FAILED);
+    return (ret == -1) ? MBEDTLS_ERR_CHACHAPOLY_BAD_STATE : ret;
+}
+
+void mbedtls_chachapoly_free(mbedtls_chachapoly_context *ctx) {
+    evp_free(&ctx->encrypt, &ctx->decrypt);
+}
@@ -0,0 +1,22 @@
+#ifndef SHIM_QUEUE_H_
+#define SHIM_QUEUE_H_
+
+#include "FreeRTOS.h"
+
+typedef struct {
+    uint8_t *storage;
+    UBaseType_t length;
+    UBaseType_t item_size;
+    UBaseType_t head;
+    UBaseType_t count;
+    uint32_t ops_while_running;     // 调度器未挂起时的收发次数 (含失败的)
+} StaticQueue_t;
+
+typedef StaticQueue_t *QueueHandle_t;
+
+QueueHandle_t xQueueCreateStatic(UBaseType_t length, UBaseType_t item_size, uint8_t *storage, StaticQueue_t *queue);
+BaseType_t xQueueSend(QueueHandle_t queue, const void *item, TickType_t ticks_to_wait);
+BaseType_t xQueueReceive(QueueHandle_t queue, void *item, TickType_t ticks_to_wait);
+UBaseType_t uxQueueMessagesWaiting(QueueHandle_t queue);
+
+#endif /* SHIM_QUEUE_H_ */
@@ -0,0 +1,142 @@
+#include "cy_secure_sockets.h"
+#include <arpa/inet.h>
+#include <errno.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <stdint.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+uint16_t shim_socket_port_override;
+uint32_t shim_socket_sends;
+bool shim_socket_discard;
+uint32_t shim_socket_send_failures;
+
+// 句柄直接保存文件描述符 + 1，0 留给 NULL
+static int fd_of(cy_socket_t handle) {
+    return (int)(intptr_t)handle - 1;
+}
+
+cy_rslt_t cy_socket_gethostbyname(const char *hostname, cy_socket_ip_version_t ip_ver, cy_socket_ip_address_t *addr) {
+    struct in_addr in;
+    if (ip_ver != CY_SOCKET_IP_VER_V4 || inet_pton(AF_INET, hostname, &in) != 1) {
+        return CY_RSLT_MODULE_SECURE_SOCKETS_HOST_NOT_FOUND;
+    }
+    addr->version = CY_SOCKET_IP_VER_V4;
+    addr->ip.v4 = in.s_addr;
+    return CY_RSLT_SUCCESS;
+}
+
+cy_rslt_t cy_socket_create(int domain, int type, int protocol, cy_socket_t *handle) {
+    bool tcp = (type == CY_SOCKET_TYPE_STREAM && protocol == CY_SOCKET_IPPROTO_TCP);
+    bool udp = (type == CY_SOCKET_TYPE_DGRAM && protocol == CY_SOCKET_IPPROTO_UDP);
+    if (domain != CY_SOCKET_DOMAIN_AF_INET || (!tcp && !udp)) {
+        return CY_RSLT_MODULE_SECURE_SOCKETS_BADARG;
+    }
+    int fd = socket(AF_INET, tcp ? SOCK_STREAM : SOCK_DGRAM, 0);
+    if (fd < 0) {
+        return CY_RSLT_MODULE_SECURE_SOCKETS_NOMEM;
+    }
+    if (tcp) {
+        int one = 1;
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+    }
+    *handle = (cy_socket_t)(intptr_t)(fd + 1);
+    return CY_RSLT_SUCCESS;
+}
+
+cy_rslt_t cy_socket_setsockopt(cy_socket_t handle, int level, int optname, const void *optval, uint32_t optlen) {
+    if (level != CY_SOCKET_SOL_SOCKET || optlen != sizeof(uint32_t) ||
+        (optname != CY_SOCKET_SO_RCVTIMEO && optname != CY_SOCKET_SO_SNDTIMEO)) {
+        return CY_RSLT_MODULE_SECURE_SOCKETS_BADARG;
+    }
+    uint32_t ms = *(const uint32_t *)optval;
+    struct timeval tv = { .tv_sec = ms / 1000u, .tv_usec = (ms % 1000u) * 1000u };
+    int name = (optname == CY_SOCKET_SO_RCVTIMEO) ? SO_RCVTIMEO : SO_SNDTIMEO;
+    return setsockopt(fd_of(handle), SOL_SOCKET, name, &tv, sizeof(tv)) == 0 ? CY_RSLT_SUCCESS
+                                                                               : CY_RSLT_MODULE_SECURE_SOCKETS_BADARG;
+}
+
+cy_rslt_t cy_socket_connect(cy_socket_t handle, cy_socket_sockaddr_t *address, uint32_t address_length) {
+    (void)address_length;
+    struct sockaddr_in sa = { .sin_family = AF_INET };
+    sa.sin_port = htons(shim_socket_port_override != 0 ? shim_socket_port_override : address->port);
+    sa.sin_addr.s_addr = address->ip_address.ip.v4;
+    return connect(fd_of(handle), (struct sockaddr *)&sa, sizeof(sa)) == 0 ? CY_RSLT_SUCCESS
+                                                                           : CY_RSLT_MODULE_SECURE_SOCKETS_TCPIP_ERROR;
+}
+
+cy_rslt_t cy_socket_send(cy_socket_t handle, const void *buffer, uint32_t length, int flags, uint32_t *bytes_sent) {
+    (void)flags;
+    shim_socket_sends++;
+    if (shim_socket_send_failures > 0) {
+        shim_socket_send_failures--;
+        *bytes_sent = 0;
+        return CY_RSLT_MODULE_SECURE_SOCKETS_NOMEM;
+    }
+    if (shim_socket_discard) {
+        *bytes_sent = length;
+        return CY_RSLT_SUCCESS;
+    }
+    ssize_t n = send(fd_of(handle), buffer, length, MSG_NOSIGNAL);
+    if (n < 0) {
+        *bytes_sent = 0;
+        if (errno == EAGAIN || errno == EWOULDBLOCK) {
+            return CY_RSLT_MODULE_SECURE_SOCKETS_TIMEOUT;
+        }
+        return (errno == EPIPE || errno == ECONNRESET) ? CY_RSLT_MODULE_SECURE_SOCKETS_CLOSED
+                                                       : CY_RSLT_MODULE_SECURE_SOCKETS_TCPIP_ERROR;
+    }
+    *bytes_sent = (uint32_t)n;
+    return CY_RSLT_SUCCESS;
+}
+
+cy_rslt_t cy_socket_sendto(cy_socket_t handle, const void *buffer, uint32_t length, int flags,
+                           const cy_socket_sockaddr_t *dest_addr, uint32_t address_length, uint32_t *bytes_sent) {
+    (void)flags;
+    (void)address_length;
+    shim_socket_sends++;
+    *bytes_sent = 0;
+    if (shim_socket_send_failures > 0) {
+        shim_socket_send_failures--;
+        return CY_RSLT_MODULE_SECURE_SOCKETS_NOMEM;
+    }
+    struct sockaddr_in sa = { .sin_family = AF_INET };
+    sa.sin_port = htons(shim_socket_port_override != 0 ? shim_socket_port_override : dest_addr->port);
+    sa.sin_addr.s_addr = dest_addr->ip_address.ip.v4;
+    ssize_t n = sendto(fd_of(handle), buffer, length, 0, (struct sockaddr *)&sa, sizeof(sa));
+    if (n < 0) {
+        return (errno == ENOBUFS || errno == EAGAIN) ? CY_RSLT_MODULE_SECURE_SOCKETS_NOMEM
+                                                     : CY_RSLT_MODULE_SECURE_SOCKETS_TCPIP_ERROR;
+    }
+    *bytes_sent = (uint32_t)n;
+    return CY_RSLT_SUCCESS;
+}
+
+cy_rslt_t cy_socket_recv(cy_socket_t handle, void *buffer, uint32_t length, int flags, uint32_t *bytes_received) {
+    (void)flags;
+    ssize_t n = recv(fd_of(handle), buffer, length, 0);
+    *bytes_received = (n > 0) ? (uint32_t)n : 0u;
+    if (n > 0) {
+        return CY_RSLT_SUCCESS;
+    }
+    if (n == 0) {
+        return CY_RSLT_MODULE_SECURE_SOCKETS_CLOSED;
+    }
+    if (errno == EAGAIN || errno == EWOULDBLOCK) {
+        return CY_RSLT_MODULE_SECURE_SOCKETS_TIMEOUT;
+    }
+    return (errno == ECONNRESET) ? CY_RSLT_MODULE_SECURE_SOCKETS_CLOSED : CY_RSLT_MODULE_SECURE_SOCKETS_TCPIP_ERROR;
+}
+
+cy_rslt_t cy_socket_disconnect(cy_socket_t handle, uint32_t timeout) {
+    (void)timeout;
+    shutdown(fd_of(handle), SHUT_RDWR);
+    return CY_RSLT_SUCCESS;
+}
+
+cy_rslt_t cy_socket_delete(cy_socket_t handle) {
+    close(fd_of(handle));
+    return CY_RSLT_SUCCESS;
+}
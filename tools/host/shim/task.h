@@ -0,0 +1,19 @@
+#ifndef SHIM_TASK_H_
+#define SHIM_TASK_H_
+
+#include "FreeRTOS.h"
+#include <stdbool.h>
+
+extern uint32_t shim_suspend_depth;     // vTaskSuspendAll() 的嵌套深度
+extern uint32_t shim_critical_depth;    // taskENTER_CRITICAL() 的嵌套深度
+extern bool shim_manual_ticks;          // 为 true 时 xTaskGetTickCount() 返回 shim_tick_count (离散时间模拟)，否则取自 CLOCK_MONOTONIC
+extern TickType_t shim_tick_count;
+
+TickType_t xTaskGetTickCount(void);
+void vTaskSuspendAll(void);
+BaseType_t xTaskResumeAll(void);
+
+#define taskENTER_CRITICAL()    (shim_critical_depth++)
+#define taskEXIT_CRITICAL()     (shim_critical_depth--)
+
+#endif /* SHIM_TASK_H_ */
@@ -0,0 +1,525 @@
+#include "sim_device.h"
+#include "byte_order.h"
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+// 分段睡眠，停止时尽快返回
+static void sleep_ms(sim_device_t *dev, uint32_t ms) {
+    while (ms > 0 && !atomic_load(&dev->stopping)) {
+        uint32_t step = (ms < 50u) ? ms : 50u;
+        struct timespec ts = { .tv_sec = 0, .tv_nsec = (long)step * 1000000L };
+        nanosleep(&ts, NULL);
+        ms -= step;
+    }
+}
+
+// 本线程到目前为止的 CPU 时间 (微秒)
+static uint64_t thread_cpu_us(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    return (uint64_t)ts.tv_sec * 1000000u + (uint64_t)ts.tv_nsec / 1000u;
+}
+
+// --- 音频源 ---
+
+bool sim_source_load_wav(const char *path, sim_pcm_source_t *src) {
+    FILE *f = fopen(path, "rb");
+    if (f == NULL) {
+        return false;
+    }
+    uint8_t riff[12];
+    bool ok = fread(riff, 1, sizeof(riff), f) == sizeof(riff) && memcmp(riff, "RIFF", 4) == 0 &&
+              memcmp(&riff[8], "WAVE", 4) == 0;
+    bool have_fmt = false;
+    while (ok) {
+        uint8_t chunk[8];
+        if (fread(chunk, 1, sizeof(chunk), f) != sizeof(chunk)) {
+            ok = false;
+            break;
+        }
+        uint32_t size = get_le32(&chunk[4]);
+        if (memcmp(chunk, "fmt ", 4) == 0 && size >= 16) {
+            uint8_t fmt[16];
+            ok = fread(fmt, 1, sizeof(fmt), f) == sizeof(fmt) && get_le16(&fmt[0]) == 1 && get_le16(&fmt[14]) == 16;
+            src->channels = get_le16(&fmt[2]);
+            src->sample_rate = get_le32(&fmt[4]);
+            ok = ok && src->channels >= 1 && src->channels <= AUDIO_CHANNELS && src->sample_rate <= AUDIO_MAX_OUTPUT_SAMPLE_RATE;
+            fseek(f, (long)(size - 16u + (size & 1u)), SEEK_CUR);
+            have_fmt = true;
+        } else if (memcmp(chunk, "data", 4) == 0 && have_fmt) {
+            src->samples = malloc(size);
+            src->frames = size / (2u * src->channels);
+            ok = src->samples != NULL && src->frames > 0 && fread(src->samples, 1, size, f) == size;
+            break;
+        } else {
+            fseek(f, (long)(size + (size & 1u)), SEEK_CUR);
+        }
+    }
+    fclose(f);
+    return ok;
+}
+
+void sim_source_synthesize(sim_pcm_source_t *src) {
+    src->sample_rate = AUDIO_SAMPLE_RATE;
+    src->channels = AUDIO_CHANNELS;
+    src->frames = (size_t)src->sample_rate * 10u;
+    src->samples = malloc(src->frames * src->channels * sizeof(int16_t));
+    uint32_t noise = 1;
+    for (size_t i = 0; i < src->frames; i++) {
+        double t = (double)i / src->sample_rate;
+        double envelope = 0.5 + 0.5 * sin(2.0 * M_PI * 3.0 * t);
+        noise = noise * 1664525u + 1013904223u;
+        double v = 6000.0 * envelope * sin(2.0 * M_PI * 220.0 * t) + (double)((int32_t)(noise >> 16) - 32768) / 64.0;
+        for (uint32_t ch = 0; ch < src->channels; ch++) {
+            src->samples[i * src->channels + ch] = (int16_t)v;
+        }
+    }
+}
+
+static void record_duration(atomic_uint *count, atomic_ulong *sum, atomic_uint *max, uint32_t ms) {
+    (*count)++;
+    *sum += ms;
+    if (ms > *max) {
+        *max = ms;
+    }
+}
+
+static uint32_t since_boot_us(const sim_device_t *dev) {
+    return (host_now_ms() - dev->boot_ms) * 1000u;
+}
+
+// --- 状态机 (每台设备一份，转换与 state_machine_handle_event() 相同) ---
+
+static void set_recording(sim_device_t *dev, bool recording) {
+    pthread_mutex_lock(&dev->lock);
+    dev->recording = recording;
+    pthread_mutex_unlock(&dev->lock);
+}
+
+static void handle_event(sim_device_t *dev, app_event_t event) {
+    app_state_t next = dev->state;
+    switch (dev->state) {
+        case APP_STATE_WIFI_DISCONNECTED:
+            if (event == EVENT_WIFI_CONNECTED) {
+                next = APP_STATE_SERVER_DISCONNECTED;
+            }
+            break;
+        case APP_STATE_SERVER_DISCONNECTED:
+            if (event == EVENT_SERVER_CONNECTED) {
+                next = APP_STATE_IDLE;
+            } else if (event == EVENT_WIFI_DISCONNECTED) {
+                next = APP_STATE_WIFI_DISCONNECTED;
+            }
+            break;
+        case APP_STATE_IDLE:
+        case APP_STATE_MEETING_IN_PROGRESS:
+        case APP_STATE_MEETING_PAUSED:
+            if (event == EVENT_WIFI_DISCONNECTED) {
+                next = APP_STATE_WIFI_DISCONNECTED;
+            } else if (event == EVENT_SERVER_DISCONNECTED) {
+                next = APP_STATE_SERVER_DISCONNECTED;
+            } else if (event == EVENT_BTN0_PRESSED) {
+                next = (dev->state == APP_STATE_MEETING_IN_PROGRESS) ? APP_STATE_MEETING_PAUSED : APP_STATE_MEETING_IN_PROGRESS;
+            } else if (event == EVENT_BTN1_LONG_PRESSED && dev->state == APP_STATE_MEETING_PAUSED) {
+                next = APP_STATE_IDLE;
+            }
+            break;
+    }
+    if (next != dev->state) {
+        dev->state = next;
+        dev->stats.transitions++;
+        dev->stats.entered[next]++;
+        if (next == APP_STATE_IDLE && boot_profile_reached_idle(&dev->boot_profile, since_boot_us(dev))) {
+            record_duration(&dev->stats.boots_to_idle, &dev->stats.boot_to_idle_ms_sum, &dev->stats.boot_to_idle_ms_max,
+                            dev->boot_profile.idle_us / 1000u);
+        }
+        set_recording(dev, next == APP_STATE_MEETING_IN_PROGRESS);
+    }
+}
+
+// --- 音频线程 ---
+
+static void *audio_thread(void *arg) {
+    sim_device_t *dev = arg;
+    const sim_config_t *config = dev->config;
+    const sim_pcm_source_t *source = dev->source;
+    uint32_t samples_per_frame = source->sample_rate * config->frame_ms / 1000u;
+    size_t frame_bytes = SIM_HEADER_SIZE + (size_t)samples_per_frame * source->channels * 2u;
+    size_t position = ((size_t)dev->index * 7919u) % source->frames;   // 各设备从不同位置开始，负载互不相同
+    uint32_t sequence = 0;
+    unsigned int seed = dev->index + 1u;
+
+    struct timespec next;
+    clock_gettime(CLOCK_MONOTONIC, &next);
+    while (!atomic_load(&dev->stopping)) {
+        // DMA 完成时刻按固定节拍推进，任务的唤醒再叠加随机抖动，抖动不累积
+        next.tv_nsec += (long)config->frame_ms * 1000000L;
+        while (next.tv_nsec >= 1000000000L) {
+            next.tv_nsec -= 1000000000L;
+            next.tv_sec++;
+        }
+        struct timespec wake = next;
+        if (config->jitter_ms > 0) {
+            wake.tv_nsec += (long)(rand_r(&seed) % (config->jitter_ms * 1000u)) * 1000L;
+            if (wake.tv_nsec >= 1000000000L) {
+                wake.tv_nsec -= 1000000000L;
+                wake.tv_sec++;
+            }
+        }
+        clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &wake, NULL);
+
+        pthread_mutex_lock(&dev->lock);
+        if (!dev->recording) {
+            pthread_mutex_unlock(&dev->lock);
+            continue;
+        }
+        if (dev->queue_count == AUDIO_QUEUE_LENGTH) {
+            dev->queue_head = (dev->queue_head + 1u) % AUDIO_QUEUE_LENGTH;
+            dev->queue_count--;
+            dev->stats.queue_drops++;
+        }
+        uint32_t slot = (dev->queue_head + dev->queue_count) % AUDIO_QUEUE_LENGTH;
+        uint8_t *frame = dev->queue[slot];
+        frame[0] = 1;   // AUDIO_FRAME_HEADER_VERSION
+        frame[1] = 0;
+        frame[2] = (uint8_t)source->channels;
+        frame[3] = 0;   // AUDIO_FRAME_FORMAT_PCM_S16LE
+        put_le16(&frame[4], (uint16_t)source->sample_rate);
+        put_le16(&frame[6], (uint16_t)samples_per_frame);
+        put_le32(&frame[8], sequence++);
+        put_le32(&frame[12], host_now_ms());
+        for (uint32_t i = 0; i < samples_per_frame; i++) {
+            memcpy(&frame[SIM_HEADER_SIZE + i * source->channels * 2u], &source->samples[position * source->channels],
+                   source->channels * 2u);
+            position = (position + 1u) % source->frames;
+        }
+        dev->queue_len[slot] = (uint16_t)frame_bytes;
+        dev->queue_count++;
+        dev->stats.captured++;
+        pthread_cond_signal(&dev->ready);
+        pthread_mutex_unlock(&dev->lock);
+    }
+    dev->stats.cpu_us += thread_cpu_us();
+    return NULL;
+}
+
+// --- 网络线程 ---
+
+// 等待最多 timeout_ms 取出一帧，没有时返回 0
+static size_t take_frame(sim_device_t *dev, uint8_t *out, uint32_t timeout_ms) {
+    pthread_mutex_lock(&dev->lock);
+    if (dev->queue_count == 0 && timeout_ms > 0) {
+        struct timespec deadline;
+        clock_gettime(CLOCK_REALTIME, &deadline);
+        deadline.tv_nsec += (long)timeout_ms * 1000000L;
+        while (deadline.tv_nsec >= 1000000000L) {
+            deadline.tv_nsec -= 1000000000L;
+            deadline.tv_sec++;
+        }
+        pthread_cond_timedwait(&dev->ready, &dev->lock, &deadline);
+    }
+    size_t len = 0;
+    if (dev->queue_count > 0) {
+        len = dev->queue_len[dev->queue_head];
+        memcpy(out, dev->queue[dev->queue_head], len);
+        dev->queue_head = (dev->queue_head + 1u) % AUDIO_QUEUE_LENGTH;
+        dev->queue_count--;
+    }
+    pthread_mutex_unlock(&dev->lock);
+    return len;
+}
+
+static void drop_link(sim_device_t *dev, app_event_t event) {
+    if (dev->link_lost_ms == 0 && dev->boot_profile.idle) {
+        dev->link_lost_ms = host_now_ms() | 1u;
+    }
+    heartbeat_stop(&dev->heartbeat);
+    host_mqtt_close(&dev->mqtt);
+    handle_event(dev, event);
+    // 断线期间队列中的帧不会再按时发出，与固件不同，这里不做积压补发，直接计为丢弃
+    pthread_mutex_lock(&dev->lock);
+    dev->stats.queue_drops += dev->queue_count;
+    dev->queue_count = 0;
+    pthread_mutex_unlock(&dev->lock);
+}
+
+// AP 消失 SIM_WIFI_LOSS_DETECT_MS 后报告 Wi-Fi 断开，返回 true
+static bool check_wifi_lost(sim_device_t *dev) {
+    if (atomic_load(&dev->wifi_available)) {
+        dev->wifi_lost_ms = 0;
+        return false;
+    }
+    uint32_t now = host_now_ms();
+    if (dev->wifi_lost_ms == 0) {
+        dev->wifi_lost_ms = now | 1u;
+    }
+    if ((now - dev->wifi_lost_ms) < SIM_WIFI_LOSS_DETECT_MS) {
+        return false;
+    }
+    dev->stats.wifi_losses++;
+    drop_link(dev, EVENT_WIFI_DISCONNECTED);
+    return true;
+}
+
+static bool connect_device(sim_device_t *dev) {
+    uint32_t t0 = host_now_ms();
+    boot_profile_begin(&dev->boot_profile, BOOT_STEP_BROKER_CONNECT, since_boot_us(dev));
+    int reason = 0;
+    if (host_mqtt_connect(&dev->mqtt, dev->config->host, dev->config->port, dev->client_id, MQTT_STREAM_KEEP_ALIVE_SEC,
+                          SIM_CONNECT_TIMEOUT_MS, &reason) != 0) {
+        dev->stats.connect_failures++;
+        return false;
+    }
+    uint32_t connect_ms = host_now_ms() - t0;
+    if (connect_ms > dev->stats.connect_ms_max) {
+        dev->stats.connect_ms_max = connect_ms;
+    }
+    dev->stats.connects++;
+    boot_profile_end(&dev->boot_profile, BOOT_STEP_BROKER_CONNECT, since_boot_us(dev));
+    host_mqtt_subscribe(&dev->mqtt, dev->echo_topic, 0);
+    heartbeat_start(&dev->heartbeat, host_now_ms());
+    fec_encoder_init(&dev->fec, dev->fec_buffer, sizeof(dev->fec_buffer), dev->config->fec_group);
+    handle_event(dev, EVENT_SERVER_CONNECTED);
+    return true;
+}
+
+static bool publish(sim_device_t *dev, const uint8_t *packet, size_t len, bool parity) {
+    if (host_mqtt_publish(&dev->mqtt, dev->stream_topic, packet, len, dev->config->qos) < 0) {
+        dev->stats.publish_errors++;
+        return false;
+    }
+    if (parity) {
+        dev->stats.parity_published++;
+    } else {
+        dev->stats.published++;
+        if (dev->link_lost_ms != 0) {
+            record_duration(&dev->stats.resumes, &dev->stats.resume_ms_sum, &dev->stats.resume_ms_max,
+                            host_now_ms() - dev->link_lost_ms);
+            dev->link_lost_ms = 0;
+        }
+    }
+    dev->stats.published_bytes += len;
+    // PUBLISH 报头：固定头 1 字节 + 剩余长度 1 ~ 3 字节 + 主题长度和主题 + QoS1 的报文标识符
+    size_t remaining = 2u + strlen(dev->stream_topic) + ((dev->config->qos > 0) ? 2u : 0u) + len;
+    size_t mqtt_len = 1u + ((remaining < 128u) ? 1u : (remaining < 16384u) ? 2u : 3u) + remaining;
+    dev->stats.wire_bytes += mqtt_len + (mqtt_len + SIM_TCP_MSS - 1u) / SIM_TCP_MSS * SIM_TCPIP_HEADER_BYTES;
+    return true;
+}
+
+// 取走已到达的回显和 PUBACK，不阻塞
+static bool service_incoming(sim_device_t *dev) {
+    host_mqtt_message_t msg;
+    int r;
+    while ((r = host_mqtt_read(&dev->mqtt, 0, &msg)) == 1) {
+        if (msg.type == HOST_MQTT_PUBLISH && strcmp(msg.topic, dev->echo_topic) == 0) {
+            heartbeat_on_echo(&dev->heartbeat, msg.payload, msg.payload_len, host_now_ms());
+        } else if (msg.type == HOST_MQTT_PUBACK) {
+            dev->stats.pubacks++;
+        }
+    }
+    return r == 0;
+}
+
+// 心跳和接收处理，与固件的 service_heartbeat() 一样在每轮发布之前执行。链路失效时断开并返回 false。
+static bool service_link(sim_device_t *dev) {
+    if (check_wifi_lost(dev)) {
+        return false;
+    }
+    uint8_t ping[HEARTBEAT_PAYLOAD_SIZE];
+    bool alive = heartbeat_poll(&dev->heartbeat, host_now_ms(), ping) == 0 ||
+                 host_mqtt_publish(&dev->mqtt, dev->heartbeat_topic, ping, sizeof(ping), 0) >= 0;
+    alive = alive && service_incoming(dev);
+    if (alive && heartbeat_check_dead(&dev->heartbeat, host_now_ms())) {
+        dev->stats.link_dead++;
+        alive = false;
+    }
+    if (!alive) {
+        drop_link(dev, EVENT_SERVER_DISCONNECTED);
+    }
+    return alive;
+}
+
+static void stream_one(sim_device_t *dev, uint8_t *frame) {
+    if (!service_link(dev)) {
+        return;
+    }
+    size_t len = take_frame(dev, frame, 10);
+    if (len == 0) {
+        return;
+    }
+    size_t parity_len = fec_encoder_close_before(&dev->fec, get_le32(&frame[8]));
+    if ((parity_len > 0 && !publish(dev, dev->fec_buffer, parity_len, true)) || !publish(dev, frame, len, false)) {
+        drop_link(dev, EVENT_SERVER_DISCONNECTED);
+        return;
+    }
+    parity_len = fec_encoder_add(&dev->fec, frame, len);
+    if (parity_len > 0 && !publish(dev, dev->fec_buffer, parity_len, true)) {
+        drop_link(dev, EVENT_SERVER_DISCONNECTED);
+    }
+}
+
+// --- 模拟 WCM ---
+
+// 平均值 ±25% 的随机耗时
+static uint32_t vary_ms(uint32_t ms, unsigned int *seed) {
+    return ms - ms / 4u + (uint32_t)rand_r(seed) % (ms / 2u + 1u);
+}
+
+// 当前 AP 的参数，与固件的 remember_association() 取到的相同
+static void current_ap(const sim_device_t *dev, uint8_t bssid[6], uint8_t *channel, uint32_t *ip) {
+    uint32_t generation = atomic_load(&dev->ap_generation);
+    const uint8_t mac[6] = { 0x02, 0x00, 0x5e, (uint8_t)(generation >> 16), (uint8_t)(generation >> 8), (uint8_t)generation };
+    memcpy(bssid, mac, sizeof(mac));
+    *channel = (uint8_t)(1u + (generation * 5u) % 11u);
+    *ip = 192u | (168u << 8) | ((1u + generation % 200u) << 16) | ((10u + dev->index) << 24);  // 网络字节序
+}
+
+// 一次 connect_to_wifi() 尝试：有缓存时先直接关联，失败后在同一次尝试中回退到扫描。连上时返回 true。
+static bool associate(sim_device_t *dev, unsigned int *seed) {
+    const sim_config_t *config = dev->config;
+    uint8_t bssid[6];
+    uint8_t channel;
+    uint32_t ip;
+    current_ap(dev, bssid, &channel, &ip);
+    uint32_t gateway = (ip & 0x00ffffffu) | (1u << 24);
+
+    wifi_cache_plan_t plan = config->wifi_cache ? wifi_cache_plan(&dev->nvm, dev->credentials_hash) : WIFI_CACHE_PLAN_SCAN;
+    if (plan != WIFI_CACHE_PLAN_SCAN) {
+        if (atomic_load(&dev->wifi_available) && memcmp(dev->nvm.bssid, bssid, sizeof(bssid)) == 0) {
+            bool used_static = plan == WIFI_CACHE_PLAN_DIRECTED_STATIC;
+            sleep_ms(dev, vary_ms(config->wifi_join_ms, seed) + (used_static ? 0u : vary_ms(config->wifi_dhcp_ms, seed)));
+            dev->stats.wifi_directed_connects++;
+            wifi_cache_update(&dev->nvm, dev->credentials_hash, bssid, channel, 0, ip, 0x00ffffffu, gateway, used_static);
+            return true;
+        }
+        sleep_ms(dev, SIM_WIFI_DIRECTED_FAIL_MS);
+        dev->stats.wifi_directed_failures++;
+    }
+    sleep_ms(dev, vary_ms(config->wifi_scan_ms, seed));
+    if (!atomic_load(&dev->wifi_available)) {
+        return false;
+    }
+    sleep_ms(dev, vary_ms(config->wifi_join_ms, seed) + vary_ms(config->wifi_dhcp_ms, seed));
+    dev->stats.wifi_scan_connects++;
+    if (config->wifi_cache) {
+        wifi_cache_update(&dev->nvm, dev->credentials_hash, bssid, channel, 0, ip, 0x00ffffffu, gateway, false);
+    }
+    return true;
+}
+
+static void *network_thread(void *arg) {
+    sim_device_t *dev = arg;
+    static __thread uint8_t frame[SIM_MAX_FRAME_BYTES];
+    unsigned int seed = dev->index * 31u + 7u;
+
+    while (!atomic_load(&dev->stopping)) {
+        switch (dev->state) {
+            case APP_STATE_WIFI_DISCONNECTED:
+                boot_profile_begin(&dev->boot_profile, BOOT_STEP_WIFI_CONNECT, since_boot_us(dev));
+                if (associate(dev, &seed)) {
+                    boot_profile_end(&dev->boot_profile, BOOT_STEP_WIFI_CONNECT, since_boot_us(dev));
+                    handle_event(dev, EVENT_WIFI_CONNECTED);
+                } else {
+                    sleep_ms(dev, SIM_WIFI_RETRY_MS);
+                }
+                break;
+            case APP_STATE_SERVER_DISCONNECTED:
+                if (!check_wifi_lost(dev) && !connect_device(dev)) {
+                    sleep_ms(dev, SIM_RECONNECT_DELAY_MS);
+                }
+                break;
+            case APP_STATE_IDLE:
+                if ((int32_t)(host_now_ms() - dev->meeting_start_ms) >= 0) {
+                    handle_event(dev, EVENT_BTN0_PRESSED);
+                } else if (service_link(dev)) {
+                    sleep_ms(dev, 10);
+                }
+                break;
+            case APP_STATE_MEETING_IN_PROGRESS:
+            case APP_STATE_MEETING_PAUSED:
+                stream_one(dev, frame);
+                break;
+        }
+    }
+    if (atomic_load(&dev->power_off)) {
+        // 断电：不发 DISCONNECT，代理靠 TCP 连接关闭或保活超时发现
+        if (dev->mqtt.fd >= 0) {
+            close(dev->mqtt.fd);
+            dev->mqtt.fd = -1;
+        }
+        dev->stats.cpu_us += thread_cpu_us();
+        return NULL;
+    }
+    // 把停止前已采集的帧发完
+    if (dev->state == APP_STATE_MEETING_IN_PROGRESS) {
+        set_recording(dev, false);
+        size_t len;
+        while ((len = take_frame(dev, frame, 0)) > 0 && publish(dev, frame, len, false)) {
+        }
+    }
+    host_mqtt_close(&dev->mqtt);
+    dev->stats.cpu_us += thread_cpu_us();
+    return NULL;
+}
+
+// 运行时状态回到上电时的样子，stats 和 nvm 不变
+static void boot(sim_device_t *dev, uint32_t meeting_start_ms) {
+    dev->state = APP_STATE_WIFI_DISCONNECTED;
+    dev->meeting_start_ms = meeting_start_ms;
+    atomic_store(&dev->stopping, false);
+    atomic_store(&dev->power_off, false);
+    dev->wifi_lost_ms = 0;
+    dev->link_lost_ms = 0;
+    dev->boot_ms = host_now_ms();
+    boot_profile_init(&dev->boot_profile);
+    dev->stats.boots++;
+    dev->queue_head = 0;
+    dev->queue_count = 0;
+    dev->recording = false;
+    dev->mqtt.fd = -1;
+    heartbeat_init(&dev->heartbeat, MQTT_HEARTBEAT_INTERVAL_MS, MQTT_HEARTBEAT_TIMEOUT_MS);
+    pthread_create(&dev->audio_thread, NULL, audio_thread, dev);
+    pthread_create(&dev->network_thread, NULL, network_thread, dev);
+}
+
+void sim_device_start(sim_device_t *dev, uint32_t index, const sim_config_t *config, const sim_pcm_source_t *source,
+                      uint32_t meeting_start_ms) {
+    memset(dev, 0, sizeof(*dev));
+    dev->index = index;
+    dev->config = config;
+    dev->source = source;
+    snprintf(dev->client_id, sizeof(dev->client_id), "%s%03u", SIM_CLIENT_ID_PREFIX, (unsigned int)index);
+    snprintf(dev->stream_topic, sizeof(dev->stream_topic), "%s/%s", MQTT_TOPIC_AUDIO_STREAM, dev->client_id);
+    snprintf(dev->heartbeat_topic, sizeof(dev->heartbeat_topic), "%s/%s", MQTT_TOPIC_HEARTBEAT, dev->client_id);
+    snprintf(dev->echo_topic, sizeof(dev->echo_topic), "%s/%s", MQTT_TOPIC_HEARTBEAT_ECHO, dev->client_id);
+    dev->credentials_hash = wifi_cache_credentials_hash(WIFI_SSID, WIFI_PASSWORD, 0);  // 主机上没有 cy_wcm.h 的安全类型
+    atomic_store(&dev->wifi_available, true);
+    pthread_mutex_init(&dev->lock, NULL);
+    pthread_cond_init(&dev->ready, NULL);
+    boot(dev, meeting_start_ms);
+}
+
+void sim_device_stop(sim_device_t *dev) {
+    atomic_store(&dev->stopping, true);
+    pthread_join(dev->audio_thread, NULL);
+    pthread_join(dev->network_thread, NULL);
+}
+
+void sim_device_reboot(sim_device_t *dev, uint32_t meeting_start_ms) {
+    atomic_store(&dev->power_off, true);
+    sim_device_stop(dev);
+    dev->stats.queue_drops += dev->queue_count;
+    boot(dev, meeting_start_ms);
+}
+
+void sim_device_set_wifi(sim_device_t *dev, bool available) {
+    atomic_store(&dev->wifi_available, available);
+}
+
+void sim_device_set_ap(sim_device_t *dev, uint32_t generation) {
+    atomic_store(&dev->ap_generation, generation);
+}
@@ -0,0 +1,157 @@
+#ifndef SIM_DEVICE_H_
+#define SIM_DEVICE_H_
+
+#include "app_config.h"
+#include "state_machine.h"
+#include "fec.h"
+#include "heartbeat.h"
+#include "wifi_cache.h"
+#include "boot_profile.h"
+#include "host_mqtt.h"
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+// 主机上模拟的一台会议助手，供 loadgen.c 和 soak.c 使用。只模拟固件的时序和报文，不运行 FreeRTOS 任务本身：
+//   状态机    状态和转换与 state_machine.c 相同 (每台设备一份)，进入非会议状态时停止采集
+//   音频线程  按帧长节拍从 PCM 源取一帧，唤醒叠加 0 ~ jitter_ms 的抖动，填好 16 字节帧头 (见 audio_task.h) 后放入
+//             AUDIO_QUEUE_LENGTH 深的队列，满时丢弃最旧的帧 (与 AUDIO_OVERLOAD_DROP_OLDEST 相同)
+//   网络线程  模拟 WCM 关联 (见下)，失败 5 秒后重试 (与 connect_to_wifi 相同)，连接代理 (失败 3 秒后重试)，
+//             按 MQTT_HEARTBEAT_INTERVAL_MS 发送心跳 (heartbeat.c)，可选 XOR 校验包 (fec.c)，逐帧发布到
+//             MQTT_TOPIC_AUDIO_STREAM/<客户端 ID>。心跳超时或发布失败时断开并回到 SERVER_DISCONNECTED。
+// 不做积压补发：断线时队列中的帧计为丢弃。
+// WCM 模型：扫描关联耗时 wifi_scan_ms + wifi_join_ms + wifi_dhcp_ms，各项有 ±25% 的随机偏差。wifi_cache 打开时与固件的
+// WIFI_FAST_RECONNECT 一样用 wifi_cache.c 决定先直接关联缓存的 BSSID (只需 wifi_join_ms，租约不可复用时再加 DHCP)，
+// 缓存的 BSSID 不可达 (AP 不在或已更换) 时耗费 SIM_WIFI_DIRECTED_FAIL_MS 后回退到扫描。记录保存在 sim_device_t.nvm 中，
+// 模拟重启 (sim_device_reboot()) 后保留。
+// 与固件一样，每台设备发布到带自己客户端 ID 的主题，帧序号从 0 开始；监视端按主题区分设备。
+// timestamp_ms 为本进程的单调时钟 (host_now_ms())，监视端可直接算出端到端延迟。
+
+#define SIM_MAX_DEVICES             (256)
+#define SIM_CLIENT_ID_PREFIX        MQTT_CLIENT_ID_PREFIX "_load"  // 客户端 ID 为前缀 + 三位设备编号
+#define SIM_HEADER_SIZE             (16)
+#define SIM_MAX_FRAME_BYTES         (SIM_HEADER_SIZE + AUDIO_BUFFER_SIZE_BYTES)
+#define SIM_WIFI_RETRY_MS           (5000)  // connect_to_wifi 的重试间隔
+#define SIM_WIFI_LOSS_DETECT_MS     (1000)  // AP 消失到 WCM 报告断开的时间 (信标丢失)
+#define SIM_WIFI_DIRECTED_FAIL_MS   (1000)  // 直接关联的 AP 不存在时，在缓存信道上探测失败的时间 (估计值)
+#define SIM_WIFI_SCAN_MS_DEFAULT    (1800)  // 双频全信道扫描 (估计值，下同)
+#define SIM_WIFI_JOIN_MS_DEFAULT    (150)
+#define SIM_WIFI_DHCP_MS_DEFAULT    (600)
+#define SIM_RECONNECT_DELAY_MS      (3000)  // connect_to_mqtt_broker 的重试间隔
+#define SIM_CONNECT_TIMEOUT_MS      (5000)
+#define SIM_STATE_COUNT             (APP_STATE_MEETING_PAUSED + 1)
+#define SIM_TCP_MSS                 (1460)  // 估算线路字节时的 TCP 分段大小 (以太网 MTU)
+#define SIM_TCPIP_HEADER_BYTES      (40)    // 每个 TCP 段的 IPv4 + TCP 头 (不含选项)
+
+typedef struct {
+    const char *host;
+    uint16_t port;
+    uint32_t frame_ms;
+    uint32_t jitter_ms;
+    uint32_t wifi_scan_ms;          // 全信道扫描 (平均值，下同)
+    uint32_t wifi_join_ms;          // 认证、关联和四次握手
+    uint32_t wifi_dhcp_ms;
+    bool wifi_cache;                // 模拟 WIFI_FAST_RECONNECT
+    uint32_t fec_group;
+    uint8_t qos;
+} sim_config_t;
+
+typedef struct {
+    int16_t *samples;               // 交错的 16 位 PCM
+    size_t frames;                  // 每通道采样点数
+    uint32_t sample_rate;
+    uint32_t channels;
+} sim_pcm_source_t;
+
+typedef struct {
+    atomic_uint captured;           // 采集的帧 (含队列中丢弃的)
+    atomic_uint queue_drops;        // 队列满或断线时丢弃的帧
+    atomic_uint published;
+    atomic_ulong published_bytes;
+    atomic_ulong wire_bytes;        // published_bytes 加上 MQTT 报头和每个 TCP 段的 TCP/IP 头 (按 SIM_TCP_MSS 分段估算)
+    atomic_ulong cpu_us;            // 音频和网络线程的 CPU 时间，线程退出时累加
+    atomic_uint parity_published;
+    atomic_uint publish_errors;
+    atomic_uint pubacks;
+    atomic_uint connects;
+    atomic_uint connect_failures;
+    atomic_uint wifi_losses;        // 报告 Wi-Fi 断开的次数
+    atomic_uint wifi_scan_connects;
+    atomic_uint wifi_directed_connects;
+    atomic_uint wifi_directed_failures;
+    atomic_uint boots;
+    atomic_uint boots_to_idle;      // 从启动到进入 IDLE 的次数和耗时
+    atomic_ulong boot_to_idle_ms_sum;
+    atomic_uint boot_to_idle_ms_max;
+    atomic_uint resumes;            // 从断线到重新发布第一帧实时帧的次数和耗时
+    atomic_ulong resume_ms_sum;
+    atomic_uint resume_ms_max;
+    atomic_uint link_dead;          // 心跳判定链路失效的次数
+    atomic_uint transitions;
+    atomic_uint entered[SIM_STATE_COUNT];   // 进入各状态的次数
+    atomic_uint connect_ms_max;
+} sim_device_stats_t;
+
+typedef struct {
+    uint32_t index;
+    const sim_config_t *config;
+    const sim_pcm_source_t *source;
+    char client_id[48];
+    char stream_topic[sizeof(MQTT_TOPIC_AUDIO_STREAM) + 48];
+    char heartbeat_topic[sizeof(MQTT_TOPIC_HEARTBEAT) + 48];
+    char echo_topic[sizeof(MQTT_TOPIC_HEARTBEAT_ECHO) + 48];
+    _Atomic app_state_t state;      // 只由网络线程修改，其他线程读取
+    uint32_t meeting_start_ms;      // 到这个时间之后，每次回到 IDLE 都按下 BTN0 开始会议
+    atomic_bool stopping;
+    atomic_bool power_off;          // 停止时不发完队列、不发送 DISCONNECT
+    atomic_bool wifi_available;     // 模拟的 AP 是否可达
+    atomic_uint ap_generation;      // 模拟的 AP 编号，决定 BSSID 和信道
+    uint32_t wifi_lost_ms;          // 网络线程发现 AP 不可达的时间，0 表示未发现
+    uint32_t boot_ms;               // 本次启动的时间
+    boot_profile_t boot_profile;    // 本次启动的 wifi_connect 和 broker_connect 步骤，时间从 boot_ms 算起
+    uint32_t link_lost_ms;          // 断线的时间，重新发布第一帧后清零
+    uint32_t credentials_hash;
+    wifi_cache_record_t nvm;        // 模拟的闪存，重启后保留
+
+    pthread_t audio_thread;
+    pthread_t network_thread;
+    pthread_mutex_t lock;
+    pthread_cond_t ready;
+    uint8_t queue[AUDIO_QUEUE_LENGTH][SIM_MAX_FRAME_BYTES];
+    uint16_t queue_len[AUDIO_QUEUE_LENGTH];
+    uint32_t queue_head;
+    uint32_t queue_count;
+    bool recording;
+
+    host_mqtt_t mqtt;
+    heartbeat_t heartbeat;
+    fec_encoder_t fec;
+    uint8_t fec_buffer[FEC_PARITY_BUFFER_SIZE(SIM_MAX_FRAME_BYTES)];
+    sim_device_stats_t stats;
+} sim_device_t;
+
+// 读取 16 位 PCM 的 WAV 文件 (不超过 AUDIO_CHANNELS 通道、AUDIO_MAX_OUTPUT_SAMPLE_RATE)，其他格式返回 false
+bool sim_source_load_wav(const char *path, sim_pcm_source_t *src);
+
+// 合成 10 秒的调幅音调加噪声，负载大小与真实语音相同
+void sim_source_synthesize(sim_pcm_source_t *src);
+
+// 初始化并启动设备的音频和网络线程。config 和 source 在设备停止前须保持有效。
+void sim_device_start(sim_device_t *dev, uint32_t index, const sim_config_t *config, const sim_pcm_source_t *source,
+                      uint32_t meeting_start_ms);
+
+// 停止采集，把已采集的帧发完后断开并等待线程退出
+void sim_device_stop(sim_device_t *dev);
+
+// 模拟断电重启：不发完队列、不发送 DISCONNECT，保留统计和 nvm，从 WIFI_DISCONNECTED 重新开始
+void sim_device_reboot(sim_device_t *dev, uint32_t meeting_start_ms);
+
+// 模拟 AP 消失/恢复：消失 SIM_WIFI_LOSS_DETECT_MS 后设备报告 Wi-Fi 断开，恢复后在下一次重试时重新关联
+void sim_device_set_wifi(sim_device_t *dev, bool available);
+
+// 模拟更换 AP：BSSID 和信道随 generation 变化，缓存的 BSSID 不再可达
+void sim_device_set_ap(sim_device_t *dev, uint32_t generation);
+
+#endif /* SIM_DEVICE_H_ */
@@ -0,0 +1,139 @@
+#include "sim_monitor.h"
+#include "byte_order.h"
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// 从 "MQTT_TOPIC_AUDIO_STREAM/<客户端 ID>" 取出设备编号，不是模拟设备的主题时返回 SIM_MAX_DEVICES
+static uint32_t device_for_topic(const char *topic) {
+    size_t n = strlen(MQTT_TOPIC_AUDIO_STREAM);
+    if (strncmp(topic, MQTT_TOPIC_AUDIO_STREAM, n) != 0 || topic[n] != '/' ||
+        strncmp(&topic[n + 1], SIM_CLIENT_ID_PREFIX, strlen(SIM_CLIENT_ID_PREFIX)) != 0) {
+        return SIM_MAX_DEVICES;
+    }
+    char *end;
+    unsigned long index = strtoul(&topic[n + 1 + strlen(SIM_CLIENT_ID_PREFIX)], &end, 10);
+    return (*end == '\0' && index < SIM_MAX_DEVICES) ? (uint32_t)index : SIM_MAX_DEVICES;
+}
+
+static void on_stream_frame(sim_monitor_t *m, uint32_t device, const uint8_t *data, size_t len, uint32_t now) {
+    if (len < SIM_HEADER_SIZE) {
+        return;
+    }
+    uint32_t seq = get_le32(&data[8]);
+    uint32_t captured_ms = get_le32(&data[12]);
+    pthread_mutex_lock(&m->lock);
+    m->received_bytes += len;
+    if (data[1] & FEC_FRAME_FLAG_PARITY) {
+        m->parity++;
+        pthread_mutex_unlock(&m->lock);
+        return;
+    }
+    m->received++;
+    uint32_t latency = now - captured_ms;
+    if ((int32_t)latency < 0) {
+        latency = 0;
+    }
+    m->latency_hist[(latency < SIM_LATENCY_BUCKETS) ? latency : SIM_LATENCY_BUCKETS - 1u]++;
+    if (latency > m->latency_max_ms) {
+        m->latency_max_ms = latency;
+    }
+    sim_device_rx_t *rx = &m->devices[device];
+    if (!rx->seen) {
+        rx->seen = true;
+        rx->first_sequence = seq;
+        rx->highest_sequence = seq;
+    } else if (seq > rx->highest_sequence) {
+        rx->highest_sequence = seq;
+    } else {
+        rx->out_of_order++;
+    }
+    rx->received++;
+    rx->last_rx_ms = now;
+    if (m->mark_ms != 0 && rx->recovered_ms == 0 && (int32_t)(captured_ms - m->mark_ms) >= 0) {
+        rx->recovered_ms = now;
+    }
+    pthread_mutex_unlock(&m->lock);
+}
+
+static void *monitor_thread(void *arg) {
+    sim_monitor_t *m = arg;
+    char filter[64];
+    snprintf(filter, sizeof(filter), "%s/+", MQTT_TOPIC_AUDIO_STREAM);
+    host_mqtt_subscribe(&m->mqtt, filter, 0);
+    snprintf(filter, sizeof(filter), "%s/+", MQTT_TOPIC_HEARTBEAT);
+    host_mqtt_subscribe(&m->mqtt, filter, 0);
+
+    uint32_t last_ping = host_now_ms();
+    uint32_t drain_start = 0;
+    size_t prefix_len = strlen(MQTT_TOPIC_HEARTBEAT);
+    for (;;) {
+        host_mqtt_message_t msg;
+        int r = host_mqtt_read(&m->mqtt, 100, &msg);
+        if (r < 0) {
+            fprintf(stderr, "monitor: connection to broker lost\n");
+            break;
+        }
+        uint32_t now = host_now_ms();
+        if (r == 1 && msg.type == HOST_MQTT_PUBLISH) {
+            uint32_t device = device_for_topic(msg.topic);
+            if (device < SIM_MAX_DEVICES) {
+                on_stream_frame(m, device, msg.payload, msg.payload_len, now);
+            } else if (strncmp(msg.topic, MQTT_TOPIC_HEARTBEAT, prefix_len) == 0 && msg.topic[prefix_len] == '/') {
+                char echo_topic[300];
+                snprintf(echo_topic, sizeof(echo_topic), "%s%s", MQTT_TOPIC_HEARTBEAT_ECHO, &msg.topic[prefix_len]);
+                host_mqtt_publish(&m->mqtt, echo_topic, msg.payload, msg.payload_len, 0);
+                m->echoes++;
+            }
+        }
+        if ((now - last_ping) >= 30000u) {
+            host_mqtt_ping(&m->mqtt);
+            last_ping = now;
+        }
+        if (!atomic_load(&m->stopping)) {
+            drain_start = now;
+        } else if ((now - drain_start) >= m->drain_ms) {
+            break;
+        }
+    }
+    return NULL;
+}
+
+bool sim_monitor_start(sim_monitor_t *m, const char *host, uint16_t port, const char *client_id, int *reason) {
+    memset(m, 0, sizeof(*m));
+    if (host_mqtt_connect(&m->mqtt, host, port, client_id, 60, SIM_CONNECT_TIMEOUT_MS, reason) != 0) {
+        return false;
+    }
+    pthread_mutex_init(&m->lock, NULL);
+    pthread_create(&m->thread, NULL, monitor_thread, m);
+    return true;
+}
+
+void sim_monitor_stop(sim_monitor_t *m, uint32_t drain_ms) {
+    m->drain_ms = drain_ms;
+    atomic_store(&m->stopping, true);
+    pthread_join(m->thread, NULL);
+    host_mqtt_close(&m->mqtt);
+}
+
+void sim_monitor_mark(sim_monitor_t *m, uint32_t mark_ms) {
+    pthread_mutex_lock(&m->lock);
+    m->mark_ms = mark_ms | 1u;
+    for (uint32_t i = 0; i < SIM_MAX_DEVICES; i++) {
+        m->devices[i].recovered_ms = 0;
+    }
+    pthread_mutex_unlock(&m->lock);
+}
+
+uint32_t sim_monitor_latency_percentile(const uint64_t *hist, uint64_t total, double pct) {
+    uint64_t target = (uint64_t)ceil(total * pct / 100.0);
+    uint64_t seen = 0;
+    for (uint32_t i = 0; i < SIM_LATENCY_BUCKETS; i++) {
+        seen += hist[i];
+        if (seen >= target && target > 0) {
+            return i;
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,51 @@
+#ifndef SIM_MONITOR_H_
+#define SIM_MONITOR_H_
+
+#include "sim_device.h"
+
+// 模拟设备的接收端，供 loadgen.c 和 soak.c 使用：用单独的连接订阅 MQTT_TOPIC_AUDIO_STREAM/+，按主题中的客户端 ID
+// (SIM_CLIENT_ID_PREFIX + 设备编号) 分设备统计到达帧、乱序和端到端延迟，并代替服务端回显 MQTT_TOPIC_HEARTBEAT/+，
+// 否则设备的心跳检测不会生效。
+
+#define SIM_LATENCY_BUCKETS         (5000)  // 1 ms 一格，超过的计入最后一格
+
+typedef struct {
+    uint32_t first_sequence;
+    uint32_t highest_sequence;
+    uint32_t received;
+    uint32_t out_of_order;
+    uint32_t last_rx_ms;
+    uint32_t recovered_ms;          // sim_monitor_mark() 之后采集的第一帧到达的时间，0 表示还没有
+    bool seen;
+} sim_device_rx_t;
+
+typedef struct {
+    pthread_mutex_t lock;
+    sim_device_rx_t devices[SIM_MAX_DEVICES];
+    uint64_t latency_hist[SIM_LATENCY_BUCKETS];
+    uint64_t received;
+    uint64_t received_bytes;
+    uint64_t parity;
+    uint64_t echoes;
+    uint32_t latency_max_ms;
+    uint32_t mark_ms;               // 0 表示不跟踪恢复时间
+
+    host_mqtt_t mqtt;
+    pthread_t thread;
+    atomic_bool stopping;
+    uint32_t drain_ms;
+} sim_monitor_t;
+
+// 连接代理并启动监视线程，连接失败时返回 false 并写出原因
+bool sim_monitor_start(sim_monitor_t *m, const char *host, uint16_t port, const char *client_id, int *reason);
+
+// 再接收 drain_ms 等在途帧到达后停止监视线程并断开
+void sim_monitor_stop(sim_monitor_t *m, uint32_t drain_ms);
+
+// 从此刻起记录每台设备第一帧 timestamp_ms >= mark_ms 的帧的到达时间，用于计算故障结束后的恢复时间
+void sim_monitor_mark(sim_monitor_t *m, uint32_t mark_ms);
+
+// 延迟直方图的百分位 (ms)
+uint32_t sim_monitor_latency_percentile(const uint64_t *hist, uint64_t total, double pct);
+
+#endif /* SIM_MONITOR_H_ */
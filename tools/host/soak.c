@@ -0,0 +1,971 @@
+// 故障注入长稳测试：N 个模拟的会议助手 (sim_device.c) 经过本进程内的 TCP 故障代理连接代理服务器，按脚本轮流注入
+// Wi-Fi 掉线、TCP 复位、代理挂起、慢确认和带宽限制，可连续运行数小时，按场景报告丢帧率、恢复时间、内存增长和
+// 状态机转换次数。
+//
+//   设备 ──► 故障代理 (127.0.0.1:-l) ──► 代理服务器 (-h:-p) ◄── 监视连接 (sim_monitor.c，不经过故障代理)
+//
+// 故障类型 (脚本中的名字)：
+//   none       透明转发
+//   wifi_drop  两个方向的数据都丢弃，新连接挂起不转发；同时让所有设备的 AP 不可达 (sim_device_set_wifi())，
+//              设备 SIM_WIFI_LOSS_DETECT_MS 后报告 Wi-Fi 断开，按 connect_to_wifi 的节奏重新关联
+//   reset      瞬时故障：用 RST 关闭所有经过代理的连接 (SO_LINGER 0)
+//   hang       代理服务器挂起：不再读取任何一方 (TCP 流控反压到设备)，新连接接受但不转发 CONNECT
+//   slow_ack   服务器到设备的数据 (PUBACK、心跳回显) 延迟 param 毫秒
+//   cap        设备到服务器方向限速 param kbit/s (所有设备共享，相当于 AP 上行带宽)
+//   ap_change  同 wifi_drop，并且 AP 换成另一台 (sim_device_set_ap())，缓存的 BSSID 失效，设备直接关联失败后回退到扫描
+//   reboot     瞬时故障：所有设备断电重启 (sim_device_reboot())，不发 DISCONNECT，闪存中的关联记录保留
+//
+// 脚本每行 "<秒> <故障> [参数]"，# 开头为注释。故障阶段和其后的 none 阶段组成一个场景，none 阶段开始时标记故障
+// 结束，恢复时间为故障结束到每台设备第一帧 "故障结束后采集的帧" 到达监视端的时间。不带 -s 时使用内置脚本
+// (见 default_script())；-T 指定总时长时脚本循环执行，否则执行一遍。
+// 内存增长为本进程的 RSS 和 malloc 在用字节 (mallinfo2) 的变化，覆盖与固件共用的 fec.c / heartbeat.c 和模拟设备
+// 本身，不代表目标板上 FreeRTOS 堆的情况。
+// 每个场景还报告 Wi-Fi 关联方式 (扫描/直接关联/直接关联失败)、重启到 IDLE 和断线到重新发布实时帧的平均时间；
+// -C 关闭模拟的 WIFI_FAST_RECONNECT，用于对比。
+//
+// 构建 (主机，在仓库根目录)：
+//   cc -O2 -pthread -Isrc -Itools/host -o soak tools/host/soak.c tools/host/sim_device.c tools/host/sim_monitor.c tools/host/host_mqtt.c src/fec.c src/heartbeat.c src/wifi_cache.c src/boot_profile.c -lm
+// 运行：
+//   ./soak -n 20 -T 14400                                 # 20 台设备，内置脚本循环 4 小时
+//   ./soak -n 50 -s faults.txt -q 1
+
+#include "sim_device.h"
+#include "sim_monitor.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <malloc.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <time.h>
+#include <unistd.h>
+
+#define SOAK_MAX_PHASES             (64)
+#define SOAK_WARMUP_MAX_MS          (15000) // 最多等这么久让所有设备进入会议，然后开始注入故障
+#define SOAK_DRAIN_MS               (1000)
+#define PROXY_MAX_CONNS             (SIM_MAX_DEVICES * 2)
+#define PROXY_QUEUE_LIMIT           (256u * 1024u)  // 单方向排队超过此字节数时停止读取，由 TCP 流控反压到对端
+#define PROXY_POLL_MS               (5)
+#define PROXY_CAP_BURST_MS          (50)    // 限速时令牌桶最多积攒的时长
+
+typedef enum {
+    FAULT_NONE,
+    FAULT_WIFI_DROP,
+    FAULT_RESET,
+    FAULT_HANG,
+    FAULT_SLOW_ACK,
+    FAULT_CAP,
+    FAULT_AP_CHANGE,
+    FAULT_REBOOT,
+    FAULT_COUNT
+} fault_t;
+
+static const char *const fault_names[FAULT_COUNT] = { "none", "wifi_drop", "reset", "hang", "slow_ack", "cap", "ap_change",
+                                                     "reboot" };
+static const char *const state_names[SIM_STATE_COUNT] = { "wifi", "server", "idle", "meeting", "paused" };
+
+typedef struct {
+    uint32_t duration_ms;
+    fault_t fault;
+    uint32_t param;
+} phase_t;
+
+typedef struct {
+    sim_config_t sim;
+    const char *broker_host;
+    uint16_t broker_port;
+    uint16_t listen_port;
+    uint32_t devices;
+    uint32_t total_s;               // 0 表示脚本执行一遍
+    const char *script_path;
+    const char *wav_path;
+} soak_config_t;
+
+static soak_config_t config = {
+    .sim = {
+        .host = "127.0.0.1",
+        .frame_ms = AUDIO_FRAME_DURATION_MS,
+        .jitter_ms = 2,
+        .wifi_scan_ms = SIM_WIFI_SCAN_MS_DEFAULT,
+        .wifi_join_ms = SIM_WIFI_JOIN_MS_DEFAULT,
+        .wifi_dhcp_ms = SIM_WIFI_DHCP_MS_DEFAULT,
+        .wifi_cache = true,
+        .fec_group = MQTT_AUDIO_FEC_GROUP_SIZE_DEFAULT,
+        .qos = MQTT_AUDIO_QOS
+    },
+    .broker_host = "127.0.0.1",
+    .broker_port = MQTT_PORT,
+    .listen_port = MQTT_PORT + 10000u,
+    .devices = 20,
+    .total_s = 0,
+    .script_path = NULL,
+    .wav_path = NULL
+};
+
+static atomic_bool interrupted;
+
+static void sleep_ms(uint32_t ms) {
+    struct timespec ts = { .tv_sec = ms / 1000u, .tv_nsec = (long)(ms % 1000u) * 1000000L };
+    nanosleep(&ts, NULL);
+}
+
+// --- 故障代理 ---
+
+typedef struct chunk {
+    struct chunk *next;
+    uint32_t release_ms;            // 到这个时间才转发 (slow_ack)
+    size_t len;
+    size_t offset;
+    uint8_t data[];
+} chunk_t;
+
+typedef struct {
+    chunk_t *head;
+    chunk_t *tail;
+    size_t bytes;
+} chunk_queue_t;
+
+typedef struct {
+    bool in_use;
+    int client_fd;                  // 设备一侧，设备关闭后为 -1
+    int server_fd;                  // 代理服务器一侧，故障期间接受的连接为 -1，恢复后再连接
+    chunk_queue_t up;               // 设备 -> 服务器
+    chunk_queue_t down;             // 服务器 -> 设备
+} proxy_conn_t;
+
+typedef struct {
+    int listen_fd;
+    struct sockaddr_storage broker_addr;
+    socklen_t broker_addr_len;
+    pthread_t thread;
+    atomic_bool stopping;
+
+    pthread_mutex_t lock;           // 保护 fault、param、reset_pending
+    fault_t fault;
+    uint32_t param;
+    bool reset_pending;
+
+    fault_t applied;                // 以下只由代理线程访问
+    double tokens;
+    uint32_t last_refill_ms;
+    proxy_conn_t conns[PROXY_MAX_CONNS];
+    atomic_uint accepted;
+    atomic_uint aborted;
+} proxy_t;
+
+static proxy_t proxy;
+
+static void queue_push(chunk_queue_t *q, const uint8_t *data, size_t len, uint32_t release_ms) {
+    chunk_t *c = malloc(sizeof(chunk_t) + len);
+    if (c == NULL) {
+        return;
+    }
+    c->next = NULL;
+    c->release_ms = release_ms;
+    c->len = len;
+    c->offset = 0;
+    memcpy(c->data, data, len);
+    if (q->tail != NULL) {
+        q->tail->next = c;
+    } else {
+        q->head = c;
+    }
+    q->tail = c;
+    q->bytes += len;
+}
+
+static void queue_clear(chunk_queue_t *q) {
+    while (q->head != NULL) {
+        chunk_t *next = q->head->next;
+        free(q->head);
+        q->head = next;
+    }
+    q->tail = NULL;
+    q->bytes = 0;
+}
+
+// 把到期的数据写到 fd，写满时留到下一轮；连接出错时返回 false
+static bool queue_flush(chunk_queue_t *q, int fd, uint32_t now) {
+    while (q->head != NULL && (int32_t)(now - q->head->release_ms) >= 0) {
+        chunk_t *c = q->head;
+        ssize_t n = send(fd, &c->data[c->offset], c->len - c->offset, MSG_NOSIGNAL | MSG_DONTWAIT);
+        if (n < 0) {
+            return errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR;
+        }
+        c->offset += (size_t)n;
+        q->bytes -= (size_t)n;
+        if (c->offset < c->len) {
+            return true;
+        }
+        q->head = c->next;
+        if (q->head == NULL) {
+            q->tail = NULL;
+        }
+        free(c);
+    }
+    return true;
+}
+
+static void set_socket_options(int fd) {
+    int one = 1;
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+    fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+}
+
+static int connect_upstream(proxy_t *p) {
+    int fd = socket(p->broker_addr.ss_family, SOCK_STREAM, 0);
+    if (fd < 0) {
+        return -1;
+    }
+    if (connect(fd, (struct sockaddr *)&p->broker_addr, p->broker_addr_len) != 0) {
+        close(fd);
+        return -1;
+    }
+    set_socket_options(fd);
+    return fd;
+}
+
+static void close_fd(int fd, bool abort) {
+    if (fd < 0) {
+        return;
+    }
+    if (abort) {
+        struct linger lg = { .l_onoff = 1, .l_linger = 0 };
+        setsockopt(fd, SOL_SOCKET, SO_LINGER, &lg, sizeof(lg));
+    }
+    close(fd);
+}
+
+static void close_conn(proxy_conn_t *c, bool abort) {
+    close_fd(c->client_fd, abort);
+    close_fd(c->server_fd, abort);
+    queue_clear(&c->up);
+    queue_clear(&c->down);
+    memset(c, 0, sizeof(*c));
+    c->client_fd = -1;
+    c->server_fd = -1;
+}
+
+static void accept_clients(proxy_t *p, bool passthrough) {
+    for (;;) {
+        int fd = accept(p->listen_fd, NULL, NULL);
+        if (fd < 0) {
+            return;
+        }
+        set_socket_options(fd);
+        proxy_conn_t *c = NULL;
+        for (uint32_t i = 0; i < PROXY_MAX_CONNS && c == NULL; i++) {
+            if (!p->conns[i].in_use) {
+                c = &p->conns[i];
+            }
+        }
+        if (c == NULL) {
+            close(fd);
+            continue;
+        }
+        c->in_use = true;
+        c->client_fd = fd;
+        c->server_fd = passthrough ? connect_upstream(p) : -1;
+        if (passthrough && c->server_fd < 0) {
+            close_conn(c, false);
+            continue;
+        }
+        p->accepted++;
+    }
+}
+
+// 读取一方的数据，对端关闭或出错时返回 false
+static bool pump_read(int fd, chunk_queue_t *q, size_t max, bool discard, uint32_t release_ms, size_t *bytes) {
+    static uint8_t buffer[16384];
+    ssize_t n = recv(fd, buffer, (max < sizeof(buffer)) ? max : sizeof(buffer), MSG_DONTWAIT);
+    *bytes = 0;
+    if (n == 0) {
+        return false;
+    }
+    if (n < 0) {
+        return errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR;
+    }
+    if (!discard) {
+        queue_push(q, buffer, (size_t)n, release_ms);
+    }
+    *bytes = (size_t)n;
+    return true;
+}
+
+static void *proxy_thread(void *arg) {
+    proxy_t *p = arg;
+    static struct pollfd fds[1 + 2 * PROXY_MAX_CONNS];
+    static int client_slot[PROXY_MAX_CONNS];
+    static int server_slot[PROXY_MAX_CONNS];
+    p->last_refill_ms = host_now_ms();
+
+    while (!atomic_load(&p->stopping)) {
+        pthread_mutex_lock(&p->lock);
+        fault_t fault = p->fault;
+        uint32_t param = p->param;
+        bool reset = p->reset_pending;
+        p->reset_pending = false;
+        pthread_mutex_unlock(&p->lock);
+
+        if (reset) {
+            for (uint32_t i = 0; i < PROXY_MAX_CONNS; i++) {
+                if (p->conns[i].in_use) {
+                    close_conn(&p->conns[i], true);
+                    p->aborted++;
+                }
+            }
+        }
+        if (fault != p->applied) {
+            if (fault == FAULT_WIFI_DROP) {
+                // 空中的数据随 AP 一起消失
+                for (uint32_t i = 0; i < PROXY_MAX_CONNS; i++) {
+                    queue_clear(&p->conns[i].up);
+                    queue_clear(&p->conns[i].down);
+                }
+            }
+            p->applied = fault;
+            p->tokens = 0.0;
+        }
+
+        uint32_t now = host_now_ms();
+        if (fault == FAULT_CAP) {
+            double bytes_per_ms = param / 8.0;
+            double burst = bytes_per_ms * PROXY_CAP_BURST_MS;
+            p->tokens += (now - p->last_refill_ms) * bytes_per_ms;
+            p->tokens = (p->tokens > ((burst < 1500.0) ? 1500.0 : burst)) ? ((burst < 1500.0) ? 1500.0 : burst) : p->tokens;
+        }
+        p->last_refill_ms = now;
+
+        bool passthrough = fault == FAULT_NONE || fault == FAULT_SLOW_ACK || fault == FAULT_CAP;
+        bool discard = fault == FAULT_WIFI_DROP;
+        bool frozen = fault == FAULT_HANG;
+
+        nfds_t nfds = 0;
+        fds[nfds++] = (struct pollfd){ .fd = p->listen_fd, .events = POLLIN };
+        for (uint32_t i = 0; i < PROXY_MAX_CONNS; i++) {
+            proxy_conn_t *c = &p->conns[i];
+            client_slot[i] = -1;
+            server_slot[i] = -1;
+            if (!c->in_use) {
+                continue;
+            }
+            if (passthrough && c->server_fd < 0 && c->client_fd >= 0) {
+                // 故障期间接受的连接，恢复后补连服务器，已排队的 CONNECT 随后转发
+                c->server_fd = connect_upstream(p);
+                if (c->server_fd < 0) {
+                    close_conn(c, false);
+                    continue;
+                }
+            }
+            if (frozen) {
+                continue;
+            }
+            bool can_send_up = discard || (c->up.bytes < PROXY_QUEUE_LIMIT && (fault != FAULT_CAP || p->tokens >= 1.0));
+            if (c->client_fd >= 0 && can_send_up) {
+                client_slot[i] = (int)nfds;
+                fds[nfds++] = (struct pollfd){ .fd = c->client_fd, .events = POLLIN };
+            }
+            if (c->server_fd >= 0 && (discard || c->down.bytes < PROXY_QUEUE_LIMIT)) {
+                server_slot[i] = (int)nfds;
+                fds[nfds++] = (struct pollfd){ .fd = c->server_fd, .events = POLLIN };
+            }
+        }
+
+        if (poll(fds, nfds, PROXY_POLL_MS) < 0 && errno != EINTR) {
+            break;
+        }
+        now = host_now_ms();
+        if (fds[0].revents & POLLIN) {
+            accept_clients(p, passthrough);
+        }
+        for (uint32_t i = 0; i < PROXY_MAX_CONNS; i++) {
+            proxy_conn_t *c = &p->conns[i];
+            if (!c->in_use) {
+                continue;
+            }
+            size_t n = 0;
+            size_t max = (fault == FAULT_CAP) ? (size_t)p->tokens : SIZE_MAX;
+            if (client_slot[i] >= 0 && fds[client_slot[i]].revents != 0 && max > 0) {   // 令牌可能已被前面的连接用完
+                if (!pump_read(c->client_fd, &c->up, max, discard, now, &n)) {
+                    close_fd(c->client_fd, false);
+                    c->client_fd = -1;
+                }
+                if (fault == FAULT_CAP) {
+                    p->tokens -= (double)n;
+                }
+            }
+            if (server_slot[i] >= 0 && fds[server_slot[i]].revents != 0) {
+                uint32_t release_ms = now + ((fault == FAULT_SLOW_ACK) ? param : 0u);
+                if (!pump_read(c->server_fd, &c->down, SIZE_MAX, discard, release_ms, &n)) {
+                    close_conn(c, false);
+                    continue;
+                }
+            }
+            if (!frozen) {
+                if ((c->server_fd >= 0 && !queue_flush(&c->up, c->server_fd, now)) ||
+                    (c->client_fd >= 0 && !queue_flush(&c->down, c->client_fd, now))) {
+                    close_conn(c, false);
+                    continue;
+                }
+            }
+            // 设备已关闭：上行数据发完 (或已无法发出) 后关闭服务器一侧
+            if (c->client_fd < 0 && (c->up.head == NULL || c->server_fd < 0) && !frozen) {
+                close_conn(c, false);
+            }
+        }
+    }
+    for (uint32_t i = 0; i < PROXY_MAX_CONNS; i++) {
+        if (p->conns[i].in_use) {
+            close_conn(&p->conns[i], false);
+        }
+    }
+    return NULL;
+}
+
+static bool proxy_start(proxy_t *p, const char *broker_host, uint16_t broker_port, uint16_t listen_port) {
+    char port_str[8];
+    snprintf(port_str, sizeof(port_str), "%u", broker_port);
+    struct addrinfo hints = { .ai_family = AF_UNSPEC, .ai_socktype = SOCK_STREAM };
+    struct addrinfo *res = NULL;
+    if (getaddrinfo(broker_host, port_str, &hints, &res) != 0) {
+        return false;
+    }
+    memcpy(&p->broker_addr, res->ai_addr, res->ai_addrlen);
+    p->broker_addr_len = res->ai_addrlen;
+    freeaddrinfo(res);
+
+    p->listen_fd = socket(AF_INET, SOCK_STREAM, 0);
+    int one = 1;
+    setsockopt(p->listen_fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+    struct sockaddr_in addr = { .sin_family = AF_INET, .sin_port = htons(listen_port),
+                                .sin_addr.s_addr = htonl(INADDR_LOOPBACK) };
+    if (bind(p->listen_fd, (struct sockaddr *)&addr, sizeof(addr)) != 0 || listen(p->listen_fd, 64) != 0) {
+        close(p->listen_fd);
+        return false;
+    }
+    fcntl(p->listen_fd, F_SETFL, fcntl(p->listen_fd, F_GETFL) | O_NONBLOCK);
+    for (uint32_t i = 0; i < PROXY_MAX_CONNS; i++) {
+        p->conns[i].client_fd = -1;
+        p->conns[i].server_fd = -1;
+    }
+    pthread_mutex_init(&p->lock, NULL);
+    pthread_create(&p->thread, NULL, proxy_thread, p);
+    return true;
+}
+
+static void proxy_stop(proxy_t *p) {
+    atomic_store(&p->stopping, true);
+    pthread_join(p->thread, NULL);
+    close(p->listen_fd);
+}
+
+static void proxy_set_fault(proxy_t *p, fault_t fault, uint32_t param) {
+    // 这两种故障发生在设备一侧，代理只看到 AP 消失或什么也看不到
+    if (fault == FAULT_AP_CHANGE) {
+        fault = FAULT_WIFI_DROP;
+    } else if (fault == FAULT_REBOOT) {
+        fault = FAULT_NONE;
+    }
+    pthread_mutex_lock(&p->lock);
+    if (fault == FAULT_RESET) {
+        p->reset_pending = true;
+        p->fault = FAULT_NONE;
+    } else {
+        p->fault = fault;
+        p->param = param;
+    }
+    pthread_mutex_unlock(&p->lock);
+}
+
+// --- 脚本 ---
+
+static bool parse_phase(const char *line, phase_t *phase) {
+    double seconds = 0.0;
+    char name[32];
+    unsigned int param = 0;
+    int n = sscanf(line, "%lf %31s %u", &seconds, name, &param);
+    if (n < 2 || seconds < 0.0) {
+        return false;
+    }
+    for (uint32_t f = 0; f < FAULT_COUNT; f++) {
+        if (strcmp(name, fault_names[f]) == 0) {
+            if ((f == FAULT_SLOW_ACK || f == FAULT_CAP) && (n < 3 || param == 0)) {
+                return false;
+            }
+            phase->duration_ms = (uint32_t)(seconds * 1000.0);
+            phase->fault = (fault_t)f;
+            phase->param = param;
+            return true;
+        }
+    }
+    return false;
+}
+
+static uint32_t load_script(FILE *f, phase_t *phases) {
+    char line[128];
+    uint32_t count = 0;
+    uint32_t line_no = 0;
+    while (fgets(line, sizeof(line), f) != NULL && count < SOAK_MAX_PHASES) {
+        line_no++;
+        char *p = line + strspn(line, " \t");
+        if (*p == '#' || *p == '\n' || *p == '\0') {
+            continue;
+        }
+        if (!parse_phase(p, &phases[count])) {
+            fprintf(stderr, "script line %u: expected \"<seconds> <fault> [param]\"\n", line_no);
+            return 0;
+        }
+        count++;
+    }
+    return count;
+}
+
+// 内置脚本：每种故障之后留 30 秒恢复；限速为每台设备 160 kbit/s，低于 16 kHz 单声道 PCM 所需的约 260 kbit/s
+static uint32_t default_script(phase_t *phases) {
+    char cap[32];
+    snprintf(cap, sizeof(cap), "30 cap %u", config.devices * 160u);
+    const char *const lines[] = {
+        "30 none", "20 wifi_drop", "30 none", "0 reset", "30 none", "20 hang", "30 none",
+        "30 slow_ack 800", "30 none", cap, "30 none", "20 ap_change", "30 none", "0 reboot", "30 none"
+    };
+    uint32_t count = 0;
+    for (size_t i = 0; i < sizeof(lines) / sizeof(lines[0]); i++) {
+        parse_phase(lines[i], &phases[count++]);
+    }
+    return count;
+}
+
+// --- 统计 ---
+
+typedef struct {
+    uint64_t captured;
+    uint64_t queue_drops;
+    uint64_t published;
+    uint64_t publish_errors;
+    uint64_t connects;
+    uint64_t connect_failures;
+    uint64_t link_dead;
+    uint64_t wifi_losses;
+    uint64_t wifi_scans;
+    uint64_t wifi_directed;
+    uint64_t wifi_directed_failures;
+    uint64_t boots_to_idle;
+    uint64_t boot_to_idle_ms_sum;
+    uint64_t resumes;
+    uint64_t resume_ms_sum;
+    uint64_t transitions;
+    uint64_t entered[SIM_STATE_COUNT];
+    uint64_t received;              // 监视端收到的帧 (不含校验包)
+} totals_t;
+
+typedef struct {
+    long rss_kib;
+    long heap_kib;
+} memory_t;
+
+typedef struct {
+    fault_t fault;
+    uint32_t param;
+    uint32_t start_ms;
+    uint32_t fault_ms;              // 故障阶段时长
+    uint32_t fault_end_ms;          // 0 表示还没有进入恢复阶段
+    totals_t start;
+    memory_t memory;
+} scenario_t;
+
+typedef struct {
+    uint32_t runs;
+    uint64_t expected;
+    uint64_t delivered;
+    uint64_t recovery_ms_sum;
+    uint32_t recovered;
+    uint32_t recovery_ms_max;
+    uint32_t stuck;
+    uint64_t reconnects;
+    uint64_t wifi_scans;
+    uint64_t wifi_directed;
+    uint64_t resumes;
+    uint64_t resume_ms_sum;
+    uint64_t transitions;
+} aggregate_t;
+
+static sim_pcm_source_t source;
+static sim_device_t *devices;
+static sim_monitor_t monitor;
+static aggregate_t aggregates[FAULT_COUNT];
+static uint32_t scenario_count;
+static uint32_t start_ms;
+
+static void sum_devices(totals_t *t) {
+    memset(t, 0, sizeof(*t));
+    for (uint32_t i = 0; i < config.devices; i++) {
+        sim_device_stats_t *s = &devices[i].stats;
+        t->captured += s->captured;
+        t->queue_drops += s->queue_drops;
+        t->published += s->published;
+        t->publish_errors += s->publish_errors;
+        t->connects += s->connects;
+        t->connect_failures += s->connect_failures;
+        t->link_dead += s->link_dead;
+        t->wifi_losses += s->wifi_losses;
+        t->wifi_scans += s->wifi_scan_connects;
+        t->wifi_directed += s->wifi_directed_connects;
+        t->wifi_directed_failures += s->wifi_directed_failures;
+        t->boots_to_idle += s->boots_to_idle;
+        t->boot_to_idle_ms_sum += s->boot_to_idle_ms_sum;
+        t->resumes += s->resumes;
+        t->resume_ms_sum += s->resume_ms_sum;
+        t->transitions += s->transitions;
+        for (uint32_t st = 0; st < SIM_STATE_COUNT; st++) {
+            t->entered[st] += s->entered[st];
+        }
+    }
+    pthread_mutex_lock(&monitor.lock);
+    t->received = monitor.received;
+    pthread_mutex_unlock(&monitor.lock);
+}
+
+static void sample_memory(memory_t *m) {
+    long size = 0;
+    long resident = 0;
+    FILE *f = fopen("/proc/self/statm", "r");
+    if (f != NULL) {
+        if (fscanf(f, "%ld %ld", &size, &resident) != 2) {
+            resident = 0;
+        }
+        fclose(f);
+    }
+    m->rss_kib = resident * (sysconf(_SC_PAGESIZE) / 1024);
+    struct mallinfo2 mi = mallinfo2();
+    m->heap_kib = (long)(mi.uordblks / 1024u);
+}
+
+static void all_devices_wifi(bool available) {
+    for (uint32_t i = 0; i < config.devices; i++) {
+        sim_device_set_wifi(&devices[i], available);
+    }
+}
+
+static void all_devices_ap(uint32_t generation) {
+    for (uint32_t i = 0; i < config.devices; i++) {
+        sim_device_set_ap(&devices[i], generation);
+    }
+}
+
+static void all_devices_reboot(void) {
+    uint32_t now = host_now_ms();
+    for (uint32_t i = 0; i < config.devices; i++) {
+        sim_device_reboot(&devices[i], now);
+    }
+}
+
+// 平均值 (秒)，没有样本时为 0
+static double mean_s(uint64_t ms_sum, uint64_t count) {
+    return (count > 0) ? ms_sum / 1000.0 / count : 0.0;
+}
+
+static void begin_scenario(scenario_t *sc, const phase_t *phase) {
+    memset(sc, 0, sizeof(*sc));
+    sc->fault = phase->fault;
+    sc->param = phase->param;
+    sc->fault_ms = phase->duration_ms;
+    sc->start_ms = host_now_ms();
+    sum_devices(&sc->start);
+    sample_memory(&sc->memory);
+}
+
+static void finish_scenario(const scenario_t *sc) {
+    uint32_t now = host_now_ms();
+    totals_t end;
+    memory_t memory;
+    sum_devices(&end);
+    sample_memory(&memory);
+
+    uint32_t window_ms = now - sc->start_ms;
+    uint64_t expected = (uint64_t)config.devices * window_ms / config.sim.frame_ms;
+    uint64_t delivered = end.received - sc->start.received;
+    double loss = (expected > 0) ? 100.0 * (1.0 - (double)delivered / expected) : 0.0;
+
+    uint32_t recovered = 0;
+    uint32_t stuck = 0;
+    uint64_t recovery_sum = 0;
+    uint32_t recovery_max = 0;
+    if (sc->fault_end_ms != 0) {
+        pthread_mutex_lock(&monitor.lock);
+        for (uint32_t i = 0; i < config.devices; i++) {
+            uint32_t at = monitor.devices[i].recovered_ms;
+            if (at == 0) {
+                stuck++;
+                continue;
+            }
+            uint32_t ms = ((int32_t)(at - sc->fault_end_ms) > 0) ? at - sc->fault_end_ms : 0u;
+            recovery_sum += ms;
+            recovery_max = (ms > recovery_max) ? ms : recovery_max;
+            recovered++;
+        }
+        pthread_mutex_unlock(&monitor.lock);
+    }
+
+    uint64_t reconnects = end.connects - sc->start.connects;
+    uint64_t transitions = end.transitions - sc->start.transitions;
+    char fault[48];
+    if (sc->fault == FAULT_SLOW_ACK || sc->fault == FAULT_CAP) {
+        snprintf(fault, sizeof(fault), "%s %u", fault_names[sc->fault], sc->param);
+    } else {
+        snprintf(fault, sizeof(fault), "%s", fault_names[sc->fault]);
+    }
+    char recovery[80] = "recovery -";
+    if (sc->fault_end_ms != 0) {
+        snprintf(recovery, sizeof(recovery), "recovery mean %.2f s max %.2f s, %u/%u stuck",
+                 (recovered > 0) ? recovery_sum / 1000.0 / recovered : 0.0, recovery_max / 1000.0, stuck, config.devices);
+    }
+    printf("[soak] t=%7.1fs #%u %s %.1f s + %.1f s: loss %.2f%% (%llu/%llu) %s | reconnects %llu failures %llu "
+           "hb_timeouts %llu wifi_losses %llu errors %llu queue_drops %llu | transitions %llu (",
+           (now - start_ms) / 1000.0, scenario_count, fault, sc->fault_ms / 1000.0,
+           (sc->fault_end_ms != 0) ? (now - sc->fault_end_ms) / 1000.0 : 0.0, (loss < 0.0) ? 0.0 : loss,
+           (unsigned long long)delivered, (unsigned long long)expected, recovery, (unsigned long long)reconnects,
+           (unsigned long long)(end.connect_failures - sc->start.connect_failures),
+           (unsigned long long)(end.link_dead - sc->start.link_dead),
+           (unsigned long long)(end.wifi_losses - sc->start.wifi_losses),
+           (unsigned long long)(end.publish_errors - sc->start.publish_errors),
+           (unsigned long long)(end.queue_drops - sc->start.queue_drops), (unsigned long long)transitions);
+    for (uint32_t st = 0; st < SIM_STATE_COUNT; st++) {
+        printf("%s%s %llu", (st > 0) ? " " : "", state_names[st], (unsigned long long)(end.entered[st] - sc->start.entered[st]));
+    }
+    uint64_t scans = end.wifi_scans - sc->start.wifi_scans;
+    uint64_t directed = end.wifi_directed - sc->start.wifi_directed;
+    uint64_t resumes = end.resumes - sc->start.resumes;
+    uint64_t resume_ms = end.resume_ms_sum - sc->start.resume_ms_sum;
+    printf(") | wifi scan %llu directed %llu failed %llu, boot->idle %.2f s, link->stream %.2f s",
+           (unsigned long long)scans, (unsigned long long)directed,
+           (unsigned long long)(end.wifi_directed_failures - sc->start.wifi_directed_failures),
+           mean_s(end.boot_to_idle_ms_sum - sc->start.boot_to_idle_ms_sum, end.boots_to_idle - sc->start.boots_to_idle),
+           mean_s(resume_ms, resumes));
+    printf(" | rss %+ld KiB heap %+ld KiB\n", memory.rss_kib - sc->memory.rss_kib, memory.heap_kib - sc->memory.heap_kib);
+    fflush(stdout);
+
+    aggregate_t *a = &aggregates[sc->fault];
+    a->runs++;
+    a->expected += expected;
+    a->delivered += delivered;
+    a->recovery_ms_sum += recovery_sum;
+    a->recovered += recovered;
+    a->recovery_ms_max = (recovery_max > a->recovery_ms_max) ? recovery_max : a->recovery_ms_max;
+    a->stuck += stuck;
+    a->reconnects += reconnects;
+    a->wifi_scans += scans;
+    a->wifi_directed += directed;
+    a->resumes += resumes;
+    a->resume_ms_sum += resume_ms;
+    a->transitions += transitions;
+    scenario_count++;
+}
+
+static void final_report(uint32_t elapsed_ms, const memory_t *first, const memory_t *last, long rss_peak_kib) {
+    printf("\n=== soak summary: %u devices, %u ms frames, qos %u, fec %u, %.1f s, %u scenarios ===\n", config.devices,
+           config.sim.frame_ms, config.sim.qos, config.sim.fec_group, elapsed_ms / 1000.0, scenario_count);
+    printf("%-10s %6s %9s %13s %12s %7s %11s %6s %9s %12s %12s\n", "fault", "runs", "loss", "recovery avg", "recovery max",
+           "stuck", "reconnects", "scans", "directed", "link->stream", "transitions");
+    for (uint32_t f = 0; f < FAULT_COUNT; f++) {
+        const aggregate_t *a = &aggregates[f];
+        if (a->runs == 0) {
+            continue;
+        }
+        double loss = (a->expected > 0) ? 100.0 * (1.0 - (double)a->delivered / a->expected) : 0.0;
+        printf("%-10s %6u %8.3f%%", fault_names[f], a->runs, (loss < 0.0) ? 0.0 : loss);
+        if (a->recovered > 0) {
+            printf(" %11.2f s %10.2f s", a->recovery_ms_sum / 1000.0 / a->recovered, a->recovery_ms_max / 1000.0);
+        } else {
+            printf(" %13s %12s", "-", "-");
+        }
+        printf(" %7u %11llu %6llu %9llu %10.2f s %12llu\n", a->stuck, (unsigned long long)a->reconnects,
+               (unsigned long long)a->wifi_scans, (unsigned long long)a->wifi_directed, mean_s(a->resume_ms_sum, a->resumes),
+               (unsigned long long)a->transitions);
+    }
+    printf("memory     rss %ld -> %ld KiB (%+ld, peak %ld), heap in use %ld -> %ld KiB (%+ld)\n", first->rss_kib,
+           last->rss_kib, last->rss_kib - first->rss_kib, rss_peak_kib, first->heap_kib, last->heap_kib,
+           last->heap_kib - first->heap_kib);
+    totals_t t;
+    sum_devices(&t);
+    printf("wifi       fast reconnect %s, %llu scans, %llu directed (%llu failed), boot->idle mean %.2f s over %llu boots\n",
+           config.sim.wifi_cache ? "on" : "off", (unsigned long long)t.wifi_scans, (unsigned long long)t.wifi_directed,
+           (unsigned long long)t.wifi_directed_failures, mean_s(t.boot_to_idle_ms_sum, t.boots_to_idle),
+           (unsigned long long)t.boots_to_idle);
+    printf("proxy      %u connections accepted, %u reset\n", (unsigned int)proxy.accepted, (unsigned int)proxy.aborted);
+}
+
+// --- 主程序 ---
+
+static void on_signal(int sig) {
+    (void)sig;
+    atomic_store(&interrupted, true);
+}
+
+static void usage(const char *argv0) {
+    fprintf(stderr,
+            "usage: %s [-h broker_host] [-p broker_port] [-l proxy_port] [-n devices] [-T total_seconds]\n"
+            "          [-s script] [-w file.wav] [-f fec_group] [-q qos] [-m frame_ms] [-j jitter_ms] [-a wifi_scan_ms]\n"
+            "          [-C]   (disable fast Wi-Fi reconnect)\n"
+            "script lines: <seconds> <none|wifi_drop|reset|hang|slow_ack ms|cap kbit/s|ap_change|reboot>\n", argv0);
+}
+
+int main(int argc, char **argv) {
+    int opt;
+    while ((opt = getopt(argc, argv, "h:p:l:n:T:s:w:f:q:m:j:a:C")) != -1) {
+        switch (opt) {
+            case 'h': config.broker_host = optarg; break;
+            case 'p': config.broker_port = (uint16_t)atoi(optarg); break;
+            case 'l': config.listen_port = (uint16_t)atoi(optarg); break;
+            case 'n': config.devices = (uint32_t)atoi(optarg); break;
+            case 'T': config.total_s = (uint32_t)atoi(optarg); break;
+            case 's': config.script_path = optarg; break;
+            case 'w': config.wav_path = optarg; break;
+            case 'f': config.sim.fec_group = (uint32_t)atoi(optarg); break;
+            case 'q': config.sim.qos = (uint8_t)atoi(optarg); break;
+            case 'm': config.sim.frame_ms = (uint32_t)atoi(optarg); break;
+            case 'j': config.sim.jitter_ms = (uint32_t)atoi(optarg); break;
+            case 'a': config.sim.wifi_scan_ms = (uint32_t)atoi(optarg); break;
+            case 'C': config.sim.wifi_cache = false; break;
+            default: usage(argv[0]); return 2;
+        }
+    }
+    if (config.devices == 0 || config.devices > SIM_MAX_DEVICES || config.sim.qos > 1 ||
+        config.sim.frame_ms < AUDIO_MIN_FRAME_DURATION_MS || config.sim.frame_ms > AUDIO_MAX_FRAME_DURATION_MS ||
+        config.sim.frame_ms % AUDIO_MIN_FRAME_DURATION_MS != 0 ||
+        (config.sim.fec_group != 0 && (config.sim.fec_group < FEC_MIN_GROUP_SIZE || config.sim.fec_group > FEC_MAX_GROUP_SIZE))) {
+        usage(argv[0]);
+        return 2;
+    }
+
+    static phase_t phases[SOAK_MAX_PHASES];
+    uint32_t phase_count;
+    if (config.script_path != NULL) {
+        FILE *f = fopen(config.script_path, "r");
+        if (f == NULL) {
+            fprintf(stderr, "cannot open %s\n", config.script_path);
+            return 1;
+        }
+        phase_count = load_script(f, phases);
+        fclose(f);
+        if (phase_count == 0) {
+            return 1;
+        }
+    } else {
+        phase_count = default_script(phases);
+    }
+    if (config.wav_path != NULL) {
+        if (!sim_source_load_wav(config.wav_path, &source)) {
+            fprintf(stderr, "%s: not a 16-bit PCM WAV with <= %u channels at <= %u Hz\n", config.wav_path, AUDIO_CHANNELS,
+                    AUDIO_MAX_OUTPUT_SAMPLE_RATE);
+            return 1;
+        }
+    } else {
+        sim_source_synthesize(&source);
+    }
+
+    int reason = 0;
+    if (!sim_monitor_start(&monitor, config.broker_host, config.broker_port, "soak_monitor", &reason)) {
+        fprintf(stderr, "cannot connect to %s:%u (%d)\n", config.broker_host, config.broker_port, reason);
+        return 1;
+    }
+    if (!proxy_start(&proxy, config.broker_host, config.broker_port, config.listen_port)) {
+        fprintf(stderr, "cannot listen on 127.0.0.1:%u\n", config.listen_port);
+        return 1;
+    }
+    config.sim.port = config.listen_port;
+    signal(SIGINT, on_signal);
+    signal(SIGTERM, on_signal);
+
+    start_ms = host_now_ms();
+    sleep_ms(200);  // 等监视端订阅生效
+    devices = calloc(config.devices, sizeof(sim_device_t));
+    uint32_t boot_ms = config.sim.wifi_scan_ms + config.sim.wifi_join_ms + config.sim.wifi_dhcp_ms;  // 首次关联没有缓存
+    for (uint32_t i = 0; i < config.devices; i++) {
+        sim_device_start(&devices[i], i, &config.sim, &source, start_ms + boot_ms + i * 20u);
+    }
+    uint32_t warmup_start = host_now_ms();
+    for (;;) {
+        uint32_t streaming = 0;
+        for (uint32_t i = 0; i < config.devices; i++) {
+            streaming += (devices[i].state == APP_STATE_MEETING_IN_PROGRESS) ? 1u : 0u;
+        }
+        if (streaming == config.devices || (host_now_ms() - warmup_start) >= SOAK_WARMUP_MAX_MS || atomic_load(&interrupted)) {
+            totals_t t;
+            sum_devices(&t);
+            printf("[soak] %u/%u devices streaming after %.1f s (boot->idle mean %.2f s), starting fault script (%u phases%s)\n",
+                   streaming, config.devices, (host_now_ms() - start_ms) / 1000.0, mean_s(t.boot_to_idle_ms_sum, t.boots_to_idle),
+                   phase_count, (config.total_s > 0) ? ", looping" : "");
+            break;
+        }
+        sleep_ms(100);
+    }
+
+    memory_t first;
+    memory_t last;
+    sample_memory(&first);
+    long rss_peak_kib = first.rss_kib;
+    uint32_t script_start = host_now_ms();
+    scenario_t sc;
+    bool open = false;
+    uint32_t ap_generation = 0;
+    uint32_t reboot_ms = 0;
+    for (uint32_t index = 0; !atomic_load(&interrupted); index++) {
+        const phase_t *phase = &phases[index % phase_count];
+        bool recovery = phase->fault == FAULT_NONE && open && sc.fault != FAULT_NONE && sc.fault_end_ms == 0;
+        if (!recovery) {
+            bool pass_done = index > 0 && (index % phase_count) == 0;
+            bool time_up = (host_now_ms() - script_start) >= config.total_s * 1000u;
+            if (pass_done && (config.total_s == 0 || time_up)) {
+                break;
+            }
+            if (open) {
+                finish_scenario(&sc);
+            }
+            begin_scenario(&sc, phase);
+            open = true;
+        }
+        if (phase->fault == FAULT_AP_CHANGE) {
+            all_devices_ap(++ap_generation);
+        }
+        all_devices_wifi(phase->fault != FAULT_WIFI_DROP && phase->fault != FAULT_AP_CHANGE);
+        proxy_set_fault(&proxy, phase->fault, phase->param);
+        if (phase->fault == FAULT_REBOOT) {
+            reboot_ms = host_now_ms();
+            all_devices_reboot();
+        }
+        if (recovery) {
+            // 逐台重启要等各自的线程退出，恢复时间从开始重启算起
+            sc.fault_end_ms = (sc.fault == FAULT_REBOOT) ? reboot_ms : host_now_ms();
+            sim_monitor_mark(&monitor, sc.fault_end_ms);
+        }
+
+        uint32_t phase_start = host_now_ms();
+        while ((host_now_ms() - phase_start) < phase->duration_ms && !atomic_load(&interrupted)) {
+            sleep_ms(100);
+            memory_t m;
+            sample_memory(&m);
+            rss_peak_kib = (m.rss_kib > rss_peak_kib) ? m.rss_kib : rss_peak_kib;
+        }
+    }
+    if (open) {
+        finish_scenario(&sc);
+    }
+    sample_memory(&last);
+
+    uint32_t elapsed_ms = host_now_ms() - script_start;
+    proxy_set_fault(&proxy, FAULT_NONE, 0);
+    all_devices_wifi(true);
+    for (uint32_t i = 0; i < config.devices; i++) {
+        sim_device_stop(&devices[i]);
+    }
+    sim_monitor_stop(&monitor, SOAK_DRAIN_MS);
+    proxy_stop(&proxy);
+    final_report(elapsed_ms, &first, &last, rss_peak_kib);
+    return 0;
+}
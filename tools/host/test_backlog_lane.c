@@ -0,0 +1,321 @@
+// backlog_lane.c 的主机检查：积压通道的挤出、过期和令牌桶，以及断线恢复后实时帧延迟和积压追平时间的模拟。
+// 确定场景：满时挤出最旧的帧且返回顺序与入队顺序一致，过期只取出超龄的队头，令牌不超过桶深、不足一帧时不出队，
+// 毫秒计数回绕时帧龄和补充时间仍正确，追平耗时从通道变为非空算起。
+// 断线模拟 (按毫秒推进)：每 AUDIO_FRAME_DURATION_MS 采集一帧 (PCM 全采样率，线上 TEST_FRAME_BYTES 字节) 进入
+// AUDIO_QUEUE_LENGTH 帧的 audio_queue (满时按默认的 DROP_OLDEST 挤出队头)；网络任务空闲时按 network_task.c 的
+// schedule_audio_frames() 的顺序调度：实时通道出队，帧龄超过 AUDIO_LIVE_MAX_AGE_MS 的帧转入 AUDIO_BACKLOG_LENGTH
+// 帧的积压通道，实时通道为空时丢弃超过 AUDIO_BACKLOG_MAX_AGE_MS 的积压帧、补充令牌、按令牌补发。报文写入
+// TEST_SEND_BUFFER 字节的发送缓冲，缓冲满时发布阻塞，发送缓冲按链路带宽排空，帧的送达时刻为其最后一个字节离开缓冲。
+// 剩余带宽按理想估计 (链路带宽 - 档位码率) 给出，码率自适应的估计误差见 test_rate_control.c。
+// 同一场景再以单一 FIFO (所有帧按序走实时通道) 运行作为对照。
+// 门限：恢复后采集的帧送达延迟不超过 TEST_MAX_LIVE_LATENCY_MS；积压帧按采集顺序送达，追平时间不超过
+// 积压量 / (剩余带宽 * 份额) 的 TEST_CATCHUP_SLACK_PCT 再加一个帧长；帧数守恒；份额为 0 时不补发，积压帧到期后全部丢弃。
+//
+// 构建 (主机，在仓库根目录)：
+//   cc -O2 -Isrc -o test_backlog_lane tools/host/test_backlog_lane.c src/backlog_lane.c
+// 运行：
+//   ./test_backlog_lane       # 任一项超出门限时返回 1
+
+#include "backlog_lane.h"
+#include "app_config.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define TEST_FRAME_BYTES        (1296u)     // 16 字节帧头 + 16 kHz 单声道 40 ms 的 PCM (audio_frame_payload_len())
+#define TEST_PUBLISH_OVERHEAD   (32u)       // 每帧的 PUBLISH 报头
+#define TEST_TIER_BPS           (TEST_FRAME_BYTES * 8u * 1000u / AUDIO_FRAME_DURATION_MS)
+#define TEST_SEND_BUFFER        (8192u)
+#define TEST_BUCKET_BITS        (2u * TEST_FRAME_BYTES * 8u)
+#define TEST_MAX_FRAMES         (8192u)
+#define TEST_RECOVERY_S         (70u)       // 恢复后模拟的时长，超过 AUDIO_BACKLOG_MAX_AGE_MS
+#define TEST_MAX_LIVE_LATENCY_MS (AUDIO_LIVE_MAX_AGE_MS)
+#define TEST_CATCHUP_SLACK_PCT  (120u)
+
+typedef struct {
+    uint32_t captured_ms;
+    uint32_t delivered_ms;
+    bool delivered;
+    bool backlog;
+    bool dropped;
+} sim_frame_t;
+
+typedef struct {
+    uint32_t outage_s;
+    uint32_t link_kbps;
+    uint32_t share_pct;
+    bool fifo;
+} scenario_t;
+
+typedef struct {
+    uint32_t live_latency_max_ms;       // 恢复后采集的帧
+    uint32_t live_latency_p99_ms;
+    uint32_t backlog_queued;            // 进入积压通道的帧
+    uint32_t backlog_delivered;
+    uint32_t backlog_dropped;           // 积压通道挤出或过期
+    uint32_t overload_dropped;          // audio_queue 满时挤出
+    uint32_t catchup_ms;
+    uint32_t backlog_last_delivered_ms; // 最后一个积压帧的送达时刻 (相对恢复)
+    bool ordered;
+    bool conserved;
+} sim_result_t;
+
+static sim_frame_t frames[TEST_MAX_FRAMES];
+
+static bool check(bool condition, const char *what) {
+    printf("%-72s %s\n", what, condition ? "ok" : "FAIL");
+    return condition;
+}
+
+static bool check_lane_unit(void) {
+    bool ok = true;
+    backlog_lane_t lane;
+    int tags[8];
+    ok &= check(!backlog_lane_init(&lane, 0, TEST_BUCKET_BITS, 0) &&
+                !backlog_lane_init(&lane, BACKLOG_LANE_MAX_FRAMES + 1u, TEST_BUCKET_BITS, 0), "init rejects capacity 0 and over maximum");
+
+    // 满时挤出最旧的帧
+    backlog_lane_init(&lane, 3, TEST_BUCKET_BITS, 100);
+    bool evict_ok = true;
+    for (int i = 0; i < 5; i++) {
+        void *evicted = backlog_lane_push(&lane, &tags[i], (uint32_t)(100 + i * 40), TEST_FRAME_BYTES, 200);
+        evict_ok &= (i < 3) ? evicted == NULL : evicted == &tags[i - 3];
+    }
+    evict_ok &= backlog_lane_depth(&lane) == 3 && lane.started_ms == 200;
+    ok &= check(evict_ok, "full lane evicts the oldest frame, depth stays at capacity");
+
+    // 没有令牌时不出队，补充后按入队顺序出队，令牌不超过桶深
+    bool pace_ok = backlog_lane_pop(&lane, 200) == NULL;
+    backlog_lane_refill(&lane, 10200, 1000000u, 100);
+    pace_ok &= lane.tokens == (uint64_t)TEST_BUCKET_BITS * 1000u;
+    pace_ok &= backlog_lane_pop(&lane, 10200) == &tags[2] && backlog_lane_pop(&lane, 10200) == &tags[3];
+    pace_ok &= backlog_lane_pop(&lane, 10200) == NULL && lane.tokens == 0;
+    // 一帧的令牌：TEST_FRAME_BYTES * 8 比特，按 8 kbit/s 的 50% (每毫秒 4 比特) 需要 TEST_FRAME_BYTES * 2 毫秒
+    uint32_t ready = 10200u + TEST_FRAME_BYTES * 2u;
+    backlog_lane_refill(&lane, ready - 1u, 8000u, 50);
+    pace_ok &= backlog_lane_pop(&lane, ready - 1u) == NULL;
+    backlog_lane_refill(&lane, ready, 8000u, 50);
+    pace_ok &= backlog_lane_pop(&lane, ready) == &tags[4] && lane.last_catchup_ms == ready - 200u;
+    ok &= check(pace_ok, "token bucket caps at its depth and paces pops in capture order");
+
+    // 过期只取出超龄的队头；毫秒计数回绕
+    uint32_t base = 0xFFFFFF00u;
+    backlog_lane_init(&lane, 4, TEST_BUCKET_BITS, base);
+    backlog_lane_push(&lane, &tags[0], base, TEST_FRAME_BYTES, base + 10u);
+    backlog_lane_push(&lane, &tags[1], base + 200u, TEST_FRAME_BYTES, base + 210u);
+    uint32_t now = base + 1100u;    // 已回绕
+    bool expire_ok = backlog_lane_expire(&lane, now, 1000) == &tags[0] && backlog_lane_expire(&lane, now, 1000) == NULL;
+    backlog_lane_refill(&lane, now, 8000u, 100);
+    expire_ok &= lane.tokens == 8000ull * 1100u;
+    expire_ok &= backlog_lane_expire(&lane, now + 201u, 1000) == &tags[1] && lane.last_catchup_ms == now + 201u - (base + 10u);
+    ok &= check(expire_ok, "expiry removes only stale head frames, ages survive ms wraparound");
+    return ok;
+}
+
+static int compare_u32(const void *a, const void *b) {
+    uint32_t x = *(const uint32_t *)a, y = *(const uint32_t *)b;
+    return (x > y) - (x < y);
+}
+
+static void run_scenario(const scenario_t *sc, sim_result_t *r) {
+    memset(frames, 0, sizeof(frames));
+    memset(r, 0, sizeof(*r));
+
+    // audio_queue 是帧下标的环形缓冲
+    uint32_t queue[AUDIO_QUEUE_LENGTH];
+    uint32_t queue_head = 0, queue_count = 0;
+    backlog_lane_t lane;
+    backlog_lane_init(&lane, AUDIO_BACKLOG_LENGTH, TEST_BUCKET_BITS, 0);
+
+    uint32_t produced = 0;
+    uint32_t send_buffer = 0;
+    uint64_t drain_credit = 0;
+    int32_t publishing = -1;            // 正在写入发送缓冲的帧
+    uint32_t publish_remaining = 0;
+    uint32_t last_backlog_capture = 0;
+    bool any_backlog = false;
+    r->ordered = true;
+
+    // 发送缓冲中的帧：送达时刻为其最后一个字节离开缓冲
+    uint32_t inflight[64];
+    uint32_t inflight_end[64];          // 该帧最后一个字节在累计写入字节中的位置
+    uint32_t inflight_head = 0, inflight_count = 0;
+    uint64_t written = 0, drained_total = 0;
+
+    uint32_t outage_start = 5000u;
+    uint32_t outage_end = outage_start + sc->outage_s * 1000u;
+    uint32_t end_ms = outage_end + TEST_RECOVERY_S * 1000u;
+    uint32_t spare_bps = sc->link_kbps * 1000u > TEST_TIER_BPS ? sc->link_kbps * 1000u - TEST_TIER_BPS : 0;
+
+    for (uint32_t now = 1; now < end_ms; now++) {
+        bool link_up = now < outage_start || now >= outage_end;
+
+        if (now % AUDIO_FRAME_DURATION_MS == 0 && produced < TEST_MAX_FRAMES) {
+            frames[produced].captured_ms = now;
+            if (queue_count == AUDIO_QUEUE_LENGTH) {
+                frames[queue[queue_head]].dropped = true;
+                queue_head = (queue_head + 1u) % AUDIO_QUEUE_LENGTH;
+                queue_count--;
+                r->overload_dropped++;
+            }
+            queue[(queue_head + queue_count) % AUDIO_QUEUE_LENGTH] = produced++;
+            queue_count++;
+        }
+
+        if (!link_up) {
+            // 断线：发送缓冲中的数据和正在发布的帧丢失 (QoS0)，网络任务不出队
+            while (inflight_count > 0) {
+                frames[inflight[inflight_head]].dropped = true;
+                inflight_head = (inflight_head + 1u) % 64u;
+                inflight_count--;
+            }
+            if (publishing >= 0) {
+                frames[publishing].dropped = true;
+                publishing = -1;
+            }
+            written = drained_total = 0;
+            send_buffer = 0;
+            drain_credit = 0;
+            continue;
+        }
+
+        // 网络任务空闲时按 schedule_audio_frames() 的顺序取下一帧
+        if (publishing < 0) {
+            while (queue_count > 0) {
+                uint32_t index = queue[queue_head];
+                queue_head = (queue_head + 1u) % AUDIO_QUEUE_LENGTH;
+                queue_count--;
+                if (!sc->fifo && now - frames[index].captured_ms > AUDIO_LIVE_MAX_AGE_MS) {
+                    frames[index].backlog = true;
+                    r->backlog_queued++;
+                    sim_frame_t *evicted = backlog_lane_push(&lane, &frames[index], frames[index].captured_ms,
+                                                             TEST_FRAME_BYTES, now);
+                    if (evicted != NULL) {
+                        evicted->dropped = true;
+                        r->backlog_dropped++;
+                    }
+                    continue;
+                }
+                publishing = (int32_t)index;
+                break;
+            }
+            if (publishing < 0 && !sc->fifo) {
+                sim_frame_t *frame;
+                while ((frame = backlog_lane_expire(&lane, now, AUDIO_BACKLOG_MAX_AGE_MS)) != NULL) {
+                    frame->dropped = true;
+                    r->backlog_dropped++;
+                }
+                backlog_lane_refill(&lane, now, spare_bps, sc->share_pct);
+                frame = backlog_lane_pop(&lane, now);
+                if (frame != NULL) {
+                    publishing = (int32_t)(frame - frames);
+                }
+            }
+            if (publishing >= 0) {
+                publish_remaining = TEST_FRAME_BYTES + TEST_PUBLISH_OVERHEAD;
+            }
+        }
+        if (publishing >= 0) {
+            uint32_t space = TEST_SEND_BUFFER - send_buffer;
+            uint32_t n = (publish_remaining < space) ? publish_remaining : space;
+            send_buffer += n;
+            written += n;
+            publish_remaining -= n;
+            if (publish_remaining == 0) {
+                inflight[(inflight_head + inflight_count) % 64u] = (uint32_t)publishing;
+                inflight_end[(inflight_head + inflight_count) % 64u] = (uint32_t)written;
+                inflight_count++;
+                publishing = -1;
+            }
+        }
+
+        drain_credit += sc->link_kbps;
+        uint32_t drained = (uint32_t)(drain_credit / 8u);
+        if (drained > send_buffer) {
+            drained = send_buffer;
+            drain_credit = 0;
+        } else {
+            drain_credit -= (uint64_t)drained * 8u;
+        }
+        send_buffer -= drained;
+        drained_total += drained;
+        while (inflight_count > 0 && inflight_end[inflight_head] <= drained_total) {
+            sim_frame_t *f = &frames[inflight[inflight_head]];
+            f->delivered = true;
+            f->delivered_ms = now;
+            if (f->backlog) {
+                r->ordered &= !any_backlog || f->captured_ms > last_backlog_capture;
+                last_backlog_capture = f->captured_ms;
+                any_backlog = true;
+                r->backlog_delivered++;
+                r->backlog_last_delivered_ms = now - outage_end;
+            }
+            inflight_head = (inflight_head + 1u) % 64u;
+            inflight_count--;
+        }
+    }
+
+    // 恢复后采集的帧的送达延迟
+    static uint32_t latencies[TEST_MAX_FRAMES];
+    uint32_t n = 0, delivered = 0, dropped = 0;
+    for (uint32_t i = 0; i < produced; i++) {
+        delivered += frames[i].delivered;
+        dropped += frames[i].dropped;
+        if (frames[i].captured_ms >= outage_end && frames[i].delivered) {
+            latencies[n++] = frames[i].delivered_ms - frames[i].captured_ms;
+        }
+    }
+    qsort(latencies, n, sizeof(latencies[0]), compare_u32);
+    r->live_latency_max_ms = n ? latencies[n - 1] : 0;
+    r->live_latency_p99_ms = n ? latencies[n * 99u / 100u] : 0;
+    r->catchup_ms = lane.last_catchup_ms;
+    // 结束时仍在 audio_queue、积压通道或发送路径中的帧
+    uint32_t pending = queue_count + backlog_lane_depth(&lane) + inflight_count + (publishing >= 0);
+    r->conserved = delivered + dropped + pending == produced;
+}
+
+int main(void) {
+    bool ok = check_lane_unit();
+
+    static const scenario_t scenarios[] = {
+        { 2, 1000, AUDIO_BACKLOG_SHARE_PCT, false }, { 2, 1000, AUDIO_BACKLOG_SHARE_PCT, true },
+        { 10, 1000, AUDIO_BACKLOG_SHARE_PCT, false }, { 10, 1000, AUDIO_BACKLOG_SHARE_PCT, true },
+        { 10, 400, AUDIO_BACKLOG_SHARE_PCT, false }, { 10, 400, AUDIO_BACKLOG_SHARE_PCT, true },
+        { 10, 400, 20, false },
+        { 10, 300, AUDIO_BACKLOG_SHARE_PCT, false }, { 10, 300, AUDIO_BACKLOG_SHARE_PCT, true },
+        { 10, 1000, 0, false },
+    };
+    printf("frame %u bytes every %u ms (%u kbit/s), audio_queue %u, backlog lane %u, live cut-off %u ms\n",
+           (unsigned int)TEST_FRAME_BYTES, (unsigned int)AUDIO_FRAME_DURATION_MS, (unsigned int)(TEST_TIER_BPS / 1000u),
+           (unsigned int)AUDIO_QUEUE_LENGTH, (unsigned int)AUDIO_BACKLOG_LENGTH, (unsigned int)AUDIO_LIVE_MAX_AGE_MS);
+    for (size_t i = 0; i < sizeof(scenarios) / sizeof(scenarios[0]); i++) {
+        const scenario_t *sc = &scenarios[i];
+        sim_result_t r;
+        run_scenario(sc, &r);
+        bool pass = r.ordered && r.conserved;
+        if (!sc->fifo) {
+            pass &= r.live_latency_max_ms <= TEST_MAX_LIVE_LATENCY_MS;
+            uint32_t spare_bps = sc->link_kbps * 1000u - TEST_TIER_BPS;
+            if (sc->share_pct > 0) {
+                // 最后一个积压帧进入通道到发完：积压量 / 补发速率，令牌桶开始时为空
+                uint64_t expected_ms = (uint64_t)r.backlog_delivered * TEST_FRAME_BYTES * 8u * 1000u * 100u /
+                                       ((uint64_t)spare_bps * sc->share_pct);
+                pass &= r.backlog_delivered + r.backlog_dropped == r.backlog_queued &&
+                        r.catchup_ms <= expected_ms * TEST_CATCHUP_SLACK_PCT / 100u + AUDIO_FRAME_DURATION_MS;
+            } else {
+                pass &= r.backlog_delivered == 0 && r.backlog_dropped == r.backlog_queued;
+            }
+        }
+        printf("%2u s outage, %4u kbit/s, %-4s share %3u%%: live after recovery p99 %4u / max %5u ms, "
+               "backlog %2u queued, %2u sent, %2u dropped (+%u overload), catch-up %5.1f s  %s\n",
+               (unsigned int)sc->outage_s, (unsigned int)sc->link_kbps, sc->fifo ? "FIFO" : "two-lane",
+               (unsigned int)sc->share_pct, (unsigned int)r.live_latency_p99_ms, (unsigned int)r.live_latency_max_ms,
+               (unsigned int)r.backlog_queued, (unsigned int)r.backlog_delivered, (unsigned int)r.backlog_dropped,
+               (unsigned int)r.overload_dropped,
+               sc->fifo ? 0.0 : (sc->share_pct ? r.catchup_ms / 1000.0 : -1.0), pass ? "ok" : "FAIL");
+        ok &= pass;
+    }
+
+    printf("%s\n", ok ? "all checks passed" : "FAILED");
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,169 @@
+// broker_select.c 的主机检查：排序规则的断言，以及两个代理的故障切换时间线。
+// 断言：未连接过的代理按列表顺序；失败把代理排到后面；近期失败次数每 BROKER_SELECT_FAILURE_DECAY_MS 减半；
+// 恢复的首选代理在失败次数衰减到 0 后重新排到前面；按平滑连接耗时排序；毫秒计数回绕不影响衰减；超出上限的代理被忽略。
+// 时间线：首选代理 A (连接 150 ms) 和备用代理 B (连接 300 ms)，按 network_task.c 的连接流程
+// (每轮按分数依次尝试、失败换下一个、整轮失败后等 3 s，最多 TEST_CONNECT_PASSES 轮) 推进：A 重启期间切到 B，
+// B 随后掉线时两个代理都不可达，按轮重试直到 A 恢复。三轮都失败时 connect_to_mqtt_broker() 放弃，
+// 之后要等下一个 Wi-Fi 或 MQTT 事件才会再次连接，时间线在此结束。
+// 连接失效由心跳在 MQTT_HEARTBEAT_TIMEOUT_MS 后判定，连接不可达的代理按 TEST_DEAD_ATTEMPT_MS 计。时间线只打印。
+//
+// 构建 (主机，在仓库根目录)：
+//   cc -O2 -Isrc -o test_broker_select tools/host/test_broker_select.c src/broker_select.c
+// 运行：
+//   ./test_broker_select      # 任一项超出门限时返回 1
+
+#include "broker_select.h"
+#include "app_config.h"
+#include <stdio.h>
+#include <string.h>
+
+#define TEST_DEAD_ATTEMPT_MS    (1000u)     // 对不可达代理的一次连接尝试的耗时 (假设)
+#define TEST_RETRY_PAUSE_MS     (3000u)     // 整轮失败后的等待，与 network_task.c 相同
+#define TEST_CONNECT_PASSES     (3u)        // connect_to_mqtt_broker() 的轮数
+#define TEST_TIMELINE_END_MS    (400000u)
+
+static const char *const addresses[] = { "A", "B", "C", "D", "E" };
+
+static bool expect_order(broker_select_t *bs, uint32_t now_ms, const char *expected, const char *what) {
+    uint32_t order[BROKER_SELECT_MAX_ENDPOINTS];
+    uint32_t count = broker_select_rank(bs, now_ms, order);
+    char got[BROKER_SELECT_MAX_ENDPOINTS + 1];
+    for (uint32_t i = 0; i < count; i++) {
+        got[i] = bs->endpoints[order[i]].address[0];
+    }
+    got[count] = '\0';
+    bool ok = (strcmp(got, expected) == 0);
+    printf("%-52s order %-4s  %s\n", what, got, ok ? "ok" : "FAIL");
+    return ok;
+}
+
+static bool check_ranking(void) {
+    broker_select_t bs;
+    bool ok = true;
+
+    broker_select_init(&bs, addresses, 5u, 0);
+    ok &= (bs.count == BROKER_SELECT_MAX_ENDPOINTS);
+    ok &= expect_order(&bs, 0, "ABCD", "unknown brokers keep list order, extra ignored");
+
+    broker_select_report_failure(&bs, 0, 1000u);
+    ok &= expect_order(&bs, 1000u, "BCDA", "a failure demotes the broker");
+
+    broker_select_init(&bs, addresses, 2u, 0);
+    for (uint32_t i = 0; i < 4u; i++) {
+        broker_select_report_failure(&bs, 0, 0);
+    }
+    static const uint32_t expected[] = { 4u, 4u, 2u, 1u, 0u };
+    static const uint32_t at_ms[] = { 0, BROKER_SELECT_FAILURE_DECAY_MS - 1u, BROKER_SELECT_FAILURE_DECAY_MS,
+                                      2u * BROKER_SELECT_FAILURE_DECAY_MS, 3u * BROKER_SELECT_FAILURE_DECAY_MS };
+    bool halves = true;
+    for (size_t i = 0; i < sizeof(expected) / sizeof(expected[0]); i++) {
+        uint32_t score = broker_select_score(&bs, 0, at_ms[i]);
+        halves &= (score == BROKER_SELECT_UNKNOWN_CONNECT_MS + expected[i] * BROKER_SELECT_FAILURE_PENALTY_MS);
+    }
+    printf("%-52s %s\n", "failure count halves every decay period", halves ? "ok" : "FAIL");
+    ok &= halves;
+
+    // 首选代理连接快，失效一次后备用代理在前，衰减后首选代理回到前面
+    broker_select_init(&bs, addresses, 2u, 0);
+    broker_select_report_success(&bs, 0, 150u, 0);
+    broker_select_report_success(&bs, 1, 300u, 0);
+    broker_select_report_failure(&bs, 0, 10000u);
+    ok &= expect_order(&bs, 10000u + BROKER_SELECT_FAILURE_DECAY_MS - 1u, "BA", "failed primary stays behind before decay");
+    ok &= expect_order(&bs, 10000u + BROKER_SELECT_FAILURE_DECAY_MS, "AB", "recovered primary returns to the front");
+
+    // 平滑连接耗时 (1/4)：B 持续更快后排到前面
+    broker_select_init(&bs, addresses, 3u, 0);
+    broker_select_report_success(&bs, 0, 800u, 0);
+    broker_select_report_success(&bs, 1, 200u, 0);
+    ok &= expect_order(&bs, 0, "BAC", "faster broker first, unknown ones at 1 s");
+    broker_select_report_success(&bs, 0, 100u, 0);
+    ok &= (bs.endpoints[0].connect_ms_avg == (800u * 3u + 100u) / 4u);
+    ok &= expect_order(&bs, 0, "BAC", "one fast connect does not outweigh the average");
+
+    // 毫秒计数回绕
+    uint32_t base = UINT32_MAX - 1000u;
+    broker_select_init(&bs, addresses, 2u, base);
+    broker_select_report_failure(&bs, 0, base);
+    bool wraps = broker_select_score(&bs, 0, base + BROKER_SELECT_FAILURE_DECAY_MS) == BROKER_SELECT_UNKNOWN_CONNECT_MS;
+    printf("%-52s %s\n", "decay across millisecond counter wrap", wraps ? "ok" : "FAIL");
+    ok &= wraps;
+    return ok;
+}
+
+// 两个代理的故障切换时间线
+typedef struct {
+    uint32_t connect_ms;
+    uint32_t down_from_ms;
+    uint32_t down_until_ms;
+} sim_broker_t;
+
+static bool broker_up(const sim_broker_t *b, uint32_t now_ms) {
+    return now_ms < b->down_from_ms || now_ms >= b->down_until_ms;
+}
+
+static void timeline(void) {
+    static const sim_broker_t brokers[2] = {
+        { 150u, 60000u, 130000u },          // A 在 60 s 重启，130 s 恢复
+        { 300u, 120000u, 240000u },         // B 在 120 s 掉线，此时 A 尚未恢复
+    };
+    broker_select_t bs;
+    broker_select_init(&bs, addresses, 2u, 0);
+    uint32_t now = 0;
+    int active = -1;
+    uint32_t down = 0;
+    printf("failover timeline (A %u ms, B %u ms to connect; dead attempt %u ms):\n", (unsigned int)brokers[0].connect_ms,
+           (unsigned int)brokers[1].connect_ms, (unsigned int)TEST_DEAD_ATTEMPT_MS);
+    while (now < TEST_TIMELINE_END_MS) {
+        if (active < 0) {
+            for (uint32_t pass = 0; pass < TEST_CONNECT_PASSES && active < 0; pass++) {
+                uint32_t order[BROKER_SELECT_MAX_ENDPOINTS];
+                uint32_t count = broker_select_rank(&bs, now, order);
+                for (uint32_t i = 0; i < count && active < 0; i++) {
+                    uint32_t idx = order[i];
+                    if (broker_up(&brokers[idx], now)) {
+                        now += brokers[idx].connect_ms;
+                        broker_select_report_success(&bs, idx, brokers[idx].connect_ms, now);
+                        active = (int)idx;
+                    } else {
+                        now += TEST_DEAD_ATTEMPT_MS;
+                        broker_select_report_failure(&bs, idx, now);
+                        printf("  %6.1f s  %s unreachable\n", now / 1000.0, addresses[idx]);
+                    }
+                }
+                if (active < 0) {
+                    now += TEST_RETRY_PAUSE_MS;
+                }
+            }
+            if (active < 0) {
+                printf("  %6.1f s  gave up after %u passes, waiting for a Wi-Fi or MQTT event\n", now / 1000.0,
+                       (unsigned int)TEST_CONNECT_PASSES);
+                break;
+            }
+            printf("  %6.1f s  connected to %s (", now / 1000.0, addresses[active]);
+            if (down == 0) {
+                printf("startup");
+            } else {
+                printf("%.1f s of outage", (now - down) / 1000.0);
+            }
+            printf("; scores A %u, B %u)\n", (unsigned int)broker_select_score(&bs, 0, now),
+                   (unsigned int)broker_select_score(&bs, 1, now));
+        }
+        // 已连接：下一次变化是当前代理掉线 (心跳判定) 或时间线结束
+        const sim_broker_t *b = &brokers[active];
+        down = (now < b->down_from_ms) ? b->down_from_ms : TEST_TIMELINE_END_MS;
+        if (down >= TEST_TIMELINE_END_MS) {
+            break;
+        }
+        now = down + MQTT_HEARTBEAT_TIMEOUT_MS;
+        broker_select_report_failure(&bs, (uint32_t)active, now);
+        printf("  %6.1f s  %s down at %.1f s, heartbeat declares it dead\n", now / 1000.0, addresses[active], down / 1000.0);
+        active = -1;
+    }
+}
+
+int main(void) {
+    bool ok = check_ranking();
+    timeline();
+    printf("%s\n", ok ? "all checks passed" : "FAILED");
+    return ok ? 0 : 1;
+}
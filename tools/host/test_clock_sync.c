@@ -0,0 +1,235 @@
+// clock_sync.c 的主机检查：模拟 TEST_BOARDS 块板与同一个服务端做时钟同步，比较各板换算出的服务端时间。
+// 板的本地节拍 = floor(初始偏移 + 真实时间 × (1 + 漂移))，漂移在 -60 ~ +40 ppm 之间等距取值，初始偏移任意 (含 2^32 回绕)；
+// 服务端时钟为 floor(真实时间)，收到请求后立即回复 (t2 = t3)。上下行延迟各为 TEST_BASE_DELAY_MS + 指数分布抖动，
+// TEST_SPIKE_PROB 的请求额外排队 TEST_SPIKE_MIN_MS ~ TEST_SPIKE_MAX_MS，TEST_REPLY_LOSS 的回复丢失。
+// 每 TEST_EVAL_STEP_MS 在同一真实时刻取各板当前节拍，用 clock_sync_to_server() 换算：
+//   对齐误差 = 换算结果 - 该节拍开始时刻的真实时间 (毫秒)，按分钟统计均方根；板间差 = 同一时刻各板换算结果的最大差；
+//   漂移误差 = |drift_ppb - 真实漂移|。
+// 每种抖动运行 TEST_RUNS 次 (不同随机种子)，报告各次的均方根范围和最大板间差、最大漂移误差。另检查迟到、重复和格式错误的回复被拒绝。
+// 门限 (抖动均值 10 ms，第 10 分钟)：对齐误差均方根、板间最大差和漂移误差不超过 TEST_MAX_RMS_MS、TEST_MAX_SPREAD_MS、TEST_MAX_DRIFT_PPM。
+//
+// 构建 (主机，在仓库根目录)：
+//   cc -O2 -Isrc -o test_clock_sync tools/host/test_clock_sync.c src/clock_sync.c -lm
+// 运行：
+//   ./test_clock_sync         # 任一项超出门限时返回 1
+
+#include "clock_sync.h"
+#include "app_config.h"
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define TEST_BOARDS             (4)
+#define TEST_MINUTES            (10u)
+#define TEST_STEP_MS            (0.5)       // 模拟步长 (真实时间)
+#define TEST_EVAL_STEP_MS       (100u)
+#define TEST_BASE_DELAY_MS      (3.0)
+#define TEST_SPIKE_PROB         (0.05)
+#define TEST_SPIKE_MIN_MS       (50.0)
+#define TEST_SPIKE_MAX_MS       (300.0)
+#define TEST_REPLY_LOSS         (0.02)
+#define TEST_MAX_IN_FLIGHT      (8)
+#define TEST_RUNS               (8u)        // 每种抖动的独立运行次数 (不同随机种子)
+#define TEST_MAX_RMS_MS         (1.0)
+#define TEST_MAX_SPREAD_MS      (2)
+#define TEST_MAX_DRIFT_PPM      (3.0)
+
+typedef struct {
+    double arrive_ms;               // 回复到达的真实时间
+    uint8_t reply[CLOCK_SYNC_MSG_SIZE];
+} in_flight_t;
+
+typedef struct {
+    clock_sync_t cs;
+    double drift;                   // 本地节拍速率 - 1
+    double offset_ms;               // 真实时间 0 时的本地节拍
+    in_flight_t flight[TEST_MAX_IN_FLIGHT];
+    int flight_count;
+} board_t;
+
+typedef struct {
+    double sum_sq;
+    uint32_t count;
+    int32_t max_spread;
+    double max_drift_error_ppm;
+} minute_stats_t;
+
+static unsigned int seed;
+
+static double uniform(void) {
+    return ((double)rand_r(&seed) + 1.0) / ((double)RAND_MAX + 2.0);
+}
+
+static double leg_delay_ms(double jitter_mean_ms) {
+    return TEST_BASE_DELAY_MS - jitter_mean_ms * log(uniform());
+}
+
+static double local_exact(const board_t *b, double t_ms) {
+    return b->offset_ms + t_ms * (1.0 + b->drift);
+}
+
+static uint32_t local_tick(const board_t *b, double t_ms) {
+    return (uint32_t)(uint64_t)floor(local_exact(b, t_ms));
+}
+
+// 返回每分钟的统计，stats[m] 为第 m + 1 分钟
+static void simulate(double jitter_mean_ms, unsigned int run_seed, minute_stats_t stats[TEST_MINUTES]) {
+    static board_t boards[TEST_BOARDS];
+    seed = run_seed;
+    memset(stats, 0, TEST_MINUTES * sizeof(minute_stats_t));
+    for (int i = 0; i < TEST_BOARDS; i++) {
+        board_t *b = &boards[i];
+        memset(b, 0, sizeof(*b));
+        clock_sync_init(&b->cs, CLOCK_SYNC_INTERVAL_MS, CLOCK_SYNC_SAMPLES_PER_PERIOD);
+        clock_sync_start(&b->cs);
+        b->drift = (-60.0 + 100.0 * i / (TEST_BOARDS - 1)) * 1e-6;
+        b->offset_ms = floor(uniform() * 4294967296.0);
+    }
+    const uint64_t steps = (uint64_t)(TEST_MINUTES * 60000.0 / TEST_STEP_MS);
+    const uint64_t eval_every = (uint64_t)(TEST_EVAL_STEP_MS / TEST_STEP_MS);
+    for (uint64_t step = 1; step <= steps; step++) {
+        double t = step * TEST_STEP_MS;
+        for (int i = 0; i < TEST_BOARDS; i++) {
+            board_t *b = &boards[i];
+            uint32_t now = local_tick(b, t);
+            // 到达的回复
+            int kept = 0;
+            for (int f = 0; f < b->flight_count; f++) {
+                if (b->flight[f].arrive_ms <= t) {
+                    (void)clock_sync_on_reply(&b->cs, b->flight[f].reply, CLOCK_SYNC_MSG_SIZE, now);
+                } else {
+                    b->flight[kept++] = b->flight[f];
+                }
+            }
+            b->flight_count = kept;
+
+            uint8_t request[CLOCK_SYNC_MSG_SIZE];
+            if (clock_sync_poll(&b->cs, now, request) > 0) {
+                double at_server = t + leg_delay_ms(jitter_mean_ms);
+                if (uniform() < TEST_SPIKE_PROB) {
+                    at_server += TEST_SPIKE_MIN_MS + (TEST_SPIKE_MAX_MS - TEST_SPIKE_MIN_MS) * uniform();
+                }
+                uint32_t t2 = (uint32_t)(uint64_t)floor(at_server);
+                if (uniform() >= TEST_REPLY_LOSS && b->flight_count < TEST_MAX_IN_FLIGHT) {
+                    in_flight_t *f = &b->flight[b->flight_count++];
+                    (void)clock_sync_make_reply(request, t2, t2, f->reply);
+                    f->arrive_ms = at_server + leg_delay_ms(jitter_mean_ms);
+                }
+            }
+        }
+
+        if (step % eval_every != 0) {
+            continue;
+        }
+        minute_stats_t *ms = &stats[(uint32_t)((t - TEST_STEP_MS) / 60000.0)];
+        uint32_t server[TEST_BOARDS];
+        bool all_synced = true;
+        for (int i = 0; i < TEST_BOARDS; i++) {
+            board_t *b = &boards[i];
+            uint32_t tick = local_tick(b, t);
+            if (!clock_sync_to_server(&b->cs, tick, &server[i])) {
+                all_synced = false;
+                continue;
+            }
+            // 该节拍开始时刻的真实时间
+            double tick_start = t - (local_exact(b, t) - floor(local_exact(b, t))) / (1.0 + b->drift);
+            double error = (double)(int32_t)(server[i] - (uint32_t)(uint64_t)floor(tick_start)) -
+                           (tick_start - floor(tick_start));
+            ms->sum_sq += error * error;
+            ms->count++;
+            if (b->cs.stats.drift_valid) {
+                // 服务端时间 - 本地节拍随本地时间的斜率，正值表示本地偏慢
+                double true_ppb = -b->drift / (1.0 + b->drift) * 1e9;
+                double e = fabs(b->cs.stats.drift_ppb - true_ppb) / 1000.0;
+                ms->max_drift_error_ppm = (e > ms->max_drift_error_ppm) ? e : ms->max_drift_error_ppm;
+            } else {
+                ms->max_drift_error_ppm = INFINITY;
+            }
+        }
+        if (all_synced) {
+            for (int i = 0; i < TEST_BOARDS; i++) {
+                for (int j = i + 1; j < TEST_BOARDS; j++) {
+                    int32_t d = abs((int32_t)(server[i] - server[j]));
+                    ms->max_spread = (d > ms->max_spread) ? d : ms->max_spread;
+                }
+            }
+        }
+    }
+}
+
+// 迟到 (序号不匹配)、重复、版本或类型不对、长度不对的回复都被拒绝，不改变估计
+static bool check_protocol(void) {
+    clock_sync_t cs;
+    clock_sync_init(&cs, CLOCK_SYNC_INTERVAL_MS, CLOCK_SYNC_SAMPLES_PER_PERIOD);
+    clock_sync_start(&cs);
+    uint8_t first[CLOCK_SYNC_MSG_SIZE];
+    uint8_t second[CLOCK_SYNC_MSG_SIZE];
+    uint8_t reply[CLOCK_SYNC_MSG_SIZE];
+    bool ok = clock_sync_poll(&cs, 1000u, first) == CLOCK_SYNC_MSG_SIZE;
+    ok &= clock_sync_poll(&cs, 1000u + CLOCK_SYNC_INTERVAL_MS, second) == CLOCK_SYNC_MSG_SIZE;
+    // 第一个请求的回复在第二个请求发出后才到
+    ok &= clock_sync_make_reply(first, 50000u, 50000u, reply);
+    ok &= !clock_sync_on_reply(&cs, reply, sizeof(reply), 1000u + CLOCK_SYNC_INTERVAL_MS + 20u);
+    ok &= clock_sync_make_reply(second, 51000u, 51000u, reply);
+    uint8_t bad[CLOCK_SYNC_MSG_SIZE];
+    memcpy(bad, reply, sizeof(bad));
+    bad[0] = CLOCK_SYNC_VERSION + 1u;
+    ok &= !clock_sync_on_reply(&cs, bad, sizeof(bad), 2010u);
+    memcpy(bad, reply, sizeof(bad));
+    bad[1] = CLOCK_SYNC_MSG_REQUEST;
+    ok &= !clock_sync_on_reply(&cs, bad, sizeof(bad), 2010u);
+    ok &= !clock_sync_on_reply(&cs, reply, sizeof(reply) - 1u, 2010u);
+    ok &= !cs.stats.synced && cs.stats.replies == 0 && cs.stats.replies_rejected == 4u;
+    ok &= clock_sync_on_reply(&cs, reply, sizeof(reply), 2010u);
+    ok &= !clock_sync_on_reply(&cs, reply, sizeof(reply), 2011u);  // 重复
+    ok &= cs.stats.replies == 1u && cs.stats.replies_rejected == 5u;
+    // 服务端不回复非请求消息
+    ok &= !clock_sync_make_reply(reply, 0, 0, bad);
+    printf("late, duplicate and malformed replies rejected  %s\n", ok ? "ok" : "FAIL");
+    return ok;
+}
+
+int main(void) {
+    static const double jitters[] = { 10.0, 40.0 };
+    static const uint32_t report_minutes[] = { 2u, 5u, 10u };
+    bool ok = true;
+    printf("%d boards, drift -60..+40 ppm, delay %.0f ms + exponential jitter each way, %.0f%% queueing spikes of "
+           "%.0f-%.0f ms, %.0f%% replies lost; %u runs per jitter\n",
+           TEST_BOARDS, TEST_BASE_DELAY_MS, TEST_SPIKE_PROB * 100.0, TEST_SPIKE_MIN_MS, TEST_SPIKE_MAX_MS,
+           TEST_REPLY_LOSS * 100.0, (unsigned int)TEST_RUNS);
+    for (size_t j = 0; j < sizeof(jitters) / sizeof(jitters[0]); j++) {
+        static minute_stats_t stats[TEST_RUNS][TEST_MINUTES];
+        for (uint32_t run = 0; run < TEST_RUNS; run++) {
+            simulate(jitters[j], 1000u * (unsigned int)j + run + 1u, stats[run]);
+        }
+        for (size_t r = 0; r < sizeof(report_minutes) / sizeof(report_minutes[0]); r++) {
+            double rms_min = INFINITY;
+            double rms_max = 0;
+            int32_t spread = 0;
+            double drift_error = 0;
+            for (uint32_t run = 0; run < TEST_RUNS; run++) {
+                const minute_stats_t *ms = &stats[run][report_minutes[r] - 1u];
+                double rms = ms->count ? sqrt(ms->sum_sq / ms->count) : INFINITY;
+                rms_min = (rms < rms_min) ? rms : rms_min;
+                rms_max = (rms > rms_max) ? rms : rms_max;
+                spread = (ms->max_spread > spread) ? ms->max_spread : spread;
+                drift_error = (ms->max_drift_error_ppm > drift_error) ? ms->max_drift_error_ppm : drift_error;
+            }
+            bool gated = (j == 0) && report_minutes[r] == TEST_MINUTES;
+            bool pass = !gated || (rms_max <= TEST_MAX_RMS_MS && spread <= TEST_MAX_SPREAD_MS && drift_error <= TEST_MAX_DRIFT_PPM);
+            printf("jitter %2.0f ms, minute %2u: alignment %.2f-%.2f ms RMS, boards differ by at most %d ms, drift error ",
+                   jitters[j], (unsigned int)report_minutes[r], rms_min, rms_max, (int)spread);
+            if (isinf(drift_error)) {
+                printf("n/a (baseline < %u s)", (unsigned int)(CLOCK_SYNC_MIN_DRIFT_BASELINE_MS / 1000u));
+            } else {
+                printf("%.1f ppm", drift_error);
+            }
+            printf("%s\n", gated ? (pass ? "  ok" : "  FAIL") : "");
+            ok &= pass;
+        }
+    }
+    ok &= check_protocol();
+    printf("%s\n", ok ? "all checks passed" : "FAILED");
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,244 @@
+// fec.c 的主机检查：编码 -> 丢帧 -> fec_recover() 往返，以及随机和突发丢包下的残余丢帧率。
+// 往返：每个组大小 (FEC_MIN_GROUP_SIZE ~ FEC_MAX_GROUP_SIZE) 编码若干组长度不等的帧，逐个丢弃组内每一帧，
+// 恢复结果须与原帧逐字节相同；同组丢两帧、不丢帧、校验包损坏时须返回 0。
+// 另外检查上游丢弃的序号 (fec_encoder_close_before() 提前结束组、覆盖位图不含该帧) 和组大小只在组边界切换。
+// 丢包统计：随机丢包和 Gilbert-Elliott 突发丢包 (平均突发长度 TEST_BURST_LEN 帧) 下，FEC 之后仍丢失的帧比例，只报告。
+//
+// 构建 (主机，在仓库根目录)：
+//   cc -O2 -Isrc -o test_fec tools/host/test_fec.c src/fec.c -lm
+// 运行：
+//   ./test_fec                # 任一项超出门限时返回 1
+
+#include "fec.h"
+#include "byte_order.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define TEST_MAX_PAYLOAD        (640u)      // 20 ms 16 kHz 单声道 PCM
+#define TEST_MAX_PACKET         (FEC_HEADER_SIZE + TEST_MAX_PAYLOAD)
+#define TEST_GROUPS             (20u)       // 往返检查中每个组大小编码的组数
+#define TEST_LOSS_FRAMES        (200000u)   // 丢包统计的帧数
+#define TEST_BURST_LEN          (3.0)
+
+static uint8_t packets[FEC_MAX_GROUP_SIZE][TEST_MAX_PACKET];
+static size_t packet_lens[FEC_MAX_GROUP_SIZE];
+static uint8_t parity_buffer[FEC_PARITY_BUFFER_SIZE(TEST_MAX_PACKET)];
+static uint8_t parity[FEC_PARITY_BUFFER_SIZE(TEST_MAX_PACKET)];
+static size_t parity_len;
+static uint8_t recovered[TEST_MAX_PACKET + FEC_LENGTH_PREFIX_SIZE];
+static unsigned int seed = 1u;
+
+static double uniform(void) {
+    return (double)rand_r(&seed) / ((double)RAND_MAX + 1.0);
+}
+
+// 与 audio_frame_header_t 布局相同的帧头 + 随机负载
+static size_t make_packet(uint8_t *p, uint32_t sequence, size_t payload_len) {
+    p[0] = 1;
+    p[1] = 0;
+    p[2] = 1;
+    p[3] = 0;
+    put_le16(&p[4], 16000u);
+    put_le16(&p[6], (uint16_t)(payload_len / 2u));
+    put_le32(&p[8], sequence);
+    put_le32(&p[12], sequence * 20u);
+    for (size_t i = 0; i < payload_len; i++) {
+        p[FEC_HEADER_SIZE + i] = (uint8_t)rand_r(&seed);
+    }
+    return FEC_HEADER_SIZE + payload_len;
+}
+
+// 恢复组内第 lost 帧 (lost2 >= 0 时同时丢弃第 lost2 帧)，返回 fec_recover() 的结果
+static size_t recover_without(uint32_t group_size, int lost, int lost2) {
+    const uint8_t *view[FEC_MAX_GROUP_SIZE];
+    size_t lens[FEC_MAX_GROUP_SIZE];
+    for (uint32_t i = 0; i < group_size; i++) {
+        bool dropped = ((int)i == lost) || ((int)i == lost2) || packet_lens[i] == 0;
+        view[i] = dropped ? NULL : packets[i];
+        lens[i] = dropped ? 0 : packet_lens[i];
+    }
+    return fec_recover(parity, parity_len, view, lens, recovered, sizeof(recovered));
+}
+
+// 编码一组 (skip 为上游丢弃的组内位置，-1 表示无)，校验包存入 parity[]
+static bool encode_group(fec_encoder_t *enc, uint32_t base, uint32_t group_size, int skip) {
+    parity_len = 0;
+    for (uint32_t i = 0; i < group_size; i++) {
+        if ((int)i == skip) {
+            packet_lens[i] = 0;
+            continue;
+        }
+        size_t early = fec_encoder_close_before(enc, base + i);
+        if (early != 0) {
+            return false;               // 组内的帧不应结束当前组
+        }
+        // 长度覆盖 0 负载、奇数长度和最大帧
+        size_t payload = (i == 0) ? TEST_MAX_PAYLOAD : (size_t)(rand_r(&seed) % (TEST_MAX_PAYLOAD + 1u));
+        packet_lens[i] = make_packet(packets[i], base + i, payload);
+        size_t len = fec_encoder_add(enc, packets[i], packet_lens[i]);
+        if (len != 0) {
+            memcpy(parity, enc->buffer, len);
+            parity_len = len;
+        }
+    }
+    if (parity_len == 0) {
+        // 最后一帧被上游丢弃：由下一组的第一帧结束本组
+        parity_len = fec_encoder_close_before(enc, base + group_size);
+        memcpy(parity, enc->buffer, parity_len);
+    }
+    return parity_len != 0;
+}
+
+static bool check_round_trip(void) {
+    bool ok = true;
+    uint32_t recovered_count = 0;
+    uint32_t rejected_count = 0;
+    for (uint32_t n = FEC_MIN_GROUP_SIZE; n <= FEC_MAX_GROUP_SIZE; n++) {
+        fec_encoder_t enc;
+        fec_encoder_init(&enc, parity_buffer, sizeof(parity_buffer), n);
+        bool group_ok = true;
+        for (uint32_t g = 0; g < TEST_GROUPS; g++) {
+            uint32_t base = (g + 1u) * n;
+            // 每隔一组由上游丢弃一帧，依次覆盖组首、组中和组尾
+            int skip = (g % 2u == 1u) ? (int)((g / 2u) % n) : -1;
+            if (!encode_group(&enc, base, n, skip)) {
+                group_ok = false;
+                continue;
+            }
+            uint16_t mask = get_le16(&parity[4]);
+            uint16_t expected_mask = (uint16_t)(((1u << n) - 1u) & ~(skip >= 0 ? 1u << skip : 0u));
+            group_ok &= (mask == expected_mask) && get_le32(&parity[8]) == base && parity[2] == n;
+
+            for (uint32_t lost = 0; lost < n; lost++) {
+                size_t len = recover_without(n, (int)lost, -1);
+                if ((int)lost == skip) {
+                    group_ok &= (len == 0);         // 未参与校验的帧无从恢复
+                    continue;
+                }
+                bool same = (len == packet_lens[lost]) && memcmp(recovered, packets[lost], len) == 0;
+                group_ok &= same;
+                recovered_count += same;
+            }
+            // 两帧丢失、没有丢失
+            uint32_t a = (skip == 0) ? 1u : 0u;
+            uint32_t b = (n - 1u == (uint32_t)skip) ? n - 2u : n - 1u;
+            if (a != b) {
+                size_t len = recover_without(n, (int)a, (int)b);
+                group_ok &= (len == 0);
+                rejected_count += (len == 0);
+            }
+            group_ok &= (recover_without(n, -1, -1) == 0);
+        }
+        if (!group_ok) {
+            printf("group size %2u: round trip FAILED\n", (unsigned int)n);
+        }
+        ok &= group_ok;
+    }
+    printf("round trip, group sizes %u-%u: %u single losses recovered byte-exact, %u double losses rejected  %s\n",
+           (unsigned int)FEC_MIN_GROUP_SIZE, (unsigned int)FEC_MAX_GROUP_SIZE, (unsigned int)recovered_count,
+           (unsigned int)rejected_count, ok ? "ok" : "FAIL");
+    return ok;
+}
+
+// 损坏的校验包 (格式、标志、组大小、声明的长度超出实际) 须被拒绝
+static bool check_malformed(void) {
+    fec_encoder_t enc;
+    fec_encoder_init(&enc, parity_buffer, sizeof(parity_buffer), 4u);
+    bool ok = encode_group(&enc, 8u, 4u, -1) && recover_without(4u, 2, -1) != 0;
+    uint8_t saved[sizeof(parity)];
+    memcpy(saved, parity, parity_len);
+    static const struct { size_t offset; uint8_t value; } corrupt[] = {
+        { 3, 0 },                           // format
+        { 1, 0 },                           // flags 不含校验标志
+        { 2, FEC_MAX_GROUP_SIZE + 1u },     // 组大小
+        { 7, 0xFF },                        // num_samples 超出包长
+    };
+    for (size_t i = 0; i < sizeof(corrupt) / sizeof(corrupt[0]); i++) {
+        memcpy(parity, saved, parity_len);
+        parity[corrupt[i].offset] = corrupt[i].value;
+        ok &= (recover_without(4u, 2, -1) == 0);
+    }
+    memcpy(parity, saved, parity_len);
+    size_t full = parity_len;
+    parity_len = FEC_HEADER_SIZE - 1u;
+    ok &= (recover_without(4u, 2, -1) == 0);
+    parity_len = full;
+    printf("malformed parity packets rejected  %s\n", ok ? "ok" : "FAIL");
+    return ok;
+}
+
+// 组大小在组中途修改时，当前组按原大小结束；不受支持的大小被拒绝
+static bool check_group_size_change(void) {
+    fec_encoder_t enc;
+    fec_encoder_init(&enc, parity_buffer, sizeof(parity_buffer), 4u);
+    bool ok = !fec_encoder_set_group_size(&enc, 1u) && !fec_encoder_set_group_size(&enc, FEC_MAX_GROUP_SIZE + 1u);
+    size_t len = 0;
+    for (uint32_t seq = 0; seq < 4u; seq++) {
+        packet_lens[seq] = make_packet(packets[seq], seq, 64u);
+        if (seq == 1u) {
+            ok &= fec_encoder_set_group_size(&enc, 8u);
+        }
+        len = fec_encoder_add(&enc, packets[seq], packet_lens[seq]);
+    }
+    ok &= (len != 0) && enc.buffer[2] == 4u;
+    for (uint32_t seq = 8u; seq < 16u; seq++) {
+        uint8_t p[TEST_MAX_PACKET];
+        len = fec_encoder_add(&enc, p, make_packet(p, seq, 64u));
+    }
+    ok &= (len != 0) && enc.buffer[2] == 8u && get_le32(&enc.buffer[8]) == 8u;
+    ok &= fec_encoder_set_group_size(&enc, 0u);
+    uint8_t p[TEST_MAX_PACKET];
+    ok &= (fec_encoder_add(&enc, p, make_packet(p, 16u, 64u)) == 0) && enc.mask == 0;
+    printf("group size changes at group boundaries, 0 disables  %s\n", ok ? "ok" : "FAIL");
+    return ok;
+}
+
+// 丢包模型：burst 为 false 时独立丢包；否则为两状态马尔可夫链，坏状态全丢，平均停留 TEST_BURST_LEN 帧
+static void simulate_loss(uint32_t n, double loss, bool burst) {
+    static bool lost[TEST_LOSS_FRAMES];
+    bool bad = false;
+    double leave_bad = 1.0 / TEST_BURST_LEN;
+    double enter_bad = loss * leave_bad / (1.0 - loss);
+    uint32_t raw = 0;
+    for (uint32_t i = 0; i < TEST_LOSS_FRAMES; i++) {
+        if (burst) {
+            bad = bad ? (uniform() >= leave_bad) : (uniform() < enter_bad);
+            lost[i] = bad;
+        } else {
+            lost[i] = uniform() < loss;
+        }
+        raw += lost[i];
+    }
+    // 校验包与组内最后一帧经过同一信道，按下一帧的状态决定是否丢失
+    uint32_t residual = 0;
+    for (uint32_t base = 0; base + n < TEST_LOSS_FRAMES; base += n) {
+        uint32_t missing = 0;
+        for (uint32_t i = 0; i < n; i++) {
+            missing += lost[base + i];
+        }
+        bool parity_lost = burst ? lost[base + n - 1u] && uniform() >= leave_bad : uniform() < loss;
+        residual += (missing == 1u && !parity_lost) ? 0u : missing;
+    }
+    printf("  N = %2u  %-6s %4.1f%% loss: %5.2f%% before FEC, %5.2f%% after\n", (unsigned int)n, burst ? "burst" : "random",
+           loss * 100.0, raw * 100.0 / TEST_LOSS_FRAMES, residual * 100.0 / TEST_LOSS_FRAMES);
+}
+
+int main(void) {
+    bool ok = true;
+    ok &= check_round_trip();
+    ok &= check_malformed();
+    ok &= check_group_size_change();
+
+    printf("residual frame loss (parity shares the channel; burst mean length %.0f frames):\n", TEST_BURST_LEN);
+    static const uint32_t groups[] = { 4u, 8u };
+    static const double losses[] = { 0.01, 0.05, 0.10 };
+    for (size_t g = 0; g < sizeof(groups) / sizeof(groups[0]); g++) {
+        for (size_t l = 0; l < sizeof(losses) / sizeof(losses[0]); l++) {
+            simulate_loss(groups[g], losses[l], false);
+            simulate_loss(groups[g], losses[l], true);
+        }
+    }
+    printf("%s\n", ok ? "all checks passed" : "FAILED");
+    return ok ? 0 : 1;
+}
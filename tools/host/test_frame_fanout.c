@@ -0,0 +1,311 @@
+// frame_fanout.c 的主机检查：随机操作序列下的环不变量和引用计数平衡，以及几个确定的场景。
+// 帧是计数数组的下标，retain/release 回调增减计数 (减到负数即失败)。每一步之后检查：
+//   每帧的计数 = 环中持有该帧的 sink 数，环外的帧计数为 0；head - tail 不超过 depth；
+//   每个 sink 的 lag = 它在环中持有的格数，且不超过 max_lag；
+//   每个 sink 按推送顺序收到帧 (帧号严格递增)；加入以来推送的帧数 = delivered + dropped + lag。
+// 随机操作：推送、peek + consume、加入和移除 sink (深度、策略和积压上限随机)，最后移除全部 sink，所有计数须归零。
+// 确定场景：不消费的 DROP_OLDEST sink 留下最新的 max_lag 帧，DROP_NEWEST 留下最早的 max_lag 帧；
+// 及时消费的 sink 不受慢 sink 影响 (环满时只有慢 sink 被迫丢帧)。
+// 另外报告环结构的大小、三个 sink 时每帧分发加消费的耗时，以及一个 sink 以 1/4 速度消费时各 sink 的丢帧和积压
+// (深度 8、积压上限 4，与 AUDIO_FANOUT_DEPTH 的建议值相同)；后者要求及时消费的 sink 不丢帧、积压不超过 1 帧。
+//
+// 构建 (主机，在仓库根目录)：
+//   cc -O2 -Isrc -o test_frame_fanout tools/host/test_frame_fanout.c src/frame_fanout.c
+// 运行：
+//   ./test_frame_fanout       # 任一项超出门限时返回 1
+
+#include "frame_fanout.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define TEST_RUNS               (200u)
+#define TEST_OPS_PER_RUN        (5000u)
+#define TEST_MAX_FRAMES         (TEST_OPS_PER_RUN + 64u)
+#define TEST_TIMING_FRAMES      (10000000u)
+#define TEST_SLOW_FRAMES        (100000u)
+#define TEST_SLOW_DEPTH         (8u)
+#define TEST_SLOW_MAX_LAG       (4u)
+
+static int32_t refcount[TEST_MAX_FRAMES];
+static uint32_t frame_ids[TEST_MAX_FRAMES];
+static bool refcount_error;
+
+static void retain(void *frame) {
+    refcount[*(uint32_t *)frame]++;
+}
+
+static void release(void *frame) {
+    if (--refcount[*(uint32_t *)frame] < 0) {
+        refcount_error = true;
+    }
+}
+
+// 测试侧对每个 sink 的记录
+typedef struct {
+    uint32_t pushed;                // 加入以来推送的帧数
+    int64_t last_delivered;         // 最近消费的帧号
+} sink_model_t;
+
+static sink_model_t model[FRAME_FANOUT_MAX_SINKS];
+static uint32_t frames_pushed;
+static unsigned int seed;
+
+static uint32_t popcount8(uint8_t v) {
+    uint32_t n = 0;
+    for (; v != 0; v &= (uint8_t)(v - 1u)) {
+        n++;
+    }
+    return n;
+}
+
+static bool check_invariants(const frame_fanout_t *fo) {
+    if (refcount_error || fo->head - fo->tail > fo->depth) {
+        return false;
+    }
+    static int32_t expected[TEST_MAX_FRAMES];
+    memset(expected, 0, frames_pushed * sizeof(int32_t));
+    uint32_t held[FRAME_FANOUT_MAX_SINKS] = { 0 };
+    for (uint32_t seq = fo->tail; seq != fo->head; seq++) {
+        uint32_t slot = seq % fo->depth;
+        uint8_t holders = fo->holders[slot];
+        if (holders != 0) {
+            if (fo->frames[slot] == NULL) {
+                return false;
+            }
+            expected[*(uint32_t *)fo->frames[slot]] += (int32_t)popcount8(holders);
+        }
+        for (int i = 0; i < FRAME_FANOUT_MAX_SINKS; i++) {
+            if (holders & (1u << i)) {
+                if (!fo->sinks[i].active) {
+                    return false;
+                }
+                held[i]++;
+            }
+        }
+    }
+    for (uint32_t f = 0; f < frames_pushed; f++) {
+        if (refcount[f] != expected[f]) {
+            return false;
+        }
+    }
+    for (int i = 0; i < FRAME_FANOUT_MAX_SINKS; i++) {
+        const frame_fanout_sink_t *s = &fo->sinks[i];
+        if (!s->active) {
+            continue;
+        }
+        if (s->stats.lag != held[i] || s->stats.lag > s->max_lag ||
+            model[i].pushed != s->stats.delivered + s->stats.dropped + s->stats.lag) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static void push(frame_fanout_t *fo) {
+    uint32_t id = frames_pushed++;
+    frame_ids[id] = id;
+    for (int i = 0; i < FRAME_FANOUT_MAX_SINKS; i++) {
+        model[i].pushed += fo->sinks[i].active ? 1u : 0u;
+    }
+    (void)frame_fanout_push(fo, &frame_ids[id]);
+}
+
+// 返回 false 表示收到的帧顺序不对
+static bool consume(frame_fanout_t *fo, int sink) {
+    void *frame = frame_fanout_peek(fo, sink);
+    if (frame == NULL) {
+        return true;
+    }
+    uint32_t id = *(uint32_t *)frame;
+    bool in_order = (int64_t)id > model[sink].last_delivered;
+    model[sink].last_delivered = id;
+    frame_fanout_consume(fo, sink);
+    return in_order;
+}
+
+static int add_sink(frame_fanout_t *fo) {
+    frame_fanout_policy_t policy = (rand_r(&seed) % 2) ? FRAME_FANOUT_DROP_OLDEST : FRAME_FANOUT_DROP_NEWEST;
+    int sink = frame_fanout_add_sink(fo, policy, 1u + (uint32_t)rand_r(&seed) % fo->depth);
+    if (sink >= 0) {
+        model[sink].pushed = 0;
+        model[sink].last_delivered = -1;
+    }
+    return sink;
+}
+
+static bool random_run(uint32_t run, uint64_t *ops, uint32_t *forced_drops) {
+    frame_fanout_t fo;
+    seed = 1000u + run;
+    memset(refcount, 0, sizeof(refcount));
+    refcount_error = false;
+    frames_pushed = 0;
+    frame_fanout_init(&fo, 1u + (uint32_t)rand_r(&seed) % FRAME_FANOUT_MAX_DEPTH, retain, release);
+    for (int i = 0; i < 2; i++) {
+        (void)add_sink(&fo);
+    }
+    for (uint32_t op = 0; op < TEST_OPS_PER_RUN; op++) {
+        uint32_t r = (uint32_t)rand_r(&seed) % 100u;
+        int sink = rand_r(&seed) % FRAME_FANOUT_MAX_SINKS;
+        if (r < 50u) {
+            push(&fo);
+        } else if (r < 96u) {
+            // 不同 sink 的消费速度不同：编号越大越慢
+            if ((uint32_t)rand_r(&seed) % (uint32_t)(sink + 1) == 0 && fo.sinks[sink].active && !consume(&fo, sink)) {
+                printf("run %u: sink %d received frames out of order\n", (unsigned int)run, sink);
+                return false;
+            }
+        } else if (r < 98u) {
+            (void)add_sink(&fo);
+        } else {
+            frame_fanout_remove_sink(&fo, sink);
+        }
+        (*ops)++;
+        if (!check_invariants(&fo)) {
+            printf("run %u: invariant broken after op %u\n", (unsigned int)run, (unsigned int)op);
+            return false;
+        }
+    }
+    for (int i = 0; i < FRAME_FANOUT_MAX_SINKS; i++) {
+        if (fo.sinks[i].active) {
+            *forced_drops += fo.sinks[i].stats.dropped;
+        }
+        frame_fanout_remove_sink(&fo, i);
+    }
+    bool balanced = !refcount_error && fo.tail == fo.head;
+    for (uint32_t f = 0; f < frames_pushed; f++) {
+        balanced &= (refcount[f] == 0);
+    }
+    if (!balanced) {
+        printf("run %u: references left after removing all sinks\n", (unsigned int)run);
+    }
+    return balanced;
+}
+
+static bool check_policies(void) {
+    frame_fanout_t fo;
+    memset(refcount, 0, sizeof(refcount));
+    refcount_error = false;
+    frames_pushed = 0;
+    frame_fanout_init(&fo, FRAME_FANOUT_MAX_DEPTH, retain, release);
+    int oldest = frame_fanout_add_sink(&fo, FRAME_FANOUT_DROP_OLDEST, 3u);
+    int newest = frame_fanout_add_sink(&fo, FRAME_FANOUT_DROP_NEWEST, 3u);
+    int fast = frame_fanout_add_sink(&fo, FRAME_FANOUT_DROP_OLDEST, 1u);
+    memset(model, 0, sizeof(model));
+    for (int i = 0; i < FRAME_FANOUT_MAX_SINKS; i++) {
+        model[i].last_delivered = -1;
+    }
+    bool ok = oldest >= 0 && newest >= 0 && fast >= 0;
+    for (uint32_t i = 0; i < 10u; i++) {
+        push(&fo);
+        ok &= consume(&fo, fast) && check_invariants(&fo);
+    }
+    // DROP_OLDEST 留下 7, 8, 9；DROP_NEWEST 留下 0, 1, 2；及时消费的 sink 没有丢帧
+    static const uint32_t expect_oldest[] = { 7u, 8u, 9u };
+    static const uint32_t expect_newest[] = { 0u, 1u, 2u };
+    for (uint32_t i = 0; i < 3u; i++) {
+        void *a = frame_fanout_peek(&fo, oldest);
+        void *b = frame_fanout_peek(&fo, newest);
+        ok &= a != NULL && b != NULL && *(uint32_t *)a == expect_oldest[i] && *(uint32_t *)b == expect_newest[i];
+        frame_fanout_consume(&fo, oldest);
+        frame_fanout_consume(&fo, newest);
+    }
+    ok &= frame_fanout_peek(&fo, oldest) == NULL && frame_fanout_peek(&fo, newest) == NULL;
+    ok &= fo.sinks[fast].stats.dropped == 0 && fo.sinks[fast].stats.delivered == 10u;
+    ok &= fo.sinks[oldest].stats.dropped == 7u && fo.sinks[newest].stats.dropped == 7u;
+    printf("DROP_OLDEST keeps the newest frames, DROP_NEWEST the oldest  %s\n", ok ? "ok" : "FAIL");
+
+    // 积压上限等于深度的慢 sink 占满环：只有它被迫丢帧，及时消费的 sink 不受影响
+    frame_fanout_remove_sink(&fo, oldest);
+    frame_fanout_remove_sink(&fo, newest);
+    int slow = frame_fanout_add_sink(&fo, FRAME_FANOUT_DROP_NEWEST, fo.depth);
+    model[slow].pushed = 0;
+    model[slow].last_delivered = -1;
+    bool isolated = slow >= 0;
+    for (uint32_t i = 0; i < 3u * fo.depth; i++) {
+        push(&fo);
+        isolated &= consume(&fo, fast) && check_invariants(&fo);
+    }
+    isolated &= fo.sinks[fast].stats.dropped == 0 && fo.sinks[slow].stats.lag == fo.depth;
+    printf("a slow sink filling the ring does not cost the fast sink frames  %s\n", isolated ? "ok" : "FAIL");
+    return ok && isolated;
+}
+
+static void count_only(void *frame) {
+    (void)frame;
+}
+
+// 三个 sink，每帧推送后逐一消费
+static void report_timing(void) {
+    static uint32_t frame = 0;
+    frame_fanout_t fo;
+    frame_fanout_init(&fo, TEST_SLOW_DEPTH, count_only, count_only);
+    int sinks[3];
+    for (int i = 0; i < 3; i++) {
+        sinks[i] = frame_fanout_add_sink(&fo, FRAME_FANOUT_DROP_OLDEST, TEST_SLOW_MAX_LAG);
+    }
+    struct timespec t0;
+    struct timespec t1;
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+    for (uint32_t n = 0; n < TEST_TIMING_FRAMES; n++) {
+        (void)frame_fanout_push(&fo, &frame);
+        for (int i = 0; i < 3; i++) {
+            if (frame_fanout_peek(&fo, sinks[i]) != NULL) {
+                frame_fanout_consume(&fo, sinks[i]);
+            }
+        }
+    }
+    clock_gettime(CLOCK_MONOTONIC, &t1);
+    double ns = ((t1.tv_sec - t0.tv_sec) * 1e9 + (t1.tv_nsec - t0.tv_nsec)) / TEST_TIMING_FRAMES;
+    printf("ring struct %u bytes; push to 3 sinks + 3 consumes: %.0f ns per frame\n", (unsigned int)sizeof(frame_fanout_t), ns);
+}
+
+// sink 0 每 4 帧消费一次，sink 1 和 2 每帧消费
+static bool check_slow_sink(void) {
+    frame_fanout_t fo;
+    memset(refcount, 0, sizeof(refcount));
+    refcount_error = false;
+    frame_fanout_init(&fo, TEST_SLOW_DEPTH, retain, release);
+    int sinks[3];
+    for (int i = 0; i < 3; i++) {
+        sinks[i] = frame_fanout_add_sink(&fo, FRAME_FANOUT_DROP_OLDEST, TEST_SLOW_MAX_LAG);
+    }
+    frame_ids[0] = 0;
+    for (uint32_t n = 0; n < TEST_SLOW_FRAMES; n++) {
+        (void)frame_fanout_push(&fo, &frame_ids[0]);
+        for (int i = 0; i < 3; i++) {
+            if ((i != 0 || n % 4u == 3u) && frame_fanout_peek(&fo, sinks[i]) != NULL) {
+                frame_fanout_consume(&fo, sinks[i]);
+            }
+        }
+    }
+    frame_fanout_sink_stats_t st[3];
+    for (int i = 0; i < 3; i++) {
+        frame_fanout_get_sink_stats(&fo, sinks[i], &st[i]);
+    }
+    bool ok = !refcount_error && st[1].dropped == 0 && st[2].dropped == 0 && st[1].lag_max <= 1u && st[2].lag_max <= 1u &&
+              refcount[0] == (int32_t)(st[0].lag + st[1].lag + st[2].lag);
+    printf("sink 0 at 1/4 speed: dropped %.1f%%, lag max %u; sinks 1-2 dropped %u/%u, lag max %u/%u  %s\n",
+           st[0].dropped * 100.0 / TEST_SLOW_FRAMES, (unsigned int)st[0].lag_max, (unsigned int)st[1].dropped,
+           (unsigned int)st[2].dropped, (unsigned int)st[1].lag_max, (unsigned int)st[2].lag_max, ok ? "ok" : "FAIL");
+    return ok;
+}
+
+int main(void) {
+    bool ok = check_policies();
+    ok &= check_slow_sink();
+    uint64_t ops = 0;
+    uint32_t drops = 0;
+    bool random_ok = true;
+    for (uint32_t run = 0; run < TEST_RUNS && random_ok; run++) {
+        random_ok &= random_run(run, &ops, &drops);
+    }
+    printf("%u random runs, %llu operations (%u frames dropped by lag limits or a full ring): invariants held, "
+           "references balanced  %s\n", (unsigned int)TEST_RUNS, (unsigned long long)ops, (unsigned int)drops,
+           random_ok ? "ok" : "FAIL");
+    ok &= random_ok;
+    report_timing();
+    printf("%s\n", ok ? "all checks passed" : "FAILED");
+    return ok ? 0 : 1;
+}
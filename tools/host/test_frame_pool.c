@@ -0,0 +1,415 @@
+// frame_pool.c 的主机检查：挤出路径的队列顺序和引用计数，以及消费者停顿时三种过载策略的丢帧和延迟。
+// 用 tools/host/shim/ 中的单线程 FreeRTOS 替身编译，队列按值拷贝指针，调度器挂起只计数。
+// 确定场景：DROP_LOWEST_ENERGY 挤出能量最低 (相同时最旧) 的帧，其余帧按原顺序留在队列中，挤出期间对输出队列的
+// 所有收发都在调度器挂起期间完成，返回的帧引用计数为 1、能量为新帧的能量；新帧能量最低时返回 NULL 且队列不变；
+// DROP_OLDEST 挤出队头，DROP_NEWEST 不动队列；已被消费者取出 (持有引用) 的帧不会被挤出。
+// 随机操作：生产 (策略随机)、消费 (随机增加 0 ~ 2 个扇出引用)、释放一个引用。每一步之后检查：每帧恰好在空闲队列
+// (计数 0)、输出队列 (计数 1) 或消费者手中 (计数 = 持有数) 之一，输出队列中的序号递增，挂起和临界区嵌套归零；
+// 最后释放全部引用并取空队列，所有帧须回到空闲队列。
+// 停顿模拟：帧长 AUDIO_FRAME_DURATION_MS，池大小 AUDIO_FRAME_POOL_SIZE (与固件默认配置相同)。语音段和停顿交替，
+// 消费者每 TEST_STALL_PERIOD_S 秒停顿一次 (时长依次取 stall_seconds[])，停顿期间手里压着一帧，恢复后以两倍帧率追赶。
+// 对每种策略报告丢帧、语音帧丢失和出队延迟 (采集到离开 audio_queue)。
+// 门限：三种策略都不乱序、不重复、帧数守恒、结束时所有帧回到空闲队列；DROP_OLDEST 的出队延迟不超过池大小个帧长；
+// DROP_LOWEST_ENERGY 丢失的语音帧少于 DROP_OLDEST。
+//
+// 构建 (主机，在仓库根目录)：
+//   cc -O2 -Isrc -Itools/host/shim -o test_frame_pool tools/host/test_frame_pool.c src/frame_pool.c tools/host/shim/freertos_shim.c -lm
+// 运行：
+//   ./test_frame_pool         # 任一项超出门限时返回 1
+
+#include "frame_pool.h"
+#include "task.h"
+#include "app_config.h"
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define TEST_RUNS               (200u)
+#define TEST_OPS_PER_RUN        (5000u)
+#define TEST_RANDOM_POOL        (16u)
+#define TEST_MAX_HOLDERS        (3u)
+#define TEST_SIM_SECONDS        (600u)
+#define TEST_STALL_PERIOD_S     (30u)
+#define TEST_CATCH_UP_RATE      (2u)        // 恢复后每个帧周期最多出队的帧数
+#define TEST_SPEECH_ENERGY      (10000u)    // 能量不低于此值的帧计为语音帧
+#define TEST_MAX_FRAMES         (FRAME_POOL_MAX_FRAMES)
+
+static const uint32_t stall_seconds[] = { 1, 2, 4, 8 };
+
+// 帧内容只是序号和采集时刻，加上填充让帧长不是 2 的幂，检查按下标换算帧地址
+typedef struct {
+    uint32_t sequence;
+    uint32_t tick;
+    uint8_t padding[52];
+} test_frame_t;
+
+static test_frame_t frames[TEST_MAX_FRAMES];
+static frame_pool_t pool;
+static StaticQueue_t free_queue_struct;
+static StaticQueue_t out_queue_struct;
+static uint8_t free_queue_storage[TEST_MAX_FRAMES * sizeof(void *)];
+static uint8_t out_queue_storage[TEST_MAX_FRAMES * sizeof(void *)];
+static QueueHandle_t free_queue;
+static QueueHandle_t out_queue;
+
+static uint32_t holders[TEST_MAX_FRAMES];   // 消费者手中对每帧持有的引用数
+static unsigned int seed;
+
+static void setup(uint32_t count) {
+    memset(frames, 0, sizeof(frames));
+    memset(holders, 0, sizeof(holders));
+    memset(&pool, 0, sizeof(pool));
+    free_queue = xQueueCreateStatic(count, sizeof(void *), free_queue_storage, &free_queue_struct);
+    out_queue = xQueueCreateStatic(count, sizeof(void *), out_queue_storage, &out_queue_struct);
+    (void)frame_pool_init(&pool, frames, sizeof(test_frame_t), count, free_queue, out_queue);
+}
+
+static uint32_t index_of(const void *frame) {
+    return (uint32_t)((const test_frame_t *)frame - frames);
+}
+
+// 第 i 个排队项 (不出队)
+static void *queued(const StaticQueue_t *q, UBaseType_t i) {
+    void *frame;
+    memcpy(&frame, q->storage + ((q->head + i) % q->length) * q->item_size, sizeof(frame));
+    return frame;
+}
+
+// 生产一帧：成功时写入序号并送入输出队列
+static test_frame_t *produce(uint32_t sequence, uint32_t tick, uint32_t energy, frame_pool_policy_t policy,
+                             bool *evicted) {
+    test_frame_t *frame = frame_pool_acquire(&pool, energy, policy, evicted);
+    if (frame != NULL) {
+        frame->sequence = sequence;
+        frame->tick = tick;
+        xQueueSend(out_queue, &frame, 0);
+    }
+    return frame;
+}
+
+// 确定场景：按给定能量填满一个 count 帧的池 (全部在输出队列中)
+static void fill(const uint32_t *energies, uint32_t count) {
+    setup(count);
+    bool evicted;
+    for (uint32_t i = 0; i < count; i++) {
+        (void)produce(i, i, energies[i], FRAME_POOL_DROP_NEWEST, &evicted);
+    }
+}
+
+// 输出队列中的序号是否依次为 expected[]
+static bool queue_is(const uint32_t *expected, uint32_t count) {
+    if (uxQueueMessagesWaiting(out_queue) != count) {
+        return false;
+    }
+    for (uint32_t i = 0; i < count; i++) {
+        if (((test_frame_t *)queued(out_queue, i))->sequence != expected[i]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static bool check_eviction(void) {
+    bool ok = true;
+    bool evicted;
+    static const uint32_t energies[] = { 50, 30, 90, 10, 70, 40 };
+
+    // 能量最低的帧 (序号 3) 被挤出，其余按原顺序留下，重排在调度器挂起期间完成
+    fill(energies, 6);
+    uint32_t ops_before = out_queue_struct.ops_while_running;
+    test_frame_t *frame = frame_pool_acquire(&pool, 20, FRAME_POOL_DROP_LOWEST_ENERGY, &evicted);
+    static const uint32_t after_first[] = { 0, 1, 2, 4, 5 };
+    bool pass = frame == &frames[3] && evicted && queue_is(after_first, 5) && pool.refs[3] == 1 &&
+                pool.energy[3] == 20 && out_queue_struct.ops_while_running == ops_before &&
+                shim_suspend_depth == 0;
+    printf("lowest energy: evicts the quietest frame, keeps order, refs 1, drained only while suspended  %s\n",
+           pass ? "ok" : "FAIL");
+    ok &= pass;
+
+    // 新帧比队列中所有帧都安静：丢弃新帧，队列不变
+    frame->sequence = 6;
+    xQueueSend(out_queue, &frame, 0);
+    static const uint32_t after_second[] = { 0, 1, 2, 4, 5, 6 };
+    frame = frame_pool_acquire(&pool, 5, FRAME_POOL_DROP_LOWEST_ENERGY, &evicted);
+    pass = frame == NULL && !evicted && queue_is(after_second, 6) && shim_suspend_depth == 0;
+    printf("lowest energy: quietest new frame is dropped, queue unchanged  %s\n", pass ? "ok" : "FAIL");
+    ok &= pass;
+
+    // 能量相同时挤出最旧的
+    static const uint32_t ties[] = { 30, 10, 10, 20 };
+    fill(ties, 4);
+    frame = frame_pool_acquire(&pool, 15, FRAME_POOL_DROP_LOWEST_ENERGY, &evicted);
+    static const uint32_t after_tie[] = { 0, 2, 3 };
+    pass = frame == &frames[1] && queue_is(after_tie, 3);
+    printf("lowest energy: ties evict the oldest  %s\n", pass ? "ok" : "FAIL");
+    ok &= pass;
+
+    // DROP_OLDEST 挤出队头，DROP_NEWEST 不动队列
+    fill(energies, 6);
+    frame = frame_pool_acquire(&pool, 1000, FRAME_POOL_DROP_OLDEST, &evicted);
+    static const uint32_t after_oldest[] = { 1, 2, 3, 4, 5 };
+    pass = frame == &frames[0] && evicted && queue_is(after_oldest, 5) && pool.refs[0] == 1;
+    frame->sequence = 6;
+    xQueueSend(out_queue, &frame, 0);
+    static const uint32_t after_newest[] = { 1, 2, 3, 4, 5, 6 };
+    frame = frame_pool_acquire(&pool, 1000, FRAME_POOL_DROP_NEWEST, &evicted);
+    pass = pass && frame == NULL && !evicted && queue_is(after_newest, 6);
+    printf("drop oldest evicts the head, drop newest leaves the queue  %s\n", pass ? "ok" : "FAIL");
+    ok &= pass;
+
+    // 消费者持有的帧 (含扇出的额外引用) 不在输出队列中，不会被挤出；最后一个引用释放后才回到空闲队列
+    fill(energies, 6);
+    void *taken[6];
+    for (uint32_t i = 0; i < 6; i++) {
+        xQueueReceive(out_queue, &taken[i], 0);
+        frame_pool_retain(&pool, taken[i]);
+    }
+    pass = true;
+    for (int policy = FRAME_POOL_DROP_NEWEST; policy <= FRAME_POOL_DROP_LOWEST_ENERGY; policy++) {
+        pass &= frame_pool_acquire(&pool, 0xffffffffu, (frame_pool_policy_t)policy, &evicted) == NULL;
+    }
+    for (uint32_t i = 0; i < 6; i++) {
+        frame_pool_release(&pool, taken[i]);
+    }
+    pass &= uxQueueMessagesWaiting(free_queue) == 0;
+    for (uint32_t i = 0; i < 6; i++) {
+        frame_pool_release(&pool, taken[i]);
+    }
+    pass &= uxQueueMessagesWaiting(free_queue) == 6 && shim_critical_depth == 0;
+    printf("held frames are never evicted, return to the pool on the last release  %s\n", pass ? "ok" : "FAIL");
+    ok &= pass;
+    return ok;
+}
+
+// 每帧恰好在一处，计数与所在位置一致，输出队列中的序号递增
+static bool check_invariants(uint32_t count) {
+    uint32_t seen[TEST_MAX_FRAMES] = { 0 };
+    for (UBaseType_t i = 0; i < uxQueueMessagesWaiting(free_queue); i++) {
+        uint32_t index = index_of(queued(free_queue, i));
+        seen[index]++;
+        if (pool.refs[index] != 0 || holders[index] != 0) {
+            return false;
+        }
+    }
+    int64_t last = -1;
+    for (UBaseType_t i = 0; i < uxQueueMessagesWaiting(out_queue); i++) {
+        test_frame_t *frame = queued(out_queue, i);
+        uint32_t index = index_of(frame);
+        seen[index]++;
+        if (pool.refs[index] != 1 || holders[index] != 0 || (int64_t)frame->sequence <= last) {
+            return false;
+        }
+        last = frame->sequence;
+    }
+    for (uint32_t i = 0; i < count; i++) {
+        if (holders[i] != 0) {
+            seen[i]++;
+            if (pool.refs[i] != holders[i]) {
+                return false;
+            }
+        }
+        if (seen[i] != 1) {
+            return false;
+        }
+    }
+    return shim_suspend_depth == 0 && shim_critical_depth == 0;
+}
+
+static bool check_random(void) {
+    bool ok = true;
+    uint32_t steps = 0;
+    for (uint32_t run = 0; run < TEST_RUNS && ok; run++) {
+        seed = 1000u + run;
+        uint32_t count = 2u + (uint32_t)rand_r(&seed) % (TEST_RANDOM_POOL - 1u);
+        setup(count);
+        uint32_t sequence = 0;
+        for (uint32_t op = 0; op < TEST_OPS_PER_RUN && ok; op++, steps++) {
+            int action = rand_r(&seed) % 4;
+            if (action <= 1) {
+                bool evicted;
+                (void)produce(sequence++, op, (uint32_t)rand_r(&seed) % 100u, (frame_pool_policy_t)(rand_r(&seed) % 3),
+                              &evicted);
+            } else if (action == 2) {
+                void *frame;
+                if (xQueueReceive(out_queue, &frame, 0) == pdPASS) {
+                    uint32_t index = index_of(frame);
+                    holders[index] = 1;
+                    uint32_t extra = (uint32_t)rand_r(&seed) % TEST_MAX_HOLDERS;
+                    for (uint32_t i = 0; i < extra; i++) {
+                        frame_pool_retain(&pool, frame);
+                        holders[index]++;
+                    }
+                }
+            } else {
+                uint32_t index = (uint32_t)rand_r(&seed) % count;
+                if (holders[index] != 0) {
+                    holders[index]--;
+                    frame_pool_release(&pool, &frames[index]);
+                }
+            }
+            ok &= check_invariants(count);
+        }
+        for (uint32_t i = 0; i < count; i++) {
+            while (holders[i] != 0) {
+                holders[i]--;
+                frame_pool_release(&pool, &frames[i]);
+            }
+        }
+        void *frame;
+        while (xQueueReceive(out_queue, &frame, 0) == pdPASS) {
+            frame_pool_release(&pool, frame);
+        }
+        ok &= uxQueueMessagesWaiting(free_queue) == count && check_invariants(count);
+    }
+    printf("%u random operations: every frame in exactly one place, refs match holders, queue in order, "
+           "all frames back in the pool  %s\n", (unsigned int)steps, ok ? "ok" : "FAIL");
+    return ok;
+}
+
+typedef struct {
+    uint32_t produced;
+    uint32_t speech;
+    uint32_t delivered;
+    uint32_t lost;
+    uint32_t speech_lost;
+    uint32_t evicted;
+    uint32_t latency_max_ms;
+    double latency_p50_ms;
+    double latency_p99_ms;
+    bool order_ok;
+    bool pool_ok;
+} sim_result_t;
+
+#define SIM_TICKS  (TEST_SIM_SECONDS * 1000u / AUDIO_FRAME_DURATION_MS)
+
+static uint32_t sim_energy[SIM_TICKS];
+static uint32_t sim_latency[SIM_TICKS];
+static bool sim_delivered[SIM_TICKS];
+
+static int compare_u32(const void *a, const void *b) {
+    uint32_t x = *(const uint32_t *)a, y = *(const uint32_t *)b;
+    return (x > y) - (x < y);
+}
+
+// 语音段 0.4 ~ 3 s、停顿 0.3 ~ 2 s 交替；语音帧能量 1e4 ~ 1e7 (按对数均匀)，停顿是 100 ~ 1000 的底噪
+static void synthesize_energy(void) {
+    unsigned int s = 777u;
+    uint32_t tick = 0;
+    bool speaking = false;
+    while (tick < SIM_TICKS) {
+        double seconds = speaking ? 0.4 + 2.6 * rand_r(&s) / (double)RAND_MAX : 0.3 + 1.7 * rand_r(&s) / (double)RAND_MAX;
+        uint32_t end = tick + (uint32_t)(seconds * 1000.0 / AUDIO_FRAME_DURATION_MS) + 1u;
+        for (; tick < end && tick < SIM_TICKS; tick++) {
+            double u = rand_r(&s) / (double)RAND_MAX;
+            sim_energy[tick] = speaking ? (uint32_t)(TEST_SPEECH_ENERGY * pow(1000.0, u))
+                                        : 100u + (uint32_t)(900.0 * u);
+        }
+        speaking = !speaking;
+    }
+}
+
+static void simulate(frame_pool_policy_t policy, sim_result_t *r) {
+    memset(r, 0, sizeof(*r));
+    memset(sim_delivered, 0, sizeof(sim_delivered));
+    setup(AUDIO_FRAME_POOL_SIZE);
+    r->order_ok = true;
+    uint32_t period = TEST_STALL_PERIOD_S * 1000u / AUDIO_FRAME_DURATION_MS;
+    uint32_t stall_until = 0;
+    test_frame_t *in_hand = NULL;   // 停顿期间消费者正在发布的帧
+    int64_t last_sequence = -1;
+
+    for (uint32_t tick = 0; tick < SIM_TICKS + AUDIO_FRAME_POOL_SIZE; tick++) {
+        if (tick < SIM_TICKS) {
+            bool evicted;
+            r->produced++;
+            r->speech += sim_energy[tick] >= TEST_SPEECH_ENERGY;
+            (void)produce(tick, tick, sim_energy[tick], policy, &evicted);
+            r->evicted += evicted;
+        }
+
+        if (tick % period == period / 2u && tick < SIM_TICKS) {
+            uint32_t stall = stall_seconds[(tick / period) % (sizeof(stall_seconds) / sizeof(stall_seconds[0]))];
+            stall_until = tick + stall * 1000u / AUDIO_FRAME_DURATION_MS;
+            if (in_hand == NULL && xQueueReceive(out_queue, &in_hand, 0) == pdPASS) {
+                sim_latency[r->delivered++] = (tick - in_hand->tick) * AUDIO_FRAME_DURATION_MS;
+                r->order_ok &= (int64_t)in_hand->sequence > last_sequence && !sim_delivered[in_hand->sequence];
+                last_sequence = in_hand->sequence;
+                sim_delivered[in_hand->sequence] = true;
+            }
+        }
+        if (tick < stall_until) {
+            continue;
+        }
+        if (in_hand != NULL) {
+            frame_pool_release(&pool, in_hand);
+            in_hand = NULL;
+        }
+        for (uint32_t n = 0; n < TEST_CATCH_UP_RATE; n++) {
+            test_frame_t *frame;
+            if (xQueueReceive(out_queue, &frame, 0) != pdPASS) {
+                break;
+            }
+            sim_latency[r->delivered++] = (tick - frame->tick) * AUDIO_FRAME_DURATION_MS;
+            r->order_ok &= (int64_t)frame->sequence > last_sequence && !sim_delivered[frame->sequence];
+            last_sequence = frame->sequence;
+            sim_delivered[frame->sequence] = true;
+            frame_pool_release(&pool, frame);
+        }
+    }
+
+    for (uint32_t tick = 0; tick < SIM_TICKS; tick++) {
+        if (!sim_delivered[tick]) {
+            r->lost++;
+            r->speech_lost += sim_energy[tick] >= TEST_SPEECH_ENERGY;
+        }
+    }
+    r->pool_ok = r->delivered + r->lost == r->produced && uxQueueMessagesWaiting(out_queue) == 0 &&
+                 uxQueueMessagesWaiting(free_queue) == AUDIO_FRAME_POOL_SIZE && check_invariants(AUDIO_FRAME_POOL_SIZE);
+    qsort(sim_latency, r->delivered, sizeof(sim_latency[0]), compare_u32);
+    r->latency_p50_ms = sim_latency[r->delivered / 2u];
+    r->latency_p99_ms = sim_latency[r->delivered * 99u / 100u];
+    r->latency_max_ms = sim_latency[r->delivered - 1u];
+}
+
+static bool check_stalls(void) {
+    static const char *names[] = { "drop newest", "drop oldest", "lowest energy" };
+    sim_result_t results[3];
+    bool ok = true;
+    synthesize_energy();
+    printf("stalled consumer: %u s, %u ms frames, pool %u frames (%u ms), stalls of 1/2/4/8 s every %u s, "
+           "catch-up at %ux\n", (unsigned int)TEST_SIM_SECONDS, (unsigned int)AUDIO_FRAME_DURATION_MS,
+           (unsigned int)AUDIO_FRAME_POOL_SIZE, (unsigned int)(AUDIO_FRAME_POOL_SIZE * AUDIO_FRAME_DURATION_MS),
+           (unsigned int)TEST_STALL_PERIOD_S, (unsigned int)TEST_CATCH_UP_RATE);
+    for (int policy = FRAME_POOL_DROP_NEWEST; policy <= FRAME_POOL_DROP_LOWEST_ENERGY; policy++) {
+        sim_result_t *r = &results[policy];
+        simulate((frame_pool_policy_t)policy, r);
+        bool pass = r->order_ok && r->pool_ok;
+        printf("  %-13s lost %u/%u (%.2f%%), speech lost %u/%u (%.2f%%), evicted %u, "
+               "latency p50 %.0f / p99 %.0f / max %u ms  %s\n", names[policy], (unsigned int)r->lost,
+               (unsigned int)r->produced, 100.0 * r->lost / r->produced, (unsigned int)r->speech_lost,
+               (unsigned int)r->speech, 100.0 * r->speech_lost / r->speech, (unsigned int)r->evicted,
+               r->latency_p50_ms, r->latency_p99_ms, (unsigned int)r->latency_max_ms, pass ? "ok" : "FAIL");
+        ok &= pass;
+    }
+    uint32_t bound_ms = AUDIO_FRAME_POOL_SIZE * AUDIO_FRAME_DURATION_MS;
+    bool pass = results[FRAME_POOL_DROP_OLDEST].latency_max_ms <= bound_ms;
+    printf("drop oldest: latency max %u ms within the pool (%u ms)  %s\n",
+           (unsigned int)results[FRAME_POOL_DROP_OLDEST].latency_max_ms, (unsigned int)bound_ms, pass ? "ok" : "FAIL");
+    ok &= pass;
+    pass = results[FRAME_POOL_DROP_LOWEST_ENERGY].speech_lost < results[FRAME_POOL_DROP_OLDEST].speech_lost;
+    printf("lowest energy loses fewer speech frames than drop oldest (%u < %u)  %s\n",
+           (unsigned int)results[FRAME_POOL_DROP_LOWEST_ENERGY].speech_lost,
+           (unsigned int)results[FRAME_POOL_DROP_OLDEST].speech_lost, pass ? "ok" : "FAIL");
+    ok &= pass;
+    return ok;
+}
+
+int main(void) {
+    bool ok = true;
+    ok &= check_eviction();
+    ok &= check_random();
+    ok &= check_stalls();
+    printf("%s\n", ok ? "all checks passed" : "FAILED");
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,187 @@
+// heartbeat.c 的主机检查：离散事件模拟链路中断的判定时间和回显丢失造成的误判。
+// 链路模型：每个方向的时延为 TEST_BASE_RTT_MS / 2 + 指数分布抖动 (均值 TEST_JITTER_MEAN_MS)，
+// 心跳或回显以给定概率独立丢失 (按往返计)。中断发生后两个方向都不再有新的报文通过，已由服务端发出的回显仍会到达。
+// 网络任务每 TEST_SERVICE_MS 调用一次 service_heartbeat() 的等效流程：取最近到达的一个回显 (回调只暂存一个)、
+// heartbeat_check_dead()、heartbeat_poll()。
+// 判定时间 = 判定时刻 - 中断时刻，对 1/2/3 s 超时各模拟 TEST_TRIALS 次中断；
+// 误判 = 链路正常时的失效判定，对每个超时和丢失率模拟 TEST_FALSE_HOURS 小时 (判定后立即重新开始，相当于重连)。
+// 门限 (默认超时 MQTT_HEARTBEAT_TIMEOUT_MS)：最长判定时间不超过超时 + TEST_MAX_LATE_MS，回显丢失 TEST_MAX_CLEAN_LOSS 时没有误判；
+// 另外检查未收到回显前不判定、上一次连接的回显被忽略。
+//
+// 构建 (主机，在仓库根目录)：
+//   cc -O2 -Isrc -o test_heartbeat tools/host/test_heartbeat.c src/heartbeat.c -lm
+// 运行：
+//   ./test_heartbeat          # 任一项超出门限时返回 1
+
+#include "heartbeat.h"
+#include "app_config.h"
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define TEST_BASE_RTT_MS        (40.0)
+#define TEST_JITTER_MEAN_MS     (20.0)      // 每个方向
+#define TEST_SERVICE_MS         (20u)       // 网络任务处理心跳的间隔 (按 20 ms 帧节拍唤醒)
+#define TEST_TRIALS             (2000u)
+#define TEST_FALSE_HOURS        (24u)
+#define TEST_MAX_LATE_MS        (500u)
+#define TEST_MAX_CLEAN_LOSS     (0.10)      // 默认超时在此丢失率以下不应误判
+#define TEST_MAX_IN_FLIGHT      (64u)
+#define TEST_NEVER              (UINT32_MAX)
+
+typedef struct {
+    uint32_t arrival_ms;                    // 回显到达设备的时间，TEST_NEVER 表示丢失
+    uint8_t payload[HEARTBEAT_PAYLOAD_SIZE];
+} in_flight_t;
+
+typedef struct {
+    heartbeat_t hb;
+    in_flight_t flight[TEST_MAX_IN_FLIGHT];
+    uint32_t flight_count;
+    uint32_t now_ms;
+    uint32_t fail_ms;                       // 中断时刻，TEST_NEVER 表示链路正常
+    double loss;
+} link_sim_t;
+
+static unsigned int seed = 4242u;
+
+static double uniform(void) {
+    return ((double)rand_r(&seed) + 1.0) / ((double)RAND_MAX + 2.0);
+}
+
+static double leg_delay_ms(void) {
+    return TEST_BASE_RTT_MS / 2.0 - TEST_JITTER_MEAN_MS * log(uniform());
+}
+
+static void sim_start(link_sim_t *sim, uint32_t timeout_ms, double loss) {
+    memset(sim, 0, sizeof(*sim));
+    heartbeat_init(&sim->hb, MQTT_HEARTBEAT_INTERVAL_MS, timeout_ms);
+    heartbeat_start(&sim->hb, 0);
+    sim->fail_ms = TEST_NEVER;
+    sim->loss = loss;
+}
+
+// 推进一个处理间隔，返回本次是否判定链路失效
+static bool sim_service(link_sim_t *sim) {
+    sim->now_ms += TEST_SERVICE_MS;
+    in_flight_t echo;
+    bool have_echo = false;
+    uint32_t kept = 0;
+    for (uint32_t i = 0; i < sim->flight_count; i++) {
+        in_flight_t f = sim->flight[i];
+        if (f.arrival_ms == TEST_NEVER) {
+            continue;
+        }
+        if (f.arrival_ms <= sim->now_ms) {
+            if (!have_echo || f.arrival_ms >= echo.arrival_ms) {
+                echo = f;
+                have_echo = true;
+            }
+            continue;
+        }
+        sim->flight[kept++] = f;
+    }
+    sim->flight_count = kept;
+    if (have_echo) {
+        heartbeat_on_echo(&sim->hb, echo.payload, sizeof(echo.payload), echo.arrival_ms);
+    }
+
+    if (heartbeat_check_dead(&sim->hb, sim->now_ms)) {
+        return true;
+    }
+
+    uint8_t ping[HEARTBEAT_PAYLOAD_SIZE];
+    if (heartbeat_poll(&sim->hb, sim->now_ms, ping) > 0 && sim->flight_count < TEST_MAX_IN_FLIGHT) {
+        in_flight_t *f = &sim->flight[sim->flight_count++];
+        memcpy(f->payload, ping, sizeof(ping));
+        double at_server = sim->now_ms + leg_delay_ms();
+        bool lost = uniform() < sim->loss || sim->now_ms >= sim->fail_ms || at_server >= sim->fail_ms;
+        f->arrival_ms = lost ? TEST_NEVER : (uint32_t)(at_server + leg_delay_ms());
+    }
+    return false;
+}
+
+// 链路中断：返回 (平均, 最长) 判定时间
+static void detection(uint32_t timeout_ms, double *mean_ms, uint32_t *max_ms) {
+    link_sim_t sim;
+    double sum = 0.0;
+    *max_ms = 0;
+    for (uint32_t t = 0; t < TEST_TRIALS; t++) {
+        sim_start(&sim, timeout_ms, 0.0);
+        sim.fail_ms = 5000u + (uint32_t)(uniform() * 5000.0);
+        while (!sim_service(&sim)) {
+        }
+        uint32_t detect = sim.now_ms - sim.fail_ms;
+        sum += detect;
+        *max_ms = (detect > *max_ms) ? detect : *max_ms;
+    }
+    *mean_ms = sum / TEST_TRIALS;
+}
+
+// 链路正常、回显按 loss 丢失：返回 TEST_FALSE_HOURS 小时内的误判次数
+static uint32_t false_positives(uint32_t timeout_ms, double loss) {
+    link_sim_t sim;
+    sim_start(&sim, timeout_ms, loss);
+    uint32_t events = 0;
+    const uint32_t steps = TEST_FALSE_HOURS * 3600000u / TEST_SERVICE_MS;
+    for (uint32_t i = 0; i < steps; i++) {
+        if (sim_service(&sim)) {
+            events++;
+            heartbeat_start(&sim.hb, sim.now_ms);   // 重连
+            sim.flight_count = 0;
+        }
+    }
+    return events;
+}
+
+// 协议行为：未收到回显前不判定；上一次连接的迟到回显被忽略
+static bool check_protocol(void) {
+    heartbeat_t hb;
+    uint8_t ping[HEARTBEAT_PAYLOAD_SIZE];
+    heartbeat_init(&hb, MQTT_HEARTBEAT_INTERVAL_MS, HEARTBEAT_MIN_TIMEOUT_MS);
+    heartbeat_start(&hb, 0);
+    bool ok = heartbeat_poll(&hb, 0, ping) == HEARTBEAT_PAYLOAD_SIZE;
+    ok &= !heartbeat_check_dead(&hb, 60000u);           // 服务端没有回显
+    heartbeat_on_echo(&hb, ping, sizeof(ping), 60040u);
+    ok &= hb.armed && hb.stats.rtt_last_ms == 60040u;
+    ok &= !heartbeat_check_dead(&hb, 60040u + HEARTBEAT_MIN_TIMEOUT_MS - 1u);
+    ok &= heartbeat_check_dead(&hb, 60040u + HEARTBEAT_MIN_TIMEOUT_MS);
+    ok &= !heartbeat_check_dead(&hb, 70000u);           // 每次连接只判定一次
+
+    heartbeat_start(&hb, 70000u);
+    heartbeat_on_echo(&hb, ping, sizeof(ping), 70010u); // 上一次连接的心跳
+    ok &= !hb.armed && hb.stats.stale_echoes == 1u;
+    ok &= !heartbeat_set_timeout(&hb, HEARTBEAT_MAX_TIMEOUT_MS + 1u) && hb.timeout_ms == HEARTBEAT_MIN_TIMEOUT_MS;
+    printf("no detection before the first echo, stale echoes ignored  %s\n", ok ? "ok" : "FAIL");
+    return ok;
+}
+
+int main(void) {
+    bool ok = check_protocol();
+    static const uint32_t timeouts[] = { 1000u, 2000u, 3000u };
+    static const double losses[] = { 0.05, 0.10, 0.20 };
+    printf("%u ms pings, RTT %.0f ms + exponential jitter (mean %.0f ms per direction), serviced every %u ms\n",
+           (unsigned int)MQTT_HEARTBEAT_INTERVAL_MS, TEST_BASE_RTT_MS, TEST_JITTER_MEAN_MS, (unsigned int)TEST_SERVICE_MS);
+    for (size_t t = 0; t < sizeof(timeouts) / sizeof(timeouts[0]); t++) {
+        double mean_ms;
+        uint32_t max_ms;
+        detection(timeouts[t], &mean_ms, &max_ms);
+        bool is_default = (timeouts[t] == MQTT_HEARTBEAT_TIMEOUT_MS);
+        bool pass = !is_default || max_ms <= timeouts[t] + TEST_MAX_LATE_MS;
+        printf("timeout %u ms: detection mean %.0f ms, max %u ms; false positives in %u h at",
+               (unsigned int)timeouts[t], mean_ms, (unsigned int)max_ms, (unsigned int)TEST_FALSE_HOURS);
+        for (size_t l = 0; l < sizeof(losses) / sizeof(losses[0]); l++) {
+            uint32_t events = false_positives(timeouts[t], losses[l]);
+            if (is_default && losses[l] <= TEST_MAX_CLEAN_LOSS + 1e-9) {
+                pass &= (events == 0);
+            }
+            printf(" %.0f%% loss: %u%s", losses[l] * 100.0, (unsigned int)events,
+                   (l + 1 < sizeof(losses) / sizeof(losses[0])) ? "," : "");
+        }
+        printf("%s%s\n", is_default ? "  (default)  " : "  ", is_default ? (pass ? "ok" : "FAIL") : "");
+        ok &= pass;
+    }
+    printf("%s\n", ok ? "all checks passed" : "FAILED");
+    return ok ? 0 : 1;
+}
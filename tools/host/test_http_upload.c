@@ -0,0 +1,513 @@
+// http_upload.c 的主机检查：上传引擎经 coreHTTP 替身 (tools/host/shim/core_http_shim.c) 和回环 TCP 连到本程序中的
+// 可续传上传服务端 (线程)，服务端逐字节核对负载，按脚本在负载中途断开、只确认一半或每个响应后关闭连接。
+//
+// 检查：
+//   整段上传     一小时 16 kHz 单声道录音 (115.2 MB) 在一条 keep-alive 连接上上传，只查询一次进度，
+//                段数 = 总长 / HTTP_UPLOAD_SEGMENT_SIZE，服务端收到的内容与源逐字节相同
+//   断线续传     每 TEST_DROP_EVERY 段在负载中途断开 (已收到的部分计入进度)、每 TEST_SHORT_EVERY 段只确认一半：
+//                上传完成，重连次数等于断开次数，续传字节等于断开时已确认的字节，已确认的字节不重发
+//   服务端不保持连接  每个响应带 Connection: close：每个请求一条连接，进度已知，不再查询
+//   取消后重新提交    同一 meeting_id 从服务端已收到的位置继续，不重发已确认的字节
+//   读取失败     放弃上传并返回错误，不再占用网络任务
+//   退避         服务端不可达时重连间隔为 1、2、4 … s，上限 HTTP_UPLOAD_RETRY_MAX_MS；恢复后完成上传
+// 吞吐：回环上的整段上传速率，以及服务端在每个响应前等待 test_rtt_ms[] (模拟往返) 时的速率。
+// 每段一个请求、等响应后才发下一段，速率上限为 段长 / 往返；门限为该上限的 TEST_MIN_RTT_EFFICIENCY_PCT%。
+//
+// 构建 (主机，在仓库根目录)：
+//   cc -O2 -pthread -DHTTP_UPLOAD_ENABLE=1 -DHTTP_UPLOAD_HOST='"127.0.0.1"' -Isrc -Itools/host/shim -o test_http_upload tools/host/test_http_upload.c src/http_upload.c tools/host/shim/core_http_shim.c tools/host/shim/secure_sockets_shim.c tools/host/shim/freertos_shim.c
+// 运行：
+//   ./test_http_upload        # 任一项超出门限时返回 1
+
+#include "http_upload.h"
+#include "cy_secure_sockets.h"
+#include "FreeRTOS.h"
+#include "task.h"
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <time.h>
+#include <unistd.h>
+
+#if (HTTP_UPLOAD_ENABLE != 1)
+#error "build with -DHTTP_UPLOAD_ENABLE=1"
+#endif
+
+#define TEST_HOUR_BYTES             (16000u * 2u * 3600u)   // 一小时 16 kHz 单声道 16 位 PCM
+#define TEST_SMALL_BYTES            (1024u * 1024u + 1000u) // 最后一段不满
+#define TEST_DROP_EVERY             (7u)
+#define TEST_SHORT_EVERY            (5u)
+#define TEST_STEP_MS                (100u)                  // 手动节拍时每次 step 推进的时间
+#define TEST_MAX_STEPS              (1000000u)
+#define TEST_MIN_LOOPBACK_MBPS      (50u)                   // 回环整段上传的最低速率 (Mbit/s)
+#define TEST_MIN_RTT_EFFICIENCY_PCT (80u)
+#define TEST_SERVER_BUFFER          (HTTP_UPLOAD_SEGMENT_SIZE + 1024u)
+
+static const uint32_t test_rtt_ms[] = { 5u, 20u };
+
+// --- 可续传上传服务端 ---
+
+typedef struct {
+    uint32_t rtt_ms;                // 每个响应前等待
+    uint32_t drop_every;            // 每 N 个上传段在负载中途断开，0 为不断开
+    uint32_t short_every;           // 每 N 个上传段只确认一半，0 为全部确认
+    bool close_every_response;      // 每个响应带 Connection: close 并关闭
+} server_script_t;
+
+typedef struct {
+    uint32_t connections;
+    uint32_t requests;
+    uint32_t queries;               // bytes */总长 的查询
+    uint32_t segments;              // 带负载的 PUT (含中途断开的)
+    uint32_t drops;
+    uint32_t completed;             // 回复 201 的次数
+    uint32_t errors;                // 内容不符、Content-Range 不合法或跳过了未确认的字节
+    uint64_t overlap_bytes;         // 已确认又重发的字节
+    uint64_t dropped_committed;     // 中途断开时确认的字节
+    char meeting[HTTP_UPLOAD_MAX_ID_LEN + 16];
+    uint32_t total;
+    uint32_t committed;
+} server_state_t;
+
+static pthread_mutex_t server_lock = PTHREAD_MUTEX_INITIALIZER;
+static server_script_t script;
+static server_state_t server;
+static int listen_fd = -1;
+static uint16_t server_port;
+
+static uint8_t pattern(uint32_t offset) {
+    return (uint8_t)(offset ^ (offset >> 8) ^ ((offset >> 16) * 7u));
+}
+
+static bool matches_pattern(const uint8_t *data, uint32_t offset, uint32_t len) {
+    for (uint32_t i = 0; i < len; i++) {
+        if (data[i] != pattern(offset + i)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// 每个场景从一条新连接开始
+static void server_reset(const server_script_t *new_script) {
+    http_upload_close();
+    pthread_mutex_lock(&server_lock);
+    script = *new_script;
+    server = (server_state_t){ 0 };
+    pthread_mutex_unlock(&server_lock);
+}
+
+static server_state_t server_snapshot(void) {
+    pthread_mutex_lock(&server_lock);
+    server_state_t s = server;
+    pthread_mutex_unlock(&server_lock);
+    return s;
+}
+
+// 从 buf 中已有的 have 字节开始读到头部结束，返回头部长度 (含空行)，连接关闭时返回 0
+static size_t read_headers(int fd, char *buf, size_t capacity, size_t *have) {
+    for (;;) {
+        buf[*have] = '\0';
+        char *end = strstr(buf, "\r\n\r\n");
+        if (end != NULL) {
+            return (size_t)(end + 4 - buf);
+        }
+        if (*have + 1u >= capacity) {
+            return 0;
+        }
+        ssize_t n = recv(fd, buf + *have, capacity - 1u - *have, 0);
+        if (n <= 0) {
+            return 0;
+        }
+        *have += (size_t)n;
+    }
+}
+
+static const char *header_value(const char *headers, const char *field) {
+    size_t len = strlen(field);
+    for (const char *p = strstr(headers, "\r\n"); p != NULL; p = strstr(p + 2, "\r\n")) {
+        if (strncasecmp(p + 2, field, len) == 0 && p[2 + len] == ':') {
+            return p + 3 + len + strspn(p + 3 + len, " ");
+        }
+    }
+    return NULL;
+}
+
+static void respond(int fd, uint32_t committed, uint32_t total, bool close_connection) {
+    char response[256];
+    int n;
+    if (committed >= total) {
+        n = snprintf(response, sizeof(response), "HTTP/1.1 201 Created\r\nContent-Length: 0\r\n%s\r\n",
+                     close_connection ? "Connection: close\r\n" : "");
+    } else if (committed == 0) {
+        n = snprintf(response, sizeof(response), "HTTP/1.1 308 Resume Incomplete\r\nContent-Length: 0\r\n%s\r\n",
+                     close_connection ? "Connection: close\r\n" : "");
+    } else {
+        n = snprintf(response, sizeof(response), "HTTP/1.1 308 Resume Incomplete\r\nRange: bytes=0-%lu\r\nContent-Length: 0\r\n%s\r\n",
+                     (unsigned long)(committed - 1u), close_connection ? "Connection: close\r\n" : "");
+    }
+    if (script.rtt_ms > 0) {
+        usleep(script.rtt_ms * 1000u);
+    }
+    (void)send(fd, response, (size_t)n, MSG_NOSIGNAL);
+}
+
+// 处理一个请求，返回是否保持连接
+static bool serve_request(int fd, char *buf, size_t *have) {
+    size_t header_len = read_headers(fd, buf, TEST_SERVER_BUFFER, have);
+    if (header_len == 0) {
+        return false;
+    }
+    char path[128] = "";
+    sscanf(buf, "PUT %127s HTTP/1.1", path);
+    const char *range = header_value(buf, "Content-Range");
+    const char *length_value = header_value(buf, "Content-Length");
+    uint32_t body_len = (length_value != NULL) ? (uint32_t)strtoul(length_value, NULL, 10) : 0u;
+    unsigned long first = 0, last = 0, total = 0;
+    bool query = (range != NULL) && sscanf(range, "bytes */%lu", &total) == 1;
+    bool upload = !query && (range != NULL) && sscanf(range, "bytes %lu-%lu/%lu", &first, &last, &total) == 3;
+
+    pthread_mutex_lock(&server_lock);
+    server.requests++;
+    const char *id = strrchr(path, '/');
+    if (id == NULL || strcmp(id + 1, server.meeting) != 0 || server.total != total) {
+        // 新的会议：从头开始
+        snprintf(server.meeting, sizeof(server.meeting), "%s", (id != NULL) ? id + 1 : "");
+        server.total = (uint32_t)total;
+        server.committed = 0;
+    }
+    bool valid = (query && body_len == 0) || (upload && last >= first && last - first + 1u == body_len && last < total);
+    if (!valid || (upload && first > server.committed) || body_len > HTTP_UPLOAD_SEGMENT_SIZE) {
+        server.errors++;
+        pthread_mutex_unlock(&server_lock);
+        return false;
+    }
+    uint32_t segment_index = upload ? ++server.segments : 0;
+    if (query) {
+        server.queries++;
+    }
+    bool drop = upload && script.drop_every != 0 && segment_index % script.drop_every == 0;
+    bool half = upload && script.short_every != 0 && segment_index % script.short_every == 0;
+    bool close_connection = script.close_every_response || drop;
+    pthread_mutex_unlock(&server_lock);
+
+    // 负载：头部之后已读到的部分加上剩余部分；中途断开时只读一半
+    uint32_t wanted = drop ? body_len / 2u : body_len;
+    size_t body_have = *have - header_len;
+    memmove(buf, buf + header_len, body_have);
+    while (body_have < wanted) {
+        ssize_t n = recv(fd, buf + body_have, TEST_SERVER_BUFFER - body_have, 0);
+        if (n <= 0) {
+            return false;
+        }
+        body_have += (size_t)n;
+    }
+    *have = body_have - ((body_have > body_len) ? body_len : body_have);
+    uint32_t accepted = half ? wanted / 2u : wanted;
+
+    pthread_mutex_lock(&server_lock);
+    if (!matches_pattern((const uint8_t *)buf, (uint32_t)first, wanted)) {
+        server.errors++;
+    }
+    if (upload && first < server.committed) {
+        uint32_t overlap = server.committed - (uint32_t)first;
+        server.overlap_bytes += (overlap < accepted) ? overlap : accepted;
+    }
+    if (upload && first + accepted > server.committed) {
+        if (drop) {
+            server.dropped_committed += first + accepted - server.committed;
+        }
+        server.committed = (uint32_t)first + accepted;
+    }
+    uint32_t committed = server.committed;
+    if (!drop) {
+        server.completed += (committed >= server.total);
+    } else {
+        server.drops++;
+    }
+    pthread_mutex_unlock(&server_lock);
+
+    if (drop) {
+        return false;
+    }
+    memmove(buf, buf + body_len, *have);
+    respond(fd, committed, (uint32_t)total, close_connection);
+    return !close_connection;
+}
+
+static void *server_thread(void *arg) {
+    (void)arg;
+    static char buf[TEST_SERVER_BUFFER];
+    for (;;) {
+        int fd = accept(listen_fd, NULL, NULL);
+        if (fd < 0) {
+            continue;
+        }
+        pthread_mutex_lock(&server_lock);
+        server.connections++;
+        pthread_mutex_unlock(&server_lock);
+        size_t have = 0;
+        while (serve_request(fd, buf, &have)) {
+        }
+        close(fd);
+    }
+    return NULL;
+}
+
+static bool start_server(void) {
+    listen_fd = socket(AF_INET, SOCK_STREAM, 0);
+    int one = 1;
+    setsockopt(listen_fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+    struct sockaddr_in sa = { .sin_family = AF_INET, .sin_addr.s_addr = htonl(INADDR_LOOPBACK) };
+    socklen_t sa_len = sizeof(sa);
+    if (listen_fd < 0 || bind(listen_fd, (struct sockaddr *)&sa, sizeof(sa)) != 0 || listen(listen_fd, 4) != 0 ||
+        getsockname(listen_fd, (struct sockaddr *)&sa, &sa_len) != 0) {
+        return false;
+    }
+    server_port = ntohs(sa.sin_port);
+    shim_socket_port_override = server_port;
+    pthread_t thread;
+    return pthread_create(&thread, NULL, server_thread, NULL) == 0;
+}
+
+// --- 上传端 ---
+
+typedef struct {
+    uint32_t fail_at;               // 读取到此偏移时失败，UINT32_MAX 为不失败
+} source_context_t;
+
+static bool read_recording(void *context, uint32_t offset, uint8_t *buffer, size_t len) {
+    const source_context_t *c = context;
+    if (offset + len > c->fail_at) {
+        return false;
+    }
+    for (size_t i = 0; i < len; i++) {
+        buffer[i] = pattern(offset + (uint32_t)i);
+    }
+    return true;
+}
+
+static source_context_t reader = { .fail_at = UINT32_MAX };
+
+static http_upload_source_t make_source(const char *id, uint32_t total) {
+    http_upload_source_t s = { .total_len = total, .read = read_recording, .context = &reader };
+    snprintf(s.meeting_id, sizeof(s.meeting_id), "%s", id);
+    return s;
+}
+
+// 推进上传直到结束 (或 stop_offset 之后)，手动节拍时每次 step 推进 TEST_STEP_MS
+static bool drive(uint32_t stop_offset) {
+    for (uint32_t i = 0; i < TEST_MAX_STEPS && http_upload_is_busy(); i++) {
+        (void)http_upload_step();
+        if (shim_manual_ticks) {
+            shim_tick_count += TEST_STEP_MS;
+        }
+        http_upload_stats_t st;
+        http_upload_get_stats(&st);
+        if (st.current_offset >= stop_offset && http_upload_is_busy()) {
+            return true;
+        }
+    }
+    return !http_upload_is_busy();
+}
+
+static double now_s(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+static http_upload_stats_t stats_delta(const http_upload_stats_t *before) {
+    http_upload_stats_t after;
+    http_upload_get_stats(&after);
+    after.uploads_completed -= before->uploads_completed;
+    after.bytes_sent -= before->bytes_sent;
+    after.segments_sent -= before->segments_sent;
+    after.connections -= before->connections;
+    after.retries -= before->retries;
+    after.resumed_bytes -= before->resumed_bytes;
+    return after;
+}
+
+static uint32_t segments_for(uint32_t bytes) {
+    return (bytes + HTTP_UPLOAD_SEGMENT_SIZE - 1u) / HTTP_UPLOAD_SEGMENT_SIZE;
+}
+
+static bool check_full_upload(void) {
+    server_reset(&(server_script_t){ 0 });
+    http_upload_stats_t before;
+    http_upload_get_stats(&before);
+    http_upload_source_t s = make_source("hour", TEST_HOUR_BYTES);
+    double start = now_s();
+    bool ok = http_upload_start(&s) && drive(UINT32_MAX);
+    double elapsed = now_s() - start;
+    http_upload_stats_t d = stats_delta(&before);
+    server_state_t sv = server_snapshot();
+    uint32_t segments = segments_for(TEST_HOUR_BYTES);
+    double mbps = TEST_HOUR_BYTES * 8.0 / elapsed / 1e6;
+    ok &= d.uploads_completed == 1u && d.connections == 1u && d.segments_sent == segments && d.bytes_sent == TEST_HOUR_BYTES &&
+          d.retries == 0;
+    ok &= sv.connections == 1u && sv.queries == 1u && sv.segments == segments && sv.completed == 1u && sv.errors == 0 &&
+          sv.committed == TEST_HOUR_BYTES && sv.overlap_bytes == 0;
+    ok &= mbps >= TEST_MIN_LOOPBACK_MBPS;
+    printf("one hour (%u bytes): %u segments on %u connection, %u query, %.2f s, %.0f Mbit/s, %.1f us per segment  %s\n",
+           (unsigned int)TEST_HOUR_BYTES, (unsigned int)sv.segments, (unsigned int)sv.connections, (unsigned int)sv.queries,
+           elapsed, mbps, elapsed * 1e6 / segments, ok ? "ok" : "FAIL");
+    return ok;
+}
+
+static bool check_drops(void) {
+    server_reset(&(server_script_t){ .drop_every = TEST_DROP_EVERY, .short_every = TEST_SHORT_EVERY });
+    http_upload_stats_t before;
+    http_upload_get_stats(&before);
+    shim_manual_ticks = true;
+    http_upload_source_t s = make_source("drops", TEST_SMALL_BYTES);
+    bool ok = http_upload_start(&s) && drive(UINT32_MAX);
+    shim_manual_ticks = false;
+    http_upload_stats_t d = stats_delta(&before);
+    server_state_t sv = server_snapshot();
+    ok &= d.uploads_completed == 1u && sv.completed == 1u && sv.errors == 0 && sv.committed == TEST_SMALL_BYTES;
+    ok &= sv.drops > 0 && d.retries == sv.drops && d.connections == sv.drops + 1u && sv.connections == sv.drops + 1u;
+    ok &= d.resumed_bytes == sv.dropped_committed && sv.overlap_bytes == 0 && sv.queries == sv.drops + 1u;
+    printf("drop every %u, half commit every %u: %u drops, %u reconnects, %u bytes resumed, %u segments, 0 bytes resent  %s\n",
+           (unsigned int)TEST_DROP_EVERY, (unsigned int)TEST_SHORT_EVERY, (unsigned int)sv.drops, (unsigned int)d.retries,
+           (unsigned int)d.resumed_bytes, (unsigned int)sv.segments, ok ? "ok" : "FAIL");
+    return ok;
+}
+
+static bool check_connection_close(void) {
+    server_reset(&(server_script_t){ .close_every_response = true });
+    http_upload_stats_t before;
+    http_upload_get_stats(&before);
+    http_upload_source_t s = make_source("close", TEST_SMALL_BYTES);
+    bool ok = http_upload_start(&s) && drive(UINT32_MAX);
+    http_upload_stats_t d = stats_delta(&before);
+    server_state_t sv = server_snapshot();
+    uint32_t segments = segments_for(TEST_SMALL_BYTES);
+    ok &= d.uploads_completed == 1u && d.retries == 0 && sv.errors == 0 && sv.queries == 1u && sv.segments == segments &&
+          sv.connections == segments + 1u && d.connections == segments + 1u;
+    printf("server closes after every response: %u connections for %u requests, %u query  %s\n", (unsigned int)sv.connections,
+           (unsigned int)sv.requests, (unsigned int)sv.queries, ok ? "ok" : "FAIL");
+    return ok;
+}
+
+static bool check_cancel_resume(void) {
+    server_reset(&(server_script_t){ 0 });
+    http_upload_stats_t before;
+    http_upload_get_stats(&before);
+    http_upload_source_t s = make_source("cancel", TEST_SMALL_BYTES);
+    bool ok = http_upload_start(&s) && drive(TEST_SMALL_BYTES / 2u);
+    http_upload_cancel();
+    (void)http_upload_step();
+    ok &= !http_upload_is_busy();
+    uint32_t committed = server_snapshot().committed;
+    ok &= committed >= TEST_SMALL_BYTES / 2u && committed < TEST_SMALL_BYTES;
+    ok &= http_upload_start(&s) && drive(UINT32_MAX);
+    http_upload_stats_t d = stats_delta(&before);
+    server_state_t sv = server_snapshot();
+    ok &= d.uploads_completed == 1u && d.resumed_bytes == committed && d.bytes_sent == TEST_SMALL_BYTES && sv.overlap_bytes == 0 &&
+          sv.errors == 0 && sv.completed == 1u && sv.queries == 2u;
+    printf("cancel at %u bytes, resubmit: resumed from the server's offset, 0 bytes resent  %s\n", (unsigned int)committed,
+           ok ? "ok" : "FAIL");
+    return ok;
+}
+
+static bool check_read_failure(void) {
+    server_reset(&(server_script_t){ 0 });
+    http_upload_stats_t before;
+    http_upload_get_stats(&before);
+    reader.fail_at = 3u * HTTP_UPLOAD_SEGMENT_SIZE;
+    http_upload_source_t s = make_source("unreadable", TEST_SMALL_BYTES);
+    bool ok = http_upload_start(&s);
+    bool failed = false;
+    for (uint32_t i = 0; i < 100u && http_upload_is_busy(); i++) {
+        failed |= (http_upload_step() != CY_RSLT_SUCCESS);
+    }
+    reader.fail_at = UINT32_MAX;
+    http_upload_stats_t d = stats_delta(&before);
+    server_state_t sv = server_snapshot();
+    ok &= failed && !http_upload_is_busy() && d.uploads_completed == 0 && d.retries == 0 && sv.committed == 3u * HTTP_UPLOAD_SEGMENT_SIZE;
+    printf("read failure abandons the upload after %u bytes  %s\n", (unsigned int)sv.committed, ok ? "ok" : "FAIL");
+    return ok;
+}
+
+// 服务端不可达 (端口没有监听) 时的重连间隔，之后恢复服务端
+static bool check_backoff(void) {
+    server_reset(&(server_script_t){ 0 });
+    int closed_fd = socket(AF_INET, SOCK_STREAM, 0);
+    struct sockaddr_in sa = { .sin_family = AF_INET, .sin_addr.s_addr = htonl(INADDR_LOOPBACK) };
+    socklen_t sa_len = sizeof(sa);
+    bind(closed_fd, (struct sockaddr *)&sa, sizeof(sa));
+    getsockname(closed_fd, (struct sockaddr *)&sa, &sa_len);
+    shim_socket_port_override = ntohs(sa.sin_port);
+
+    static const uint32_t expected_ms[] = { 1000u, 2000u, 4000u, 8000u, 16000u, HTTP_UPLOAD_RETRY_MAX_MS, HTTP_UPLOAD_RETRY_MAX_MS };
+    const uint32_t attempts = sizeof(expected_ms) / sizeof(expected_ms[0]) + 1u;
+    uint32_t failure_tick[sizeof(expected_ms) / sizeof(expected_ms[0]) + 1u];
+    uint32_t failures = 0;
+    http_upload_stats_t before;
+    http_upload_get_stats(&before);
+    shim_manual_ticks = true;
+    http_upload_source_t s = make_source("backoff", TEST_SMALL_BYTES);
+    bool ok = http_upload_start(&s);
+    for (uint32_t i = 0; i < TEST_MAX_STEPS && failures < attempts; i++) {
+        (void)http_upload_step();
+        http_upload_stats_t d = stats_delta(&before);
+        if (d.retries > failures) {
+            failure_tick[failures++] = shim_tick_count;
+        }
+        shim_tick_count += TEST_STEP_MS;
+    }
+    bool gaps_ok = failures == attempts;
+    printf("backoff while unreachable:");
+    for (uint32_t i = 1; i < failures; i++) {
+        uint32_t gap = failure_tick[i] - failure_tick[i - 1u];
+        printf(" %.1f", gap / 1000.0);
+        gaps_ok &= gap >= expected_ms[i - 1u] && gap <= expected_ms[i - 1u] + TEST_STEP_MS;
+    }
+    shim_socket_port_override = server_port;
+    close(closed_fd);
+    ok &= gaps_ok && drive(UINT32_MAX);
+    shim_manual_ticks = false;
+    server_state_t sv = server_snapshot();
+    ok &= sv.completed == 1u && sv.errors == 0;
+    printf(" s, then completes once reachable  %s\n", ok ? "ok" : "FAIL");
+    return ok;
+}
+
+static bool check_rtt(void) {
+    bool ok = true;
+    for (size_t i = 0; i < sizeof(test_rtt_ms) / sizeof(test_rtt_ms[0]); i++) {
+        server_reset(&(server_script_t){ .rtt_ms = test_rtt_ms[i] });
+        http_upload_source_t s = make_source("rtt", TEST_SMALL_BYTES);
+        double start = now_s();
+        bool run_ok = http_upload_start(&s) && drive(UINT32_MAX);
+        double elapsed = now_s() - start;
+        double mbps = TEST_SMALL_BYTES * 8.0 / elapsed / 1e6;
+        double bound = HTTP_UPLOAD_SEGMENT_SIZE * 8.0 / (test_rtt_ms[i] / 1000.0) / 1e6;
+        run_ok &= server_snapshot().completed == 1u && mbps * 100.0 >= bound * TEST_MIN_RTT_EFFICIENCY_PCT;
+        printf("round trip %2u ms: %.2f Mbit/s (segment / round trip %.2f Mbit/s), one hour in %.0f s  %s\n",
+               (unsigned int)test_rtt_ms[i], mbps, bound, TEST_HOUR_BYTES * 8.0 / (mbps * 1e6), run_ok ? "ok" : "FAIL");
+        ok &= run_ok;
+    }
+    return ok;
+}
+
+int main(void) {
+    if (!start_server()) {
+        printf("cannot start the upload server  FAIL\n");
+        return 1;
+    }
+    bool ok = check_full_upload();
+    ok &= check_drops();
+    ok &= check_connection_close();
+    ok &= check_cancel_resume();
+    ok &= check_read_failure();
+    ok &= check_backoff();
+    ok &= check_rtt();
+    printf("%s\n", ok ? "all checks passed" : "FAILED");
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,197 @@
+// log_mel.c 的主机检查：定点特征与双精度浮点参考逐帧逐频带比较。
+// 参考实现使用同样的周期 Hann 窗、补零长度和帧定位 (窗口开头补零)，用直接 DFT 求功率谱，
+// 频带权重取自 log_mel_t 中的 mel 滤波器 (滤波器设计不在检查范围内)，再按 LOG_MEL_DB_MIN/LOG_MEL_DB_STEP 量化。
+// 误差以量化级 (0.5 dB) 计，按频带相对本帧最强频带的深度分为两组：TEST_RANGE_DB 以内的须在门限内；
+// 更深的频带落在块浮点 16 位 FFT 的噪声底附近 (定点结果偏高)，只报告。
+// 另外检查 20 ms 分块与一次性处理的输出逐字节一致，以及 log_mel_output_count() 的预测。
+//
+// 构建 (主机，在仓库根目录)：
+//   cc -O2 -Isrc -o test_log_mel tools/host/test_log_mel.c src/log_mel.c src/dsp.c -lm
+// 运行：
+//   ./test_log_mel            # 任一项超出门限时返回 1
+
+#include "log_mel.h"
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define TEST_SECONDS            (2u)
+#define TEST_MAX_RATE           (16000u)
+#define TEST_BLOCK_MS           (20u)
+#define TEST_RANGE_DB           (45.0)      // 比本帧最强频带低不超过此 dB 的频带参与门限
+#define TEST_MAX_MEAN_STEPS     (0.5)       // 平均绝对误差 (量化级)
+#define TEST_MAX_ERROR_STEPS    (3)         // 最大绝对误差 (量化级)
+#define TEST_MAX_FRAMES         (TEST_SECONDS * 1000u / LOG_MEL_HOP_MS)
+
+typedef enum {
+    SIGNAL_NOISE,           // 白噪声
+    SIGNAL_TILTED_NOISE,    // 一阶低通后的噪声，频带间动态范围大
+    SIGNAL_TONES,           // 三个单频之和
+} signal_kind_t;
+
+typedef struct {
+    const char *name;
+    signal_kind_t kind;
+    double level_dbfs;
+} test_signal_t;
+
+static const test_signal_t signals[] = {
+    { "white noise  -10 dBFS", SIGNAL_NOISE, -10.0 },
+    { "white noise  -40 dBFS", SIGNAL_NOISE, -40.0 },
+    { "tilted noise -20 dBFS", SIGNAL_TILTED_NOISE, -20.0 },
+    { "tones        -6 dBFS", SIGNAL_TONES, -6.0 },
+    { "tones        -50 dBFS", SIGNAL_TONES, -50.0 },
+};
+
+static const uint32_t rates[] = { 16000u, 8000u };
+
+static int16_t input[TEST_MAX_RATE * TEST_SECONDS];
+static uint8_t fixed_out[TEST_MAX_FRAMES * LOG_MEL_BANDS];
+static uint8_t whole_out[TEST_MAX_FRAMES * LOG_MEL_BANDS];
+static log_mel_t lm;
+
+static double gaussian(unsigned int *seed) {
+    double u1 = ((double)rand_r(seed) + 1.0) / ((double)RAND_MAX + 2.0);
+    double u2 = (double)rand_r(seed) / ((double)RAND_MAX + 1.0);
+    return sqrt(-2.0 * log(u1)) * cos(2.0 * M_PI * u2);
+}
+
+static void make_signal(const test_signal_t *sig, uint32_t rate, size_t n) {
+    unsigned int seed = 7u;
+    double rms = 32768.0 * pow(10.0, sig->level_dbfs / 20.0);
+    double lp = 0.0;
+    for (size_t i = 0; i < n; i++) {
+        double x;
+        switch (sig->kind) {
+        case SIGNAL_NOISE:
+            x = rms * gaussian(&seed);
+            break;
+        case SIGNAL_TILTED_NOISE:
+            lp = 0.95 * lp + gaussian(&seed);
+            x = rms * lp * sqrt(1.0 - 0.95 * 0.95);
+            break;
+        default: {
+            double t = (double)i / rate;
+            x = rms * (sin(2.0 * M_PI * 440.0 * t) + 0.5 * sin(2.0 * M_PI * 1250.0 * t) +
+                       0.25 * sin(2.0 * M_PI * 3100.0 * t)) / sqrt(0.5 * (1.0 + 0.25 + 0.0625));
+            break;
+        }
+        }
+        x = (x > 32767.0) ? 32767.0 : (x < -32768.0) ? -32768.0 : x;
+        input[i] = (int16_t)lrint(x);
+    }
+}
+
+// 第 frame 帧的浮点参考：窗口结束于样本 (frame + 1) * hop，之前不足的部分为零
+static void reference_frame(size_t frame, double *db) {
+    static double re[DSP_FFT_MAX_N];
+    static double power[DSP_FFT_MAX_N / 2 + 1];
+    const uint32_t n_fft = 1u << lm.log2n;
+    const long end = (long)(frame + 1) * lm.hop_len;
+    for (uint32_t n = 0; n < n_fft; n++) {
+        re[n] = 0.0;
+        long idx = end - lm.window_len + (long)n;
+        if (n < lm.window_len && idx >= 0) {
+            double w = 0.5 - 0.5 * cos(2.0 * M_PI * n / lm.window_len);
+            re[n] = input[idx] * w;
+        }
+    }
+    for (uint32_t k = 0; k <= n_fft / 2; k++) {
+        double sr = 0.0;
+        double si = 0.0;
+        for (uint32_t n = 0; n < lm.window_len; n++) {
+            double a = 2.0 * M_PI * (double)k * n / n_fft;
+            sr += re[n] * cos(a);
+            si -= re[n] * sin(a);
+        }
+        power[k] = sr * sr + si * si;
+    }
+    for (uint32_t b = 0; b < LOG_MEL_BANDS; b++) {
+        double acc = 0.0;
+        for (uint32_t j = 0; j < lm.mel.bin_count[b]; j++) {
+            acc += power[lm.mel.first_bin[b] + j] * (lm.mel.weights[lm.mel.weight_offset[b] + j] / 65535.0);
+        }
+        db[b] = (acc > 0.0) ? 10.0 * log10(acc) : -1000.0;
+    }
+}
+
+static int quantize(double db) {
+    long q = lround((db - LOG_MEL_DB_MIN) / LOG_MEL_DB_STEP);
+    return (int)((q < 0) ? 0 : (q > 255) ? 255 : q);
+}
+
+static bool check(uint32_t rate, const test_signal_t *sig) {
+    if (!log_mel_init(&lm, rate)) {
+        printf("%5u Hz  log_mel_init failed\n", (unsigned int)rate);
+        return false;
+    }
+    size_t n = rate * TEST_SECONDS;
+    make_signal(sig, rate, n);
+
+    // 按帧长分块处理，顺带检查 log_mel_output_count() 的预测
+    size_t block = rate * TEST_BLOCK_MS / 1000u;
+    size_t frames = 0;
+    bool count_ok = true;
+    for (size_t pos = 0; pos < n; pos += block) {
+        size_t len = (n - pos < block) ? n - pos : block;
+        size_t expected = log_mel_output_count(&lm, len);
+        size_t got = log_mel_process(&lm, &input[pos], len, 1, &fixed_out[frames * LOG_MEL_BANDS]);
+        count_ok &= (got == expected);
+        frames += got;
+    }
+    count_ok &= (frames == n / lm.hop_len);
+
+    // 一次性处理整段信号，须与分块处理逐字节相同
+    log_mel_reset(&lm);
+    size_t whole = log_mel_process(&lm, input, n, 1, whole_out);
+    bool blocks_ok = (whole == frames) && memcmp(whole_out, fixed_out, frames * LOG_MEL_BANDS) == 0;
+
+    uint64_t loud_count = 0;
+    uint64_t quiet_count = 0;
+    double loud_sum = 0.0;
+    double quiet_sum = 0.0;
+    int loud_max = 0;
+    int quiet_max = 0;
+    for (size_t f = 0; f < frames; f++) {
+        double db[LOG_MEL_BANDS];
+        reference_frame(f, db);
+        double peak = -1000.0;
+        for (uint32_t b = 0; b < LOG_MEL_BANDS; b++) {
+            peak = (db[b] > peak) ? db[b] : peak;
+        }
+        for (uint32_t b = 0; b < LOG_MEL_BANDS; b++) {
+            int err = abs((int)fixed_out[f * LOG_MEL_BANDS + b] - quantize(db[b]));
+            if (db[b] >= peak - TEST_RANGE_DB) {
+                loud_count++;
+                loud_sum += err;
+                loud_max = (err > loud_max) ? err : loud_max;
+            } else {
+                quiet_count++;
+                quiet_sum += err;
+                quiet_max = (err > quiet_max) ? err : quiet_max;
+            }
+        }
+    }
+    double loud_mean = loud_count ? loud_sum / loud_count : 0.0;
+    bool ok = count_ok && blocks_ok && loud_mean <= TEST_MAX_MEAN_STEPS && loud_max <= TEST_MAX_ERROR_STEPS;
+    printf("%5u Hz  %-22s  within %.0f dB: %5llu bands, mean %.2f max %d steps", (unsigned int)rate, sig->name, TEST_RANGE_DB,
+           (unsigned long long)loud_count, loud_mean, loud_max);
+    printf("  deeper: %5llu bands, mean %.2f max %d steps  blocks %s  counts %s  %s\n",
+           (unsigned long long)quiet_count, quiet_count ? quiet_sum / quiet_count : 0.0, quiet_max,
+           blocks_ok ? "match" : "DIFFER", count_ok ? "ok" : "WRONG", ok ? "ok" : "FAIL");
+    return ok;
+}
+
+int main(void) {
+    printf("fixed-point log-mel vs double reference, 1 step = %.1f dB; gate: mean <= %.1f, max <= %d steps\n",
+           LOG_MEL_DB_STEP, TEST_MAX_MEAN_STEPS, TEST_MAX_ERROR_STEPS);
+    bool ok = true;
+    for (size_t r = 0; r < sizeof(rates) / sizeof(rates[0]); r++) {
+        for (size_t s = 0; s < sizeof(signals) / sizeof(signals[0]); s++) {
+            ok &= check(rates[r], &signals[s]);
+        }
+    }
+    printf("%s\n", ok ? "all checks passed" : "FAILED");
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,385 @@
+// mqtt_stream.c 的 QoS0 快速路径 (MQTT_AUDIO_FAST_PATH) 的主机检查：PUBLISH 报头前缀缓存的线上格式和每帧发布开销。
+// mqtt_stream.c 以默认的 MQTT_AUDIO_QOS=0 编译，经 tools/host/shim/ 中的 secure-sockets 和 FreeRTOS 替身连接到本程序
+// 在回环地址临时端口上运行的接收线程；接收线程回复 CONNACK 后记录收到的全部字节。
+// 线上格式：与按 MQTT 3.1.1 独立编码的参考报文逐字节比较。覆盖剩余长度 1/2/3 字节的边界 (127/128、16383/16384)，
+// 多于 MQTT_STREAM_PREFIX_CACHE_SIZE 个主题轮流发布 (缓存不断换出)，同一主题上帧长交替变化 (码率自适应切换档位)，
+// mqtt_stream_publish_shared() 发布后帧仍归调用者。每帧恰好一次 cy_socket_send()，经 mqtt_stream_publish() 的帧恰好归还一次。
+// 开销：与 cy_mqtt 的发布路径对比。cy_mqtt 不能在主机上链接，对照是按它的做法写的模型：每次 strlen 主题、
+// 序列化固定报头和主题、把负载拷贝进 2 KB 的 mqtt_network_buffer，再从缓冲发送 (不含 cy_mqtt 的互斥锁和
+// coreMQTT 的状态记录，实际开销只会更高)。分两种情况测量：替身的发送不进入内核 (只有发布路径本身的 CPU 开销)，
+// 以及经回环 TCP 发出。
+// 门限：线上格式全部一致、发送次数和归还次数正确；不进内核时快速路径命中缓存的每帧开销低于模型。
+//
+// 构建 (主机，在仓库根目录)：
+//   cc -O2 -pthread -Isrc -Itools/host/shim -o test_mqtt_publish tools/host/test_mqtt_publish.c src/mqtt_stream.c tools/host/shim/secure_sockets_shim.c tools/host/shim/freertos_shim.c
+// 运行：
+//   ./test_mqtt_publish       # 任一项超出门限时返回 1
+
+#include "mqtt_stream.h"
+#include "app_config.h"
+#include "cy_secure_sockets.h"
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <time.h>
+#include <unistd.h>
+
+#if (MQTT_AUDIO_QOS != 0)
+#error "build with the default MQTT_AUDIO_QOS=0"
+#endif
+
+#define TEST_CLIENT_ID          "test"
+#define TEST_CAPTURE_BYTES      (4u * 1024u * 1024u)
+#define TEST_TOPICS             (MQTT_STREAM_PREFIX_CACHE_SIZE + 1u)
+#define TEST_BENCH_CPU_FRAMES   (1000000u)
+#define TEST_BENCH_TCP_FRAMES   (100000u)
+#define TEST_FRAME_SAMPLES      (AUDIO_MAX_OUTPUT_SAMPLE_RATE * AUDIO_FRAME_DURATION_MS / 1000u)
+#define TEST_WAIT_MS            (5000u)
+#define TEST_NETWORK_BUFFER     (1024u * 2u)   // 与 network_task.c 中的 mqtt_network_buffer 相同
+
+// ---- 接收线程 ----
+
+static int listen_fd = -1;
+static atomic_bool receiver_stop;
+static atomic_bool capture_enabled;             // 只记录第一条连接 (mqtt_stream.c) 的字节
+static uint8_t capture[TEST_CAPTURE_BYTES];
+static atomic_uint capture_len;
+static atomic_ulong received_total;
+static pthread_t receiver;
+
+static void *connection_thread(void *arg) {
+    int fd = (int)(intptr_t)arg;
+    static uint8_t scratch[65536];
+    // CONNECT：固定报头 + 变长的剩余长度 + 其余部分 (不检查，test_mqtt_stream.c 检查 CONNECT 的内容)
+    uint8_t byte = 0;
+    uint32_t remaining = 0, shift = 0;
+    bool ok = recv(fd, &byte, 1, MSG_WAITALL) == 1 && byte == 0x10u;
+    do {
+        ok = ok && recv(fd, &byte, 1, MSG_WAITALL) == 1;
+        remaining |= (uint32_t)(byte & 0x7Fu) << shift;
+        shift += 7;
+    } while (ok && (byte & 0x80u) && shift < 28);
+    if (!ok || remaining > sizeof(scratch) || recv(fd, scratch, remaining, MSG_WAITALL) != (ssize_t)remaining) {
+        close(fd);
+        return NULL;
+    }
+    static const uint8_t connack[4] = { 0x20, 2, 0, 0 };
+    (void)send(fd, connack, sizeof(connack), MSG_NOSIGNAL);
+    bool capturing = atomic_exchange(&capture_enabled, false);
+    uint8_t local[65536];
+    while (!atomic_load(&receiver_stop)) {
+        struct pollfd p = { .fd = fd, .events = POLLIN };
+        if (poll(&p, 1, 20) <= 0) {
+            continue;
+        }
+        ssize_t n = recv(fd, local, sizeof(local), 0);
+        if (n <= 0) {
+            break;
+        }
+        if (capturing) {
+            uint32_t at = atomic_load(&capture_len);
+            uint32_t room = TEST_CAPTURE_BYTES - at;
+            uint32_t take = ((uint32_t)n < room) ? (uint32_t)n : room;
+            memcpy(&capture[at], local, take);
+            atomic_store(&capture_len, at + take);
+        }
+        atomic_fetch_add(&received_total, (unsigned long)n);
+    }
+    close(fd);
+    return NULL;
+}
+
+static void *receiver_thread(void *arg) {
+    (void)arg;
+    while (!atomic_load(&receiver_stop)) {
+        struct pollfd p = { .fd = listen_fd, .events = POLLIN };
+        if (poll(&p, 1, 20) <= 0) {
+            continue;
+        }
+        int fd = accept(listen_fd, NULL, NULL);
+        pthread_t t;
+        if (fd >= 0 && pthread_create(&t, NULL, connection_thread, (void *)(intptr_t)fd) == 0) {
+            pthread_detach(t);
+        }
+    }
+    return NULL;
+}
+
+static bool start_receiver(void) {
+    atomic_store(&capture_enabled, true);
+    listen_fd = socket(AF_INET, SOCK_STREAM, 0);
+    struct sockaddr_in sa = { .sin_family = AF_INET, .sin_addr.s_addr = htonl(INADDR_LOOPBACK) };
+    socklen_t sa_len = sizeof(sa);
+    if (listen_fd < 0 || bind(listen_fd, (struct sockaddr *)&sa, sizeof(sa)) != 0 || listen(listen_fd, 4) != 0 ||
+        getsockname(listen_fd, (struct sockaddr *)&sa, &sa_len) != 0) {
+        return false;
+    }
+    shim_socket_port_override = ntohs(sa.sin_port);
+    return pthread_create(&receiver, NULL, receiver_thread, NULL) == 0;
+}
+
+static uint64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+}
+
+static bool wait_received(unsigned long total) {
+    uint64_t deadline = now_ns() + (uint64_t)TEST_WAIT_MS * 1000000u;
+    while (atomic_load(&received_total) < total && now_ns() < deadline) {
+        usleep(1000);
+    }
+    return atomic_load(&received_total) >= total;
+}
+
+// ---- 参考编码 ----
+
+static uint8_t expected[TEST_CAPTURE_BYTES];
+static uint32_t expected_len;
+
+static void expect_publish(const char *topic, const uint8_t *payload, uint32_t payload_len) {
+    uint32_t topic_len = (uint32_t)strlen(topic);
+    uint32_t remaining = 2u + topic_len + payload_len;
+    uint8_t *p = &expected[expected_len];
+    uint32_t n = 0;
+    p[n++] = 0x30u;                                 // PUBLISH，QoS0，DUP = 0，RETAIN = 0
+    do {
+        p[n] = (uint8_t)(remaining & 0x7Fu);
+        remaining >>= 7;
+        p[n++] |= (remaining > 0) ? 0x80u : 0u;
+    } while (remaining > 0);
+    p[n++] = (uint8_t)(topic_len >> 8);
+    p[n++] = (uint8_t)topic_len;
+    memcpy(&p[n], topic, topic_len);
+    n += topic_len;
+    memcpy(&p[n], payload, payload_len);
+    expected_len += n + payload_len;
+}
+
+// ---- 设备侧 ----
+
+static audio_data_t frames[4];
+static uint32_t released;
+
+void audio_release_frame(audio_data_t *frame) {
+    (void)frame;
+    released++;
+}
+
+static void fill_frame(audio_data_t *frame, uint32_t sequence, uint32_t num_samples) {
+    frame->header.version = AUDIO_FRAME_HEADER_VERSION;
+    frame->header.flags = 0;
+    frame->header.channels = AUDIO_CHANNELS;
+    frame->header.format = AUDIO_FRAME_FORMAT_PCM_S16LE;
+    frame->header.sample_rate_hz = num_samples * 1000u / AUDIO_FRAME_DURATION_MS;
+    frame->header.num_samples = (uint16_t)num_samples;
+    frame->header.sequence = sequence;
+    frame->header.timestamp_ms = sequence * AUDIO_FRAME_DURATION_MS;
+    for (uint32_t i = 0; i < num_samples * AUDIO_CHANNELS; i++) {
+        frame->samples[i] = (int16_t)(sequence * 31u + i);
+    }
+}
+
+// 主题地址在运行期间不变 (前缀缓存按地址匹配)
+static char topics[TEST_TOPICS][MQTT_STREAM_MAX_TOPIC_LEN + 1];
+
+static bool check(bool condition, const char *what) {
+    printf("%-78s %s\n", what, condition ? "ok" : "FAIL");
+    return condition;
+}
+
+static bool compare_capture(const char *what) {
+    bool ok = wait_received(expected_len) && atomic_load(&capture_len) == expected_len &&
+              memcmp(capture, expected, expected_len) == 0;
+    return check(ok, what);
+}
+
+static bool check_wire_format(void) {
+    bool ok = true;
+    static uint8_t buffer[AUDIO_FRAME_HEADROOM + 20000u];
+    uint8_t *payload = &buffer[AUDIO_FRAME_HEADROOM];
+    for (uint32_t i = 0; i < 20000u; i++) {
+        payload[i] = (uint8_t)(i * 7u + 3u);
+    }
+
+    // 剩余长度边界：负载 0 ~ 300 字节覆盖 127/128，另加 16383/16384 两侧 (主题长度计入剩余长度)
+    uint32_t sends = shim_socket_sends;
+    uint32_t publishes = 0;
+    uint32_t topic_len = (uint32_t)strlen(topics[0]);
+    uint32_t large[] = { 16383u - 2u - topic_len - 1u, 16383u - 2u - topic_len, 16384u - 2u - topic_len, 20000u };
+    for (uint32_t len = 0; len <= 300u + sizeof(large) / sizeof(large[0]); len++) {
+        uint32_t payload_len = (len <= 300u) ? len : large[len - 301u];
+        ok &= mqtt_stream_publish_payload(topics[0], payload, payload_len) == CY_RSLT_SUCCESS;
+        expect_publish(topics[0], payload, payload_len);
+        publishes++;
+    }
+    ok &= check(shim_socket_sends - sends == publishes, "publish_payload: one cy_socket_send() per packet");
+    ok &= compare_capture("remaining length 1/2/3 bytes (payload 0..300, around 16383/16384) match reference");
+
+    // 多于缓存容量的主题轮流发布，同一主题上帧长交替 (全采样率 / 降采样率)
+    sends = shim_socket_sends;
+    uint32_t released_before = released;
+    uint32_t frames_published = 0;
+    for (uint32_t seq = 0; seq < 200u; seq++) {
+        audio_data_t *frame = &frames[seq % 4u];
+        uint32_t num_samples = ((seq / TEST_TOPICS) % 2u == 0) ? TEST_FRAME_SAMPLES : TEST_FRAME_SAMPLES / 2u;
+        fill_frame(frame, seq, num_samples);
+        const char *topic = topics[seq % TEST_TOPICS];
+        expect_publish(topic, (const uint8_t *)&frame->header, (uint32_t)audio_frame_payload_len(frame));
+        ok &= mqtt_stream_publish(frame, topic) == CY_RSLT_SUCCESS;
+        frames_published++;
+    }
+    ok &= check(shim_socket_sends - sends == frames_published && released - released_before == frames_published,
+                "publish: one send per frame, every frame released exactly once");
+    ok &= compare_capture("5 topics over a 4-entry prefix cache, alternating frame lengths match reference");
+
+    // 共享帧：QoS0 时不在在途窗口中，报头写入预留区一次发出，帧不归还
+    sends = shim_socket_sends;
+    released_before = released;
+    fill_frame(&frames[0], 1000u, TEST_FRAME_SAMPLES);
+    ok &= mqtt_stream_publish_shared(&frames[0], topics[1]) == CY_RSLT_SUCCESS;
+    expect_publish(topics[1], (const uint8_t *)&frames[0].header, (uint32_t)audio_frame_payload_len(&frames[0]));
+    ok &= check(shim_socket_sends - sends == 1u && released == released_before, "publish_shared: one send, frame stays with caller");
+    ok &= compare_capture("publish_shared matches reference");
+
+    // 主题超过 MQTT_STREAM_MAX_TOPIC_LEN 时拒绝，不发送
+    static char long_topic[MQTT_STREAM_MAX_TOPIC_LEN + 2];
+    memset(long_topic, 'x', sizeof(long_topic) - 1u);
+    sends = shim_socket_sends;
+    ok &= check(mqtt_stream_publish_payload(long_topic, payload, 10) == CY_RSLT_MODULE_SECURE_SOCKETS_BADARG &&
+                shim_socket_sends == sends && mqtt_stream_is_connected(), "over-long topic rejected without sending");
+    return ok;
+}
+
+// ---- cy_mqtt 发布路径的模型 ----
+
+static uint8_t network_buffer[TEST_NETWORK_BUFFER];
+
+static cy_rslt_t generic_publish(cy_socket_t socket, const char *topic, const uint8_t *payload, uint32_t payload_len) {
+    uint32_t topic_len = (uint32_t)strlen(topic);
+    uint32_t remaining = 2u + topic_len + payload_len;
+    uint32_t n = 0;
+    network_buffer[n++] = 0x30u;
+    do {
+        network_buffer[n] = (uint8_t)(remaining & 0x7Fu);
+        remaining >>= 7;
+        network_buffer[n++] |= (remaining > 0) ? 0x80u : 0u;
+    } while (remaining > 0);
+    network_buffer[n++] = (uint8_t)(topic_len >> 8);
+    network_buffer[n++] = (uint8_t)topic_len;
+    memcpy(&network_buffer[n], topic, topic_len);
+    n += topic_len;
+    if (n + payload_len > sizeof(network_buffer)) {
+        return CY_RSLT_MODULE_SECURE_SOCKETS_BADARG;
+    }
+    memcpy(&network_buffer[n], payload, payload_len);
+    n += payload_len;
+    uint32_t sent = 0;
+    for (uint32_t off = 0; off < n; off += sent) {
+        cy_rslt_t result = cy_socket_send(socket, &network_buffer[off], n - off, CY_SOCKET_FLAGS_NONE, &sent);
+        if (result != CY_RSLT_SUCCESS) {
+            return result;
+        }
+    }
+    return CY_RSLT_SUCCESS;
+}
+
+static cy_socket_t connect_generic(void) {
+    cy_socket_t socket = NULL;
+    cy_socket_sockaddr_t address = { .port = MQTT_PORT };
+    if (cy_socket_gethostbyname("127.0.0.1", CY_SOCKET_IP_VER_V4, &address.ip_address) != CY_RSLT_SUCCESS ||
+        cy_socket_create(CY_SOCKET_DOMAIN_AF_INET, CY_SOCKET_TYPE_STREAM, CY_SOCKET_IPPROTO_TCP, &socket) != CY_RSLT_SUCCESS ||
+        cy_socket_connect(socket, &address, sizeof(address)) != CY_RSLT_SUCCESS) {
+        return NULL;
+    }
+    static const uint8_t connect[] = { 0x10, 16, 0, 4, 'M', 'Q', 'T', 'T', 4, 0x02, 0, 60, 0, 4, 't', 'e', 's', 't' };
+    uint32_t sent = 0;
+    uint8_t connack[4];
+    uint32_t got = 0;
+    if (cy_socket_send(socket, connect, sizeof(connect), CY_SOCKET_FLAGS_NONE, &sent) != CY_RSLT_SUCCESS ||
+        cy_socket_recv(socket, connack, sizeof(connack), CY_SOCKET_FLAGS_NONE, &got) != CY_RSLT_SUCCESS) {
+        return NULL;
+    }
+    return socket;
+}
+
+typedef enum { BENCH_FAST_HIT, BENCH_FAST_MISS, BENCH_GENERIC } bench_path_t;
+
+// 返回每帧纳秒数
+static double bench(bench_path_t path, cy_socket_t generic_socket, uint32_t count) {
+    audio_data_t *frame = &frames[0];
+    fill_frame(frame, 0, TEST_FRAME_SAMPLES);
+    uint32_t payload_len = (uint32_t)audio_frame_payload_len(frame);
+    unsigned long before = atomic_load(&received_total);
+    unsigned long bytes = 0;
+    uint64_t start = now_ns();
+    for (uint32_t i = 0; i < count; i++) {
+        // 命中：同一主题和长度；未命中：多于缓存容量的主题轮流使用，每次都重新编码
+        const char *topic = (path == BENCH_FAST_MISS) ? topics[i % TEST_TOPICS] : topics[0];
+        cy_rslt_t result = (path == BENCH_GENERIC)
+                               ? generic_publish(generic_socket, topic, (const uint8_t *)&frame->header, payload_len)
+                               : mqtt_stream_publish(frame, topic);
+        if (result != CY_RSLT_SUCCESS) {
+            return -1.0;
+        }
+        bytes += 2u + 2u + strlen(topic) + payload_len;
+    }
+    uint64_t elapsed = now_ns() - start;
+    // 经 TCP 时等对端收完，计入发送路径的全部开销
+    if (!shim_socket_discard && !wait_received(before + bytes)) {
+        return -1.0;
+    }
+    if (!shim_socket_discard) {
+        elapsed = now_ns() - start;
+    }
+    return (double)elapsed / count;
+}
+
+int main(void) {
+    bool ok = true;
+    for (uint32_t i = 0; i < TEST_TOPICS; i++) {
+        snprintf(topics[i], sizeof(topics[i]), "%s/meeting-room-%u", (i % 2u) ? MQTT_TOPIC_AUDIO_BACKLOG : MQTT_TOPIC_AUDIO_STREAM,
+                 (unsigned int)i);
+    }
+    if (!start_receiver() || mqtt_stream_connect("127.0.0.1", TEST_CLIENT_ID) != CY_RSLT_SUCCESS) {
+        printf("cannot connect to local receiver  FAIL\nFAILED\n");
+        return 1;
+    }
+    ok &= check_wire_format();
+
+    cy_socket_t generic_socket = connect_generic();
+    if (generic_socket == NULL) {
+        printf("cannot open generic-path connection  FAIL\nFAILED\n");
+        return 1;
+    }
+    printf("publish cost per %u-byte frame (topic \"%s\"):\n", (unsigned int)(sizeof(audio_frame_header_t) +
+           TEST_FRAME_SAMPLES * AUDIO_CHANNELS * 2u), topics[0]);
+    static const char *names[] = { "fast path, prefix cached", "fast path, prefix miss every frame", "cy_mqtt model (strlen + copy)" };
+    double cpu[3], tcp[3];
+    shim_socket_discard = true;
+    for (int p = 0; p < 3; p++) {
+        cpu[p] = bench((bench_path_t)p, generic_socket, TEST_BENCH_CPU_FRAMES);
+    }
+    shim_socket_discard = false;
+    for (int p = 0; p < 3; p++) {
+        tcp[p] = bench((bench_path_t)p, generic_socket, TEST_BENCH_TCP_FRAMES);
+    }
+    for (int p = 0; p < 3; p++) {
+        printf("  %-36s %7.1f ns without send, %7.0f ns over loopback TCP\n", names[p], cpu[p], tcp[p]);
+    }
+    ok &= check(cpu[0] > 0 && cpu[2] > 0 && tcp[0] > 0 && tcp[2] > 0, "all benchmark publishes succeeded");
+    ok &= check(cpu[0] < cpu[2], "cached fast path costs less CPU per frame than the cy_mqtt model");
+
+    mqtt_stream_disconnect();
+    cy_socket_delete(generic_socket);
+    atomic_store(&receiver_stop, true);
+    pthread_join(receiver, NULL);
+    printf("%s\n", ok ? "all checks passed" : "FAILED");
+    return ok ? 0 : 1;
+}
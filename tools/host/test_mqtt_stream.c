@@ -0,0 +1,380 @@
+// mqtt_stream.c 的主机检查：QoS1 数据连接在 PUBACK 丢失和断线重连 (clean session = 0) 下的交付次数，
+// 以及不同往返时间和 PUBACK 丢失率下的吞吐和在途内存。
+// mqtt_stream.c 以 MQTT_AUDIO_QOS=1 编译，经 tools/host/shim/ 中的 secure-sockets (BSD 套接字) 和 FreeRTOS 替身
+// 连接到本程序在回环地址临时端口上运行的脚本化代理线程。代理检查 CONNECT (协议级别 4、clean session = 0、
+// 客户端 ID 带 MQTT_STREAM_CLIENT_ID_SUFFIX)，记录每个 PUBLISH 的帧序号、报文标识符和 DUP 标志，
+// 按给定概率丢弃 PUBACK、按给定往返时间延迟发出，每收到 kill_every 个 PUBLISH 就不回 PUBACK 直接断开连接。
+// 与 MQTT 3.1.1 代理一样不按 DUP 去重：设备重传的帧可能到达多次，接收端 (receiver.c) 须按帧序号去重。
+// 门限：每帧至少到达一次，按序号去重后首次到达的顺序与发布顺序相同；重复的副本都带 DUP 且报文标识符与首次相同；
+// 每帧恰好归还一次 (audio_release_frame)，结束时没有在途帧；往返 100 ms 以内且 PUBACK 不丢失时吞吐不低于实时帧率。
+// 另外报告各场景的帧率、重传数、在途峰值和在途帧占用的帧缓冲池内存。
+//
+// 构建 (主机，在仓库根目录)：
+//   cc -O2 -pthread -DMQTT_AUDIO_QOS=1 -Isrc -Itools/host/shim -o test_mqtt_stream tools/host/test_mqtt_stream.c src/mqtt_stream.c tools/host/shim/secure_sockets_shim.c tools/host/shim/freertos_shim.c
+// 运行：
+//   ./test_mqtt_stream        # 任一项超出门限时返回 1
+
+#include "mqtt_stream.h"
+#include "app_config.h"
+#include "cy_secure_sockets.h"
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <time.h>
+#include <unistd.h>
+
+#if (MQTT_AUDIO_QOS != 1)
+#error "build with -DMQTT_AUDIO_QOS=1"
+#endif
+
+#define TEST_MAX_FRAMES         (4000u)
+#define TEST_FRAME_SLOTS        (MQTT_STREAM_INFLIGHT_WINDOW + 2u)
+#define TEST_FRAME_SAMPLES      (AUDIO_MAX_OUTPUT_SAMPLE_RATE * AUDIO_FRAME_DURATION_MS / 1000u)
+#define TEST_TOPIC              MQTT_TOPIC_AUDIO_STREAM "/test"
+#define TEST_CLIENT_ID          "test"
+#define TEST_MAX_PENDING_ACKS   (64u)
+#define TEST_DRAIN_TIMEOUT_MS   (20000u)
+
+// ---- 代理线程 ----
+
+typedef struct {
+    uint32_t rtt_ms;            // PUBACK 在收到 PUBLISH 之后多久发出
+    uint32_t ack_loss_pct;      // 丢弃 PUBACK 的概率
+    uint32_t kill_every;        // 每收到这么多 PUBLISH 就直接断开 (0 表示不断开)
+} broker_script_t;
+
+typedef struct {
+    uint16_t packet_id;
+    uint64_t due_ms;
+} pending_ack_t;
+
+static broker_script_t script;
+static int listen_fd = -1;
+static atomic_bool broker_stop;
+static unsigned int broker_seed;
+
+// 代理记录 (代理线程写，场景结束、线程退出后主线程读)
+static uint32_t copies[TEST_MAX_FRAMES];        // 每个帧序号到达的次数
+static uint16_t first_packet_id[TEST_MAX_FRAMES];
+static uint32_t arrival_order[TEST_MAX_FRAMES]; // 按首次到达排列的帧序号
+static uint32_t arrivals;
+static uint32_t bad_duplicates;                 // 不带 DUP 或报文标识符不同的重复副本
+static uint32_t connects;
+static uint32_t bad_connects;                   // clean session 不为 0、协议级别或客户端 ID 不对
+static uint32_t kills;
+static uint32_t acks_dropped;
+
+static uint64_t now_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000u + (uint64_t)ts.tv_nsec / 1000000u;
+}
+
+static bool send_packet(int fd, const uint8_t *bytes, size_t len) {
+    return send(fd, bytes, len, MSG_NOSIGNAL) == (ssize_t)len;
+}
+
+// 检查 CONNECT 的可变报头和客户端 ID，回复 CONNACK (重连时会话存在标志为 1，与保留会话的代理一样)
+static bool handle_connect(int fd, const uint8_t *body, uint32_t len) {
+    static const char suffix[] = MQTT_STREAM_CLIENT_ID_SUFFIX;
+    bool ok = len >= 12u && memcmp(body, "\x00\x04MQTT\x04", 7) == 0 && (body[7] & 0x02u) == 0;
+    if (ok) {
+        uint32_t id_len = ((uint32_t)body[10] << 8) | body[11];
+        ok = 12u + id_len <= len && id_len >= sizeof(suffix) - 1u &&
+             memcmp(&body[12 + id_len - (sizeof(suffix) - 1u)], suffix, sizeof(suffix) - 1u) == 0;
+    }
+    bad_connects += !ok;
+    uint8_t connack[4] = { 0x20, 2, connects > 0 ? 1 : 0, 0 };
+    connects++;
+    return send_packet(fd, connack, sizeof(connack));
+}
+
+static void record_publish(const uint8_t *body, uint32_t len, uint8_t flags, uint16_t *packet_id) {
+    uint32_t topic_len = ((uint32_t)body[0] << 8) | body[1];
+    *packet_id = (uint16_t)((body[2 + topic_len] << 8) | body[3 + topic_len]);
+    audio_frame_header_t header;
+    if (4u + topic_len + sizeof(header) > len) {
+        return;
+    }
+    memcpy(&header, &body[4 + topic_len], sizeof(header));
+    if (header.sequence >= TEST_MAX_FRAMES) {
+        return;
+    }
+    if (copies[header.sequence]++ == 0) {
+        first_packet_id[header.sequence] = *packet_id;
+        arrival_order[arrivals++] = header.sequence;
+    } else if (!(flags & 0x08u) || first_packet_id[header.sequence] != *packet_id) {
+        bad_duplicates++;
+    }
+}
+
+// 服务一个连接，直到设备断开、脚本要求断开或测试结束
+static void serve_connection(int fd) {
+    static uint8_t rx[65536];
+    pending_ack_t pending[TEST_MAX_PENDING_ACKS];
+    uint32_t pending_count = 0;
+    uint32_t rx_len = 0;
+    uint32_t publishes = 0;
+
+    while (!atomic_load(&broker_stop)) {
+        uint64_t now = now_ms();
+        // 到期的 PUBACK 按收到 PUBLISH 的顺序发出
+        while (pending_count > 0 && pending[0].due_ms <= now) {
+            uint8_t puback[4] = { 0x40, 2, (uint8_t)(pending[0].packet_id >> 8), (uint8_t)pending[0].packet_id };
+            if (!send_packet(fd, puback, sizeof(puback))) {
+                return;
+            }
+            memmove(&pending[0], &pending[1], (--pending_count) * sizeof(pending[0]));
+        }
+        int timeout = (pending_count > 0) ? (int)(pending[0].due_ms - now) : 20;
+        struct pollfd p = { .fd = fd, .events = POLLIN };
+        if (poll(&p, 1, timeout) <= 0) {
+            continue;
+        }
+        ssize_t n = recv(fd, &rx[rx_len], sizeof(rx) - rx_len, 0);
+        if (n <= 0) {
+            return;
+        }
+        rx_len += (uint32_t)n;
+
+        for (;;) {
+            uint32_t remaining = 0, multiplier = 1, pos = 1;
+            uint8_t byte = 0x80u;
+            while ((byte & 0x80u) && pos < rx_len && pos < 5) {
+                byte = rx[pos++];
+                remaining += (byte & 0x7Fu) * multiplier;
+                multiplier *= 128u;
+            }
+            if ((byte & 0x80u) || pos + remaining > rx_len) {
+                break;
+            }
+            uint8_t type = rx[0] & 0xF0u;
+            const uint8_t *body = &rx[pos];
+            if (type == 0x10u) {
+                if (!handle_connect(fd, body, remaining)) {
+                    return;
+                }
+            } else if (type == 0x30u) {
+                uint16_t packet_id = 0;
+                record_publish(body, remaining, rx[0], &packet_id);
+                publishes++;
+                if (script.kill_every > 0 && publishes % script.kill_every == 0) {
+                    kills++;
+                    return;                 // 不回这一帧和所有未发出的 PUBACK
+                }
+                if ((uint32_t)(rand_r(&broker_seed) % 100u) < script.ack_loss_pct) {
+                    acks_dropped++;
+                } else if (pending_count < TEST_MAX_PENDING_ACKS) {
+                    pending[pending_count++] = (pending_ack_t){ packet_id, now_ms() + script.rtt_ms };
+                }
+            } else if (type == 0xC0u) {
+                static const uint8_t pingresp[2] = { 0xD0, 0 };
+                if (!send_packet(fd, pingresp, sizeof(pingresp))) {
+                    return;
+                }
+            } else if (type == 0xE0u) {
+                return;
+            }
+            rx_len -= pos + remaining;
+            memmove(rx, &rx[pos + remaining], rx_len);
+        }
+    }
+}
+
+static void *broker_thread(void *arg) {
+    (void)arg;
+    while (!atomic_load(&broker_stop)) {
+        struct pollfd p = { .fd = listen_fd, .events = POLLIN };
+        if (poll(&p, 1, 20) <= 0) {
+            continue;
+        }
+        int fd = accept(listen_fd, NULL, NULL);
+        if (fd >= 0) {
+            serve_connection(fd);
+            close(fd);
+        }
+    }
+    return NULL;
+}
+
+static pthread_t broker;
+
+static bool start_broker(const broker_script_t *s) {
+    script = *s;
+    broker_seed = 4242u;
+    memset(copies, 0, sizeof(copies));
+    arrivals = bad_duplicates = connects = bad_connects = kills = acks_dropped = 0;
+    atomic_store(&broker_stop, false);
+
+    listen_fd = socket(AF_INET, SOCK_STREAM, 0);
+    struct sockaddr_in sa = { .sin_family = AF_INET, .sin_addr.s_addr = htonl(INADDR_LOOPBACK) };
+    socklen_t sa_len = sizeof(sa);
+    if (listen_fd < 0 || bind(listen_fd, (struct sockaddr *)&sa, sizeof(sa)) != 0 || listen(listen_fd, 4) != 0 ||
+        getsockname(listen_fd, (struct sockaddr *)&sa, &sa_len) != 0) {
+        return false;
+    }
+    shim_socket_port_override = ntohs(sa.sin_port);
+    return pthread_create(&broker, NULL, broker_thread, NULL) == 0;
+}
+
+static void stop_broker(void) {
+    atomic_store(&broker_stop, true);
+    pthread_join(broker, NULL);
+    close(listen_fd);
+}
+
+// ---- 设备侧 ----
+
+static audio_data_t frame_slots[TEST_FRAME_SLOTS];
+static bool slot_busy[TEST_FRAME_SLOTS];
+static uint32_t released[TEST_MAX_FRAMES];
+
+// mqtt_stream.c 在发送 (QoS0) 或收到 PUBACK (QoS1) 后归还帧
+void audio_release_frame(audio_data_t *frame) {
+    released[frame->header.sequence]++;
+    slot_busy[frame - frame_slots] = false;
+}
+
+static audio_data_t *take_slot(void) {
+    for (uint32_t i = 0; i < TEST_FRAME_SLOTS; i++) {
+        if (!slot_busy[i]) {
+            slot_busy[i] = true;
+            return &frame_slots[i];
+        }
+    }
+    return NULL;
+}
+
+// 轮询一次；连接断开时重连 (与网络任务相同：重连后 mqtt_stream_connect() 立即重传在途帧)
+static void service(void) {
+    if (!mqtt_stream_is_connected()) {
+        if (mqtt_stream_connect("127.0.0.1", TEST_CLIENT_ID) != CY_RSLT_SUCCESS) {
+            usleep(10000);
+        }
+        return;
+    }
+    (void)mqtt_stream_poll();
+}
+
+typedef struct {
+    double seconds;
+    double frames_per_s;
+    mqtt_stream_stats_t stats;  // 本场景的增量 (inflight_max 为本场景峰值)
+    bool drained;
+} run_result_t;
+
+// 以在途窗口允许的最快速度发布 frames 帧，然后等待全部确认
+static void run_device(uint32_t frames, run_result_t *r) {
+    static mqtt_stream_stats_t total;
+    mqtt_stream_stats_t before = total;
+    memset(released, 0, sizeof(released));
+    uint64_t start = now_ms();
+    for (uint32_t seq = 0; seq < frames; seq++) {
+        while (!mqtt_stream_can_publish()) {
+            service();
+        }
+        audio_data_t *frame = take_slot();
+        frame->header.version = AUDIO_FRAME_HEADER_VERSION;
+        frame->header.flags = 0;
+        frame->header.channels = AUDIO_CHANNELS;
+        frame->header.format = AUDIO_FRAME_FORMAT_PCM_S16LE;
+        frame->header.sample_rate_hz = AUDIO_MAX_OUTPUT_SAMPLE_RATE;
+        frame->header.num_samples = TEST_FRAME_SAMPLES;
+        frame->header.sequence = seq;
+        frame->header.timestamp_ms = seq * AUDIO_FRAME_DURATION_MS;
+        (void)mqtt_stream_publish(frame, TEST_TOPIC);  // 发送失败的帧留在在途窗口中，重连后重传
+    }
+    uint64_t deadline = now_ms() + TEST_DRAIN_TIMEOUT_MS;
+    mqtt_stream_stats_t stats;
+    do {
+        service();
+        mqtt_stream_get_stats(&stats);
+    } while (stats.inflight > 0 && now_ms() < deadline);
+    r->seconds = (now_ms() - start) / 1000.0;
+    r->frames_per_s = frames / r->seconds;
+    r->drained = stats.inflight == 0;
+    mqtt_stream_disconnect();
+
+    total = stats;
+    r->stats.published = stats.published - before.published;
+    r->stats.acked = stats.acked - before.acked;
+    r->stats.retransmits = stats.retransmits - before.retransmits;
+    r->stats.reconnects = stats.reconnects - before.reconnects;
+    r->stats.inflight_max = stats.inflight_max;
+}
+
+// 交付检查：每帧至少到达一次、去重后首次到达按序、重复副本带 DUP 且标识符相同、每帧恰好归还一次
+static bool check_delivery(uint32_t frames, uint32_t *duplicates) {
+    bool ok = arrivals == frames && bad_duplicates == 0 && bad_connects == 0;
+    *duplicates = 0;
+    for (uint32_t i = 0; i < frames; i++) {
+        ok &= copies[i] >= 1 && released[i] == 1 && arrival_order[i] == i;
+        *duplicates += copies[i] > 1 ? copies[i] - 1 : 0;
+    }
+    return ok;
+}
+
+static bool run_scenario(const char *name, const broker_script_t *s, uint32_t frames, bool realtime_gate) {
+    run_result_t r;
+    memset(&r, 0, sizeof(r));
+    if (!start_broker(s)) {
+        printf("%s: cannot start broker  FAIL\n", name);
+        return false;
+    }
+    run_device(frames, &r);
+    stop_broker();
+
+    uint32_t duplicates = 0;
+    bool pass = r.drained && check_delivery(frames, &duplicates);
+    double realtime_fps = 1000.0 / AUDIO_FRAME_DURATION_MS;
+    if (realtime_gate) {
+        pass &= r.frames_per_s >= realtime_fps;
+    }
+    printf("%-34s %u frames in %.2f s (%.0f/s, %.1fx real time), %u PUBACKs dropped, %u kills, %u reconnects, "
+           "%u retransmits, %u duplicates at broker, in flight max %u (%lu KiB of frame pool)  %s\n",
+           name, (unsigned int)frames, r.seconds, r.frames_per_s, r.frames_per_s / realtime_fps,
+           (unsigned int)acks_dropped, (unsigned int)kills, (unsigned int)r.stats.reconnects,
+           (unsigned int)r.stats.retransmits, (unsigned int)duplicates, (unsigned int)r.stats.inflight_max,
+           (unsigned long)(r.stats.inflight_max * sizeof(audio_data_t) / 1024u), pass ? "ok" : "FAIL");
+    return pass;
+}
+
+int main(void) {
+    bool ok = true;
+    printf("window %u, retransmit after %u ms, %u ms frames (%lu bytes on the wire, audio_data_t %lu bytes)\n",
+           (unsigned int)MQTT_STREAM_INFLIGHT_WINDOW, (unsigned int)MQTT_STREAM_RETRANSMIT_MS,
+           (unsigned int)AUDIO_FRAME_DURATION_MS,
+           (unsigned long)(sizeof(audio_frame_header_t) + TEST_FRAME_SAMPLES * AUDIO_CHANNELS * 2u),
+           (unsigned long)sizeof(audio_data_t));
+
+    // 交付次数：断线重连和 PUBACK 丢失同时发生
+    static const broker_script_t reconnects = { .rtt_ms = 20, .ack_loss_pct = 0, .kill_every = 97 };
+    ok &= run_scenario("reconnect every 97 publishes", &reconnects, 2000, false);
+    static const broker_script_t lossy = { .rtt_ms = 20, .ack_loss_pct = 5, .kill_every = 211 };
+    ok &= run_scenario("5% PUBACK loss + reconnects", &lossy, 600, false);
+
+    // 吞吐和在途内存
+    static const uint32_t rtts[] = { 0, 20, 50, 100, 200 };
+    for (size_t i = 0; i < sizeof(rtts) / sizeof(rtts[0]); i++) {
+        broker_script_t s = { .rtt_ms = rtts[i] };
+        char name[48];
+        snprintf(name, sizeof(name), "RTT %u ms", (unsigned int)rtts[i]);
+        ok &= run_scenario(name, &s, 200, rtts[i] <= 100);
+    }
+    static const uint32_t losses[] = { 1, 5 };
+    for (size_t i = 0; i < sizeof(losses) / sizeof(losses[0]); i++) {
+        broker_script_t s = { .rtt_ms = 50, .ack_loss_pct = losses[i] };
+        char name[48];
+        snprintf(name, sizeof(name), "RTT 50 ms, %u%% PUBACK loss", (unsigned int)losses[i]);
+        ok &= run_scenario(name, &s, 400, false);
+    }
+
+    printf("%s\n", ok ? "all checks passed" : "FAILED");
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,481 @@
+// payload_crypto.c 的主机检查：真实的 payload_crypto_seal()/payload_crypto_open() 在 audio_data_t 帧缓冲中原地加解密，
+// mbedTLS 的 GCM 和 ChaCha20-Poly1305 接口由 tools/host/shim/mbedtls_shim.c 经主机上的 OpenSSL 实现。
+//
+// 算法替身：AES-256-GCM (GCM 规范测试用例 14) 和 ChaCha20-Poly1305 (RFC 8439 2.8.2 节) 的已知答案。
+// 线上格式：加密后的帧与按 payload_crypto.h 的说明独立计算的结果逐字节相同 (nonce = salt | 小端序号，
+//   附加认证数据 = 置位加密标志后的 16 字节帧头，尾部 = salt | 标签)。
+// 原地加密：按 network_task.c 的 seal_frame() 传入帧缓冲的容量，单声道 40 ms、最长负载和空负载的帧都在帧缓冲内完成，
+//   返回长度等于 audio_frame_payload_len()，帧头只多出加密标志；解密后恢复原帧并清除标志。
+// 认证：帧头、负载、salt、标签任意一位翻转或密钥不同时 payload_crypto_open() 返回 0。重放的帧能通过认证，
+//   须由接收端按序号拒绝。已加密的帧不再加密，容量不足、未加密或过短的帧不处理，帧内容不变。
+// nonce：不同 salt (重启) 的同序号帧、同 salt 的不同序号帧密文不同。
+// FEC：已加密帧的校验包恢复出的帧通过认证并解密为原帧；校验包损坏时恢复出的帧不能通过认证。
+// 开销：每帧加密耗时与同一帧的 MQTT PUBLISH 经 TLS 1.3 / TLS 1.2 (AES-128-GCM，内存 BIO) 发送一条记录的耗时比较，
+//   只报告；主机上的耗时不代表设备上的硬件 AES，设备上的数据见调度统计的 seal_cycles 和 publish_cycles。
+// 门限：以上检查全部成立。
+//
+// 构建 (主机，在仓库根目录)：
+//   cc -O2 -DAUDIO_PAYLOAD_ENCRYPTION=1 -DMBEDTLS_CHACHAPOLY_C -Isrc -Itools/host/shim -o test_payload_crypto tools/host/test_payload_crypto.c src/payload_crypto.c src/fec.c tools/host/shim/mbedtls_shim.c -lssl -lcrypto
+// 运行：
+//   ./test_payload_crypto     # 任一项超出门限时返回 1
+
+#include "payload_crypto.h"
+#include "audio_task.h"
+#include "byte_order.h"
+#include "fec.h"
+#include <openssl/evp.h>
+#include <openssl/ssl.h>
+#include <openssl/x509.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#if (AUDIO_PAYLOAD_ENCRYPTION == 0) || !defined(MBEDTLS_CHACHAPOLY_C)
+#error "build with -DAUDIO_PAYLOAD_ENCRYPTION=1 -DMBEDTLS_CHACHAPOLY_C"
+#endif
+
+#define TEST_FRAME_SAMPLES      (AUDIO_MAX_OUTPUT_SAMPLE_RATE * AUDIO_FRAME_DURATION_MS / 1000u)   // 40 ms 单声道
+#define TEST_FEC_GROUP          (4u)
+#define TEST_BENCH_FRAMES       (200000u)
+#define TEST_CLIENT_ID          MQTT_CLIENT_ID_PREFIX "-000000"
+
+static const uint8_t test_key[PAYLOAD_CRYPTO_KEY_SIZE] = AUDIO_PAYLOAD_KEY;
+static const uint8_t test_salt[PAYLOAD_CRYPTO_SALT_SIZE] = { 0xa0, 0xa1, 0xa2, 0xa3, 0xa4, 0xa5, 0xa6, 0xa7 };
+static const uint8_t other_salt[PAYLOAD_CRYPTO_SALT_SIZE] = { 0xb0, 0xb1, 0xb2, 0xb3, 0xb4, 0xb5, 0xb6, 0xb7 };
+static const char *const cipher_names[] = { "", "AES-256-GCM", "ChaCha20-Poly1305" };
+
+static audio_data_t frames[TEST_FEC_GROUP];
+static audio_data_t original;
+static audio_data_t scratch;
+static unsigned int seed = 1u;
+
+#define FRAME_CAPACITY          (sizeof(audio_data_t) - offsetof(audio_data_t, header))
+
+static uint8_t *packet_of(audio_data_t *frame) {
+    return (uint8_t *)&frame->header;
+}
+
+static void make_frame(audio_data_t *frame, uint32_t sequence, uint16_t num_samples) {
+    memset(frame, 0, sizeof(*frame));
+    frame->header.version = AUDIO_FRAME_HEADER_VERSION;
+    frame->header.channels = 1;
+    frame->header.format = AUDIO_FRAME_FORMAT_PCM_S16LE;
+    frame->header.sample_rate_hz = AUDIO_SAMPLE_RATE;
+    frame->header.num_samples = num_samples;
+    frame->header.sequence = sequence;
+    frame->header.timestamp_ms = sequence * AUDIO_FRAME_DURATION_MS;
+    for (size_t i = 0; i < num_samples; i++) {
+        frame->samples[i] = (int16_t)rand_r(&seed);
+    }
+}
+
+static int hex_to_bytes(const char *hex, uint8_t *out) {
+    int n = 0;
+    for (; hex[0] != '\0' && hex[1] != '\0'; hex += 2) {
+        unsigned int byte;
+        sscanf(hex, "%2x", &byte);
+        out[n++] = (uint8_t)byte;
+    }
+    return n;
+}
+
+// ---- 算法替身的已知答案 ----
+
+static bool check_known_answers(void) {
+    uint8_t key[32];
+    uint8_t iv[12];
+    uint8_t aad[16];
+    uint8_t plain[128];
+    uint8_t out[128];
+    uint8_t tag[16];
+    uint8_t expected[128];
+    uint8_t expected_tag[16];
+
+    // GCM 规范测试用例 14：K = 0^256，IV = 0^96，P = 0^128
+    memset(key, 0, sizeof(key));
+    memset(iv, 0, sizeof(iv));
+    memset(plain, 0, 16);
+    mbedtls_gcm_context gcm;
+    mbedtls_gcm_init(&gcm);
+    bool gcm_ok = mbedtls_gcm_setkey(&gcm, MBEDTLS_CIPHER_ID_AES, key, 256) == 0 &&
+                  mbedtls_gcm_crypt_and_tag(&gcm, MBEDTLS_GCM_ENCRYPT, 16, iv, 12, NULL, 0, plain, out, 16, tag) == 0;
+    hex_to_bytes("cea7403d4d606b6e074ec5d3baf39d18", expected);
+    hex_to_bytes("d0d1c8a799996bf0265b98b5d48ab919", expected_tag);
+    gcm_ok = gcm_ok && memcmp(out, expected, 16) == 0 && memcmp(tag, expected_tag, 16) == 0;
+    mbedtls_gcm_free(&gcm);
+
+    // RFC 8439 2.8.2 节
+    static const char sunscreen[] = "Ladies and Gentlemen of the class of '99: If I could offer you only one tip for "
+                                    "the future, sunscreen would be it.";
+    hex_to_bytes("808182838485868788898a8b8c8d8e8f909192939495969798999a9b9c9d9e9f", key);
+    hex_to_bytes("070000004041424344454647", iv);
+    int aad_len = hex_to_bytes("50515253c0c1c2c3c4c5c6c7", aad);
+    hex_to_bytes("1ae10b594f09e26a7e902ecbd0600691", expected_tag);
+    hex_to_bytes("d31a8d34648e60db7b86afbc53ef7ec2", expected);
+    mbedtls_chachapoly_context chachapoly;
+    mbedtls_chachapoly_init(&chachapoly);
+    size_t len = sizeof(sunscreen) - 1u;
+    bool chacha_ok = mbedtls_chachapoly_setkey(&chachapoly, key) == 0 &&
+                     mbedtls_chachapoly_encrypt_and_tag(&chachapoly, len, iv, aad, (size_t)aad_len,
+                                                        (const uint8_t *)sunscreen, out, tag) == 0;
+    chacha_ok = chacha_ok && memcmp(out, expected, 16) == 0 && memcmp(tag, expected_tag, 16) == 0;
+    mbedtls_chachapoly_free(&chachapoly);
+
+    printf("cipher shim known answers: GCM test case 14 %s, RFC 8439 2.8.2 %s\n", gcm_ok ? "ok" : "FAIL",
+           chacha_ok ? "ok" : "FAIL");
+    return gcm_ok && chacha_ok;
+}
+
+// ---- 线上格式和原地加密 ----
+
+// 按 payload_crypto.h 的格式说明独立计算加密后的帧
+static size_t reference_seal(uint8_t cipher, const uint8_t *packet, size_t packet_len, uint8_t *out) {
+    memcpy(out, packet, packet_len);
+    out[1] |= PAYLOAD_CRYPTO_FLAG;
+    uint8_t nonce[PAYLOAD_CRYPTO_NONCE_SIZE];
+    memcpy(nonce, test_salt, PAYLOAD_CRYPTO_SALT_SIZE);
+    put_le32(&nonce[PAYLOAD_CRYPTO_SALT_SIZE], get_le32(&packet[8]));
+    EVP_CIPHER_CTX *ctx = EVP_CIPHER_CTX_new();
+    const EVP_CIPHER *evp = (cipher == PAYLOAD_CRYPTO_CIPHER_AES_GCM) ? EVP_aes_256_gcm() : EVP_chacha20_poly1305();
+    int n;
+    size_t payload_len = packet_len - PAYLOAD_CRYPTO_HEADER_SIZE;
+    uint8_t *trailer = &out[packet_len];
+    bool ok = EVP_EncryptInit_ex(ctx, evp, NULL, test_key, nonce) == 1 &&
+              EVP_EncryptUpdate(ctx, NULL, &n, out, PAYLOAD_CRYPTO_HEADER_SIZE) == 1 &&
+              (payload_len == 0 || EVP_EncryptUpdate(ctx, &out[PAYLOAD_CRYPTO_HEADER_SIZE], &n,
+                                                     &packet[PAYLOAD_CRYPTO_HEADER_SIZE], (int)payload_len) == 1) &&
+              EVP_EncryptFinal_ex(ctx, trailer, &n) == 1 &&
+              EVP_CIPHER_CTX_ctrl(ctx, EVP_CTRL_AEAD_GET_TAG, PAYLOAD_CRYPTO_TAG_SIZE,
+                                  &trailer[PAYLOAD_CRYPTO_SALT_SIZE]) == 1;
+    memcpy(trailer, test_salt, PAYLOAD_CRYPTO_SALT_SIZE);
+    EVP_CIPHER_CTX_free(ctx);
+    return ok ? packet_len + PAYLOAD_CRYPTO_TRAILER_SIZE : 0;
+}
+
+static bool check_round_trip(payload_crypto_t *ctx, uint8_t cipher, uint16_t num_samples, const char *what) {
+    static uint8_t expected[sizeof(audio_data_t)];
+    make_frame(&scratch, 1000u + num_samples, num_samples);
+    original = scratch;
+    uint8_t *packet = packet_of(&scratch);
+    size_t plain_len = audio_frame_payload_len(&scratch);
+    size_t expected_len = reference_seal(cipher, packet, plain_len, expected);
+
+    size_t sealed_len = payload_crypto_seal(ctx, packet, plain_len, FRAME_CAPACITY);
+    bool format_ok = sealed_len == plain_len + PAYLOAD_CRYPTO_TRAILER_SIZE && sealed_len == expected_len &&
+                     memcmp(packet, expected, sealed_len) == 0;
+    // 帧头只多出加密标志，audio_frame_payload_len() 计入尾部；帧缓冲之外没有写入 (尾部在结构体之内)
+    bool in_place = sealed_len == audio_frame_payload_len(&scratch) && sealed_len <= FRAME_CAPACITY &&
+                    scratch.header.flags == (original.header.flags | AUDIO_FRAME_FLAG_ENCRYPTED) &&
+                    memcmp(&scratch.header.sequence, &original.header.sequence, 8) == 0 &&
+                    memcmp(scratch.transport_headroom, original.transport_headroom, AUDIO_FRAME_HEADROOM) == 0;
+    size_t opened_len = payload_crypto_open(ctx, packet, sealed_len);
+    bool open_ok = opened_len == plain_len && memcmp(packet, packet_of(&original), plain_len) == 0;
+    bool ok = format_ok && in_place && open_ok;
+    printf("%-18s %-26s %5zu -> %5zu B  format %s, in place %s, opens %s  %s\n", cipher_names[cipher], what, plain_len,
+           sealed_len, format_ok ? "ok" : "wrong", in_place ? "ok" : "wrong", open_ok ? "ok" : "wrong",
+           ok ? "ok" : "FAIL");
+    return ok;
+}
+
+// ---- 认证和边界 ----
+
+// 对加密后的帧逐位翻转 [from, to) 中的每一位，每次都须被拒绝
+static unsigned int count_accepted_flips(payload_crypto_t *ctx, const uint8_t *sealed, size_t sealed_len, size_t from,
+                                         size_t to) {
+    unsigned int accepted = 0;
+    uint8_t *packet = packet_of(&scratch);
+    for (size_t byte = from; byte < to; byte++) {
+        for (unsigned int bit = 0; bit < 8; bit++) {
+            memcpy(packet, sealed, sealed_len);
+            packet[byte] ^= (uint8_t)(1u << bit);
+            // 翻转加密标志本身使帧看起来未加密，同样不能被接受
+            accepted += payload_crypto_open(ctx, packet, sealed_len) != 0;
+        }
+    }
+    return accepted;
+}
+
+static bool check_authentication(payload_crypto_t *ctx, uint8_t cipher) {
+    static uint8_t sealed[sizeof(audio_data_t)];
+    make_frame(&scratch, 77u, TEST_FRAME_SAMPLES);
+    uint8_t *packet = packet_of(&scratch);
+    size_t plain_len = audio_frame_payload_len(&scratch);
+    size_t sealed_len = payload_crypto_seal(ctx, packet, plain_len, FRAME_CAPACITY);
+    memcpy(sealed, packet, sealed_len);
+    size_t payload_end = sealed_len - PAYLOAD_CRYPTO_TRAILER_SIZE;
+
+    unsigned int header = count_accepted_flips(ctx, sealed, sealed_len, 0, PAYLOAD_CRYPTO_HEADER_SIZE);
+    // 负载抽查开头、中间和结尾各 16 字节
+    unsigned int payload = count_accepted_flips(ctx, sealed, sealed_len, PAYLOAD_CRYPTO_HEADER_SIZE,
+                                                PAYLOAD_CRYPTO_HEADER_SIZE + 16u);
+    payload += count_accepted_flips(ctx, sealed, sealed_len, payload_end / 2u, payload_end / 2u + 16u);
+    payload += count_accepted_flips(ctx, sealed, sealed_len, payload_end - 16u, payload_end);
+    unsigned int trailer = count_accepted_flips(ctx, sealed, sealed_len, payload_end, sealed_len);
+
+    uint8_t wrong_key[PAYLOAD_CRYPTO_KEY_SIZE];
+    memcpy(wrong_key, test_key, sizeof(wrong_key));
+    wrong_key[31] ^= 1u;
+    payload_crypto_t other;
+    bool key_ok = payload_crypto_init(&other, cipher, wrong_key, NULL);
+    memcpy(packet, sealed, sealed_len);
+    key_ok = key_ok && payload_crypto_open(&other, packet, sealed_len) == 0;
+    payload_crypto_free(&other);
+
+    // 截断的帧 (丢掉标签的最后一个字节) 不能通过认证
+    memcpy(packet, sealed, sealed_len);
+    bool truncated_ok = payload_crypto_open(ctx, packet, sealed_len - 1u) == 0;
+
+    // 重放：同一个加密帧两次都能通过认证，序号去重是接收端的责任
+    memcpy(packet, sealed, sealed_len);
+    bool replay_opens = payload_crypto_open(ctx, packet, sealed_len) == plain_len;
+    memcpy(packet, sealed, sealed_len);
+    replay_opens = replay_opens && payload_crypto_open(ctx, packet, sealed_len) == plain_len;
+
+    bool ok = header == 0 && payload == 0 && trailer == 0 && key_ok && truncated_ok && replay_opens;
+    printf("%-18s bit flips accepted: header %u/128, payload %u/384, salt+tag %u/192; wrong key %s, truncated %s, "
+           "replay %s  %s\n",
+           cipher_names[cipher], header, payload, trailer, key_ok ? "rejected" : "ACCEPTED",
+           truncated_ok ? "rejected" : "ACCEPTED", replay_opens ? "opens (receiver drops by sequence)" : "rejected",
+           ok ? "ok" : "FAIL");
+    return ok;
+}
+
+static bool unchanged_after(size_t result, const audio_data_t *before) {
+    return result == 0 && memcmp(&scratch, before, sizeof(scratch)) == 0;
+}
+
+static bool check_guards(payload_crypto_t *ctx) {
+    make_frame(&scratch, 5u, TEST_FRAME_SAMPLES);
+    uint8_t *packet = packet_of(&scratch);
+    size_t plain_len = audio_frame_payload_len(&scratch);
+    original = scratch;
+
+    bool ok = unchanged_after(payload_crypto_seal(ctx, packet, plain_len, plain_len + PAYLOAD_CRYPTO_TRAILER_SIZE - 1u),
+                              &original);
+    ok &= unchanged_after(payload_crypto_seal(ctx, packet, PAYLOAD_CRYPTO_HEADER_SIZE - 1u, FRAME_CAPACITY), &original);
+    ok &= unchanged_after(payload_crypto_open(ctx, packet, plain_len), &original);
+    size_t sealed_len = payload_crypto_seal(ctx, packet, plain_len, FRAME_CAPACITY);
+    audio_data_t sealed = scratch;
+    ok &= sealed_len != 0 && unchanged_after(payload_crypto_seal(ctx, packet, sealed_len, FRAME_CAPACITY), &sealed);
+    ok &= unchanged_after(payload_crypto_open(ctx, packet, PAYLOAD_CRYPTO_HEADER_SIZE + PAYLOAD_CRYPTO_TRAILER_SIZE - 1u),
+                          &sealed);
+
+    payload_crypto_t unset;
+    ok &= !payload_crypto_init(&unset, 0, test_key, test_salt);
+    ok &= !payload_crypto_init(&unset, 3, test_key, test_salt);
+    ok &= unchanged_after(payload_crypto_seal(&unset, packet, sealed_len, FRAME_CAPACITY), &sealed);
+    ok &= unchanged_after(payload_crypto_open(&unset, packet, sealed_len), &sealed);
+    printf("short capacity, short packet, double seal, clear frame and unset context leave the frame unchanged  %s\n",
+           ok ? "ok" : "FAIL");
+    return ok;
+}
+
+// 同序号不同 salt、同 salt 不同序号的两帧负载相同，密文须不同
+static bool check_nonces(uint8_t cipher) {
+    payload_crypto_t boot1;
+    payload_crypto_t boot2;
+    bool ok = payload_crypto_init(&boot1, cipher, test_key, test_salt) &&
+              payload_crypto_init(&boot2, cipher, test_key, other_salt);
+    static audio_data_t a;
+    static audio_data_t b;
+    make_frame(&a, 9u, TEST_FRAME_SAMPLES);
+    b = a;
+    size_t len = audio_frame_payload_len(&a);
+    ok = ok && payload_crypto_seal(&boot1, packet_of(&a), len, FRAME_CAPACITY) != 0 &&
+         payload_crypto_seal(&boot2, packet_of(&b), len, FRAME_CAPACITY) != 0;
+    bool salt_differs = memcmp(a.samples, b.samples, len - PAYLOAD_CRYPTO_HEADER_SIZE) != 0;
+    make_frame(&a, 9u, TEST_FRAME_SAMPLES);
+    b = a;
+    b.header.sequence = 10u;
+    ok = ok && payload_crypto_seal(&boot1, packet_of(&a), len, FRAME_CAPACITY) != 0 &&
+         payload_crypto_seal(&boot1, packet_of(&b), len, FRAME_CAPACITY) != 0;
+    bool sequence_differs = memcmp(a.samples, b.samples, len - PAYLOAD_CRYPTO_HEADER_SIZE) != 0;
+    payload_crypto_free(&boot1);
+    payload_crypto_free(&boot2);
+    ok = ok && salt_differs && sequence_differs;
+    printf("%-18s same sequence after reboot %s, next sequence %s  %s\n", cipher_names[cipher],
+           salt_differs ? "differs" : "SAME", sequence_differs ? "differs" : "SAME", ok ? "ok" : "FAIL");
+    return ok;
+}
+
+// ---- FEC ----
+
+static bool check_fec(payload_crypto_t *ctx) {
+    static uint8_t parity_buffer[FEC_PARITY_BUFFER_SIZE(sizeof(audio_data_t))];
+    static uint8_t recovered[FEC_PARITY_BUFFER_SIZE(sizeof(audio_data_t))];
+    static audio_data_t plain[TEST_FEC_GROUP];
+    fec_encoder_t enc;
+    fec_encoder_init(&enc, parity_buffer, sizeof(parity_buffer), TEST_FEC_GROUP);
+    const uint8_t *packets[TEST_FEC_GROUP];
+    size_t lens[TEST_FEC_GROUP];
+    size_t parity_len = 0;
+    // 组内帧长不同 (码率档位切换)，按 publish_live_frame() 的顺序：先加密，再累加校验
+    for (uint32_t i = 0; i < TEST_FEC_GROUP; i++) {
+        make_frame(&frames[i], 400u + i, (uint16_t)(TEST_FRAME_SAMPLES / (1u + (i & 1u))));
+        plain[i] = frames[i];
+        lens[i] = payload_crypto_seal(ctx, packet_of(&frames[i]), audio_frame_payload_len(&frames[i]), FRAME_CAPACITY);
+        packets[i] = packet_of(&frames[i]);
+        parity_len = fec_encoder_add(&enc, packets[i], lens[i]);
+    }
+    unsigned int recovered_ok = 0;
+    for (uint32_t lost = 0; lost < TEST_FEC_GROUP; lost++) {
+        const uint8_t *view[TEST_FEC_GROUP];
+        memcpy(view, packets, sizeof(view));
+        view[lost] = NULL;
+        size_t len = fec_recover(parity_buffer, parity_len, view, lens, recovered, sizeof(recovered));
+        size_t plain_len = audio_frame_payload_len(&plain[lost]);
+        recovered_ok += len == lens[lost] && payload_crypto_open(ctx, recovered, len) == plain_len &&
+                        memcmp(recovered, packet_of(&plain[lost]), plain_len) == 0;
+    }
+    // 校验包负载中的一个字节损坏：恢复出的帧不能通过认证
+    const uint8_t *view[TEST_FEC_GROUP];
+    memcpy(view, packets, sizeof(view));
+    view[1] = NULL;
+    parity_buffer[FEC_HEADER_SIZE + FEC_LENGTH_PREFIX_SIZE + 100u] ^= 0x40u;
+    size_t len = fec_recover(parity_buffer, parity_len, view, lens, recovered, sizeof(recovered));
+    bool corrupt_rejected = len != 0 && payload_crypto_open(ctx, recovered, len) == 0;
+    bool ok = parity_len != 0 && recovered_ok == TEST_FEC_GROUP && corrupt_rejected;
+    printf("FEC over sealed frames: %u/%u recovered frames authenticate and decrypt, corrupted parity %s  %s\n",
+           recovered_ok, (unsigned int)TEST_FEC_GROUP, corrupt_rejected ? "rejected" : "ACCEPTED", ok ? "ok" : "FAIL");
+    return ok;
+}
+
+// ---- 开销：逐帧 AEAD 与 TLS 记录 ----
+
+static double now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec * 1e9 + (double)ts.tv_nsec;
+}
+
+static double bench_seal(uint8_t cipher, size_t *overhead) {
+    payload_crypto_t ctx;
+    payload_crypto_init(&ctx, cipher, test_key, test_salt);
+    make_frame(&scratch, 0, TEST_FRAME_SAMPLES);
+    uint8_t *packet = packet_of(&scratch);
+    size_t plain_len = audio_frame_payload_len(&scratch);
+    size_t sealed_len = 0;
+    double start = now_ns();
+    for (uint32_t i = 0; i < TEST_BENCH_FRAMES; i++) {
+        // 每帧新序号，加密标志清除后再加密 (负载保持密文，不影响耗时)
+        scratch.header.sequence = i;
+        scratch.header.flags = 0;
+        sealed_len = payload_crypto_seal(&ctx, packet, plain_len, FRAME_CAPACITY);
+    }
+    double ns = (now_ns() - start) / TEST_BENCH_FRAMES;
+    payload_crypto_free(&ctx);
+    *overhead = sealed_len - plain_len;
+    return ns;
+}
+
+// 一帧 MQTT PUBLISH 经 TLS 发送 (SSL_write 加读出记录) 的耗时，TLS 两端经内存 BIO 连接
+static double bench_tls(int version, size_t publish_len, size_t *overhead) {
+    EVP_PKEY *key = EVP_EC_gen("P-256");
+    X509 *cert = X509_new();
+    X509_set_version(cert, 2);
+    X509_gmtime_adj(X509_getm_notBefore(cert), -3600);
+    X509_gmtime_adj(X509_getm_notAfter(cert), 3600);
+    X509_set_pubkey(cert, key);
+    X509_sign(cert, key, EVP_sha256());
+    SSL_CTX *sctx = SSL_CTX_new(TLS_server_method());
+    SSL_CTX_use_certificate(sctx, cert);
+    SSL_CTX_use_PrivateKey(sctx, key);
+    SSL_CTX *cctx = SSL_CTX_new(TLS_client_method());
+    SSL_CTX_set_min_proto_version(cctx, version);
+    SSL_CTX_set_max_proto_version(cctx, version);
+    SSL_CTX_set_ciphersuites(cctx, "TLS_AES_128_GCM_SHA256");
+    SSL_CTX_set_cipher_list(cctx, "ECDHE-ECDSA-AES128-GCM-SHA256");
+    SSL *client = SSL_new(cctx);
+    SSL *server = SSL_new(sctx);
+    BIO *client_end = NULL;
+    BIO *server_end = NULL;
+    BIO_new_bio_pair(&client_end, 1u << 16, &server_end, 1u << 16);
+    SSL_set_bio(client, client_end, client_end);
+    SSL_set_bio(server, server_end, server_end);
+    SSL_set_connect_state(client);
+    SSL_set_accept_state(server);
+    int rc_client = 0;
+    int rc_server = 0;
+    for (int i = 0; i < 20 && (rc_client != 1 || rc_server != 1); i++) {
+        rc_client = SSL_do_handshake(client);
+        rc_server = SSL_do_handshake(server);
+    }
+    double ns = -1.0;
+    if (rc_client == 1 && rc_server == 1) {
+        uint8_t *publish = calloc(publish_len, 1);
+        static uint8_t sink[1u << 16];
+        size_t wire = 0;
+        double start = now_ns();
+        for (uint32_t i = 0; i < TEST_BENCH_FRAMES; i++) {
+            SSL_write(client, publish, (int)publish_len);
+            // 服务端一侧只取走密文，不解密
+            int n;
+            wire = 0;
+            while ((n = BIO_read(server_end, sink, sizeof(sink))) > 0) {
+                wire += (size_t)n;
+            }
+        }
+        ns = (now_ns() - start) / TEST_BENCH_FRAMES;
+        *overhead = wire - publish_len;
+        free(publish);
+    }
+    SSL_free(client);
+    SSL_free(server);
+    SSL_CTX_free(cctx);
+    SSL_CTX_free(sctx);
+    X509_free(cert);
+    EVP_PKEY_free(key);
+    return ns;
+}
+
+static bool check_cost(void) {
+    make_frame(&scratch, 0, TEST_FRAME_SAMPLES);
+    size_t frame_len = audio_frame_payload_len(&scratch);
+    size_t remaining = 2u + strlen(MQTT_TOPIC_AUDIO_STREAM "/" TEST_CLIENT_ID) + frame_len;
+    size_t publish_len = 1u + ((remaining < 128u) ? 1u : (remaining < 16384u) ? 2u : 3u) + remaining;
+    size_t gcm_overhead = 0;
+    size_t chacha_overhead = 0;
+    size_t tls13_overhead = 0;
+    size_t tls12_overhead = 0;
+    double gcm_ns = bench_seal(PAYLOAD_CRYPTO_CIPHER_AES_GCM, &gcm_overhead);
+    double chacha_ns = bench_seal(PAYLOAD_CRYPTO_CIPHER_CHACHAPOLY, &chacha_overhead);
+    double tls13_ns = bench_tls(TLS1_3_VERSION, publish_len, &tls13_overhead);
+    double tls12_ns = bench_tls(TLS1_2_VERSION, publish_len, &tls12_overhead);
+    printf("per 40 ms frame (%zu B frame, %zu B PUBLISH), host:\n", frame_len, publish_len);
+    printf("  seal AES-256-GCM         %6.0f ns  %5.2f ns/B  +%zu B\n", gcm_ns, gcm_ns / (double)frame_len, gcm_overhead);
+    printf("  seal ChaCha20-Poly1305   %6.0f ns  %5.2f ns/B  +%zu B\n", chacha_ns, chacha_ns / (double)frame_len,
+           chacha_overhead);
+    printf("  TLS 1.3 record (AES-128) %6.0f ns  %5.2f ns/B  +%zu B\n", tls13_ns, tls13_ns / (double)publish_len,
+           tls13_overhead);
+    printf("  TLS 1.2 record (AES-128) %6.0f ns  %5.2f ns/B  +%zu B\n", tls12_ns, tls12_ns / (double)publish_len,
+           tls12_overhead);
+    bool ok = gcm_ns > 0 && chacha_ns > 0 && tls13_ns > 0 && tls12_ns > 0 && gcm_overhead == PAYLOAD_CRYPTO_TRAILER_SIZE;
+    printf("cost measured (report only)  %s\n", ok ? "ok" : "FAIL");
+    return ok;
+}
+
+int main(void) {
+    bool ok = check_known_answers();
+    static const uint8_t ciphers[] = { PAYLOAD_CRYPTO_CIPHER_AES_GCM, PAYLOAD_CRYPTO_CIPHER_CHACHAPOLY };
+    for (size_t c = 0; c < sizeof(ciphers) / sizeof(ciphers[0]); c++) {
+        payload_crypto_t ctx;
+        if (!payload_crypto_init(&ctx, ciphers[c], test_key, test_salt)) {
+            printf("%s init  FAIL\n", cipher_names[ciphers[c]]);
+            return 1;
+        }
+        ok &= check_round_trip(&ctx, ciphers[c], TEST_FRAME_SAMPLES, "40 ms mono");
+        ok &= check_round_trip(&ctx, ciphers[c], AUDIO_SAMPLES_PER_FRAME * AUDIO_CHANNELS, "longest payload");
+        ok &= check_round_trip(&ctx, ciphers[c], 0, "empty payload");
+        ok &= check_authentication(&ctx, ciphers[c]);
+        ok &= check_nonces(ciphers[c]);
+        if (c == 0) {
+            ok &= check_guards(&ctx);
+            ok &= check_fec(&ctx);
+        }
+        payload_crypto_free(&ctx);
+    }
+    ok &= check_cost();
+    printf("%s\n", ok ? "all checks passed" : "FAILED");
+    return ok ? 0 : 1;
+}
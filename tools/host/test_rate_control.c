@@ -0,0 +1,244 @@
+// rate_control.c 的主机检查：按毫秒推进的离散时间模拟，链路带宽按阶段变化，统计档位切换、丢帧和队列深度。
+// 模型：音频任务每 AUDIO_FRAME_DURATION_MS 按当前档位 (在帧边界生效的采样率和格式) 生成一帧放入 audio_queue
+// (容量 AUDIO_QUEUE_LENGTH，满时丢帧)；网络任务逐帧发布，报文先写入 TEST_SEND_BUFFER 字节的发送缓冲，
+// 缓冲满时发布阻塞，发布耗时和字节数交给 rate_control_on_publish()；发送缓冲按当前链路带宽排空。
+// 每一毫秒调用一次 rate_control_update(0) (QoS0，没有在途窗口)，它自己按 RATE_CONTROL_INTERVAL_MS 取周期。
+// 用 tools/host/shim/ 中的 FreeRTOS 替身编译，节拍手动推进。
+// 门限：带宽下降到当前档位以下后 TEST_MAX_DOWNGRADE_S 秒内降到能承载的档位，之后该阶段不再丢帧，
+// 试探升档造成的队列深度不超过 TEST_MAX_QUEUE_FRAMES；带宽恢复后 TEST_MAX_UPGRADE_S 秒内回到 PCM 全采样率；
+// 每个阶段的切换次数不超过每 RATE_CONTROL_UPGRADE_HOLD_MAX_MS 一次试探；接收端报告丢包达到 RATE_CONTROL_LOSS_PCT 时降档。
+//
+// 构建 (主机，在仓库根目录)：
+//   cc -O2 -Isrc -Itools/host/shim -o test_rate_control tools/host/test_rate_control.c src/rate_control.c tools/host/shim/freertos_shim.c
+// 运行：
+//   ./test_rate_control       # 任一项超出门限时返回 1
+
+#include "rate_control.h"
+#include "audio_task.h"
+#include "app_config.h"
+#include "task.h"
+#include <stdio.h>
+#include <string.h>
+
+#define TEST_SEND_BUFFER        (8192u)     // 发送缓冲 (字节)，与 lwIP 的 TCP_SND_BUF 同一量级
+#define TEST_PUBLISH_OVERHEAD   (32u)       // 每帧的 PUBLISH 报头 (主题 "audio/stream/<客户端 ID>")
+#define TEST_MAX_DOWNGRADE_S    (4u)
+// 恢复：最后一次试探失败后等待时间可能已加倍到上限，第一级升档等满上限，第二级等新档位被确认稳定，再加两个切换后的周期
+#define TEST_MAX_UPGRADE_S      ((RATE_CONTROL_UPGRADE_HOLD_MAX_MS + RATE_CONTROL_UPGRADE_STABLE_MS) / 1000u + 5u)
+#define TEST_MAX_QUEUE_FRAMES   (15u)       // 处于能承载的档位后，试探升档造成的队列深度上限 (600 ms)
+
+typedef struct {
+    const char *name;
+    uint32_t seconds;
+    uint32_t kbps;
+} link_phase_t;
+
+// 带宽阶段：干净 -> 拥塞到只够降采样 PCM -> 只够特征 -> 低于最低档 -> 恢复 -> 卡在两档之间
+static const link_phase_t phases[] = {
+    { "clean 1000 kbit/s", 60, 1000 },
+    { "congested 200 kbit/s", 60, 200 },
+    { "congested 100 kbit/s", 60, 100 },
+    { "below lowest tier 50 kbit/s", 30, 50 },
+    { "recovered 1000 kbit/s", 60, 1000 },
+    { "between tiers 240 kbit/s", 300, 240 },
+};
+
+QueueHandle_t audio_queue = NULL;
+static StaticQueue_t audio_queue_struct;
+static uint8_t audio_queue_storage[AUDIO_QUEUE_LENGTH * sizeof(uint32_t)];
+
+// 音频任务侧：请求的采样率和格式在下一帧边界生效
+static uint32_t requested_rate = AUDIO_MAX_OUTPUT_SAMPLE_RATE;
+static uint8_t requested_format = AUDIO_FRAME_FORMAT_PCM_S16LE;
+
+bool audio_set_output_sample_rate(uint32_t sample_rate_hz) {
+    requested_rate = sample_rate_hz;
+    return true;
+}
+
+bool audio_set_stream_format(uint8_t format) {
+    requested_format = format;
+    return true;
+}
+
+uint32_t audio_get_frame_duration_ms(void) {
+    return AUDIO_FRAME_DURATION_MS;
+}
+
+static uint32_t frame_bytes(void) {
+    uint32_t payload = (requested_format == AUDIO_FRAME_FORMAT_LOGMEL_U8)
+                           ? (AUDIO_FRAME_DURATION_MS / LOG_MEL_HOP_MS) * LOG_MEL_BANDS
+                           : requested_rate * AUDIO_FRAME_DURATION_MS / 1000u * AUDIO_CHANNELS * (AUDIO_BIT_RESOLUTION / 8);
+    return (uint32_t)sizeof(audio_frame_header_t) + payload + TEST_PUBLISH_OVERHEAD;
+}
+
+// 档位的线上码率 (kbit/s)，用于判断当前档位能否被链路承载
+static uint32_t tier_kbps(rate_tier_t tier) {
+    uint32_t saved_rate = requested_rate;
+    uint8_t saved_format = requested_format;
+    requested_rate = (tier == RATE_TIER_PCM_REDUCED) ? AUDIO_RATE_CONTROL_REDUCED_SAMPLE_RATE : AUDIO_MAX_OUTPUT_SAMPLE_RATE;
+    requested_format = (tier == RATE_TIER_FEATURES) ? AUDIO_FRAME_FORMAT_LOGMEL_U8 : AUDIO_FRAME_FORMAT_PCM_S16LE;
+    uint32_t kbps = frame_bytes() * 8u / AUDIO_FRAME_DURATION_MS;
+    requested_rate = saved_rate;
+    requested_format = saved_format;
+    return kbps;
+}
+
+typedef struct {
+    uint32_t produced;
+    uint32_t dropped;
+    uint32_t dropped_after_settle;  // 档位已能被链路承载之后的丢帧
+    uint32_t queue_max;
+    uint32_t queue_max_after_fit;
+    uint32_t switches;
+    uint32_t tier_ms[RATE_TIER_COUNT];
+    int32_t fit_after_ms;           // 第一次处于能承载的最高档 (恢复阶段) 或能承载的档位 (下降阶段) 的时间，-1 表示没有
+} phase_result_t;
+
+// 链路与网络任务的状态
+static uint32_t send_buffer;        // 发送缓冲中的字节
+static uint64_t drain_credit;       // 链路排空的累计比特 (千分之一字节精度)
+static uint32_t publish_remaining;  // 当前发布还没写入发送缓冲的字节，0 表示空闲
+static uint32_t publish_bytes;
+static TickType_t publish_start;
+
+static void run_phase(const link_phase_t *phase, phase_result_t *r, TickType_t *now) {
+    memset(r, 0, sizeof(*r));
+    r->fit_after_ms = -1;
+    rate_control_stats_t stats;
+    rate_control_get_stats(&stats);
+    rate_tier_t last_tier = stats.tier;
+
+    // 能承载的最高档：线上码率不超过带宽
+    rate_tier_t best = RATE_TIER_COUNT;
+    for (int t = RATE_TIER_PCM_FULL; t < RATE_TIER_COUNT; t++) {
+        if (tier_kbps((rate_tier_t)t) <= phase->kbps) {
+            best = (rate_tier_t)t;
+            break;
+        }
+    }
+    bool recovering = phase->kbps >= tier_kbps(RATE_TIER_PCM_FULL) * 2u;
+
+    for (uint32_t ms = 0; ms < phase->seconds * 1000u; ms++, (*now)++) {
+        shim_tick_count = *now;
+
+        // 音频任务：帧边界按请求的档位生成一帧
+        if (*now % AUDIO_FRAME_DURATION_MS == 0) {
+            uint32_t bytes = frame_bytes();
+            r->produced++;
+            if (xQueueSend(audio_queue, &bytes, 0) != pdPASS) {
+                r->dropped++;
+                r->dropped_after_settle += (r->fit_after_ms >= 0);
+            }
+        }
+
+        // 网络任务：空闲时取下一帧发布，报文写入发送缓冲，缓冲满时阻塞
+        if (publish_remaining == 0 && xQueueReceive(audio_queue, &publish_bytes, 0) == pdPASS) {
+            publish_remaining = publish_bytes;
+            publish_start = *now;
+        }
+        if (publish_remaining > 0) {
+            uint32_t space = TEST_SEND_BUFFER - send_buffer;
+            uint32_t n = (publish_remaining < space) ? publish_remaining : space;
+            send_buffer += n;
+            publish_remaining -= n;
+            if (publish_remaining == 0) {
+                rate_control_on_publish(publish_bytes, *now - publish_start);
+            }
+        }
+
+        // 链路按当前带宽排空发送缓冲 (每毫秒 kbps 比特)
+        drain_credit += phase->kbps;
+        uint32_t drained = (uint32_t)(drain_credit / 8u);
+        if (drained > send_buffer) {
+            drained = send_buffer;
+            drain_credit = 0;
+        } else {
+            drain_credit -= (uint64_t)drained * 8u;
+        }
+        send_buffer -= drained;
+
+        rate_control_update(0);
+
+        rate_control_get_stats(&stats);
+        uint32_t depth = (uint32_t)uxQueueMessagesWaiting(audio_queue);
+        if (depth > r->queue_max) {
+            r->queue_max = depth;
+        }
+        if (r->fit_after_ms >= 0 && depth > r->queue_max_after_fit) {
+            r->queue_max_after_fit = depth;
+        }
+        r->tier_ms[stats.tier]++;
+        if (stats.tier != last_tier) {
+            r->switches++;
+            last_tier = stats.tier;
+        }
+        if (r->fit_after_ms < 0 && best != RATE_TIER_COUNT &&
+            (recovering ? stats.tier == RATE_TIER_PCM_FULL : stats.tier >= best)) {
+            r->fit_after_ms = (int32_t)ms;
+        }
+    }
+}
+
+static bool check_loss_report(TickType_t *now) {
+    // 带宽充足但接收端 (UDP) 报告丢包：发送不阻塞，只能靠丢包报告降档
+    rate_control_init();
+    rate_control_set_enabled(true);
+    for (uint32_t ms = 0; ms < 3000u; ms++, (*now)++) {
+        shim_tick_count = *now;
+        if (*now % AUDIO_FRAME_DURATION_MS == 0) {
+            rate_control_on_publish(frame_bytes(), 0);
+        }
+        if (ms >= 2000u) {
+            rate_control_report_loss(RATE_CONTROL_LOSS_PCT * 2u);
+        }
+        rate_control_update(0);
+    }
+    rate_control_stats_t stats;
+    rate_control_get_stats(&stats);
+    bool pass = stats.tier == RATE_TIER_PCM_REDUCED && stats.downgrades == 1;
+    printf("receiver loss report of %u%% without blocking: downgrade to tier %d  %s\n",
+           (unsigned int)(RATE_CONTROL_LOSS_PCT * 2u), (int)stats.tier, pass ? "ok" : "FAIL");
+    return pass;
+}
+
+int main(void) {
+    bool ok = true;
+    shim_manual_ticks = true;
+    TickType_t now = 1;
+    shim_tick_count = now;
+    audio_queue = xQueueCreateStatic(AUDIO_QUEUE_LENGTH, sizeof(uint32_t), audio_queue_storage, &audio_queue_struct);
+
+    printf("tiers on the wire (%u ms frames, %u channel(s)): full %u, reduced %u, features %u kbit/s; "
+           "send buffer %u bytes, queue %u frames\n", (unsigned int)AUDIO_FRAME_DURATION_MS, (unsigned int)AUDIO_CHANNELS,
+           (unsigned int)tier_kbps(RATE_TIER_PCM_FULL), (unsigned int)tier_kbps(RATE_TIER_PCM_REDUCED),
+           (unsigned int)tier_kbps(RATE_TIER_FEATURES), (unsigned int)TEST_SEND_BUFFER, (unsigned int)AUDIO_QUEUE_LENGTH);
+
+    rate_control_init();
+    rate_control_set_enabled(true);
+    for (size_t i = 0; i < sizeof(phases) / sizeof(phases[0]); i++) {
+        const link_phase_t *phase = &phases[i];
+        phase_result_t r;
+        run_phase(phase, &r, &now);
+        // 试探升档的间隔最短为等待上限，每次试探失败是一次升档和一次降档
+        uint32_t max_switches = 2u * (phase->seconds * 1000u / RATE_CONTROL_UPGRADE_HOLD_MAX_MS + 3u);
+        bool pass = r.switches <= max_switches;
+        if (phase->kbps >= tier_kbps(RATE_TIER_FEATURES)) {
+            uint32_t limit_s = (phase->kbps >= tier_kbps(RATE_TIER_PCM_FULL) * 2u) ? TEST_MAX_UPGRADE_S : TEST_MAX_DOWNGRADE_S;
+            pass = pass && r.fit_after_ms >= 0 && (uint32_t)r.fit_after_ms <= limit_s * 1000u &&
+                   r.dropped_after_settle == 0 && r.queue_max_after_fit <= TEST_MAX_QUEUE_FRAMES;
+        }
+        printf("%-28s fits after %5.1f s, %u switches, time in full/reduced/features %u/%u/%u s, "
+               "dropped %u/%u (%u after fitting), queue max %u (%u after fitting)  %s\n",
+               phase->name, r.fit_after_ms >= 0 ? r.fit_after_ms / 1000.0 : -1.0, (unsigned int)r.switches,
+               (unsigned int)(r.tier_ms[0] / 1000u), (unsigned int)(r.tier_ms[1] / 1000u),
+               (unsigned int)(r.tier_ms[2] / 1000u), (unsigned int)r.dropped, (unsigned int)r.produced,
+               (unsigned int)r.dropped_after_settle, (unsigned int)r.queue_max,
+               (unsigned int)r.queue_max_after_fit, pass ? "ok" : "FAIL");
+        ok &= pass;
+    }
+
+    ok &= check_loss_report(&now);
+    printf("%s\n", ok ? "all checks passed" : "FAILED");
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,273 @@
+// resampler.c 的主机检查：对固件用到的采样率比测量通带增益、混叠抑制，并确认分块处理与一次性处理的输出逐样本一致。
+// 用单频正弦 (半满幅) 作输入，跳过滤波器的起始暂态后，以同频正弦/余弦投影求输出幅度；
+// 混叠按输出中全部能量相对输入幅度计算 (输入频率高于输出奈奎斯特频率时，输出中只有混叠和量化噪声)。
+// 另外对 48k 采集的三个输出档位计时：多相实现与同一组系数的直接形式 (补零到 L 倍采样率后逐点滤波、再每 M 点取一点)
+// 比较，两者输出须逐样本相同、多相实现须更快；并与原来直接以输出采样率采集时每帧的一次拷贝对照。
+// 耗时是主机上的，只用于比较实现；目标板上的每帧周期数见 audio_get_pipeline_stats() 的 process_cycles_*。
+//
+// 构建 (主机，在仓库根目录)：
+//   cc -O2 -Isrc -o test_resampler tools/host/test_resampler.c src/resampler.c src/dsp.c -lm
+// 运行：
+//   ./test_resampler          # 任一项超出门限时返回 1
+
+#include "resampler.h"
+#include "dsp.h"
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define TEST_SECONDS            (1)
+#define TEST_AMPLITUDE          (16384.0)
+#define TEST_BLOCK_MS           (20)        // 与默认帧长相同的分块
+#define TEST_SETTLE_SAMPLES     (256)       // 跳过的输出样本 (覆盖滤波器长度)
+#define TEST_PASSBAND_EDGE      (0.70)      // 通带检查到输出奈奎斯特频率的比例
+#define TEST_PASSBAND_TOL_DB    (0.10)
+#define TEST_STOPBAND_EDGE      (1.20)      // 混叠检查的起点 (输出奈奎斯特频率的比例)，混叠落在 0.8 倍以下
+#define TEST_ALIAS_MIN_DB       (65.0)
+#define TEST_MAX_RATE           (48000u)
+#define TEST_TIMING_REPEATS     (50u)       // 计时时重复处理 TEST_SECONDS 秒信号的次数
+#define TEST_TIMING_CHANNELS    (2u)        // 按立体声帧报告
+#define TEST_OLD_RATE           (16000u)    // 加入重采样级之前直接以此采样率采集
+
+typedef struct {
+    uint32_t in_rate;
+    uint32_t out_rate;
+} rate_pair_t;
+
+// 48k 采集到默认输出、降采样档位和回退档位，以及几个其他支持的比
+static const rate_pair_t pairs[] = {
+    { 48000u, 16000u },
+    { 48000u, 8000u },
+    { 48000u, 24000u },
+    { 48000u, 32000u },
+    { 32000u, 16000u },
+    { 16000u, 8000u },
+};
+
+static int16_t input[TEST_MAX_RATE * TEST_SECONDS];
+static int16_t out_blocks[TEST_MAX_RATE * TEST_SECONDS];
+static int16_t out_whole[TEST_MAX_RATE * TEST_SECONDS];
+static int16_t out_direct[TEST_MAX_RATE * TEST_SECONDS];
+static int16_t stuffed[RESAMPLER_MAX_FACTOR * TEST_MAX_RATE * TEST_SECONDS];
+static int16_t direct_full[RESAMPLER_MAX_FACTOR * TEST_MAX_RATE * TEST_SECONDS];
+
+static void make_tone(uint32_t rate, double hz, size_t n) {
+    for (size_t i = 0; i < n; i++) {
+        input[i] = (int16_t)lrint(TEST_AMPLITUDE * sin(2.0 * M_PI * hz * (double)i / rate));
+    }
+}
+
+// 分块处理，顺带检查 resampler_output_count() 的预测
+static size_t run_blocks(resampler_t *rs, size_t n, bool *count_ok) {
+    size_t block = rs->in_rate * TEST_BLOCK_MS / 1000u;
+    size_t produced = 0;
+    resampler_reset(rs);
+    for (size_t pos = 0; pos < n; pos += block) {
+        size_t len = (n - pos < block) ? n - pos : block;
+        size_t expected = resampler_output_count(rs, len);
+        size_t got = resampler_process(rs, &input[pos], len, 1, &out_blocks[produced], 1);
+        if (got != expected) {
+            *count_ok = false;
+        }
+        produced += got;
+    }
+    return produced;
+}
+
+// 输出中 hz 分量的幅度 (dB，相对输入幅度)
+static double tone_gain_db(const int16_t *y, size_t n, uint32_t rate, double hz) {
+    double s = 0.0;
+    double c = 0.0;
+    for (size_t i = TEST_SETTLE_SAMPLES; i < n; i++) {
+        double a = 2.0 * M_PI * hz * (double)i / rate;
+        s += y[i] * sin(a);
+        c += y[i] * cos(a);
+    }
+    double amplitude = 2.0 * sqrt(s * s + c * c) / (double)(n - TEST_SETTLE_SAMPLES);
+    return 20.0 * log10(amplitude / TEST_AMPLITUDE);
+}
+
+// 输出总能量对应的正弦幅度 (dB，相对输入幅度)
+static double total_level_db(const int16_t *y, size_t n) {
+    double sum = 0.0;
+    for (size_t i = TEST_SETTLE_SAMPLES; i < n; i++) {
+        sum += (double)y[i] * y[i];
+    }
+    double amplitude = sqrt(2.0 * sum / (double)(n - TEST_SETTLE_SAMPLES));
+    return 20.0 * log10((amplitude > 0.0 ? amplitude : 1e-3) / TEST_AMPLITUDE);
+}
+
+static bool check_pair(const rate_pair_t *pair) {
+    static resampler_t rs;
+    if (!resampler_init(&rs, pair->in_rate, pair->out_rate)) {
+        printf("%5u -> %5u  not supported\n", (unsigned int)pair->in_rate, (unsigned int)pair->out_rate);
+        return false;
+    }
+    size_t n = pair->in_rate * TEST_SECONDS;
+    double out_nyquist = pair->out_rate / 2.0;
+    double in_nyquist = pair->in_rate / 2.0;
+    bool count_ok = true;
+    bool blocks_ok = true;
+
+    // 通带：输出奈奎斯特频率的 5% ~ TEST_PASSBAND_EDGE，步长 5%
+    double ripple_db = 0.0;
+    for (double ratio = 0.05; ratio <= TEST_PASSBAND_EDGE + 1e-9; ratio += 0.05) {
+        double hz = ratio * out_nyquist;
+        make_tone(pair->in_rate, hz, n);
+        size_t produced = run_blocks(&rs, n, &count_ok);
+        double gain = tone_gain_db(out_blocks, produced, pair->out_rate, hz);
+        if (fabs(gain) > ripple_db) {
+            ripple_db = fabs(gain);
+        }
+
+        // 一次性处理整段信号，须与分块处理逐样本相同
+        resampler_reset(&rs);
+        size_t whole = resampler_process(&rs, input, n, 1, out_whole, 1);
+        if (whole != produced || memcmp(out_whole, out_blocks, produced * sizeof(int16_t)) != 0) {
+            blocks_ok = false;
+        }
+    }
+
+    // 混叠：降采样时输入 TEST_STOPBAND_EDGE x 输出奈奎斯特频率到输入奈奎斯特频率之间的单频，步长 2.5%
+    double worst_alias_db = -200.0;
+    double worst_alias_hz = 0.0;
+    if (pair->out_rate < pair->in_rate) {
+        for (double hz = TEST_STOPBAND_EDGE * out_nyquist; hz < in_nyquist * 0.98; hz += 0.025 * out_nyquist) {
+            make_tone(pair->in_rate, hz, n);
+            size_t produced = run_blocks(&rs, n, &count_ok);
+            double level = total_level_db(out_blocks, produced);
+            if (level > worst_alias_db) {
+                worst_alias_db = level;
+                worst_alias_hz = hz;
+            }
+        }
+    }
+
+    bool ok = count_ok && blocks_ok && ripple_db <= TEST_PASSBAND_TOL_DB &&
+              (pair->out_rate >= pair->in_rate || -worst_alias_db >= TEST_ALIAS_MIN_DB);
+    printf("%5u -> %5u  L/M %u/%u taps %2u  passband ripple %.3f dB", (unsigned int)pair->in_rate,
+           (unsigned int)pair->out_rate, (unsigned int)rs.up, (unsigned int)rs.down, (unsigned int)rs.taps_per_phase,
+           ripple_db);
+    if (pair->out_rate < pair->in_rate) {
+        printf("  alias rejection %.1f dB (worst at %.0f Hz)", -worst_alias_db, worst_alias_hz);
+    }
+    printf("  blocks %s  counts %s  %s\n", blocks_ok ? "match" : "DIFFER", count_ok ? "ok" : "WRONG",
+           ok ? "ok" : "FAIL");
+    return ok;
+}
+
+static double elapsed_ns(const struct timespec *t0, const struct timespec *t1) {
+    return (double)(t1->tv_sec - t0->tv_sec) * 1e9 + (double)(t1->tv_nsec - t0->tv_nsec);
+}
+
+// 直接形式：把输入补零到 L 倍采样率，用完整的原型滤波器 (由多相系数还原) 对每个点滤波，再每 M 点取一点。
+// 乘加的顺序与 resampler_process() 相同，输出逐样本一致，只是多算了补零点的乘积和被丢弃的点。
+static size_t direct_process(const resampler_t *rs, const int16_t *in, size_t in_count, int16_t *out) {
+    const uint32_t up = rs->up;
+    const uint32_t taps = rs->taps_per_phase;
+    const uint32_t proto_len = up * taps;
+    int16_t proto[RESAMPLER_MAX_FACTOR * RESAMPLER_MAX_TAPS_PER_PHASE];
+    for (uint32_t p = 0; p < up; p++) {
+        for (uint32_t k = 0; k < taps; k++) {
+            proto[p + k * up] = rs->coeffs[p * taps + k];
+        }
+    }
+    size_t full_len = in_count * up;
+    memset(stuffed, 0, full_len * sizeof(int16_t));
+    for (size_t i = 0; i < in_count; i++) {
+        stuffed[i * up] = in[i];
+    }
+    for (size_t j = 0; j < full_len; j++) {
+        int32_t acc = 0;
+        uint32_t m_end = (j + 1 < proto_len) ? (uint32_t)j + 1u : proto_len;
+        for (uint32_t m = 0; m < m_end; m++) {
+            acc += (int32_t)proto[m] * (int32_t)stuffed[j - m];
+        }
+        acc = (acc + (1 << 14)) >> 15;
+        direct_full[j] = (int16_t)(acc > INT16_MAX ? INT16_MAX : (acc < INT16_MIN ? INT16_MIN : acc));
+    }
+    size_t produced = 0;
+    for (size_t j = 0; j < full_len; j += rs->down) {
+        out[produced++] = direct_full[j];
+    }
+    return produced;
+}
+
+// 一个 TEST_BLOCK_MS 立体声帧的耗时 (ns)：整段信号处理 repeats 次的总耗时按帧数折算
+static double per_frame_ns(double total_ns, uint32_t repeats, uint32_t frames_per_run) {
+    return total_ns / ((double)repeats * frames_per_run) * TEST_TIMING_CHANNELS;
+}
+
+static bool check_timing(void) {
+    static const uint32_t out_rates[] = { 16000u, 32000u, 8000u };
+    static resampler_t rs;
+    const uint32_t frames = 1000u * TEST_SECONDS / TEST_BLOCK_MS;
+    bool ok = true;
+    struct timespec t0;
+    struct timespec t1;
+
+    // 原来的路径：直接以输出采样率采集，每帧只把交错立体声从 DMA 缓冲拷进队列
+    const size_t old_frame = TEST_OLD_RATE / 1000u * TEST_BLOCK_MS * TEST_TIMING_CHANNELS;
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+    for (uint32_t n = 0; n < TEST_TIMING_REPEATS * frames * 100u; n++) {
+        memcpy(out_whole, input, old_frame * sizeof(int16_t));
+        __asm__ volatile("" : : "r"(out_whole) : "memory");
+    }
+    clock_gettime(CLOCK_MONOTONIC, &t1);
+    printf("old path (capture at %u Hz, copy only): %.0f ns per %u ms stereo frame\n", (unsigned int)TEST_OLD_RATE,
+           elapsed_ns(&t0, &t1) / ((double)TEST_TIMING_REPEATS * frames * 100u), (unsigned int)TEST_BLOCK_MS);
+
+    size_t n = TEST_MAX_RATE * TEST_SECONDS;
+    make_tone(TEST_MAX_RATE, 1000.0, n);
+    for (size_t r = 0; r < sizeof(out_rates) / sizeof(out_rates[0]); r++) {
+        (void)resampler_init(&rs, TEST_MAX_RATE, out_rates[r]);
+        size_t produced = 0;
+        clock_gettime(CLOCK_MONOTONIC, &t0);
+        for (uint32_t rep = 0; rep < TEST_TIMING_REPEATS; rep++) {
+            bool count_ok = true;
+            produced = run_blocks(&rs, n, &count_ok);
+        }
+        clock_gettime(CLOCK_MONOTONIC, &t1);
+        double poly_ns = per_frame_ns(elapsed_ns(&t0, &t1), TEST_TIMING_REPEATS, frames);
+
+        size_t direct = 0;
+        clock_gettime(CLOCK_MONOTONIC, &t0);
+        for (uint32_t rep = 0; rep < TEST_TIMING_REPEATS; rep++) {
+            direct = direct_process(&rs, input, n, out_direct);
+        }
+        clock_gettime(CLOCK_MONOTONIC, &t1);
+        double direct_ns = per_frame_ns(elapsed_ns(&t0, &t1), TEST_TIMING_REPEATS, frames);
+
+        // 每个立体声帧的乘加数：多相每个输出 T 次；直接形式每个 L 倍采样率的点 L*T 次
+        uint32_t poly_macs = (uint32_t)(produced / frames) * rs.taps_per_phase * TEST_TIMING_CHANNELS;
+        uint32_t direct_macs = (uint32_t)(n / frames) * rs.up * rs.up * rs.taps_per_phase * TEST_TIMING_CHANNELS;
+        bool same = direct == produced && memcmp(out_direct, out_blocks, produced * sizeof(int16_t)) == 0;
+        bool pass = same && poly_ns < direct_ns;
+        printf("%5u -> %5u  per %u ms stereo frame: polyphase %u MACs %.0f ns, direct form %u MACs %.0f ns (%.1fx)  "
+               "outputs %s  %s\n",
+               (unsigned int)TEST_MAX_RATE, (unsigned int)out_rates[r], (unsigned int)TEST_BLOCK_MS, (unsigned int)poly_macs,
+               poly_ns, (unsigned int)direct_macs, direct_ns, direct_ns / poly_ns, same ? "match" : "DIFFER",
+               pass ? "ok" : "FAIL");
+        ok &= pass;
+    }
+    return ok;
+}
+
+int main(void) {
+    dsp_init();
+    printf("passband to %.0f%% of output Nyquist within %.2f dB, alias rejection >= %.0f dB from %.0f%% of output Nyquist\n",
+           TEST_PASSBAND_EDGE * 100.0, TEST_PASSBAND_TOL_DB, TEST_ALIAS_MIN_DB, TEST_STOPBAND_EDGE * 100.0);
+    bool ok = true;
+    for (size_t i = 0; i < sizeof(pairs) / sizeof(pairs[0]); i++) {
+        ok &= check_pair(&pairs[i]);
+    }
+    ok &= check_timing();
+    if (resampler_init(&(resampler_t){ 0 }, 44100u, 16000u)) {
+        printf("44100 -> 16000 should be rejected\n");
+        ok = false;
+    }
+    printf("%s\n", ok ? "all checks passed" : "FAILED");
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,96 @@
+// server_control.c 的主机检查：命令的字节布局、编码 -> 解析往返，以及错误命令的拒绝。
+// 布局用手写的字节序列固定 (服务端按 server_control.h 的说明独立实现时应得到同样的字节)；
+// 往返覆盖两种命令的随机字段和全部标志；长度、版本或类型不对的命令须被拒绝。
+// 重复命令 ID 的过滤在 network_task.c 中，不在此检查。
+//
+// 构建 (主机，在仓库根目录)：
+//   cc -O2 -Isrc -o test_server_control tools/host/test_server_control.c src/server_control.c
+// 运行：
+//   ./test_server_control     # 任一项超出门限时返回 1
+
+#include "server_control.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define TEST_ROUND_TRIPS        (10000u)
+
+static bool same_cmd(const server_control_cmd_t *a, const server_control_cmd_t *b) {
+    return a->type == b->type && a->flags == b->flags && a->id == b->id && a->credits == b->credits &&
+           a->format == b->format && a->sample_rate_hz == b->sample_rate_hz && a->frame_duration_ms == b->frame_duration_ms;
+}
+
+static bool check_layout(void) {
+    // 信用：ID 0x1234，追加 500 帧
+    static const uint8_t credit[SERVER_CONTROL_MSG_SIZE] = { 1, 1, 0x34, 0x12, 0xF4, 0x01, 0, 0, 0, 0, 0, 0 };
+    // 质量：ID 7，log-mel，16000 Hz，帧长 40 ms，恢复自适应
+    static const uint8_t quality[SERVER_CONTROL_MSG_SIZE] = { 1, 2, 7, 0, 1, 0, 0x80, 0x3E, 2, 0, 40, 0 };
+    server_control_cmd_t cmd;
+    uint8_t out[SERVER_CONTROL_MSG_SIZE];
+    bool ok = server_control_parse(credit, sizeof(credit), &cmd) && cmd.type == SERVER_CONTROL_CMD_CREDIT &&
+              cmd.id == 0x1234u && cmd.credits == 500u && cmd.flags == 0 &&
+              server_control_encode(&cmd, out) == SERVER_CONTROL_MSG_SIZE && memcmp(out, credit, sizeof(out)) == 0;
+    ok &= server_control_parse(quality, sizeof(quality), &cmd) && cmd.type == SERVER_CONTROL_CMD_QUALITY && cmd.id == 7u &&
+          cmd.format == 1u && cmd.sample_rate_hz == 16000u && cmd.frame_duration_ms == 40u &&
+          cmd.flags == SERVER_CONTROL_FLAG_QUALITY_AUTO && cmd.credits == 0 &&
+          server_control_encode(&cmd, out) == SERVER_CONTROL_MSG_SIZE && memcmp(out, quality, sizeof(out)) == 0;
+    printf("wire layout of CREDIT and QUALITY commands  %s\n", ok ? "ok" : "FAIL");
+    return ok;
+}
+
+static bool check_round_trip(void) {
+    unsigned int seed = 99u;
+    bool ok = true;
+    for (uint32_t i = 0; i < TEST_ROUND_TRIPS; i++) {
+        server_control_cmd_t in = { 0 };
+        in.type = (i % 2u == 0) ? SERVER_CONTROL_CMD_CREDIT : SERVER_CONTROL_CMD_QUALITY;
+        in.flags = (uint8_t)rand_r(&seed);
+        in.id = (uint16_t)rand_r(&seed);
+        if (in.type == SERVER_CONTROL_CMD_CREDIT) {
+            in.credits = ((uint32_t)rand_r(&seed) << 16) ^ (uint32_t)rand_r(&seed);
+        } else {
+            in.format = (uint8_t)((i % 3u == 0) ? SERVER_CONTROL_KEEP_FORMAT : rand_r(&seed) % 2);
+            in.sample_rate_hz = (uint16_t)rand_r(&seed);
+            in.frame_duration_ms = (uint16_t)rand_r(&seed);
+        }
+        uint8_t wire[SERVER_CONTROL_MSG_SIZE];
+        server_control_cmd_t out;
+        ok &= server_control_encode(&in, wire) == SERVER_CONTROL_MSG_SIZE && server_control_parse(wire, sizeof(wire), &out) &&
+              same_cmd(&in, &out);
+    }
+    printf("%u encode -> parse round trips  %s\n", (unsigned int)TEST_ROUND_TRIPS, ok ? "ok" : "FAIL");
+    return ok;
+}
+
+static bool check_rejects(void) {
+    server_control_cmd_t cmd = { .type = SERVER_CONTROL_CMD_CREDIT, .id = 1, .credits = 10 };
+    uint8_t wire[SERVER_CONTROL_MSG_SIZE + 1];
+    server_control_encode(&cmd, wire);
+    wire[SERVER_CONTROL_MSG_SIZE] = 0;
+    bool ok = true;
+    ok &= !server_control_parse(wire, 0, &cmd);
+    ok &= !server_control_parse(wire, SERVER_CONTROL_MSG_SIZE - 1u, &cmd);
+    ok &= !server_control_parse(wire, SERVER_CONTROL_MSG_SIZE + 1u, &cmd);
+    static const uint8_t bad_versions[] = { 0, SERVER_CONTROL_VERSION + 1u, 0xFF };
+    for (size_t i = 0; i < sizeof(bad_versions); i++) {
+        wire[0] = bad_versions[i];
+        ok &= !server_control_parse(wire, SERVER_CONTROL_MSG_SIZE, &cmd);
+    }
+    wire[0] = SERVER_CONTROL_VERSION;
+    static const uint8_t bad_types[] = { 0, SERVER_CONTROL_CMD_QUALITY + 1u, 0xFF };
+    for (size_t i = 0; i < sizeof(bad_types); i++) {
+        wire[1] = bad_types[i];
+        ok &= !server_control_parse(wire, SERVER_CONTROL_MSG_SIZE, &cmd);
+    }
+    printf("wrong length, version and type rejected  %s\n", ok ? "ok" : "FAIL");
+    return ok;
+}
+
+int main(void) {
+    bool ok = true;
+    ok &= check_layout();
+    ok &= check_round_trip();
+    ok &= check_rejects();
+    printf("%s\n", ok ? "all checks passed" : "FAILED");
+    return ok ? 0 : 1;
+}
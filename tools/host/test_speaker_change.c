@@ -0,0 +1,243 @@
+// speaker_change.c 的主机检查：用合成的两个"说话人"交替说话，统计检出的切换和误报。
+// 说话人模型：带抖动的声门脉冲串 + 送气噪声，经过三个共振峰 (二阶谐振器)，每 60 ~ 140 ms 换一个元音。
+// 两人的基频不同，共振峰按声道长度缩放 (B 比 A 高 18%)，同一人内部的元音变化提供类内差异。
+// 检出的切换点按 speaker_change_latency_ms() 回推，与真实切换点相差不超过 TEST_TOLERANCE_MS 计为命中。
+// 每种场景用 TEST_RUNS 个种子各合成 TEST_SECONDS 秒，误报率按总时长计算。
+// 门限：命中率不低于 TEST_MIN_RECALL，两人交替和单一说话人时的误报率都低于 TEST_MAX_FALSE_PER_MIN，
+// 相邻两次切换的间隔不短于 SPEAKER_CHANGE_MIN_SEGMENT_MS，块大小 (帧长) 不影响结果，静音不产生切换。
+// 合成语音不能代表真实说话人，在真实录音上的误报率仍须单独确认。
+//
+// 构建 (主机，在仓库根目录)：
+//   cc -O2 -Isrc -o test_speaker_change tools/host/test_speaker_change.c src/speaker_change.c src/dsp.c -lm
+// 运行：
+//   ./test_speaker_change     # 任一项超出门限时返回 1
+
+#include "speaker_change.h"
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define TEST_RATE               (16000u)
+#define TEST_SECONDS            (120u)
+#define TEST_SAMPLES            (TEST_RATE * TEST_SECONDS)
+#define TEST_SEGMENT_MIN_MS     (3000u)
+#define TEST_SEGMENT_MAX_MS     (6000u)
+#define TEST_LEVEL              (25000.0)   // RMS 约 -25 dBFS，峰值不削顶
+#define TEST_TOLERANCE_MS       (500u)
+#define TEST_RUNS               (5u)
+#define TEST_MIN_RECALL         (0.70)
+#define TEST_MAX_FALSE_PER_MIN  (1.0)
+#define TEST_MAX_CHANGES        (64u)
+#define TEST_MAX_DETECTIONS     (256u)
+
+typedef struct {
+    double f0_hz;
+    double formant_scale;
+} voice_t;
+
+static const voice_t voices[2] = {
+    { 115.0, 1.00 },
+    { 210.0, 1.18 },
+};
+
+// 元音的前三个共振峰 (Hz) 和带宽
+static const double vowels[][3] = {
+    { 730.0, 1090.0, 2440.0 },  // a
+    { 270.0, 2290.0, 3010.0 },  // i
+    { 300.0, 870.0, 2240.0 },   // u
+    { 530.0, 1840.0, 2480.0 },  // e
+    { 570.0, 840.0, 2410.0 },   // o
+};
+static const double bandwidths[3] = { 90.0, 110.0, 160.0 };
+
+static int16_t signal[TEST_SAMPLES];
+static uint32_t change_ms[TEST_MAX_CHANGES];
+static uint32_t change_count;
+static uint32_t detected_ms[TEST_MAX_DETECTIONS];
+static uint32_t detected_count;
+static speaker_change_t detector;
+
+static double uniform(unsigned int *seed) {
+    return (double)rand_r(seed) / ((double)RAND_MAX + 1.0);
+}
+
+// 合成 [start, end) 样本：speaker 为 -1 时是静音
+static void synthesize(uint32_t start, uint32_t end, int speaker, unsigned int *seed) {
+    static double state[3][2];
+    double phase = 0.0;
+    double glottal = 0.0;
+    uint32_t vowel_end = start;
+    double coeff[3][2] = { { 0 } };
+    double gain = 0.0;
+    for (uint32_t n = start; n < end; n++) {
+        if (speaker < 0) {
+            signal[n] = 0;
+            continue;
+        }
+        const voice_t *v = &voices[speaker];
+        if (n >= vowel_end) {
+            const double *f = vowels[rand_r(seed) % (sizeof(vowels) / sizeof(vowels[0]))];
+            for (int k = 0; k < 3; k++) {
+                double r = exp(-M_PI * bandwidths[k] / TEST_RATE);
+                coeff[k][0] = 2.0 * r * cos(2.0 * M_PI * f[k] * v->formant_scale / TEST_RATE);
+                coeff[k][1] = -r * r;
+            }
+            gain = 0.5 + uniform(seed);     // 音节之间的响度变化
+            vowel_end = n + (uint32_t)((0.06 + 0.08 * uniform(seed)) * TEST_RATE);
+        }
+        double f0 = v->f0_hz * (1.0 + 0.03 * (uniform(seed) - 0.5));
+        phase += f0 / TEST_RATE;
+        double pulse = 0.0;
+        if (phase >= 1.0) {
+            phase -= 1.0;
+            pulse = 1.0;
+        }
+        glottal = pulse + 0.9 * glottal;   // 声门脉冲的频谱倾斜
+        double x = glottal + 0.2 * (uniform(seed) - 0.5);
+        for (int k = 0; k < 3; k++) {
+            double y = x + coeff[k][0] * state[k][0] + coeff[k][1] * state[k][1];
+            state[k][1] = state[k][0];
+            state[k][0] = y;
+            x = y * (1.0 - coeff[k][0] - coeff[k][1]) * 0.5;
+        }
+        double s = TEST_LEVEL * gain * x;
+        signal[n] = (int16_t)(s > 32767.0 ? 32767.0 : (s < -32768.0 ? -32768.0 : s));
+    }
+}
+
+// 按 block_ms 分块送入检测器，记录回推后的切换时间。相邻切换的间隔短于 SPEAKER_CHANGE_MIN_SEGMENT_MS 时返回 false
+static bool run_detector(uint32_t block_ms) {
+    bool spacing_ok = true;
+    uint32_t block = TEST_RATE * block_ms / 1000u;
+    speaker_change_reset(&detector);
+    detected_count = 0;
+    for (uint32_t pos = 0; pos < TEST_SAMPLES; pos += block) {
+        uint32_t len = (TEST_SAMPLES - pos < block) ? TEST_SAMPLES - pos : block;
+        if (speaker_change_process(&detector, &signal[pos], len, 1) && detected_count < TEST_MAX_DETECTIONS) {
+            uint32_t end_ms = (pos + len) * 1000u / TEST_RATE;
+            uint32_t latency = speaker_change_latency_ms(&detector);
+            uint32_t at = (end_ms > latency) ? end_ms - latency : 0;
+            if (detected_count > 0 && at - detected_ms[detected_count - 1] < SPEAKER_CHANGE_MIN_SEGMENT_MS) {
+                spacing_ok = false;
+            }
+            detected_ms[detected_count++] = at;
+        }
+    }
+    return spacing_ok;
+}
+
+// 与真实切换点匹配，返回命中数并写出误报数和平均定位误差
+static uint32_t score(uint32_t *false_alarms, double *mean_error_ms) {
+    bool used[TEST_MAX_DETECTIONS] = { false };
+    uint32_t hits = 0;
+    double error_sum = 0.0;
+    for (uint32_t c = 0; c < change_count; c++) {
+        for (uint32_t d = 0; d < detected_count; d++) {
+            uint32_t diff = (detected_ms[d] > change_ms[c]) ? detected_ms[d] - change_ms[c] : change_ms[c] - detected_ms[d];
+            if (!used[d] && diff <= TEST_TOLERANCE_MS) {
+                used[d] = true;
+                hits++;
+                error_sum += diff;
+                break;
+            }
+        }
+    }
+    *false_alarms = detected_count - hits;
+    *mean_error_ms = hits ? error_sum / hits : 0.0;
+    return hits;
+}
+
+// 合成两人交替的 TEST_SECONDS 秒并记录真实切换点
+static void synthesize_dialogue(unsigned int *seed) {
+    change_count = 0;
+    uint32_t pos = 0;
+    int speaker = 0;
+    while (pos < TEST_SAMPLES) {
+        uint32_t len_ms = TEST_SEGMENT_MIN_MS + (uint32_t)(uniform(seed) * (TEST_SEGMENT_MAX_MS - TEST_SEGMENT_MIN_MS));
+        uint32_t end = pos + len_ms * TEST_RATE / 1000u;
+        if (end > TEST_SAMPLES) {
+            end = TEST_SAMPLES;
+        }
+        synthesize(pos, end, speaker, seed);
+        if (pos > 0 && change_count < TEST_MAX_CHANGES) {
+            change_ms[change_count++] = pos * 1000u / TEST_RATE;
+        }
+        pos = end;
+        speaker ^= 1;
+    }
+}
+
+int main(void) {
+    bool ok = true;
+    if (!speaker_change_init(&detector, TEST_RATE)) {
+        printf("speaker_change_init failed\n");
+        return 1;
+    }
+    double minutes = TEST_RUNS * TEST_SECONDS / 60.0;
+
+    // 交替的两个说话人
+    static const uint32_t block_ms[] = { 10, 20, 40, 80 };
+    uint32_t total_changes = 0, total_hits = 0, total_false = 0;
+    double error_sum = 0.0;
+    bool blocks_ok = true;
+    for (uint32_t run = 0; run < TEST_RUNS; run++) {
+        unsigned int seed = 12345u + run;
+        synthesize_dialogue(&seed);
+        uint32_t first_detections = 0;
+        for (size_t b = 0; b < sizeof(block_ms) / sizeof(block_ms[0]); b++) {
+            blocks_ok &= run_detector(block_ms[b]);
+            if (b == 0) {
+                first_detections = detected_count;
+            } else if (detected_count != first_detections) {
+                blocks_ok = false;  // 每个窗都被分析时，结果与块大小无关
+            }
+        }
+        uint32_t false_alarms;
+        double mean_error;
+        uint32_t hits = score(&false_alarms, &mean_error);
+        printf("two speakers, run %u: %u/%u changes found, %u false\n", (unsigned int)run, (unsigned int)hits,
+               (unsigned int)change_count, (unsigned int)false_alarms);
+        total_changes += change_count;
+        total_hits += hits;
+        total_false += false_alarms;
+        error_sum += mean_error * hits;
+    }
+    double recall = (double)total_hits / total_changes;
+    bool pass = recall >= TEST_MIN_RECALL && total_false / minutes < TEST_MAX_FALSE_PER_MIN;
+    printf("two speakers, %.0f min: %u/%u changes found (%.0f%%, at least %.0f%%), mean error %.0f ms, "
+           "%u false (%.2f/min, below %.1f/min)  %s\n",
+           minutes, (unsigned int)total_hits, (unsigned int)total_changes, recall * 100.0, TEST_MIN_RECALL * 100.0,
+           total_hits ? error_sum / total_hits : 0.0, (unsigned int)total_false, total_false / minutes,
+           TEST_MAX_FALSE_PER_MIN, pass ? "ok" : "FAIL");
+    ok &= pass;
+    printf("10/20/40/80 ms blocks: same detections, minimum spacing kept  %s\n", blocks_ok ? "ok" : "FAIL");
+    ok &= blocks_ok;
+
+    // 单一说话人：只有误报
+    for (int s = 0; s < 2; s++) {
+        uint32_t false_alarms = 0;
+        bool spacing_ok = true;
+        for (uint32_t run = 0; run < TEST_RUNS; run++) {
+            unsigned int seed = 54321u + run;
+            synthesize(0, TEST_SAMPLES, s, &seed);
+            change_count = 0;
+            spacing_ok &= run_detector(20);
+            false_alarms += detected_count;
+        }
+        pass = spacing_ok && false_alarms / minutes < TEST_MAX_FALSE_PER_MIN;
+        printf("speaker %c alone, %.0f min: %u false (%.2f/min, below %.1f/min)  %s\n", 'A' + s, minutes,
+               (unsigned int)false_alarms, false_alarms / minutes, TEST_MAX_FALSE_PER_MIN, pass ? "ok" : "FAIL");
+        ok &= pass;
+    }
+
+    // 静音：静音窗不进入统计，不应有任何切换
+    unsigned int seed = 1u;
+    synthesize(0, TEST_SAMPLES, -1, &seed);
+    (void)run_detector(20);
+    printf("silence: %u detections  %s\n", (unsigned int)detected_count, detected_count == 0 ? "ok" : "FAIL");
+    ok &= (detected_count == 0);
+
+    printf("%s\n", ok ? "all checks passed" : "FAILED");
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,517 @@
+// mbedtls_user_config.h 中 APP_MBEDTLS_TRIMMED_PROFILE 的主机检查：裁剪后的客户端能否与常见代理互通，
+// 以及握手往返、字节数和记录长度。
+//
+// 主机上没有 mbedTLS 的开发文件，设备端由 OpenSSL 客户端按裁剪配置代替：套件列表直接取自 mbedtls_user_config.h 的
+// MBEDTLS_SSL_CIPHERSUITES (先按 IANA 编号定义套件 ID，再包含该头文件)，只提供 P-256 组，按根证书和 SNI 验证服务端；
+// 对端是默认配置的 OpenSSL 服务端 (mosquitto 等代理默认的 TLS 实现)。两端经内存 BIO 按步推进，
+// 客户端每次要等服务端的数据才能继续记为一个往返，线上字节按 TLS 记录逐条统计。
+//
+// 互通：TLS 1.3 和 TLS 1.2 (ECDSA P-256 证书、RSA 2048 证书) 都协商到配置中的套件和 P-256；
+//   只提供 CBC 套件或只接受 P-384 的服务端握手失败 (裁剪的代价，部署前须确认代理的配置)。
+// 握手：完整握手 TLS 1.3 为 1 个往返、TLS 1.2 为 2 个；用会话票据恢复都是 1 个往返且服务端不再发送证书。
+//   按 RTT 估算一次重连 (TCP + TLS + MQTT CONNECT) 的网络耗时，cy_mqtt 没有保存/恢复会话的接口，设备上只有完整握手。
+// 记录：服务端发送 16 KB 消息时最大记录的明文不超过 APP_MBEDTLS_IN_CONTENT_LEN；客户端请求 4096 字节的最大分片长度时
+//   服务端遵守 (接收缓冲降到 4 KB 的前提，见 mbedtls_user_config.h)。客户端按 APP_MBEDTLS_OUT_CONTENT_LEN 分片
+//   发送默认帧长、最大帧长和立体声最大帧长的音频 PUBLISH，统计拆成的记录数，对端收到的数据逐字节相同。
+// 主机上的 CPU 时间只用于比较完整握手和恢复，不代表设备上 mbedTLS (硬件 ECP) 的耗时；设备上的握手/重连耗时和
+// 峰值堆由 network_get_connection_stats() 给出。
+// 门限：互通结果如上；往返数如上；恢复的握手字节 (含 TLS 1.3 握手后的会话票据) 少于完整握手；记录长度不超过对应的缓冲。
+//
+// 构建 (主机，在仓库根目录)：
+//   cc -O2 -Isrc -Itools/host/shim -o test_tls_profile tools/host/test_tls_profile.c -lssl -lcrypto
+// 运行：
+//   ./test_tls_profile        # 任一项超出门限时返回 1
+
+// mbedTLS 的套件 ID 即 IANA 编号 (ssl_ciphersuites.h)
+#define MBEDTLS_TLS1_3_AES_128_GCM_SHA256                   0x1301
+#define MBEDTLS_TLS_ECDHE_ECDSA_WITH_AES_128_GCM_SHA256     0xC02B
+#define MBEDTLS_TLS_ECDHE_RSA_WITH_AES_128_GCM_SHA256       0xC02F
+#define COMPONENT_4390X                 // 不包含 cy_syslib.h
+#define DISABLE_MBEDTLS_ACCELERATION    // 不包含 mbedtls_alt_config.h
+#include "mbedtls_user_config.h"
+
+#include "audio_task.h"
+#include "app_config.h"
+#include <openssl/err.h>
+#include <openssl/evp.h>
+#include <openssl/ssl.h>
+#include <openssl/x509.h>
+#include <openssl/x509v3.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#ifndef APP_MBEDTLS_TRIMMED_PROFILE
+#error "APP_MBEDTLS_TRIMMED_PROFILE is not defined in mbedtls_user_config.h"
+#endif
+
+#define TEST_SERVER_NAME        "broker.local"
+#define TEST_CPU_ROUNDS         (200u)          // 每种握手重复次数，取平均 CPU 时间
+#define TEST_DOWNLINK_BYTES     (20000u)        // 服务端一次发送的消息 (大于一条记录)
+#define TEST_MFL_BYTES          (4096u)
+#define TEST_MAX_RTTS           (8u)
+#define TEST_CLIENT_ID          MQTT_CLIENT_ID_PREFIX "-000000"
+
+static const int profile_suites[] = { MBEDTLS_SSL_CIPHERSUITES };
+#define PROFILE_SUITE_COUNT     (sizeof(profile_suites) / sizeof(profile_suites[0]))
+
+typedef struct {
+    EVP_PKEY *key;
+    X509 *cert;
+} identity_t;
+
+// 单方向的线上统计：按 5 字节记录头切分字节流
+typedef struct {
+    uint8_t header[5];
+    size_t header_have;
+    size_t body_left;
+    size_t bytes;
+    unsigned int records;
+    unsigned int app_records;       // 外层类型为 application_data 的记录 (TLS 1.3 加密后的记录都是这种)
+    size_t max_record;              // 最大记录的密文长度 (不含记录头)
+} wire_dir_t;
+
+typedef struct {
+    SSL *client;
+    SSL *server;
+    wire_dir_t up;                  // 客户端 → 服务端
+    wire_dir_t down;
+    unsigned int rtts;
+    unsigned int server_certificates;   // 客户端收到的 Certificate 消息数
+    double client_cpu_us;
+    double server_cpu_us;
+} link_t;
+
+static identity_t ecdsa_id;
+static identity_t rsa_id;
+static char client_tls12_list[256];
+static char client_tls13_list[256];
+
+// ---- 证书和上下文 ----
+
+static bool make_identity(identity_t *id, EVP_PKEY *key) {
+    id->key = key;
+    id->cert = X509_new();
+    if (key == NULL || id->cert == NULL) {
+        return false;
+    }
+    X509_set_version(id->cert, 2);
+    ASN1_INTEGER_set(X509_get_serialNumber(id->cert), 1);
+    X509_gmtime_adj(X509_getm_notBefore(id->cert), -3600);
+    X509_gmtime_adj(X509_getm_notAfter(id->cert), 3600L * 24 * 365);
+    X509_NAME *name = X509_get_subject_name(id->cert);
+    X509_NAME_add_entry_by_txt(name, "CN", MBSTRING_ASC, (const unsigned char *)TEST_SERVER_NAME, -1, -1, 0);
+    X509_set_issuer_name(id->cert, name);
+    X509_set_pubkey(id->cert, key);
+    // 自签名证书同时作为客户端的根证书，与设备上 MQTT_ROOT_CA_CERTIFICATE 的用法相同
+    X509V3_CTX ctx;
+    X509V3_set_ctx_nodb(&ctx);
+    X509V3_set_ctx(&ctx, id->cert, id->cert, NULL, NULL, 0);
+    X509_EXTENSION *ext = X509V3_EXT_conf_nid(NULL, &ctx, NID_subject_alt_name, "DNS:" TEST_SERVER_NAME);
+    X509_EXTENSION *bc = X509V3_EXT_conf_nid(NULL, &ctx, NID_basic_constraints, "critical,CA:TRUE");
+    bool ok = ext != NULL && bc != NULL && X509_add_ext(id->cert, ext, -1) && X509_add_ext(id->cert, bc, -1);
+    X509_EXTENSION_free(ext);
+    X509_EXTENSION_free(bc);
+    return ok && X509_sign(id->cert, key, EVP_sha256()) > 0;
+}
+
+// 把配置中的套件 ID 换成 OpenSSL 的名字：TLS 1.3 套件和 TLS 1.2 套件分开设置
+static bool map_profile_suites(void) {
+    SSL_CTX *ctx = SSL_CTX_new(TLS_method());
+    SSL *ssl = SSL_new(ctx);
+    bool ok = ssl != NULL;
+    for (size_t i = 0; ok && i < PROFILE_SUITE_COUNT; i++) {
+        const unsigned char id[2] = { (unsigned char)(profile_suites[i] >> 8), (unsigned char)profile_suites[i] };
+        const SSL_CIPHER *cipher = SSL_CIPHER_find(ssl, id);
+        if (cipher == NULL) {
+            printf("suite 0x%04X from MBEDTLS_SSL_CIPHERSUITES unknown  FAIL\n", (unsigned int)profile_suites[i]);
+            ok = false;
+            break;
+        }
+        char *list = (id[0] == 0x13) ? client_tls13_list : client_tls12_list;
+        if (list[0] != '\0') {
+            strcat(list, ":");
+        }
+        strcat(list, SSL_CIPHER_get_name(cipher));
+    }
+    SSL_free(ssl);
+    SSL_CTX_free(ctx);
+    if (ok) {
+        printf("profile: TLS 1.3 [%s], TLS 1.2 [%s], group P-256, record buffers in %u / out %u bytes\n", client_tls13_list,
+               client_tls12_list, (unsigned int)APP_MBEDTLS_IN_CONTENT_LEN, (unsigned int)APP_MBEDTLS_OUT_CONTENT_LEN);
+    }
+    return ok;
+}
+
+static SSL_CTX *client_ctx(int max_version, const identity_t *trust) {
+    SSL_CTX *ctx = SSL_CTX_new(TLS_client_method());
+    SSL_CTX_set_min_proto_version(ctx, TLS1_2_VERSION);
+    SSL_CTX_set_max_proto_version(ctx, max_version);
+    SSL_CTX_set_ciphersuites(ctx, client_tls13_list);
+    SSL_CTX_set_cipher_list(ctx, client_tls12_list);
+    SSL_CTX_set1_groups_list(ctx, "P-256");
+    SSL_CTX_set_verify(ctx, SSL_VERIFY_PEER, NULL);
+    X509_STORE_add_cert(SSL_CTX_get_cert_store(ctx), trust->cert);
+    SSL_CTX_set_session_cache_mode(ctx, SSL_SESS_CACHE_CLIENT);
+    return ctx;
+}
+
+// 默认配置的服务端；tls12_ciphers/groups 非 NULL 时限制为给定的套件/组
+static SSL_CTX *server_ctx(const identity_t *id, const char *tls12_ciphers, const char *groups) {
+    SSL_CTX *ctx = SSL_CTX_new(TLS_server_method());
+    SSL_CTX_use_certificate(ctx, id->cert);
+    SSL_CTX_use_PrivateKey(ctx, id->key);
+    if (tls12_ciphers != NULL) {
+        SSL_CTX_set_max_proto_version(ctx, TLS1_2_VERSION);
+        SSL_CTX_set_cipher_list(ctx, tls12_ciphers);
+    }
+    if (groups != NULL) {
+        SSL_CTX_set1_groups_list(ctx, groups);
+    }
+    return ctx;
+}
+
+// ---- 内存 BIO 上的连接 ----
+
+static void wire_count(wire_dir_t *dir, const uint8_t *data, size_t len) {
+    dir->bytes += len;
+    while (len > 0) {
+        if (dir->body_left == 0) {
+            dir->header[dir->header_have++] = *data++;
+            len--;
+            if (dir->header_have == sizeof(dir->header)) {
+                dir->body_left = ((size_t)dir->header[3] << 8) | dir->header[4];
+                dir->header_have = 0;
+                dir->records++;
+                dir->app_records += (dir->header[0] == 23);
+                if (dir->body_left > dir->max_record) {
+                    dir->max_record = dir->body_left;
+                }
+            }
+            continue;
+        }
+        size_t n = (len < dir->body_left) ? len : dir->body_left;
+        dir->body_left -= n;
+        data += n;
+        len -= n;
+    }
+}
+
+// 把 from 写出的字节交给 to，返回字节数
+static size_t pump(SSL *from, SSL *to, wire_dir_t *dir) {
+    uint8_t buf[4096];
+    size_t total = 0;
+    int n;
+    while ((n = BIO_read(SSL_get_wbio(from), buf, sizeof(buf))) > 0) {
+        wire_count(dir, buf, (size_t)n);
+        BIO_write(SSL_get_rbio(to), buf, n);
+        total += (size_t)n;
+    }
+    return total;
+}
+
+static double cpu_us(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &ts);
+    return (double)ts.tv_sec * 1e6 + (double)ts.tv_nsec / 1e3;
+}
+
+static void on_client_message(int write_p, int version, int content_type, const void *buf, size_t len, SSL *ssl,
+                              void *arg) {
+    (void)version;
+    (void)arg;
+    link_t *link = SSL_get_app_data(ssl);
+    if (!write_p && content_type == SSL3_RT_HANDSHAKE && len > 0 && ((const uint8_t *)buf)[0] == SSL3_MT_CERTIFICATE) {
+        link->server_certificates++;
+    }
+}
+
+static void link_open(link_t *link, SSL_CTX *cctx, SSL_CTX *sctx, SSL_SESSION *resume) {
+    memset(link, 0, sizeof(*link));
+    link->client = SSL_new(cctx);
+    link->server = SSL_new(sctx);
+    SSL_set_bio(link->client, BIO_new(BIO_s_mem()), BIO_new(BIO_s_mem()));
+    SSL_set_bio(link->server, BIO_new(BIO_s_mem()), BIO_new(BIO_s_mem()));
+    SSL_set_app_data(link->client, link);
+    SSL_set_msg_callback(link->client, on_client_message);
+    SSL_set_connect_state(link->client);
+    SSL_set_accept_state(link->server);
+    SSL_set_tlsext_host_name(link->client, TEST_SERVER_NAME);
+    SSL_set1_host(link->client, TEST_SERVER_NAME);
+    if (resume != NULL) {
+        SSL_set_session(link->client, resume);
+    }
+}
+
+// 正常关闭 (close_notify)：未关闭就释放的会话会被 OpenSSL 标为不可恢复
+static void link_close(link_t *link) {
+    SSL_shutdown(link->client);
+    SSL_shutdown(link->server);
+    SSL_free(link->client);
+    SSL_free(link->server);
+}
+
+static bool want_io(SSL *ssl, int rc) {
+    int err = SSL_get_error(ssl, rc);
+    return err == SSL_ERROR_WANT_READ || err == SSL_ERROR_WANT_WRITE;
+}
+
+// 按步推进握手，直到客户端完成 (可以发送 CONNECT)；rtts 为客户端等待服务端数据的次数
+static bool link_handshake(link_t *link) {
+    for (;;) {
+        double t0 = cpu_us();
+        int rc = SSL_do_handshake(link->client);
+        link->client_cpu_us += cpu_us() - t0;
+        if (rc != 1 && !want_io(link->client, rc)) {
+            return false;
+        }
+        pump(link->client, link->server, &link->up);
+        if (rc == 1) {
+            break;
+        }
+        if (link->rtts == TEST_MAX_RTTS) {
+            return false;
+        }
+        t0 = cpu_us();
+        rc = SSL_do_handshake(link->server);
+        link->server_cpu_us += cpu_us() - t0;
+        if (rc != 1 && !want_io(link->server, rc)) {
+            return false;
+        }
+        if (pump(link->server, link->client, &link->down) > 0) {
+            link->rtts++;
+        }
+    }
+    // 服务端处理客户端的最后一个 flight；TLS 1.3 的会话票据在握手之后发送，客户端读一次才能取到
+    double t0 = cpu_us();
+    int rc = SSL_do_handshake(link->server);
+    link->server_cpu_us += cpu_us() - t0;
+    if (rc != 1) {
+        return false;
+    }
+    pump(link->server, link->client, &link->down);
+    uint8_t scratch[16];
+    rc = SSL_read(link->client, scratch, sizeof(scratch));
+    return rc <= 0 && want_io(link->client, rc);
+}
+
+// from 发送 len 字节，to 读出后与原数据比较
+static bool link_transfer(SSL *from, SSL *to, wire_dir_t *dir, size_t len) {
+    uint8_t *data = calloc(len, 1);
+    uint8_t *got = malloc(len);
+    if (data == NULL || got == NULL) {
+        free(data);
+        free(got);
+        return false;
+    }
+    for (size_t i = 0; i < len; i++) {
+        data[i] = (uint8_t)(i * 131u + 7u);
+    }
+    bool ok = SSL_write(from, data, (int)len) == (int)len;
+    pump(from, to, dir);
+    size_t have = 0;
+    while (ok && have < len) {
+        int n = SSL_read(to, got + have, (int)(len - have));
+        ok = n > 0;
+        have += (n > 0) ? (size_t)n : 0;
+    }
+    ok = ok && memcmp(data, got, len) == 0;
+    free(data);
+    free(got);
+    return ok;
+}
+
+// 记录的明文长度上限：AES-128-GCM 的密文比明文多 16 字节标签，TLS 1.2 另有 8 字节显式 nonce，TLS 1.3 另有 1 字节内容类型
+static size_t record_plaintext(const SSL *ssl, size_t record) {
+    size_t overhead = (SSL_version(ssl) == TLS1_3_VERSION) ? 17u : 24u;
+    return (record > overhead) ? record - overhead : 0;
+}
+
+// ---- 检查 ----
+
+static bool negotiated_in_profile(SSL *ssl) {
+    uint16_t id = SSL_CIPHER_get_protocol_id(SSL_get_current_cipher(ssl));
+    for (size_t i = 0; i < PROFILE_SUITE_COUNT; i++) {
+        if (profile_suites[i] == id) {
+            return SSL_get_negotiated_group(ssl) == NID_X9_62_prime256v1;
+        }
+    }
+    return false;
+}
+
+static bool check_interop(const char *what, int max_version, const identity_t *id, const char *server_ciphers,
+                          const char *server_groups, bool expect_ok) {
+    SSL_CTX *cctx = client_ctx(max_version, id);
+    SSL_CTX *sctx = server_ctx(id, server_ciphers, server_groups);
+    link_t link;
+    link_open(&link, cctx, sctx, NULL);
+    bool connected = link_handshake(&link) && SSL_get_verify_result(link.client) == X509_V_OK;
+    bool ok = connected ? (expect_ok && negotiated_in_profile(link.client)) : !expect_ok;
+    printf("%-44s %-8s %s  %s\n", what, connected ? SSL_get_version(link.client) : "-",
+           connected ? SSL_CIPHER_get_name(SSL_get_current_cipher(link.client)) : "handshake fails", ok ? "ok" : "FAIL");
+    ERR_clear_error();
+    link_close(&link);
+    SSL_CTX_free(cctx);
+    SSL_CTX_free(sctx);
+    return ok;
+}
+
+typedef struct {
+    unsigned int rtts;
+    size_t up;
+    size_t down;
+    double client_us;
+    double server_us;
+    bool reused;
+    bool server_cert;
+} handshake_result_t;
+
+// 完整握手后用取到的会话恢复；两种握手各重复 TEST_CPU_ROUNDS 次取平均 CPU 时间
+static bool run_handshakes(int max_version, const identity_t *id, handshake_result_t *full, handshake_result_t *resumed) {
+    SSL_CTX *cctx = client_ctx(max_version, id);
+    SSL_CTX *sctx = server_ctx(id, NULL, NULL);
+    SSL_SESSION *session = NULL;
+    bool ok = true;
+    for (int pass = 0; pass < 2 && ok; pass++) {
+        handshake_result_t *r = (pass == 0) ? full : resumed;
+        memset(r, 0, sizeof(*r));
+        for (unsigned int i = 0; i < TEST_CPU_ROUNDS && ok; i++) {
+            link_t link;
+            link_open(&link, cctx, sctx, (pass == 1) ? session : NULL);
+            ok = link_handshake(&link);
+            if (i == 0) {
+                r->rtts = link.rtts;
+                r->up = link.up.bytes;
+                r->down = link.down.bytes;
+                r->reused = SSL_session_reused(link.client);
+                r->server_cert = link.server_certificates > 0;
+            }
+            r->client_us += link.client_cpu_us / TEST_CPU_ROUNDS;
+            r->server_us += link.server_cpu_us / TEST_CPU_ROUNDS;
+            if (pass == 0 && i == 0) {
+                session = SSL_get1_session(link.client);
+                ok = ok && session != NULL && SSL_SESSION_is_resumable(session);
+            }
+            link_close(&link);
+        }
+    }
+    SSL_SESSION_free(session);
+    SSL_CTX_free(cctx);
+    SSL_CTX_free(sctx);
+    return ok;
+}
+
+static bool check_handshakes(const char *what, int max_version, const identity_t *id, unsigned int full_rtts) {
+    handshake_result_t full;
+    handshake_result_t resumed;
+    if (!run_handshakes(max_version, id, &full, &resumed)) {
+        printf("%-28s handshake failed  FAIL\n", what);
+        return false;
+    }
+    bool ok = full.rtts == full_rtts && !full.reused && full.server_cert;
+    ok &= resumed.rtts == 1u && resumed.reused && !resumed.server_cert;
+    ok &= resumed.up + resumed.down < full.up + full.down;
+    printf("%-28s full    %u RTT  %5zu B up %5zu B down  client %6.0f us  server %6.0f us\n", what, full.rtts, full.up,
+           full.down, full.client_us, full.server_us);
+    printf("%-28s resumed %u RTT  %5zu B up %5zu B down  client %6.0f us  server %6.0f us  %s\n", "", resumed.rtts,
+           resumed.up, resumed.down, resumed.client_us, resumed.server_us, ok ? "ok" : "FAIL");
+    // 一次重连的网络耗时：TCP 1 个往返 + TLS + CONNECT/CONNACK 1 个往返 (TLS 1.3 的客户端 Finished 与 CONNECT 一起发送)
+    printf("%-28s reconnect at RTT 5/20/50 ms: full %u/%u/%u ms, resumed %u/%u/%u ms\n", "", (full.rtts + 2u) * 5u,
+           (full.rtts + 2u) * 20u, (full.rtts + 2u) * 50u, (resumed.rtts + 2u) * 5u, (resumed.rtts + 2u) * 20u,
+           (resumed.rtts + 2u) * 50u);
+    return ok;
+}
+
+// 服务端发送大消息时的最大记录，mfl 非 0 时客户端请求该最大分片长度
+static bool check_downlink(int max_version, unsigned int mfl, size_t limit) {
+    SSL_CTX *cctx = client_ctx(max_version, &ecdsa_id);
+    SSL_CTX *sctx = server_ctx(&ecdsa_id, NULL, NULL);
+    link_t link;
+    link_open(&link, cctx, sctx, NULL);
+    if (mfl != 0) {
+        SSL_set_tlsext_max_fragment_length(link.client, TLSEXT_max_fragment_length_4096);
+    }
+    bool ok = link_handshake(&link);
+    memset(&link.down, 0, sizeof(link.down));
+    ok = ok && link_transfer(link.server, link.client, &link.down, TEST_DOWNLINK_BYTES);
+    size_t plaintext = record_plaintext(link.client, link.down.max_record);
+    ok = ok && plaintext <= limit;
+    printf("%-8s %u B from broker, max fragment %-5s  %u records, largest %5zu B plaintext (limit %zu)  %s\n",
+           SSL_get_version(link.client), (unsigned int)TEST_DOWNLINK_BYTES, (mfl != 0) ? "4096" : "-",
+           link.down.app_records, plaintext, limit, ok ? "ok" : "FAIL");
+    link_close(&link);
+    SSL_CTX_free(cctx);
+    SSL_CTX_free(sctx);
+    return ok;
+}
+
+// 一帧音频 PUBLISH (QoS0) 的长度：固定报头 + 主题 + 帧头 + PCM 负载
+static size_t audio_publish_len(unsigned int frame_ms, unsigned int channels) {
+    size_t payload = sizeof(audio_frame_header_t) +
+                     (size_t)AUDIO_MAX_OUTPUT_SAMPLE_RATE * frame_ms / 1000u * channels * (AUDIO_BIT_RESOLUTION / 8);
+    size_t remaining = 2u + strlen(MQTT_TOPIC_AUDIO_STREAM "/" TEST_CLIENT_ID) + payload;
+    return 1u + ((remaining < 128u) ? 1u : (remaining < 16384u) ? 2u : 3u) + remaining;
+}
+
+static bool check_uplink(unsigned int frame_ms, unsigned int channels) {
+    SSL_CTX *cctx = client_ctx(TLS1_3_VERSION, &ecdsa_id);
+    SSL_CTX *sctx = server_ctx(&ecdsa_id, NULL, NULL);
+    SSL_CTX_set_max_send_fragment(cctx, APP_MBEDTLS_OUT_CONTENT_LEN);
+    link_t link;
+    link_open(&link, cctx, sctx, NULL);
+    size_t len = audio_publish_len(frame_ms, channels);
+    bool ok = link_handshake(&link);
+    memset(&link.up, 0, sizeof(link.up));
+    ok = ok && link_transfer(link.client, link.server, &link.up, len);
+    unsigned int expected = (unsigned int)((len + APP_MBEDTLS_OUT_CONTENT_LEN - 1u) / APP_MBEDTLS_OUT_CONTENT_LEN);
+    ok = ok && link.up.app_records == expected &&
+         record_plaintext(link.client, link.up.max_record) <= APP_MBEDTLS_OUT_CONTENT_LEN;
+    printf("audio PUBLISH %2u ms x %u ch: %5zu B -> %u record(s), %zu B on the wire  %s\n", frame_ms,
+           channels, len, link.up.app_records, link.up.bytes, ok ? "ok" : "FAIL");
+    link_close(&link);
+    SSL_CTX_free(cctx);
+    SSL_CTX_free(sctx);
+    return ok;
+}
+
+int main(void) {
+    bool ok = make_identity(&ecdsa_id, EVP_EC_gen("P-256")) && make_identity(&rsa_id, EVP_RSA_gen(2048));
+    ok = ok && map_profile_suites();
+    if (!ok) {
+        printf("cannot set up certificates or profile  FAIL\n");
+        return 1;
+    }
+#ifdef MBEDTLS_ECP_DP_CURVE25519_ENABLED
+    printf("Curve25519 still enabled by the trimmed profile  FAIL\n");
+    ok = false;
+#endif
+
+    ok &= check_interop("TLS 1.3, ECDSA P-256 certificate", TLS1_3_VERSION, &ecdsa_id, NULL, NULL, true);
+    ok &= check_interop("TLS 1.3, RSA 2048 certificate", TLS1_3_VERSION, &rsa_id, NULL, NULL, true);
+    ok &= check_interop("TLS 1.2, ECDSA P-256 certificate", TLS1_2_VERSION, &ecdsa_id, NULL, NULL, true);
+    ok &= check_interop("TLS 1.2, RSA 2048 certificate", TLS1_2_VERSION, &rsa_id, NULL, NULL, true);
+    ok &= check_interop("TLS 1.2 broker with CBC suites only", TLS1_3_VERSION, &rsa_id,
+                        "ECDHE-RSA-AES128-SHA256:ECDHE-RSA-AES128-SHA", NULL, false);
+    ok &= check_interop("broker accepting P-384 only", TLS1_3_VERSION, &ecdsa_id, NULL, "P-384", false);
+
+    ok &= check_handshakes("TLS 1.3, ECDSA P-256", TLS1_3_VERSION, &ecdsa_id, 1u);
+    ok &= check_handshakes("TLS 1.2, ECDSA P-256", TLS1_2_VERSION, &ecdsa_id, 2u);
+    ok &= check_handshakes("TLS 1.2, RSA 2048", TLS1_2_VERSION, &rsa_id, 2u);
+
+    ok &= check_downlink(TLS1_3_VERSION, 0, APP_MBEDTLS_IN_CONTENT_LEN);
+    ok &= check_downlink(TLS1_2_VERSION, 0, APP_MBEDTLS_IN_CONTENT_LEN);
+    ok &= check_downlink(TLS1_3_VERSION, TEST_MFL_BYTES, TEST_MFL_BYTES);
+    ok &= check_downlink(TLS1_2_VERSION, TEST_MFL_BYTES, TEST_MFL_BYTES);
+
+    ok &= check_uplink(AUDIO_FRAME_DURATION_MS, AUDIO_CHANNELS);
+    ok &= check_uplink(AUDIO_MAX_FRAME_DURATION_MS, AUDIO_CHANNELS);
+    ok &= check_uplink(AUDIO_MAX_FRAME_DURATION_MS, 2u);   // 立体声 (AUDIO_MODE) 的最大帧
+
+    printf("record buffers: %u B now, %u B if the broker honoured a %u B max fragment length\n",
+           (unsigned int)(APP_MBEDTLS_IN_CONTENT_LEN + APP_MBEDTLS_OUT_CONTENT_LEN),
+           (unsigned int)(TEST_MFL_BYTES + APP_MBEDTLS_OUT_CONTENT_LEN), (unsigned int)TEST_MFL_BYTES);
+    printf("%s\n", ok ? "all checks passed" : "FAILED");
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,482 @@
+// udp_stream.c 的主机检查：真实的 udp_stream_send() 经回环 UDP 发往本程序，在接收侧按丢包模型丢弃数据报，
+// 用 fec_recover() 恢复，并与同一丢包率下 MQTT (TCP) 路径的队头阻塞模型比较实时帧的延迟和丢帧。
+//
+// 报文检查 (每个数据报)：V=2、PT 按校验标志为 96/97、RTP 序号连续 (含校验包)、时间戳为 timestamp_ms x 48、
+// SSRC 为客户端 ID 的 FNV-1a 散列、RTP 报头之后的内容与发送的帧头 + 负载逐字节相同；每个数据报一次 sendto。
+// 恢复检查：按 RTP 序号 (跨过 16 位回绕) 统计的丢失数等于实际丢弃的数据报数 (最后收到的之后的除外)，FEC 恢复的帧与原帧逐字节相同。
+// 发送失败 (协议栈缓冲不足) 计入 send_errors 并占用序号；接收端报告按 udp_stream.h 的格式解析，
+// 版本不对或长度不足的报告被忽略，同一报告只取出一次。
+//
+// 延迟比较：帧长 TEST_FRAME_MS，单程时延 TEST_ONE_WAY_MS，不计排队和 Wi-Fi 抖动，只比较丢包的影响。
+//   UDP     收到的帧延迟为单程时延；FEC 恢复的帧要等到本组校验包到达；其余丢失。
+//   TCP     每帧一个报文段 (MQTT QoS0)，丢失的报文段在收到 3 个重复确认 (后续 3 个报文段到达) 或 RTO 到期时重传，
+//           重传同样可能丢失 (RTO 加倍)。接收端按序交付，之前的报文段未到时后面的帧全部等待 (队头阻塞)。
+//           每个丢失的报文段各自快速重传、拥塞窗口不收缩、没有时延确认，模型偏向 TCP。
+//           RTO 取 TEST_TCP_RTO_MS：lwIP 以 500 ms 的慢定时器计算 RTO，局域网上一般收敛到 2 个节拍。
+// 门限：TCP 不丢帧；UDP 直接收到的帧延迟等于单程时延，恢复的帧不超过一组的时长；
+// 随机丢包 TEST_HOL_LOSS_PCT% 时 TCP 的 p99 延迟至少比 UDP 高 TEST_MIN_HOL_MS；随机丢包下 FEC 降低 UDP 的丢帧。
+//
+// 构建 (主机，在仓库根目录)：
+//   cc -O2 -Isrc -Itools/host/shim -o test_udp_stream tools/host/test_udp_stream.c src/udp_stream.c src/fec.c tools/host/shim/secure_sockets_shim.c tools/host/shim/freertos_shim.c
+// 运行：
+//   ./test_udp_stream         # 任一项超出门限时返回 1
+
+#include "udp_stream.h"
+#include "audio_task.h"
+#include "byte_order.h"
+#include "fec.h"
+#include "cy_secure_sockets.h"
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#define TEST_CLIENT_ID          "test-client"
+#define TEST_FRAME_MS           (40u)
+#define TEST_PAYLOAD_BYTES      (1280u)     // 40 ms 16 kHz 单声道 PCM
+#define TEST_FRAMES             (7500u)     // 每种条件 5 分钟
+#define TEST_FEC_GROUP          (4u)
+#define TEST_ONE_WAY_MS         (3u)
+#define TEST_TCP_RTO_MS         (1000u)
+#define TEST_TCP_DUPACKS        (3u)
+#define TEST_BURST_LEN          (3.0)       // 突发丢包的平均长度 (数据报)
+#define TEST_HOL_LOSS_PCT       (2u)
+#define TEST_MIN_HOL_MS         (60u)
+
+#define TEST_PACKET_BYTES       (sizeof(audio_frame_header_t) + TEST_PAYLOAD_BYTES)
+#define TEST_DATAGRAM_BYTES     (UDP_STREAM_RTP_HEADER_SIZE + FEC_PARITY_BUFFER_SIZE(TEST_PACKET_BYTES))
+#define TEST_NOT_DELIVERED      (UINT32_MAX)
+
+typedef struct {
+    const char *name;
+    uint32_t loss_pct;
+    bool burst;
+} loss_condition_t;
+
+typedef struct {
+    uint32_t p50_ms;
+    uint32_t p99_ms;
+    uint32_t max_ms;
+    uint32_t lost;              // 未交付的帧数
+} latency_summary_t;
+
+static int receiver_fd = -1;
+static uint8_t frame_storage[AUDIO_FRAME_HEADROOM + TEST_PACKET_BYTES];
+static uint8_t parity_storage[AUDIO_FRAME_HEADROOM + FEC_PARITY_BUFFER_SIZE(TEST_PACKET_BYTES)];
+static uint8_t received[TEST_FRAMES][TEST_PACKET_BYTES];   // 按帧序号存放收到的帧头 + 负载
+static size_t received_len[TEST_FRAMES];
+static uint32_t latency_ms[TEST_FRAMES];
+static bool frame_lost[TEST_FRAMES];
+static uint32_t sorted[TEST_FRAMES];
+static unsigned int seed = 1u;
+
+static double uniform(void) {
+    return (double)rand_r(&seed) / ((double)RAND_MAX + 1.0);
+}
+
+// 丢包模型：burst 为 false 时独立丢包；否则为两状态马尔可夫链，坏状态全丢，平均停留 TEST_BURST_LEN 个包
+static bool loss_bad;
+
+static bool next_lost(const loss_condition_t *c) {
+    double p = c->loss_pct / 100.0;
+    if (!c->burst) {
+        return uniform() < p;
+    }
+    double leave_bad = 1.0 / TEST_BURST_LEN;
+    double enter_bad = p * leave_bad / (1.0 - p);
+    loss_bad = loss_bad ? (uniform() >= leave_bad) : (uniform() < enter_bad);
+    return loss_bad;
+}
+
+static uint32_t fnv1a(const char *s) {
+    uint32_t hash = 2166136261u;
+    while (*s != '\0') {
+        hash ^= (uint8_t)*s++;
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+// 负载由序号决定，接收侧可以重新生成原帧比较
+static size_t make_frame(uint8_t *p, uint32_t sequence) {
+    audio_frame_header_t header = {
+        .version = AUDIO_FRAME_HEADER_VERSION,
+        .flags = 0,
+        .channels = 1,
+        .format = AUDIO_FRAME_FORMAT_PCM_S16LE,
+        .sample_rate_hz = 16000u,
+        .num_samples = TEST_PAYLOAD_BYTES / 2u,
+        .sequence = sequence,
+        .timestamp_ms = 100000u + sequence * TEST_FRAME_MS,
+    };
+    memcpy(p, &header, sizeof(header));
+    for (size_t i = 0; i < TEST_PAYLOAD_BYTES; i++) {
+        p[sizeof(header) + i] = (uint8_t)((sequence * 131u + i * 7u) ^ (i >> 8));
+    }
+    return TEST_PACKET_BYTES;
+}
+
+static bool same_as_original(const uint8_t *packet, size_t len, uint32_t sequence) {
+    uint8_t original[TEST_PACKET_BYTES];
+    return len == make_frame(original, sequence) && memcmp(packet, original, len) == 0;
+}
+
+static int open_receiver(void) {
+    int fd = socket(AF_INET, SOCK_DGRAM, 0);
+    int size = 4 * 1024 * 1024;
+    setsockopt(fd, SOL_SOCKET, SO_RCVBUF, &size, sizeof(size));
+    struct sockaddr_in sa = { .sin_family = AF_INET, .sin_addr.s_addr = htonl(INADDR_LOOPBACK) };
+    socklen_t sa_len = sizeof(sa);
+    if (fd < 0 || bind(fd, (struct sockaddr *)&sa, sizeof(sa)) != 0 || getsockname(fd, (struct sockaddr *)&sa, &sa_len) != 0) {
+        return -1;
+    }
+    shim_socket_port_override = ntohs(sa.sin_port);
+    return fd;
+}
+
+// 接收一个数据报 (回环上 sendto 返回时数据报已在接收队列中)
+static ssize_t receive_datagram(uint8_t *buffer, size_t capacity) {
+    return recv(receiver_fd, buffer, capacity, MSG_DONTWAIT);
+}
+
+// --- UDP 经回环 ---
+
+typedef struct {
+    bool format_ok;             // 所有数据报的 RTP 报头和内容正确
+    bool recovery_ok;           // 恢复的帧与原帧相同
+    uint32_t datagrams;
+    uint32_t dropped;           // 按丢包模型丢弃的数据报
+    uint32_t trailing_drops;    // 最后一个收到的数据报之后丢弃的，接收端无从得知
+    uint32_t recovered;
+    uint32_t sends;
+    // 接收端的丢包统计 (与 receiver.c 相同，RFC 3550 附录 A.1 的扩展序号)
+    bool rtp_started;
+    uint16_t rtp_max_seq;
+    uint32_t rtp_base;
+    uint32_t rtp_cycles;
+    uint32_t rtp_received;
+} udp_run_t;
+
+static void on_rtp_sequence(udp_run_t *run, uint16_t seq) {
+    if (!run->rtp_started) {
+        run->rtp_started = true;
+        run->rtp_base = seq;
+        run->rtp_max_seq = seq;
+    } else {
+        uint16_t delta = (uint16_t)(seq - run->rtp_max_seq);
+        if (delta < 0x8000u) {
+            if (seq < run->rtp_max_seq) {
+                run->rtp_cycles += 0x10000u;
+            }
+            run->rtp_max_seq = seq;
+        }
+    }
+    run->rtp_received++;
+}
+
+static uint32_t rtp_lost(const udp_run_t *run) {
+    return run->rtp_cycles + run->rtp_max_seq - run->rtp_base + 1u - run->rtp_received;
+}
+
+// 检查一个数据报的 RTP 报头，返回其后的帧头 + 负载
+static const uint8_t *check_rtp(const uint8_t *d, ssize_t len, uint16_t expected_seq, const uint8_t *sent, size_t sent_len,
+                                bool *ok) {
+    bool parity = (sent[offsetof(audio_frame_header_t, flags)] & AUDIO_FRAME_FLAG_FEC_PARITY) != 0;
+    uint32_t timestamp_ms = get_le32(&sent[offsetof(audio_frame_header_t, timestamp_ms)]);
+    *ok &= (len == (ssize_t)(UDP_STREAM_RTP_HEADER_SIZE + sent_len)) && d[0] == (UDP_STREAM_RTP_VERSION << 6) &&
+           d[1] == (parity ? UDP_STREAM_PAYLOAD_TYPE_FEC : UDP_STREAM_PAYLOAD_TYPE_AUDIO) && get_be16(&d[2]) == expected_seq &&
+           get_be32(&d[4]) == timestamp_ms * UDP_STREAM_RTP_CLOCK_KHZ && get_be32(&d[8]) == fnv1a(TEST_CLIENT_ID) &&
+           memcmp(&d[UDP_STREAM_RTP_HEADER_SIZE], sent, sent_len) == 0;
+    return &d[UDP_STREAM_RTP_HEADER_SIZE];
+}
+
+// 收到校验包时尝试恢复本组唯一丢失的帧；恢复出的帧在校验包到达时交付
+static void on_parity(udp_run_t *run, const uint8_t *parity, size_t parity_len, uint32_t arrival_ms) {
+    uint32_t base = get_le32(&parity[offsetof(audio_frame_header_t, sequence)]);
+    uint32_t group = parity[offsetof(audio_frame_header_t, channels)];
+    const uint8_t *view[FEC_MAX_GROUP_SIZE];
+    size_t lens[FEC_MAX_GROUP_SIZE];
+    for (uint32_t i = 0; i < group; i++) {
+        bool have = (base + i < TEST_FRAMES) && received_len[base + i] != 0;
+        view[i] = have ? received[base + i] : NULL;
+        lens[i] = have ? received_len[base + i] : 0;
+    }
+    uint8_t out[FEC_PARITY_BUFFER_SIZE(TEST_PACKET_BYTES)];
+    size_t len = fec_recover(parity, parity_len, view, lens, out, sizeof(out));
+    if (len == 0) {
+        return;
+    }
+    uint32_t sequence = get_le32(&out[offsetof(audio_frame_header_t, sequence)]);
+    if (sequence < base || sequence >= base + group || sequence >= TEST_FRAMES || received_len[sequence] != 0 ||
+        !same_as_original(out, len, sequence)) {
+        run->recovery_ok = false;
+        return;
+    }
+    memcpy(received[sequence], out, len);
+    received_len[sequence] = len;
+    latency_ms[sequence] = arrival_ms - sequence * TEST_FRAME_MS;
+    run->recovered++;
+}
+
+// 发送一个数据报 (帧或校验包)，接收并按丢包模型决定是否丢弃
+static void send_and_receive(udp_run_t *run, const loss_condition_t *c, uint8_t *packet, size_t len, uint16_t *expected_seq,
+                             uint32_t send_ms) {
+    uint8_t sent[FEC_PARITY_BUFFER_SIZE(TEST_PACKET_BYTES)];
+    memcpy(sent, packet, len);
+    uint32_t sends_before = shim_socket_sends;
+    run->format_ok &= (udp_stream_send(packet, len) == CY_RSLT_SUCCESS) && (shim_socket_sends == sends_before + 1u);
+
+    static uint8_t d[TEST_DATAGRAM_BYTES + 16];
+    ssize_t n = receive_datagram(d, sizeof(d));
+    if (n <= 0) {
+        run->format_ok = false;
+        return;
+    }
+    bool ok = true;
+    const uint8_t *content = check_rtp(d, n, *expected_seq, sent, len, &ok);
+    run->format_ok &= ok;
+    run->datagrams++;
+    (*expected_seq)++;
+    if (next_lost(c)) {
+        run->dropped++;
+        run->trailing_drops++;
+        return;
+    }
+    run->trailing_drops = 0;
+    on_rtp_sequence(run, get_be16(&d[2]));
+    size_t content_len = (size_t)n - UDP_STREAM_RTP_HEADER_SIZE;
+    uint32_t arrival_ms = send_ms + TEST_ONE_WAY_MS;
+    if ((content[offsetof(audio_frame_header_t, flags)] & AUDIO_FRAME_FLAG_FEC_PARITY) != 0) {
+        on_parity(run, content, content_len, arrival_ms);
+        return;
+    }
+    uint32_t sequence = get_le32(&content[offsetof(audio_frame_header_t, sequence)]);
+    memcpy(received[sequence], content, content_len);
+    received_len[sequence] = content_len;
+    latency_ms[sequence] = arrival_ms - sequence * TEST_FRAME_MS;
+}
+
+// 按网络任务的顺序发送 TEST_FRAMES 帧：结束被跳过的组、发帧、累加校验、组满时发校验包
+static udp_run_t run_udp(const loss_condition_t *c, uint32_t group_size) {
+    udp_run_t run = { .format_ok = true, .recovery_ok = true };
+    memset(received_len, 0, sizeof(received_len));
+    for (uint32_t i = 0; i < TEST_FRAMES; i++) {
+        latency_ms[i] = TEST_NOT_DELIVERED;
+    }
+    fec_encoder_t enc;
+    uint8_t *parity_buffer = &parity_storage[AUDIO_FRAME_HEADROOM];
+    fec_encoder_init(&enc, parity_buffer, sizeof(parity_storage) - AUDIO_FRAME_HEADROOM, group_size);
+    seed = 1u;
+    loss_bad = false;
+
+    udp_stream_stats_t stats;
+    udp_stream_get_stats(&stats);
+    uint32_t sent_before = stats.datagrams_sent;
+    // 序号接着之前的运行，每次运行约 9000 个数据报，几次运行后 16 位序号回绕
+    uint16_t expected_seq = (uint16_t)(stats.datagrams_sent + stats.send_errors);
+    uint32_t sends_before = shim_socket_sends;
+
+    uint8_t *frame = &frame_storage[AUDIO_FRAME_HEADROOM];
+    for (uint32_t seq = 0; seq < TEST_FRAMES; seq++) {
+        uint32_t now_ms = seq * TEST_FRAME_MS;
+        size_t parity_len = fec_encoder_close_before(&enc, seq);
+        if (parity_len > 0) {
+            send_and_receive(&run, c, parity_buffer, parity_len, &expected_seq, now_ms);
+        }
+        size_t len = make_frame(frame, seq);
+        parity_len = fec_encoder_add(&enc, frame, len);
+        send_and_receive(&run, c, frame, len, &expected_seq, now_ms);
+        if (parity_len > 0) {
+            send_and_receive(&run, c, parity_buffer, parity_len, &expected_seq, now_ms);
+        }
+    }
+    run.sends = shim_socket_sends - sends_before;
+    for (uint32_t seq = 0; seq < TEST_FRAMES; seq++) {
+        frame_lost[seq] = (received_len[seq] == 0);
+        if (received_len[seq] != 0 && !same_as_original(received[seq], received_len[seq], seq)) {
+            run.recovery_ok = false;
+        }
+    }
+    udp_stream_get_stats(&stats);
+    run.format_ok &= (stats.datagrams_sent - sent_before == run.datagrams) && (run.sends == run.datagrams);
+    return run;
+}
+
+// --- TCP 队头阻塞模型 ---
+
+// 按与 UDP 相同的丢包模型丢弃报文段 (首次发送和重传)，得到每帧交付给应用的延迟
+static void run_tcp(const loss_condition_t *c) {
+    static uint32_t arrival[TEST_FRAMES];
+    static bool first_lost[TEST_FRAMES];
+    seed = 1u;
+    loss_bad = false;
+    for (uint32_t k = 0; k < TEST_FRAMES; k++) {
+        first_lost[k] = next_lost(c);
+    }
+    for (uint32_t k = 0; k < TEST_FRAMES; k++) {
+        uint32_t send_ms = k * TEST_FRAME_MS;
+        if (!first_lost[k]) {
+            arrival[k] = send_ms + TEST_ONE_WAY_MS;
+            continue;
+        }
+        // 第 TEST_TCP_DUPACKS 个后续到达的报文段触发快速重传，否则等 RTO
+        uint32_t retransmit_ms = send_ms + TEST_TCP_RTO_MS;
+        uint32_t dupacks = 0;
+        for (uint32_t j = k + 1; j < TEST_FRAMES && j * TEST_FRAME_MS < retransmit_ms; j++) {
+            if (!first_lost[j] && ++dupacks == TEST_TCP_DUPACKS) {
+                uint32_t fast_ms = j * TEST_FRAME_MS + 2u * TEST_ONE_WAY_MS;
+                retransmit_ms = (fast_ms < retransmit_ms) ? fast_ms : retransmit_ms;
+                break;
+            }
+        }
+        uint32_t rto = TEST_TCP_RTO_MS;
+        while (next_lost(c)) {
+            retransmit_ms += rto;
+            rto *= 2u;
+        }
+        arrival[k] = retransmit_ms + TEST_ONE_WAY_MS;
+    }
+    uint32_t delivered_ms = 0;
+    for (uint32_t k = 0; k < TEST_FRAMES; k++) {
+        delivered_ms = (arrival[k] > delivered_ms) ? arrival[k] : delivered_ms;
+        latency_ms[k] = delivered_ms - k * TEST_FRAME_MS;
+        frame_lost[k] = false;
+    }
+}
+
+static int compare_u32(const void *a, const void *b) {
+    uint32_t x = *(const uint32_t *)a;
+    uint32_t y = *(const uint32_t *)b;
+    return (x > y) - (x < y);
+}
+
+static latency_summary_t summarize(void) {
+    latency_summary_t s = { 0 };
+    uint32_t n = 0;
+    for (uint32_t k = 0; k < TEST_FRAMES; k++) {
+        if (frame_lost[k]) {
+            s.lost++;
+        } else {
+            sorted[n++] = latency_ms[k];
+        }
+    }
+    if (n > 0) {
+        qsort(sorted, n, sizeof(sorted[0]), compare_u32);
+        s.p50_ms = sorted[n / 2u];
+        s.p99_ms = sorted[(n * 99u) / 100u];
+        s.max_ms = sorted[n - 1u];
+    }
+    return s;
+}
+
+static void print_summary(const char *path, const latency_summary_t *s) {
+    printf("    %-12s p50 %4u ms  p99 %4u ms  max %5u ms  lost %5.2f%%\n", path, (unsigned int)s->p50_ms,
+           (unsigned int)s->p99_ms, (unsigned int)s->max_ms, 100.0 * s->lost / TEST_FRAMES);
+}
+
+static bool check_condition(const loss_condition_t *c) {
+    printf("%s loss %u%%:\n", c->name, (unsigned int)c->loss_pct);
+    udp_run_t plain = run_udp(c, 0);
+    latency_summary_t udp = summarize();
+    print_summary("udp", &udp);
+    udp_run_t fec = run_udp(c, TEST_FEC_GROUP);
+    latency_summary_t udp_fec = summarize();
+    print_summary("udp+fec", &udp_fec);
+    run_tcp(c);
+    latency_summary_t tcp = summarize();
+    print_summary("tcp (model)", &tcp);
+
+    bool format_ok = plain.format_ok && fec.format_ok && plain.datagrams == TEST_FRAMES &&
+                     fec.datagrams == TEST_FRAMES + TEST_FRAMES / TEST_FEC_GROUP;
+    bool accounting_ok = rtp_lost(&plain) == plain.dropped - plain.trailing_drops &&
+                         rtp_lost(&fec) == fec.dropped - fec.trailing_drops && plain.recovered == 0 &&
+                         plain.dropped == udp.lost && fec.recovery_ok && plain.recovery_ok;
+    bool latency_ok = udp.max_ms == TEST_ONE_WAY_MS && udp_fec.max_ms <= (TEST_FEC_GROUP - 1u) * TEST_FRAME_MS + TEST_ONE_WAY_MS &&
+                      tcp.lost == 0;
+    bool fec_ok = c->burst || c->loss_pct == 0 || udp_fec.lost < udp.lost;
+    bool hol_ok = c->burst || c->loss_pct != TEST_HOL_LOSS_PCT || tcp.p99_ms >= udp.p99_ms + TEST_MIN_HOL_MS;
+    bool ok = format_ok && accounting_ok && latency_ok && fec_ok && hol_ok;
+    printf("    %u datagrams, %u dropped, %u recovered by FEC; RTP format %s, loss accounting %s  %s\n",
+           (unsigned int)fec.datagrams, (unsigned int)fec.dropped, (unsigned int)fec.recovered, format_ok ? "ok" : "wrong",
+           accounting_ok ? "ok" : "wrong", ok ? "ok" : "FAIL");
+    return ok;
+}
+
+// 发送失败计数并占用序号；之后的数据报序号跳过失败的那个
+static bool check_send_failure(void) {
+    udp_stream_stats_t before, after;
+    udp_stream_get_stats(&before);
+    uint8_t *frame = &frame_storage[AUDIO_FRAME_HEADROOM];
+    size_t len = make_frame(frame, 0);
+    shim_socket_send_failures = 1;
+    bool ok = udp_stream_send(frame, len) != CY_RSLT_SUCCESS;
+    ok &= udp_stream_send(frame, len) == CY_RSLT_SUCCESS;
+    uint8_t d[TEST_DATAGRAM_BYTES];
+    ssize_t n = receive_datagram(d, sizeof(d));
+    udp_stream_get_stats(&after);
+    ok &= n > 0 && get_be16(&d[2]) == (uint16_t)(before.datagrams_sent + before.send_errors + 1u);
+    ok &= after.send_errors == before.send_errors + 1u && after.datagrams_sent == before.datagrams_sent + 1u;
+    ok &= receive_datagram(d, sizeof(d)) < 0;
+    printf("send failure counted, sequence number skipped  %s\n", ok ? "ok" : "FAIL");
+    return ok;
+}
+
+static bool check_feedback(void) {
+    udp_stream_feedback_t fb;
+    udp_stream_stats_t stats;
+    uint8_t report[UDP_STREAM_FEEDBACK_SIZE] = { 0 };
+    report[0] = UDP_STREAM_FEEDBACK_VERSION;
+    report[1] = 13;
+    put_le32(&report[4], 0x00012345u);
+    put_le32(&report[8], 321u);
+    put_le32(&report[12], 7u);
+
+    bool ok = !udp_stream_take_feedback(&fb);
+    udp_stream_handle_feedback(report, sizeof(report) - 1u);
+    ok &= !udp_stream_take_feedback(&fb);
+    report[0] = UDP_STREAM_FEEDBACK_VERSION + 1u;
+    udp_stream_handle_feedback(report, sizeof(report));
+    ok &= !udp_stream_take_feedback(&fb);
+
+    report[0] = UDP_STREAM_FEEDBACK_VERSION;
+    udp_stream_handle_feedback(report, sizeof(report));
+    ok &= udp_stream_take_feedback(&fb) && fb.fraction_lost == 13 && fb.highest_sequence == 0x00012345u &&
+          fb.cumulative_lost == 321u && fb.jitter_ms == 7u;
+    ok &= !udp_stream_take_feedback(&fb);
+    udp_stream_get_stats(&stats);
+    ok &= stats.feedback_reports == 1u && stats.last_feedback.cumulative_lost == 321u;
+    printf("receiver reports parsed, malformed ones ignored, each taken once  %s\n", ok ? "ok" : "FAIL");
+    return ok;
+}
+
+int main(void) {
+    static const loss_condition_t conditions[] = {
+        { "no", 0, false },
+        { "random", 1, false },
+        { "random", TEST_HOL_LOSS_PCT, false },
+        { "random", 5, false },
+        { "burst", TEST_HOL_LOSS_PCT, true },
+    };
+    receiver_fd = open_receiver();
+    if (receiver_fd < 0 || udp_stream_open("127.0.0.1", TEST_CLIENT_ID) != CY_RSLT_SUCCESS) {
+        printf("cannot open loopback UDP  FAIL\n");
+        return 1;
+    }
+    bool ok = udp_stream_is_open();
+    ok &= check_feedback();
+    ok &= check_send_failure();
+    printf("%u frames of %u ms, one-way delay %u ms, FEC group %u, TCP RTO %u ms\n", (unsigned int)TEST_FRAMES,
+           (unsigned int)TEST_FRAME_MS, (unsigned int)TEST_ONE_WAY_MS, (unsigned int)TEST_FEC_GROUP,
+           (unsigned int)TEST_TCP_RTO_MS);
+    for (size_t i = 0; i < sizeof(conditions) / sizeof(conditions[0]); i++) {
+        ok &= check_condition(&conditions[i]);
+    }
+    udp_stream_close();
+    ok &= !udp_stream_is_open();
+    close(receiver_fd);
+    printf("%s\n", ok ? "all checks passed" : "FAILED");
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,212 @@
+#!/usr/bin/env python3
+"""SRAM 内存报告：解析 GNU ld 的 .map 文件，按模块 (目标文件或库) 汇总静态占用，
+并列出任务堆栈、队列、定时器/事件组和大缓冲区。
+
+ModusToolbox 构建 (GCC_ARM) 后由 Makefile 的 POSTBUILD 调用：
+    python3 tools/memmap.py build/APP_CY8CPROTO-062-4343W/Debug/meeting-assistant-app.map
+
+依赖 -fdata-sections (ModusToolbox 默认开启)，每个变量有自己的输入段 (.bss.<名字>)，才能按变量归类。
+应用的对象都是静态分配的，这里看到的就是它们的全部占用；剩下的 SRAM 是 C 库堆 (.heap) 和主堆栈。
+"""
+
+import argparse
+import os
+import re
+import sys
+
+HEX = r'0x([0-9a-fA-F]+)'
+RE_REGION = re.compile(r'^(\S+)\s+' + HEX + r'\s+' + HEX + r'(?:\s+(\S+))?\s*$')
+RE_OUTPUT_ONE_LINE = re.compile(r'^(\S+)\s+' + HEX + r'\s+' + HEX + r'(?:\s|$)')
+RE_INPUT_ONE_LINE = re.compile(r'^ (\S+)\s+' + HEX + r'\s+' + HEX + r'\s+(\S.*)$')
+RE_ADDR_SIZE = re.compile(r'^\s+' + HEX + r'\s+' + HEX + r'(?:\s+(\S.*))?$')
+RE_NAME_ONLY_OUTPUT = re.compile(r'^(\S+)\s*$')
+RE_NAME_ONLY_INPUT = re.compile(r'^ (\S+)\s*$')
+
+# 找不到可写内存区域 (例如主机上的默认链接脚本) 时按输出段名判断
+RAM_SECTION_NAMES = {'.data', '.bss', '.tdata', '.tbss', '.noinit', '.heap', '.stack', '.stack_dummy', '.ramVectors'}
+
+# 按变量名归类，顺序即优先级。名字约定见 design.md "静态内存分配"
+CATEGORIES = [
+    ('Task stacks and TCBs', re.compile(r'(_stack|_tcb)$')),
+    ('Queues', re.compile(r'queue')),
+    ('Timers and event groups', re.compile(r'(timer|event_group)_struct$')),
+]
+BUFFERS = 'Buffers'
+
+
+def parse_map(path):
+    """返回 (内存区域列表, 输出段列表, 输入段列表)。"""
+    regions = []
+    outputs = []
+    inputs = []
+    with open(path, errors='replace') as f:
+        lines = f.read().splitlines()
+
+    i = 0
+    # 内存区域表
+    while i < len(lines) and lines[i].strip() != 'Memory Configuration':
+        i += 1
+    while i < len(lines) and not lines[i].startswith('Linker script and memory map'):
+        m = RE_REGION.match(lines[i])
+        if m and m.group(1) != '*default*':
+            regions.append({'name': m.group(1), 'origin': int(m.group(2), 16), 'length': int(m.group(3), 16),
+                            'attrs': m.group(4) or ''})
+        i += 1
+
+    current = None
+    pending_output = None
+    pending_input = None
+    for line in lines[i:]:
+        # 名字太长时地址和大小折到下一行
+        if pending_output is not None or pending_input is not None:
+            m = RE_ADDR_SIZE.match(line)
+            if m:
+                addr, size = int(m.group(1), 16), int(m.group(2), 16)
+                if pending_output is not None:
+                    current = {'name': pending_output, 'addr': addr, 'size': size}
+                    outputs.append(current)
+                elif current is not None and m.group(3):
+                    inputs.append(make_input(current, pending_input, addr, size, m.group(3)))
+                pending_output = pending_input = None
+                continue
+            pending_output = pending_input = None
+
+        if not line or line.startswith('LOAD ') or line.startswith('OUTPUT('):
+            continue
+        if not line[0].isspace():
+            m = RE_OUTPUT_ONE_LINE.match(line)
+            if m:
+                current = {'name': m.group(1), 'addr': int(m.group(2), 16), 'size': int(m.group(3), 16)}
+                outputs.append(current)
+                continue
+            m = RE_NAME_ONLY_OUTPUT.match(line)
+            if m:
+                pending_output = m.group(1)
+            continue
+        if current is None or line.startswith(' *'):
+            continue    # 链接脚本中的通配模式和 *fill*
+        m = RE_INPUT_ONE_LINE.match(line)
+        if m:
+            inputs.append(make_input(current, m.group(1), int(m.group(2), 16), int(m.group(3), 16), m.group(4)))
+            continue
+        m = RE_NAME_ONLY_INPUT.match(line)
+        if m:
+            pending_input = m.group(1)
+    return regions, outputs, inputs
+
+
+def make_input(output, section, addr, size, obj):
+    return {'output': output['name'], 'section': section, 'addr': addr, 'size': size, 'object': obj.strip()}
+
+
+def ram_regions(regions):
+    return [r for r in regions if 'w' in r['attrs'].lower()]
+
+
+def in_ram(addr, size, name, rams):
+    if rams:
+        return any(r['origin'] <= addr < r['origin'] + r['length'] for r in rams)
+    return size > 0 and name in RAM_SECTION_NAMES
+
+
+def module_name(obj):
+    """目标文件归到模块：库里的成员归到库，ModusToolbox 共享库里的源文件归到库目录，应用自己的源文件按文件名。"""
+    obj = obj.replace('\\', '/')
+    m = re.match(r'^(.*?)\((.*)\)$', obj)
+    if m:
+        return os.path.basename(m.group(1))
+    m = re.search(r'(?:mtb_shared|libs)/([^/]+)/', obj)
+    if m:
+        return m.group(1)
+    if '/bsps/' in obj:
+        return 'bsp'
+    return os.path.basename(obj)
+
+
+def symbol_name(section):
+    # .bss.<名字> / .data.<名字>；函数内的静态变量带 .<编号> 后缀
+    for prefix in ('.bss.', '.data.', '.noinit.', '.tbss.', '.tdata.'):
+        if section.startswith(prefix):
+            return re.sub(r'\.\d+$', '', section[len(prefix):])
+    return None
+
+
+def category(symbol):
+    for name, pattern in CATEGORIES:
+        if pattern.search(symbol):
+            return name
+    return BUFFERS
+
+
+def report(path, top, min_buffer, out):
+    regions, outputs, inputs = parse_map(path)
+    rams = ram_regions(regions)
+    ram_outputs = [o for o in outputs if o['size'] > 0 and in_ram(o['addr'], o['size'], o['name'], rams)]
+    ram_output_names = {o['name'] for o in ram_outputs}
+    # .heap 和 .stack_dummy 由链接脚本填满剩余空间，单独列出，不算作模块的静态占用
+    reserved = {'.heap', '.stack', '.stack_dummy'}
+    static_inputs = [s for s in inputs if s['size'] > 0 and s['output'] in ram_output_names and s['output'] not in reserved]
+
+    w = out.write
+    w('SRAM report for %s\n' % path)
+    for r in rams:
+        used = sum(o['size'] for o in ram_outputs if r['origin'] <= o['addr'] < r['origin'] + r['length'])
+        w('  region %-10s 0x%08x  %7d bytes, %7d used, %7d free\n' % (r['name'], r['origin'], r['length'], used,
+                                                                        r['length'] - used))
+    for o in ram_outputs:
+        note = ''
+        if o['name'] == '.heap':
+            note = '  (C library heap: WHD, lwIP, mbedTLS)'
+        elif o['name'] in ('.stack', '.stack_dummy'):
+            note = '  (main stack, interrupts)'
+        w('  %-18s 0x%08x  %7d bytes%s\n' % (o['name'], o['addr'], o['size'], note))
+    total = sum(s['size'] for s in static_inputs)
+    w('  static data total           %7d bytes\n' % total)
+
+    modules = {}
+    for s in static_inputs:
+        modules[module_name(s['object'])] = modules.get(module_name(s['object']), 0) + s['size']
+    w('\nSRAM by module (.data, .bss and other RAM sections):\n')
+    for name, size in sorted(modules.items(), key=lambda kv: -kv[1])[:top]:
+        w('  %-40s %7d  %5.1f%%\n' % (name, size, 100.0 * size / total if total else 0.0))
+    if len(modules) > top:
+        rest = sum(size for _, size in sorted(modules.items(), key=lambda kv: -kv[1])[top:])
+        w('  %-40s %7d\n' % ('(%d more)' % (len(modules) - top), rest))
+
+    grouped = {}
+    for s in static_inputs:
+        symbol = symbol_name(s['section'])
+        if symbol is None:
+            continue
+        cat = category(symbol)
+        if cat == BUFFERS and s['size'] < min_buffer:
+            continue
+        grouped.setdefault(cat, []).append((symbol, s['size'], module_name(s['object'])))
+    for cat in [name for name, _ in CATEGORIES] + [BUFFERS]:
+        entries = sorted(grouped.get(cat, []), key=lambda e: -e[1])
+        title = cat if cat != BUFFERS else '%s (>= %d bytes)' % (BUFFERS, min_buffer)
+        w('\n%s: %d bytes\n' % (title, sum(e[1] for e in entries)))
+        for symbol, size, module in entries:
+            w('  %-40s %7d  %s\n' % (symbol, size, module))
+    return 0
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Summarize SRAM usage from a GNU ld map file.')
+    parser.add_argument('map', help='linker map file (-Wl,-Map)')
+    parser.add_argument('--top', type=int, default=20, help='number of modules to list (default 20)')
+    parser.add_argument('--min-buffer', type=int, default=256, help='smallest buffer to list, in bytes (default 256)')
+    parser.add_argument('-o', '--output', help='also write the report to this file')
+    args = parser.parse_args()
+    if not os.path.exists(args.map):
+        sys.stderr.write('memmap: %s not found\n' % args.map)
+        return 1
+    report(args.map, args.top, args.min_buffer, sys.stdout)
+    if args.output:
+        with open(args.output, 'w') as f:
+            report(args.map, args.top, args.min_buffer, f)
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())